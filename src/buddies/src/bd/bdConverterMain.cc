@@ -65,9 +65,10 @@ int converter_main (int argc, char *argv[], const std::string &format)
     generic_writer_options.configure (save_options, layout);
     save_options.set_format (format);
 
-    tl::OutputStream stream (outfile);
+    tl::OutputStream stream (outfile, tl::OutputStream::OM_Auto, false, save_options.zlib_threads ());
     db::Writer writer (save_options);
     writer.write (layout, stream);
+    stream.close ();
   }
 
   return 0;
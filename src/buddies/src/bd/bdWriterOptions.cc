@@ -35,6 +35,7 @@ GenericWriterOptions::GenericWriterOptions ()
     m_dont_write_empty_cells (false),
     m_keep_instances (false),
     m_write_context_info (true),
+    m_zlib_threads (0),
     m_gds2_max_vertex_count (8000),
     m_gds2_no_zero_length_paths (false),
     m_gds2_multi_xy_records (false),
@@ -134,6 +135,14 @@ GenericWriterOptions::add_options (tl::CommandLineOptions &cmd, const std::strin
                   "* \"TOP,-A\" - Select cell TOP (plus children), then remove A (with children)"
                  );
 
+  cmd << tl::arg (group +
+                  "#--zlib-threads=threads",  &m_zlib_threads, "Compresses gzip output with multiple threads",
+                  "If the output file is gzip-compressed (e.g. with suffix '.gz'), this option specifies the number "
+                  "of threads to use for compression. The output is still a standard gzip file, but it carries a "
+                  "block index which allows reading it with multiple threads too. With a value of 0 (the default), "
+                  "the file is compressed by the writing thread."
+                 );
+
   if (format.empty () || format == gds2_format_name || format == gds2text_format_name) {
 
     //  Add GDS2 and GDS2Text format options
@@ -345,6 +354,7 @@ GenericWriterOptions::configure (db::SaveLayoutOptions &save_options, const db::
   save_options.set_dont_write_empty_cells (m_dont_write_empty_cells);
   save_options.set_keep_instances (m_keep_instances);
   save_options.set_write_context_info (m_write_context_info);
+  save_options.set_zlib_threads (m_zlib_threads);
 
   save_options.set_option_by_name ("gds2_max_vertex_count", m_gds2_max_vertex_count);
   save_options.set_option_by_name ("gds2_no_zero_length_paths", m_gds2_no_zero_length_paths);
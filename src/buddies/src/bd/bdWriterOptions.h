@@ -112,6 +112,7 @@ private:
   bool m_keep_instances;
   bool m_write_context_info;
   std::string m_cell_selection;
+  unsigned int m_zlib_threads;
 
   unsigned int m_gds2_max_vertex_count;
   bool m_gds2_no_zero_length_paths;
@@ -159,7 +159,7 @@ void clip (const ClipData &data)
   save_options.set_format_from_filename (data.file_out);
   data.writer_options.configure (save_options, target_layout);
 
-  tl::OutputStream stream (data.file_out);
+  tl::OutputStream stream (data.file_out, tl::OutputStream::OM_Auto, false, save_options.zlib_threads ());
   db::Writer writer (save_options);
   writer.write (target_layout, stream);
 }
@@ -25,6 +25,7 @@
 #include "dbLayoutDiff.h"
 #include "dbReader.h"
 #include "tlCommandLineParser.h"
+#include "tlStream.h"
 
 BD_PUBLIC int strmcmp (int argc, char *argv[])
 {
@@ -55,6 +56,7 @@ BD_PUBLIC int strmcmp (int argc, char *argv[])
   double tolerance = 0.0;
   int max_count = 0;
   bool print_properties = false;
+  int threads = 0;
 
   tl::CommandLineOptions cmd;
   generic_reader_options_a.add_options (cmd);
@@ -126,12 +128,20 @@ BD_PUBLIC int strmcmp (int argc, char *argv[])
                   "If the value is >1, max-count-1 differences plus one warning about abbreviation is printed. "
                   "A value of 0 means \"no limitation\". To suppress all output, use --silent."
                  )
+      << tl::arg ("-n|--threads=threads",      &threads,    "Specifies the number of threads to use",
+                  "If given, the cells are compared in parallel using the given number of threads. "
+                  "The differences are reported in the same order as without this option. "
+                  "The threads are also used for reading gzip-compressed files."
+                 )
     ;
 
   cmd.brief ("This program will compare two layout files on a per-object basis");
 
   cmd.parse (argc, argv);
 
+  //  the threads are also used for reading gzip files
+  unsigned int zlib_threads = threads > 1 ? (unsigned int) threads : 0;
+
   if (top_a.empty () != top_b.empty ()) {
     throw tl::Exception ("Both -ta|--top-a and -tb|--top-b top cells must be given");
   }
@@ -143,7 +153,7 @@ BD_PUBLIC int strmcmp (int argc, char *argv[])
     db::LoadLayoutOptions load_options;
     generic_reader_options_a.configure (load_options);
 
-    tl::InputStream stream (infile_a);
+    tl::InputStream stream (infile_a, zlib_threads);
     db::Reader reader (stream);
     reader.read (layout_a, load_options);
   }
@@ -152,7 +162,7 @@ BD_PUBLIC int strmcmp (int argc, char *argv[])
     db::LoadLayoutOptions load_options;
     generic_reader_options_b.configure (load_options);
 
-    tl::InputStream stream (infile_b);
+    tl::InputStream stream (infile_b, zlib_threads);
     db::Reader reader (stream);
     reader.read (layout_b, load_options);
   }
@@ -231,10 +241,10 @@ BD_PUBLIC int strmcmp (int argc, char *argv[])
       throw tl::Exception ("'" + top_b + "' is not a valid cell name in second layout");
     }
 
-    result = db::compare_layouts (layout_a, index_a.second, layout_b, index_b.second, flags, tolerance_dbu, max_count, print_properties);
+    result = db::compare_layouts (layout_a, index_a.second, layout_b, index_b.second, flags, tolerance_dbu, max_count, print_properties, threads);
 
   } else {
-    result = db::compare_layouts (layout_a, layout_b, flags, tolerance_dbu, max_count, print_properties);
+    result = db::compare_layouts (layout_a, layout_b, flags, tolerance_dbu, max_count, print_properties, threads);
   }
 
   if (! result && ! silent) {
@@ -28,8 +28,17 @@
 #include "dbSaveLayoutOptions.h"
 #include "dbRegion.h"
 #include "dbDeepShapeStore.h"
+#include "dbStreamingWriter.h"
+#include "dbContentHash.h"
+#include "rdb.h"
+#include "rdbUtils.h"
+#include "rdbTiledRdbOutputReceiver.h"
 #include "gsiExpression.h"
 #include "tlCommandLineParser.h"
+#include "tlThreadedWorkers.h"
+#include "tlThreads.h"
+#include "tlFileUtils.h"
+#include "tlStream.h"
 
 class CountingInserter
 {
@@ -55,31 +64,37 @@ private:
   size_t m_count;
 };
 
-class CountingReceiver
-  : public db::TileOutputReceiver
+class ShapesInserter
 {
 public:
-  CountingReceiver (size_t *count)
-    : mp_count (count)
+  ShapesInserter (db::Shapes *shapes, const db::ICplxTrans &trans)
+    : mp_shapes (shapes), m_trans (trans), m_count (0)
   {
     //  .. nothing yet ..
   }
 
-  virtual void put (size_t /*ix*/, size_t /*iy*/, const db::Box &tile, size_t /*id*/, const tl::Variant &obj, double /*dbu*/, const db::ICplxTrans & /*trans*/, bool clip)
+  template <class T>
+  void operator() (const T &t)
   {
-    CountingInserter inserter;
-    db::insert_var (inserter, obj, tile, clip);
-    *mp_count += inserter.count ();
+    mp_shapes->insert (t.transformed (m_trans));
+    m_count += 1;
+  }
+
+  size_t count () const
+  {
+    return m_count;
   }
 
 private:
-  size_t *mp_count;
+  db::Shapes *mp_shapes;
+  db::ICplxTrans m_trans;
+  size_t m_count;
 };
 
 struct ResultDescriptor
 {
   ResultDescriptor ()
-    : shape_count (0), layer_a (-1), layer_b (-1), layer_output (-1), layout (0), top_cell (0)
+    : shape_count (0), layer_a (-1), layer_b (-1), layer_output (-1), layout (0), top_cell (0), rdb_category (0)
   {
     //  .. nothing yet ..
   }
@@ -90,6 +105,8 @@ struct ResultDescriptor
   int layer_output;
   db::Layout *layout;
   db::cell_index_type top_cell;
+  std::string output_name;
+  rdb::id_type rdb_category;
 
   size_t count () const
   {
@@ -126,7 +143,8 @@ struct XORData
       tolerance_bump (0),
       dont_summarize_missing_layers (false), silent (false), no_summary (false),
       threads (0),
-      tile_size (0.0), output_layout (0), output_cell (0)
+      tile_size (0.0), max_count (0), output_layout (0), output_cell (0),
+      output_writer (0), output_rdb (0), output_rdb_cell (0)
   { }
 
   db::Layout *layout_a, *layout_b;
@@ -138,12 +156,175 @@ struct XORData
   bool no_summary;
   int threads;
   double tile_size;
+  size_t max_count;
   db::Layout *output_layout;
   db::cell_index_type output_cell;
+  db::StreamingWriter *output_writer;
+  rdb::Database *output_rdb;
+  rdb::id_type output_rdb_cell;
   std::map<db::LayerProperties, std::pair<int, int> > l2l_map;
   std::map<std::pair<int, db::LayerProperties>, ResultDescriptor> *results;
 };
 
+/**
+ *  @brief Tracks the number of differences per layer for the early stop mode
+ *
+ *  A layer is done if all of its results have reached the maximum number of
+ *  differences. The tiles of such layers are skipped.
+ */
+class XORStopCondition
+{
+public:
+  XORStopCondition (size_t max_count)
+    : m_max_count (max_count)
+  {
+    //  .. nothing yet ..
+  }
+
+  void add_result (int index, const ResultDescriptor *result)
+  {
+    m_results [index].push_back (result);
+  }
+
+  bool is_done (const ResultDescriptor *result) const
+  {
+    return m_max_count > 0 && result->shape_count >= m_max_count;
+  }
+
+  bool is_done (int index)
+  {
+    tl::MutexLocker locker (&m_lock);
+
+    std::map<int, std::vector<const ResultDescriptor *> >::const_iterator r = m_results.find (index);
+    if (r == m_results.end () || m_max_count == 0) {
+      return false;
+    }
+    for (std::vector<const ResultDescriptor *>::const_iterator i = r->second.begin (); i != r->second.end (); ++i) {
+      if (! is_done (*i)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  tl::Mutex &lock ()
+  {
+    return m_lock;
+  }
+
+private:
+  tl::Mutex m_lock;
+  size_t m_max_count;
+  std::map<int, std::vector<const ResultDescriptor *> > m_results;
+};
+
+/**
+ *  @brief The "_skip(index)" function for the tile scripts
+ *
+ *  This function returns true if the given layer is done in early stop mode.
+ */
+class XORSkipFunction
+  : public tl::EvalFunction
+{
+public:
+  XORSkipFunction (XORStopCondition *stop)
+    : mp_stop (stop)
+  {
+    //  .. nothing yet ..
+  }
+
+  void execute (const tl::ExpressionParserContext & /*context*/, tl::Variant &out, const std::vector<tl::Variant> &args) const
+  {
+    out = args.size () == 1 && mp_stop->is_done (args.front ().to_int ());
+  }
+
+private:
+  XORStopCondition *mp_stop;
+};
+
+/**
+ *  @brief The receiver for the tile results
+ *
+ *  The results are sent to the output layout, the streaming writer or the report database
+ *  tile by tile. The receiver also counts the differences. The tiling processor
+ *  serializes the calls of "put".
+ */
+class XORResultReceiver
+  : public db::TileOutputReceiver
+{
+public:
+  XORResultReceiver (const XORData *xor_data, ResultDescriptor *result, XORStopCondition *stop)
+    : mp_xor_data (xor_data), mp_result (result), mp_stop (stop)
+  {
+    if (xor_data->output_rdb) {
+      mp_rdb_receiver.reset (new rdb::TiledRdbOutputReceiver (xor_data->output_rdb, xor_data->output_rdb_cell, result->rdb_category));
+    }
+  }
+
+  virtual void put (size_t ix, size_t iy, const db::Box &tile, size_t id, const tl::Variant &obj, double dbu, const db::ICplxTrans &trans, bool clip)
+  {
+    if (mp_stop->is_done (mp_result)) {
+      return;
+    }
+
+    size_t n = 0;
+
+    if (mp_rdb_receiver.get ()) {
+
+      mp_rdb_receiver->put (ix, iy, tile, id, obj, dbu, trans, clip);
+
+      CountingInserter inserter;
+      db::insert_var (inserter, obj, tile, clip);
+      n = inserter.count ();
+
+    } else if (mp_xor_data->output_writer) {
+
+      ShapesInserter inserter (&mp_xor_data->output_writer->shapes ((unsigned int) mp_result->layer_output), trans);
+      db::insert_var (inserter, obj, tile, clip);
+      n = inserter.count ();
+
+      mp_xor_data->output_writer->checkpoint (n);
+
+    } else if (mp_xor_data->output_layout) {
+
+      ShapesInserter inserter (&mp_xor_data->output_layout->cell (mp_xor_data->output_cell).shapes ((unsigned int) mp_result->layer_output), trans);
+      db::insert_var (inserter, obj, tile, clip);
+      n = inserter.count ();
+
+    } else {
+
+      CountingInserter inserter;
+      db::insert_var (inserter, obj, tile, clip);
+      n = inserter.count ();
+
+    }
+
+    tl::MutexLocker locker (&mp_stop->lock ());
+    mp_result->shape_count += n;
+  }
+
+private:
+  const XORData *mp_xor_data;
+  ResultDescriptor *mp_result;
+  XORStopCondition *mp_stop;
+  std::auto_ptr<rdb::TiledRdbOutputReceiver> mp_rdb_receiver;
+};
+
+static void init_result_output (const XORData &xor_data, ResultDescriptor &result, const db::LayerProperties &lp)
+{
+  std::string name = lp.to_string ();
+
+  if (xor_data.output_layout) {
+    result.layer_output = result.layout->insert_layer (lp);
+  } else if (xor_data.output_writer) {
+    result.layer_output = xor_data.output_writer->layer (lp);
+    result.output_name = name;
+  } else if (xor_data.output_rdb) {
+    result.rdb_category = xor_data.output_rdb->create_category (name)->id ();
+    result.output_name = name;
+  }
+}
+
 static bool run_tiled_xor (const XORData &xor_data);
 static bool run_deep_xor (const XORData &xor_data);
 
@@ -171,6 +352,7 @@ BD_PUBLIC int strmxor (int argc, char *argv[])
   int tolerance_bump = 10000;
   int threads = 1;
   double tile_size = 0.0;
+  int max_count = 0;
 
   tl::CommandLineOptions cmd;
   generic_reader_options_a.add_options (cmd);
@@ -180,7 +362,9 @@ BD_PUBLIC int strmxor (int argc, char *argv[])
       << tl::arg ("input_b",                   &infile_b,   "The second input file (any format, may be gzip compressed)")
       << tl::arg ("?output",                   &output,     "The output file to which the XOR differences are written",
                   "This argument is optional. If not given, the exit status alone will indicate whether the layouts "
-                  "are identical or not."
+                  "are identical or not. If the file name has the suffix \".lyrdb\" or \".rdb\", the differences "
+                  "are written to a report database. In tiling mode, formats supporting streaming (GDS2 and OASIS) "
+                  "receive the differences tile by tile, so they don't need to be kept in memory."
                  )
       << tl::arg ("-ta|--top-a=name",          &top_a,      "Specifies the top cell for the first layout",
                   "Use this option to take a specific cell as the top cell from the first layout. All "
@@ -212,7 +396,15 @@ BD_PUBLIC int strmxor (int argc, char *argv[])
                  )
       << tl::arg ("-n|--threads=threads",      &threads,   "Specifies the number of threads to use",
                   "If given, multiple threads are used for the XOR computation. This way, multiple cores can "
-                  "be utilized."
+                  "be utilized. In tiling mode, the tiles of all layers are distributed over the threads. In "
+                  "deep mode, multiple layers are computed in parallel and the threads are shared between them. "
+                  "The threads are also used for reading and writing gzip-compressed files."
+                 )
+      << tl::arg ("-m|--max-count=count",      &max_count, "Stops after the given number of differences per layer",
+                  "If this option is given, a layer is not computed further once it has produced the given "
+                  "number of differences. This mode is useful for quick checks when only the presence of "
+                  "differences matters. The reported differences and the output are incomplete then. "
+                  "This option is effective in tiling mode only."
                  )
       << tl::arg ("-p|--tiles=size",           &tile_size, "Specifies tiling mode",
                   "In tiling mode, the layout is divided into tiles of the given size. Each tile is computed "
@@ -230,6 +422,9 @@ BD_PUBLIC int strmxor (int argc, char *argv[])
 
   cmd.parse (argc, argv);
 
+  //  the threads are also used for compressing and decompressing gzip files
+  unsigned int zlib_threads = threads > 1 ? (unsigned int) threads : 0;
+
   if (top_a.empty () != top_b.empty ()) {
     throw tl::Exception ("Both -ta|--top-a and -tb|--top-b top cells must be given");
   }
@@ -251,7 +446,7 @@ BD_PUBLIC int strmxor (int argc, char *argv[])
     db::LoadLayoutOptions load_options;
     generic_reader_options_a.configure (load_options);
 
-    tl::InputStream stream (infile_a);
+    tl::InputStream stream (infile_a, zlib_threads);
     db::Reader reader (stream);
     reader.read (layout_a, load_options);
   }
@@ -260,7 +455,7 @@ BD_PUBLIC int strmxor (int argc, char *argv[])
     db::LoadLayoutOptions load_options;
     generic_reader_options_b.configure (load_options);
 
-    tl::InputStream stream (infile_b);
+    tl::InputStream stream (infile_b, zlib_threads);
     db::Reader reader (stream);
     reader.read (layout_b, load_options);
   }
@@ -310,10 +505,43 @@ BD_PUBLIC int strmxor (int argc, char *argv[])
 
   std::auto_ptr<db::Layout> output_layout;
   db::cell_index_type output_top = 0;
+  std::auto_ptr<tl::OutputStream> output_stream;
+  std::auto_ptr<db::StreamingWriter> output_writer;
+  std::auto_ptr<rdb::Database> output_rdb;
+  rdb::id_type output_rdb_cell = 0;
 
   if (! output.empty ()) {
-    output_layout.reset (new db::Layout ());
-    output_top = output_layout->add_cell ("XOR");
+
+    std::string ext = tl::to_lower_case (tl::extension_last (output));
+
+    if (ext == "lyrdb" || ext == "rdb") {
+
+      output_rdb.reset (new rdb::Database ());
+      output_rdb->set_generator ("strmxor");
+      output_rdb->set_description ("XOR differences of " + infile_a + " vs. " + infile_b);
+      output_rdb->set_top_cell_name (top_a);
+      output_rdb_cell = output_rdb->create_cell (top_a)->id ();
+
+    } else {
+
+      db::SaveLayoutOptions save_options;
+      save_options.set_format_from_filename (output);
+      save_options.set_zlib_threads (zlib_threads);
+
+      if (! deep && db::StreamingWriter::supports_format (save_options.format ())) {
+
+        //  in tiling mode, the differences are written as they are produced
+        output_stream.reset (new tl::OutputStream (output, tl::OutputStream::OM_Auto, false, save_options.zlib_threads ()));
+        output_writer.reset (new db::StreamingWriter (*output_stream, save_options, std::min (layout_a.dbu (), layout_b.dbu ())));
+        output_writer->begin_cell ("XOR");
+
+      } else {
+        output_layout.reset (new db::Layout ());
+        output_top = output_layout->add_cell ("XOR");
+      }
+
+    }
+
   }
 
   std::map<std::pair<int, db::LayerProperties>, ResultDescriptor> results;
@@ -330,8 +558,12 @@ BD_PUBLIC int strmxor (int argc, char *argv[])
   xor_data.no_summary = no_summary;
   xor_data.threads = threads;
   xor_data.tile_size = tile_size;
+  xor_data.max_count = size_t (std::max (0, max_count));
   xor_data.output_layout = output_layout.get ();
   xor_data.output_cell = output_top;
+  xor_data.output_writer = output_writer.get ();
+  xor_data.output_rdb = output_rdb.get ();
+  xor_data.output_rdb_cell = output_rdb_cell;
   xor_data.l2l_map = l2l_map;
   xor_data.results = &results;
 
@@ -351,11 +583,24 @@ BD_PUBLIC int strmxor (int argc, char *argv[])
 
     db::SaveLayoutOptions save_options;
     save_options.set_format_from_filename (output);
+    save_options.set_zlib_threads (zlib_threads);
 
-    tl::OutputStream stream (output);
+    tl::OutputStream stream (output, tl::OutputStream::OM_Auto, false, save_options.zlib_threads ());
     db::Writer writer (save_options);
     writer.write (*output_layout, stream);
+    stream.close ();
+
+  }
 
+  if (output_writer.get ()) {
+    output_writer->finish ();
+    output_writer.reset (0);
+    output_stream->close ();
+    output_stream.reset (0);
+  }
+
+  if (output_rdb.get ()) {
+    output_rdb->save (output);
   }
 
   if (! silent && ! no_summary) {
@@ -390,8 +635,13 @@ BD_PUBLIC int strmxor (int argc, char *argv[])
         } else if (! r->second.is_empty ()) {
           if (r->second.layer_output >= 0 && r->second.layout) {
             out = r->second.layout->get_properties (r->second.layer_output).to_string ();
+          } else if (! r->second.output_name.empty ()) {
+            out = r->second.output_name;
           }
           value = tl::to_string (r->second.count ());
+          if (! deep && max_count > 0 && r->second.count () >= size_t (max_count)) {
+            value += " (stopped)";
+          }
         }
         if (! value.empty ()) {
           tl::info << tl::sprintf (line_format, r->first.second.to_string (), out, value);
@@ -409,6 +659,28 @@ BD_PUBLIC int strmxor (int argc, char *argv[])
 }
 
 
+/**
+ *  @brief Returns true, if the given layers are identical in both layouts
+ *
+ *  Both layers are identical if the hierarchical content of both top cells is the same.
+ *  This check is based on a content hash and is cheap compared to the XOR. It is
+ *  a shortcut for the common case of layouts with few changes. Note that a layer
+ *  is only identical if the hierarchy is the same - a flattened layout
+ *  will not be recognized as identical to the hierarchical original.
+ */
+static bool
+is_identical_layer (const XORData &xor_data, int layer_a, int layer_b)
+{
+  if (layer_a < 0 || layer_b < 0 || fabs (xor_data.layout_a->dbu () - xor_data.layout_b->dbu ()) > 1e-10) {
+    return false;
+  }
+
+  db::SubtreeContentHashes hashes_a (*xor_data.layout_a, (unsigned int) layer_a);
+  db::SubtreeContentHashes hashes_b (*xor_data.layout_b, (unsigned int) layer_b);
+
+  return hashes_a.hash (xor_data.cell_a) == hashes_b.hash (xor_data.cell_b);
+}
+
 bool run_tiled_xor (const XORData &xor_data)
 {
   db::TilingProcessor proc;
@@ -440,7 +712,10 @@ bool run_tiled_xor (const XORData &xor_data)
 
   int index = 1;
 
-  std::list<tl::shared_ptr<CountingReceiver> > counters;
+  XORStopCondition stop (xor_data.max_count);
+  proc.define_function ("_skip", new XORSkipFunction (&stop));
+
+  std::list<tl::shared_ptr<XORResultReceiver> > receivers;
 
   for (std::map<db::LayerProperties, std::pair<int, int> >::const_iterator ll = xor_data.l2l_map.begin (); ll != xor_data.l2l_map.end (); ++ll) {
 
@@ -467,6 +742,32 @@ bool run_tiled_xor (const XORData &xor_data)
 
       }
 
+    } else if (is_identical_layer (xor_data, ll->second.first, ll->second.second)) {
+
+      if (tl::verbosity () >= 20) {
+        tl::log << "Layer " << ll->first.to_string () << " is identical in both layouts - XOR skipped";
+      }
+
+      int tol_index = 0;
+      for (std::vector<double>::const_iterator t = xor_data.tolerances.begin (); t != xor_data.tolerances.end (); ++t) {
+
+        db::LayerProperties lp = ll->first;
+        if (lp.layer >= 0) {
+          lp.layer += tol_index * xor_data.tolerance_bump;
+        }
+
+        ResultDescriptor &result = xor_data.results->insert (std::make_pair (std::make_pair (tol_index, ll->first), ResultDescriptor ())).first->second;
+        result.layer_a = ll->second.first;
+        result.layer_b = ll->second.second;
+        result.layout = xor_data.output_layout;
+        result.top_cell = xor_data.output_cell;
+
+        init_result_output (xor_data, result, lp);
+
+        ++tol_index;
+
+      }
+
     } else {
 
       std::string in_a = "a" + tl::to_string (index);
@@ -502,14 +803,12 @@ bool run_tiled_xor (const XORData &xor_data)
         result.layout = xor_data.output_layout;
         result.top_cell = xor_data.output_cell;
 
-        if (result.layout) {
-          result.layer_output = result.layout->insert_layer (lp);
-          proc.output (out, *result.layout, result.top_cell, result.layer_output);
-        } else {
-          CountingReceiver *counter = new CountingReceiver (&result.shape_count);
-          counters.push_back (tl::shared_ptr<CountingReceiver> (counter));
-          proc.output (out, 0, counter, db::ICplxTrans ());
-        }
+        init_result_output (xor_data, result, lp);
+        stop.add_result (index, &result);
+
+        XORResultReceiver *receiver = new XORResultReceiver (&xor_data, &result, &stop);
+        receivers.push_back (tl::shared_ptr<XORResultReceiver> (receiver));
+        proc.output (out, 0, receiver, db::ICplxTrans ());
 
         if (*t > db::epsilon) {
           expr += "x=x.sized(-round(" + tl::to_string (*t) + "/_dbu)/2).sized(round(" + tl::to_string (*t) + "/_dbu)/2); ";
@@ -520,6 +819,11 @@ bool run_tiled_xor (const XORData &xor_data)
 
       }
 
+      if (xor_data.max_count > 0) {
+        //  skips the computation once the layer has produced enough differences
+        expr = "_skip(" + tl::to_string (index) + ") || (" + expr + "true)";
+      }
+
       if (tl::verbosity () >= 20) {
         tl::log << "Running expression: '" << expr << "' for layer " << ll->first;
       }
@@ -533,7 +837,7 @@ bool run_tiled_xor (const XORData &xor_data)
 
   //  Runs the processor
 
-  if ((! xor_data.silent && ! xor_data.no_summary) || result || xor_data.output_layout) {
+  if ((! xor_data.silent && ! xor_data.no_summary) || result || xor_data.output_layout || xor_data.output_writer || xor_data.output_rdb) {
     proc.execute ("Running XOR");
   }
 
@@ -545,13 +849,226 @@ bool run_tiled_xor (const XORData &xor_data)
   return result;
 }
 
-bool run_deep_xor (const XORData &xor_data)
+/**
+ *  @brief The output of a deep XOR task
+ *
+ *  The XOR results refer to the deep shape store, so the store is kept together with
+ *  the results. The results are declared after the store, so they are destroyed first.
+ */
+struct DeepXOROutput
 {
   db::DeepShapeStore dss;
-  dss.set_threads (xor_data.threads);
+  std::vector<db::Region> xor_results;
+};
+
+/**
+ *  @brief Collects the output of the deep XOR tasks
+ *
+ *  The cell names of the output layout depend on the order in which the layers are
+ *  inserted. Hence the output of the tasks is kept until it can be delivered in the order
+ *  the tasks have been scheduled. The delivery happens in the thread running the job, so
+ *  the workers never need to wait for each other.
+ */
+class DeepXOROutputCollector
+{
+public:
+  DeepXOROutputCollector ()
+    : m_replayed (0)
+  {
+    //  .. nothing yet ..
+  }
+
+  ~DeepXOROutputCollector ()
+  {
+    for (std::vector<DeepXOROutput *>::iterator o = m_outputs.begin (); o != m_outputs.end (); ++o) {
+      delete *o;
+    }
+    m_outputs.clear ();
+  }
+
+  /**
+   *  @brief Registers a task with the given result descriptors
+   *
+   *  Returns the sequence number of the task. The output is delivered in the order of the sequence numbers.
+   */
+  size_t add_task (const std::vector<ResultDescriptor *> &results)
+  {
+    m_results.push_back (results);
+    m_outputs.push_back (0);
+    return m_outputs.size () - 1;
+  }
+
+  void task_finished (size_t seq, DeepXOROutput *output)
+  {
+    tl::MutexLocker locker (&m_lock);
+    m_outputs [seq] = output;
+  }
+
+  void replay_finished (const XORData &xor_data);
+
+private:
+  std::vector<std::vector<ResultDescriptor *> > m_results;
+  std::vector<DeepXOROutput *> m_outputs;
+  size_t m_replayed;
+  tl::Mutex m_lock;
+};
+
+/**
+ *  @brief A task for the deep XOR: computes the XOR for one layer
+ */
+class DeepXORTask
+  : public tl::Task
+{
+public:
+  DeepXORTask (const XORData *xor_data, const db::LayerProperties &lp, int layer_a, int layer_b, size_t seq, DeepXOROutputCollector *collector)
+    : xor_data (xor_data), lp (lp), layer_a (layer_a), layer_b (layer_b), threads (1), seq (seq), collector (collector)
+  {
+    //  .. nothing yet ..
+  }
+
+  const XORData *xor_data;
+  db::LayerProperties lp;
+  int layer_a, layer_b;
+  int threads;
+  size_t seq;
+  DeepXOROutputCollector *collector;
+};
+
+/**
+ *  @brief The worker for the deep XOR
+ *
+ *  Each layer uses a separate deep shape store. The input layouts are only read.
+ *  The output is handed over to the collector which delivers it in the order of the layers.
+ */
+class DeepXORWorker
+  : public tl::Worker
+{
+public:
+  DeepXORWorker ()
+    : tl::Worker ()
+  {
+    //  .. nothing yet ..
+  }
+
+  void perform_task (tl::Task *task)
+  {
+    DeepXORTask *xor_task = dynamic_cast<DeepXORTask *> (task);
+    if (xor_task) {
+      do_perform (xor_task);
+    }
+  }
+
+private:
+  void do_perform (const DeepXORTask *task);
+  void do_xor (const DeepXORTask *task, db::DeepShapeStore &dss, std::vector<db::Region> &xor_results);
+};
+
+void
+DeepXORWorker::do_xor (const DeepXORTask *task, db::DeepShapeStore &dss, std::vector<db::Region> &xor_results)
+{
+  const XORData &xor_data = *task->xor_data;
 
   double dbu = std::min (xor_data.layout_a->dbu (), xor_data.layout_b->dbu ());
 
+  if (is_identical_layer (xor_data, task->layer_a, task->layer_b)) {
+
+    if (tl::verbosity () >= 20) {
+      tl::log << "Layer " << task->lp.to_string () << " is identical in both layouts - XOR skipped";
+    }
+
+    xor_results.resize (xor_data.tolerances.size (), db::Region ());
+    return;
+
+  }
+
+  db::RecursiveShapeIterator ri_a, ri_b;
+
+  if (task->layer_a >= 0) {
+    ri_a = db::RecursiveShapeIterator (*xor_data.layout_a, xor_data.layout_a->cell (xor_data.cell_a), task->layer_a);
+  }
+
+  if (task->layer_b >= 0) {
+    ri_b = db::RecursiveShapeIterator (*xor_data.layout_b, xor_data.layout_b->cell (xor_data.cell_b), task->layer_b);
+  }
+
+  db::Region in_a (ri_a, dss, db::ICplxTrans (xor_data.layout_a->dbu () / dbu));
+  db::Region in_b (ri_b, dss, db::ICplxTrans (xor_data.layout_b->dbu () / dbu));
+
+  db::Region xor_res;
+  xor_res = in_a ^ in_b;
+
+  for (std::vector<double>::const_iterator t = xor_data.tolerances.begin (); t != xor_data.tolerances.end (); ++t) {
+
+    if (tl::verbosity () >= 20) {
+      tl::log << "Running XOR on layer " << task->lp.to_string () << " with tolerance " << *t;
+    }
+
+    if (*t > db::epsilon) {
+      xor_res.size (-db::coord_traits<db::Coord>::rounded (0.5 * *t / dbu));
+      xor_res.size (db::coord_traits<db::Coord>::rounded (0.5 * *t / dbu));
+    }
+
+    xor_results.push_back (xor_res);
+
+  }
+}
+
+void
+DeepXORWorker::do_perform (const DeepXORTask *task)
+{
+  std::auto_ptr<DeepXOROutput> output (new DeepXOROutput ());
+  output->dss.set_threads (task->threads);
+
+  do_xor (task, output->dss, output->xor_results);
+
+  task->collector->task_finished (task->seq, output.release ());
+}
+
+void
+DeepXOROutputCollector::replay_finished (const XORData &xor_data)
+{
+  double dbu = std::min (xor_data.layout_a->dbu (), xor_data.layout_b->dbu ());
+
+  while (m_replayed < m_outputs.size ()) {
+
+    std::auto_ptr<DeepXOROutput> output;
+
+    {
+      tl::MutexLocker locker (&m_lock);
+      if (! m_outputs [m_replayed]) {
+        break;
+      }
+      //  a finished output is no longer accessed by the workers
+      output.reset (m_outputs [m_replayed]);
+      m_outputs [m_replayed] = 0;
+    }
+
+    const std::vector<ResultDescriptor *> &results = m_results [m_replayed];
+    ++m_replayed;
+
+    for (size_t i = 0; i < output->xor_results.size (); ++i) {
+
+      ResultDescriptor &result = *results [i];
+      const db::Region &xor_res = output->xor_results [i];
+
+      if (xor_data.output_layout) {
+        xor_res.insert_into (xor_data.output_layout, xor_data.output_cell, result.layer_output);
+      } else if (xor_data.output_rdb) {
+        rdb::create_items_from_region (xor_data.output_rdb, xor_data.output_rdb_cell, result.rdb_category, db::CplxTrans (dbu), xor_res);
+        result.shape_count = xor_res.size ();
+      } else {
+        result.shape_count = xor_res.size ();
+      }
+
+    }
+
+  }
+}
+
+bool run_deep_xor (const XORData &xor_data)
+{
+  double dbu = std::min (xor_data.layout_a->dbu (), xor_data.layout_b->dbu ());
+
   if (tl::verbosity () >= 20) {
     tl::log << "Database unit: " << dbu;
     tl::log << "Threads: " << xor_data.threads;
@@ -562,9 +1079,14 @@ bool run_deep_xor (const XORData &xor_data)
     xor_data.output_layout->dbu (dbu);
   }
 
+  //  the input layouts are read from multiple threads, so they need to be up to date
+  xor_data.layout_a->update ();
+  xor_data.layout_b->update ();
+
   bool result = true;
 
-  int index = 1;
+  DeepXOROutputCollector collector;
+  std::vector<DeepXORTask *> tasks;
 
   for (std::map<db::LayerProperties, std::pair<int, int> >::const_iterator ll = xor_data.l2l_map.begin (); ll != xor_data.l2l_map.end (); ++ll) {
 
@@ -593,29 +1115,12 @@ bool run_deep_xor (const XORData &xor_data)
 
     } else {
 
-      db::RecursiveShapeIterator ri_a, ri_b;
-
-      if (ll->second.first >= 0) {
-        ri_a = db::RecursiveShapeIterator (*xor_data.layout_a, xor_data.layout_a->cell (xor_data.cell_a), ll->second.first);
-      }
-
-      if (ll->second.second >= 0) {
-        ri_b = db::RecursiveShapeIterator (*xor_data.layout_b, xor_data.layout_b->cell (xor_data.cell_b), ll->second.second);
-      }
-
-      db::Region in_a (ri_a, dss, db::ICplxTrans (xor_data.layout_a->dbu () / dbu));
-      db::Region in_b (ri_b, dss, db::ICplxTrans (xor_data.layout_b->dbu () / dbu));
-
-      db::Region xor_res;
-      xor_res = in_a ^ in_b;
+      //  the results and output layers are created here, so the workers don't need to
+      std::vector<ResultDescriptor *> results;
 
       int tol_index = 0;
       for (std::vector<double>::const_iterator t = xor_data.tolerances.begin (); t != xor_data.tolerances.end (); ++t) {
 
-        if (tl::verbosity () >= 20) {
-          tl::log << "Running XOR on layer " << ll->first.to_string () << " with tolerance " << *t;
-        }
-
         db::LayerProperties lp = ll->first;
         if (lp.layer >= 0) {
           lp.layer += tol_index * xor_data.tolerance_bump;
@@ -627,28 +1132,56 @@ bool run_deep_xor (const XORData &xor_data)
         result.layout = xor_data.output_layout;
         result.top_cell = xor_data.output_cell;
 
-        if (*t > db::epsilon) {
-          xor_res.size (-db::coord_traits<db::Coord>::rounded (0.5 * *t / dbu));
-          xor_res.size (db::coord_traits<db::Coord>::rounded (0.5 * *t / dbu));
-        }
-
-        if (xor_data.output_layout) {
-          result.layer_output = result.layout->insert_layer (lp);
-          xor_res.insert_into (xor_data.output_layout, xor_data.output_cell, result.layer_output);
-        } else {
-          result.shape_count = xor_res.size ();
-        }
+        init_result_output (xor_data, result, lp);
+        results.push_back (&result);
 
         ++tol_index;
 
       }
 
+      tasks.push_back (new DeepXORTask (&xor_data, ll->first, ll->second.first, ll->second.second, collector.add_task (results), &collector));
+
     }
 
-    ++index;
+  }
+
+  //  Distributes the threads: layers are computed in parallel and the remaining
+  //  threads are given to the hierarchical processor of each layer
+
+  int threads = std::max (1, xor_data.threads);
+  int layer_threads = std::min (threads, int (tasks.size ()));
+  int threads_per_layer = std::max (1, threads / std::max (1, layer_threads));
+
+  if (tl::verbosity () >= 20) {
+    tl::log << "Layers computed in parallel: " << layer_threads;
+    tl::log << "Threads per layer: " << threads_per_layer;
+  }
+
+  tl::Job<DeepXORWorker> job (layer_threads > 1 ? layer_threads : 0);
+
+  for (std::vector<DeepXORTask *>::const_iterator t = tasks.begin (); t != tasks.end (); ++t) {
+    (*t)->threads = threads_per_layer;
+    job.schedule (*t);
+  }
 
+  //  the output is delivered while the job is running, so finished results don't pile up
+  try {
+    job.start ();
+    while (job.is_running ()) {
+      collector.replay_finished (xor_data);
+      job.wait (100);
+    }
+  } catch (...) {
+    job.terminate ();
+    throw;
+  }
+
+  if (job.has_error ()) {
+    throw tl::Exception (job.error_messages ().front ());
   }
 
+  collector.replay_finished (xor_data);
+
   //  Determines the output status
   for (std::map<std::pair<int, db::LayerProperties>, ResultDescriptor>::const_iterator r = xor_data.results->begin (); r != xor_data.results->end () && result; ++r) {
     result = r->second.is_empty ();
@@ -43,6 +43,7 @@ TEST(1)
                    "--drop-empty-cells",
                    "--keep-instances",
                    "--no-context-info",
+                   "--zlib-threads=3",
                    //  CIF
                    "--blank-separator",
                    "--dummy-calls",
@@ -74,6 +75,7 @@ TEST(1)
   EXPECT_EQ (stream_opt.dont_write_empty_cells (), false);
   EXPECT_EQ (stream_opt.keep_instances (), false);
   EXPECT_EQ (stream_opt.write_context_info (), true);
+  EXPECT_EQ (stream_opt.zlib_threads (), (unsigned int) 0);
   EXPECT_EQ (stream_opt.get_option_by_name ("cif_blank_separator").to_bool (), false);
   EXPECT_EQ (stream_opt.get_option_by_name ("cif_dummy_calls").to_bool (), false);
   EXPECT_EQ (stream_opt.get_option_by_name ("dxf_polygon_mode").to_int (), 0);
@@ -99,6 +101,7 @@ TEST(1)
   EXPECT_EQ (stream_opt.dont_write_empty_cells (), true);
   EXPECT_EQ (stream_opt.keep_instances (), true);
   EXPECT_EQ (stream_opt.write_context_info (), false);
+  EXPECT_EQ (stream_opt.zlib_threads (), (unsigned int) 3);
   EXPECT_EQ (stream_opt.get_option_by_name ("cif_blank_separator").to_bool (), true);
   EXPECT_EQ (stream_opt.get_option_by_name ("cif_dummy_calls").to_bool (), true);
   EXPECT_EQ (stream_opt.get_option_by_name ("dxf_polygon_mode").to_int (), 2);
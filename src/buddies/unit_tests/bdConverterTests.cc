@@ -26,6 +26,7 @@
 #include "dbTestSupport.h"
 #include "dbReader.h"
 #include "tlUnitTest.h"
+#include "tlParallelGZip.h"
 
 //  Testing the converter main implementation (CIF)
 TEST(1)
@@ -186,3 +187,33 @@ TEST(6)
 
   db::compare_layouts (this, layout, input_au, db::WriteGDS2);
 }
+
+//  Testing the converter main implementation (OASIS, gzip-compressed with multiple threads)
+TEST(7)
+{
+  std::string input = tl::testsrc ();
+  input += "/testdata/gds/t10.gds";
+
+  std::string output = this->tmp_file ("t10.oas.gz");
+
+  const char *argv[] = { "x", input.c_str (), output.c_str (), "--zlib-threads=2" };
+
+  EXPECT_EQ (bd::converter_main (sizeof (argv) / sizeof (argv[0]), (char **) argv, bd::GenericWriterOptions::oasis_format_name), 0);
+
+  //  files compressed in parallel carry a block index
+  std::vector<tl::ParallelGZipIndexEntry> index;
+  unsigned long crc = 0, size = 0;
+  EXPECT_EQ (tl::ParallelGZipReader::read_index (output, index, crc, size), true);
+
+  db::Layout layout;
+
+  {
+    tl::InputStream stream (output, 2);
+    db::LoadLayoutOptions options;
+    db::Reader reader (stream);
+    reader.read (layout, options);
+    EXPECT_EQ (reader.format (), "OASIS");
+  }
+
+  db::compare_layouts (this, layout, input, db::NoNormalization);
+}
@@ -181,6 +181,35 @@ TEST(2F)
   );
 }
 
+TEST(2G)
+{
+  tl::CaptureChannel cap;
+
+  std::string input_a = tl::testsrc ();
+  input_a += "/testdata/bd/strmcmp_in.gds";
+
+  std::string input_b = tl::testsrc ();
+  input_b += "/testdata/bd/strmcmp_ref2.gds";
+
+  const char *argv[] = { "x", "-n=4", input_a.c_str (), input_b.c_str () };
+
+  EXPECT_EQ (strmcmp (sizeof (argv) / sizeof (argv[0]), (char **) argv), 1);
+
+  EXPECT_EQ (cap.captured_text (),
+    "Boxes differ for layer 8/0 in cell RINGO\n"
+    "Not in b but in a:\n"
+    "  (-1720,1600;23160,2000)\n"
+    "Not in a but in b:\n"
+    "  (-1520,1600;23160,2000)\n"
+    "Texts differ for layer 8/1 in cell RINGO\n"
+    "Not in b but in a:\n"
+    "  ('FB',r0 0,1800)\n"
+    "Not in a but in b:\n"
+    "  ('BF',r0 0,1800)\n"
+    "Layouts differ\n"
+  );
+}
+
 TEST(3A)
 {
   tl::CaptureChannel cap;
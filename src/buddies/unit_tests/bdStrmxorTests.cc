@@ -23,6 +23,7 @@
 #include "bdCommon.h"
 #include "dbReader.h"
 #include "dbTestSupport.h"
+#include "rdb.h"
 #include "tlLog.h"
 #include "tlUnitTest.h"
 
@@ -624,3 +625,156 @@ TEST(6_Deep)
     "Layer 10/0 is not present in first layout, but in second\n"
   );
 }
+
+TEST(7_Flat)
+{
+  tl::CaptureChannel cap;
+
+  std::string input_a = tl::testsrc ();
+  input_a += "/testdata/bd/strmxor_in1.gds";
+
+  std::string input_b = tl::testsrc ();
+  input_b += "/testdata/bd/strmxor_in2.gds";
+
+  //  stops after one difference per layer
+  const char *argv[] = { "x", "-m=1", "-p=1.0", "-n=4", input_a.c_str (), input_b.c_str () };
+
+  EXPECT_EQ (strmxor (sizeof (argv) / sizeof (argv[0]), (char **) argv), 1);
+
+  std::string text = cap.captured_text ();
+  EXPECT_EQ (text.find ("  3/0        -            ") != std::string::npos, true);
+  EXPECT_EQ (text.find ("  6/0        -            ") != std::string::npos, true);
+  EXPECT_EQ (text.find (" (stopped)\n") != std::string::npos, true);
+}
+
+TEST(8_Flat)
+{
+  tl::CaptureChannel cap;
+
+  std::string input_a = tl::testsrc ();
+  input_a += "/testdata/bd/strmxor_in1.gds";
+
+  std::string input_b = tl::testsrc ();
+  input_b += "/testdata/bd/strmxor_in2.gds";
+
+  std::string output = this->tmp_file ("tmp.lyrdb");
+
+  const char *argv[] = { "x", "--no-summary", "-p=1.0", "-n=4", input_a.c_str (), input_b.c_str (), output.c_str () };
+
+  EXPECT_EQ (strmxor (sizeof (argv) / sizeof (argv[0]), (char **) argv), 1);
+
+  rdb::Database rdb;
+  rdb.load (output);
+
+  EXPECT_EQ (rdb.category_by_name ("'3/0'") != 0, true);
+  EXPECT_EQ (rdb.category_by_name ("'3/0'")->num_items () > 0, true);
+  EXPECT_EQ (rdb.category_by_name ("'6/0'") != 0, true);
+  EXPECT_EQ (rdb.category_by_name ("'6/0'")->num_items () > 0, true);
+  EXPECT_EQ (rdb.category_by_name ("'8/1'") != 0, true);
+  EXPECT_EQ (rdb.category_by_name ("'8/1'")->num_items () > 0, true);
+  EXPECT_EQ (rdb.category_by_name ("'1/0'") != 0, true);
+  EXPECT_EQ (rdb.category_by_name ("'1/0'")->num_items (), size_t (0));
+}
+
+TEST(8_Deep)
+{
+  tl::CaptureChannel cap;
+
+  std::string input_a = tl::testsrc ();
+  input_a += "/testdata/bd/strmxor_in1.gds";
+
+  std::string input_b = tl::testsrc ();
+  input_b += "/testdata/bd/strmxor_in2.gds";
+
+  std::string output = this->tmp_file ("tmp.lyrdb");
+
+  const char *argv[] = { "x", "-u", "-n=4", input_a.c_str (), input_b.c_str (), output.c_str () };
+
+  EXPECT_EQ (strmxor (sizeof (argv) / sizeof (argv[0]), (char **) argv), 1);
+
+  rdb::Database rdb;
+  rdb.load (output);
+
+  EXPECT_EQ (rdb.category_by_name ("'3/0'") != 0, true);
+  EXPECT_EQ (rdb.category_by_name ("'3/0'")->num_items (), size_t (30));
+  EXPECT_EQ (rdb.category_by_name ("'6/0'") != 0, true);
+  EXPECT_EQ (rdb.category_by_name ("'6/0'")->num_items (), size_t (314));
+  EXPECT_EQ (rdb.category_by_name ("'8/1'") != 0, true);
+  EXPECT_EQ (rdb.category_by_name ("'8/1'")->num_items (), size_t (1));
+
+  EXPECT_EQ (cap.captured_text (),
+    "Layer 10/0 is not present in first layout, but in second\n"
+    "Result summary (layers without differences are not shown):\n"
+    "\n"
+    "  Layer      Output       Differences (shape count)\n"
+    "  -------------------------------------------------------\n"
+    "  3/0        3/0          30\n"
+    "  6/0        6/0          314\n"
+    "  8/1        8/1          1\n"
+    "  10/0       -            (no such layer in first layout)\n"
+    "\n"
+  );
+}
+
+//  identical layers are skipped, but still deliver their (empty) results
+TEST(9_Flat)
+{
+  tl::CaptureChannel cap;
+
+  std::string input_a = tl::testsrc ();
+  input_a += "/testdata/bd/strmxor_in1.gds";
+
+  std::string input_b = tl::testsrc ();
+  input_b += "/testdata/bd/strmxor_in1.gds";
+
+  std::string output = this->tmp_file ("tmp.lyrdb");
+
+  const char *argv[] = { "x", "-p=1.0", "-n=4", input_a.c_str (), input_b.c_str (), output.c_str () };
+
+  EXPECT_EQ (strmxor (sizeof (argv) / sizeof (argv[0]), (char **) argv), 0);
+
+  rdb::Database rdb;
+  rdb.load (output);
+
+  EXPECT_EQ (rdb.category_by_name ("'1/0'") != 0, true);
+  EXPECT_EQ (rdb.category_by_name ("'1/0'")->num_items (), size_t (0));
+  EXPECT_EQ (rdb.category_by_name ("'3/0'") != 0, true);
+  EXPECT_EQ (rdb.category_by_name ("'3/0'")->num_items (), size_t (0));
+  EXPECT_EQ (rdb.category_by_name ("'6/0'") != 0, true);
+  EXPECT_EQ (rdb.category_by_name ("'6/0'")->num_items (), size_t (0));
+
+  EXPECT_EQ (cap.captured_text (),
+    "No differences found\n"
+  );
+}
+
+TEST(9_Deep)
+{
+  tl::CaptureChannel cap;
+
+  std::string input_a = tl::testsrc ();
+  input_a += "/testdata/bd/strmxor_in1.gds";
+
+  std::string input_b = tl::testsrc ();
+  input_b += "/testdata/bd/strmxor_in1.gds";
+
+  std::string output = this->tmp_file ("tmp.lyrdb");
+
+  const char *argv[] = { "x", "-u", "-n=4", input_a.c_str (), input_b.c_str (), output.c_str () };
+
+  EXPECT_EQ (strmxor (sizeof (argv) / sizeof (argv[0]), (char **) argv), 0);
+
+  rdb::Database rdb;
+  rdb.load (output);
+
+  EXPECT_EQ (rdb.category_by_name ("'1/0'") != 0, true);
+  EXPECT_EQ (rdb.category_by_name ("'1/0'")->num_items (), size_t (0));
+  EXPECT_EQ (rdb.category_by_name ("'3/0'") != 0, true);
+  EXPECT_EQ (rdb.category_by_name ("'3/0'")->num_items (), size_t (0));
+  EXPECT_EQ (rdb.category_by_name ("'6/0'") != 0, true);
+  EXPECT_EQ (rdb.category_by_name ("'6/0'")->num_items (), size_t (0));
+
+  EXPECT_EQ (cap.captured_text (),
+    "No differences found\n"
+  );
+}
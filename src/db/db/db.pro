@@ -20,6 +20,7 @@ SOURCES = \
   dbClipboardData.cc \
   dbClip.cc \
   dbCommonReader.cc \
+  dbContentHash.cc \
   dbEdge.cc \
   dbEdgePair.cc \
   dbEdgePairRelations.cc \
@@ -79,6 +80,7 @@ SOURCES = \
   dbUserObject.cc \
   dbVector.cc \
   dbWriter.cc \
+  dbStreamingWriter.cc \
   dbWriterTools.cc \
   dbVariableWidthPath.cc \
   dbNamedLayerReader.cc \
@@ -197,7 +199,10 @@ SOURCES = \
     dbNetShape.cc \
     dbShapeCollection.cc \
     gsiDeclDbShapeCollection.cc \
-    dbShapeCollectionUtils.cc
+    dbShapeCollectionUtils.cc \
+    dbCoordinateArrays.cc \
+    dbShapeBatch.cc \
+    gsiDeclDbCoordinateArrays.cc
 
 HEADERS = \
   dbArray.h \
@@ -214,6 +219,7 @@ HEADERS = \
   dbClipboard.h \
   dbClip.h \
   dbCommonReader.h \
+  dbContentHash.h \
   dbEdge.h \
   dbEdgePair.h \
   dbEdgePairRelations.h \
@@ -278,6 +284,7 @@ HEADERS = \
   dbUserObject.h \
   dbVector.h \
   dbWriter.h \
+  dbStreamingWriter.h \
   dbWriterTools.h \
   dbGlyphs.h \
   dbCommon.h \
@@ -355,7 +362,9 @@ HEADERS = \
     dbOriginalLayerTexts.h \
     dbNetShape.h \
     dbShapeCollection.h \
-    dbShapeCollectionUtils.h
+    dbShapeCollectionUtils.h \
+    dbCoordinateArrays.h \
+    dbShapeBatch.h
 
 !equals(HAVE_QT, "0") {
 
@@ -27,6 +27,7 @@
 #include "dbCommon.h"
 
 #include "dbEdgePairsDelegate.h"
+#include "tlThreads.h"
 
 namespace db {
 
@@ -83,6 +84,7 @@ private:
 
   mutable bool m_bbox_valid;
   mutable db::Box m_bbox;
+  mutable tl::Mutex m_bbox_lock;
 
   virtual db::Box compute_bbox () const;
 };
@@ -398,6 +398,9 @@ AsIfFlatEdges::length (const db::Box &box) const
 
 Box AsIfFlatEdges::bbox () const
 {
+  //  NOTE: the lock allows using the object from multiple threads
+  tl::MutexLocker locker (&m_bbox_lock);
+
   if (! m_bbox_valid) {
     m_bbox = compute_bbox ();
     m_bbox_valid = true;
@@ -30,6 +30,7 @@
 #include "dbEdgeBoolean.h"
 #include "dbBoxScanner.h"
 #include "dbPolygonTools.h"
+#include "tlThreads.h"
 
 #include <map>
 #include <vector>
@@ -191,6 +192,7 @@ protected:
 private:
   mutable bool m_bbox_valid;
   mutable db::Box m_bbox;
+  mutable tl::Mutex m_bbox_lock;
 
   virtual db::Box compute_bbox () const;
   EdgesDelegate *boolean (const Edges *other, EdgeBoolOp op) const;
@@ -228,6 +228,9 @@ AsIfFlatRegion::perimeter (const db::Box &box) const
 
 Box AsIfFlatRegion::bbox () const
 {
+  //  NOTE: the lock allows using the object from multiple threads
+  tl::MutexLocker locker (&m_bbox_lock);
+
   if (! m_bbox_valid) {
     m_bbox = compute_bbox ();
     m_bbox_valid = true;
@@ -31,6 +31,7 @@
 #include "dbEdge.h"
 #include "dbBoxScanner.h"
 #include "dbEdgePairRelations.h"
+#include "tlThreads.h"
 
 #include <set>
 
@@ -279,6 +280,7 @@ private:
 
   mutable bool m_bbox_valid;
   mutable db::Box m_bbox;
+  mutable tl::Mutex m_bbox_lock;
 
   virtual db::Box compute_bbox () const;
   static RegionDelegate *region_from_box (const db::Box &b);
@@ -117,6 +117,9 @@ AsIfFlatTexts::size () const
 
 Box AsIfFlatTexts::bbox () const
 {
+  //  NOTE: the lock allows using the object from multiple threads
+  tl::MutexLocker locker (&m_bbox_lock);
+
   if (! m_bbox_valid) {
     m_bbox = compute_bbox ();
     m_bbox_valid = true;
@@ -27,6 +27,7 @@
 #include "dbCommon.h"
 
 #include "dbTextsDelegate.h"
+#include "tlThreads.h"
 
 namespace db {
 
@@ -87,6 +88,7 @@ private:
 
   mutable bool m_bbox_valid;
   mutable db::Box m_bbox;
+  mutable tl::Mutex m_bbox_lock;
 
   virtual db::Box compute_bbox () const;
   virtual TextsDelegate *selected_interacting_generic (const Region &other, bool inverse) const;
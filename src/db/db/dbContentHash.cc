@@ -0,0 +1,261 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "dbContentHash.h"
+#include "dbShape.h"
+#include "dbShapes.h"
+#include "dbLayout.h"
+#include "dbLayoutUtils.h"
+
+namespace db
+{
+
+// ------------------------------------------------------------------
+//  ContentHash implementation
+
+void
+ContentHash::add (const char *s)
+{
+  uint64_t n = 0;
+  for ( ; *s; ++s, ++n) {
+    add (uint64_t ((unsigned char) *s));
+  }
+  add (n);
+}
+
+void
+ContentHash::add (const db::ICplxTrans &t)
+{
+  add (uint64_t (t.is_mirror ()));
+  add (t.angle (), db::epsilon);
+  add (t.mag (), db::epsilon);
+  add (t.disp ().x (), db::coord_traits<db::DCoord>::prec ());
+  add (t.disp ().y (), db::coord_traits<db::DCoord>::prec ());
+}
+
+// ------------------------------------------------------------------
+//  Content hash functions
+
+namespace
+{
+
+//  Tags for the shape categories
+enum {
+  ht_polygon = 1,
+  ht_path,
+  ht_box,
+  ht_edge,
+  ht_edge_pair,
+  ht_text,
+  ht_user_object
+};
+
+}
+
+static void
+add_contour (db::ContentHash &h, const db::Polygon::contour_type &c)
+{
+  h.add (uint64_t (c.size ()));
+  for (db::Polygon::contour_type::simple_iterator p = c.begin (); p != c.end (); ++p) {
+    h.add (*p);
+  }
+}
+
+uint64_t
+shape_content_hash (const db::Shape &shape)
+{
+  db::ContentHash h;
+
+  if (shape.is_polygon ()) {
+
+    db::Polygon poly;
+    shape.polygon (poly);
+
+    h.add (uint64_t (ht_polygon));
+    h.add (uint64_t (poly.holes ()));
+    add_contour (h, poly.hull ());
+    for (unsigned int i = 0; i < poly.holes (); ++i) {
+      add_contour (h, poly.hole (i));
+    }
+
+  } else if (shape.is_path ()) {
+
+    db::Path path;
+    shape.path (path);
+
+    h.add (uint64_t (ht_path));
+    h.add_coord (path.width ());
+    h.add_coord (path.bgn_ext ());
+    h.add_coord (path.end_ext ());
+    h.add (uint64_t (path.round ()));
+    h.add (uint64_t (path.points ()));
+    for (db::Path::iterator p = path.begin (); p != path.end (); ++p) {
+      h.add (*p);
+    }
+
+  } else if (shape.is_box ()) {
+
+    db::Box box = shape.box ();
+
+    h.add (uint64_t (ht_box));
+    h.add (box.p1 ());
+    h.add (box.p2 ());
+
+  } else if (shape.is_edge ()) {
+
+    db::Edge edge;
+    shape.edge (edge);
+
+    h.add (uint64_t (ht_edge));
+    h.add (edge.p1 ());
+    h.add (edge.p2 ());
+
+  } else if (shape.is_edge_pair ()) {
+
+    db::EdgePair ep;
+    shape.edge_pair (ep);
+
+    h.add (uint64_t (ht_edge_pair));
+    h.add (ep.first ().p1 ());
+    h.add (ep.first ().p2 ());
+    h.add (ep.second ().p1 ());
+    h.add (ep.second ().p2 ());
+
+  } else if (shape.is_text ()) {
+
+    db::Text text;
+    shape.text (text);
+
+    h.add (uint64_t (ht_text));
+    h.add (text.string ());
+    h.add (uint64_t (text.trans ().rot ()));
+    h.add (text.trans ().disp ());
+    h.add_coord (text.size ());
+    h.add (uint64_t (int64_t (text.font ())));
+    h.add (uint64_t (int64_t (text.halign ())));
+    h.add (uint64_t (int64_t (text.valign ())));
+
+  } else if (shape.is_user_object ()) {
+
+    //  user objects are opaque - use their identity
+    h.add (uint64_t (ht_user_object));
+    h.add (uint64_t (size_t (shape.basic_ptr (db::Shape::user_object_type::tag ()))));
+
+  }
+
+  return h.value ();
+}
+
+uint64_t
+shapes_content_hash (const db::Shapes &shapes, db::PropertyMapper *pm)
+{
+  //  The sum of the mixed shape hashes does not depend on the order of the shapes
+  uint64_t h = 0;
+
+  for (db::ShapeIterator s = shapes.begin (db::ShapeIterator::All); ! s.at_end (); ++s) {
+
+    uint64_t hs = shape_content_hash (*s);
+    if (pm) {
+      hs = db::ContentHash::mix (hs ^ db::ContentHash::mix (uint64_t ((*pm) (s->prop_id ()))));
+    } else {
+      hs = db::ContentHash::mix (hs);
+    }
+
+    h += hs;
+
+  }
+
+  return h;
+}
+
+uint64_t
+inst_content_hash (const db::CellInstArray &inst, uint64_t child)
+{
+  db::ContentHash h;
+  h.add (child);
+
+  db::Vector a, b;
+  unsigned long na = 1, nb = 1;
+  if (inst.is_regular_array (a, b, na, nb)) {
+
+    h.add (uint64_t (1));
+    h.add (a);
+    h.add (b);
+    h.add (uint64_t (na));
+    h.add (uint64_t (nb));
+    h.add (inst.complex_trans ());
+
+  } else if (inst.size () > 1) {
+
+    //  iterated array: include all members
+    h.add (uint64_t (2));
+    h.add (uint64_t (inst.size ()));
+    for (db::CellInstArray::iterator i = inst.begin (); ! i.at_end (); ++i) {
+      h.add (inst.complex_trans (*i));
+    }
+
+  } else {
+
+    h.add (uint64_t (0));
+    h.add (inst.complex_trans ());
+
+  }
+
+  return h.value ();
+}
+
+// ------------------------------------------------------------------
+//  SubtreeContentHashes implementation
+
+SubtreeContentHashes::SubtreeContentHashes (const db::Layout &layout, unsigned int layer)
+{
+  //  bottom-up order makes sure the child cells are computed before their parents
+  for (db::Layout::bottom_up_const_iterator c = layout.begin_bottom_up (); c != layout.end_bottom_up (); ++c) {
+
+    const db::Cell &cell = layout.cell (*c);
+
+    uint64_t hs = shapes_content_hash (cell.shapes (layer));
+
+    uint64_t hi = 0;
+    for (db::Cell::const_iterator i = cell.begin (); ! i.at_end (); ++i) {
+      uint64_t hc = hash (i->cell_index ());
+      if (hc != 0) {
+        hi += db::ContentHash::mix (inst_content_hash (i->cell_inst (), hc));
+      }
+    }
+
+    if (hs != 0 || hi != 0) {
+      db::ContentHash h;
+      h.add (hs);
+      h.add (hi);
+      if (*c >= m_hashes.size ()) {
+        m_hashes.resize (*c + 1, 0);
+      }
+      m_hashes [*c] = h.value ();
+    }
+
+  }
+}
+
+}
+
@@ -0,0 +1,211 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#ifndef HDR_dbContentHash
+#define HDR_dbContentHash
+
+#include "dbCommon.h"
+
+#include "dbTypes.h"
+#include "dbPoint.h"
+#include "dbVector.h"
+#include "dbTrans.h"
+#include "dbInstances.h"
+
+#include <string>
+#include <vector>
+#include <cmath>
+#include <stdint.h>
+
+namespace db
+{
+
+class Shape;
+class Shapes;
+class Layout;
+class PropertyMapper;
+
+/**
+ *  @brief A 64 bit hash accumulator for content identity checks
+ *
+ *  Unlike the std::hash specializations from dbHash.h which are intended for hash containers,
+ *  this hash is used to detect identical content: all attributes of an object enter the hash
+ *  and the values are mixed in a non-linear fashion so the probability of collisions is
+ *  negligible. Values are added in sequence, hence the hash depends on the order.
+ */
+class DB_PUBLIC ContentHash
+{
+public:
+  /**
+   *  @brief Creates a hash accumulator
+   */
+  ContentHash ()
+    : m_h (0x9e3779b97f4a7c15ULL)
+  {
+    //  .. nothing yet ..
+  }
+
+  /**
+   *  @brief Adds an integer value
+   */
+  void add (uint64_t v)
+  {
+    m_h = mix (m_h ^ (v + 0x9e3779b97f4a7c15ULL + (m_h << 6) + (m_h >> 2)));
+  }
+
+  /**
+   *  @brief Adds a coordinate
+   */
+  void add_coord (db::Coord c)
+  {
+    add (uint64_t (int64_t (c)));
+  }
+
+  /**
+   *  @brief Adds a point
+   */
+  void add (const db::Point &p)
+  {
+    add_coord (p.x ());
+    add_coord (p.y ());
+  }
+
+  /**
+   *  @brief Adds a vector
+   */
+  void add (const db::Vector &v)
+  {
+    add_coord (v.x ());
+    add_coord (v.y ());
+  }
+
+  /**
+   *  @brief Adds a floating-point value
+   *
+   *  The value is rounded to the given precision.
+   */
+  void add (double d, double prec)
+  {
+    add (uint64_t (int64_t (floor (0.5 + d / prec))));
+  }
+
+  /**
+   *  @brief Adds a string
+   */
+  void add (const char *s);
+
+  /**
+   *  @brief Adds a complex transformation
+   */
+  void add (const db::ICplxTrans &t);
+
+  /**
+   *  @brief Gets the hash value
+   */
+  uint64_t value () const
+  {
+    return m_h;
+  }
+
+  /**
+   *  @brief The mixing function (a bijective 64 bit finalizer)
+   */
+  static uint64_t mix (uint64_t h)
+  {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+  }
+
+private:
+  uint64_t m_h;
+};
+
+/**
+ *  @brief Computes the content hash of a shape
+ *
+ *  The hash covers the geometry and - for texts - the string and the text attributes.
+ *  It does not depend on the representation: a box array member delivers the same hash as
+ *  a plain box and a polygon reference the same hash as a polygon. Properties are not included.
+ */
+DB_PUBLIC uint64_t shape_content_hash (const db::Shape &shape);
+
+/**
+ *  @brief Computes the content hash of a shape container
+ *
+ *  The hash does not depend on the order of the shapes. If a property mapper is given,
+ *  the properties IDs are translated through this mapper and included in the hash. Properties
+ *  are ignored otherwise. The property mapper is intended to normalize the properties IDs
+ *  into a common repository. An empty container gives a hash value of 0.
+ */
+DB_PUBLIC uint64_t shapes_content_hash (const db::Shapes &shapes, db::PropertyMapper *pm = 0);
+
+/**
+ *  @brief Computes the content hash of a cell instance array
+ *
+ *  The hash covers the transformation and the array parameters. The cell the instance
+ *  refers to is represented by "child" - for example a hash of the child cell's content
+ *  or an index which is comparable between layouts.
+ */
+DB_PUBLIC uint64_t inst_content_hash (const db::CellInstArray &inst, uint64_t child);
+
+/**
+ *  @brief Computes geometrical hashes of cell subtrees per layer
+ *
+ *  For each cell, the hash covers the shapes on the given layer in the cell and in all its
+ *  child cells, taking the placement of the child cells into account. Cell names, cell indexes
+ *  and properties do not enter the hash, so the hashes of two layouts can be compared:
+ *  if the hashes of two cells are equal, both cells have an identical hierarchical
+ *  content on that layer. Instances of cells without shapes on the layer are ignored
+ *  and a cell without shapes on the layer in its subtree has a hash value of 0.
+ *
+ *  Note that the hash is sensitive to the hierarchical organization: the same geometry
+ *  in a different hierarchy gives different hashes.
+ */
+class DB_PUBLIC SubtreeContentHashes
+{
+public:
+  /**
+   *  @brief Computes the hashes for all cells of the given layout and the given layer
+   */
+  SubtreeContentHashes (const db::Layout &layout, unsigned int layer);
+
+  /**
+   *  @brief Gets the hash value for the given cell
+   */
+  uint64_t hash (db::cell_index_type ci) const
+  {
+    return ci < m_hashes.size () ? m_hashes [ci] : 0;
+  }
+
+private:
+  std::vector<uint64_t> m_hashes;
+};
+
+}
+
+#endif
+
@@ -0,0 +1,290 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+
+#include "dbCoordinateArrays.h"
+#include "tlInternational.h"
+#include "tlException.h"
+
+#include <limits>
+
+namespace db
+{
+
+template <class T>
+static std::vector<char> pack_le (const std::vector<T> &values, unsigned int width)
+{
+  if (width != 4 && width != 8) {
+    throw tl::Exception (tl::to_string (tr ("Integer width must be 4 or 8 bytes, not %d")), int (width));
+  }
+
+  std::vector<char> data;
+  data.reserve (values.size () * width);
+
+  for (typename std::vector<T>::const_iterator v = values.begin (); v != values.end (); ++v) {
+
+    int64_t i = int64_t (*v);
+    if (width == 4 && (i < int64_t (std::numeric_limits<int32_t>::min ()) || i > int64_t (std::numeric_limits<int32_t>::max ()))) {
+      throw tl::Exception (tl::to_string (tr ("Value %s cannot be represented by a 4 byte integer")), tl::to_string (i));
+    }
+
+    uint64_t u = uint64_t (i);
+    for (unsigned int b = 0; b < width; ++b) {
+      data.push_back (char (u & 0xff));
+      u >>= 8;
+    }
+
+  }
+
+  return data;
+}
+
+template <class T>
+static void unpack_le (const std::vector<char> &data, unsigned int width, std::vector<T> &values)
+{
+  if (width != 4 && width != 8) {
+    throw tl::Exception (tl::to_string (tr ("Integer width must be 4 or 8 bytes, not %d")), int (width));
+  }
+  if ((data.size () % width) != 0) {
+    throw tl::Exception (tl::to_string (tr ("Packed data size (%s bytes) is not a multiple of the integer width (%d)")), tl::to_string (data.size ()), int (width));
+  }
+
+  values.clear ();
+  values.reserve (data.size () / width);
+
+  const unsigned char *d = (const unsigned char *) (data.empty () ? 0 : &data.front ());
+  for (size_t n = data.size () / width; n > 0; --n, d += width) {
+
+    uint64_t u = 0;
+    for (unsigned int b = width; b > 0; ) {
+      --b;
+      u = (u << 8) | uint64_t (d [b]);
+    }
+
+    int64_t i;
+    if (width == 4) {
+      i = int64_t (int32_t (uint32_t (u)));
+    } else {
+      i = int64_t (u);
+    }
+
+    if (i < int64_t (std::numeric_limits<T>::min ()) || (i > 0 && uint64_t (i) > uint64_t (std::numeric_limits<T>::max ()))) {
+      throw tl::Exception (tl::to_string (tr ("Value %s is out of range")), tl::to_string (i));
+    }
+
+    values.push_back (T (i));
+
+  }
+}
+
+std::vector<db::Coord>
+unpack_coordinates (const std::vector<char> &data, unsigned int width)
+{
+  std::vector<db::Coord> coords;
+  unpack_le (data, width, coords);
+  return coords;
+}
+
+CoordinateArrays::CoordinateArrays ()
+{
+  m_contour_offsets.push_back (0);
+  m_polygon_offsets.push_back (0);
+}
+
+CoordinateArrays::CoordinateArrays (const std::vector<coord_type> &coordinates, const std::vector<size_t> &contour_offsets, const std::vector<size_t> &polygon_offsets)
+  : m_coordinates (coordinates), m_contour_offsets (contour_offsets), m_polygon_offsets (polygon_offsets)
+{
+  //  an empty offset array is taken as "no contours" or "no polygons"
+  if (m_contour_offsets.empty ()) {
+    m_contour_offsets.push_back (0);
+  }
+  if (m_polygon_offsets.empty ()) {
+    m_polygon_offsets.push_back (0);
+  }
+
+  validate ();
+}
+
+CoordinateArrays
+CoordinateArrays::from_packed (const std::vector<char> &coordinates, const std::vector<char> &contour_offsets, const std::vector<char> &polygon_offsets, unsigned int width, unsigned int offset_width)
+{
+  CoordinateArrays arrays;
+
+  unpack_le (coordinates, width, arrays.m_coordinates);
+  unpack_le (contour_offsets, offset_width, arrays.m_contour_offsets);
+  unpack_le (polygon_offsets, offset_width, arrays.m_polygon_offsets);
+
+  //  an empty offset array is taken as "no contours" or "no polygons"
+  if (arrays.m_contour_offsets.empty ()) {
+    arrays.m_contour_offsets.push_back (0);
+  }
+  if (arrays.m_polygon_offsets.empty ()) {
+    arrays.m_polygon_offsets.push_back (0);
+  }
+
+  arrays.validate ();
+  return arrays;
+}
+
+void
+CoordinateArrays::validate () const
+{
+  if ((m_coordinates.size () % 2) != 0) {
+    throw tl::Exception (tl::to_string (tr ("Coordinate array must have an even number of entries (x and y values)")));
+  }
+
+  if (m_contour_offsets.front () != 0 || m_contour_offsets.back () != points ()) {
+    throw tl::Exception (tl::to_string (tr ("Contour offsets must start with 0 and end with the number of points")));
+  }
+  for (size_t i = 1; i < m_contour_offsets.size (); ++i) {
+    if (m_contour_offsets [i] < m_contour_offsets [i - 1]) {
+      throw tl::Exception (tl::to_string (tr ("Contour offsets must be monotonic")));
+    }
+  }
+
+  if (m_polygon_offsets.front () != 0 || m_polygon_offsets.back () != m_contour_offsets.size () - 1) {
+    throw tl::Exception (tl::to_string (tr ("Polygon offsets must start with 0 and end with the number of contours")));
+  }
+  for (size_t i = 1; i < m_polygon_offsets.size (); ++i) {
+    if (m_polygon_offsets [i] <= m_polygon_offsets [i - 1]) {
+      throw tl::Exception (tl::to_string (tr ("Polygon offsets must be strictly monotonic (every polygon needs a hull)")));
+    }
+  }
+}
+
+void
+CoordinateArrays::clear ()
+{
+  m_coordinates.clear ();
+  m_contour_offsets.clear ();
+  m_contour_offsets.push_back (0);
+  m_polygon_offsets.clear ();
+  m_polygon_offsets.push_back (0);
+}
+
+void
+CoordinateArrays::reserve (size_t polygons, size_t points)
+{
+  m_coordinates.reserve (points * 2);
+  m_contour_offsets.reserve (polygons + 1);
+  m_polygon_offsets.reserve (polygons + 1);
+}
+
+void
+CoordinateArrays::add_contour (const db::Polygon::contour_type &ctr)
+{
+  size_t n = ctr.size ();
+  for (size_t i = 0; i < n; ++i) {
+    db::Point p = ctr [i];
+    m_coordinates.push_back (p.x ());
+    m_coordinates.push_back (p.y ());
+  }
+  m_contour_offsets.push_back (points ());
+}
+
+void
+CoordinateArrays::add (const db::Polygon &polygon)
+{
+  add_contour (polygon.hull ());
+  for (unsigned int h = 0; h < polygon.holes (); ++h) {
+    add_contour (polygon.hole (h));
+  }
+  m_polygon_offsets.push_back (m_contour_offsets.size () - 1);
+}
+
+void
+CoordinateArrays::add (const db::Box &box)
+{
+  if (box.empty ()) {
+    return;
+  }
+
+  //  same point order as db::Polygon (box) produces
+  m_coordinates.push_back (box.left ());
+  m_coordinates.push_back (box.bottom ());
+  m_coordinates.push_back (box.left ());
+  m_coordinates.push_back (box.top ());
+  m_coordinates.push_back (box.right ());
+  m_coordinates.push_back (box.top ());
+  m_coordinates.push_back (box.right ());
+  m_coordinates.push_back (box.bottom ());
+
+  m_contour_offsets.push_back (points ());
+  m_polygon_offsets.push_back (m_contour_offsets.size () - 1);
+}
+
+std::vector<char>
+CoordinateArrays::packed_coordinates (unsigned int width) const
+{
+  return pack_le (m_coordinates, width);
+}
+
+std::vector<char>
+CoordinateArrays::packed_contour_offsets (unsigned int width) const
+{
+  return pack_le (m_contour_offsets, width);
+}
+
+std::vector<char>
+CoordinateArrays::packed_polygon_offsets (unsigned int width) const
+{
+  return pack_le (m_polygon_offsets, width);
+}
+
+db::Polygon
+CoordinateArrays::polygon (size_t index) const
+{
+  db::Polygon poly;
+  get_polygon (index, poly);
+  return poly;
+}
+
+void
+CoordinateArrays::get_polygon (size_t index, db::Polygon &polygon) const
+{
+  polygon.clear ();
+  if (index >= size ()) {
+    return;
+  }
+
+  std::vector<db::Point> pts;
+
+  for (size_t c = m_polygon_offsets [index]; c < m_polygon_offsets [index + 1]; ++c) {
+
+    pts.clear ();
+    pts.reserve (m_contour_offsets [c + 1] - m_contour_offsets [c]);
+    for (size_t i = m_contour_offsets [c]; i < m_contour_offsets [c + 1]; ++i) {
+      pts.push_back (db::Point (m_coordinates [i * 2], m_coordinates [i * 2 + 1]));
+    }
+
+    if (c == m_polygon_offsets [index]) {
+      polygon.assign_hull (pts.begin (), pts.end ());
+    } else {
+      polygon.insert_hole (pts.begin (), pts.end ());
+    }
+
+  }
+}
+
+}
+
@@ -0,0 +1,197 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+
+#ifndef HDR_dbCoordinateArrays
+#define HDR_dbCoordinateArrays
+
+#include "dbCommon.h"
+#include "dbPolygon.h"
+#include "dbBox.h"
+
+#include <vector>
+
+namespace db
+{
+
+/**
+ *  @brief A flat, array-based representation of a set of polygons
+ *
+ *  This object stores polygons in three plain arrays which are suitable for bulk
+ *  transfer to or from foreign code (e.g. numpy arrays in Python):
+ *
+ *  - coordinates: the point coordinates as x0, y0, x1, y1, ... for all contours
+ *  - contour offsets: the index of the first point of each contour plus a final
+ *    entry with the total number of points. The first contour of each polygon is
+ *    the hull, the following ones are the holes.
+ *  - polygon offsets: the index of the first contour of each polygon plus a
+ *    final entry with the total number of contours.
+ *
+ *  Hence, the points of contour c are found at "contour_offsets [c]" to
+ *  "contour_offsets [c + 1]" (exclusive) and the contours of polygon p are found
+ *  at "polygon_offsets [p]" to "polygon_offsets [p + 1]" (exclusive).
+ */
+class DB_PUBLIC CoordinateArrays
+{
+public:
+  typedef db::Coord coord_type;
+
+  /**
+   *  @brief Creates an empty object
+   */
+  CoordinateArrays ();
+
+  /**
+   *  @brief Creates an object from the given arrays
+   *
+   *  This constructor will check the arrays for consistency and throw an
+   *  exception if they are not.
+   */
+  CoordinateArrays (const std::vector<coord_type> &coordinates, const std::vector<size_t> &contour_offsets, const std::vector<size_t> &polygon_offsets);
+
+  /**
+   *  @brief Creates an object from packed little-endian integer arrays
+   *
+   *  This is the reverse of "packed_coordinates", "packed_contour_offsets" and
+   *  "packed_polygon_offsets". "width" is the number of bytes per coordinate value,
+   *  "offset_width" the number of bytes per offset value. Both need to be 4 or 8.
+   *  The arrays are checked for consistency like in the other constructor.
+   */
+  static CoordinateArrays from_packed (const std::vector<char> &coordinates, const std::vector<char> &contour_offsets, const std::vector<char> &polygon_offsets, unsigned int width, unsigned int offset_width);
+
+  /**
+   *  @brief Clears the arrays
+   */
+  void clear ();
+
+  /**
+   *  @brief Reserves space for the given number of polygons and points
+   */
+  void reserve (size_t polygons, size_t points);
+
+  /**
+   *  @brief Adds a polygon
+   */
+  void add (const db::Polygon &polygon);
+
+  /**
+   *  @brief Adds a box (as a polygon with four points)
+   */
+  void add (const db::Box &box);
+
+  /**
+   *  @brief Gets the number of polygons stored
+   */
+  size_t size () const
+  {
+    return m_polygon_offsets.size () - 1;
+  }
+
+  /**
+   *  @brief Gets the total number of points stored
+   */
+  size_t points () const
+  {
+    return m_coordinates.size () / 2;
+  }
+
+  /**
+   *  @brief Gets the polygon with the given index
+   */
+  db::Polygon polygon (size_t index) const;
+
+  /**
+   *  @brief Gets the polygon with the given index (in-place version)
+   */
+  void get_polygon (size_t index, db::Polygon &polygon) const;
+
+  /**
+   *  @brief Gets the coordinate array
+   */
+  const std::vector<coord_type> &coordinates () const
+  {
+    return m_coordinates;
+  }
+
+  /**
+   *  @brief Gets the contour offset array
+   */
+  const std::vector<size_t> &contour_offsets () const
+  {
+    return m_contour_offsets;
+  }
+
+  /**
+   *  @brief Gets the polygon offset array
+   */
+  const std::vector<size_t> &polygon_offsets () const
+  {
+    return m_polygon_offsets;
+  }
+
+  /**
+   *  @brief Gets the coordinate array as packed little-endian integers
+   *
+   *  "width" is the number of bytes per value and needs to be 4 or 8. The values
+   *  are signed integers. An exception is thrown if a value does not fit.
+   *  The result is a memory block which can be used directly by foreign code
+   *  (e.g. with numpy.frombuffer).
+   */
+  std::vector<char> packed_coordinates (unsigned int width) const;
+
+  /**
+   *  @brief Gets the contour offset array as packed little-endian integers
+   *
+   *  See "packed_coordinates" for the format.
+   */
+  std::vector<char> packed_contour_offsets (unsigned int width) const;
+
+  /**
+   *  @brief Gets the polygon offset array as packed little-endian integers
+   *
+   *  See "packed_coordinates" for the format.
+   */
+  std::vector<char> packed_polygon_offsets (unsigned int width) const;
+
+private:
+  std::vector<coord_type> m_coordinates;
+  std::vector<size_t> m_contour_offsets;
+  std::vector<size_t> m_polygon_offsets;
+
+  void add_contour (const db::Polygon::contour_type &ctr);
+  void validate () const;
+};
+
+/**
+ *  @brief Unpacks a coordinate array from packed little-endian integers
+ *
+ *  "width" is the number of bytes per value and needs to be 4 or 8. An exception is
+ *  thrown if the data size is not a multiple of the width or a value does not fit
+ *  into a coordinate. This is the format delivered by "CoordinateArrays::packed_coordinates".
+ */
+DB_PUBLIC std::vector<db::Coord> unpack_coordinates (const std::vector<char> &data, unsigned int width);
+
+}
+
+#endif
+
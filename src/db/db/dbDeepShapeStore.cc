@@ -35,6 +35,7 @@
 #include "dbShapeCollection.h"
 
 #include "tlTimer.h"
+#include "tlThreads.h"
 
 namespace db
 {
@@ -388,15 +389,20 @@ DeepShapeStoreState::max_vertex_count () const
 // ----------------------------------------------------------------------------------
 
 static size_t s_instance_count = 0;
+static tl::Mutex s_instance_count_lock;
 
 DeepShapeStore::DeepShapeStore ()
 {
+  tl::MutexLocker locker (&s_instance_count_lock);
   ++s_instance_count;
 }
 
 DeepShapeStore::DeepShapeStore (const std::string &topcell_name, double dbu)
 {
-  ++s_instance_count;
+  {
+    tl::MutexLocker locker (&s_instance_count_lock);
+    ++s_instance_count;
+  }
 
   m_layouts.push_back (new LayoutHolder (db::ICplxTrans ()));
   m_layouts.back ()->layout.dbu (dbu);
@@ -405,7 +411,10 @@ DeepShapeStore::DeepShapeStore (const std::string &topcell_name, double dbu)
 
 DeepShapeStore::~DeepShapeStore ()
 {
-  --s_instance_count;
+  {
+    tl::MutexLocker locker (&s_instance_count_lock);
+    --s_instance_count;
+  }
 
   for (std::vector<LayoutHolder *>::iterator h = m_layouts.begin (); h != m_layouts.end (); ++h) {
     delete *h;
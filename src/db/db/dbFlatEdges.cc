@@ -107,6 +107,9 @@ void FlatEdges::reserve (size_t n)
 void
 FlatEdges::ensure_merged_edges_valid () const
 {
+  //  NOTE: the lock allows using the object from multiple threads
+  tl::MutexLocker locker (&m_merged_edges_lock);
+
   if (! m_merged_edges_valid) {
 
     m_merged_edges.clear ();
@@ -197,6 +197,7 @@ private:
   mutable db::Shapes m_edges;
   mutable db::Shapes m_merged_edges;
   mutable bool m_merged_edges_valid;
+  mutable tl::Mutex m_merged_edges_lock;
 
   void init ();
   void ensure_merged_edges_valid () const;
@@ -109,6 +109,9 @@ void FlatRegion::reserve (size_t n)
 void
 FlatRegion::ensure_merged_polygons_valid () const
 {
+  //  NOTE: the lock allows using the object from multiple threads
+  tl::MutexLocker locker (&m_merged_polygons_lock);
+
   if (! m_merged_polygons_valid) {
 
     m_merged_polygons.clear ();
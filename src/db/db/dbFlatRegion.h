@@ -196,6 +196,7 @@ private:
   mutable db::Shapes m_polygons;
   mutable db::Shapes m_merged_polygons;
   mutable bool m_merged_polygons_valid;
+  mutable tl::Mutex m_merged_polygons_lock;
 
   void init ();
   void ensure_merged_polygons_valid () const;
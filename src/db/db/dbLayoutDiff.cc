@@ -26,7 +26,12 @@
 #include "dbCellMapping.h"
 #include "dbFuzzyCellMapping.h"
 #include "dbLayoutUtils.h"
+#include "dbContentHash.h"
+#include "dbHash.h"
 #include "tlLog.h"
+#include "tlProgress.h"
+#include "tlThreadedWorkers.h"
+#include "tlThreads.h"
 #include "tlExceptions.h"
 
 namespace db
@@ -150,6 +155,50 @@ collect_insts (const db::Layout & /*l*/, const db::Cell *cell, unsigned int flag
   std::sort (insts.begin (), insts.end ());
 }
 
+/**
+ *  @brief Computes an order-independent content hash for the instances of a cell
+ *
+ *  Child cells are represented by their common cell index, so the hashes are comparable
+ *  between the layouts. Returns false if the cell has instances of cells which are not
+ *  common cells.
+ */
+static bool
+insts_content_hash (const db::Cell *cell, unsigned int flags, const std::map <db::cell_index_type, db::cell_index_type> &cci, PropertyMapper &pn, uint64_t &h)
+{
+  h = 0;
+
+  for (db::Cell::const_iterator i = cell->begin (); !i.at_end (); ++i) {
+
+    std::map <db::cell_index_type, db::cell_index_type>::const_iterator ccii = cci.find (i->cell_index ());
+    if (ccii == cci.end ()) {
+      return false;
+    }
+
+    uint64_t hi = db::inst_content_hash (i->cell_inst (), uint64_t (ccii->second));
+    if (! (flags & layout_diff::f_no_properties)) {
+      hi ^= db::ContentHash::mix (uint64_t (pn (i->prop_id ())));
+    }
+
+    h += db::ContentHash::mix (hi);
+
+  }
+
+  return true;
+}
+
+/**
+ *  @brief Computes the content hash for the shapes of a cell on the given layer
+ */
+static uint64_t
+shapes_content_hash (const db::Cell *cell, unsigned int layer, bool is_valid, unsigned int flags, PropertyMapper &pn)
+{
+  if (! is_valid) {
+    return 0;
+  } else {
+    return db::shapes_content_hash (cell->shapes (layer), (flags & layout_diff::f_no_properties) ? 0 : &pn);
+  }
+}
+
 /**
  *  @brief A generic compare function for sorted sequences using a compare operator
  */
@@ -226,6 +275,144 @@ void reduce (std::vector<X> &a, std::vector<X> &b, Op op, bool iterate)
   } while (iterate);
 }
 
+/**
+ *  @brief An equality operator derived from a compare operator
+ */
+template <class X, class Op>
+struct equal_by_compare_func
+{
+  equal_by_compare_func (const Op &op)
+    : m_op (op)
+  { }
+
+  bool operator() (const X &a, const X &b) const
+  {
+    return ! m_op (a, b) && ! m_op (b, a);
+  }
+
+private:
+  Op m_op;
+};
+
+/**
+ *  @brief Reduces two vectors to the objects not present in the other one using hash-based matching
+ *
+ *  The hash function needs to be compatible with the compare operator: objects which are
+ *  equal according to the compare operator need to have the same hash value. The compare
+ *  operator is not required to implement a tolerance.
+ *  The remaining objects are sorted, so the result is the same as the one of "reduce".
+ */
+template <class X, class Op, class H>
+void reduce_by_hash (std::vector<X> &a, std::vector<X> &b, Op op, const H &hf)
+{
+  if (! a.empty () && ! b.empty ()) {
+
+    typedef std::unordered_map<X, size_t, H, equal_by_compare_func<X, Op> > count_map;
+    count_map counts (b.size (), hf, equal_by_compare_func<X, Op> (op));
+
+    for (typename std::vector<X>::const_iterator i = b.begin (); i != b.end (); ++i) {
+      ++counts [*i];
+    }
+
+    typename std::vector<X>::iterator wa = a.begin ();
+    for (typename std::vector<X>::const_iterator i = a.begin (); i != a.end (); ++i) {
+      typename count_map::iterator c = counts.find (*i);
+      if (c != counts.end () && c->second > 0) {
+        --c->second;
+      } else {
+        *wa++ = *i;
+      }
+    }
+    a.erase (wa, a.end ());
+
+    //  the remaining counts tell how many of the equivalent b objects are left over
+    typename std::vector<X>::iterator wb = b.begin ();
+    for (typename std::vector<X>::const_iterator i = b.begin (); i != b.end (); ++i) {
+      typename count_map::iterator c = counts.find (*i);
+      if (c->second > 0) {
+        --c->second;
+        *wb++ = *i;
+      }
+    }
+    b.erase (wb, b.end ());
+
+  }
+
+  std::sort (a.begin (), a.end (), op);
+  std::sort (b.begin (), b.end (), op);
+}
+
+/**
+ *  @brief A hash function for shapes with properties compatible with the compare operators without tolerance
+ */
+template <class SH>
+struct shape_hash_func
+{
+  size_t operator() (const std::pair<SH, db::properties_id_type> &s) const
+  {
+    return std::hfunc (s.first, std::hfunc (s.second));
+  }
+};
+
+/**
+ *  @brief Specialization for polygons
+ *
+ *  The polygon compare operator compares the edge sets, so the hash does not depend on
+ *  the order of the edges.
+ */
+template <>
+struct shape_hash_func<db::Polygon>
+{
+  size_t operator() (const std::pair<db::Polygon, db::properties_id_type> &s) const
+  {
+    size_t he = 0;
+    for (db::Polygon::polygon_edge_iterator e = s.first.begin_edge (); ! e.at_end (); ++e) {
+      he += std::hfunc (*e);
+    }
+
+    size_t h = std::hfunc (s.second);
+    h = std::hfunc (s.first.holes (), h);
+    h = std::hfunc (s.first.vertices (), h);
+    return std::hcombine (h, he);
+  }
+};
+
+/**
+ *  @brief Specialization for texts
+ *
+ *  The text compare operator only looks at the string, the rotation, the size and the
+ *  displacement.
+ */
+template <>
+struct shape_hash_func<db::Text>
+{
+  size_t operator() (const std::pair<db::Text, db::properties_id_type> &s) const
+  {
+    size_t h = std::hfunc (s.second);
+    h = std::hfunc (std::string (s.first.string ()), h);
+    h = std::hfunc (s.first.trans ().rot (), h);
+    h = std::hfunc (s.first.size (), h);
+    h = std::hfunc (s.first.trans ().disp (), h);
+    return h;
+  }
+};
+
+/**
+ *  @brief Reduces two shape vectors to the shapes not present in the other one
+ *
+ *  Without a tolerance, hash-based matching is used. Otherwise the shapes are matched
+ *  by sorting.
+ */
+template <class SH, class Op>
+void reduce_shapes (std::vector<std::pair<SH, db::properties_id_type> > &a, std::vector<std::pair<SH, db::properties_id_type> > &b, Op op, db::Coord tolerance)
+{
+  if (tolerance > 0) {
+    reduce (a, b, op, true);
+  } else {
+    reduce_by_hash (a, b, op, shape_hash_func<SH> ());
+  }
+}
+
 /**
  *  @brief Compare two coordinates with tolerance
  *  This function is the basis of the fuzzy compare functions below
@@ -604,139 +791,933 @@ collect_paths (const db::Layout &, const db::Cell *c, unsigned int layer, unsign
   }
 }
 
+/**
+ *  @brief The data shared by the compare steps of the individual cells
+ */
+struct CellCompareContext
+{
+  const db::Layout *a, *b;
+  unsigned int flags;
+  db::Coord tolerance;
+  const std::map<db::LayerProperties, unsigned int, db::LPLogicalLessFunc> *layers_a, *layers_b;
+  const std::vector<db::LayerProperties> *common_layers;
+  const std::vector <std::string> *common_cells;
+  const std::vector <db::cell_index_type> *common_cells_a, *common_cells_b;
+  const std::map <db::cell_index_type, db::cell_index_type> *common_cell_indices_a, *common_cell_indices_b;
+  const db::Layout *n;
+  PropertyMapper *prop_normalize_a, *prop_normalize_b;
+  PropertyMapper *prop_remap_to_a, *prop_remap_to_b;
+};
+
+/**
+ *  @brief The working buffers for the compare of a cell
+ */
+struct CellCompareBuffers
+{
+  std::vector <db::CellInstArrayWithProperties> insts_a;
+  std::vector <db::CellInstArrayWithProperties> insts_b;
+  std::vector <std::pair <db::Polygon, db::properties_id_type> > polygons_a;
+  std::vector <std::pair <db::Polygon, db::properties_id_type> > polygons_b;
+  std::vector <std::pair <db::Path, db::properties_id_type> > paths_a;
+  std::vector <std::pair <db::Path, db::properties_id_type> > paths_b;
+  std::vector <std::pair <db::Text, db::properties_id_type> > texts_a;
+  std::vector <std::pair <db::Text, db::properties_id_type> > texts_b;
+  std::vector <std::pair <db::Box, db::properties_id_type> > boxes_a;
+  std::vector <std::pair <db::Box, db::properties_id_type> > boxes_b;
+  std::vector <std::pair <db::Edge, db::properties_id_type> > edges_a;
+  std::vector <std::pair <db::Edge, db::properties_id_type> > edges_b;
+};
+
+/**
+ *  @brief Compares the common cell with the given index
+ *
+ *  Returns true, if the cells differ. In silent mode, this function returns on the first
+ *  difference without notifying the receiver.
+ */
 static bool
-do_compare_layouts (const db::Layout &a, const db::Cell *top_a, const db::Layout &b, const db::Cell *top_b, unsigned int flags, db::Coord tolerance, DifferenceReceiver &r)
+compare_cell (const CellCompareContext &ctx, unsigned int cci, CellCompareBuffers &buffers, DifferenceReceiver &r)
 {
+  const db::Layout &a = *ctx.a;
+  const db::Layout &b = *ctx.b;
+  const db::Layout &n = *ctx.n;
+  unsigned int flags = ctx.flags;
+  db::Coord tolerance = ctx.tolerance;
+  bool verbose = (flags & layout_diff::f_verbose);
+
+  const std::map<db::LayerProperties, unsigned int, db::LPLogicalLessFunc> &layers_a = *ctx.layers_a;
+  const std::map<db::LayerProperties, unsigned int, db::LPLogicalLessFunc> &layers_b = *ctx.layers_b;
+  const std::vector<db::LayerProperties> &common_layers = *ctx.common_layers;
+  const std::vector <std::string> &common_cells = *ctx.common_cells;
+  const std::vector <db::cell_index_type> &common_cells_a = *ctx.common_cells_a;
+  const std::vector <db::cell_index_type> &common_cells_b = *ctx.common_cells_b;
+  const std::map <db::cell_index_type, db::cell_index_type> &common_cell_indices_a = *ctx.common_cell_indices_a;
+  const std::map <db::cell_index_type, db::cell_index_type> &common_cell_indices_b = *ctx.common_cell_indices_b;
+
+  PropertyMapper &prop_normalize_a = *ctx.prop_normalize_a;
+  PropertyMapper &prop_normalize_b = *ctx.prop_normalize_b;
+  PropertyMapper &prop_remap_to_a = *ctx.prop_remap_to_a;
+  PropertyMapper &prop_remap_to_b = *ctx.prop_remap_to_b;
+
+  std::vector <db::CellInstArrayWithProperties> &insts_a = buffers.insts_a;
+  std::vector <db::CellInstArrayWithProperties> &insts_b = buffers.insts_b;
+  std::vector <std::pair <db::Polygon, db::properties_id_type> > &polygons_a = buffers.polygons_a;
+  std::vector <std::pair <db::Polygon, db::properties_id_type> > &polygons_b = buffers.polygons_b;
+  std::vector <std::pair <db::Path, db::properties_id_type> > &paths_a = buffers.paths_a;
+  std::vector <std::pair <db::Path, db::properties_id_type> > &paths_b = buffers.paths_b;
+  std::vector <std::pair <db::Text, db::properties_id_type> > &texts_a = buffers.texts_a;
+  std::vector <std::pair <db::Text, db::properties_id_type> > &texts_b = buffers.texts_b;
+  std::vector <std::pair <db::Box, db::properties_id_type> > &boxes_a = buffers.boxes_a;
+  std::vector <std::pair <db::Box, db::properties_id_type> > &boxes_b = buffers.boxes_b;
+  std::vector <std::pair <db::Edge, db::properties_id_type> > &edges_a = buffers.edges_a;
+  std::vector <std::pair <db::Edge, db::properties_id_type> > &edges_b = buffers.edges_b;
+
   bool differs = false;
 
-  if (fabs (a.dbu () - b.dbu ()) > 1e-9) {
+  const db::Cell *cell_a = &a.cell (common_cells_a [cci]);
+  const db::Cell *cell_b = &b.cell (common_cells_b [cci]);
+
+  if (tl::verbosity () >= 30) {
+    tl::info << "Layout diff - compare cell " << a.cell_name (cell_a->cell_index ()) << " and " << b.cell_name (cell_b->cell_index ());
+  }
+
+  r.begin_cell (common_cells [cci], common_cells_a [cci], common_cells_b [cci]); 
+
+  if (!verbose && cell_a->bbox () != cell_b->bbox ()) {
     differs = true;
     if (flags & layout_diff::f_silent) {
-      return false;
+      return true;
     }
-    r.dbu_differs (a.dbu (), b.dbu ());
+    r.bbox_differs (cell_a->bbox (), cell_b->bbox ());
   }
 
-  bool verbose = (flags & layout_diff::f_verbose);
+  //  shortcut: identical instances do not need a detailed compare (this is the common case
+  //  for layouts with few changes)
+  uint64_t hi_a = 0, hi_b = 0;
+  bool insts_identical = insts_content_hash (cell_a, flags, common_cell_indices_a, prop_normalize_a, hi_a) &&
+                         insts_content_hash (cell_b, flags, common_cell_indices_b, prop_normalize_b, hi_b) &&
+                         hi_a == hi_b;
 
-  db::Layout n, na, nb;
-  na.properties_repository () = a.properties_repository ();
-  nb.properties_repository () = b.properties_repository ();
+  if (! insts_identical) {
 
-  db::PropertyMapper prop_normalize_a (n, a);
-  db::PropertyMapper prop_normalize_b (n, b);
+    collect_insts (a, cell_a, flags, common_cell_indices_a, insts_a, prop_normalize_a);
+    collect_insts (b, cell_b, flags, common_cell_indices_b, insts_b, prop_normalize_b);
 
-  db::PropertyMapper prop_remap_to_a (na, n);
-  db::PropertyMapper prop_remap_to_b (nb, n);
+    std::vector <db::CellInstArrayWithProperties> anotb;
+    std::set_difference (insts_a.begin (), insts_a.end (), insts_b.begin (), insts_b.end (), std::back_inserter (anotb));
 
-  //  compare layers
+    rewrite_instances_to (anotb, flags, common_cells_a, prop_remap_to_a);
+    collect_insts_of_unmapped_cells (a, cell_a, flags, common_cell_indices_a, anotb);
 
-  std::map<db::LayerProperties, unsigned int, db::LPLogicalLessFunc> layers_a;
-  std::map<db::LayerProperties, unsigned int, db::LPLogicalLessFunc> layers_b;
+    std::vector <db::CellInstArrayWithProperties> bnota;
+    std::set_difference (insts_b.begin (), insts_b.end (), insts_a.begin (), insts_a.end (), std::back_inserter (bnota));
 
-  collect_layers (a, layers_a, flags);
-  collect_layers (b, layers_b, flags);
+    rewrite_instances_to (bnota, flags, common_cells_b, prop_remap_to_b);
+    collect_insts_of_unmapped_cells (b, cell_b, flags, common_cell_indices_b, bnota);
 
-  std::vector<db::LayerProperties> common_layers;
-  std::vector<db::LayerProperties> layers_in_a_only;
-  std::vector<db::LayerProperties> layers_in_b_only;
+    if (! anotb.empty () || ! bnota.empty ()) {
 
-  for (std::map<db::LayerProperties, unsigned int, db::LPLogicalLessFunc>::const_iterator la = layers_a.begin (); la != layers_a.end (); ++la) {
-    std::map<db::LayerProperties, unsigned int, db::LPLogicalLessFunc>::const_iterator lb = layers_b.find (la->first);
-    if (lb == layers_b.end ()) {
       differs = true;
+
       if (flags & layout_diff::f_silent) {
-        return false;
-      }
-      if (flags & layout_diff::f_dont_summarize_missing_layers) {
-        layers_in_a_only.push_back (la->first);
-        common_layers.push_back (la->first);
-      } else {
-        r.layer_in_a_only (la->first);
+        return true;
       }
-    } else {
-      common_layers.push_back (la->first);
-      if (! (flags & layout_diff::f_no_layer_names) && la->first.name != lb->first.name) {
-        differs = true;
-        if (flags & layout_diff::f_silent) {
-          return false;
-        }
-        r.layer_name_differs (la->first, lb->first);
+
+      r.begin_inst_differences ();
+
+      if (verbose) {
+
+        r.instances_in_a (insts_a, common_cells, n.properties_repository ());
+        r.instances_in_b (insts_b, common_cells, n.properties_repository ());
+
+        r.instances_in_a_only (anotb, a);
+        r.instances_in_b_only (bnota, b);
+
       }
+
+      r.end_inst_differences ();
+
     }
-  }
 
-  for (std::map<db::LayerProperties, unsigned int, db::LPLogicalLessFunc>::const_iterator lb = layers_b.begin (); lb != layers_b.end (); ++lb) {
-    std::map<db::LayerProperties, unsigned int, db::LPLogicalLessFunc>::const_iterator la = layers_a.find (lb->first);
-    if (la == layers_a.end ()) {
-      differs = true;
-      if (flags & layout_diff::f_silent) {
-        return false;
-      }
-      if (flags & layout_diff::f_dont_summarize_missing_layers) {
-        layers_in_b_only.push_back (lb->first);
-        common_layers.push_back (lb->first);
-      } else {
-        r.layer_in_b_only (lb->first);
-      }
-    } 
   }
 
-  //  compare cells
-
-  std::map <std::string, db::cell_index_type> cells_a; 
-  std::map <std::string, db::cell_index_type> cells_b; 
 
-  collect_cells (a, top_a, cells_a);
-  collect_cells (b, top_b, cells_b);
+  //  compare layer by layer
+  
+  for (std::vector<db::LayerProperties>::const_iterator cl = common_layers.begin (); cl != common_layers.end (); ++cl) {
 
-  std::vector <std::string> common_cells;
-  std::map <db::cell_index_type, db::cell_index_type> common_cell_indices_a;
-  std::vector <db::cell_index_type> common_cells_a;
-  std::map <db::cell_index_type, db::cell_index_type> common_cell_indices_b;
-  std::vector <db::cell_index_type> common_cells_b;
+    if (tl::verbosity () >= 40) {
+      tl::info << "Layout diff - compare layer " << cl->to_string ();
+    }
 
-  if (top_a && top_b && (flags & layout_diff::f_smart_cell_mapping)) {
+    bool is_valid_a = false, is_valid_b = false;
+    unsigned int layer_a = 0, layer_b = 0;
 
-    //  employ the cell mapping to derive equivalent cells
-    if (tl::verbosity () >= 20) {
-      tl::info << "Layout diff - cell name mapping";
+    if (layers_a.find (*cl) != layers_a.end ()) { 
+      layer_a = layers_a.find (*cl)->second;
+      is_valid_a = true;
+    }
+    
+    if (layers_b.find (*cl) != layers_b.end ()) {
+      layer_b = layers_b.find (*cl)->second;
+      is_valid_b = true;
     }
 
-    db::FuzzyCellMapping mapping;
-    mapping.create (a, top_a->cell_index (), b, top_b->cell_index ());
+    r.begin_layer (*cl, layer_a, is_valid_a, layer_b, is_valid_b);
 
-    // collect all A cells which have corresponding B cells.
-    std::set<db::cell_index_type> mapped;
-    for (std::map <std::string, db::cell_index_type>::const_iterator cb = cells_b.begin (); cb != cells_b.end (); ++cb) {
-      std::pair<bool, db::cell_index_type> cm = mapping.cell_mapping_pair (cb->second);
-      if (cm.first) {
-        mapped.insert (cm.second);
+    if (!verbose && is_valid_a && is_valid_b && cell_a->bbox (layer_a) != cell_b->bbox (layer_b)) {
+      differs = true;
+      if (flags & layout_diff::f_silent) {
+        return true;
       }
+      r.per_layer_bbox_differs (cell_a->bbox (layer_a), cell_b->bbox (layer_b));
     }
 
-    db::cell_index_type cci = 0;
-    for (std::map <std::string, db::cell_index_type>::const_iterator cb = cells_b.begin (); cb != cells_b.end (); ++cb) {
+    //  shortcut: identical shapes do not need a detailed compare
+    if (shapes_content_hash (cell_a, layer_a, is_valid_a, flags, prop_normalize_a) == shapes_content_hash (cell_b, layer_b, is_valid_b, flags, prop_normalize_b)) {
+      r.end_layer ();
+      continue;
+    }
 
-      std::pair<bool, db::cell_index_type> cm = mapping.cell_mapping_pair (cb->second);
-      if (!cm.first) {
+    //  compare polygons
 
-        //  Employ exact name matching to unused cells as last resort.
-        std::map <std::string, db::cell_index_type>::const_iterator ca = cells_a.find (cb->first);
-        if (ca == cells_a.end () || mapped.find (ca->second) != mapped.end ()) {
+    polygons_a.clear();
+    polygons_b.clear();
+    if (is_valid_a) {
+      collect_polygons (a, cell_a, layer_a, flags, polygons_a, prop_normalize_a);
+    } 
+    if (is_valid_b) {
+      collect_polygons (b, cell_b, layer_b, flags, polygons_b, prop_normalize_b);
+    }
 
-          differs = true;
-          if (flags & layout_diff::f_silent) {
-            return false;
-          }
+    reduce_shapes (polygons_a, polygons_b, make_polygon_compare_func (tolerance), tolerance);
 
-          r.cell_in_b_only (cb->first, cb->second);
+    if (!polygons_a.empty () || !polygons_b.empty ()) {
+      differs = true;
+      if (flags & layout_diff::f_silent) {
+        return true;
+      }
+      r.begin_polygon_differences ();
+      if (verbose) {
+        r.detailed_diff (n.properties_repository (), polygons_a, polygons_b);
+      }
+      r.end_polygon_differences ();
+    }
 
-        } else {
 
-          mapped.insert (ca->second);
-          common_cells.push_back (ca->first);
-          common_cell_indices_a.insert (std::make_pair (ca->second, cci));
+    //  compare paths
+
+    if (! (flags & db::layout_diff::f_paths_as_polygons)) {
+
+      paths_a.clear();
+      paths_b.clear();
+      if (is_valid_a) {
+        collect_paths (a, cell_a, layer_a, flags, paths_a, prop_normalize_a);
+      }
+      if (is_valid_b) {
+        collect_paths (b, cell_b, layer_b, flags, paths_b, prop_normalize_b);
+      }
+
+      reduce_shapes (paths_a, paths_b, make_path_compare_func (tolerance), tolerance);
+
+      if (!paths_a.empty () || !paths_b.empty ()) {
+        differs = true;
+        if (flags & layout_diff::f_silent) {
+          return true;
+        }
+        r.begin_path_differences ();
+        if (verbose) {
+          r.detailed_diff (n.properties_repository (), paths_a, paths_b);
+        }
+        r.end_path_differences ();
+      }
+
+    }
+
+    //  compare texts
+
+    texts_a.clear();
+    texts_b.clear();
+    if (is_valid_a) {
+      collect_texts (a, cell_a, layer_a, flags, texts_a, prop_normalize_a);
+    }
+    if (is_valid_b) {
+      collect_texts (b, cell_b, layer_b, flags, texts_b, prop_normalize_b);
+    }
+
+    reduce_shapes (texts_a, texts_b, make_text_compare_func (tolerance), tolerance);
+
+    if (!texts_a.empty () || !texts_b.empty ()) {
+      differs = true;
+      if (flags & layout_diff::f_silent) {
+        return true;
+      }
+      r.begin_text_differences ();
+      if (verbose) {
+        r.detailed_diff (n.properties_repository (), texts_a, texts_b);
+      }
+      r.end_text_differences ();
+    }
+
+    //  compare boxes (unless this is done by the polygon compare code)
+    
+    if (! (flags & db::layout_diff::f_boxes_as_polygons)) {
+
+      boxes_a.clear();
+      boxes_b.clear();
+      if (is_valid_a) {
+        collect_boxes (a, cell_a, layer_a, flags, boxes_a, prop_normalize_a);
+      }
+      if (is_valid_b) {
+        collect_boxes (b, cell_b, layer_b, flags, boxes_b, prop_normalize_b);
+      }
+
+      reduce_shapes (boxes_a, boxes_b, make_box_compare_func (tolerance), tolerance);
+
+      if (!boxes_a.empty () || !boxes_b.empty ()) {
+        differs = true;
+        if (flags & layout_diff::f_silent) {
+          return true;
+        }
+        r.begin_box_differences ();
+        if (verbose) {
+          r.detailed_diff (n.properties_repository (), boxes_a, boxes_b);
+        }
+        r.end_box_differences ();
+      }
+
+    }
+
+    //  compare edges
+
+    edges_a.clear();
+    edges_b.clear();
+    if (is_valid_a) {
+      collect_edges (a, cell_a, layer_a, flags, edges_a, prop_normalize_a);
+    }
+    if (is_valid_b) {
+      collect_edges (b, cell_b, layer_b, flags, edges_b, prop_normalize_b);
+    }
+
+    reduce_shapes (edges_a, edges_b, make_edge_compare_func (tolerance), tolerance);
+
+    if (!edges_a.empty () || !edges_b.empty ()) {
+      differs = true;
+      if (flags & layout_diff::f_silent) {
+        return true;
+      }
+      r.begin_edge_differences ();
+      if (verbose) {
+        r.detailed_diff (n.properties_repository (), edges_a, edges_b);
+      }
+      r.end_edge_differences ();
+    }
+
+    r.end_layer ();
+
+  }
+
+  r.end_cell ();
+
+  return differs;
+}
+
+// -------------------------------------------------------------------------------------------
+//  Parallel cell compare
+
+/**
+ *  @brief A recorded difference event
+ */
+class DifferenceEvent
+{
+public:
+  virtual ~DifferenceEvent () { }
+  virtual void replay (DifferenceReceiver &r) const = 0;
+};
+
+/**
+ *  @brief A recorded event without arguments
+ */
+class SimpleDifferenceEvent
+  : public DifferenceEvent
+{
+public:
+  typedef void (DifferenceReceiver::*method_type) ();
+
+  SimpleDifferenceEvent (method_type m)
+    : m_method (m)
+  { }
+
+  virtual void replay (DifferenceReceiver &r) const
+  {
+    (r.*m_method) ();
+  }
+
+private:
+  method_type m_method;
+};
+
+/**
+ *  @brief A recorded bounding box difference event
+ */
+class BoxDifferenceEvent
+  : public DifferenceEvent
+{
+public:
+  typedef void (DifferenceReceiver::*method_type) (const db::Box &, const db::Box &);
+
+  BoxDifferenceEvent (method_type m, const db::Box &ba, const db::Box &bb)
+    : m_method (m), m_ba (ba), m_bb (bb)
+  { }
+
+  virtual void replay (DifferenceReceiver &r) const
+  {
+    (r.*m_method) (m_ba, m_bb);
+  }
+
+private:
+  method_type m_method;
+  db::Box m_ba, m_bb;
+};
+
+/**
+ *  @brief A recorded "begin_cell" event
+ */
+class BeginCellDifferenceEvent
+  : public DifferenceEvent
+{
+public:
+  BeginCellDifferenceEvent (const std::string &cellname, db::cell_index_type cia, db::cell_index_type cib)
+    : m_cellname (cellname), m_cia (cia), m_cib (cib)
+  { }
+
+  virtual void replay (DifferenceReceiver &r) const
+  {
+    r.begin_cell (m_cellname, m_cia, m_cib);
+  }
+
+private:
+  std::string m_cellname;
+  db::cell_index_type m_cia, m_cib;
+};
+
+/**
+ *  @brief A recorded "begin_layer" event
+ */
+class BeginLayerDifferenceEvent
+  : public DifferenceEvent
+{
+public:
+  BeginLayerDifferenceEvent (const db::LayerProperties &layer, unsigned int layer_index_a, bool is_valid_a, unsigned int layer_index_b, bool is_valid_b)
+    : m_layer (layer), m_layer_index_a (layer_index_a), m_is_valid_a (is_valid_a), m_layer_index_b (layer_index_b), m_is_valid_b (is_valid_b)
+  { }
+
+  virtual void replay (DifferenceReceiver &r) const
+  {
+    r.begin_layer (m_layer, m_layer_index_a, m_is_valid_a, m_layer_index_b, m_is_valid_b);
+  }
+
+private:
+  db::LayerProperties m_layer;
+  unsigned int m_layer_index_a;
+  bool m_is_valid_a;
+  unsigned int m_layer_index_b;
+  bool m_is_valid_b;
+};
+
+/**
+ *  @brief A recorded "instances_in_a" or "instances_in_b" event
+ */
+class InstancesDifferenceEvent
+  : public DifferenceEvent
+{
+public:
+  typedef void (DifferenceReceiver::*method_type) (const std::vector <db::CellInstArrayWithProperties> &, const std::vector <std::string> &, const db::PropertiesRepository &);
+
+  InstancesDifferenceEvent (method_type m, const std::vector <db::CellInstArrayWithProperties> &insts, const std::vector <std::string> &cell_names, const db::PropertiesRepository &props)
+    : m_method (m), m_insts (insts), mp_cell_names (&cell_names), mp_props (&props)
+  { }
+
+  virtual void replay (DifferenceReceiver &r) const
+  {
+    (r.*m_method) (m_insts, *mp_cell_names, *mp_props);
+  }
+
+private:
+  method_type m_method;
+  std::vector <db::CellInstArrayWithProperties> m_insts;
+  const std::vector <std::string> *mp_cell_names;
+  const db::PropertiesRepository *mp_props;
+};
+
+/**
+ *  @brief A recorded "instances_in_a_only" or "instances_in_b_only" event
+ */
+class InstancesOnlyDifferenceEvent
+  : public DifferenceEvent
+{
+public:
+  typedef void (DifferenceReceiver::*method_type) (const std::vector <db::CellInstArrayWithProperties> &, const db::Layout &);
+
+  InstancesOnlyDifferenceEvent (method_type m, const std::vector <db::CellInstArrayWithProperties> &insts, const db::Layout &layout)
+    : m_method (m), m_insts (insts), mp_layout (&layout)
+  { }
+
+  virtual void replay (DifferenceReceiver &r) const
+  {
+    (r.*m_method) (m_insts, *mp_layout);
+  }
+
+private:
+  method_type m_method;
+  std::vector <db::CellInstArrayWithProperties> m_insts;
+  const db::Layout *mp_layout;
+};
+
+/**
+ *  @brief A recorded "detailed_diff" event
+ */
+template <class SH>
+class DetailedDifferenceEvent
+  : public DifferenceEvent
+{
+public:
+  DetailedDifferenceEvent (const db::PropertiesRepository &pr, const std::vector <std::pair <SH, db::properties_id_type> > &a, const std::vector <std::pair <SH, db::properties_id_type> > &b)
+    : mp_pr (&pr), m_a (a), m_b (b)
+  { }
+
+  virtual void replay (DifferenceReceiver &r) const
+  {
+    r.detailed_diff (*mp_pr, m_a, m_b);
+  }
+
+private:
+  const db::PropertiesRepository *mp_pr;
+  std::vector <std::pair <SH, db::properties_id_type> > m_a, m_b;
+};
+
+/**
+ *  @brief A difference receiver recording the events for later replay
+ *
+ *  This receiver covers the events of the cell compare.
+ */
+class DifferenceRecorder
+  : public DifferenceReceiver
+{
+public:
+  DifferenceRecorder () { }
+
+  ~DifferenceRecorder ()
+  {
+    for (std::vector<DifferenceEvent *>::const_iterator e = m_events.begin (); e != m_events.end (); ++e) {
+      delete *e;
+    }
+    m_events.clear ();
+  }
+
+  void replay (DifferenceReceiver &r) const
+  {
+    for (std::vector<DifferenceEvent *>::const_iterator e = m_events.begin (); e != m_events.end (); ++e) {
+      (*e)->replay (r);
+    }
+  }
+
+  virtual void bbox_differs (const db::Box &ba, const db::Box &bb) { add (new BoxDifferenceEvent (&DifferenceReceiver::bbox_differs, ba, bb)); }
+  virtual void begin_cell (const std::string &cellname, db::cell_index_type cia, db::cell_index_type cib) { add (new BeginCellDifferenceEvent (cellname, cia, cib)); }
+  virtual void begin_inst_differences () { add (new SimpleDifferenceEvent (&DifferenceReceiver::begin_inst_differences)); }
+  virtual void instances_in_a (const std::vector <db::CellInstArrayWithProperties> &insts_a, const std::vector <std::string> &cell_names, const db::PropertiesRepository &props) { add (new InstancesDifferenceEvent (&DifferenceReceiver::instances_in_a, insts_a, cell_names, props)); }
+  virtual void instances_in_b (const std::vector <db::CellInstArrayWithProperties> &insts_b, const std::vector <std::string> &cell_names, const db::PropertiesRepository &props) { add (new InstancesDifferenceEvent (&DifferenceReceiver::instances_in_b, insts_b, cell_names, props)); }
+  virtual void instances_in_a_only (const std::vector <db::CellInstArrayWithProperties> &anotb, const db::Layout &a) { add (new InstancesOnlyDifferenceEvent (&DifferenceReceiver::instances_in_a_only, anotb, a)); }
+  virtual void instances_in_b_only (const std::vector <db::CellInstArrayWithProperties> &bnota, const db::Layout &b) { add (new InstancesOnlyDifferenceEvent (&DifferenceReceiver::instances_in_b_only, bnota, b)); }
+  virtual void end_inst_differences () { add (new SimpleDifferenceEvent (&DifferenceReceiver::end_inst_differences)); }
+  virtual void begin_layer (const db::LayerProperties &layer, unsigned int layer_index_a, bool is_valid_a, unsigned int layer_index_b, bool is_valid_b) { add (new BeginLayerDifferenceEvent (layer, layer_index_a, is_valid_a, layer_index_b, is_valid_b)); }
+  virtual void per_layer_bbox_differs (const db::Box &ba, const db::Box &bb) { add (new BoxDifferenceEvent (&DifferenceReceiver::per_layer_bbox_differs, ba, bb)); }
+  virtual void begin_polygon_differences () { add (new SimpleDifferenceEvent (&DifferenceReceiver::begin_polygon_differences)); }
+  virtual void detailed_diff (const db::PropertiesRepository &pr, const std::vector <std::pair <db::Polygon, db::properties_id_type> > &a, const std::vector <std::pair <db::Polygon, db::properties_id_type> > &b) { add (new DetailedDifferenceEvent<db::Polygon> (pr, a, b)); }
+  virtual void end_polygon_differences () { add (new SimpleDifferenceEvent (&DifferenceReceiver::end_polygon_differences)); }
+  virtual void begin_path_differences () { add (new SimpleDifferenceEvent (&DifferenceReceiver::begin_path_differences)); }
+  virtual void detailed_diff (const db::PropertiesRepository &pr, const std::vector <std::pair <db::Path, db::properties_id_type> > &a, const std::vector <std::pair <db::Path, db::properties_id_type> > &b) { add (new DetailedDifferenceEvent<db::Path> (pr, a, b)); }
+  virtual void end_path_differences () { add (new SimpleDifferenceEvent (&DifferenceReceiver::end_path_differences)); }
+  virtual void begin_box_differences () { add (new SimpleDifferenceEvent (&DifferenceReceiver::begin_box_differences)); }
+  virtual void detailed_diff (const db::PropertiesRepository &pr, const std::vector <std::pair <db::Box, db::properties_id_type> > &a, const std::vector <std::pair <db::Box, db::properties_id_type> > &b) { add (new DetailedDifferenceEvent<db::Box> (pr, a, b)); }
+  virtual void end_box_differences () { add (new SimpleDifferenceEvent (&DifferenceReceiver::end_box_differences)); }
+  virtual void begin_edge_differences () { add (new SimpleDifferenceEvent (&DifferenceReceiver::begin_edge_differences)); }
+  virtual void detailed_diff (const db::PropertiesRepository &pr, const std::vector <std::pair <db::Edge, db::properties_id_type> > &a, const std::vector <std::pair <db::Edge, db::properties_id_type> > &b) { add (new DetailedDifferenceEvent<db::Edge> (pr, a, b)); }
+  virtual void end_edge_differences () { add (new SimpleDifferenceEvent (&DifferenceReceiver::end_edge_differences)); }
+  virtual void begin_text_differences () { add (new SimpleDifferenceEvent (&DifferenceReceiver::begin_text_differences)); }
+  virtual void detailed_diff (const db::PropertiesRepository &pr, const std::vector <std::pair <db::Text, db::properties_id_type> > &a, const std::vector <std::pair <db::Text, db::properties_id_type> > &b) { add (new DetailedDifferenceEvent<db::Text> (pr, a, b)); }
+  virtual void end_text_differences () { add (new SimpleDifferenceEvent (&DifferenceReceiver::end_text_differences)); }
+  virtual void end_layer () { add (new SimpleDifferenceEvent (&DifferenceReceiver::end_layer)); }
+  virtual void end_cell () { add (new SimpleDifferenceEvent (&DifferenceReceiver::end_cell)); }
+
+private:
+  std::vector<DifferenceEvent *> m_events;
+
+  //  no copying
+  DifferenceRecorder (const DifferenceRecorder &);
+  DifferenceRecorder &operator= (const DifferenceRecorder &);
+
+  void add (DifferenceEvent *event)
+  {
+    m_events.push_back (event);
+  }
+};
+
+/**
+ *  @brief A task for the parallel cell compare: compares one pair of common cells
+ */
+class CellCompareTask
+  : public tl::Task
+{
+public:
+  CellCompareTask (unsigned int cci)
+    : m_cci (cci)
+  { }
+
+  unsigned int cci () const
+  {
+    return m_cci;
+  }
+
+private:
+  unsigned int m_cci;
+};
+
+/**
+ *  @brief The job for the parallel cell compare
+ *
+ *  Each cell compare records its differences in a separate recorder. The recorders are
+ *  replayed in the order of the cells, so the receiver sees the same sequence of events
+ *  as in the single-threaded case. While the job is running, the completed leading
+ *  recorders are replayed and deleted already, so the events don't pile up in memory.
+ */
+class CellCompareJob
+  : public tl::JobBase
+{
+public:
+  CellCompareJob (int nworkers, const CellCompareContext &ctx)
+    : tl::JobBase (nworkers), m_ctx (ctx), m_differs (false), m_stop (false), m_progress (0), m_replayed (0)
+  {
+    m_done.resize (ctx.common_cells->size (), false);
+    m_recorders.resize (ctx.common_cells->size (), 0);
+    for (std::vector<DifferenceRecorder *>::iterator r = m_recorders.begin (); r != m_recorders.end (); ++r) {
+      *r = new DifferenceRecorder ();
+    }
+  }
+
+  ~CellCompareJob ()
+  {
+    for (std::vector<DifferenceRecorder *>::iterator r = m_recorders.begin (); r != m_recorders.end (); ++r) {
+      delete *r;
+    }
+    m_recorders.clear ();
+  }
+
+  const CellCompareContext &context () const
+  {
+    return m_ctx;
+  }
+
+  DifferenceRecorder *recorder (unsigned int cci) const
+  {
+    return m_recorders [cci];
+  }
+
+  void task_finished (unsigned int cci, bool differs)
+  {
+    tl::MutexLocker locker (&m_lock);
+    m_done [cci] = true;
+    ++m_progress;
+    if (differs) {
+      m_differs = true;
+      //  in silent mode, the first difference is sufficient
+      if (m_ctx.flags & layout_diff::f_silent) {
+        m_stop = true;
+      }
+    }
+  }
+
+  bool stop_requested ()
+  {
+    tl::MutexLocker locker (&m_lock);
+    return m_stop;
+  }
+
+  bool differs ()
+  {
+    tl::MutexLocker locker (&m_lock);
+    return m_differs;
+  }
+
+  void update_progress (tl::RelativeProgress &progress)
+  {
+    size_t p;
+    {
+      tl::MutexLocker locker (&m_lock);
+      p = m_progress;
+    }
+
+    progress.set (p, true /*force yield*/);
+  }
+
+  /**
+   *  @brief Replays the recorders of the finished cells in order
+   *
+   *  The replay stops at the first cell which is not finished yet. Replayed recorders
+   *  are deleted. This method must be called from the main thread only.
+   */
+  void replay_finished (DifferenceReceiver &r)
+  {
+    while (m_replayed < m_recorders.size ()) {
+
+      {
+        tl::MutexLocker locker (&m_lock);
+        if (! m_done [m_replayed]) {
+          break;
+        }
+      }
+
+      //  a finished recorder is no longer accessed by the workers
+      std::auto_ptr<DifferenceRecorder> rec (m_recorders [m_replayed]);
+      m_recorders [m_replayed] = 0;
+      ++m_replayed;
+
+      rec->replay (r);
+
+    }
+  }
+
+  virtual tl::Worker *create_worker ();
+
+private:
+  CellCompareContext m_ctx;
+  std::vector<DifferenceRecorder *> m_recorders;
+  std::vector<bool> m_done;
+  bool m_differs, m_stop;
+  size_t m_progress, m_replayed;
+  tl::Mutex m_lock;
+};
+
+/**
+ *  @brief The worker for the parallel cell compare
+ */
+class CellCompareWorker
+  : public tl::Worker
+{
+public:
+  CellCompareWorker (CellCompareJob *job)
+    : tl::Worker (), mp_job (job)
+  { }
+
+  void perform_task (tl::Task *task)
+  {
+    CellCompareTask *compare_task = dynamic_cast<CellCompareTask *> (task);
+    if (compare_task) {
+      bool differs = false;
+      if (! mp_job->stop_requested ()) {
+        differs = compare_cell (mp_job->context (), compare_task->cci (), m_buffers, *mp_job->recorder (compare_task->cci ()));
+      }
+      mp_job->task_finished (compare_task->cci (), differs);
+    }
+  }
+
+private:
+  CellCompareJob *mp_job;
+  CellCompareBuffers m_buffers;
+};
+
+tl::Worker *
+CellCompareJob::create_worker ()
+{
+  return new CellCompareWorker (this);
+}
+
+/**
+ *  @brief Compares the common cells using multiple threads
+ *
+ *  Returns true, if differences are found.
+ */
+static bool
+compare_cells_parallel (const CellCompareContext &ctx, int threads, tl::RelativeProgress &progress, DifferenceReceiver &r)
+{
+  //  The property mappers are not thread-safe: by mapping all properties IDs beforehand,
+  //  the workers will only read the mapping tables
+  for (db::PropertiesRepository::iterator p = ctx.a->properties_repository ().begin (); p != ctx.a->properties_repository ().end (); ++p) {
+    (*ctx.prop_remap_to_a) ((*ctx.prop_normalize_a) (p->first));
+  }
+  for (db::PropertiesRepository::iterator p = ctx.b->properties_repository ().begin (); p != ctx.b->properties_repository ().end (); ++p) {
+    (*ctx.prop_remap_to_b) ((*ctx.prop_normalize_b) (p->first));
+  }
+
+  //  the layouts are read from multiple threads, so they need to be up to date
+  ctx.a->update ();
+  ctx.b->update ();
+
+  CellCompareJob job (threads, ctx);
+  for (unsigned int cci = 0; cci < ctx.common_cells->size (); ++cci) {
+    job.schedule (new CellCompareTask (cci));
+  }
+
+  //  NOTE: in silent mode, the compare stops at the first difference, so the events are not complete.
+  //  Hence they are replayed only after the job has finished and if no difference was found.
+  bool silent = (ctx.flags & layout_diff::f_silent) != 0;
+
+  try {
+    job.start ();
+    while (job.is_running ()) {
+      //  This may throw an exception, if the cancel button has been pressed.
+      job.update_progress (progress);
+      if (! silent) {
+        job.replay_finished (r);
+      }
+      job.wait (100);
+    }
+  } catch (...) {
+    job.terminate ();
+    throw;
+  }
+
+  if (job.has_error ()) {
+    throw tl::Exception (job.error_messages ().front ());
+  }
+
+  if (! silent || ! job.differs ()) {
+    job.replay_finished (r);
+  }
+
+  return job.differs ();
+}
+
+static bool
+do_compare_layouts (const db::Layout &a, const db::Cell *top_a, const db::Layout &b, const db::Cell *top_b, unsigned int flags, db::Coord tolerance, DifferenceReceiver &r, int threads)
+{
+  bool differs = false;
+
+  if (fabs (a.dbu () - b.dbu ()) > 1e-9) {
+    differs = true;
+    if (flags & layout_diff::f_silent) {
+      return false;
+    }
+    r.dbu_differs (a.dbu (), b.dbu ());
+  }
+
+  db::Layout n, na, nb;
+  na.properties_repository () = a.properties_repository ();
+  nb.properties_repository () = b.properties_repository ();
+
+  db::PropertyMapper prop_normalize_a (n, a);
+  db::PropertyMapper prop_normalize_b (n, b);
+
+  db::PropertyMapper prop_remap_to_a (na, n);
+  db::PropertyMapper prop_remap_to_b (nb, n);
+
+  //  compare layers
+
+  std::map<db::LayerProperties, unsigned int, db::LPLogicalLessFunc> layers_a;
+  std::map<db::LayerProperties, unsigned int, db::LPLogicalLessFunc> layers_b;
+
+  collect_layers (a, layers_a, flags);
+  collect_layers (b, layers_b, flags);
+
+  std::vector<db::LayerProperties> common_layers;
+  std::vector<db::LayerProperties> layers_in_a_only;
+  std::vector<db::LayerProperties> layers_in_b_only;
+
+  for (std::map<db::LayerProperties, unsigned int, db::LPLogicalLessFunc>::const_iterator la = layers_a.begin (); la != layers_a.end (); ++la) {
+    std::map<db::LayerProperties, unsigned int, db::LPLogicalLessFunc>::const_iterator lb = layers_b.find (la->first);
+    if (lb == layers_b.end ()) {
+      differs = true;
+      if (flags & layout_diff::f_silent) {
+        return false;
+      }
+      if (flags & layout_diff::f_dont_summarize_missing_layers) {
+        layers_in_a_only.push_back (la->first);
+        common_layers.push_back (la->first);
+      } else {
+        r.layer_in_a_only (la->first);
+      }
+    } else {
+      common_layers.push_back (la->first);
+      if (! (flags & layout_diff::f_no_layer_names) && la->first.name != lb->first.name) {
+        differs = true;
+        if (flags & layout_diff::f_silent) {
+          return false;
+        }
+        r.layer_name_differs (la->first, lb->first);
+      }
+    }
+  }
+
+  for (std::map<db::LayerProperties, unsigned int, db::LPLogicalLessFunc>::const_iterator lb = layers_b.begin (); lb != layers_b.end (); ++lb) {
+    std::map<db::LayerProperties, unsigned int, db::LPLogicalLessFunc>::const_iterator la = layers_a.find (lb->first);
+    if (la == layers_a.end ()) {
+      differs = true;
+      if (flags & layout_diff::f_silent) {
+        return false;
+      }
+      if (flags & layout_diff::f_dont_summarize_missing_layers) {
+        layers_in_b_only.push_back (lb->first);
+        common_layers.push_back (lb->first);
+      } else {
+        r.layer_in_b_only (lb->first);
+      }
+    } 
+  }
+
+  //  compare cells
+
+  std::map <std::string, db::cell_index_type> cells_a; 
+  std::map <std::string, db::cell_index_type> cells_b; 
+
+  collect_cells (a, top_a, cells_a);
+  collect_cells (b, top_b, cells_b);
+
+  std::vector <std::string> common_cells;
+  std::map <db::cell_index_type, db::cell_index_type> common_cell_indices_a;
+  std::vector <db::cell_index_type> common_cells_a;
+  std::map <db::cell_index_type, db::cell_index_type> common_cell_indices_b;
+  std::vector <db::cell_index_type> common_cells_b;
+
+  if (top_a && top_b && (flags & layout_diff::f_smart_cell_mapping)) {
+
+    //  employ the cell mapping to derive equivalent cells
+    if (tl::verbosity () >= 20) {
+      tl::info << "Layout diff - cell name mapping";
+    }
+
+    db::FuzzyCellMapping mapping;
+    mapping.create (a, top_a->cell_index (), b, top_b->cell_index ());
+
+    // collect all A cells which have corresponding B cells.
+    std::set<db::cell_index_type> mapped;
+    for (std::map <std::string, db::cell_index_type>::const_iterator cb = cells_b.begin (); cb != cells_b.end (); ++cb) {
+      std::pair<bool, db::cell_index_type> cm = mapping.cell_mapping_pair (cb->second);
+      if (cm.first) {
+        mapped.insert (cm.second);
+      }
+    }
+
+    db::cell_index_type cci = 0;
+    for (std::map <std::string, db::cell_index_type>::const_iterator cb = cells_b.begin (); cb != cells_b.end (); ++cb) {
+
+      std::pair<bool, db::cell_index_type> cm = mapping.cell_mapping_pair (cb->second);
+      if (!cm.first) {
+
+        //  Employ exact name matching to unused cells as last resort.
+        std::map <std::string, db::cell_index_type>::const_iterator ca = cells_a.find (cb->first);
+        if (ca == cells_a.end () || mapped.find (ca->second) != mapped.end ()) {
+
+          differs = true;
+          if (flags & layout_diff::f_silent) {
+            return false;
+          }
+
+          r.cell_in_b_only (cb->first, cb->second);
+
+        } else {
+
+          mapped.insert (ca->second);
+          common_cells.push_back (ca->first);
+          common_cell_indices_a.insert (std::make_pair (ca->second, cci));
           common_cells_a.push_back (ca->second);
           common_cell_indices_b.insert (std::make_pair (cb->second, cci));
           common_cells_b.push_back (cb->second);
@@ -816,251 +1797,51 @@ do_compare_layouts (const db::Layout &a, const db::Cell *top_a, const db::Layout
     tl::info << "Layout diff - cell by cell compare";
   }
 
-  std::vector <db::CellInstArrayWithProperties> insts_a;
-  std::vector <db::CellInstArrayWithProperties> insts_b;
-  std::vector <std::pair <db::Polygon, db::properties_id_type> > polygons_a;
-  std::vector <std::pair <db::Polygon, db::properties_id_type> > polygons_b;
-  std::vector <std::pair <db::Path, db::properties_id_type> > paths_a;
-  std::vector <std::pair <db::Path, db::properties_id_type> > paths_b;
-  std::vector <std::pair <db::Text, db::properties_id_type> > texts_a;
-  std::vector <std::pair <db::Text, db::properties_id_type> > texts_b;
-  std::vector <std::pair <db::Box, db::properties_id_type> > boxes_a;
-  std::vector <std::pair <db::Box, db::properties_id_type> > boxes_b;
-  std::vector <std::pair <db::Edge, db::properties_id_type> > edges_a;
-  std::vector <std::pair <db::Edge, db::properties_id_type> > edges_b;
-
-  for (unsigned int cci = 0; cci < common_cells.size (); ++cci) {
-
-    const db::Cell *cell_a = &a.cell (common_cells_a [cci]);
-    const db::Cell *cell_b = &b.cell (common_cells_b [cci]);
-
-    if (tl::verbosity () >= 30) {
-      tl::info << "Layout diff - compare cell " << a.cell_name (cell_a->cell_index ()) << " and " << b.cell_name (cell_b->cell_index ());
-    }
-
-    r.begin_cell (common_cells [cci], common_cells_a [cci], common_cells_b [cci]); 
-
-    if (!verbose && cell_a->bbox () != cell_b->bbox ()) {
-      differs = true;
-      if (flags & layout_diff::f_silent) {
-        return false;
-      }
-      r.bbox_differs (cell_a->bbox (), cell_b->bbox ());
-    }
-
-    collect_insts (a, cell_a, flags, common_cell_indices_a, insts_a, prop_normalize_a);
-    collect_insts (b, cell_b, flags, common_cell_indices_b, insts_b, prop_normalize_b);
-
-    std::vector <db::CellInstArrayWithProperties> anotb;
-    std::set_difference (insts_a.begin (), insts_a.end (), insts_b.begin (), insts_b.end (), std::back_inserter (anotb));
-
-    rewrite_instances_to (anotb, flags, common_cells_a, prop_remap_to_a);
-    collect_insts_of_unmapped_cells (a, cell_a, flags, common_cell_indices_a, anotb);
-
-    std::vector <db::CellInstArrayWithProperties> bnota;
-    std::set_difference (insts_b.begin (), insts_b.end (), insts_a.begin (), insts_a.end (), std::back_inserter (bnota));
-
-    rewrite_instances_to (bnota, flags, common_cells_b, prop_remap_to_b);
-    collect_insts_of_unmapped_cells (b, cell_b, flags, common_cell_indices_b, bnota);
-
-    if (! anotb.empty () || ! bnota.empty ()) {
-
+  CellCompareContext ctx;
+  ctx.a = &a;
+  ctx.b = &b;
+  ctx.flags = flags;
+  ctx.tolerance = tolerance;
+  ctx.layers_a = &layers_a;
+  ctx.layers_b = &layers_b;
+  ctx.common_layers = &common_layers;
+  ctx.common_cells = &common_cells;
+  ctx.common_cells_a = &common_cells_a;
+  ctx.common_cells_b = &common_cells_b;
+  ctx.common_cell_indices_a = &common_cell_indices_a;
+  ctx.common_cell_indices_b = &common_cell_indices_b;
+  ctx.n = &n;
+  ctx.prop_normalize_a = &prop_normalize_a;
+  ctx.prop_normalize_b = &prop_normalize_b;
+  ctx.prop_remap_to_a = &prop_remap_to_a;
+  ctx.prop_remap_to_b = &prop_remap_to_b;
+
+  if (threads > 0 && common_cells.size () > 1) {
+
+    if (compare_cells_parallel (ctx, threads, progress, r)) {
       differs = true;
-
       if (flags & layout_diff::f_silent) {
         return false;
       }
-
-      r.begin_inst_differences ();
-
-      if (verbose) {
-
-        r.instances_in_a (insts_a, common_cells, n.properties_repository ());
-        r.instances_in_b (insts_b, common_cells, n.properties_repository ());
-
-        r.instances_in_a_only (anotb, a);
-        r.instances_in_b_only (bnota, b);
-
-      }
-
-      r.end_inst_differences ();
-
     }
 
+  } else {
 
-    //  compare layer by layer
-    
-    for (std::vector<db::LayerProperties>::const_iterator cl = common_layers.begin (); cl != common_layers.end (); ++cl) {
-
-      if (tl::verbosity () >= 40) {
-        tl::info << "Layout diff - compare layer " << cl->to_string ();
-      }
-
-      bool is_valid_a = false, is_valid_b = false;
-      unsigned int layer_a = 0, layer_b = 0;
-
-      if (layers_a.find (*cl) != layers_a.end ()) { 
-        layer_a = layers_a.find (*cl)->second;
-        is_valid_a = true;
-      }
-      
-      if (layers_b.find (*cl) != layers_b.end ()) {
-        layer_b = layers_b.find (*cl)->second;
-        is_valid_b = true;
-      }
-
-      r.begin_layer (*cl, layer_a, is_valid_a, layer_b, is_valid_b);
-
-      if (!verbose && is_valid_a && is_valid_b && cell_a->bbox (layer_a) != cell_b->bbox (layer_b)) {
-        differs = true;
-        if (flags & layout_diff::f_silent) {
-          return false;
-        }
-        r.per_layer_bbox_differs (cell_a->bbox (layer_a), cell_b->bbox (layer_b));
-      }
-
-      //  compare polygons
-
-      polygons_a.clear();
-      polygons_b.clear();
-      if (is_valid_a) {
-        collect_polygons (a, cell_a, layer_a, flags, polygons_a, prop_normalize_a);
-      } 
-      if (is_valid_b) {
-        collect_polygons (b, cell_b, layer_b, flags, polygons_b, prop_normalize_b);
-      }
-
-      reduce (polygons_a, polygons_b, make_polygon_compare_func (tolerance), tolerance > 0);
-
-      if (!polygons_a.empty () || !polygons_b.empty ()) {
-        differs = true;
-        if (flags & layout_diff::f_silent) {
-          return false;
-        }
-        r.begin_polygon_differences ();
-        if (verbose) {
-          r.detailed_diff (n.properties_repository (), polygons_a, polygons_b);
-        }
-        r.end_polygon_differences ();
-      }
-
-
-      //  compare paths
-
-      if (! (flags & db::layout_diff::f_paths_as_polygons)) {
-
-        paths_a.clear();
-        paths_b.clear();
-        if (is_valid_a) {
-          collect_paths (a, cell_a, layer_a, flags, paths_a, prop_normalize_a);
-        }
-        if (is_valid_b) {
-          collect_paths (b, cell_b, layer_b, flags, paths_b, prop_normalize_b);
-        }
-
-        reduce (paths_a, paths_b, make_path_compare_func (tolerance), tolerance > 0);
-
-        if (!paths_a.empty () || !paths_b.empty ()) {
-          differs = true;
-          if (flags & layout_diff::f_silent) {
-            return false;
-          }
-          r.begin_path_differences ();
-          if (verbose) {
-            r.detailed_diff (n.properties_repository (), paths_a, paths_b);
-          }
-          r.end_path_differences ();
-        }
-
-      }
-
-      //  compare texts
-
-      texts_a.clear();
-      texts_b.clear();
-      if (is_valid_a) {
-        collect_texts (a, cell_a, layer_a, flags, texts_a, prop_normalize_a);
-      }
-      if (is_valid_b) {
-        collect_texts (b, cell_b, layer_b, flags, texts_b, prop_normalize_b);
-      }
-
-      reduce (texts_a, texts_b, make_text_compare_func (tolerance), tolerance > 0);
-
-      if (!texts_a.empty () || !texts_b.empty ()) {
-        differs = true;
-        if (flags & layout_diff::f_silent) {
-          return false;
-        }
-        r.begin_text_differences ();
-        if (verbose) {
-          r.detailed_diff (n.properties_repository (), texts_a, texts_b);
-        }
-        r.end_text_differences ();
-      }
-
-      //  compare boxes (unless this is done by the polygon compare code)
-      
-      if (! (flags & db::layout_diff::f_boxes_as_polygons)) {
-
-        boxes_a.clear();
-        boxes_b.clear();
-        if (is_valid_a) {
-          collect_boxes (a, cell_a, layer_a, flags, boxes_a, prop_normalize_a);
-        }
-        if (is_valid_b) {
-          collect_boxes (b, cell_b, layer_b, flags, boxes_b, prop_normalize_b);
-        }
-
-        reduce (boxes_a, boxes_b, make_box_compare_func (tolerance), tolerance > 0);
-
-        if (!boxes_a.empty () || !boxes_b.empty ()) {
-          differs = true;
-          if (flags & layout_diff::f_silent) {
-            return false;
-          }
-          r.begin_box_differences ();
-          if (verbose) {
-            r.detailed_diff (n.properties_repository (), boxes_a, boxes_b);
-          }
-          r.end_box_differences ();
-        }
-
-      }
-
-      //  compare edges
-
-      edges_a.clear();
-      edges_b.clear();
-      if (is_valid_a) {
-        collect_edges (a, cell_a, layer_a, flags, edges_a, prop_normalize_a);
-      }
-      if (is_valid_b) {
-        collect_edges (b, cell_b, layer_b, flags, edges_b, prop_normalize_b);
-      }
+    CellCompareBuffers buffers;
 
-      reduce (edges_a, edges_b, make_edge_compare_func (tolerance), tolerance > 0);
+    for (unsigned int cci = 0; cci < common_cells.size (); ++cci) {
 
-      if (!edges_a.empty () || !edges_b.empty ()) {
+      if (compare_cell (ctx, cci, buffers, r)) {
         differs = true;
         if (flags & layout_diff::f_silent) {
           return false;
         }
-        r.begin_edge_differences ();
-        if (verbose) {
-          r.detailed_diff (n.properties_repository (), edges_a, edges_b);
-        }
-        r.end_edge_differences ();
       }
 
-      r.end_layer ();
+      ++progress;
 
     }
 
-    r.end_cell ();
-
-    ++progress;
-
   }
 
   return ! differs;
@@ -1068,15 +1849,15 @@ do_compare_layouts (const db::Layout &a, const db::Cell *top_a, const db::Layout
 }
 
 bool
-compare_layouts (const db::Layout &a, const db::Layout &b, unsigned int flags, db::Coord tolerance, DifferenceReceiver &r)
+compare_layouts (const db::Layout &a, const db::Layout &b, unsigned int flags, db::Coord tolerance, DifferenceReceiver &r, int threads)
 {
-  return do_compare_layouts (a, 0, b, 0, flags, tolerance, r);
+  return do_compare_layouts (a, 0, b, 0, flags, tolerance, r, threads);
 }
 
 bool
-compare_layouts (const db::Layout &a, db::cell_index_type top_a, const db::Layout &b, db::cell_index_type top_b, unsigned int flags, db::Coord tolerance, DifferenceReceiver &r)
+compare_layouts (const db::Layout &a, db::cell_index_type top_a, const db::Layout &b, db::cell_index_type top_b, unsigned int flags, db::Coord tolerance, DifferenceReceiver &r, int threads)
 {
-  return do_compare_layouts (a, &a.cell (top_a), b, &b.cell (top_b), flags, tolerance, r);
+  return do_compare_layouts (a, &a.cell (top_a), b, &b.cell (top_b), flags, tolerance, r, threads);
 }
 
 // -------------------------------------------------------------------------------
@@ -1563,21 +2344,21 @@ PrintingDifferenceReceiver::end_cell ()
 //  Implementation of a printing diff 
 
 bool
-compare_layouts (const db::Layout &a, const db::Layout &b, unsigned int flags, db::Coord tolerance, size_t max_count, bool print_properties)
+compare_layouts (const db::Layout &a, const db::Layout &b, unsigned int flags, db::Coord tolerance, size_t max_count, bool print_properties, int threads)
 {
   PrintingDifferenceReceiver r;
   r.set_max_count (max_count);
   r.set_print_properties (print_properties);
-  return compare_layouts (a, b, flags, tolerance, r);
+  return compare_layouts (a, b, flags, tolerance, r, threads);
 }
 
 bool
-compare_layouts (const db::Layout &a, db::cell_index_type top_a, const db::Layout &b, db::cell_index_type top_b, unsigned int flags, db::Coord tolerance, size_t max_count, bool print_properties)
+compare_layouts (const db::Layout &a, db::cell_index_type top_a, const db::Layout &b, db::cell_index_type top_b, unsigned int flags, db::Coord tolerance, size_t max_count, bool print_properties, int threads)
 {
   PrintingDifferenceReceiver r;
   r.set_max_count (max_count);
   r.set_print_properties (print_properties);
-  return compare_layouts (a, top_a, b, top_b, flags, tolerance, r);
+  return compare_layouts (a, top_a, b, top_b, flags, tolerance, r, threads);
 }
 
 }
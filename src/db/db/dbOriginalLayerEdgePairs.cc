@@ -145,7 +145,10 @@ OriginalLayerEdgePairs::begin_iter () const
 bool
 OriginalLayerEdgePairs::empty () const
 {
-  return m_iter.at_end ();
+  //  NOTE: test a copy, so the member iterator is not initialized here and concurrent readers
+  //  do not interfere
+  db::RecursiveShapeIterator iter (m_iter);
+  return iter.at_end ();
 }
 
 const db::EdgePair *
@@ -183,7 +183,10 @@ OriginalLayerEdges::begin_merged_iter () const
 bool
 OriginalLayerEdges::empty () const
 {
-  return m_iter.at_end ();
+  //  NOTE: test a copy, so the member iterator is not initialized here and concurrent readers
+  //  do not interfere
+  db::RecursiveShapeIterator iter (m_iter);
+  return iter.at_end ();
 }
 
 bool
@@ -248,6 +251,9 @@ OriginalLayerEdges::init ()
 void
 OriginalLayerEdges::ensure_merged_edges_valid () const
 {
+  //  NOTE: the lock allows using the object from multiple threads
+  tl::MutexLocker locker (&m_merged_edges_lock);
+
   if (! m_merged_edges_valid) {
 
     m_merged_edges.clear ();
@@ -75,6 +75,7 @@ private:
   bool m_is_merged;
   mutable db::Shapes m_merged_edges;
   mutable bool m_merged_edges_valid;
+  mutable tl::Mutex m_merged_edges_lock;
   mutable db::RecursiveShapeIterator m_iter;
   db::ICplxTrans m_iter_trans;
 
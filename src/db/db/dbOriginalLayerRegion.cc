@@ -196,7 +196,10 @@ OriginalLayerRegion::begin_merged_iter () const
 bool
 OriginalLayerRegion::empty () const
 {
-  return m_iter.at_end ();
+  //  NOTE: test a copy, so the member iterator is not initialized here and concurrent readers
+  //  do not interfere
+  db::RecursiveShapeIterator iter (m_iter);
+  return iter.at_end ();
 }
 
 bool
@@ -275,6 +278,9 @@ OriginalLayerRegion::insert_into (Layout *layout, db::cell_index_type into_cell,
 void
 OriginalLayerRegion::ensure_merged_polygons_valid () const
 {
+  //  NOTE: the lock allows using the object from multiple threads
+  tl::MutexLocker locker (&m_merged_polygons_lock);
+
   if (! m_merged_polygons_valid) {
 
     m_merged_polygons.clear ();
@@ -80,6 +80,7 @@ private:
   bool m_is_merged;
   mutable db::Shapes m_merged_polygons;
   mutable bool m_merged_polygons_valid;
+  mutable tl::Mutex m_merged_polygons_lock;
   mutable db::RecursiveShapeIterator m_iter;
   db::ICplxTrans m_iter_trans;
 
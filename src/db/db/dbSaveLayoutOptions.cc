@@ -32,7 +32,7 @@ namespace db
 
 SaveLayoutOptions::SaveLayoutOptions ()
   : m_format ("GDS2"), m_all_layers (true), m_all_cells (true), m_dbu (0.0), m_scale_factor (1.0),
-    m_keep_instances (false), m_write_context_info (true), m_dont_write_empty_cells (false)
+    m_keep_instances (false), m_write_context_info (true), m_dont_write_empty_cells (false), m_zlib_threads (0)
 {
   // .. nothing yet ..
 }
@@ -63,6 +63,7 @@ SaveLayoutOptions::operator= (const SaveLayoutOptions &d)
     m_keep_instances = d.m_keep_instances;
     m_write_context_info = d.m_write_context_info;
     m_dont_write_empty_cells = d.m_dont_write_empty_cells;
+    m_zlib_threads = d.m_zlib_threads;
 
     release ();
     for (std::map <std::string, FormatSpecificWriterOptions *>::const_iterator o = d.m_options.begin (); o != d.m_options.end (); ++o) {
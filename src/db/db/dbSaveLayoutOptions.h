@@ -250,6 +250,29 @@ public:
     m_write_context_info = ctx_info;
   }
 
+  /**
+   *  @brief The number of threads used for compressing the output (getter)
+   *
+   *  This value is used when writing gzip-compressed files. With a value of 0 (the default),
+   *  the file is compressed by the writing thread. With a value of 1 or more, blocks are compressed
+   *  in parallel and a block index is written (see tl::ParallelGZipWriter).
+   *  The writer does not use this value itself - it is used by the code opening the output stream.
+   */
+  unsigned int zlib_threads () const
+  {
+    return m_zlib_threads;
+  }
+
+  /**
+   *  @brief The number of threads used for compressing the output (setter)
+   *
+   *  See zlib_threads for a description of that property.
+   */
+  void set_zlib_threads (unsigned int n)
+  {
+    m_zlib_threads = n;
+  }
+
   /**
    *  @brief Set the format (default) from the file name
    *
@@ -443,6 +466,7 @@ private:
   bool m_keep_instances;
   bool m_write_context_info;
   bool m_dont_write_empty_cells;
+  unsigned int m_zlib_threads;
   std::map <std::string, FormatSpecificWriterOptions *> m_options;
 
   void release ();
@@ -0,0 +1,72 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+
+
+#include "dbShapeBatch.h"
+#include "dbRecursiveShapeIterator.h"
+
+#include <algorithm>
+
+namespace db
+{
+
+ShapeBatch::ShapeBatch ()
+{
+  //  .. nothing yet ..
+}
+
+void
+ShapeBatch::clear ()
+{
+  m_shapes.clear ();
+  m_trans.clear ();
+  m_layers.clear ();
+  m_cell_indexes.clear ();
+}
+
+size_t
+ShapeBatch::fetch (db::RecursiveShapeIterator &iter, size_t n)
+{
+  clear ();
+
+  //  don't reserve a huge chunk for a few shapes only
+  size_t nres = std::min (n, size_t (1024));
+  m_shapes.reserve (nres);
+  m_trans.reserve (nres);
+  m_layers.reserve (nres);
+  m_cell_indexes.reserve (nres);
+
+  while (m_shapes.size () < n && ! iter.at_end ()) {
+    m_shapes.push_back (iter.shape ());
+    m_trans.push_back (iter.trans ());
+    m_layers.push_back (iter.layer ());
+    m_cell_indexes.push_back (iter.cell_index ());
+    ++iter;
+  }
+
+  return m_shapes.size ();
+}
+
+}
+
@@ -0,0 +1,134 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+
+
+#ifndef HDR_dbShapeBatch
+#define HDR_dbShapeBatch
+
+#include "dbCommon.h"
+#include "dbShape.h"
+#include "dbTrans.h"
+#include "dbTypes.h"
+
+#include <vector>
+
+namespace db
+{
+
+class RecursiveShapeIterator;
+
+/**
+ *  @brief A chunk of shapes delivered by a recursive shape iterator
+ *
+ *  This object holds the results of a number of iteration steps of a
+ *  RecursiveShapeIterator in the form of parallel arrays: the shapes, the
+ *  transformations into the top cell, the layers and the cells the shapes
+ *  are coming from. The purpose of this object is to deliver many shapes at
+ *  once to script code instead of crossing the language boundary for every
+ *  single shape.
+ *
+ *  The shapes are references into the layout. Like for the iterator, the layout
+ *  must not be modified while a batch is in use.
+ */
+class DB_PUBLIC ShapeBatch
+{
+public:
+  /**
+   *  @brief Creates an empty batch
+   */
+  ShapeBatch ();
+
+  /**
+   *  @brief Clears the batch
+   */
+  void clear ();
+
+  /**
+   *  @brief Fills the batch with the next "n" shapes from the iterator
+   *
+   *  The batch is cleared before. The iterator is advanced behind the last
+   *  shape taken. Fewer than "n" shapes are taken if the iterator reaches
+   *  the end. Returns the number of shapes taken.
+   */
+  size_t fetch (db::RecursiveShapeIterator &iter, size_t n);
+
+  /**
+   *  @brief Gets the number of shapes in the batch
+   */
+  size_t size () const
+  {
+    return m_shapes.size ();
+  }
+
+  /**
+   *  @brief Returns true, if the batch is empty
+   */
+  bool empty () const
+  {
+    return m_shapes.empty ();
+  }
+
+  /**
+   *  @brief Gets the shapes
+   */
+  const std::vector<db::Shape> &shapes () const
+  {
+    return m_shapes;
+  }
+
+  /**
+   *  @brief Gets the transformations of the shapes into the iterator's top cell
+   */
+  const std::vector<db::ICplxTrans> &trans () const
+  {
+    return m_trans;
+  }
+
+  /**
+   *  @brief Gets the layer indexes of the shapes
+   */
+  const std::vector<unsigned int> &layers () const
+  {
+    return m_layers;
+  }
+
+  /**
+   *  @brief Gets the indexes of the cells the shapes are coming from
+   */
+  const std::vector<db::cell_index_type> &cell_indexes () const
+  {
+    return m_cell_indexes;
+  }
+
+private:
+  std::vector<db::Shape> m_shapes;
+  std::vector<db::ICplxTrans> m_trans;
+  std::vector<unsigned int> m_layers;
+  std::vector<db::cell_index_type> m_cell_indexes;
+};
+
+}
+
+#endif
+
@@ -0,0 +1,253 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "dbStreamingWriter.h"
+#include "dbStream.h"
+#include "tlClassRegistry.h"
+#include "tlAssert.h"
+#include "tlStream.h"
+
+namespace db
+{
+
+// ------------------------------------------------------------------
+//  StreamingWriter implementation
+
+StreamingWriter::StreamingWriter (tl::OutputStream &stream, const db::SaveLayoutOptions &options, double dbu)
+  : mp_streaming_writer (0), m_options (options), m_cell (0), m_in_cell (false), m_finished (false), m_pending (0), m_flush_threshold (100000)
+{
+  for (tl::Registrar<db::StreamFormatDeclaration>::iterator fmt = tl::Registrar<db::StreamFormatDeclaration>::begin (); fmt != tl::Registrar<db::StreamFormatDeclaration>::end () && ! mp_writer.get (); ++fmt) {
+    if (m_options.format () == fmt->format_name ()) {
+      mp_writer.reset (fmt->create_writer ());
+    }
+  }
+  if (! mp_writer.get ()) {
+    throw tl::Exception (tl::to_string (tr ("Unknown stream format: %s")), m_options.format ());
+  }
+
+  mp_streaming_writer = dynamic_cast<StreamingWriterBase *> (mp_writer.get ());
+  if (! mp_streaming_writer) {
+    throw tl::Exception (tl::to_string (tr ("Stream format does not support streaming mode: %s")), m_options.format ());
+  }
+
+  m_layout.dbu (dbu);
+  mp_streaming_writer->begin_stream (m_layout, stream, m_options);
+}
+
+StreamingWriter::~StreamingWriter ()
+{
+  //  .. nothing yet ..
+}
+
+bool
+StreamingWriter::supports_format (const std::string &format)
+{
+  for (tl::Registrar<db::StreamFormatDeclaration>::iterator fmt = tl::Registrar<db::StreamFormatDeclaration>::begin (); fmt != tl::Registrar<db::StreamFormatDeclaration>::end (); ++fmt) {
+    if (format == fmt->format_name ()) {
+      std::auto_ptr<db::WriterBase> writer (fmt->create_writer ());
+      return dynamic_cast<StreamingWriterBase *> (writer.get ()) != 0;
+    }
+  }
+  return false;
+}
+
+unsigned int
+StreamingWriter::layer (const db::LayerProperties &lp)
+{
+  for (db::Layout::layer_iterator l = m_layout.begin_layers (); l != m_layout.end_layers (); ++l) {
+    if ((*l).second->log_equal (lp)) {
+      return (*l).first;
+    }
+  }
+  return m_layout.insert_layer (lp);
+}
+
+db::cell_index_type
+StreamingWriter::cell (const std::string &name)
+{
+  std::pair<bool, db::cell_index_type> c = m_layout.cell_by_name (name.c_str ());
+  if (c.first) {
+    return c.second;
+  } else {
+    return m_layout.add_cell (name.c_str ());
+  }
+}
+
+db::cell_index_type
+StreamingWriter::begin_cell (const std::string &name)
+{
+  tl_assert (! m_in_cell && ! m_finished);
+
+  db::cell_index_type ci = cell (name);
+  if (! m_cells_written.insert (ci).second) {
+    throw tl::Exception (tl::to_string (tr ("Cell is written twice in streaming mode: %s")), name);
+  }
+
+  m_cell = ci;
+  m_in_cell = true;
+  m_pending = 0;
+
+  mp_streaming_writer->begin_stream_cell (ci);
+
+  return ci;
+}
+
+db::Shapes &
+StreamingWriter::shapes (unsigned int layer)
+{
+  tl_assert (m_in_cell);
+  return m_layout.cell (m_cell).shapes (layer);
+}
+
+void
+StreamingWriter::insert (const db::CellInstArray &inst)
+{
+  tl_assert (m_in_cell);
+  m_layout.cell (m_cell).insert (inst);
+  checkpoint ();
+}
+
+void
+StreamingWriter::insert (const db::CellInstArrayWithProperties &inst)
+{
+  tl_assert (m_in_cell);
+  m_layout.cell (m_cell).insert (inst);
+  checkpoint ();
+}
+
+void
+StreamingWriter::checkpoint (size_t n)
+{
+  m_pending += n;
+  if (m_pending >= m_flush_threshold) {
+    flush ();
+  }
+}
+
+void
+StreamingWriter::update_layers ()
+{
+  if (m_layers_seen.size () == m_layout.layers ()) {
+    return;
+  }
+
+  //  Assign the layer properties for new layers. The assignment of existing layers is not changed.
+  std::vector <std::pair <unsigned int, db::LayerProperties> > layers;
+  m_options.get_valid_layers (m_layout, layers, db::SaveLayoutOptions::LP_AssignNumber);
+
+  for (std::vector <std::pair <unsigned int, db::LayerProperties> >::const_iterator l = layers.begin (); l != layers.end (); ++l) {
+    if (m_layers_seen.find (l->first) == m_layers_seen.end ()) {
+      m_layers.push_back (*l);
+    }
+  }
+
+  for (db::Layout::layer_iterator l = m_layout.begin_layers (); l != m_layout.end_layers (); ++l) {
+    m_layers_seen.insert ((*l).first);
+  }
+}
+
+void
+StreamingWriter::flush ()
+{
+  if (! m_in_cell) {
+    return;
+  }
+
+  update_layers ();
+  m_layout.update ();
+
+  mp_streaming_writer->write_stream_cell_content (m_layers);
+
+  db::Cell &cell = m_layout.cell (m_cell);
+  cell.clear_shapes ();
+  cell.clear_insts ();
+
+  m_pending = 0;
+}
+
+void
+StreamingWriter::end_cell ()
+{
+  tl_assert (m_in_cell);
+
+  flush ();
+  mp_streaming_writer->end_stream_cell ();
+
+  m_in_cell = false;
+}
+
+void
+StreamingWriter::finish ()
+{
+  if (m_finished) {
+    return;
+  }
+
+  if (m_in_cell) {
+    end_cell ();
+  }
+
+  m_layout.update ();
+  mp_streaming_writer->end_stream ();
+
+  m_finished = true;
+}
+
+// ------------------------------------------------------------------
+//  StreamingWriterShapeReceiver implementation
+
+StreamingWriterShapeReceiver::StreamingWriterShapeReceiver (db::StreamingWriter *writer, unsigned int layer, HierarchyBuilderShapeReceiver *pipe)
+  : mp_writer (writer), m_layer (layer), mp_pipe (pipe)
+{
+  //  .. nothing yet ..
+}
+
+void
+StreamingWriterShapeReceiver::begin (const RecursiveShapeIterator *iter)
+{
+  if (iter->layout ()) {
+    mp_pm.reset (new db::PropertyMapper (mp_writer->layout (), *iter->layout ()));
+  } else {
+    mp_pm.reset (0);
+  }
+}
+
+void
+StreamingWriterShapeReceiver::shape (const RecursiveShapeIterator * /*iter*/, const db::Shape &shape, const db::ICplxTrans &trans, const db::Box &region, const box_tree_type *complex_region)
+{
+  db::Shapes &target = mp_writer->shapes (m_layer);
+
+  if (mp_pipe) {
+    mp_pipe->push (shape, trans, region, complex_region, &target);
+  } else if (mp_pm.get ()) {
+    target.insert (shape, trans, *mp_pm);
+  } else {
+    tl::ident_map<db::properties_id_type> pm;
+    target.insert (shape, trans, pm);
+  }
+
+  mp_writer->checkpoint ();
+}
+
+}
+
@@ -0,0 +1,312 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#ifndef HDR_dbStreamingWriter
+#define HDR_dbStreamingWriter
+
+#include "dbCommon.h"
+
+#include "dbLayout.h"
+#include "dbWriter.h"
+#include "dbSaveLayoutOptions.h"
+#include "dbRecursiveShapeIterator.h"
+#include "dbHierarchyBuilder.h"
+#include "dbLayoutUtils.h"
+
+#include <vector>
+#include <set>
+#include <memory>
+
+namespace tl
+{
+  class OutputStream;
+}
+
+namespace db
+{
+
+/**
+ *  @brief The interface of a writer supporting the streaming mode
+ *
+ *  Writers implementing this interface in addition to WriterBase can be used with
+ *  StreamingWriter. In streaming mode, the writer does not see the full layout. Instead,
+ *  StreamingWriter maintains a scratch layout which holds the content of the current cell
+ *  only. The cell's content is delivered in one or many slices through
+ *  "write_stream_cell_content". After a slice has been written, the content is removed
+ *  from the scratch layout.
+ *
+ *  The scratch layout provides the database unit, the properties and the cell names.
+ *  Cells may be referenced by instances before or after they have been written.
+ */
+class DB_PUBLIC StreamingWriterBase
+{
+public:
+  /**
+   *  @brief Constructor
+   */
+  StreamingWriterBase () { }
+
+  /**
+   *  @brief Destructor
+   */
+  virtual ~StreamingWriterBase () { }
+
+  /**
+   *  @brief Begins writing the file
+   *
+   *  @param layout The scratch layout
+   */
+  virtual void begin_stream (const db::Layout &layout, tl::OutputStream &stream, const db::SaveLayoutOptions &options) = 0;
+
+  /**
+   *  @brief Begins a new cell
+   *
+   *  Each cell is begun only once.
+   */
+  virtual void begin_stream_cell (db::cell_index_type cell) = 0;
+
+  /**
+   *  @brief Writes the current content of the cell begun last
+   *
+   *  @param layers The layers to write with their target layer properties
+   */
+  virtual void write_stream_cell_content (const std::vector <std::pair <unsigned int, db::LayerProperties> > &layers) = 0;
+
+  /**
+   *  @brief Ends the cell begun last
+   */
+  virtual void end_stream_cell () = 0;
+
+  /**
+   *  @brief Finishes the file
+   */
+  virtual void end_stream () = 0;
+};
+
+/**
+ *  @brief A writer producing the output incrementally
+ *
+ *  Unlike Writer, this writer does not need a complete layout. Instead, cells, shapes
+ *  and instances are pushed into the writer and written out as they arrive. The
+ *  memory required is limited by the "flush threshold" - the number of shapes and
+ *  instances kept before they are written.
+ *
+ *  Usage is:
+ *
+ *  @code
+ *  db::StreamingWriter writer (stream, options, 0.001);
+ *  unsigned int l1 = writer.layer (db::LayerProperties (1, 0));
+ *  writer.begin_cell ("TOP");
+ *  writer.insert (l1, db::Box (0, 0, 100, 100));
+ *  writer.insert (db::CellInstArray (db::CellInst (writer.cell ("A")), db::Trans ()));
+ *  writer.end_cell ();
+ *  writer.begin_cell ("A");
+ *  ...
+ *  writer.end_cell ();
+ *  writer.finish ();
+ *  @endcode
+ *
+ *  The properties IDs used for shapes and instances refer to the properties repository
+ *  of the writer's scratch layout (see "layout").
+ *
+ *  The format is taken from the options. The format's writer needs to implement
+ *  StreamingWriterBase. The cell selection and cell properties options are not
+ *  supported. Neither is the context information for PCells and libraries.
+ */
+class DB_PUBLIC StreamingWriter
+{
+public:
+  /**
+   *  @brief Creates a writer sending the output to the given stream
+   *
+   *  This will already write the header of the file.
+   */
+  StreamingWriter (tl::OutputStream &stream, const db::SaveLayoutOptions &options, double dbu);
+
+  /**
+   *  @brief Destructor
+   *
+   *  The destructor will not finish the file. Use "finish" to complete the file.
+   */
+  ~StreamingWriter ();
+
+  /**
+   *  @brief Returns a value indicating whether the given format supports streaming mode
+   */
+  static bool supports_format (const std::string &format);
+
+  /**
+   *  @brief Gets the scratch layout
+   *
+   *  The scratch layout provides the properties repository for the properties IDs.
+   */
+  db::Layout &layout ()
+  {
+    return m_layout;
+  }
+
+  /**
+   *  @brief Gets the layer index for the given layer
+   *
+   *  The layer is created if it does not exist yet.
+   */
+  unsigned int layer (const db::LayerProperties &lp);
+
+  /**
+   *  @brief Gets the cell index for the cell with the given name
+   *
+   *  Use this cell index for instances. The cell does not need to be written before.
+   */
+  db::cell_index_type cell (const std::string &name);
+
+  /**
+   *  @brief Begins the cell with the given name
+   *
+   *  Each cell can only be written once. An exception is thrown if the cell has been
+   *  written already.
+   */
+  db::cell_index_type begin_cell (const std::string &name);
+
+  /**
+   *  @brief Gets the shapes container for the given layer of the current cell
+   *
+   *  Shapes can be inserted into this container directly. Call "checkpoint" after
+   *  inserting shapes, so the writer can flush the content.
+   */
+  db::Shapes &shapes (unsigned int layer);
+
+  /**
+   *  @brief Inserts a shape into the current cell
+   */
+  template <class Sh>
+  void insert (unsigned int layer, const Sh &shape)
+  {
+    shapes (layer).insert (shape);
+    checkpoint ();
+  }
+
+  /**
+   *  @brief Inserts an instance into the current cell
+   */
+  void insert (const db::CellInstArray &inst);
+
+  /**
+   *  @brief Inserts an instance with properties into the current cell
+   */
+  void insert (const db::CellInstArrayWithProperties &inst);
+
+  /**
+   *  @brief Indicates that "n" objects have been added to the current cell
+   *
+   *  If the flush threshold is reached, the content is written.
+   */
+  void checkpoint (size_t n = 1);
+
+  /**
+   *  @brief Writes the content of the current cell collected so far
+   */
+  void flush ();
+
+  /**
+   *  @brief Ends the current cell
+   */
+  void end_cell ();
+
+  /**
+   *  @brief Finishes the file
+   */
+  void finish ();
+
+  /**
+   *  @brief Sets the flush threshold
+   *
+   *  The flush threshold is the number of objects after which the content of the
+   *  current cell is written.
+   */
+  void set_flush_threshold (size_t n)
+  {
+    m_flush_threshold = n;
+  }
+
+  /**
+   *  @brief Gets the flush threshold
+   */
+  size_t flush_threshold () const
+  {
+    return m_flush_threshold;
+  }
+
+private:
+  //  no copying
+  StreamingWriter (const StreamingWriter &);
+  StreamingWriter &operator= (const StreamingWriter &);
+
+  db::Layout m_layout;
+  std::auto_ptr<db::WriterBase> mp_writer;
+  StreamingWriterBase *mp_streaming_writer;
+  db::SaveLayoutOptions m_options;
+  std::vector <std::pair <unsigned int, db::LayerProperties> > m_layers;
+  std::set<unsigned int> m_layers_seen;
+  std::set<db::cell_index_type> m_cells_written;
+  db::cell_index_type m_cell;
+  bool m_in_cell, m_finished;
+  size_t m_pending, m_flush_threshold;
+
+  void update_layers ();
+};
+
+/**
+ *  @brief A shape receiver feeding a streaming writer
+ *
+ *  This receiver can be used with RecursiveShapeIterator::push to send the shapes
+ *  delivered by the iterator to the current cell of a StreamingWriter. The shapes are
+ *  flattened into the current cell. The receiver does not begin or end a cell.
+ *
+ *  Optionally, a HierarchyBuilderShapeReceiver can be used to modify the shapes before
+ *  they are put into the writer, e.g. ClippingHierarchyBuilderShapeReceiver to clip the
+ *  shapes at the iterator's region. Without such a receiver, the shapes are copied
+ *  and their properties are mapped into the writer's scratch layout.
+ */
+class DB_PUBLIC StreamingWriterShapeReceiver
+  : public db::RecursiveShapeReceiver
+{
+public:
+  /**
+   *  @brief Creates a receiver writing the shapes to the given layer of the writer
+   */
+  StreamingWriterShapeReceiver (db::StreamingWriter *writer, unsigned int layer, HierarchyBuilderShapeReceiver *pipe = 0);
+
+  virtual void begin (const RecursiveShapeIterator *iter);
+  virtual void shape (const RecursiveShapeIterator *iter, const db::Shape &shape, const db::ICplxTrans &trans, const db::Box &region, const box_tree_type *complex_region);
+
+private:
+  db::StreamingWriter *mp_writer;
+  unsigned int m_layer;
+  HierarchyBuilderShapeReceiver *mp_pipe;
+  std::auto_ptr<db::PropertyMapper> mp_pm;
+};
+
+}
+
+#endif
+
@@ -30,6 +30,7 @@
 #include "dbLayoutDiff.h"
 #include "dbNetlist.h"
 #include "dbNetlistCompare.h"
+#include "dbStreamingWriter.h"
 
 #include "tlUnitTest.h"
 #include "tlFileUtils.h"
@@ -326,5 +327,32 @@ void DB_PUBLIC compare_netlist (tl::TestBase *_this, const db::Netlist &netlist,
   }
 }
 
+void write_cell_streaming (db::StreamingWriter &writer, const db::Layout &layout, db::cell_index_type ci)
+{
+  const db::Cell &source_cell = layout.cell (ci);
+  db::PropertyMapper pm (writer.layout (), layout);
+
+  writer.begin_cell (layout.cell_name (ci));
+
+  for (db::Layout::layer_iterator l = layout.begin_layers (); l != layout.end_layers (); ++l) {
+    unsigned int wl = writer.layer (*(*l).second);
+    for (db::ShapeIterator s = source_cell.shapes ((*l).first).begin (db::ShapeIterator::All); ! s.at_end (); ++s) {
+      writer.shapes (wl).insert (*s, pm);
+      writer.checkpoint ();
+    }
+  }
+
+  for (db::Cell::const_iterator i = source_cell.begin (); ! i.at_end (); ++i) {
+    db::CellInstArray inst = i->cell_inst ();
+    inst.object ().cell_index (writer.cell (layout.cell_name (inst.object ().cell_index ())));
+    if (i->has_prop_id ()) {
+      writer.insert (db::CellInstArrayWithProperties (inst, pm (i->prop_id ())));
+    } else {
+      writer.insert (inst);
+    }
+  }
+
+  writer.end_cell ();
+}
 
 }
@@ -38,6 +38,7 @@ namespace db
 
 class Layout;
 class Cell;
+class StreamingWriter;
 class LayerMap;
 class Netlist;
 
@@ -84,6 +85,15 @@ void DB_PUBLIC compare_netlist (tl::TestBase *_this, const db::Netlist &netlist,
  */
 void DB_PUBLIC compare_netlist (tl::TestBase *_this, const db::Netlist &netlist, const db::Netlist &netlist_au, bool exact_parameter_match = false);
 
+/**
+ *  @brief Writes a cell of the given layout to a streaming writer
+ *
+ *  The cell is written with the shapes and instances of the given cell. No cell must be open
+ *  in the writer. Layers and properties are mapped into the writer's scratch layout and
+ *  instances refer to the child cells by name.
+ */
+void DB_PUBLIC write_cell_streaming (db::StreamingWriter &writer, const db::Layout &layout, db::cell_index_type ci);
+
 }
 
 #endif
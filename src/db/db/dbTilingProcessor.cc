@@ -691,6 +691,12 @@ TilingProcessor::var (const std::string &name, const tl::Variant &value)
   m_top_eval.set_var (name, value);
 }
 
+void
+TilingProcessor::define_function (const std::string &name, tl::EvalFunction *function)
+{
+  m_top_eval.define_function (name, function);
+}
+
 
 void  
 TilingProcessor::output (const std::string &name, size_t id, TileOutputReceiver *rec, const db::ICplxTrans &trans)
@@ -453,6 +453,14 @@ public:
    */
   void var (const std::string &name, const tl::Variant &var);
 
+  /**
+   *  @brief Specifies a function
+   *
+   *  The function will be available in the scripts under the given name. It may be called
+   *  from multiple threads. The processor takes over ownership of the function object.
+   */
+  void define_function (const std::string &name, tl::EvalFunction *function);
+
   /**
    *  @brief Specifies an input
    *
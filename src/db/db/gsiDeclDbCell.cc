@@ -1114,6 +1114,7 @@ write_simple (const db::Cell *cell, const std::string &filename)
   db::Writer writer (options);
   tl::OutputStream stream (filename);
   writer.write (*layout, stream);
+  stream.close ();
 }
 
 static void 
@@ -1129,8 +1130,9 @@ write_options (const db::Cell *cell, const std::string &filename, const db::Save
   options.add_cell (cell->cell_index ());
 
   db::Writer writer (options);
-  tl::OutputStream stream (filename);
+  tl::OutputStream stream (filename, tl::OutputStream::OM_Auto, false, options.zlib_threads ());
   writer.write (*layout, stream);
+  stream.close ();
 }
 
 static void
@@ -0,0 +1,326 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+
+#include "gsiDecl.h"
+#include "dbCoordinateArrays.h"
+#include "dbRegion.h"
+#include "dbEdges.h"
+#include "dbShapes.h"
+
+namespace gsi
+{
+
+// ---------------------------------------------------------------
+//  db::CoordinateArrays binding
+
+static db::CoordinateArrays *new_arrays (const std::vector<db::Coord> &coordinates, const std::vector<size_t> &contour_offsets, const std::vector<size_t> &polygon_offsets)
+{
+  return new db::CoordinateArrays (coordinates, contour_offsets, polygon_offsets);
+}
+
+static db::CoordinateArrays *new_arrays_from_bytes (const std::vector<char> &coordinates, const std::vector<char> &contour_offsets, const std::vector<char> &polygon_offsets, unsigned int width, unsigned int offset_width)
+{
+  return new db::CoordinateArrays (db::CoordinateArrays::from_packed (coordinates, contour_offsets, polygon_offsets, width, offset_width));
+}
+
+static void add_polygon (db::CoordinateArrays *arrays, const db::Polygon &polygon)
+{
+  arrays->add (polygon);
+}
+
+static void add_box (db::CoordinateArrays *arrays, const db::Box &box)
+{
+  arrays->add (box);
+}
+
+Class<db::CoordinateArrays> decl_CoordinateArrays ("db", "CoordinateArrays",
+  gsi::constructor ("new", &new_arrays, gsi::arg ("coordinates"), gsi::arg ("contour_offsets"), gsi::arg ("polygon_offsets"),
+    "@brief Creates the object from the given arrays\n"
+    "See the class description for the layout of the arrays. The arrays are checked for consistency "
+    "and an error is raised if they are not consistent."
+  ) +
+  gsi::constructor ("from_bytes", &new_arrays_from_bytes, gsi::arg ("coordinates"), gsi::arg ("contour_offsets"), gsi::arg ("polygon_offsets"), gsi::arg ("width", (unsigned int) 4), gsi::arg ("offset_width", (unsigned int) 8),
+    "@brief Creates the object from packed little-endian integer arrays\n"
+    "@param coordinates The coordinates as packed signed integers of 'width' bytes each\n"
+    "@param contour_offsets The contour offsets as packed integers of 'offset_width' bytes each\n"
+    "@param polygon_offsets The polygon offsets as packed integers of 'offset_width' bytes each\n"
+    "@param width The number of bytes per coordinate value (4 or 8)\n"
+    "@param offset_width The number of bytes per offset value (4 or 8)\n"
+    "This is the reverse of \\coordinates_bytes, \\contour_offsets_bytes and \\polygon_offsets_bytes. "
+    "In Python, the arguments can be bytes objects or any object supporting the buffer protocol with contiguous "
+    "memory - e.g. numpy arrays of the matching integer type:\n"
+    "\n"
+    "@code\n"
+    "ca = pya.CoordinateArrays.from_bytes(xy.astype(\"<i4\"), co.astype(\"<i8\"), po.astype(\"<i8\"))\n"
+    "region.insert_coordinates(ca)\n"
+    "@/code\n"
+    "\n"
+    "The arrays are checked for consistency like in \\new.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  gsi::method_ext ("add", &add_polygon, gsi::arg ("polygon"),
+    "@brief Adds a polygon\n"
+  ) +
+  gsi::method_ext ("add", &add_box, gsi::arg ("box"),
+    "@brief Adds a box\n"
+    "The box is stored as a polygon with four points."
+  ) +
+  gsi::method ("clear", &db::CoordinateArrays::clear,
+    "@brief Clears the arrays\n"
+  ) +
+  gsi::method ("size", &db::CoordinateArrays::size,
+    "@brief Gets the number of polygons stored\n"
+  ) +
+  gsi::method ("points", &db::CoordinateArrays::points,
+    "@brief Gets the total number of points stored\n"
+  ) +
+  gsi::method ("polygon", &db::CoordinateArrays::polygon, gsi::arg ("index"),
+    "@brief Gets the polygon with the given index\n"
+    "An empty polygon is returned if the index is not valid."
+  ) +
+  gsi::method ("coordinates", &db::CoordinateArrays::coordinates,
+    "@brief Gets the flat coordinate array\n"
+    "The array holds the x and y coordinates of all points in the order x0, y0, x1, y1, ..."
+  ) +
+  gsi::method ("contour_offsets", &db::CoordinateArrays::contour_offsets,
+    "@brief Gets the contour offsets\n"
+    "This array holds the index of the first point of each contour plus a final entry with the "
+    "total number of points."
+  ) +
+  gsi::method ("polygon_offsets", &db::CoordinateArrays::polygon_offsets,
+    "@brief Gets the polygon offsets\n"
+    "This array holds the index of the first contour of each polygon plus a final entry with the "
+    "total number of contours."
+  ) +
+  gsi::method ("coordinates_bytes", &db::CoordinateArrays::packed_coordinates, gsi::arg ("width", (unsigned int) 4),
+    "@brief Gets the flat coordinate array as packed little-endian integers\n"
+    "@param width The number of bytes per value (4 or 8)\n"
+    "This method delivers the same values as \\coordinates, but as a single byte string holding "
+    "signed integers of the given width. Such a string can be converted into a numpy array without "
+    "element-wise conversion, e.g. with 'numpy.frombuffer(ca.coordinates_bytes(4), dtype=\"<i4\")'.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  gsi::method ("contour_offsets_bytes", &db::CoordinateArrays::packed_contour_offsets, gsi::arg ("width", (unsigned int) 8),
+    "@brief Gets the contour offsets as packed little-endian integers\n"
+    "@param width The number of bytes per value (4 or 8)\n"
+    "See \\coordinates_bytes for details about the format.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  gsi::method ("polygon_offsets_bytes", &db::CoordinateArrays::packed_polygon_offsets, gsi::arg ("width", (unsigned int) 8),
+    "@brief Gets the polygon offsets as packed little-endian integers\n"
+    "@param width The number of bytes per value (4 or 8)\n"
+    "See \\coordinates_bytes for details about the format.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ),
+  "@brief A flat representation of polygons by plain integer arrays\n"
+  "This object is intended for transferring large numbers of polygons to or from "
+  "foreign code, e.g. numpy arrays. Instead of one object per polygon and point, "
+  "three plain integer arrays are used:\n"
+  "\n"
+  "@ul\n"
+  "@li 'coordinates': the x and y values of all points (x0, y0, x1, y1, ...) @/li\n"
+  "@li 'contour_offsets': the index of the first point of each contour plus the total number of points. "
+  "The first contour of each polygon is the hull, the following ones are the holes. @/li\n"
+  "@li 'polygon_offsets': the index of the first contour of each polygon plus the total number of contours. @/li\n"
+  "@/ul\n"
+  "\n"
+  "The points of contour c are 'contour_offsets[c]' to 'contour_offsets[c+1]' (exclusive), the "
+  "contours of polygon p are 'polygon_offsets[p]' to 'polygon_offsets[p+1]' (exclusive).\n"
+  "\n"
+  "Use \\Region#to_coordinates, \\Shapes#to_coordinates or \\Polygon#to_coordinates to obtain such "
+  "an object. \\Region#insert_coordinates and \\Shapes#insert_coordinates insert the polygons "
+  "represented by it.\n"
+  "\n"
+  "The array getters deliver copies of the arrays as lists. For numpy, the packed versions "
+  "(\\coordinates_bytes, \\contour_offsets_bytes and \\polygon_offsets_bytes) are more efficient: "
+  "they deliver the arrays as byte strings which numpy can use without converting every element. "
+  "In the other direction, \\from_bytes takes packed arrays - byte strings or, in Python, numpy arrays "
+  "directly.\n"
+  "\n"
+  "@code\n"
+  "ca = region.to_coordinates\n"
+  "xy = numpy.frombuffer(ca.coordinates_bytes(4), dtype=\"<i4\").reshape(-1, 2)\n"
+  "co = numpy.frombuffer(ca.contour_offsets_bytes(8), dtype=\"<i8\")\n"
+  "@/code\n"
+  "\n"
+  "This class has been introduced in version 0.27."
+);
+
+// ---------------------------------------------------------------
+//  Bulk coordinate access for Region, Edges, Shapes and Polygon
+
+static db::CoordinateArrays region_to_coordinates (const db::Region *region)
+{
+  db::CoordinateArrays arrays;
+  arrays.reserve (region->size (), 0);
+  for (db::Region::const_iterator p = region->begin (); ! p.at_end (); ++p) {
+    arrays.add (*p);
+  }
+  return arrays;
+}
+
+static void region_insert_coordinates (db::Region *region, const db::CoordinateArrays &arrays)
+{
+  if (arrays.size () == 0) {
+    return;
+  }
+
+  region->reserve (region->size () + arrays.size ());
+
+  db::Polygon poly;
+  for (size_t i = 0; i < arrays.size (); ++i) {
+    arrays.get_polygon (i, poly);
+    region->insert (poly);
+  }
+}
+
+gsi::ClassExt<db::Region> region_coordinate_arrays_decl (
+  gsi::method_ext ("to_coordinates", &region_to_coordinates,
+    "@brief Gets the polygons of the region in a flat, array-based representation\n"
+    "See \\CoordinateArrays for details about this representation. This method is much faster than "
+    "iterating the polygons and points individually.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  gsi::method_ext ("insert_coordinates", &region_insert_coordinates, gsi::arg ("arrays"),
+    "@brief Inserts the polygons from the flat, array-based representation\n"
+    "See \\CoordinateArrays for details about this representation.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ),
+  ""
+);
+
+static std::vector<db::Coord> edges_to_coordinates (const db::Edges *edges)
+{
+  std::vector<db::Coord> coords;
+  coords.reserve (edges->size () * 4);
+  for (db::Edges::const_iterator e = edges->begin (); ! e.at_end (); ++e) {
+    coords.push_back (e->p1 ().x ());
+    coords.push_back (e->p1 ().y ());
+    coords.push_back (e->p2 ().x ());
+    coords.push_back (e->p2 ().y ());
+  }
+  return coords;
+}
+
+static void edges_insert_coordinates (db::Edges *edges, const std::vector<db::Coord> &coords)
+{
+  if ((coords.size () % 4) != 0) {
+    throw tl::Exception (tl::to_string (tr ("Edge coordinate array must have four entries (x1, y1, x2, y2) per edge")));
+  }
+  if (coords.empty ()) {
+    return;
+  }
+
+  edges->reserve (edges->size () + coords.size () / 4);
+  for (size_t i = 0; i < coords.size (); i += 4) {
+    edges->insert (db::Edge (coords [i], coords [i + 1], coords [i + 2], coords [i + 3]));
+  }
+}
+
+gsi::ClassExt<db::Edges> edges_coordinate_arrays_decl (
+  gsi::method_ext ("to_coordinates", &edges_to_coordinates,
+    "@brief Gets the edges as a flat coordinate array\n"
+    "The array holds four values per edge: x1, y1, x2, y2. This method is much faster than "
+    "iterating the edges individually.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  gsi::method_ext ("insert_coordinates", &edges_insert_coordinates, gsi::arg ("coordinates"),
+    "@brief Inserts edges from a flat coordinate array\n"
+    "The array needs to hold four values per edge: x1, y1, x2, y2.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ),
+  ""
+);
+
+static db::CoordinateArrays shapes_to_coordinates (const db::Shapes *shapes)
+{
+  db::CoordinateArrays arrays;
+
+  db::Polygon poly;
+  for (db::ShapeIterator s = shapes->begin (db::ShapeIterator::Polygons | db::ShapeIterator::Paths | db::ShapeIterator::Boxes); ! s.at_end (); ++s) {
+    if (s->is_box ()) {
+      arrays.add (s->box ());
+    } else if (s->polygon (poly)) {
+      arrays.add (poly);
+    }
+  }
+
+  return arrays;
+}
+
+static void shapes_insert_coordinates (db::Shapes *shapes, const db::CoordinateArrays &arrays)
+{
+  std::vector<db::Polygon> polygons;
+  polygons.resize (arrays.size ());
+  for (size_t i = 0; i < arrays.size (); ++i) {
+    arrays.get_polygon (i, polygons [i]);
+  }
+
+  shapes->insert (polygons.begin (), polygons.end ());
+}
+
+gsi::ClassExt<db::Shapes> shapes_coordinate_arrays_decl (
+  gsi::method_ext ("to_coordinates", &shapes_to_coordinates,
+    "@brief Gets the polygons, boxes and paths in a flat, array-based representation\n"
+    "Paths are converted to polygons. Boxes are represented by polygons with four points. "
+    "See \\CoordinateArrays for details about this representation.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  gsi::method_ext ("insert_coordinates", &shapes_insert_coordinates, gsi::arg ("arrays"),
+    "@brief Inserts polygons from the flat, array-based representation\n"
+    "See \\CoordinateArrays for details about this representation.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ),
+  ""
+);
+
+static db::CoordinateArrays polygon_to_coordinates (const db::Polygon *polygon)
+{
+  db::CoordinateArrays arrays;
+  arrays.add (*polygon);
+  return arrays;
+}
+
+gsi::ClassExt<db::Polygon> polygon_coordinate_arrays_decl (
+  gsi::method_ext ("to_coordinates", &polygon_to_coordinates,
+    "@brief Gets the polygon in a flat, array-based representation\n"
+    "See \\CoordinateArrays for details about this representation.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ),
+  ""
+);
+
+}
+
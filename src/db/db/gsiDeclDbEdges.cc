@@ -703,7 +703,7 @@ Class<db::Edges> dec_Edges (decl_dbShapeCollection, "db", "Edges",
   method_ext ("insert", &insert_a2, gsi::arg ("edges"),
     "@brief Inserts all edges from the array into this edge collection\n"
   ) +
-  method ("merge", (db::Edges &(db::Edges::*) ()) &db::Edges::merge,
+  gsi::long_running (method ("merge", (db::Edges &(db::Edges::*) ()) &db::Edges::merge,
     "@brief Merge the edges\n"
     "\n"
     "@return The edge collection after the edges have been merged (self).\n"
@@ -711,8 +711,8 @@ Class<db::Edges> dec_Edges (decl_dbShapeCollection, "db", "Edges",
     "Merging joins parallel edges which overlap or touch.\n"
     "Crossing edges are not merged.\n"
     "If the edge collection is already merged, this method does nothing\n"
-  ) +
-  method ("merged", (db::Edges (db::Edges::*) () const) &db::Edges::merged,
+  )) +
+  gsi::long_running (method ("merged", (db::Edges (db::Edges::*) () const) &db::Edges::merged,
     "@brief Returns the merged edge collection\n"
     "\n"
     "@return The edge collection after the edges have been merged.\n"
@@ -720,7 +720,7 @@ Class<db::Edges> dec_Edges (decl_dbShapeCollection, "db", "Edges",
     "Merging joins parallel edges which overlap or touch.\n"
     "Crossing edges are not merged.\n"
     "In contrast to \\merge, this method does not modify the edge collection but returns a merged copy.\n"
-  ) +
+  )) +
   method ("&", (db::Edges (db::Edges::*)(const db::Edges &) const) &db::Edges::operator&, gsi::arg ("other"),
     "@brief Returns the boolean AND between self and the other edge collection\n"
     "\n"
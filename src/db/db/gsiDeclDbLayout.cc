@@ -519,14 +519,16 @@ write_simple (db::Layout *layout, const std::string &filename)
   db::Writer writer (options);
   tl::OutputStream stream (filename);
   writer.write (*layout, stream);
+  stream.close ();
 }
 
 static void 
 write_options1 (db::Layout *layout, const std::string &filename, const db::SaveLayoutOptions &options)
 {
   db::Writer writer (options);
-  tl::OutputStream stream (filename);
+  tl::OutputStream stream (filename, tl::OutputStream::OM_Auto, false, options.zlib_threads ());
   writer.write (*layout, stream);
+  stream.close ();
 }
 
 static void 
@@ -2166,6 +2168,23 @@ Class<db::SaveLayoutOptions> decl_SaveLayoutOptions ("db", "SaveLayoutOptions",
   gsi::method ("no_empty_cells?", &db::SaveLayoutOptions::dont_write_empty_cells,
     "@brief Returns a flag indicating whether empty cells are not written.\n"
   ) + 
+  gsi::method ("zlib_threads=", &db::SaveLayoutOptions::set_zlib_threads, gsi::arg ("threads"),
+    "@brief Sets the number of threads used for compressing the output\n"
+    "\n"
+    "This value is used when writing gzip-compressed files (e.g. with suffix '.gds.gz' or '.oas.gz'). "
+    "With a value of 0 (the default), the file is compressed in the writing thread. With a value of 1 or more, "
+    "blocks are compressed in parallel using the given number of threads. The file is still a standard gzip "
+    "file, but it carries a block index which allows reading it with multiple threads too.\n"
+    "\n"
+    "This method has been introduced in version 0.27.\n"
+  ) +
+  gsi::method ("zlib_threads", &db::SaveLayoutOptions::zlib_threads,
+    "@brief Gets the number of threads used for compressing the output\n"
+    "\n"
+    "See \\zlib_threads= for details about this attribute.\n"
+    "\n"
+    "This method has been introduced in version 0.27.\n"
+  ) +
   gsi::method ("scale_factor=", &db::SaveLayoutOptions::set_scale_factor, gsi::arg ("scale_factor"),
     "@brief Set the scaling factor for the saving \n"
     "\n"
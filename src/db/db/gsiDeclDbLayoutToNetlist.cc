@@ -372,7 +372,7 @@ Class<db::LayoutToNetlist> decl_dbLayoutToNetlist ("db", "LayoutToNetlist",
   gsi::method ("global_net_name", &db::LayoutToNetlist::global_net_name, gsi::arg ("global_net_id"),
     "@brief Gets the global net name for the given global net ID."
   ) +
-  gsi::method ("extract_netlist", &db::LayoutToNetlist::extract_netlist, gsi::arg ("join_net_names", std::string (), "\"\""), gsi::arg ("include_floating_subcircuits", false),
+  gsi::long_running (gsi::method ("extract_netlist", &db::LayoutToNetlist::extract_netlist, gsi::arg ("join_net_names", std::string (), "\"\""), gsi::arg ("include_floating_subcircuits", false),
     "@brief Runs the netlist extraction\n"
     "'join_net_names' is a glob expression for labels. Nets on top level carrying the same label which matches this glob "
     "expression will be connected implicitly even if there is no physical connection. This feature is useful to simulate a connection "
@@ -397,8 +397,8 @@ Class<db::LayoutToNetlist> decl_dbLayoutToNetlist ("db", "LayoutToNetlist",
     "See the class description for more details.\n"
     "\n"
     "The 'include_floating_subcircuits' argument has been introduced in version 0.26.2."
-  ) +
-  gsi::method ("extract_netlist", &db::LayoutToNetlist::extract_netlist, gsi::arg ("join_net_names"), gsi::arg ("join_net_names_per_cell"), gsi::arg ("include_floating_subcircuits", false),
+  )) +
+  gsi::long_running (gsi::method ("extract_netlist", &db::LayoutToNetlist::extract_netlist, gsi::arg ("join_net_names"), gsi::arg ("join_net_names_per_cell"), gsi::arg ("include_floating_subcircuits", false),
     "@brief Runs the netlist extraction\n"
     "This method runs the netlist extraction like the two-parameter version. In addition to the latter, this method "
     "can be given a per-cell net label joining specification in 'join_net_names_per_cell'. The keys of this array "
@@ -410,7 +410,7 @@ Class<db::LayoutToNetlist> decl_dbLayoutToNetlist ("db", "LayoutToNetlist",
     "case, the label match pattern are combined. In any case, the 'join_net_names' has priority for the top cell.\n"
     "\n"
     "This variant of 'extract_netlist' has been introduced in version 0.26.2."
-  ) +
+  )) +
   gsi::method_ext ("internal_layout", &l2n_internal_layout,
     "@brief Gets the internal layout\n"
     "Usually it should not be required to obtain the internal layout. If you need to do so, make sure not to modify the layout as\n"
@@ -253,7 +253,7 @@ namespace gsi
   //  extend the layout class by two reader methods
   static
   gsi::ClassExt<db::Layout> layout_reader_decl (
-    gsi::method_ext ("read", &load_without_options, gsi::arg ("filename"),
+    gsi::long_running (gsi::method_ext ("read", &load_without_options, gsi::arg ("filename"),
       "@brief Load the layout from the given file\n"
       "The format of the file is determined automatically and automatic unzipping is provided. "
       "No particular options can be specified.\n"
@@ -261,8 +261,8 @@ namespace gsi
       "@return A layer map that contains the mapping used by the reader including the layers that have been created."
       "\n"
       "This method has been added in version 0.18."
-    ) +
-    gsi::method_ext ("read", &load_with_options, gsi::arg ("filename"), gsi::arg ("options"),
+    )) +
+    gsi::long_running (gsi::method_ext ("read", &load_with_options, gsi::arg ("filename"), gsi::arg ("options"),
       "@brief Load the layout from the given file with options\n"
       "The format of the file is determined automatically and automatic unzipping is provided. "
       "In this version, some reader options can be specified. "
@@ -271,7 +271,7 @@ namespace gsi
       "@return A layer map that contains the mapping used by the reader including the layers that have been created."
       "\n"
       "This method has been added in version 0.18."
-    ),
+    )),
     ""
   );
 
@@ -24,6 +24,9 @@
 #include "gsiDecl.h"
 #include "dbRecursiveShapeIterator.h"
 #include "dbRegion.h"
+#include "dbShapeBatch.h"
+#include "dbCoordinateArrays.h"
+#include "gsiDeclDbHelpers.h"
 
 #include "tlGlobPattern.h"
 
@@ -110,6 +113,57 @@ static void unselect_cells2 (db::RecursiveShapeIterator *r, const std::string &p
   r->unselect_cells (cc);
 }
 
+/**
+ *  @brief An iterator delivering ShapeBatch objects from a copy of a recursive shape iterator
+ */
+class shape_batch_iterator
+  : private db::LayoutLocker
+{
+public:
+  typedef db::ShapeBatch value_type;
+  typedef const db::ShapeBatch &reference;
+  typedef const db::ShapeBatch *pointer;
+  typedef std::ptrdiff_t difference_type;
+  typedef std::forward_iterator_tag iterator_category;
+
+  shape_batch_iterator (const db::RecursiveShapeIterator &iter, size_t n)
+    : db::LayoutLocker (const_cast<db::Layout *> (iter.layout ())), m_iter (iter), m_n (std::max (n, size_t (1)))
+  {
+    m_batch.fetch (m_iter, m_n);
+  }
+
+  bool at_end () const { return m_batch.empty (); }
+  void operator++ () { m_batch.fetch (m_iter, m_n); }
+
+  reference operator* () const { return m_batch; }
+  pointer operator-> () const { return &m_batch; }
+
+private:
+  db::RecursiveShapeIterator m_iter;
+  size_t m_n;
+  db::ShapeBatch m_batch;
+};
+
+static shape_batch_iterator each_batch (const db::RecursiveShapeIterator *iter, size_t n)
+{
+  return shape_batch_iterator (*iter, n);
+}
+
+static db::CoordinateArrays batch_to_coordinates (const db::ShapeBatch *batch)
+{
+  db::CoordinateArrays arrays;
+  arrays.reserve (batch->size (), 0);
+
+  db::Polygon poly;
+  for (size_t i = 0; i < batch->size (); ++i) {
+    if (batch->shapes () [i].polygon (poly)) {
+      arrays.add (poly.transformed (batch->trans () [i]));
+    }
+  }
+
+  return arrays;
+}
+
 static db::Region complex_region (const db::RecursiveShapeIterator *iter)
 {
   if (iter->has_complex_region ()) {
@@ -119,6 +173,44 @@ static db::Region complex_region (const db::RecursiveShapeIterator *iter)
   }
 }
 
+Class<db::ShapeBatch> decl_ShapeBatch ("db", "ShapeBatch",
+  gsi::method ("size", &db::ShapeBatch::size,
+    "@brief Gets the number of shapes in this batch\n"
+  ) +
+  gsi::method ("shapes", &db::ShapeBatch::shapes,
+    "@brief Gets the shapes\n"
+    "The shapes are not transformed - they are located in the cells given by \\cell_indexes.\n"
+    "This method creates one \\Shape object per shape. Use \\to_coordinates to obtain the geometry only.\n"
+  ) +
+  gsi::method_ext ("to_coordinates", &batch_to_coordinates,
+    "@brief Gets the polygons of this batch in the iterator's top cell\n"
+    "The boxes, polygons and paths of this batch are transformed into the top cell and delivered "
+    "as a \\CoordinateArrays object - i.e. as plain integer arrays. Paths are converted to polygons. "
+    "Other shapes (edges, texts etc.) are skipped, so the polygon index does not necessarily "
+    "correspond to the index in \\shapes.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  gsi::method ("trans", &db::ShapeBatch::trans,
+    "@brief Gets the transformations of the shapes into the iterator's top cell\n"
+    "This array has the same length as \\shapes.\n"
+  ) +
+  gsi::method ("layers", &db::ShapeBatch::layers,
+    "@brief Gets the layer indexes of the shapes\n"
+    "This array has the same length as \\shapes.\n"
+  ) +
+  gsi::method ("cell_indexes", &db::ShapeBatch::cell_indexes,
+    "@brief Gets the indexes of the cells the shapes are coming from\n"
+    "This array has the same length as \\shapes.\n"
+  ),
+  "@brief A chunk of shapes delivered by \\RecursiveShapeIterator#each_batch\n"
+  "\n"
+  "This object holds the results of a number of iteration steps of a recursive shape "
+  "iterator in the form of parallel arrays.\n"
+  "\n"
+  "This class has been introduced in version 0.27."
+);
+
 Class<db::RecursiveShapeIterator> decl_RecursiveShapeIterator ("db", "RecursiveShapeIterator",
   gsi::constructor ("new", &new_si1, gsi::arg ("layout"), gsi::arg ("cell"), gsi::arg ("layer"),
     "@brief Creates a recursive, single-layer shape iterator.\n"
@@ -439,6 +531,27 @@ Class<db::RecursiveShapeIterator> decl_RecursiveShapeIterator ("db", "RecursiveS
     "@brief Increment the iterator\n"
     "This moves the iterator to the next shape inside the search scope."
   ) +
+  gsi::iterator_ext ("each_batch", &each_batch, gsi::arg ("n"),
+    "@brief Delivers the remaining shapes in chunks of up to n shapes\n"
+    "\n"
+    "This iterator delivers \\ShapeBatch objects. Each of them holds the shapes, transformations, "
+    "layers and cell indexes of up to 'n' iteration steps. Iteration starts at the current position. "
+    "This iterator is not modified - the iteration happens on a copy.\n"
+    "\n"
+    "Visiting shapes in chunks is much faster in scripts than stepping the iterator for every single shape:\n"
+    "\n"
+    "@code\n"
+    "iter = layout.begin_shapes(cell, layer)\n"
+    "iter.each_batch(1000) do |batch|\n"
+    "  batch.shapes.each_with_index do |shape, i|\n"
+    "    polygon = shape.polygon.transformed(batch.trans[i])\n"
+    "    ...\n"
+    "  end\n"
+    "end\n"
+    "@/code\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
   gsi::method ("layer", &db::RecursiveShapeIterator::layer,
     "@brief Returns the layer index where the current shape is coming from.\n"
     "\n"
@@ -29,6 +29,7 @@
 #include "dbPolygonTools.h"
 #include "dbLayoutUtils.h"
 #include "dbShapes.h"
+#include "dbCoordinateArrays.h"
 #include "dbDeepShapeStore.h"
 #include "dbRegion.h"
 #include "dbRegionProcessors.h"
@@ -170,13 +171,39 @@ static db::Region::perimeter_type perimeter2 (const db::Region *r, const db::Box
   return r->perimeter (rect);
 }
 
-static void insert_a (db::Region *r, const std::vector <db::Polygon> &a)
+template <class Sh>
+static void insert_many (db::Region *r, const std::vector <Sh> &a)
 {
-  for (std::vector <db::Polygon>::const_iterator p = a.begin (); p != a.end (); ++p) {
+  if (a.empty ()) {
+    return;
+  }
+
+  r->reserve (r->size () + a.size ());
+  for (typename std::vector <Sh>::const_iterator p = a.begin (); p != a.end (); ++p) {
     r->insert (*p);
   }
 }
 
+static void insert_boxes (db::Region *r, const std::vector<db::Coord> &coords)
+{
+  if ((coords.size () % 4) != 0) {
+    throw tl::Exception (tl::to_string (tr ("Box coordinate array must have four entries (left, bottom, right, top) per box")));
+  }
+  if (coords.empty ()) {
+    return;
+  }
+
+  r->reserve (r->size () + coords.size () / 4);
+  for (size_t i = 0; i < coords.size (); i += 4) {
+    r->insert (db::Box (coords [i], coords [i + 1], coords [i + 2], coords [i + 3]));
+  }
+}
+
+static void insert_boxes_packed (db::Region *r, const std::vector<char> &data, unsigned int width)
+{
+  insert_boxes (r, db::unpack_coordinates (data, width));
+}
+
 static void insert_r (db::Region *r, const db::Region &a)
 {
   for (db::Region::const_iterator p = a.begin (); ! p.at_end (); ++p) {
@@ -1037,9 +1064,58 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "This variant will apply the given transformation to the shapes. This is useful to scale the "
     "shapes to a specific database unit for example.\n"
   ) +
-  method_ext ("insert", &insert_a, gsi::arg ("array"),
+  method_ext ("insert", &insert_many<db::Polygon>, gsi::arg ("array"),
     "@brief Inserts all polygons from the array into this region\n"
   ) +
+  method_ext ("insert_many", &insert_many<db::Box>, gsi::arg ("boxes"),
+    "@brief Inserts many boxes into the region\n"
+    "This method is equivalent to calling \\insert for each \\Box in the array, but faster "
+    "as the memory for the polygons is reserved in advance and the boxes are inserted in a single call.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  method_ext ("insert_many", &insert_many<db::Polygon>, gsi::arg ("polygons"),
+    "@brief Inserts many polygons into the region\n"
+    "This method is equivalent to calling \\insert for each \\Polygon in the array, but faster "
+    "as the memory for the polygons is reserved in advance and the polygons are inserted in a single call.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  method_ext ("insert_many", &insert_many<db::SimplePolygon>, gsi::arg ("polygons"),
+    "@brief Inserts many simple polygons into the region\n"
+    "This method is equivalent to calling \\insert for each \\SimplePolygon in the array, but faster "
+    "as the memory for the polygons is reserved in advance and the simple polygons are inserted in a single call.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  method_ext ("insert_many", &insert_many<db::Path>, gsi::arg ("paths"),
+    "@brief Inserts many paths into the region\n"
+    "This method is equivalent to calling \\insert for each \\Path in the array, but faster "
+    "as the memory for the polygons is reserved in advance and the paths are inserted in a single call.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  method_ext ("insert_boxes", &insert_boxes, gsi::arg ("coordinates"),
+    "@brief Inserts boxes from a flat coordinate array\n"
+    "The array needs to hold four values per box: left, bottom, right and top in database units. "
+    "For numpy arrays, the packed version taking a byte string is more efficient.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  method_ext ("insert_boxes", &insert_boxes_packed, gsi::arg ("data"), gsi::arg ("width", (unsigned int) 4),
+    "@brief Inserts boxes from a packed coordinate array\n"
+    "@param data The coordinates as packed little-endian signed integers\n"
+    "@param width The number of bytes per value (4 or 8)\n"
+    "This version takes the same four values per box as the list version, but as a byte string. "
+    "In Python, any object supporting the buffer protocol with contiguous memory is accepted too, so a numpy "
+    "array can be passed directly without converting it to a list:\n"
+    "\n"
+    "@code\n"
+    "region.insert_boxes(boxes.astype(\"<i4\"))\n"
+    "@/code\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
   method_ext ("insert", &insert_r, gsi::arg ("region"),
     "@brief Inserts all polygons from the other region into this region\n"
     "This method has been introduced in version 0.25."
@@ -1126,15 +1202,15 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "\n"
     "This function has been introduced in version 0.25.\n"
   ) +
-  method ("merge", (db::Region &(db::Region::*) ()) &db::Region::merge,
+  gsi::long_running (method ("merge", (db::Region &(db::Region::*) ()) &db::Region::merge,
     "@brief Merge the region\n"
     "\n"
     "@return The region after is has been merged (self).\n"
     "\n"
     "Merging removes overlaps and joins touching polygons.\n"
     "If the region is already merged, this method does nothing\n"
-  ) +
-  method_ext ("merge", &merge_ext1, gsi::arg ("min_wc"),
+  )) +
+  gsi::long_running (method_ext ("merge", &merge_ext1, gsi::arg ("min_wc"),
     "@brief Merge the region with options\n"
     "\n"
     "@param min_wc Overlap selection\n"
@@ -1146,8 +1222,8 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "means that output is only produced if two or more polygons overlap.\n"
     "\n"
     "This method is equivalent to \"merge(false, min_wc).\n"
-  ) +
-  method_ext ("merge", &merge_ext2, gsi::arg ("min_coherence"), gsi::arg ("min_wc"),
+  )) +
+  gsi::long_running (method_ext ("merge", &merge_ext2, gsi::arg ("min_coherence"), gsi::arg ("min_wc"),
     "@brief Merge the region with options\n"
     "\n"
     "@param min_coherence A flag indicating whether the resulting polygons shall have minimum coherence\n"
@@ -1159,8 +1235,8 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "resolved by producing separate polygons. \"min_wc\" controls whether output is only produced if multiple "
     "polygons overlap. The value specifies the number of polygons that need to overlap. A value of 2 "
     "means that output is only produced if two or more polygons overlap.\n"
-  ) +
-  method ("merged", (db::Region (db::Region::*) () const) &db::Region::merged,
+  )) +
+  gsi::long_running (method ("merged", (db::Region (db::Region::*) () const) &db::Region::merged,
     "@brief Returns the merged region\n"
     "\n"
     "@return The region after is has been merged.\n"
@@ -1168,8 +1244,8 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "Merging removes overlaps and joins touching polygons.\n"
     "If the region is already merged, this method does nothing.\n"
     "In contrast to \\merge, this method does not modify the region but returns a merged copy.\n"
-  ) +
-  method_ext ("merged", &merged_ext1, gsi::arg ("min_wc"),
+  )) +
+  gsi::long_running (method_ext ("merged", &merged_ext1, gsi::arg ("min_wc"),
     "@brief Returns the merged region (with options)\n"
     "\n"
     "@return The region after is has been merged.\n"
@@ -1181,8 +1257,8 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "This method is equivalent to \"merged(false, min_wc)\".\n"
     "\n"
     "In contrast to \\merge, this method does not modify the region but returns a merged copy.\n"
-  ) +
-  method_ext ("merged", &merged_ext2, gsi::arg ("min_coherence"), gsi::arg ("min_wc"),
+  )) +
+  gsi::long_running (method_ext ("merged", &merged_ext2, gsi::arg ("min_coherence"), gsi::arg ("min_wc"),
     "@brief Returns the merged region (with options)\n"
     "\n"
     "@param min_coherence A flag indicating whether the resulting polygons shall have minimum coherence\n"
@@ -1196,7 +1272,7 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "means that output is only produced if two or more polygons overlap.\n"
     "\n"
     "In contrast to \\merge, this method does not modify the region but returns a merged copy.\n"
-  ) +
+  )) +
   method ("round_corners", &db::Region::round_corners, gsi::arg ("r_inner"), gsi::arg ("r_outer"), gsi::arg ("n"),
     "@brief Corner rounding\n"
     "@param r_inner Inner corner radius (in database units)\n"
@@ -1237,7 +1313,7 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "See \\smooth for a description of this method. This version returns a new region instead of "
     "modifying self (out-of-place). It has been introduced in version 0.25."
   ) +
-  method ("size", (db::Region & (db::Region::*) (db::Coord, db::Coord, unsigned int)) &db::Region::size, gsi::arg ("dx"), gsi::arg ("dy"), gsi::arg ("mode"),
+  gsi::long_running (method ("size", (db::Region & (db::Region::*) (db::Coord, db::Coord, unsigned int)) &db::Region::size, gsi::arg ("dx"), gsi::arg ("dy"), gsi::arg ("mode"),
     "@brief Anisotropic sizing (biasing)\n"
     "\n"
     "@return The region after the sizing has applied (self)\n"
@@ -1374,7 +1450,7 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "\n"
     "The boolean OR is implemented by merging the polygons of both regions. To simply join the regions "
     "without merging, the + operator is more efficient."
-  ) + 
+  )) +
   method ("+", &db::Region::operator+, gsi::arg ("other"),
     "@brief Returns the combined region of self and the other region\n"
     "\n"
@@ -1391,7 +1467,7 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "This operator adds the polygons of the other region to self. "
     "This usually creates unmerged regions and polygons may overlap. Use \\merge if you want to ensure the result region is merged.\n"
   ) + 
-  method ("inside", &db::Region::selected_inside, gsi::arg ("other"),
+  gsi::long_running (method ("inside", &db::Region::selected_inside, gsi::arg ("other"),
     "@brief Returns the polygons of this region which are completely inside polygons from the other region\n"
     "\n"
     "@return A new region containing the polygons which are inside polygons from the other region\n"
@@ -1627,7 +1703,7 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "Merged semantics applies for this method (see \\merged_semantics= of merged semantics)\n"
     "\n"
     "This method has been introduced in version 0.27\n"
-  ) +
+  )) +
   method ("is_box?", &db::Region::is_box,
     "@brief Returns true, if the region is a simple box\n"
     "\n"
@@ -1888,7 +1964,7 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "\n"
     "@return The transformed region.\n"
   ) +
-  method_ext ("width_check", &width1, gsi::arg ("d"),
+  gsi::long_running (method_ext ("width_check", &width1, gsi::arg ("d"),
     "@brief Performs a width check\n"
     "@param d The minimum width for which the polygons are checked\n"
     "Performs a width check against the minimum width \"d\". For locations where a polygon has a "
@@ -2234,7 +2310,7 @@ Class<db::Region> decl_Region (decl_dbShapeCollection, "db", "Region",
     "If you don't want to specify one limit, pass nil to the respective value.\n"
     "\n"
     "Merged semantics applies for the input of this method (see \\merged_semantics= of merged semantics)\n"
-  ) +
+  )) +
   method_ext ("area", &area1,
     "@brief The area of the region\n"
     "\n"
@@ -25,12 +25,16 @@
 
 #include "gsiDeclDbHelpers.h"
 #include "dbShapes.h"
+#include "dbCoordinateArrays.h"
 #include "dbShape.h"
 #include "dbLayout.h"
 #include "dbRegion.h"
 #include "dbEdgePairs.h"
 #include "dbEdges.h"
 
+#include <algorithm>
+#include <iterator>
+
 namespace gsi
 {
 
@@ -103,6 +107,48 @@ static db::Shape dinsert_with_properties (db::Shapes *s, const Sh &p, db::proper
   return s->insert (db::object_with_properties<ISh> (db::CplxTrans (shapes_dbu (s)).inverted () * p, id));
 }
 
+template<class Sh>
+static void insert_many (db::Shapes *s, const std::vector<Sh> &shapes)
+{
+  //  NOTE: inserting a sequence does the bookkeeping (undo, state invalidation) once
+  //  and reserves the space in the shape layer
+  s->insert (shapes.begin (), shapes.end ());
+}
+
+template<class Sh, class ISh>
+static void dinsert_many (db::Shapes *s, const std::vector<Sh> &shapes)
+{
+  db::VCplxTrans trans = db::CplxTrans (shapes_dbu (s)).inverted ();
+
+  std::vector<ISh> ishapes;
+  ishapes.reserve (shapes.size ());
+  for (typename std::vector<Sh>::const_iterator i = shapes.begin (); i != shapes.end (); ++i) {
+    ishapes.push_back (trans * *i);
+  }
+
+  s->insert (ishapes.begin (), ishapes.end ());
+}
+
+static void insert_boxes (db::Shapes *s, const std::vector<db::Coord> &coords)
+{
+  if ((coords.size () % 4) != 0) {
+    throw tl::Exception (tl::to_string (tr ("Box coordinate array must have four entries (left, bottom, right, top) per box")));
+  }
+
+  std::vector<db::Box> boxes;
+  boxes.reserve (coords.size () / 4);
+  for (size_t i = 0; i < coords.size (); i += 4) {
+    boxes.push_back (db::Box (coords [i], coords [i + 1], coords [i + 2], coords [i + 3]));
+  }
+
+  s->insert (boxes.begin (), boxes.end ());
+}
+
+static void insert_boxes_packed (db::Shapes *s, const std::vector<char> &data, unsigned int width)
+{
+  insert_boxes (s, db::unpack_coordinates (data, width));
+}
+
 static gsi::layout_locking_iterator1<db::Shapes::shape_iterator> begin (const db::Shapes *s, unsigned int flags)
 {
   return gsi::layout_locking_iterator1<db::Shapes::shape_iterator> (s->layout (), s->begin (flags));
@@ -113,6 +159,62 @@ static gsi::layout_locking_iterator1<db::Shapes::shape_iterator>begin_all (const
   return gsi::layout_locking_iterator1<db::Shapes::shape_iterator> (s->layout (), s->begin (db::ShapeIterator::All));
 }
 
+/**
+ *  @brief A layout locking iterator delivering the polygon-type shapes in chunks
+ *
+ *  Each step of this iterator delivers the geometry of up to "n" boxes, polygons or
+ *  paths in a CoordinateArrays object. Script clients hence obtain plain geometry
+ *  for many shapes with one call instead of one Shape object per shape.
+ */
+class coordinate_batch_iterator
+  : private db::LayoutLocker
+{
+public:
+  typedef db::CoordinateArrays value_type;
+  typedef const db::CoordinateArrays &reference;
+  typedef const db::CoordinateArrays *pointer;
+  typedef std::ptrdiff_t difference_type;
+  typedef std::forward_iterator_tag iterator_category;
+
+  coordinate_batch_iterator (const db::Shapes *shapes, unsigned int flags, size_t n)
+    : db::LayoutLocker (const_cast<db::Layout *> (shapes->layout ())),
+      m_i (shapes->begin (flags & (db::ShapeIterator::Polygons | db::ShapeIterator::Paths | db::ShapeIterator::Boxes))),
+      m_n (std::max (n, size_t (1)))
+  {
+    fetch ();
+  }
+
+  bool at_end () const { return m_batch.size () == 0; }
+  void operator++ () { fetch (); }
+
+  reference operator* () const { return m_batch; }
+  pointer operator-> () const { return &m_batch; }
+
+private:
+  db::ShapeIterator m_i;
+  size_t m_n;
+  db::CoordinateArrays m_batch;
+  db::Polygon m_poly;
+
+  void fetch ()
+  {
+    m_batch.clear ();
+    while (m_batch.size () < m_n && ! m_i.at_end ()) {
+      if (m_i->is_box ()) {
+        m_batch.add (m_i->box ());
+      } else if (m_i->polygon (m_poly)) {
+        m_batch.add (m_poly);
+      }
+      ++m_i;
+    }
+  }
+};
+
+static coordinate_batch_iterator begin_batch (const db::Shapes *s, size_t n, unsigned int flags)
+{
+  return coordinate_batch_iterator (s, flags, n);
+}
+
 static gsi::layout_locking_iterator1<db::Shapes::shape_iterator>begin_overlapping (const db::Shapes *s, unsigned int flags, const db::Box &region)
 {
   return gsi::layout_locking_iterator1<db::Shapes::shape_iterator> (s->layout (), s->begin_overlapping (region, flags));
@@ -1026,6 +1128,111 @@ Class<db::Shapes> decl_Shapes ("db", "Shapes",
     "\n"
     "This variant has been introduced in version 0.25."
   ) +
+  gsi::method_ext ("insert_many", &insert_many<db::Box>, gsi::arg ("boxes"),
+    "@brief Inserts many boxes into the shapes list\n"
+    "This method is equivalent to calling \\insert for each \\Box in the array, but much faster "
+    "as the boxes are inserted in a single call. Undo bookkeeping is done once for the whole array.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  gsi::method_ext ("insert_many", &dinsert_many<db::DBox, db::Box>, gsi::arg ("boxes"),
+    "@brief Inserts many micrometer-unit boxes into the shapes list\n"
+    "This method behaves like the \\insert_many version with a \\Box array, except that it will "
+    "internally translate the boxes from micrometer to database units.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  gsi::method_ext ("insert_many", &insert_many<db::Path>, gsi::arg ("paths"),
+    "@brief Inserts many paths into the shapes list\n"
+    "This method is equivalent to calling \\insert for each \\Path in the array, but much faster "
+    "as the paths are inserted in a single call. Undo bookkeeping is done once for the whole array.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  gsi::method_ext ("insert_many", &dinsert_many<db::DPath, db::Path>, gsi::arg ("paths"),
+    "@brief Inserts many micrometer-unit paths into the shapes list\n"
+    "This method behaves like the \\insert_many version with a \\Path array, except that it will "
+    "internally translate the paths from micrometer to database units.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  gsi::method_ext ("insert_many", &insert_many<db::Edge>, gsi::arg ("edges"),
+    "@brief Inserts many edges into the shapes list\n"
+    "This method is equivalent to calling \\insert for each \\Edge in the array, but much faster "
+    "as the edges are inserted in a single call. Undo bookkeeping is done once for the whole array.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  gsi::method_ext ("insert_many", &dinsert_many<db::DEdge, db::Edge>, gsi::arg ("edges"),
+    "@brief Inserts many micrometer-unit edges into the shapes list\n"
+    "This method behaves like the \\insert_many version with a \\Edge array, except that it will "
+    "internally translate the edges from micrometer to database units.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  gsi::method_ext ("insert_many", &insert_many<db::Text>, gsi::arg ("texts"),
+    "@brief Inserts many texts into the shapes list\n"
+    "This method is equivalent to calling \\insert for each \\Text in the array, but much faster "
+    "as the texts are inserted in a single call. Undo bookkeeping is done once for the whole array.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  gsi::method_ext ("insert_many", &dinsert_many<db::DText, db::Text>, gsi::arg ("texts"),
+    "@brief Inserts many micrometer-unit texts into the shapes list\n"
+    "This method behaves like the \\insert_many version with a \\Text array, except that it will "
+    "internally translate the texts from micrometer to database units.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  gsi::method_ext ("insert_many", &insert_many<db::SimplePolygon>, gsi::arg ("simple_polygons"),
+    "@brief Inserts many simple polygons into the shapes list\n"
+    "This method is equivalent to calling \\insert for each \\SimplePolygon in the array, but much faster "
+    "as the simple polygons are inserted in a single call. Undo bookkeeping is done once for the whole array.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  gsi::method_ext ("insert_many", &dinsert_many<db::DSimplePolygon, db::SimplePolygon>, gsi::arg ("simple_polygons"),
+    "@brief Inserts many micrometer-unit simple polygons into the shapes list\n"
+    "This method behaves like the \\insert_many version with a \\SimplePolygon array, except that it will "
+    "internally translate the simple polygons from micrometer to database units.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  gsi::method_ext ("insert_many", &insert_many<db::Polygon>, gsi::arg ("polygons"),
+    "@brief Inserts many polygons into the shapes list\n"
+    "This method is equivalent to calling \\insert for each \\Polygon in the array, but much faster "
+    "as the polygons are inserted in a single call. Undo bookkeeping is done once for the whole array.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  gsi::method_ext ("insert_many", &dinsert_many<db::DPolygon, db::Polygon>, gsi::arg ("polygons"),
+    "@brief Inserts many micrometer-unit polygons into the shapes list\n"
+    "This method behaves like the \\insert_many version with a \\Polygon array, except that it will "
+    "internally translate the polygons from micrometer to database units.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  gsi::method_ext ("insert_boxes", &insert_boxes, gsi::arg ("coordinates"),
+    "@brief Inserts boxes from a flat coordinate array\n"
+    "The array needs to hold four values per box: left, bottom, right and top in database units. "
+    "For numpy arrays, the packed version taking a byte string is more efficient.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
+  gsi::method_ext ("insert_boxes", &insert_boxes_packed, gsi::arg ("data"), gsi::arg ("width", (unsigned int) 4),
+    "@brief Inserts boxes from a packed coordinate array\n"
+    "@param data The coordinates as packed little-endian signed integers\n"
+    "@param width The number of bytes per value (4 or 8)\n"
+    "This version takes the same four values per box as the list version, but as a byte string. "
+    "In Python, any object supporting the buffer protocol with contiguous memory is accepted too, so a numpy "
+    "array can be passed directly without converting it to a list:\n"
+    "\n"
+    "@code\n"
+    "shapes.insert_boxes(boxes.astype(\"<i4\"))\n"
+    "@/code\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
   gsi::method_ext ("insert|#insert_box_with_properties", &insert_with_properties<db::Box>, gsi::arg ("box"), gsi::arg ("property_id"),
     "@brief Inserts a box with properties into the shapes list\n"
     "@return A reference to the new shape (a \\Shape object)\n"
@@ -1148,6 +1355,28 @@ Class<db::Shapes> decl_Shapes ("db", "Shapes",
     "\n"
     "This call is equivalent to each(SAll). This convenience method has been introduced in version 0.16\n"
   ) +
+  gsi::iterator_ext ("each_batch", &begin_batch, gsi::arg ("n"), gsi::arg ("flags", (unsigned int) db::ShapeIterator::All, "SAll"),
+    "@brief Gets the geometry of the boxes, polygons and paths in chunks of up to n shapes\n"
+    "\n"
+    "@param n The maximum number of shapes per chunk\n"
+    "@param flags An \"or\"-ed combination of the S... constants\n"
+    "\n"
+    "This iterator delivers a \\CoordinateArrays object with the polygons of up to 'n' shapes per step. "
+    "Boxes are delivered as polygons with four points, paths are converted to polygons. Other shapes "
+    "(edges, texts etc.) are skipped. The polygons are delivered in the order of \\each.\n"
+    "\n"
+    "No \\Shape object is created per shape, so this method is much faster in script code when the "
+    "geometry of many shapes needs to be visited. With the packed arrays of \\CoordinateArrays, a chunk "
+    "can be turned into numpy arrays directly:\n"
+    "\n"
+    "@code\n"
+    "for ca in shapes.each_batch(10000):\n"
+    "  xy = numpy.frombuffer(ca.coordinates_bytes(4), dtype=\"<i4\").reshape(-1, 2)\n"
+    "  ...\n"
+    "@/code\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
   gsi::iterator_ext ("each_touching", &begin_touching, gsi::arg ("flags"), gsi::arg ("region"),
     "@brief Gets all shapes that touch the search box (region)\n"
     "This method was introduced in version 0.16\n"
@@ -0,0 +1,163 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "tlUnitTest.h"
+#include "dbContentHash.h"
+#include "dbLayout.h"
+#include "dbLayoutUtils.h"
+
+TEST(1_ShapesHash)
+{
+  db::Shapes s1, s2;
+
+  EXPECT_EQ (db::shapes_content_hash (s1) == 0, true);
+
+  s1.insert (db::Box (0, 0, 100, 200));
+  s1.insert (db::Polygon (db::Box (10, 10, 20, 20)));
+  s1.insert (db::Text ("A", db::Trans (db::Vector (1, 2))));
+
+  //  order does not matter
+  s2.insert (db::Text ("A", db::Trans (db::Vector (1, 2))));
+  s2.insert (db::Polygon (db::Box (10, 10, 20, 20)));
+  s2.insert (db::Box (0, 0, 100, 200));
+
+  EXPECT_EQ (db::shapes_content_hash (s1) == db::shapes_content_hash (s2), true);
+  EXPECT_EQ (db::shapes_content_hash (s1) == 0, false);
+
+  //  text attributes matter
+  db::Shapes s3;
+  s3.insert (db::Text ("A", db::Trans (db::Vector (1, 2)), 17));
+  s3.insert (db::Polygon (db::Box (10, 10, 20, 20)));
+  s3.insert (db::Box (0, 0, 100, 200));
+
+  EXPECT_EQ (db::shapes_content_hash (s1) == db::shapes_content_hash (s3), false);
+
+  //  a box is not the same than a polygon
+  db::Shapes s4;
+  s4.insert (db::Text ("A", db::Trans (db::Vector (1, 2))));
+  s4.insert (db::Box (10, 10, 20, 20));
+  s4.insert (db::Box (0, 0, 100, 200));
+
+  EXPECT_EQ (db::shapes_content_hash (s1) == db::shapes_content_hash (s4), false);
+
+  //  duplicates matter
+  s4.insert (db::Box (0, 0, 100, 200));
+  db::Shapes s5;
+  s5.insert (db::Box (0, 0, 100, 200));
+
+  EXPECT_EQ (db::shapes_content_hash (s4) == db::shapes_content_hash (s5), false);
+}
+
+TEST(2_ShapesHashWithProperties)
+{
+  db::Layout la, lb, n;
+
+  db::PropertiesRepository::properties_set ps_a;
+  ps_a.insert (std::make_pair (la.properties_repository ().prop_name_id (tl::Variant ("X")), tl::Variant (17)));
+  db::properties_id_type pa = la.properties_repository ().properties_id (ps_a);
+
+  //  creates an offset in the properties IDs of lb
+  db::PropertiesRepository::properties_set ps_dummy;
+  ps_dummy.insert (std::make_pair (lb.properties_repository ().prop_name_id (tl::Variant ("Y")), tl::Variant (1)));
+  lb.properties_repository ().properties_id (ps_dummy);
+
+  db::PropertiesRepository::properties_set ps_b;
+  ps_b.insert (std::make_pair (lb.properties_repository ().prop_name_id (tl::Variant ("X")), tl::Variant (17)));
+  db::properties_id_type pb = lb.properties_repository ().properties_id (ps_b);
+
+  EXPECT_EQ (pa == pb, false);
+
+  db::Shapes sa, sb, sc;
+  sa.insert (db::BoxWithProperties (db::Box (0, 0, 100, 200), pa));
+  sb.insert (db::BoxWithProperties (db::Box (0, 0, 100, 200), pb));
+  sc.insert (db::Box (0, 0, 100, 200));
+
+  db::PropertyMapper pm_a (n, la);
+  db::PropertyMapper pm_b (n, lb);
+
+  //  properties are normalized through the property mapper
+  EXPECT_EQ (db::shapes_content_hash (sa, &pm_a) == db::shapes_content_hash (sb, &pm_b), true);
+  EXPECT_EQ (db::shapes_content_hash (sa, &pm_a) == db::shapes_content_hash (sc, &pm_b), false);
+
+  //  without a property mapper, properties are ignored
+  EXPECT_EQ (db::shapes_content_hash (sa) == db::shapes_content_hash (sc), true);
+}
+
+static void
+make_layout (db::Layout &l, const char *child_name, db::Coord dx)
+{
+  unsigned int l1 = l.insert_layer (db::LayerProperties (1, 0));
+  unsigned int l2 = l.insert_layer (db::LayerProperties (2, 0));
+
+  db::cell_index_type top = l.add_cell ("TOP");
+  db::cell_index_type child = l.add_cell (child_name);
+  db::cell_index_type empty = l.add_cell ("EMPTY");
+
+  l.cell (child).shapes (l1).insert (db::Box (0, 0, 100, 100));
+  l.cell (child).shapes (l2).insert (db::Box (0, 0, 10 + dx, 10));
+  l.cell (top).shapes (l1).insert (db::Box (-100, -100, 0, 0));
+
+  l.cell (top).insert (db::CellInstArray (db::CellInst (child), db::Trans (db::Vector (200, 0))));
+  l.cell (top).insert (db::CellInstArray (db::CellInst (child), db::Trans (db::Vector (0, 0)), db::Vector (0, 200), db::Vector (200, 0), 3, 2));
+  l.cell (top).insert (db::CellInstArray (db::CellInst (empty), db::Trans (db::Vector (-500, 0))));
+}
+
+TEST(3_SubtreeHashes)
+{
+  db::Layout la, lb, lc;
+  make_layout (la, "A", 0);
+  make_layout (lb, "B", 0);
+  make_layout (lc, "A", 5);
+
+  db::cell_index_type top_a = la.cell_by_name ("TOP").second;
+  db::cell_index_type top_b = lb.cell_by_name ("TOP").second;
+  db::cell_index_type top_c = lc.cell_by_name ("TOP").second;
+
+  db::SubtreeContentHashes ha1 (la, 0), hb1 (lb, 0), hc1 (lc, 0);
+  db::SubtreeContentHashes ha2 (la, 1), hb2 (lb, 1), hc2 (lc, 1);
+
+  //  cell names don't matter
+  EXPECT_EQ (ha1.hash (top_a) == hb1.hash (top_b), true);
+  EXPECT_EQ (ha2.hash (top_a) == hb2.hash (top_b), true);
+
+  //  a change in the child cell on layer 2 changes the top cell's hash on layer 2 only
+  EXPECT_EQ (ha1.hash (top_a) == hc1.hash (top_c), true);
+  EXPECT_EQ (ha2.hash (top_a) == hc2.hash (top_c), false);
+
+  //  empty cells give a hash of 0 and their instances do not contribute
+  EXPECT_EQ (ha1.hash (la.cell_by_name ("EMPTY").second) == 0, true);
+
+  db::Layout ld;
+  make_layout (ld, "A", 0);
+  db::cell_index_type top_d = ld.cell_by_name ("TOP").second;
+  ld.cell (top_d).insert (db::CellInstArray (db::CellInst (ld.cell_by_name ("EMPTY").second), db::Trans (db::Vector (-700, 0))));
+
+  db::SubtreeContentHashes hd1 (ld, 0);
+  EXPECT_EQ (ha1.hash (top_a) == hd1.hash (top_d), true);
+
+  //  a change of the placement matters
+  ld.cell (top_d).insert (db::CellInstArray (db::CellInst (ld.cell_by_name ("A").second), db::Trans (db::Vector (-700, 0))));
+
+  db::SubtreeContentHashes hd1b (ld, 0);
+  EXPECT_EQ (ha1.hash (top_a) == hd1b.hash (top_d), false);
+}
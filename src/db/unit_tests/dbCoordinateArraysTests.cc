@@ -0,0 +1,213 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "dbCoordinateArrays.h"
+#include "tlUnitTest.h"
+
+TEST(1)
+{
+  db::CoordinateArrays ca;
+  EXPECT_EQ (ca.size (), size_t (0));
+  EXPECT_EQ (ca.points (), size_t (0));
+
+  ca.add (db::Box (0, 0, 100, 200));
+
+  db::Polygon p;
+  db::Point hull[] = { db::Point (0, 0), db::Point (0, 1000), db::Point (1000, 1000), db::Point (1000, 0) };
+  db::Point hole[] = { db::Point (100, 100), db::Point (200, 100), db::Point (200, 200), db::Point (100, 200) };
+  p.assign_hull (hull + 0, hull + 4);
+  p.insert_hole (hole + 0, hole + 4);
+  ca.add (p);
+
+  //  empty boxes are skipped
+  ca.add (db::Box ());
+
+  EXPECT_EQ (ca.size (), size_t (2));
+  EXPECT_EQ (ca.points (), size_t (12));
+  EXPECT_EQ (ca.coordinates ().size (), size_t (24));
+  EXPECT_EQ (ca.contour_offsets ().size (), size_t (4));
+  EXPECT_EQ (ca.contour_offsets () [1], size_t (4));
+  EXPECT_EQ (ca.contour_offsets () [3], size_t (12));
+  EXPECT_EQ (ca.polygon_offsets ().size (), size_t (3));
+  EXPECT_EQ (ca.polygon_offsets () [1], size_t (1));
+  EXPECT_EQ (ca.polygon_offsets () [2], size_t (3));
+
+  EXPECT_EQ (ca.polygon (0).to_string (), "(0,0;0,200;100,200;100,0)");
+  EXPECT_EQ (ca.polygon (1).to_string (), p.to_string ());
+  EXPECT_EQ (ca.polygon (2).to_string (), "()");
+
+  //  round trip through the plain arrays
+  db::CoordinateArrays ca2 (ca.coordinates (), ca.contour_offsets (), ca.polygon_offsets ());
+  EXPECT_EQ (ca2.size (), size_t (2));
+  EXPECT_EQ (ca2.polygon (1) == p, true);
+
+  ca2.clear ();
+  EXPECT_EQ (ca2.size (), size_t (0));
+  EXPECT_EQ (ca2.contour_offsets ().size (), size_t (1));
+}
+
+TEST(2)
+{
+  //  consistency checks
+  std::vector<db::Coord> c;
+  c.push_back (0); c.push_back (0);
+  c.push_back (0); c.push_back (10);
+  c.push_back (10); c.push_back (0);
+
+  std::vector<size_t> co;
+  co.push_back (0);
+  co.push_back (3);
+
+  std::vector<size_t> po;
+  po.push_back (0);
+  po.push_back (1);
+
+  db::CoordinateArrays ca (c, co, po);
+  EXPECT_EQ (ca.polygon (0).to_string (), "(0,0;0,10;10,0)");
+
+  bool error = false;
+  try {
+    c.push_back (1);
+    db::CoordinateArrays (c, co, po);
+  } catch (tl::Exception &) {
+    error = true;
+  }
+  EXPECT_EQ (error, true);
+  c.pop_back ();
+
+  error = false;
+  try {
+    co.back () = 2;
+    db::CoordinateArrays (c, co, po);
+  } catch (tl::Exception &) {
+    error = true;
+  }
+  EXPECT_EQ (error, true);
+  co.back () = 3;
+
+  error = false;
+  try {
+    po.back () = 2;
+    db::CoordinateArrays (c, co, po);
+  } catch (tl::Exception &) {
+    error = true;
+  }
+  EXPECT_EQ (error, true);
+}
+
+TEST(3)
+{
+  db::CoordinateArrays ca;
+  ca.add (db::Box (-1, 0, 256, 2));
+
+  //  4 points, 8 coordinates: -1,0;-1,2;256,2;256,0
+  std::vector<char> c4 = ca.packed_coordinates (4);
+  EXPECT_EQ (c4.size (), size_t (32));
+  EXPECT_EQ (int ((unsigned char) c4 [0]), 0xff);
+  EXPECT_EQ (int ((unsigned char) c4 [3]), 0xff);
+  EXPECT_EQ (int ((unsigned char) c4 [4]), 0);
+  EXPECT_EQ (int ((unsigned char) c4 [16]), 0);
+  EXPECT_EQ (int ((unsigned char) c4 [17]), 1);
+  EXPECT_EQ (int ((unsigned char) c4 [20]), 2);
+
+  std::vector<char> c8 = ca.packed_coordinates (8);
+  EXPECT_EQ (c8.size (), size_t (64));
+  EXPECT_EQ (int ((unsigned char) c8 [7]), 0xff);
+  EXPECT_EQ (int ((unsigned char) c8 [8]), 0);
+
+  std::vector<char> co = ca.packed_contour_offsets (8);
+  EXPECT_EQ (co.size (), size_t (16));
+  EXPECT_EQ (int (co [0]), 0);
+  EXPECT_EQ (int (co [8]), 4);
+
+  std::vector<char> po = ca.packed_polygon_offsets (4);
+  EXPECT_EQ (po.size (), size_t (8));
+  EXPECT_EQ (int (po [4]), 1);
+
+  bool error = false;
+  try {
+    ca.packed_coordinates (2);
+  } catch (tl::Exception &) {
+    error = true;
+  }
+  EXPECT_EQ (error, true);
+}
+
+TEST(4)
+{
+  db::CoordinateArrays ca;
+  ca.add (db::Box (-1, 0, 256, 2));
+
+  db::Polygon p;
+  db::Point hull[] = { db::Point (-100000, 0), db::Point (-100000, 1000), db::Point (1000, 1000), db::Point (1000, 0) };
+  db::Point hole[] = { db::Point (100, 100), db::Point (200, 100), db::Point (200, 200), db::Point (100, 200) };
+  p.assign_hull (hull + 0, hull + 4);
+  p.insert_hole (hole + 0, hole + 4);
+  ca.add (p);
+
+  //  round trip through the packed arrays
+  db::CoordinateArrays ca4 = db::CoordinateArrays::from_packed (ca.packed_coordinates (4), ca.packed_contour_offsets (8), ca.packed_polygon_offsets (8), 4, 8);
+  EXPECT_EQ (ca4.size (), size_t (2));
+  EXPECT_EQ (ca4.polygon (0).to_string (), "(-1,0;-1,2;256,2;256,0)");
+  EXPECT_EQ (ca4.polygon (1) == p, true);
+
+  db::CoordinateArrays ca8 = db::CoordinateArrays::from_packed (ca.packed_coordinates (8), ca.packed_contour_offsets (4), ca.packed_polygon_offsets (4), 8, 4);
+  EXPECT_EQ (ca8.coordinates () == ca.coordinates (), true);
+  EXPECT_EQ (ca8.contour_offsets () == ca.contour_offsets (), true);
+  EXPECT_EQ (ca8.polygon_offsets () == ca.polygon_offsets (), true);
+
+  //  empty offset arrays
+  db::CoordinateArrays ca0 = db::CoordinateArrays::from_packed (std::vector<char> (), std::vector<char> (), std::vector<char> (), 4, 8);
+  EXPECT_EQ (ca0.size (), size_t (0));
+
+  //  size not a multiple of the width
+  bool error = false;
+  try {
+    std::vector<char> c = ca.packed_coordinates (4);
+    c.pop_back ();
+    db::CoordinateArrays::from_packed (c, ca.packed_contour_offsets (8), ca.packed_polygon_offsets (8), 4, 8);
+  } catch (tl::Exception &) {
+    error = true;
+  }
+  EXPECT_EQ (error, true);
+
+  //  negative offsets are not allowed
+  error = false;
+  try {
+    std::vector<char> co = ca.packed_contour_offsets (4);
+    co [4] = co [5] = co [6] = co [7] = char (0xff);
+    db::CoordinateArrays::from_packed (ca.packed_coordinates (4), co, ca.packed_polygon_offsets (4), 4, 4);
+  } catch (tl::Exception &) {
+    error = true;
+  }
+  EXPECT_EQ (error, true);
+
+  //  offsets not matching the coordinates
+  error = false;
+  try {
+    db::CoordinateArrays::from_packed (ca.packed_coordinates (4), ca.packed_contour_offsets (4), ca.packed_polygon_offsets (4), 4, 8);
+  } catch (tl::Exception &) {
+    error = true;
+  }
+  EXPECT_EQ (error, true);
+}
@@ -26,6 +26,7 @@
 #include "dbDeepRegion.h"
 #include "tlUnitTest.h"
 #include "tlStream.h"
+#include "tlThreads.h"
 
 TEST(1)
 {
@@ -265,3 +266,71 @@ TEST(5_State)
   EXPECT_EQ (store.breakout_cells (0)->find (5) != store.breakout_cells (0)->end (), true);
   EXPECT_EQ (store.breakout_cells (0)->find (3) != store.breakout_cells (0)->end (), true);
 }
+
+namespace {
+
+  class DeepLayerCopyThread
+    : public tl::Thread
+  {
+  public:
+    DeepLayerCopyThread (const db::DeepLayer &dl1, const db::DeepLayer &dl2)
+      : m_dl1 (dl1), m_dl2 (dl2)
+    { }
+
+    void run ()
+    {
+      //  copying deep layers registers weak pointers to the same store
+      for (int i = 0; i < 100000; ++i) {
+        db::DeepLayer dl1 (m_dl1);
+        db::DeepLayer dl2 (m_dl2);
+        dl1 = dl2;
+        dl2 = db::DeepLayer ();
+      }
+    }
+
+  private:
+    db::DeepLayer m_dl1, m_dl2;
+  };
+
+}
+
+//  concurrent copies of deep layers from the same store
+TEST(6_ConcurrentRefCounting)
+{
+  db::DeepShapeStore store;
+  db::Layout layout;
+
+  unsigned int l1 = layout.insert_layer ();
+  unsigned int l2 = layout.insert_layer ();
+  db::cell_index_type c1 = layout.add_cell ("C1");
+  layout.cell (c1).shapes (l1).insert (db::Box (0, 1, 2, 3));
+  layout.cell (c1).shapes (l2).insert (db::Box (0, 1, 2, 3));
+
+  db::DeepLayer dl1 = store.create_polygon_layer (db::RecursiveShapeIterator (layout, layout.cell (c1), l1));
+  db::DeepLayer dl2 = store.create_polygon_layer (db::RecursiveShapeIterator (layout, layout.cell (c1), l2));
+  unsigned int lyi = dl1.layout_index ();
+
+  std::vector<DeepLayerCopyThread *> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.push_back (new DeepLayerCopyThread (dl1, dl2));
+  }
+
+  for (std::vector<DeepLayerCopyThread *>::const_iterator t = threads.begin (); t != threads.end (); ++t) {
+    (*t)->start ();
+  }
+  for (std::vector<DeepLayerCopyThread *>::const_iterator t = threads.begin (); t != threads.end (); ++t) {
+    (*t)->wait ();
+    delete *t;
+  }
+
+  //  the references of the threads are all gone now
+  EXPECT_EQ (shapes_in_top (store.const_layout (lyi), dl1.layer ()), size_t (1));
+  EXPECT_EQ (shapes_in_top (store.const_layout (lyi), dl2.layer ()), size_t (1));
+
+  dl1 = db::DeepLayer ();
+  EXPECT_EQ (shapes_in_top (store.const_layout (lyi), l1), size_t (0));
+  EXPECT_EQ (shapes_in_top (store.const_layout (lyi), l2), size_t (1));
+
+  dl2 = db::DeepLayer ();
+  EXPECT_EQ (store.is_valid_layout_index (lyi), false);
+}
@@ -1473,3 +1473,199 @@ TEST(7)
 }
 
 
+
+//  identical cells are skipped - normalization still applies to the others
+TEST(8)
+{
+  db::Layout g;
+  g.insert_layer (0);
+  g.set_properties (0, db::LayerProperties (17, 0));
+  g.insert_layer (1);
+  g.set_properties (1, db::LayerProperties (42, 1));
+
+  db::cell_index_type c1i = g.add_cell ("c1");
+  db::cell_index_type c2i = g.add_cell ("c2");
+  db::cell_index_type c3i = g.add_cell ("c3");
+
+  g.cell (c3i).shapes (0).insert (db::Box (0, 0, 100, 200));
+  g.cell (c3i).shapes (1).insert (db::Text ("T", db::Trans (db::Vector (10, 20)), 5));
+  g.cell (c2i).shapes (0).insert (db::Polygon (db::Box (0, 0, 10, 10)));
+  g.cell (c2i).insert (db::CellInstArray (db::CellInst (c3i), db::Trans (db::Vector (100, 0))));
+  g.cell (c1i).insert (db::CellInstArray (db::CellInst (c2i), db::Trans (db::Vector (0, 0)), db::Vector (0, 1000), db::Vector (1000, 0), 10, 10));
+
+  db::Layout h = g;
+
+  TestDifferenceReceiver r;
+  bool eq;
+
+  eq = db::compare_layouts (g, h, db::layout_diff::f_verbose, 0, r);
+
+  EXPECT_EQ (eq, true);
+  EXPECT_EQ (r.text (), "");
+
+  //  text size only
+  h.cell (c3i).shapes (1).clear ();
+  h.cell (c3i).shapes (1).insert (db::Text ("T", db::Trans (db::Vector (10, 20)), 6));
+
+  r.clear ();
+  eq = db::compare_layouts (g, h, 0, 0, r);
+
+  EXPECT_EQ (eq, false);
+  EXPECT_EQ (r.text (), "layout_diff: texts differ for layer 42/1 in cell c3\n");
+
+  r.clear ();
+  eq = db::compare_layouts (g, h, db::layout_diff::f_no_text_orientation, 0, r);
+
+  EXPECT_EQ (eq, true);
+  EXPECT_EQ (r.text (), "");
+
+  //  properties with different IDs
+  h = g;
+
+  db::PropertiesRepository::properties_set ps;
+  ps.insert (std::make_pair (g.properties_repository ().prop_name_id (tl::Variant ("X")), tl::Variant (17)));
+  g.cell (c2i).shapes (0).insert (db::BoxWithProperties (db::Box (0, 0, 1, 1), g.properties_repository ().properties_id (ps)));
+
+  ps.clear ();
+  ps.insert (std::make_pair (h.properties_repository ().prop_name_id (tl::Variant ("Y")), tl::Variant (1)));
+  h.properties_repository ().properties_id (ps);
+  ps.clear ();
+  ps.insert (std::make_pair (h.properties_repository ().prop_name_id (tl::Variant ("X")), tl::Variant (17)));
+  h.cell (c2i).shapes (0).insert (db::BoxWithProperties (db::Box (0, 0, 1, 1), h.properties_repository ().properties_id (ps)));
+
+  r.clear ();
+  eq = db::compare_layouts (g, h, 0, 0, r);
+
+  EXPECT_EQ (eq, true);
+  EXPECT_EQ (r.text (), "");
+
+  //  instance placement
+  h.cell (c2i).clear_insts ();
+  h.cell (c2i).insert (db::CellInstArray (db::CellInst (c3i), db::Trans (db::Vector (101, 0))));
+
+  r.clear ();
+  eq = db::compare_layouts (g, h, 0, 0, r);
+
+  EXPECT_EQ (eq, false);
+  EXPECT_EQ (r.text (),
+    "layout_diff: bounding boxes differ for cell c1, (0,0;9200,9200) vs. (0,0;9201,9200)\n"
+    "layout_diff: per-layer bounding boxes differ for cell c1, layer (17/0), (0,0;9200,9200) vs. (0,0;9201,9200)\n"
+    "layout_diff: per-layer bounding boxes differ for cell c1, layer (42/1), (110,20;9110,9020) vs. (111,20;9111,9020)\n"
+    "layout_diff: bounding boxes differ for cell c2, (0,0;200,200) vs. (0,0;201,200)\n"
+    "layout_diff: instances differ in cell c2\n"
+    "layout_diff: per-layer bounding boxes differ for cell c2, layer (17/0), (0,0;200,200) vs. (0,0;201,200)\n"
+    "layout_diff: per-layer bounding boxes differ for cell c2, layer (42/1), (110,20;110,20) vs. (111,20;111,20)\n"
+  );
+}
+
+TEST(9)
+{
+  //  multi-threaded compare delivers the same results as single-threaded compare
+
+  db::Layout g;
+  g.insert_layer (0);
+  g.set_properties (0, db::LayerProperties (17, 0));
+  g.insert_layer (1);
+  g.set_properties (1, db::LayerProperties (42, 1));
+
+  db::PropertiesRepository::properties_set ps;
+  ps.insert (std::make_pair (g.properties_repository ().prop_name_id (tl::Variant ("X")), tl::Variant (17)));
+  db::properties_id_type pid = g.properties_repository ().properties_id (ps);
+
+  db::cell_index_type top = g.add_cell ("TOP");
+  std::vector<db::cell_index_type> cells;
+  for (int i = 0; i < 20; ++i) {
+
+    db::cell_index_type ci = g.add_cell (("C" + tl::to_string (i)).c_str ());
+    cells.push_back (ci);
+
+    for (int j = 0; j < 10; ++j) {
+      g.cell (ci).shapes (0).insert (db::Box (j * 100, i * 10, j * 100 + 50, i * 10 + 20));
+      g.cell (ci).shapes (0).insert (db::Polygon (db::Box (j * 100, 0, j * 100 + 10, 10)));
+      g.cell (ci).shapes (1).insert (db::Text ("T" + tl::to_string (j), db::Trans (db::Vector (j * 10, i))));
+      g.cell (ci).shapes (1).insert (db::BoxWithProperties (db::Box (0, 0, j + 1, i + 1), pid));
+    }
+
+    g.cell (top).insert (db::CellInstArray (db::CellInst (ci), db::Trans (db::Vector (0, i * 1000))));
+
+  }
+
+  db::Layout h = g;
+
+  TestDifferenceReceiver r0, r4;
+  bool eq;
+
+  eq = db::compare_layouts (g, h, db::layout_diff::f_verbose, 0, r4, 4);
+  EXPECT_EQ (eq, true);
+  EXPECT_EQ (r4.text (), "");
+
+  //  polygons with a different start point are identical
+  db::Point pts[] = { db::Point (100, 0), db::Point (110, 0), db::Point (110, 10), db::Point (100, 10) };
+  db::Polygon p;
+  p.assign_hull (pts, pts + sizeof (pts) / sizeof (pts [0]), false /*don't normalize*/);
+  h.cell (cells [3]).shapes (0).clear ();
+  for (int j = 0; j < 10; ++j) {
+    h.cell (cells [3]).shapes (0).insert (db::Box (j * 100, 30, j * 100 + 50, 50));
+    if (j != 1) {
+      h.cell (cells [3]).shapes (0).insert (db::Polygon (db::Box (j * 100, 0, j * 100 + 10, 10)));
+    }
+  }
+  h.cell (cells [3]).shapes (0).insert (p);
+
+  eq = db::compare_layouts (g, h, db::layout_diff::f_verbose, 0, r4, 4);
+  EXPECT_EQ (eq, true);
+  EXPECT_EQ (r4.text (), "");
+
+  //  some differences in various cells
+  h.cell (cells [2]).shapes (0).insert (db::Box (1, 2, 3, 4));
+  h.cell (cells [5]).shapes (1).insert (db::Text ("X", db::Trans ()));
+  h.cell (cells [11]).shapes (0).insert (db::Polygon (db::Box (1, 2, 3, 4)));
+  h.cell (cells [17]).shapes (1).insert (db::BoxWithProperties (db::Box (0, 0, 100, 100), pid));
+  h.cell (cells [17]).insert (db::CellInstArray (db::CellInst (cells [2]), db::Trans ()));
+
+  eq = db::compare_layouts (g, h, db::layout_diff::f_verbose, 0, r0, 0);
+  EXPECT_EQ (eq, false);
+
+  r4.clear ();
+  eq = db::compare_layouts (g, h, db::layout_diff::f_verbose, 0, r4, 4);
+  EXPECT_EQ (eq, false);
+  EXPECT_EQ (r4.text (), r0.text ());
+  EXPECT_EQ (r0.text (),
+    "layout_diff: polygons differ for layer 17/0 in cell C11\n"
+    "Not in b but in a:\n"
+    "Not in a but in b:\n"
+    "  (1,2;1,4;3,4;3,2)\n"
+    "layout_diff: instances differ in cell C17\n"
+    "list for a:\n"
+    "list for b:\n"
+    "  C2 r0 *1 0,0\n"
+    "Not in b but in a:\n"
+    "Not in a but in b:\n"
+    "  C2 r0 *1 0,0layout_diff: boxes differ for layer 42/1 in cell C17\n"
+    "Not in b but in a:\n"
+    "Not in a but in b:\n"
+    "  (0,0;100,100) [1]\n"
+    "layout_diff: boxes differ for layer 17/0 in cell C2\n"
+    "Not in b but in a:\n"
+    "Not in a but in b:\n"
+    "  (1,2;3,4)\n"
+    "layout_diff: texts differ for layer 42/1 in cell C5\n"
+    "Not in b but in a:\n"
+    "Not in a but in b:\n"
+    "  ('X',r0 0,0)\n"
+  );
+
+  r0.clear ();
+  eq = db::compare_layouts (g, h, 0, 0, r0, 0);
+  EXPECT_EQ (eq, false);
+
+  r4.clear ();
+  eq = db::compare_layouts (g, h, 0, 0, r4, 4);
+  EXPECT_EQ (eq, false);
+  EXPECT_EQ (r4.text (), r0.text ());
+
+  r4.clear ();
+  eq = db::compare_layouts (g, h, db::layout_diff::f_silent, 0, r4, 4);
+  EXPECT_EQ (eq, false);
+  EXPECT_EQ (r4.text (), "");
+}
@@ -22,6 +22,7 @@
 
 
 #include "dbRecursiveShapeIterator.h"
+#include "dbShapeBatch.h"
 #include "dbRegion.h"
 #include "dbLayoutDiff.h"
 #include "tlString.h"
@@ -1304,3 +1305,55 @@ TEST(10)
     "end\n"
   );
 }
+
+//  ShapeBatch
+TEST(11)
+{
+  db::Layout g;
+  unsigned int l0 = g.insert_layer (db::LayerProperties (1, 0));
+  unsigned int l1 = g.insert_layer (db::LayerProperties (2, 0));
+
+  db::Cell &c0 (g.cell (g.add_cell ()));
+  db::Cell &c1 (g.cell (g.add_cell ()));
+
+  db::Box b (0, 100, 1000, 1200);
+  c0.shapes (l0).insert (b);
+  c1.shapes (l0).insert (b);
+  c1.shapes (l1).insert (b);
+
+  c0.insert (db::CellInstArray (db::CellInst (c1.cell_index ()), db::Trans (db::Vector (100, -100))));
+  c0.insert (db::CellInstArray (db::CellInst (c1.cell_index ()), db::Trans (db::Vector (2000, 0))));
+
+  std::vector<unsigned int> layers;
+  layers.push_back (l0);
+  layers.push_back (l1);
+
+  db::RecursiveShapeIterator iter (g, c0, layers);
+  std::string ref = collect_with_copy (iter, g, true);
+
+  db::ShapeBatch batch;
+  std::string res;
+  size_t nbatches = 0;
+
+  while (batch.fetch (iter, 2) > 0) {
+    ++nbatches;
+    EXPECT_EQ (batch.trans ().size (), batch.size ());
+    EXPECT_EQ (batch.layers ().size (), batch.size ());
+    EXPECT_EQ (batch.cell_indexes ().size (), batch.size ());
+    for (size_t i = 0; i < batch.size (); ++i) {
+      if (! res.empty ()) {
+        res += "/";
+      }
+      db::Box box;
+      batch.shapes () [i].box (box);
+      res += std::string ("[") + g.cell_name (batch.cell_indexes () [i]) + "]";
+      res += (batch.trans () [i] * box).to_string ();
+      res += "*" + tl::to_string (batch.layers () [i]);
+    }
+  }
+
+  EXPECT_EQ (res, ref);
+  EXPECT_EQ (nbatches, size_t (3));
+  EXPECT_EQ (iter.at_end (), true);
+  EXPECT_EQ (batch.empty (), true);
+}
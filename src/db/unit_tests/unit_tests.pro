@@ -66,6 +66,7 @@ SOURCES = \
     dbEdgePairRelationsTests.cc \
     dbEdgePairTests.cc \
     dbEdgeTests.cc \
+    dbContentHashTests.cc \
     dbClipTests.cc \
     dbCellMappingTests.cc \
     dbCellHullGeneratorTests.cc \
@@ -76,7 +77,8 @@ SOURCES = \
     dbBoxTests.cc \
     dbArrayTests.cc \
     dbDeepTextsTests.cc \
-    dbNetShapeTests.cc
+    dbNetShapeTests.cc \
+    dbCoordinateArraysTests.cc
 
 INCLUDEPATH += $$TL_INC $$DB_INC $$GSI_INC
 DEPENDPATH += $$TL_INC $$DB_INC $$GSI_INC
@@ -4,6 +4,57 @@ require 'pathname'
 
 module DRC
 
+  # A readers/writer lock for the data objects shared by parallel branches:
+  # multiple branches may read an object at the same time, while modifying
+  # it requires exclusive access. A thread holding the lock may lock it
+  # again in any mode.
+  
+  class DRCDataLock
+  
+    def initialize
+      @mutex = Mutex::new
+      @released = ConditionVariable::new
+      @readers = Hash::new(0)
+      @writer = nil
+      @writes = 0
+    end
+    
+    def synchronize(exclusive)
+    
+      t = Thread.current
+      
+      @mutex.synchronize do
+        if exclusive
+          while (@writer && @writer != t) || @readers.keys.any? { |r| r != t }
+            @released.wait(@mutex)
+          end
+          @writer = t
+          @writes += 1
+        else
+          while @writer && @writer != t
+            @released.wait(@mutex)
+          end
+          @readers[t] += 1
+        end
+      end
+      
+      begin
+        yield
+      ensure
+        @mutex.synchronize do
+          if exclusive
+            (@writes -= 1) == 0 && @writer = nil
+          else
+            (@readers[t] -= 1) == 0 && @readers.delete(t)
+          end
+          @released.broadcast
+        end
+      end
+      
+    end
+    
+  end
+
   # The DRC engine
   
   # %DRC%
@@ -51,6 +102,11 @@ module DRC
 
       @verbose = false
 
+      @profile = false
+      @profile_lines = 25
+      @profile_file = nil
+      @profile_data = []
+
     end
     
     def joined
@@ -351,6 +407,53 @@ module DRC
       @verbose = f
     end
     
+    # %DRC%
+    # @name profile
+    # @brief Enables profiling of the operations
+    # @synopsis profile
+    # @synopsis profile(lines)
+    # With profiling enabled, the engine records wall and CPU time, the change 
+    # of memory usage, the input and output shape counts and the flat or deep mode
+    # for every operation executed. At the end of the script, a summary table is 
+    # printed to the log listing the operations which took the most time.
+    # Operations executed multiple times from the same line (e.g. inside a loop)
+    # are summarized into one entry. "lines" specifies the number of entries
+    # printed (default is 25). A value of 0 suppresses the summary table.
+    #
+    # To write the full profile into a file, use \profile_report.
+    #
+    # This method has been introduced in version 0.27.
+    
+    def profile(lines = 25)
+      @profile = true
+      @profile_lines = lines.to_i
+    end
+    
+    # %DRC%
+    # @name profile_report
+    # @brief Enables profiling and writes the profile to a file
+    # @synopsis profile_report(filename)
+    # This method enables profiling like \profile, but in addition writes 
+    # one record per operation executed into the given file at the end of the script.
+    # If the file name has a ".csv" extension, the file is written in CSV format.
+    # Otherwise JSON format is used. The records contain the operation,
+    # the source line, the wall and CPU times in seconds, the memory usage 
+    # change in bytes, the input and output shape counts (if applicable) and 
+    # the mode ("flat" or "deep").
+    #
+    # Unless \profile is used, no summary table is printed.
+    #
+    # This method has been introduced in version 0.27.
+    
+    def profile_report(filename)
+      filename.is_a?(String) || raise("Argument must be a string in profile_report")
+      if !@profile
+        @profile = true
+        @profile_lines = 0
+      end
+      @profile_file = filename
+    end
+    
     # %DRC%
     # @name info 
     # @brief Outputs as message to the logger window
@@ -563,11 +666,68 @@ module DRC
     # If using threads, tiles are distributed on multiple CPU cores for
     # parallelization. Still, all tiles must be processed before the 
     # operation proceeds with the next statement.
+    #
+    # The number of threads also specifies the number of branches executed
+    # concurrently inside a \parallel block.
     
     def threads(n)
       @tt = n.to_i
     end
     
+    # %DRC%
+    # @name parallel
+    # @brief Executes independent rules concurrently
+    # @synopsis parallel { block }
+    # Inside the block, independent rules are declared with \branch. When the
+    # block has been read, the branches are executed on the number of threads
+    # specified with \threads. "parallel" returns when all branches have finished.
+    #
+    # @code
+    # threads(4)
+    # m1 = input(1, 0)
+    # m2 = input(2, 0)
+    # parallel do
+    #   branch { m1.width(0.2.um).output("M1 width < 0.2um") }
+    #   branch { m2.width(0.2.um).output("M2 width < 0.2um") }
+    #   branch { m1.separation(m2, 0.1.um).output("M1/M2 separation < 0.1um") }
+    # end
+    # @/code
+    #
+    # Branches must not depend on each other's results. The heavy operations (booleans,
+    # sizing, interactions and the DRC checks) then run concurrently. Branches may read 
+    # the same layers at the same time. Operations modifying a layer (such as \Layer#merge
+    # or \Layer#size) wait until the other branches have finished using it.
+    # Inputs should be declared before the "parallel" block. Output (see \Layer#output)
+    # is deferred until all branches have finished and happens in the order
+    # of the branches, so the results are the same as without "parallel".
+    #
+    # Branches are executed sequentially in deep mode and if only one thread is specified.
+    
+    def parallel(&block)
+      (@branches || @data_locks) && raise("'parallel' cannot be nested")
+      @branches = []
+      begin
+        yield
+        branches = @branches
+      ensure
+        @branches = nil
+      end
+      _run_branches(branches)
+    end
+    
+    # %DRC%
+    # @name branch
+    # @brief Declares a rule for concurrent execution
+    # @synopsis branch { block }
+    # This function can only be used inside a \parallel block. The block given
+    # to "branch" is executed concurrently with those of the other branches.
+    # See \parallel for details.
+    
+    def branch(&block)
+      @branches || raise("'branch' can only be used inside a 'parallel' block")
+      @branches.push(block)
+    end
+    
     # %DRC%
     # @name make_layer
     # @brief Creates an empty polygon layer based on the hierarchical scheme selected
@@ -1411,25 +1571,59 @@ CODE
       end
     end
     
-    def run_timed(desc, obj)
+    def run_timed(desc, obj, *args)
 
       info(desc)
 
-      # enable progress
-      if obj.is_a?(RBA::Region) || obj.is_a?(RBA::Edges) || obj.is_a?(RBA::EdgePairs)
+      # enable progress (not for parallel branches which may share the object)
+      progress = !@data_locks && (obj.is_a?(RBA::Region) || obj.is_a?(RBA::Edges) || obj.is_a?(RBA::EdgePairs))
+      if progress
         obj.enable_progress(desc)
       end
       
+      # count the inputs before the timer is started, so counting does not add to the profile
+      input = nil
+      if @profile
+        _synchronize_data(obj, *args) do
+          ([ obj ] + args).each do |o|
+            c = _profile_count(o)
+            c && input = (input || 0) + c
+          end
+        end
+      end
+
       t = RBA::Timer::new
       t.start
       GC.start # force a garbage collection before the operation to free unused memory
-      res = yield
+      mem = @profile && RBA::Timer::memory_size
+      res = _synchronize_data(obj, *args) do
+        yield
+      end
       t.stop
 
       info("Elapsed: #{'%.3f'%(t.sys+t.user)}s")
 
+      if @profile
+        op = desc
+        line = nil
+        if desc =~ /^"(.*)" in: (.*)$/
+          op = $1
+          line = $2
+        end
+        @profile_data << {
+          :op => op,
+          :line => line,
+          :wall => t.wall,
+          :cpu => t.sys + t.user,
+          :mem => RBA::Timer::memory_size - mem,
+          :input => input,
+          :output => _profile_count(res),
+          :mode => (obj.respond_to?(:is_deep?) ? obj.is_deep? : @deep) ? "deep" : "flat"
+        }
+      end
+
       # disable progress
-      if obj.is_a?(RBA::Region) || obj.is_a?(RBA::Edges) || obj.is_a?(RBA::EdgePairs)
+      if progress
         obj.disable_progress
       end
           
@@ -1437,8 +1631,166 @@ CODE
 
     end
     
+    def _profile_count(obj)
+      if obj.is_a?(RBA::Region) || obj.is_a?(RBA::Edges) || obj.is_a?(RBA::EdgePairs) || obj.is_a?(RBA::Texts)
+        obj.size
+      else
+        nil
+      end
+    end
+
+    def _profile_summary
+
+      # summarize by operation and source line
+      entries = {}
+      @profile_data.each do |d|
+        e = (entries[[ d[:op], d[:line] ]] ||= d.merge(:count => 0, :wall => 0.0, :cpu => 0.0, :mem => 0, :input => nil, :output => nil))
+        e[:count] += 1
+        [ :wall, :cpu, :mem ].each { |k| e[k] += d[k] }
+        [ :input, :output ].each { |k| d[k] && e[k] = (e[k] || 0) + d[k] }
+      end
+
+      entries = entries.values.sort { |a,b| b[:wall] <=> a[:wall] }
+      if entries.size > @profile_lines
+        entries = entries[0, @profile_lines]
+      end
+
+      log("Profile (#{entries.size} of #{@profile_data.size} operations, by wall time):")
+      log("%10s %10s %10s %12s %12s %5s %6s  %s" % [ "wall [s]", "cpu [s]", "mem [M]", "input", "output", "mode", "count", "operation" ])
+      entries.each do |e|
+        log("%10.3f %10.3f %10.2f %12s %12s %5s %6d  %s" % [ e[:wall], e[:cpu], e[:mem] / (1024.0 * 1024.0), e[:input] || "-", e[:output] || "-", e[:mode], e[:count], e[:line] ? "\"#{e[:op]}\" in: #{e[:line]}" : e[:op] ])
+      end
+
+    end
+
+    def _profile_write(filename)
+
+      keys = [ :op, :line, :wall, :cpu, :mem, :input, :output, :mode ]
+
+      File.open(filename, "w") do |file|
+
+        if filename =~ /\.csv$/i
+
+          file.puts(keys.collect(&:to_s).join(","))
+          @profile_data.each do |d|
+            file.puts(keys.collect { |k| v = d[k]; v.is_a?(String) ? "\"" + v.gsub("\"", "\"\"") + "\"" : v.to_s }.join(","))
+          end
+
+        else
+
+          file.puts("[")
+          @profile_data.each_with_index do |d,i|
+            items = keys.collect do |k| 
+              v = d[k]
+              if v.is_a?(String)
+                v = "\"" + v.gsub(/[\\"]/) { |c| "\\" + c }.gsub(/[\x00-\x1f]/) { |c| "\\u%04x" % c.ord } + "\""
+              elsif v.nil?
+                v = "null"
+              end
+              "\"#{k}\": #{v}"
+            end
+            file.puts("  { " + items.join(", ") + " }" + (i + 1 < @profile_data.size ? "," : ""))
+          end
+          file.puts("]")
+
+        end
+
+      end
+
+    end
+
+    def _run_branches(branches)
+
+      nthreads = [ @tt || 1, branches.size ].min
+      if @deep || nthreads <= 1
+        branches.each { |b| b.call }
+        return
+      end
+      
+      # sort the layouts before they are read by multiple threads
+      @layout_sources.each do |n,l|
+        l.layout.update
+      end
+      
+      outputs = branches.collect { [] }
+      errors = []
+      queue = Queue::new
+      branches.size.times { |i| queue.push(i) }
+      
+      @data_locks = {}
+      @data_locks_lock = Mutex::new
+      
+      begin
+      
+        workers = nthreads.times.collect do
+          Thread::new do
+            while (i = (queue.pop(true) rescue nil))
+              Thread.current[:drc_outputs] = outputs[i]
+              begin
+                branches[i].call
+              rescue => ex
+                @data_locks_lock.synchronize { errors.push([ i, ex ]) }
+              end
+            end
+          end
+        end
+        workers.each { |w| w.join }
+        
+      ensure
+        @data_locks = nil
+        @data_locks_lock = nil
+      end
+      
+      # emulate sequential execution: deliver the output up to the first failing branch
+      error = errors.min_by { |e| e[0] }
+      outputs.each_with_index do |o,i|
+        error && i >= error[0] && raise(error[1])
+        o.each { |data, args| _output(data, *args) }
+      end
+
+    end
+    
+    # Locks the given data objects for reading while running the block, so 
+    # concurrent branches do not modify them
+    def _synchronize_data(*objs, &block)
+      if !@data_locks
+        return yield
+      end
+      _synchronize_locks(_data_locks(objs), false, &block)
+    end
+    
+    # Locks the given data object for writing while running the block, 
+    # so concurrent branches do not use it
+    # NOTE: objects modified in place are locked before and separately from
+    # the inputs of the operation. This is safe as long as the in-place 
+    # operations do not take other layers as arguments.
+    def _modify_data(obj, &block)
+      if !@data_locks
+        return yield
+      end
+      _synchronize_locks(_data_locks([ obj ]), true, &block)
+    end
+    
+    def _data_locks(objs)
+      @data_locks_lock.synchronize do
+        objs.flatten.select do |o| 
+          o.is_a?(RBA::Region) || o.is_a?(RBA::Edges) || o.is_a?(RBA::EdgePairs) || o.is_a?(RBA::Texts)
+        end.collect { |o| o.object_id }.uniq.sort.collect do |id|
+          @data_locks[id] ||= DRCDataLock::new
+        end
+      end
+    end
+    
+    def _synchronize_locks(locks, exclusive, &block)
+      if locks.empty?
+        yield
+      else
+        locks[0].synchronize(exclusive) { _synchronize_locks(locks[1..-1], exclusive, &block) }
+      end
+    end
+    
     def _cmd(obj, method, *args)
-      run_timed("\"#{method}\" in: #{src_line}", obj) do
+      run_timed("\"#{method}\" in: #{src_line}", obj, *args) do
         obj.send(method, *args)
       end
     end
@@ -1468,7 +1820,7 @@ CODE
         end
         av = args.size.times.collect { |i| "a#{i}" }.join(", ")
         tp.queue("_output(res, self.#{method}(#{av}))")
-        run_timed("\"#{method}\" in: #{src_line}", obj) do
+        run_timed("\"#{method}\" in: #{src_line}", obj, *args) do
           tp.execute("Tiled \"#{method}\" in: #{src_line}")
         end
         
@@ -1479,14 +1831,14 @@ CODE
         end
 
         res = nil
-        run_timed("\"#{method}\" in: #{src_line}", obj) do
+        run_timed("\"#{method}\" in: #{src_line}", obj, *args) do
           res = obj.send(method, *args)
         end
 
       end
       
       # enable progress
-      if obj.is_a?(RBA::Region)
+      if obj.is_a?(RBA::Region) && !@data_locks
         obj.disable_progress
       end
       
@@ -1529,7 +1881,7 @@ CODE
       end
       
       # enable progress
-      if obj.is_a?(RBA::Region)
+      if obj.is_a?(RBA::Region) && !@data_locks
         obj.disable_progress
       end
       
@@ -1538,13 +1890,13 @@ CODE
     end
     
     def _rcmd(obj, method, *args)
-      run_timed("\"#{method}\" in: #{src_line}", obj) do
+      run_timed("\"#{method}\" in: #{src_line}", obj, *args) do
         RBA::Region::new(obj.send(method, *args))
       end
     end
     
     def _vcmd(obj, method, *args)
-      run_timed("\"#{method}\" in: #{src_line}", obj) do
+      run_timed("\"#{method}\" in: #{src_line}", obj, *args) do
         obj.send(method, *args)
       end
     end
@@ -1657,6 +2009,16 @@ CODE
 
         end
 
+        # print and write the profile if requested
+        if final && @profile
+          @profile_lines > 0 && _profile_summary
+          if @profile_file
+            profile_file = _make_path(@profile_file)
+            info("Writing profile: #{profile_file} ..")
+            _profile_write(profile_file)
+          end
+        end
+
         # give derived classes a change to perform their actions
         _before_cleanup
       
@@ -1872,6 +2234,13 @@ CODE
     
     def _output(data, *args)
 
+      # inside "parallel", the output is deferred
+      deferred = Thread.current[:drc_outputs]
+      if deferred
+        deferred.push([ data, args ])
+        return
+      end
+
       if @output_rdb
         
         if args.size < 1
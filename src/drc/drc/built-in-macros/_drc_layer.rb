@@ -44,21 +44,23 @@ module DRC
     
     def insert(*args)
       requires_edges_or_region("insert")
-      args.each do |a|
-        if a.is_a?(RBA::DBox) 
-          @data.insert(RBA::Box::from_dbox(a * (1.0 / @engine.dbu)))
-        elsif a.is_a?(RBA::DPolygon) 
-          @data.insert(RBA::Polygon::from_dpoly(a * (1.0 / @engine.dbu)))
-        elsif a.is_a?(RBA::DSimplePolygon) 
-          @data.insert(RBA::SimplePolygon::from_dpoly(a * (1.0 / @engine.dbu)))
-        elsif a.is_a?(RBA::DPath) 
-          @data.insert(RBA::Path::from_dpath(a * (1.0 / @engine.dbu)))
-        elsif a.is_a?(RBA::DEdge) 
-          @data.insert(RBA::Edge::from_dedge(a * (1.0 / @engine.dbu)))
-        elsif a.is_a?(Array)
-          insert(*a)
-        else
-          raise("Invalid argument type #{a.class.to_s} for 'insert' method")
+      @engine._modify_data(@data) do
+        args.each do |a|
+          if a.is_a?(RBA::DBox) 
+            @data.insert(RBA::Box::from_dbox(a * (1.0 / @engine.dbu)))
+          elsif a.is_a?(RBA::DPolygon) 
+            @data.insert(RBA::Polygon::from_dpoly(a * (1.0 / @engine.dbu)))
+          elsif a.is_a?(RBA::DSimplePolygon) 
+            @data.insert(RBA::SimplePolygon::from_dpoly(a * (1.0 / @engine.dbu)))
+          elsif a.is_a?(RBA::DPath) 
+            @data.insert(RBA::Path::from_dpath(a * (1.0 / @engine.dbu)))
+          elsif a.is_a?(RBA::DEdge) 
+            @data.insert(RBA::Edge::from_dedge(a * (1.0 / @engine.dbu)))
+          elsif a.is_a?(Array)
+            insert(*a)
+          else
+            raise("Invalid argument type #{a.class.to_s} for 'insert' method")
+          end
         end
       end
       self
@@ -128,7 +130,7 @@ module DRC
     
     def clean
       requires_edges_or_region("clean")
-      @data.merged_semantics = true
+      @engine._modify_data(@data) { @data.merged_semantics = true }
       self
     end
     
@@ -159,7 +161,7 @@ module DRC
     
     def raw
       requires_edges_or_region("raw")
-      @data.merged_semantics = false
+      @engine._modify_data(@data) { @data.merged_semantics = false }
       self
     end
     
@@ -197,7 +199,7 @@ module DRC
     # on input layers.
 
     def size
-      @data.size
+      @engine._synchronize_data(@data) { @data.size }
     end
     
     # %DRC%
@@ -1156,7 +1158,7 @@ CODE
           @data = @engine._tcmd(@data, 0, @data.class, :snapped, gx, gy)
           self
         elsif :#{f} == :snap
-          @engine._tcmd(@data, 0, @data.class, :#{f}, gx, gy)
+          @engine._modify_data(@data) { @engine._tcmd(@data, 0, @data.class, :#{f}, gx, gy) }
           self
         else
           DRCLayer::new(@engine, @engine._tcmd(@data, 0, @data.class, :#{f}, gx, gy))
@@ -2206,7 +2208,7 @@ CODE
     # micrometer units. 
     
     def bbox
-      RBA::DBox::from_ibox(@data.bbox) * @engine.dbu.to_f
+      RBA::DBox::from_ibox(@engine._synchronize_data(@data) { @data.bbox }) * @engine.dbu.to_f
     end
     
     # %DRC%
@@ -2323,7 +2325,7 @@ CODE
     # to a flat collection of texts, polygons, edges or edge pairs.
     
     def flatten
-      DRC::DRCLayer::new(@engine, @engine._cmd(@data, :flatten))
+      DRC::DRCLayer::new(@engine, @engine._modify_data(@data) { @engine._cmd(@data, :flatten) })
     end
     
     # %DRC%
@@ -2339,7 +2341,7 @@ CODE
     
     def is_merged?
       requires_edges_or_region("is_merged?")
-      @data.is_merged?
+      @engine._synchronize_data(@data) { @data.is_merged? }
     end
     
     # %DRC%
@@ -2348,7 +2350,7 @@ CODE
     # @synopsis layer.is_empty?
     
     def is_empty?
-      @data.is_empty?
+      @engine._synchronize_data(@data) { @data.is_empty? }
     end
     
     # %DRC%
@@ -2893,7 +2895,7 @@ CODE
           @data = @engine._tcmd(@data, dist, RBA::Region, :sized, *aa)
           self
         elsif :#{f} == :size 
-          @engine._tcmd(@data, dist, RBA::Region, :#{f}, *aa)
+          @engine._modify_data(@data) { @engine._tcmd(@data, dist, RBA::Region, :#{f}, *aa) }
           self
         else 
           DRCLayer::new(@engine, @engine._tcmd(@data, dist, RBA::Region, :#{f}, *aa))
@@ -3017,7 +3019,7 @@ CODE
       eval <<"CODE"
       def #{f}(*args)
         aa = args.collect { |a| @engine._prep_value(a) }
-        @engine._cmd(@data, :#{f}, *aa)
+        @engine._modify_data(@data) { @engine._cmd(@data, :#{f}, *aa) }
         self
       end
 CODE
@@ -3073,7 +3075,7 @@ CODE
         # in tiled mode, no modifying versions are available
         @data = @engine._tcmd(@data, 0, @data.class, :merged, *aa)
       else
-        @engine._tcmd(@data, 0, @data.class, :merge, *aa)
+        @engine._modify_data(@data) { @engine._tcmd(@data, 0, @data.class, :merge, *aa) }
       end
       self
     end
@@ -27,6 +27,7 @@
 #include "dbNetlistSpiceReader.h"
 #include "lymMacro.h"
 #include "tlFileUtils.h"
+#include "tlStream.h"
 
 TEST(1)
 {
@@ -755,3 +756,126 @@ TEST(16_issue570)
 
   db::compare_layouts (_this, layout, au, db::NoNormalization);
 }
+
+TEST(17_parallel)
+{
+  std::string rs = tl::testsrc ();
+  rs += "/testdata/drc/drcSimpleTests_17.drc";
+
+  std::string input = tl::testsrc ();
+  input += "/testdata/drc/drctest.gds";
+
+  std::string au = tl::testsrc ();
+  au += "/testdata/drc/drcSimpleTests_au2.gds";
+
+  std::string output = this->tmp_file ("tmp.gds");
+
+  {
+    //  Set some variables
+    lym::Macro config;
+    config.set_text (tl::sprintf (
+        "$drc_test_source = '%s'\n"
+        "$drc_test_target = '%s'\n"
+      , input, output)
+    );
+    config.set_interpreter (lym::Macro::Ruby);
+    EXPECT_EQ (config.run (), 0);
+  }
+
+  lym::Macro drc;
+  drc.load_from (rs);
+  EXPECT_EQ (drc.run (), 0);
+
+  db::Layout layout;
+
+  {
+    tl::InputStream stream (output);
+    db::Reader reader (stream);
+    reader.read (layout);
+  }
+
+  db::compare_layouts (_this, layout, au, db::NoNormalization);
+}
+
+TEST(18_profile)
+{
+  std::string rs = tl::testsrc ();
+  rs += "/testdata/drc/drcSimpleTests_18.drc";
+
+  std::string input = tl::testsrc ();
+  input += "/testdata/drc/drctest.gds";
+
+  std::string output = this->tmp_file ("tmp.gds");
+  std::string profile = this->tmp_file ("tmp.csv");
+
+  {
+    //  Set some variables
+    lym::Macro config;
+    config.set_text (tl::sprintf (
+        "$drc_test_source = '%s'\n"
+        "$drc_test_target = '%s'\n"
+        "$drc_test_profile = '%s'\n"
+      , input, output, profile)
+    );
+    config.set_interpreter (lym::Macro::Ruby);
+    EXPECT_EQ (config.run (), 0);
+  }
+
+  lym::Macro drc;
+  drc.load_from (rs);
+  EXPECT_EQ (drc.run (), 0);
+
+  //  verify the profile without the times and memory figures (columns 2 to 4)
+
+  std::string text;
+
+  {
+    tl::InputStream stream (profile);
+    tl::TextInputStream ts (stream);
+    while (! ts.at_end ()) {
+      std::vector<std::string> cols = tl::split (ts.get_line (), ",");
+      if (cols.size () == 8) {
+        cols.erase (cols.begin () + 2, cols.begin () + 5);
+      }
+      text += tl::join (cols, ",") + "\n";
+    }
+  }
+
+  EXPECT_EQ (text,
+    "op,line,input,output,mode\n"
+    "\"_input\",\"drcSimpleTests_18.drc:7\",,2,\"flat\"\n"
+    "\"_input\",\"drcSimpleTests_18.drc:8\",,15,\"flat\"\n"
+    "\"&\",\"drcSimpleTests_18.drc:10\",17,1,\"flat\"\n"
+    "\"_output\",\"drcSimpleTests_18.drc:10\",1,,\"flat\"\n"
+    "\"sized\",\"drcSimpleTests_18.drc:11\",2,2,\"flat\"\n"
+    "\"_output\",\"drcSimpleTests_18.drc:11\",2,,\"flat\"\n"
+  );
+}
+
+TEST(19_parallel_shared_input)
+{
+  std::string rs = tl::testsrc ();
+  rs += "/testdata/drc/drcSimpleTests_19.drc";
+
+  std::string input = tl::testsrc ();
+  input += "/testdata/drc/drctest.gds";
+
+  std::string output = this->tmp_file ("tmp.gds");
+
+  {
+    //  Set some variables
+    lym::Macro config;
+    config.set_text (tl::sprintf (
+        "$drc_test_source = '%s'\n"
+        "$drc_test_target = '%s'\n"
+      , input, output)
+    );
+    config.set_interpreter (lym::Macro::Ruby);
+    EXPECT_EQ (config.run (), 0);
+  }
+
+  //  NOTE: the script itself verifies the results and whether the branches overlapped
+  lym::Macro drc;
+  drc.load_from (rs);
+  EXPECT_EQ (drc.run (), 0);
+}
@@ -28,6 +28,9 @@
 #include "tlExpression.h"
 #include "tlGlobPattern.h"
 #include "tlRecipe.h"
+#include "tlPixelBuffer.h"
+
+#include <cstring>
 
 // ----------------------------------------------------------------
 //  Logger binding
@@ -163,6 +166,13 @@ Class<tl::Timer> decl_Timer ("tl", "Timer",
     "@brief Returns the elapsed real time from start to stop in seconds\n"
     "This method has been introduced in version 0.26."
   ) +
+  gsi::method ("memory_size", &tl::Timer::memory_size,
+    "@brief Returns the current memory usage of the process in bytes\n"
+    "This is the virtual memory size of the process. On platforms where this figure "
+    "is not available, this method returns 0.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
+  ) +
   gsi::method_ext ("to_s", &timer_to_s,
     "@brief Produces a string with the currently elapsed times\n"
   ) +
@@ -622,6 +632,235 @@ Class<tl::GlobPattern> decl_GlobPattern ("tl", "GlobPattern",
   "This class has been introduced in version 0.26."
 );
 
+static tl::PixelBuffer *new_pixel_buffer (unsigned int width, unsigned int height)
+{
+  return new tl::PixelBuffer (width, height);
+}
+
+static bool host_is_little_endian ()
+{
+  const tl::color_t probe = 1;
+  return *((const unsigned char *) &probe) == 1;
+}
+
+//  Byte orders: ARGB32 is little endian 0xAARRGGBB (B G R A), RGBA is R G B A
+
+static inline tl::color_t pixel_from_bytes (const unsigned char *d, bool rgba)
+{
+  if (rgba) {
+    return (tl::color_t (d [3]) << 24) | (tl::color_t (d [0]) << 16) | (tl::color_t (d [1]) << 8) | tl::color_t (d [2]);
+  } else {
+    return (tl::color_t (d [3]) << 24) | (tl::color_t (d [2]) << 16) | (tl::color_t (d [1]) << 8) | tl::color_t (d [0]);
+  }
+}
+
+static inline void pixel_to_bytes (tl::color_t c, unsigned char *d, bool rgba)
+{
+  d [0] = (unsigned char) (rgba ? (c >> 16) : c);
+  d [1] = (unsigned char) (c >> 8);
+  d [2] = (unsigned char) (rgba ? c : (c >> 16));
+  d [3] = (unsigned char) (c >> 24);
+}
+
+static void set_data_with_order (tl::PixelBuffer *pb, const std::vector<char> &data, bool rgba)
+{
+  size_t w = pb->width ();
+  size_t n = w * size_t (pb->height ());
+  if (data.size () != n * 4) {
+    throw tl::Exception (tl::to_string (tr ("Pixel data size (%d bytes) does not match the buffer size (%dx%d pixels, 4 bytes each)")), int (data.size ()), pb->width (), pb->height ());
+  }
+  if (n == 0) {
+    return;
+  }
+
+  bool direct = (! rgba && host_is_little_endian ());
+
+  const unsigned char *d = (const unsigned char *) &data.front ();
+  for (unsigned int y = 0; y < pb->height (); ++y, d += w * 4) {
+    tl::color_t *p = pb->scan_line (y);
+    if (direct) {
+      memcpy (p, d, w * 4);
+    } else {
+      const unsigned char *dd = d;
+      for (size_t x = 0; x < w; ++x, dd += 4) {
+        *p++ = pixel_from_bytes (dd, rgba);
+      }
+    }
+  }
+}
+
+static std::vector<char> get_data_with_order (const tl::PixelBuffer *pb, bool rgba)
+{
+  size_t w = pb->width ();
+
+  std::vector<char> data;
+  data.reserve (w * size_t (pb->height ()) * 4);
+
+  bool direct = (! rgba && host_is_little_endian ());
+
+  std::vector<char> row;
+  if (! direct) {
+    row.resize (w * 4);
+  }
+
+  for (unsigned int y = 0; y < pb->height () && w > 0; ++y) {
+    const tl::color_t *p = pb->scan_line (y);
+    if (direct) {
+      data.insert (data.end (), (const char *) p, (const char *) (p + w));
+    } else {
+      unsigned char *d = (unsigned char *) &row.front ();
+      for (size_t x = 0; x < w; ++x, d += 4) {
+        pixel_to_bytes (*p++, d, rgba);
+      }
+      data.insert (data.end (), row.begin (), row.end ());
+    }
+  }
+
+  return data;
+}
+
+static void set_data (tl::PixelBuffer *pb, const std::vector<char> &data)
+{
+  set_data_with_order (pb, data, false);
+}
+
+static std::vector<char> get_data (const tl::PixelBuffer *pb)
+{
+  return get_data_with_order (pb, false);
+}
+
+static void set_rgba_data (tl::PixelBuffer *pb, const std::vector<char> &data)
+{
+  set_data_with_order (pb, data, true);
+}
+
+static std::vector<char> get_rgba_data (const tl::PixelBuffer *pb)
+{
+  return get_data_with_order (pb, true);
+}
+
+static tl::PixelBuffer *new_pixel_buffer_from_data (unsigned int width, unsigned int height, const std::vector<char> &data, bool rgba)
+{
+  std::auto_ptr<tl::PixelBuffer> pb (new tl::PixelBuffer (width, height));
+  set_data_with_order (pb.get (), data, rgba);
+  return pb.release ();
+}
+
+static void check_pixel_coords (const tl::PixelBuffer *pb, unsigned int x, unsigned int y)
+{
+  if (x >= pb->width () || y >= pb->height ()) {
+    throw tl::Exception (tl::to_string (tr ("Pixel coordinates (%d,%d) outside of the buffer (%dx%d)")), x, y, pb->width (), pb->height ());
+  }
+}
+
+static tl::color_t get_pixel (const tl::PixelBuffer *pb, unsigned int x, unsigned int y)
+{
+  check_pixel_coords (pb, x, y);
+  return pb->pixel (x, y);
+}
+
+static void set_pixel (tl::PixelBuffer *pb, unsigned int x, unsigned int y, tl::color_t c)
+{
+  check_pixel_coords (pb, x, y);
+  pb->set_pixel (x, y, c);
+}
+
+Class<tl::PixelBuffer> decl_PixelBuffer ("tl", "PixelBuffer",
+  gsi::constructor ("new", &new_pixel_buffer, gsi::arg ("width"), gsi::arg ("height"),
+    "@brief Creates a pixel buffer object\n"
+    "\n"
+    "@param width The width in pixels\n"
+    "@param height The height in pixels\n"
+    "\n"
+    "The pixels are not initialized. Use \\fill to initialize them."
+  ) +
+  gsi::constructor ("new", &new_pixel_buffer_from_data, gsi::arg ("width"), gsi::arg ("height"), gsi::arg ("data"), gsi::arg ("rgba", false),
+    "@brief Creates a pixel buffer object from raw pixel data\n"
+    "\n"
+    "@param width The width in pixels\n"
+    "@param height The height in pixels\n"
+    "@param data The pixel data (see \\data for the format)\n"
+    "@param rgba If true, the data is given in RGBA byte order (see \\rgba_data)\n"
+    "\n"
+    "In Python, 'data' can be any object providing a contiguous buffer, e.g. 'bytes', 'bytearray' or "
+    "a numpy array. For example, a numpy array of shape (height, width, 4) and type 'uint8' holding "
+    "RGBA images can be passed with 'rgba=True'.\n"
+    "\n"
+    "This method has been added in version 0.27."
+  ) +
+  gsi::method ("==", &tl::PixelBuffer::operator==, gsi::arg ("other"),
+    "@brief Returns a value indicating whether self is identical to the other image\n"
+  ) +
+  gsi::method ("!=", &tl::PixelBuffer::operator!=, gsi::arg ("other"),
+    "@brief Returns a value indicating whether self is not identical to the other image\n"
+  ) +
+  gsi::method ("transparent=", &tl::PixelBuffer::set_transparent, gsi::arg ("t"),
+    "@brief Sets a flag indicating whether the pixel buffer supports an alpha channel\n"
+  ) +
+  gsi::method ("transparent", &tl::PixelBuffer::transparent,
+    "@brief Gets a flag indicating whether the pixel buffer supports an alpha channel\n"
+  ) +
+  gsi::method ("fill", &tl::PixelBuffer::fill, gsi::arg ("color"),
+    "@brief Fills the pixel buffer with the given pixel value\n"
+  ) +
+  gsi::method ("swap", &tl::PixelBuffer::swap, gsi::arg ("other"),
+    "@brief Swaps data with another PixelBuffer object\n"
+  ) +
+  gsi::method ("width", &tl::PixelBuffer::width,
+    "@brief Gets the width of the pixel buffer in pixels\n"
+  ) +
+  gsi::method ("height", &tl::PixelBuffer::height,
+    "@brief Gets the height of the pixel buffer in pixels\n"
+  ) +
+  gsi::method_ext ("set_pixel", &set_pixel, gsi::arg ("x"), gsi::arg ("y"), gsi::arg ("c"),
+    "@brief Sets the value of the pixel at position x, y\n"
+  ) +
+  gsi::method_ext ("pixel", &get_pixel, gsi::arg ("x"), gsi::arg ("y"),
+    "@brief Gets the value of the pixel at position x, y\n"
+  ) +
+  gsi::method_ext ("data", &get_data,
+    "@brief Gets the pixel data as a byte string\n"
+    "The data is delivered row by row, starting with the top row. Each pixel is a 32 bit ARGB "
+    "value in little endian byte order (blue, green, red, alpha). The byte string hence has "
+    "a size of width * height * 4 bytes. In Python, the data is a 'bytes' object which can be "
+    "converted into an array with 'numpy.frombuffer(data, dtype='<u4').reshape(height, width)'.\n"
+    "\n"
+    "This method has been added in version 0.27."
+  ) +
+  gsi::method_ext ("data=", &set_data, gsi::arg ("data"),
+    "@brief Sets the pixel data from a byte string\n"
+    "The format of the data is the same as delivered by \\data. The size of the byte string "
+    "must match the size of the buffer (width * height * 4 bytes). In Python, any object providing "
+    "a contiguous buffer (e.g. a numpy array) is accepted as well.\n"
+    "\n"
+    "This method has been added in version 0.27."
+  ) +
+  gsi::method_ext ("rgba_data", &get_rgba_data,
+    "@brief Gets the pixel data as a byte string in RGBA byte order\n"
+    "This method is similar to \\data, but delivers the bytes of each pixel in the order red, green, blue, alpha. "
+    "This is the order used by most image processing libraries. "
+    "In Python, the data can be converted into an image array with "
+    "'numpy.frombuffer(data, dtype='uint8').reshape(height, width, 4)'.\n"
+    "\n"
+    "This method has been added in version 0.27."
+  ) +
+  gsi::method_ext ("rgba_data=", &set_rgba_data, gsi::arg ("data"),
+    "@brief Sets the pixel data from a byte string in RGBA byte order\n"
+    "The format of the data is the same as delivered by \\rgba_data. The size of the data "
+    "must match the size of the buffer (width * height * 4 bytes). In Python, any object providing "
+    "a contiguous buffer (e.g. a numpy array) is accepted as well.\n"
+    "\n"
+    "This method has been added in version 0.27."
+  ),
+  "@brief A simple pixel buffer object\n"
+  "This class is a Qt-independent container for 32 bit ARGB pixel values (0xAARRGGBB). "
+  "Row 0 is the top row. It is used as the target of \\LayoutView#get_pixels_with_options "
+  "for example. Rendering into a pixel buffer does not require QImage and is a lightweight "
+  "alternative for applications which process the rendered images themselves.\n"
+  "\n"
+  "This class has been introduced in version 0.27."
+);
+
 class Recipe_Impl
   : public tl::Recipe, public gsi::ObjectBase
 {
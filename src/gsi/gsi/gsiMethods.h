@@ -268,6 +268,27 @@ public:
     m_const = c;
   }
 
+  /**
+   *  @brief Gets a value indicating whether the method is a long-running one
+   *
+   *  Long-running methods are pure C++ methods which do not call back into
+   *  the script interpreter (e.g. through callbacks or events). Interpreters
+   *  with a global lock (i.e. Python) may release this lock while executing
+   *  such a method, allowing other script threads to run in the meantime.
+   */
+  bool is_long_running () const
+  {
+    return m_long_running;
+  }
+
+  /**
+   *  @brief Sets a value indicating whether the method is a long-running one
+   */
+  void set_long_running (bool f)
+  {
+    m_long_running = f;
+  }
+
   /**
    *  @brief Gets a value indicating whether the method is a static method
    */
@@ -570,6 +591,7 @@ private:
   bool m_const : 1;
   bool m_static : 1;
   bool m_protected : 1;
+  bool m_long_running : 1;
   unsigned int m_argsize;
   std::vector<MethodSynonym> m_method_synonyms;
 
@@ -730,6 +752,27 @@ inline Methods operator+ (const Methods &a, const Methods &b)
   return Methods (a) + b;
 }
 
+/**
+ *  @brief Marks the given methods as long-running
+ *
+ *  Use this function to decorate method declarations, e.g.
+ *
+ *  @code
+ *  gsi::long_running (gsi::method ("merged", &Region::merged, ...))
+ *  @endcode
+ *
+ *  See MethodBase::is_long_running for details. Only methods which do not
+ *  call back into the interpreter must be marked this way.
+ */
+inline Methods long_running (const Methods &m)
+{
+  Methods res (m);
+  for (std::vector<MethodBase *>::iterator i = res.m_methods.begin (); i != res.m_methods.end (); ++i) {
+    (*i)->set_long_running (true);
+  }
+  return res;
+}
+
 template <class X>
 class MethodSpecificBase 
   : public MethodBase
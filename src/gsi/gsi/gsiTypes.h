@@ -424,6 +424,7 @@ template <> struct type_traits<__int128>                    : generic_type_trait
 template <> struct type_traits<double>                      : generic_type_traits<double_tag, double, T_double> { };
 template <> struct type_traits<float>                       : generic_type_traits<float_tag, float, T_float> { };
 template <> struct type_traits<std::string>                 : generic_type_traits<string_tag, StringAdaptor, T_string> { };
+template <> struct type_traits<std::vector<char> >          : generic_type_traits<string_tag, StringAdaptor, T_string> { };
 #if defined(HAVE_QT)
 template <> struct type_traits<QString>                     : generic_type_traits<string_tag, StringAdaptor, T_string> { };
 template <> struct type_traits<QStringRef>                  : generic_type_traits<string_tag, StringAdaptor, T_string> { };
@@ -456,6 +457,7 @@ template <> struct type_traits<const __int128 &>            : generic_type_trait
 template <> struct type_traits<const double &>              : generic_type_traits<double_cref_tag, double, T_double> { };
 template <> struct type_traits<const float &>               : generic_type_traits<float_cref_tag, float, T_float> { };
 template <> struct type_traits<const std::string &>         : generic_type_traits<string_cref_tag, StringAdaptor, T_string> { };
+template <> struct type_traits<const std::vector<char> &>   : generic_type_traits<string_cref_tag, StringAdaptor, T_string> { };
 #if defined(HAVE_QT)
 template <> struct type_traits<const QString &>             : generic_type_traits<string_cref_tag, StringAdaptor, T_string> { };
 template <> struct type_traits<const QStringRef &>          : generic_type_traits<string_cref_tag, StringAdaptor, T_string> { };
@@ -485,6 +487,7 @@ template <> struct type_traits<__int128 &>                  : generic_type_trait
 template <> struct type_traits<double &>                    : generic_type_traits<double_ref_tag, double, T_double> { };
 template <> struct type_traits<float &>                     : generic_type_traits<float_ref_tag, float, T_float> { };
 template <> struct type_traits<std::string &>               : generic_type_traits<string_ref_tag, StringAdaptor, T_string> { };
+template <> struct type_traits<std::vector<char> &>         : generic_type_traits<string_ref_tag, StringAdaptor, T_string> { };
 #if defined(HAVE_QT)
 template <> struct type_traits<QString &>                   : generic_type_traits<string_ref_tag, StringAdaptor, T_string> { };
 template <> struct type_traits<QStringRef &>                : generic_type_traits<string_ref_tag, StringAdaptor, T_string> { };
@@ -515,6 +518,7 @@ template <> struct type_traits<const __int128 *>            : generic_type_trait
 template <> struct type_traits<const double *>              : generic_type_traits<double_cptr_tag, double, T_double> { };
 template <> struct type_traits<const float *>               : generic_type_traits<float_cptr_tag, float, T_float> { };
 template <> struct type_traits<const std::string *>         : generic_type_traits<string_cptr_tag, StringAdaptor, T_string> { };
+template <> struct type_traits<const std::vector<char> *>   : generic_type_traits<string_cptr_tag, StringAdaptor, T_string> { };
 #if defined(HAVE_QT)
 template <> struct type_traits<const QString *>             : generic_type_traits<string_cptr_tag, StringAdaptor, T_string> { };
 template <> struct type_traits<const QStringRef *>          : generic_type_traits<string_cptr_tag, StringAdaptor, T_string> { };
@@ -545,6 +549,7 @@ template <> struct type_traits<__int128 *>                  : generic_type_trait
 template <> struct type_traits<double *>                    : generic_type_traits<double_ptr_tag, double, T_double> { };
 template <> struct type_traits<float *>                     : generic_type_traits<float_ptr_tag, float, T_float> { };
 template <> struct type_traits<std::string *>               : generic_type_traits<string_ptr_tag, StringAdaptor, T_string> { };
+template <> struct type_traits<std::vector<char> *>         : generic_type_traits<string_ptr_tag, StringAdaptor, T_string> { };
 #if defined(HAVE_QT)
 template <> struct type_traits<QString *>                   : generic_type_traits<string_ptr_tag, StringAdaptor, T_string> { };
 template <> struct type_traits<QStringRef *>                : generic_type_traits<string_ptr_tag, StringAdaptor, T_string> { };
@@ -333,6 +333,26 @@ static QImage get_image_with_options (lay::LayoutView *view, unsigned int width,
 }
 #endif
 
+static tl::PixelBuffer get_pixels_with_options (lay::LayoutView *view, unsigned int width, unsigned int height, int linewidth, double resolution, const db::DBox &target_box)
+{
+  return view->get_pixels_with_options (width, height, linewidth, resolution, QColor (), QColor (), QColor (), target_box);
+}
+
+static void render_pixels_with_options (lay::LayoutView *view, tl::PixelBuffer &pixels, int linewidth, double resolution, const db::DBox &target_box)
+{
+  view->render_pixels_with_options (pixels, linewidth, resolution, QColor (), QColor (), QColor (), target_box);
+}
+
+static void set_show_redraw_statistics (lay::LayoutView *view, bool f)
+{
+  view->show_redraw_statistics (f);
+}
+
+static bool get_show_redraw_statistics (const lay::LayoutView *view)
+{
+  return view->show_redraw_statistics ();
+}
+
 static void save_image_with_options (lay::LayoutView *view, const std::string &fn, unsigned int width, unsigned int height, int linewidth, int oversampling, double resolution, const db::DBox &target_box, bool monochrome)
 {
   view->save_image_with_options (fn, width, height, linewidth, oversampling, resolution, QColor (), QColor (), QColor (), target_box, monochrome); 
@@ -1107,6 +1127,53 @@ Class<lay::LayoutView> decl_LayoutView (QT_EXTERNAL_BASE (QWidget) "lay", "Layou
     "This method has been introduced in 0.23.10.\n"
   ) +
 #endif
+  gsi::method_ext ("get_pixels_with_options", &get_pixels_with_options, gsi::arg ("width"), gsi::arg ("height"), gsi::arg ("linewidth", 0), gsi::arg ("resolution", 0.0), gsi::arg ("target", db::DBox (), "current box"),
+    "@brief Gets the layout image as a \\PixelBuffer (with options)\n"
+    "\n"
+    "@param width The width of the image to render in pixel.\n"
+    "@param height The height of the image to render in pixel.\n"
+    "@param linewidth The width of a line in pixels (usually 1) or 0 for default.\n"
+    "@param resolution The resolution (pixel size compared to a screen pixel size) or 0 for default.\n"
+    "@param target_box The box to draw or an empty box for default.\n"
+    "\n"
+    "In contrast to \\get_image_with_options, this method does not need Qt's image classes. "
+    "The image contains the layout only (no annotations or markers) and no oversampling is applied. "
+    "This makes the method suitable for batch rendering of many layout clips.\n"
+    "\n"
+    "This method has been introduced in 0.27.\n"
+  ) +
+  gsi::method_ext ("render_pixels_with_options", &render_pixels_with_options, gsi::arg ("pixels"), gsi::arg ("linewidth", 0), gsi::arg ("resolution", 0.0), gsi::arg ("target", db::DBox (), "current box"),
+    "@brief Renders the layout into an existing \\PixelBuffer (with options)\n"
+    "\n"
+    "@param pixels The pixel buffer to render into. The dimensions of the image are taken from this buffer.\n"
+    "@param linewidth The width of a line in pixels (usually 1) or 0 for default.\n"
+    "@param resolution The resolution (pixel size compared to a screen pixel size) or 0 for default.\n"
+    "@param target_box The box to draw or an empty box for default.\n"
+    "\n"
+    "This method is similar to \\get_pixels_with_options, but allows reusing a pixel buffer. "
+    "If the pixel buffer is transparent, the background is left transparent.\n"
+    "\n"
+    "This method has been introduced in 0.27.\n"
+  ) +
+  gsi::method ("redraw_statistics", &lay::LayoutView::redraw_statistics,
+    "@brief Gets the statistics of the current or last redraw\n"
+    "The statistics object delivered is a snapshot which includes the time spent per layer, "
+    "the number of shapes drawn, the number of instances visited and the cell bitmap cache hits. "
+    "See \\RedrawStatistics for details.\n"
+    "\n"
+    "This method has been introduced in 0.27.\n"
+  ) +
+  gsi::method_ext ("show_redraw_statistics=", &set_show_redraw_statistics, gsi::arg ("flag"),
+    "@brief Enables or disables the redraw statistics overlay\n"
+    "If enabled, a summary of the redraw statistics is painted over the layout.\n"
+    "\n"
+    "This method has been introduced in 0.27.\n"
+  ) +
+  gsi::method_ext ("show_redraw_statistics", &get_show_redraw_statistics,
+    "@brief Gets a value indicating whether the redraw statistics overlay is shown\n"
+    "\n"
+    "This method has been introduced in 0.27.\n"
+  ) +
   gsi::method ("save_screenshot", &lay::LayoutView::save_screenshot, gsi::arg ("filename"),
     "@brief Saves a screenshot to the given file\n"
     "\n"
@@ -0,0 +1,128 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "gsiDecl.h"
+#include "layRedrawStatistics.h"
+
+namespace gsi
+{
+
+static int task_id (const lay::RedrawLayerStatistics *s)
+{
+  return s->task_id;
+}
+
+static const std::string &task_name (const lay::RedrawLayerStatistics *s)
+{
+  return s->name;
+}
+
+static double task_seconds (const lay::RedrawLayerStatistics *s)
+{
+  return s->seconds;
+}
+
+static size_t shapes_drawn (const lay::RedrawLayerStatistics *s)
+{
+  return s->shapes_drawn;
+}
+
+static size_t instances_visited (const lay::RedrawLayerStatistics *s)
+{
+  return s->instances_visited;
+}
+
+static size_t cache_hits (const lay::RedrawLayerStatistics *s)
+{
+  return s->cache_hits;
+}
+
+static size_t cache_misses (const lay::RedrawLayerStatistics *s)
+{
+  return s->cache_misses;
+}
+
+Class<lay::RedrawLayerStatistics> decl_RedrawLayerStatistics ("lay", "RedrawLayerStatistics",
+  gsi::method_ext ("task_id", &task_id,
+    "@brief Gets the redraw task ID\n"
+    "For layers, the task ID is the index of the layer in the list of drawn layers. "
+    "Negative IDs are used for the cell frames and the decorations."
+  ) +
+  gsi::method_ext ("name", &task_name,
+    "@brief Gets the name of the redraw task\n"
+    "For layers, this is the display name of the layer as shown in the layer list."
+  ) +
+  gsi::method_ext ("seconds", &task_seconds,
+    "@brief Gets the time spent in this task in seconds"
+  ) +
+  gsi::method_ext ("shapes_drawn", &shapes_drawn,
+    "@brief Gets the number of shapes sent to the renderer"
+  ) +
+  gsi::method_ext ("instances_visited", &instances_visited,
+    "@brief Gets the number of instances visited"
+  ) +
+  gsi::method_ext ("cache_hits", &cache_hits,
+    "@brief Gets the number of cell bitmap cache hits"
+  ) +
+  gsi::method_ext ("cache_misses", &cache_misses,
+    "@brief Gets the number of cell bitmap cache misses"
+  ) +
+  gsi::method ("cache_hit_rate", &lay::RedrawLayerStatistics::cache_hit_rate,
+    "@brief Gets the cell bitmap cache hit rate (a value between 0 and 1)"
+  ),
+  "@brief Redraw statistics for a single layer or drawing task\n"
+  "Objects of this kind are delivered by \\RedrawStatistics#tasks and \\RedrawStatistics#total.\n"
+  "\n"
+  "This class has been introduced in version 0.27."
+);
+
+Class<lay::RedrawStatistics> decl_RedrawStatistics ("lay", "RedrawStatistics",
+  gsi::method ("tasks", &lay::RedrawStatistics::tasks,
+    "@brief Gets the statistics per redraw task (usually per layer)"
+  ) +
+  gsi::method ("total", &lay::RedrawStatistics::total,
+    "@brief Gets the statistics summed over all tasks"
+  ) +
+  gsi::method ("redraw_time", &lay::RedrawStatistics::redraw_time,
+    "@brief Gets the wall time of the full redraw in seconds"
+  ) +
+  gsi::method ("image_time", &lay::RedrawStatistics::image_time,
+    "@brief Gets the time spent in converting the drawn bitmaps into the screen image in seconds"
+  ) +
+  gsi::method ("image_updates", &lay::RedrawStatistics::image_updates,
+    "@brief Gets the number of image conversions during the redraw"
+  ) +
+  gsi::method ("to_s", &lay::RedrawStatistics::to_string, gsi::arg ("max_tasks", (unsigned int) 0),
+    "@brief Gets a human-readable summary\n"
+    "If 'max_tasks' is non-zero, only the given number of slowest tasks is listed."
+  ),
+  "@brief Statistics of a layout view redraw\n"
+  "Use \\LayoutView#redraw_statistics to obtain a snapshot of the statistics of the current "
+  "or last redraw. With \\LayoutView#show_redraw_statistics, an overlay showing these figures "
+  "can be enabled.\n"
+  "\n"
+  "This class has been introduced in version 0.27."
+);
+
+}
+
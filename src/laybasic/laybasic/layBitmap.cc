@@ -28,6 +28,49 @@
 
 namespace lay {
 
+static const uint32_t masks [32] = {
+  0x00000000, 0x00000001, 0x00000003, 0x00000007,
+  0x0000000f, 0x0000001f, 0x0000003f, 0x0000007f,
+  0x000000ff, 0x000001ff, 0x000003ff, 0x000007ff,
+  0x00000fff, 0x00001fff, 0x00003fff, 0x00007fff,
+  0x0000ffff, 0x0001ffff, 0x0003ffff, 0x0007ffff,
+  0x000fffff, 0x001fffff, 0x003fffff, 0x007fffff,
+  0x00ffffff, 0x01ffffff, 0x03ffffff, 0x07ffffff,
+  0x0fffffff, 0x1fffffff, 0x3fffffff, 0x7fffffff
+};
+
+static const uint32_t all_ones = 0xffffffff;
+
+static void
+fill_bits (uint32_t *sl, unsigned int x1, unsigned int x2)
+{
+  unsigned int b1 = x1 / 32;
+
+  sl += b1;
+
+  unsigned int b = x2 / 32 - b1;
+  if (b == 0) {
+
+    *sl |= (masks [x2 % 32] & ~masks [x1 % 32]);
+
+  } else if (b > 0) {
+
+    *sl++ |= ~masks [x1 % 32];
+    while (b > 1) {
+      *sl++ |= all_ones;
+      b--;
+    }
+
+    unsigned int m = masks [x2 % 32];
+    //  Hint: if x2==width and width%32==0, sl must not be accessed. This is guaranteed by
+    //  checking if m != 0.
+    if (m) {
+      *sl |= m;
+    }
+
+  }
+}
+
 Bitmap::Bitmap ()
   : m_empty_scanline (0)
 {
@@ -68,9 +111,28 @@ Bitmap::operator= (const Bitmap &d)
         for (unsigned int b = (m_width + 31) / 32; b > 0; --b) {
           *sl++ = *ss++;
         }
-      } else if (! m_scanlines.empty () && m_scanlines [i] != 0) {
-        m_free.push_back (m_scanlines [i]);
-        m_scanlines [i] = 0;
+      } else {
+        if (! m_scanlines.empty () && m_scanlines [i] != 0) {
+          m_free.push_back (m_scanlines [i]);
+          m_scanlines [i] = 0;
+        }
+        if (is_scanline_sparse (i)) {
+          m_spans [i]->clear ();
+          m_free_spans.push_back (m_spans [i]);
+          m_spans [i] = 0;
+        }
+        if (d.is_scanline_sparse (i)) {
+          if (m_spans.empty ()) {
+            m_spans.resize (m_height, 0);
+          }
+          if (! m_free_spans.empty ()) {
+            m_spans [i] = m_free_spans.back ();
+            m_free_spans.pop_back ();
+            *m_spans [i] = *d.m_spans [i];
+          } else {
+            m_spans [i] = new span_list (*d.m_spans [i]);
+          }
+        }
       }
     }
     
@@ -86,6 +148,17 @@ Bitmap::~Bitmap ()
   cleanup ();
 }
 
+void
+Bitmap::update_range (unsigned int n)
+{
+  if (m_first_sl > n) {
+    m_first_sl = n;
+  }
+  if (m_last_sl <= n) {
+    m_last_sl = n + 1;
+  }
+}
+
 uint32_t *
 Bitmap::scanline (unsigned int n)
 {
@@ -95,6 +168,7 @@ Bitmap::scanline (unsigned int n)
 
   uint32_t *sl = m_scanlines [n];
   if (sl == 0) {
+
     unsigned int b = (m_width + 31) / 32;
     if (! m_free.empty ()) {
       sl = m_scanlines [n] = m_free.back ();
@@ -105,16 +179,49 @@ Bitmap::scanline (unsigned int n)
     for (uint32_t *p = sl; b > 0; --b) {
       *p++ = 0;
     }
-    if (m_first_sl > n) {
-      m_first_sl = n;
-    }
-    if (m_last_sl <= n) {
-      m_last_sl = n + 1;
+
+    //  convert a sparse scanline into the dense representation
+    if (is_scanline_sparse (n)) {
+      span_list *spans = m_spans [n];
+      for (span_list::const_iterator s = spans->begin (); s != spans->end (); ++s) {
+        fill_bits (sl, s->first, s->second);
+      }
+      spans->clear ();
+      m_free_spans.push_back (spans);
+      m_spans [n] = 0;
     }
+
+    update_range (n);
+
   } 
   return sl;
 }
 
+void
+Bitmap::expand_scanline (unsigned int n, uint32_t *buffer) const
+{
+  unsigned int b = (m_width + 31) / 32;
+
+  if (n < m_scanlines.size () && m_scanlines [n] != 0) {
+    const uint32_t *sl = m_scanlines [n];
+    for ( ; b > 0; --b) {
+      *buffer++ = *sl++;
+    }
+    return;
+  }
+
+  for (uint32_t *p = buffer; b > 0; --b) {
+    *p++ = 0;
+  }
+
+  if (is_scanline_sparse (n)) {
+    const span_list *spans = m_spans [n];
+    for (span_list::const_iterator s = spans->begin (); s != spans->end (); ++s) {
+      fill_bits (buffer, s->first, s->second);
+    }
+  }
+}
+
 void
 Bitmap::clear ()
 {
@@ -126,6 +233,13 @@ Bitmap::clear ()
   for (std::vector<uint32_t *>::iterator i = m_scanlines.begin (); i != m_scanlines.end (); ++i) {
     *i = 0;
   }
+  for (std::vector<span_list *>::iterator i = m_spans.begin (); i != m_spans.end (); ++i) {
+    if (*i) {
+      (*i)->clear ();
+      m_free_spans.push_back (*i);
+      *i = 0;
+    }
+  }
   m_last_sl = m_first_sl = 0;
 }
 
@@ -149,6 +263,16 @@ Bitmap::cleanup ()
   }
   m_free.clear ();
 
+  for (std::vector<span_list *>::iterator i = m_spans.begin (); i != m_spans.end (); ++i) {
+    delete *i;
+  }
+  m_spans.clear ();
+
+  for (std::vector<span_list *>::iterator i = m_free_spans.begin (); i != m_free_spans.end (); ++i) {
+    delete *i;
+  }
+  m_free_spans.clear ();
+
   m_width = m_height = 0;
   m_last_sl = m_first_sl = 0;
 }
@@ -159,6 +283,10 @@ Bitmap::init (unsigned int w, unsigned int h)
   m_width = w;
   m_height = h;
 
+  //  The sparse representation is used as long as the span list takes less than
+  //  half of the memory of a dense scanline. For narrow bitmaps it is disabled.
+  m_max_spans = ((w + 31) / 32) / 4;
+
   if (m_width > 0) {
     unsigned int b = (w + 31) / 32;
     m_empty_scanline = new uint32_t [b];
@@ -170,6 +298,18 @@ Bitmap::init (unsigned int w, unsigned int h)
   m_last_sl = m_first_sl = 0;
 }
 
+void
+Bitmap::merge_spans (const span_list &spans, unsigned int y, int dx, unsigned int from_width)
+{
+  for (span_list::const_iterator s = spans.begin (); s != spans.end (); ++s) {
+    int x1 = std::max (0, int (s->first) + dx);
+    int x2 = std::min (int (from_width), int (s->second)) + dx;
+    if (x2 > x1) {
+      fill (y, (unsigned int) x1, (unsigned int) x2);
+    }
+  }
+}
+
 void 
 Bitmap::merge (const lay::Bitmap *from, int dx, int dy)
 {
@@ -217,6 +357,11 @@ Bitmap::merge (const lay::Bitmap *from, int dx, int dy)
         continue;
       }
 
+      if (from->is_scanline_sparse (n)) {
+        merge_spans (from->scanline_spans (n), n + dy, dx, from_width);
+        continue;
+      }
+
       const uint32_t *sl_from = from->scanline (n) + mo;
       uint32_t *sl_to = scanline (n + dy);
 
@@ -251,6 +396,11 @@ Bitmap::merge (const lay::Bitmap *from, int dx, int dy)
         continue;
       }
 
+      if (from->is_scanline_sparse (n)) {
+        merge_spans (from->scanline_spans (n), n + dy, dx, from_width);
+        continue;
+      }
+
       const uint32_t *sl_from = from->scanline (n);
       uint32_t *sl_to = scanline (n + dy) + mo;
 
@@ -304,7 +454,26 @@ Bitmap::fill_pattern (int y, int x, const uint32_t *pp, unsigned int stride, uns
           x1 = 0;
         }
 
-        if (p) {
+        if (p && m_max_spans > 0 && (m_scanlines.empty () || m_scanlines [y] == 0)) {
+
+          //  keep non-dense scanlines sparse: add the pattern as runs of pixels
+          unsigned int xx = (unsigned int) x1;
+          while (p) {
+            while (! (p & 1)) {
+              p >>= 1;
+              ++xx;
+            }
+            unsigned int xs = xx;
+            while (p & 1) {
+              p >>= 1;
+              ++xx;
+            }
+            if (xs < m_width) {
+              fill ((unsigned int) y, xs, std::min (xx, m_width));
+            }
+          }
+
+        } else if (p) {
 
           unsigned int bx = ((unsigned int) x1) & ~(32 - 1);
 
@@ -336,47 +505,68 @@ Bitmap::fill_pattern (int y, int x, const uint32_t *pp, unsigned int stride, uns
   }
 }
  
-static const uint32_t masks [32] = {
-  0x00000000, 0x00000001, 0x00000003, 0x00000007,
-  0x0000000f, 0x0000001f, 0x0000003f, 0x0000007f,
-  0x000000ff, 0x000001ff, 0x000003ff, 0x000007ff,
-  0x00000fff, 0x00001fff, 0x00003fff, 0x00007fff,
-  0x0000ffff, 0x0001ffff, 0x0003ffff, 0x0007ffff,
-  0x000fffff, 0x001fffff, 0x003fffff, 0x007fffff,
-  0x00ffffff, 0x01ffffff, 0x03ffffff, 0x07ffffff,
-  0x0fffffff, 0x1fffffff, 0x3fffffff, 0x7fffffff
-};
-
-static const uint32_t all_ones = 0xffffffff;
 
 void 
 Bitmap::fill (unsigned int y, unsigned int x1, unsigned int x2)
 {
-  unsigned int b1 = x1 / 32;
+  if (m_max_spans > 0 && (m_scanlines.empty () || m_scanlines [y] == 0)) {
+    fill_sparse (y, x1, x2);
+  } else {
+    fill_bits (scanline (y), x1, x2);
+  }
+}
 
-  uint32_t *sl = scanline (y);
-  sl += b1;
+void
+Bitmap::fill_sparse (unsigned int y, unsigned int x1, unsigned int x2)
+{
+  if (x2 <= x1) {
+    return;
+  }
 
-  unsigned int b = x2 / 32 - b1;
-  if (b == 0) {
+  if (m_spans.empty ()) {
+    m_spans.resize (m_height, 0);
+  }
 
-    *sl |= (masks [x2 % 32] & ~masks [x1 % 32]);
+  span_list *spans = m_spans [y];
+  if (! spans) {
+    if (! m_free_spans.empty ()) {
+      spans = m_free_spans.back ();
+      m_free_spans.pop_back ();
+    } else {
+      spans = new span_list ();
+    }
+    m_spans [y] = spans;
+    update_range (y);
+  }
 
-  } else if (b > 0) {
+  //  find the first span which ends at or after x1 - this one may be joined with the new one
+  span_list::iterator s = spans->end ();
+  while (s != spans->begin () && (s - 1)->second >= x1) {
+    --s;
+  }
 
-    *sl++ |= ~masks [x1 % 32];
-    while (b > 1) {
-      *sl++ |= all_ones;
-      b--;
-    }
+  if (s == spans->end () || s->first > x2) {
 
-    unsigned int m = masks [x2 % 32];
-    //  Hint: if x2==width and width%32==0, sl must not be accessed. This is guaranteed by
-    //  checking if m != 0.
-    if (m) {
-      *sl |= m;
+    spans->insert (s, std::make_pair (x1, x2));
+
+  } else {
+
+    //  join the new span with all spans it overlaps or touches
+    s->first = std::min (s->first, x1);
+    s->second = std::max (s->second, x2);
+
+    span_list::iterator e = s + 1;
+    while (e != spans->end () && e->first <= s->second) {
+      s->second = std::max (s->second, e->second);
+      ++e;
     }
+    spans->erase (s + 1, e);
+
+  }
 
+  //  switch to dense representation if the span list becomes too long
+  if (spans->size () > m_max_spans) {
+    scanline (y);
   }
 }
 
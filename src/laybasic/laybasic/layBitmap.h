@@ -137,13 +137,26 @@ struct RenderText
  *  shapes. The basic ability is to provide scanlines. A scanline
  *  is an array of uint32_t. It is up to the renderer how the
  *  scanlines are used.
- *  
+ *
+ *  Scanlines are created on demand. As long as a scanline is only
+ *  partially covered, it is kept in a sparse representation - a sorted
+ *  list of non-overlapping spans. When the number of spans exceeds a 
+ *  certain limit or a scanline is requested for modification, the scanline 
+ *  is converted into the dense representation. This keeps the memory 
+ *  footprint low for mostly empty planes at high resolutions.
  */
 
 class LAYBASIC_PUBLIC Bitmap 
   : public CanvasPlane
 {
 public:
+  /**
+   *  @brief The span list type for the sparse scanline representation
+   *
+   *  Each span is a pair of start (inclusive) and end (exclusive) x coordinate.
+   */
+  typedef std::vector<std::pair<unsigned int, unsigned int> > span_list;
+
   /**
    *  @brief Default constructor
    *
@@ -202,6 +215,10 @@ public:
 
   /**
    *  @brief Fetch scanline number n
+   *
+   *  This method does not change the bitmap. For scanlines which are not 
+   *  stored in dense representation, the empty scanline is returned. Hence
+   *  sparse scanlines need to be read with "expand_scanline" or "scanline_spans".
    */
   const uint32_t *scanline (unsigned int n) const;
 
@@ -210,8 +227,32 @@ public:
    */
   bool is_scanline_empty (unsigned int n) const;
 
+  /**
+   *  @brief Report true if the scanline is stored in sparse representation
+   */
+  bool is_scanline_sparse (unsigned int n) const;
+
+  /**
+   *  @brief Gets the spans of a sparse scanline
+   *
+   *  This method must only be called if "is_scanline_sparse" is true for 
+   *  this scanline. The spans are sorted and do not overlap or touch.
+   */
+  const span_list &scanline_spans (unsigned int n) const;
+
+  /**
+   *  @brief Expands scanline number n into the given buffer
+   *
+   *  The buffer must be large enough to hold (width + 31) / 32 words.
+   *  This method works on dense, sparse and empty scanlines and does not 
+   *  change the representation of the scanline.
+   */
+  void expand_scanline (unsigned int n, uint32_t *buffer) const;
+
   /**
    *  @brief Fetch scanline number n in modification mode
+   *
+   *  This will convert the scanline into dense representation.
    */
   uint32_t *scanline (unsigned int n);
 
@@ -305,11 +346,17 @@ private:
   double m_resolution;
   std::vector<uint32_t *> m_scanlines;
   std::vector<uint32_t *> m_free;
+  std::vector<span_list *> m_spans;
+  std::vector<span_list *> m_free_spans;
+  unsigned int m_max_spans;
   uint32_t *m_empty_scanline;
   unsigned int m_first_sl, m_last_sl;
 
   void cleanup ();
   void init (unsigned int w, unsigned int h);
+  void fill_sparse (unsigned int y, unsigned int x1, unsigned int x2);
+  void update_range (unsigned int n);
+  void merge_spans (const span_list &spans, unsigned int y, int dx, unsigned int from_width);
 
   /**
    *  @brief Fill a bit pattern 
@@ -330,10 +377,22 @@ private:
   void fill_pattern (int y, int x, const uint32_t *p, unsigned int stride, unsigned int n);
 };
 
+inline bool
+Bitmap::is_scanline_sparse (unsigned int n) const
+{
+  return n < m_spans.size () && m_spans [n] != 0;
+}
+
 inline bool
 Bitmap::is_scanline_empty (unsigned int n) const
 {
-  return m_scanlines.empty () || m_scanlines [n] == 0;
+  return (m_scanlines.empty () || m_scanlines [n] == 0) && ! is_scanline_sparse (n);
+}
+
+inline const Bitmap::span_list &
+Bitmap::scanline_spans (unsigned int n) const
+{
+  return *m_spans [n];
 }
 
 inline bool
@@ -34,9 +34,83 @@
 namespace lay
 {
 
+/**
+ *  @brief Provides read access to dense and sparse scanlines
+ *
+ *  Sparse scanlines are expanded into a slot of a scratch buffer, so the 
+ *  bitmap is not converted into the dense representation while reading.
+ */
+class ScanlineSource
+{
+public:
+  //  the maximum number of scanlines required at the same time (see render_scanline_px)
+  static const unsigned int max_slots = 16;
+
+  ScanlineSource (unsigned int width)
+    : m_nwords ((width + 31) / 32), m_buffer (size_t (m_nwords) * max_slots + 1, 0)
+  {
+    //  .. nothing yet ..
+  }
+
+  const uint32_t *get (const lay::Bitmap *pbitmap, unsigned int y, unsigned int slot)
+  {
+    if (! pbitmap->is_scanline_sparse (y)) {
+      return pbitmap->scanline (y);
+    }
+
+    tl_assert (slot < max_slots);
+    tl_assert ((pbitmap->width () + 31) / 32 <= m_nwords);
+
+    uint32_t *b = &m_buffer.front () + size_t (slot) * m_nwords;
+    pbitmap->expand_scanline (y, b);
+    return b;
+  }
+
+private:
+  unsigned int m_nwords;
+  std::vector<uint32_t> m_buffer;
+};
+
+static void
+render_scanline_std_sparse (const uint32_t *dp, unsigned int ds, const lay::Bitmap::span_list &spans, unsigned int w, uint32_t *data)
+{
+  unsigned int nwords = (w + 31) / 32;
+  for (unsigned int i = 0; i < nwords; ++i) {
+    data [i] = 0;
+  }
+
+  //  render the dither pattern into the spans directly
+  for (lay::Bitmap::span_list::const_iterator s = spans.begin (); s != spans.end (); ++s) {
+
+    unsigned int x1 = s->first;
+    unsigned int x2 = std::min (s->second, w);
+
+    while (x1 < x2) {
+
+      unsigned int b = x1 / lay::wordlen;
+      unsigned int xe = std::min (x2, (b + 1) * lay::wordlen);
+
+      uint32_t m = lay::wordones << (x1 % lay::wordlen);
+      if (xe % lay::wordlen != 0) {
+        m &= ~(lay::wordones << (xe % lay::wordlen));
+      }
+
+      data [b] |= m & dp [b % ds];
+      x1 = xe;
+
+    }
+
+  }
+}
+
 static void
 render_scanline_std (const uint32_t *dp, unsigned int ds, const lay::Bitmap *pbitmap, unsigned int y, unsigned int w, unsigned int /*h*/, uint32_t *data)
 {
+  if (pbitmap->is_scanline_sparse (y)) {
+    render_scanline_std_sparse (dp, ds, pbitmap->scanline_spans (y), w, data);
+    return;
+  }
+
   const uint32_t *ps = pbitmap->scanline (y);
   const uint32_t *dm = dp;
 
@@ -55,11 +129,11 @@ render_scanline_std (const uint32_t *dp, unsigned int ds, const lay::Bitmap *pbi
 }
 
 static void
-render_scanline_std_edge (const uint32_t *dp, unsigned int ds, const lay::Bitmap *pbitmap, unsigned int y, unsigned int w, unsigned int h, uint32_t *data)
+render_scanline_std_edge (const uint32_t *dp, unsigned int ds, const lay::Bitmap *pbitmap, unsigned int y, unsigned int w, unsigned int h, uint32_t *data, ScanlineSource &sls)
 {
-  const uint32_t *psp = (y > 0 ? pbitmap->scanline (y - 1) : pbitmap->empty_scanline ());
-  const uint32_t *psn = (y < h - 1 ? pbitmap->scanline (y + 1) : pbitmap->empty_scanline ());
-  const uint32_t *ps = pbitmap->scanline (y);
+  const uint32_t *psp = (y > 0 ? sls.get (pbitmap, y - 1, 0) : pbitmap->empty_scanline ());
+  const uint32_t *psn = (y < h - 1 ? sls.get (pbitmap, y + 1, 1) : pbitmap->empty_scanline ());
+  const uint32_t *ps = sls.get (pbitmap, y, 2);
 
   const uint32_t *dm = dp;
 
@@ -235,7 +309,7 @@ render_scanline_std_edge (const uint32_t *dp, unsigned int ds, const lay::Bitmap
 static void
 render_scanline_px (const uint32_t *dp, unsigned int ds, const lay::Bitmap *pbitmap,
                     unsigned int y, unsigned int w, unsigned int h, uint32_t *data,
-                    unsigned int pixels)
+                    unsigned int pixels, ScanlineSource &sls)
 {
   if (pixels < 1) {
     return;
@@ -253,11 +327,11 @@ render_scanline_px (const uint32_t *dp, unsigned int ds, const lay::Bitmap *pbit
   const uint32_t *ps[16];
   for (unsigned int p = 0; p < pixels; ++p) {
     if (y + p < px1) {
-      ps[p] = pbitmap->scanline (0);
+      ps[p] = sls.get (pbitmap, 0, p);
     } else if ((y + p - px1) >= h) {
-      ps[p] = pbitmap->scanline (h - 1);
+      ps[p] = sls.get (pbitmap, h - 1, p);
     } else {
-      ps[p] = pbitmap->scanline (y + p - px1);
+      ps[p] = sls.get (pbitmap, y + p - px1, p);
     }
   }
 
@@ -306,7 +380,7 @@ render_scanline_px (const uint32_t *dp, unsigned int ds, const lay::Bitmap *pbit
 static void
 render_scanline_cross (const uint32_t *dp, unsigned int ds, const lay::Bitmap *pbitmap,
                        unsigned int y, unsigned int w, unsigned int h, uint32_t *data,
-                       unsigned int pixels)
+                       unsigned int pixels, ScanlineSource &sls)
 {
   if (pixels < 1) {
     return;
@@ -323,11 +397,11 @@ render_scanline_cross (const uint32_t *dp, unsigned int ds, const lay::Bitmap *p
   const uint32_t *ps[16];
   for (unsigned int p = 0; p < pixels; ++p) {
     if (y + p < px1) {
-      ps[p] = pbitmap->scanline (0);
+      ps[p] = sls.get (pbitmap, 0, p);
     } else if ((y + p - px1) >= h) {
-      ps[p] = pbitmap->scanline (h - 1);
+      ps[p] = sls.get (pbitmap, h - 1, p);
     } else {
-      ps[p] = pbitmap->scanline (y + p - px1);
+      ps[p] = sls.get (pbitmap, y + p - px1, p);
     }
   }
 
@@ -409,8 +483,9 @@ static void create_precursor_bitmaps (const std::vector<lay::ViewOp> &view_ops_i
       LineStyleInfo ls_info = ls.style (op.line_style_index ());
       ls_info.scale_pattern (op.width ());
 
+      ScanlineSource sls (width);
       for (unsigned int y = 0; y < height; y++) {
-        render_scanline_std_edge (ls_info.pattern (), ls_info.pattern_stride (), pbitmaps_in [bm_index], y, width, height, bp.scanline (y));
+        render_scanline_std_edge (ls_info.pattern (), ls_info.pattern_stride (), pbitmaps_in [bm_index], y, width, height, bp.scanline (y), sls);
       }
 
       if (mutex) {
@@ -422,15 +497,16 @@ static void create_precursor_bitmaps (const std::vector<lay::ViewOp> &view_ops_i
   }
 }
 
-static void 
-bitmaps_to_image_rgb (const std::vector<lay::ViewOp> &view_ops_in,
-                      const std::vector<lay::Bitmap *> &pbitmaps_in,
-                      const lay::DitherPattern &dp,
-                      const lay::LineStyles &ls,
-                      QImage *pimage, unsigned int width, unsigned int height,
-                      bool use_bitmap_index,
-                      bool transparent,
-                      QMutex *mutex)
+void
+bitmaps_to_image (const std::vector<lay::ViewOp> &view_ops_in,
+                  const std::vector<lay::Bitmap *> &pbitmaps_in,
+                  const lay::DitherPattern &dp,
+                  const lay::LineStyles &ls,
+                  lay::color_t *data, unsigned int stride,
+                  unsigned int width, unsigned int height,
+                  bool use_bitmap_index,
+                  bool transparent,
+                  QMutex *mutex)
 {
   std::vector<unsigned int> bm_map;
   std::vector<unsigned int> vo_map;
@@ -479,6 +555,9 @@ bitmaps_to_image_rgb (const std::vector<lay::ViewOp> &view_ops_in,
   unsigned int nwords = (width + 31) / 32;
   uint32_t *buffer = new uint32_t [n_in * nwords];
 
+  //  a scratch buffer for reading sparse scanlines
+  ScanlineSource sls (width);
+
   for (unsigned int y = 0; y < height; y++) {
 
     //  lock bitmaps against change by the redraw thread
@@ -559,15 +638,15 @@ bitmaps_to_image_rgb (const std::vector<lay::ViewOp> &view_ops_in,
 
           if (op.width () == 1) {
             if (ls_info.width () > 0) {
-              render_scanline_std_edge (ls_info.pattern (), ls_info.pattern_stride (), pbitmaps [i], y, width, height, dptr);
+              render_scanline_std_edge (ls_info.pattern (), ls_info.pattern_stride (), pbitmaps [i], y, width, height, dptr, sls);
             } else {
               render_scanline_std (dither, dither_stride, pbitmaps [i], y, width, height, dptr);
             }
           } else if (op.width () > 1) {
             if (op.shape () == lay::ViewOp::Rect) {
-              render_scanline_px (dither, dither_stride, pbitmaps [i], y, width, height, dptr, (unsigned int) op.width ());
+              render_scanline_px (dither, dither_stride, pbitmaps [i], y, width, height, dptr, (unsigned int) op.width (), sls);
             } else if (op.shape () == lay::ViewOp::Cross) {
-              render_scanline_cross (dither, dither_stride, pbitmaps [i], y, width, height, dptr, (unsigned int) op.width ());
+              render_scanline_cross (dither, dither_stride, pbitmaps [i], y, width, height, dptr, (unsigned int) op.width (), sls);
             }
           }
 
@@ -588,7 +667,7 @@ bitmaps_to_image_rgb (const std::vector<lay::ViewOp> &view_ops_in,
 
     if (masks.size () > 0) {
 
-      lay::color_t *pt = (lay::color_t *) pimage->scanLine (height - 1 - y);
+      lay::color_t *pt = data + size_t (height - 1 - y) * size_t (stride);
       uint32_t *dptr_end = dptr; 
 
       unsigned int i = 0;
@@ -717,6 +796,9 @@ bitmaps_to_image_mono (const std::vector<lay::ViewOp> &view_ops_in,
   unsigned int nwords = (width + 31) / 32;
   uint32_t *buffer = new uint32_t [n_in * nwords];
 
+  //  a scratch buffer for reading sparse scanlines
+  ScanlineSource sls (width);
+
   for (unsigned int y = 0; y < height; y++) {
 
     //  lock bitmaps against change by the redraw thread
@@ -796,15 +878,15 @@ bitmaps_to_image_mono (const std::vector<lay::ViewOp> &view_ops_in,
 
           if (op.width () == 1) {
             if (ls_info.width () > 0) {
-              render_scanline_std_edge (ls_info.pattern (), ls_info.pattern_stride (), pbitmaps [i], y, width, height, dptr);
+              render_scanline_std_edge (ls_info.pattern (), ls_info.pattern_stride (), pbitmaps [i], y, width, height, dptr, sls);
             } else {
               render_scanline_std (dither, dither_stride, pbitmaps [i], y, width, height, dptr);
             }
           } else if (op.width () > 1) {
             if (op.shape () == lay::ViewOp::Rect) {
-              render_scanline_px (dither, dither_stride, pbitmaps [i], y, width, height, dptr, (unsigned int) op.width ());
+              render_scanline_px (dither, dither_stride, pbitmaps [i], y, width, height, dptr, (unsigned int) op.width (), sls);
             } else if (op.shape () == lay::ViewOp::Cross) {
-              render_scanline_cross (dither, dither_stride, pbitmaps [i], y, width, height, dptr, (unsigned int) op.width ());
+              render_scanline_cross (dither, dither_stride, pbitmaps [i], y, width, height, dptr, (unsigned int) op.width (), sls);
             }
           }
 
@@ -879,7 +961,8 @@ bitmaps_to_image (const std::vector<lay::ViewOp> &view_ops_in,
     bitmaps_to_image_mono (view_ops_in, pbitmaps_in, dp, ls, pimage, width, height, use_bitmap_index, mutex);
   } else {
     bool transparent = (pimage->format () == QImage::Format_ARGB32);
-    bitmaps_to_image_rgb (view_ops_in, pbitmaps_in, dp, ls, pimage, width, height, use_bitmap_index, transparent, mutex);
+    tl_assert (pimage->bytesPerLine () % sizeof (lay::color_t) == 0);
+    bitmaps_to_image (view_ops_in, pbitmaps_in, dp, ls, (lay::color_t *) pimage->bits (), (unsigned int) (pimage->bytesPerLine () / sizeof (lay::color_t)), width, height, use_bitmap_index, transparent, mutex);
   }
 }
 
@@ -898,6 +981,8 @@ bitmap_to_bitmap (const lay::ViewOp &view_op, const lay::Bitmap &bitmap,
   unsigned int nwords = (width + 31) / 32;
   uint32_t *buffer = new uint32_t [nwords];
 
+  ScanlineSource sls (width);
+
   //  determine endianess ..
   unsigned int x = 0xc0000001;
   unsigned char x0 = ((unsigned char *) &x) [0];
@@ -917,7 +1002,7 @@ bitmap_to_bitmap (const lay::ViewOp &view_op, const lay::Bitmap &bitmap,
       if (view_op.width () == 1) {
 
         if (ls_info.width () > 0) {
-          render_scanline_std_edge (ls_info.pattern (), ls_info.pattern_stride (), &bitmap, height - 1 - y, width, height, buffer);
+          render_scanline_std_edge (ls_info.pattern (), ls_info.pattern_stride (), &bitmap, height - 1 - y, width, height, buffer, sls);
         } else {
           render_scanline_std (dither, dither_stride, &bitmap, height - 1 - y, width, height, buffer);
         }
@@ -937,7 +1022,7 @@ bitmap_to_bitmap (const lay::ViewOp &view_op, const lay::Bitmap &bitmap,
           lsi.scale_pattern (view_op.width ());
 
           for (unsigned int y = 0; y < height; y++) {
-            render_scanline_std_edge (lsi.pattern (), lsi.pattern_stride (), bp, y, width, height, precursor.scanline (y));
+            render_scanline_std_edge (lsi.pattern (), lsi.pattern_stride (), bp, y, width, height, precursor.scanline (y), sls);
           }
 
           bp = &precursor;
@@ -945,9 +1030,9 @@ bitmap_to_bitmap (const lay::ViewOp &view_op, const lay::Bitmap &bitmap,
         }
 
         if (view_op.shape () == lay::ViewOp::Rect) {
-          render_scanline_px (dither, dither_stride, bp, height - 1 - y, width, height, buffer, (unsigned int) view_op.width ());
+          render_scanline_px (dither, dither_stride, bp, height - 1 - y, width, height, buffer, (unsigned int) view_op.width (), sls);
         } else if (view_op.shape () == lay::ViewOp::Cross) {
-          render_scanline_cross (dither, dither_stride, bp, height - 1 - y, width, height, buffer, (unsigned int) view_op.width ());
+          render_scanline_cross (dither, dither_stride, bp, height - 1 - y, width, height, buffer, (unsigned int) view_op.width (), sls);
         }
       }
 
@@ -62,6 +62,29 @@ bitmaps_to_image (const std::vector <lay::ViewOp> &view_ops,
                   bool use_bitmap_index,
                   QMutex *mutex);
 
+/**
+ *  @brief This function converts the given set of bitmaps to a raw 32 bit pixel buffer
+ *
+ *  This is the Qt-independent variant of bitmaps_to_image for color images.
+ *  It paints into a caller-supplied buffer of width x height pixels. "data"
+ *  points to the top left pixel and "stride" is the distance between two rows
+ *  in pixels. The pixel format is 0xAARRGGBB, which is the layout of
+ *  QImage::Format_RGB32 and QImage::Format_ARGB32.
+ *  If "transparent" is true, the alpha channel is set for painted pixels
+ *  only. Otherwise, the alpha channel is set to 0xff.
+ *  The other parameters are the same than for the QImage variant.
+ */
+LAYBASIC_PUBLIC void
+bitmaps_to_image (const std::vector <lay::ViewOp> &view_ops,
+                  const std::vector <lay::Bitmap *> &pbitmaps,
+                  const lay::DitherPattern &dp,
+                  const lay::LineStyles &ls,
+                  lay::color_t *data, unsigned int stride,
+                  unsigned int width, unsigned int height,
+                  bool use_bitmap_index,
+                  bool transparent,
+                  QMutex *mutex);
+
 /**
  *  @brief Convert a lay::Bitmap to a unsigned char * data field to be passed to QBitmap
  *
@@ -0,0 +1,148 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "layCellNameIndex.h"
+#include "dbLayout.h"
+#include "tlGlobPattern.h"
+
+#include <algorithm>
+
+namespace lay
+{
+
+//  Only ASCII characters are folded: the case-insensitive prefix is confined to
+//  ASCII characters, so this is sufficient to select the candidates.
+static std::string
+ascii_lower (const std::string &s)
+{
+  std::string r (s);
+  for (std::string::iterator c = r.begin (); c != r.end (); ++c) {
+    if (*c >= 'A' && *c <= 'Z') {
+      *c = *c - 'A' + 'a';
+    }
+  }
+  return r;
+}
+
+static bool
+starts_with (const std::string &s, const std::string &prefix)
+{
+  return s.size () >= prefix.size () && s.compare (0, prefix.size (), prefix) == 0;
+}
+
+CellNameIndex::CellNameIndex ()
+  : m_valid (false)
+{
+  //  .. nothing yet ..
+}
+
+void
+CellNameIndex::invalidate ()
+{
+  m_names.clear ();
+  m_lc_names.clear ();
+  m_valid = false;
+}
+
+void
+CellNameIndex::build (const db::Layout &layout)
+{
+  invalidate ();
+
+  m_names.reserve (layout.cells ());
+  for (db::Layout::const_iterator c = layout.begin (); c != layout.end (); ++c) {
+    m_names.push_back (std::make_pair (c->get_display_name (), c->cell_index ()));
+  }
+  std::sort (m_names.begin (), m_names.end ());
+
+  m_lc_names.reserve (m_names.size ());
+  for (name_list::const_iterator n = m_names.begin (); n != m_names.end (); ++n) {
+    m_lc_names.push_back (std::make_pair (ascii_lower (n->first), size_t (n - m_names.begin ())));
+  }
+  std::sort (m_lc_names.begin (), m_lc_names.end ());
+
+  m_valid = true;
+}
+
+std::string
+CellNameIndex::literal_prefix (const tl::GlobPattern &pattern)
+{
+  const std::string &p = pattern.pattern ();
+  if (pattern.exact ()) {
+    return p;
+  }
+
+  std::string prefix;
+  for (const char *c = p.c_str (); *c; ++c) {
+    if (*c == '\\') {
+      if (c[1]) {
+        prefix += *++c;
+      }
+    } else if (*c == '?' || *c == '*' || *c == '[' || *c == '{' || *c == '(') {
+      break;
+    } else {
+      prefix += *c;
+    }
+  }
+
+  return prefix;
+}
+
+void
+CellNameIndex::find (const tl::GlobPattern &pattern, std::vector<db::cell_index_type> &cells) const
+{
+  std::string prefix = literal_prefix (pattern);
+
+  if (pattern.case_sensitive ()) {
+
+    name_list::const_iterator i = std::lower_bound (m_names.begin (), m_names.end (), std::make_pair (prefix, db::cell_index_type (0)));
+    for ( ; i != m_names.end () && starts_with (i->first, prefix); ++i) {
+      if (pattern.match (i->first)) {
+        cells.push_back (i->second);
+      }
+    }
+
+  } else {
+
+    //  confine the prefix to ASCII characters (see ascii_lower)
+    size_t n = 0;
+    while (n < prefix.size () && (unsigned char) prefix [n] < 0x80) {
+      ++n;
+    }
+    prefix = ascii_lower (std::string (prefix, 0, n));
+
+    lc_name_list::const_iterator i = std::lower_bound (m_lc_names.begin (), m_lc_names.end (), std::make_pair (prefix, size_t (0)));
+    for ( ; i != m_lc_names.end () && starts_with (i->first, prefix); ++i) {
+      const std::pair<std::string, db::cell_index_type> &name = m_names [i->second];
+      if (pattern.match (name.first)) {
+        cells.push_back (name.second);
+      }
+    }
+
+  }
+
+  std::sort (cells.begin (), cells.end ());
+}
+
+}
+
@@ -0,0 +1,111 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#ifndef HDR_layCellNameIndex
+#define HDR_layCellNameIndex
+
+#include "laybasicCommon.h"
+#include "dbTypes.h"
+
+#include <vector>
+#include <string>
+
+namespace tl
+{
+  class GlobPattern;
+}
+
+namespace db
+{
+  class Layout;
+}
+
+namespace lay
+{
+
+/**
+ *  @brief A sorted index of the cell display names of a layout
+ *
+ *  The index is used to find cells by name patterns. It keeps the names
+ *  sorted, once as they are and once in lower case. The literal prefix of a
+ *  pattern (the part before the first wildcard) then selects a range of
+ *  candidates and only these are matched against the pattern. Patterns
+ *  starting with a wildcard still need to visit all names.
+ *
+ *  The index does not observe the layout. It needs to be rebuilt when cells
+ *  are added, removed or renamed.
+ */
+class LAYBASIC_PUBLIC CellNameIndex
+{
+public:
+  /**
+   *  @brief Creates an empty, invalid index
+   */
+  CellNameIndex ();
+
+  /**
+   *  @brief Builds the index for the given layout
+   */
+  void build (const db::Layout &layout);
+
+  /**
+   *  @brief Clears the index and marks it invalid
+   */
+  void invalidate ();
+
+  /**
+   *  @brief Gets a value indicating whether the index has been built
+   */
+  bool is_valid () const
+  {
+    return m_valid;
+  }
+
+  /**
+   *  @brief Finds the cells whose display name matches the given pattern
+   *
+   *  The cell indexes are appended to "cells" which is sorted afterwards.
+   */
+  void find (const tl::GlobPattern &pattern, std::vector<db::cell_index_type> &cells) const;
+
+  /**
+   *  @brief Gets the literal prefix of the pattern
+   *
+   *  All names matched by the pattern start with this prefix. This method is
+   *  provided for testing purposes mainly.
+   */
+  static std::string literal_prefix (const tl::GlobPattern &pattern);
+
+private:
+  typedef std::vector<std::pair<std::string, db::cell_index_type> > name_list;
+  typedef std::vector<std::pair<std::string, size_t> > lc_name_list;
+
+  name_list m_names;
+  lc_name_list m_lc_names;
+  bool m_valid;
+};
+
+}
+
+#endif
+
@@ -40,37 +40,75 @@
 namespace lay {
 
 // --------------------------------------------------------------------
-//  A compare functor for the cell tree items by area
+//  Sorting of cell tree items
+//
+//  Sorting is done on precomputed keys: the display text of a cell may require
+//  some string formatting (i.e. for library proxies and PCell variants) and
+//  the area requires a bbox lookup. Computing them inside the compare function
+//  would do this O(N log N) times instead of N times.
+
+struct CellTreeItemSortKey
+{
+  CellTreeItemSortKey (CellTreeItem *i, CellTreeModel::Sorting sorting)
+    : item (i), text (i->display_text ()), area (0), is_pcell (i->is_pcell ())
+  {
+    if (sorting != CellTreeModel::ByName) {
+      area = i->area ();
+    }
+  }
+
+  CellTreeItem *item;
+  std::string text;
+  db::Box::area_type area;
+  bool is_pcell;
+};
 
-struct cmp_cell_tree_items_f 
+struct cmp_cell_tree_item_keys_f
 {
-  cmp_cell_tree_items_f (CellTreeModel::Sorting s)
+  cmp_cell_tree_item_keys_f (CellTreeModel::Sorting s)
     : m_sorting (s)
   { }
 
-  bool operator() (const CellTreeItem *a, const CellTreeItem *b)
+  bool operator() (const CellTreeItemSortKey &a, const CellTreeItemSortKey &b) const
   {
     if (m_sorting == CellTreeModel::ByArea) {
-      if (a->by_area_equal_than (b)) {
-        return a->by_name_less_than (b);
-      } else {
-        return a->by_area_less_than (b);
+      //  PCells are considered smallest
+      if (a.is_pcell != b.is_pcell) {
+        return a.is_pcell > b.is_pcell;
+      } else if (a.area != b.area) {
+        return a.area < b.area;
       }
     } else if (m_sorting == CellTreeModel::ByAreaReverse) {
-      if (a->by_area_equal_than (b)) {
-        return a->by_name_less_than (b);
-      } else {
-        return b->by_area_less_than (a);
+      if (a.is_pcell != b.is_pcell) {
+        return a.is_pcell < b.is_pcell;
+      } else if (a.area != b.area) {
+        return a.area > b.area;
       }
-    } else {
-      return a->by_name_less_than (b);
     }
+    return a.text < b.text;
   }
 
 private:
   CellTreeModel::Sorting m_sorting;
 };
 
+static void
+sort_cell_tree_items (std::vector<CellTreeItem *> &items, CellTreeModel::Sorting sorting)
+{
+  std::vector<CellTreeItemSortKey> keys;
+  keys.reserve (items.size ());
+  for (std::vector<CellTreeItem *>::const_iterator i = items.begin (); i != items.end (); ++i) {
+    keys.push_back (CellTreeItemSortKey (*i, sorting));
+  }
+
+  std::sort (keys.begin (), keys.end (), cmp_cell_tree_item_keys_f (sorting));
+
+  for (size_t i = 0; i < keys.size (); ++i) {
+    items [i] = keys [i].item;
+    items [i]->set_index (i);
+  }
+}
+
 // --------------------------------------------------------------------
 //  A compare functor for the cell tree items vs. name
 
@@ -164,11 +202,7 @@ CellTreeItem::add_child (CellTreeItem *item)
 void
 CellTreeItem::finish_children ()
 {
-  std::sort (m_children.begin (), m_children.end (), cmp_cell_tree_items_f (m_sorting));
-
-  for (size_t i = 0; i < m_children.size (); ++i) {
-    m_children [i]->set_index (i);
-  }
+  sort_cell_tree_items (m_children, m_sorting);
 }
 
 db::cell_index_type
@@ -253,6 +287,16 @@ CellTreeItem::by_area_equal_than (const CellTreeItem *b) const
   return mp_layout->cell (cell_or_pcell_index ()).bbox ().area () == b->mp_layout->cell (b->cell_or_pcell_index ()).bbox ().area ();
 }
 
+db::Box::area_type
+CellTreeItem::area () const
+{
+  if (m_is_pcell || ! mp_layout->is_valid_cell_index (cell_or_pcell_index ())) {
+    return 0;
+  } else {
+    return mp_layout->cell (cell_or_pcell_index ()).bbox ().area ();
+  }
+}
+
 // --------------------------------------------------------------------
 //  CellTreeModel implementation
 //  Hint: it may happen that the cell tree model gets engaged while the layout is not
@@ -265,16 +309,17 @@ CellTreeModel::CellTreeModel (QWidget *parent, lay::LayoutView *view, int cv_ind
     m_sorting (sorting),
     mp_parent (parent), 
     mp_view (view), 
+    mp_layout (0),
     m_cv_index (cv_index),
     mp_base (base)
 {
   mp_view->cell_visibility_changed_event.add (this, &CellTreeModel::signal_data_changed);
-  mp_view->cellview_changed_event.add (this, &CellTreeModel::signal_data_changed_with_int);
+  mp_view->cellview_changed_event.add (this, &CellTreeModel::cellview_changed);
 
   m_flat = ((flags & Flat) != 0) && ((flags & TopCells) == 0);
   m_pad = ((flags & NoPadding) == 0);
 
-  mp_layout = & view->cellview (cv_index)->layout ();
+  attach_layout (& view->cellview (cv_index)->layout ());
   mp_library = 0;
   tl_assert (! mp_layout->under_construction () && ! (mp_layout->manager () && mp_layout->manager ()->transacting ()));
 
@@ -289,13 +334,14 @@ CellTreeModel::CellTreeModel (QWidget *parent, db::Layout *layout, unsigned int
     m_sorting (sorting),
     mp_parent (parent), 
     mp_view (0), 
+    mp_layout (0),
     m_cv_index (-1),
     mp_base (base)
 {
   m_flat = ((flags & Flat) != 0) && ((flags & TopCells) == 0);
   m_pad = ((flags & NoPadding) == 0);
 
-  mp_layout = layout;
+  attach_layout (layout);
   mp_library = 0;
   tl_assert (! mp_layout->under_construction () && ! (mp_layout->manager () && mp_layout->manager ()->transacting ()));
 
@@ -310,13 +356,14 @@ CellTreeModel::CellTreeModel (QWidget *parent, db::Library *library, unsigned in
     m_sorting (sorting),
     mp_parent (parent),
     mp_view (0),
+    mp_layout (0),
     m_cv_index (-1),
     mp_base (base)
 {
   m_flat = ((flags & Flat) != 0) && ((flags & TopCells) == 0);
   m_pad = ((flags & NoPadding) == 0);
 
-  mp_layout = &library->layout ();
+  attach_layout (&library->layout ());
   mp_library = library;
   tl_assert (! mp_layout->under_construction () && ! (mp_layout->manager () && mp_layout->manager ()->transacting ()));
 
@@ -369,14 +416,14 @@ CellTreeModel::do_configure (db::Layout *layout, db::Library *library, lay::Layo
 
     if (mp_view) {
       mp_view->cell_visibility_changed_event.remove (this, &CellTreeModel::signal_data_changed);
-      mp_view->cellview_changed_event.remove (this, &CellTreeModel::signal_data_changed_with_int);
+      mp_view->cellview_changed_event.remove (this, &CellTreeModel::cellview_changed);
     }
 
     mp_view = view;
 
     if (mp_view) {
       mp_view->cell_visibility_changed_event.add (this, &CellTreeModel::signal_data_changed);
-      mp_view->cellview_changed_event.add (this, &CellTreeModel::signal_data_changed_with_int);
+      mp_view->cellview_changed_event.add (this, &CellTreeModel::cellview_changed);
     }
 
   }
@@ -391,7 +438,7 @@ CellTreeModel::do_configure (db::Layout *layout, db::Library *library, lay::Layo
   m_flat = flat;
   m_pad = ((flags & NoPadding) == 0);
 
-  mp_layout = layout;
+  attach_layout (layout);
   mp_library = library;
   tl_assert (! mp_layout->under_construction () && ! (mp_layout->manager () && mp_layout->manager ()->transacting ()));
 
@@ -488,6 +535,43 @@ CellTreeModel::signal_data_changed ()
   emit layoutChanged ();
 }
 
+void
+CellTreeModel::cellview_changed (int)
+{
+  m_name_index.invalidate ();
+  signal_data_changed ();
+}
+
+void
+CellTreeModel::invalidate_name_index ()
+{
+  m_name_index.invalidate ();
+}
+
+void
+CellTreeModel::attach_layout (db::Layout *layout)
+{
+  mp_layout = layout;
+
+  //  NOTE: the observed layout is held by a weak pointer as the layout may be gone already
+  if (m_observed_layout.get () == layout) {
+    return;
+  }
+
+  if (m_observed_layout.get ()) {
+    m_observed_layout->hier_changed_event.remove (this, &CellTreeModel::invalidate_name_index);
+    m_observed_layout->cell_name_changed_event.remove (this, &CellTreeModel::invalidate_name_index);
+  }
+
+  m_observed_layout.reset (layout);
+  m_name_index.invalidate ();
+
+  if (layout) {
+    layout->hier_changed_event.add (this, &CellTreeModel::invalidate_name_index);
+    layout->cell_name_changed_event.add (this, &CellTreeModel::invalidate_name_index);
+  }
+}
+
 void 
 CellTreeModel::clear_top_level ()
 {
@@ -578,11 +662,7 @@ CellTreeModel::build_top_level ()
 
   }
 
-  std::sort (m_toplevel.begin (), m_toplevel.end (), cmp_cell_tree_items_f (m_sorting));
-
-  for (size_t i = 0; i < m_toplevel.size (); ++i) {
-    m_toplevel [i]->set_index (i);
-  }
+  sort_cell_tree_items (m_toplevel, m_sorting);
 }
 
 Qt::ItemFlags 
@@ -926,7 +1006,7 @@ CellTreeModel::clear_locate ()
   m_current_index = m_selected_indexes.begin ();
   m_selected_indexes_set.clear ();
 
-  signal_data_changed ();
+  emit layoutChanged ();
 }
 
 QModelIndex 
@@ -966,17 +1046,30 @@ CellTreeModel::locate_prev ()
 }
 
 void
-CellTreeModel::search_children (const tl::GlobPattern &pattern, CellTreeItem *item)
+CellTreeModel::search_children (const std::vector<bool> &matching, const std::vector<bool> &leads_to_match, const tl::GlobPattern &pattern, CellTreeItem *item)
 {
   int children = item->children ();
   for (int i = 0; i < children; ++i) {
+
     CellTreeItem *c = item->child (i);
-    if (c) {
+    if (! c) {
+      continue;
+    }
+
+    if (c->is_pcell ()) {
       if (c->name_matches (pattern)) {
         m_selected_indexes.push_back (model_index (c));
       }
-      search_children (pattern, c);
+      search_children (matching, leads_to_match, pattern, c);
+    } else if (c->cell_or_pcell_index () < leads_to_match.size () && leads_to_match [c->cell_or_pcell_index ()]) {
+      //  only descend into subtrees which contain a match - this avoids expanding the
+      //  whole tree which can be huge for deep hierarchies
+      if (matching [c->cell_or_pcell_index ()]) {
+        m_selected_indexes.push_back (model_index (c));
+      }
+      search_children (matching, leads_to_match, pattern, c);
     }
+
   }
 }
 
@@ -994,19 +1087,55 @@ CellTreeModel::locate (const char *name, bool glob_pattern, bool case_sensitive,
   p.set_exact (!glob_pattern);
   p.set_header_match (true);
 
+  //  look up the matching cells in the name index and derive the set of cells which
+  //  have a matching cell somewhere below them (bottom-up)
+
+  //  NOTE: the hierarchy change event is only issued once until the layout is updated, hence
+  //  the index is not trusted while the hierarchy is dirty
+  if (! m_name_index.is_valid () || mp_layout->hier_dirty ()) {
+    m_name_index.build (*mp_layout);
+  }
+
+  std::vector<db::cell_index_type> found;
+  m_name_index.find (p, found);
+
+  std::vector<bool> matching (mp_layout->cells (), false);
+  for (std::vector<db::cell_index_type>::const_iterator ci = found.begin (); ci != found.end (); ++ci) {
+    if (*ci < matching.size () && mp_layout->is_valid_cell_index (*ci)) {
+      matching [*ci] = true;
+    }
+  }
+
+  std::vector<bool> leads_to_match;
+  if (! top_only) {
+    leads_to_match = matching;
+    for (db::Layout::bottom_up_const_iterator c = mp_layout->begin_bottom_up (); c != mp_layout->end_bottom_up (); ++c) {
+      if (*c < leads_to_match.size () && ! leads_to_match [*c]) {
+        const db::Cell &cell = mp_layout->cell (*c);
+        for (db::Cell::child_cell_iterator cc = cell.begin_child_cells (); ! cc.at_end (); ++cc) {
+          if (*cc < leads_to_match.size () && leads_to_match [*cc]) {
+            leads_to_match [*c] = true;
+            break;
+          }
+        }
+      }
+    }
+  }
+
   for (std::vector <CellTreeItem *>::const_iterator lc = m_toplevel.begin (); lc != m_toplevel.end (); ++lc) {
-    if ((*lc)->name_matches (p)) {
+    if ((*lc)->is_pcell () ? (*lc)->name_matches (p) : ((*lc)->cell_or_pcell_index () < matching.size () && matching [(*lc)->cell_or_pcell_index ()])) {
       m_selected_indexes.push_back (model_index (*lc));
     }
     if (! top_only) {
-      search_children (p, *lc);
+      search_children (matching, leads_to_match, p, *lc);
     }
   }
 
   m_selected_indexes_set.clear ();
   m_selected_indexes_set.insert (m_selected_indexes.begin (), m_selected_indexes.end ());
-  
-  signal_data_changed ();
+
+  //  only the highlighting changes - the name index stays valid
+  emit layoutChanged ();
 
   m_current_index = m_selected_indexes.begin ();
   if (m_current_index == m_selected_indexes.end ()) {
@@ -26,6 +26,8 @@
 
 #include <vector>
 
+#include "laybasicCommon.h"
+#include "layCellNameIndex.h"
 #include "dbLayout.h"
 
 #include <QAbstractItemModel>
@@ -55,7 +57,7 @@ class CellTreeItem;
  *  representation or a hierarchical one.
  */
 
-class CellTreeModel 
+class LAYBASIC_PUBLIC CellTreeModel 
   : public QAbstractItemModel,
     public tl::Object
 {
@@ -237,6 +239,14 @@ public:
     signal_data_changed ();
   }
 
+  /**
+   *  @brief Invalidates the cell name index used by "locate"
+   *
+   *  The index is invalidated automatically if cells are added, deleted or
+   *  renamed in the layout or if the cellview changes.
+   */
+  void invalidate_name_index ();
+
 private:
   bool m_flat, m_pad;
   unsigned int m_flags;
@@ -251,10 +261,14 @@ private:
   std::set <QModelIndex> m_selected_indexes_set;
   std::vector <QModelIndex> m_selected_indexes;
   std::vector <QModelIndex>::const_iterator m_current_index;
+  lay::CellNameIndex m_name_index;
+  tl::weak_ptr<db::Layout> m_observed_layout;
 
   void build_top_level ();
   void clear_top_level ();
-  void search_children (const tl::GlobPattern &pattern, CellTreeItem *item);
+  void cellview_changed (int);
+  void attach_layout (db::Layout *layout);
+  void search_children (const std::vector<bool> &matching, const std::vector<bool> &leads_to_match, const tl::GlobPattern &pattern, CellTreeItem *item);
   void do_configure (db::Layout *layout, db::Library *library, lay::LayoutView *view, int cv_index, unsigned int flags, const db::Cell *base, Sorting sorting);
 };
 
@@ -277,6 +291,7 @@ public:
   bool by_name_less_than (const CellTreeItem *b) const;
   bool by_area_less_than (const CellTreeItem *b) const;
   bool by_area_equal_than (const CellTreeItem *b) const;
+  db::Box::area_type area () const;
   bool name_less_than (const char *name) const;
   bool name_equals (const char *name) const;
   bool name_matches (const tl::GlobPattern &p) const;
@@ -311,8 +311,9 @@ LayoutHandle::save_as (const std::string &fn, tl::OutputStream::OutputStreamMode
     {
       //  The write needs to be finished before the file watcher gets the new modification time
       db::Writer writer (options);
-      tl::OutputStream stream (fn, om);
+      tl::OutputStream stream (fn, om, false, options.zlib_threads ());
       writer.write (*mp_layout, stream);
+      stream.close ();
     }
 
     if (update) {
@@ -0,0 +1,76 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "layCompiledPropertySelection.h"
+#include "dbLayout.h"
+
+namespace lay
+{
+
+CompiledPropertySelection::CompiledPropertySelection (const db::Layout &layout, unsigned int layer, const std::set<db::properties_id_type> &prop_sel, bool inverse)
+  : m_selected_cells (0), m_inverse (inverse)
+{
+  if (! prop_sel.empty ()) {
+    m_prop_ids.resize (*prop_sel.rbegin () + 1, false);
+    for (std::set<db::properties_id_type>::const_iterator p = prop_sel.begin (); p != prop_sel.end (); ++p) {
+      m_prop_ids [*p] = true;
+    }
+  }
+
+  m_cells.resize (layout.cells (), false);
+
+  if (! layout.is_valid_layer (layer)) {
+    return;
+  }
+
+  //  same optimization as in ShapeIterator: a non-inverted selection can only match shapes with properties
+  unsigned int flags = db::ShapeIterator::All;
+  if (! m_inverse) {
+    flags |= db::ShapeIterator::Properties;
+  }
+
+  //  bottom-up, so the child cells are computed before their parents
+  for (db::Layout::bottom_up_const_iterator c = layout.begin_bottom_up (); c != layout.end_bottom_up (); ++c) {
+
+    const db::Cell &cell = layout.cell (*c);
+
+    bool selected = false;
+
+    for (db::Cell::child_cell_iterator cc = cell.begin_child_cells (); ! cc.at_end () && ! selected; ++cc) {
+      selected = m_cells [*cc];
+    }
+
+    for (db::ShapeIterator s = cell.shapes (layer).begin (flags); ! s.at_end () && ! selected; ++s) {
+      selected = matches (s->prop_id ());
+    }
+
+    if (selected) {
+      m_cells [*c] = true;
+      ++m_selected_cells;
+    }
+
+  }
+}
+
+}
+
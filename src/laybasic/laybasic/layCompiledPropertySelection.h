@@ -0,0 +1,104 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#ifndef HDR_layCompiledPropertySelection
+#define HDR_layCompiledPropertySelection
+
+#include "laybasicCommon.h"
+#include "dbTypes.h"
+
+#include <vector>
+#include <set>
+
+namespace db
+{
+  class Layout;
+}
+
+namespace lay
+{
+
+/**
+ *  @brief A compiled form of a layer's property selection
+ *
+ *  The property selection of a layer (see LayerProperties::prop_sel and
+ *  LayerProperties::inverse_prop_sel) is a set of properties IDs. This object
+ *  translates this set into a bitmap indexed by properties ID and precomputes
+ *  the set of cells whose subtree contains at least one shape matching the
+ *  selection on the given layer.
+ *
+ *  The redraw code uses the cell set to skip whole subtrees which cannot
+ *  contribute to a property-filtered layer.
+ *
+ *  The object refers to the state of the layout at the time it was created. It needs
+ *  to be discarded if the layout changes.
+ */
+class LAYBASIC_PUBLIC CompiledPropertySelection
+{
+public:
+  /**
+   *  @brief Creates a compiled property selection for the given layout and layer
+   */
+  CompiledPropertySelection (const db::Layout &layout, unsigned int layer, const std::set<db::properties_id_type> &prop_sel, bool inverse);
+
+  /**
+   *  @brief Returns true, if shapes with the given properties ID are selected
+   */
+  bool matches (db::properties_id_type id) const
+  {
+    if (id < m_prop_ids.size ()) {
+      return m_prop_ids [id] != m_inverse;
+    } else {
+      return m_inverse;
+    }
+  }
+
+  /**
+   *  @brief Returns true, if the cell or any of its children have shapes matching the selection
+   *
+   *  Cells not known to this object are reported as selected.
+   */
+  bool selects_cell (db::cell_index_type ci) const
+  {
+    return ci >= m_cells.size () || m_cells [ci];
+  }
+
+  /**
+   *  @brief Gets the number of cells selected
+   */
+  size_t selected_cells () const
+  {
+    return m_selected_cells;
+  }
+
+private:
+  std::vector<bool> m_prop_ids;
+  std::vector<bool> m_cells;
+  size_t m_selected_cells;
+  bool m_inverse;
+};
+
+}
+
+#endif
+
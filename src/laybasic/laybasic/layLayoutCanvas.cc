@@ -32,6 +32,7 @@
 #include "tlTimer.h"
 #include "tlLog.h"
 #include "tlAssert.h"
+#include "tlInternational.h"
 #include "layLayoutCanvas.h"
 #include "layRedrawThread.h"
 #include "layLayoutView.h"
@@ -285,6 +286,7 @@ LayoutCanvas::LayoutCanvas (QWidget *parent, lay::LayoutView *view, const char *
     m_redraw_clearing (false),
     m_redraw_force_update (true),
     m_update_image (true),
+    m_show_redraw_statistics (false),
     m_do_update_image_dm (this, &LayoutCanvas::do_update_image),
     m_do_end_of_drawing_dm (this, &LayoutCanvas::do_end_of_drawing),
     m_image_cache_size (1)
@@ -543,6 +545,21 @@ LayoutCanvas::update_image ()
   update (); // produces a paintEvent()
 }
 
+RedrawStatistics
+LayoutCanvas::redraw_statistics () const
+{
+  return mp_redraw_thread->statistics ();
+}
+
+void
+LayoutCanvas::set_show_redraw_statistics (bool f)
+{
+  if (f != m_show_redraw_statistics) {
+    m_show_redraw_statistics = f;
+    update ();
+  }
+}
+
 void
 LayoutCanvas::free_resources ()
 {
@@ -584,7 +601,9 @@ LayoutCanvas::paintEvent (QPaintEvent *)
       }
 
       //  render the main bitmaps
+      tl::Clock image_start = tl::Clock::current ();
       to_image (m_view_ops, dither_pattern (), line_styles (), background_color (), foreground_color (), active_color (), this, *mp_image, m_viewport_l.width (), m_viewport_l.height ());
+      mp_redraw_thread->statistics ().add_image_time ((tl::Clock::current () - image_start).seconds ());
 
       if (mp_pixmap) {
         delete mp_pixmap;
@@ -685,6 +704,11 @@ LayoutCanvas::paintEvent (QPaintEvent *)
     //  erase dynamic bitmaps 
     clear_fg_bitmaps ();
 
+    if (m_show_redraw_statistics) {
+      painter.setPen (foreground_color ());
+      painter.drawText (rect ().adjusted (4, 4, -4, -4), Qt::AlignLeft | Qt::AlignTop, tl::to_qstring (mp_redraw_thread->statistics ().to_string (5)));
+    }
+
 #if QT_VERSION < 0x050000
     QApplication::syncX ();
 #endif
@@ -867,6 +891,64 @@ LayoutCanvas::image_with_options (unsigned int width, unsigned int height, int l
   return img;
 }
 
+void
+LayoutCanvas::render_pixels (tl::PixelBuffer &pixels, int linewidth, double resolution, QColor background, QColor foreground, QColor active, const db::DBox &target_box)
+{
+  if (linewidth <= 0) {
+    linewidth = 1;
+  }
+  if (resolution <= 0.0) {
+    resolution = 1.0;
+  }
+  if (background == QColor ()) {
+    background = background_color ();
+  }
+  if (foreground == QColor ()) {
+    foreground = foreground_color ();
+  }
+  if (active == QColor ()) {
+    active = active_color ();
+  }
+
+  unsigned int width = pixels.width ();
+  unsigned int height = pixels.height ();
+  if (width == 0 || height == 0) {
+    return;
+  }
+
+  if (pixels.transparent ()) {
+    pixels.fill (0);
+  } else {
+    pixels.fill (background.rgb ());
+  }
+
+  BitmapRedrawThreadCanvas rd_canvas;
+
+  //  compute the new viewport 
+  db::DBox tb (target_box);
+  if (tb.empty ()) {
+    tb = m_viewport.target_box ();
+  }
+  Viewport vp (width, height, tb);
+  vp.set_global_trans (m_viewport.global_trans ());
+
+  std::vector<lay::ViewOp> view_ops (m_view_ops); 
+  if (linewidth > 1) {
+    for (std::vector<lay::ViewOp>::iterator vo = view_ops.begin (); vo != view_ops.end (); ++vo) {
+      vo->width (std::min (31, vo->width () * linewidth));
+    }
+  }
+
+  lay::RedrawThread redraw_thread (&rd_canvas, mp_view);
+
+  //  render the layout
+  redraw_thread.start (0 /*synchroneous*/, m_layers, vp, resolution, true);
+  redraw_thread.stop (); // safety
+
+  //  paint the layout bitmaps directly into the pixel buffer
+  rd_canvas.to_image (view_ops, dither_pattern (), line_styles (), background, foreground, active, this, pixels.data (), pixels.stride (), pixels.transparent (), width, height);
+}
+
 QImage 
 LayoutCanvas::screenshot () 
 {
@@ -42,7 +42,9 @@
 #include "layLineStyles.h"
 #include "layRedrawThreadCanvas.h"
 #include "layRedrawLayerInfo.h"
+#include "layRedrawStatistics.h"
 #include "tlDeferredExecution.h"
+#include "tlPixelBuffer.h"
 
 namespace lay
 {
@@ -169,6 +171,17 @@ public:
   QImage image (unsigned int width, unsigned int height);
   QImage image_with_options (unsigned int width, unsigned int height, int linewidth, int oversampling, double resolution, QColor background, QColor foreground, QColor active_color, const db::DBox &target_box, bool monochrome);
 
+  /**
+   *  @brief Renders the layout into the given pixel buffer
+   *
+   *  The image is rendered with the dimensions of the pixel buffer. The pixel buffer
+   *  may refer to external memory, so the image is rendered directly into that memory.
+   *  This method does not involve QImage. It renders the layout and the drawings only
+   *  (no background or foreground view objects) and does not support oversampling.
+   *  See image_with_options for a description of the other parameters.
+   */
+  void render_pixels (tl::PixelBuffer &pixels, int linewidth, double resolution, QColor background, QColor foreground, QColor active_color, const db::DBox &target_box);
+
   void update_image ();
 
   virtual void paintEvent (QPaintEvent *);
@@ -337,6 +350,24 @@ public:
     return m_viewport;
   }
 
+  /**
+   *  @brief Gets a snapshot of the statistics of the current or last redraw
+   */
+  RedrawStatistics redraw_statistics () const;
+
+  /**
+   *  @brief Enables or disables the redraw statistics overlay
+   */
+  void set_show_redraw_statistics (bool f);
+
+  /**
+   *  @brief Gets a value indicating whether the redraw statistics overlay is shown
+   */
+  bool show_redraw_statistics () const
+  {
+    return m_show_redraw_statistics;
+  }
+
   /**
    *  @brief An event indicating that the viewport was changed.
    *  If the viewport (the rectangle that is shown) changes, this event is fired.
@@ -374,6 +405,7 @@ private:
   bool m_redraw_clearing;
   bool m_redraw_force_update;
   bool m_update_image;
+  bool m_show_redraw_statistics;
   std::vector<int> m_need_redraw_layer;
   std::vector<lay::RedrawLayerInfo> m_layers;
 
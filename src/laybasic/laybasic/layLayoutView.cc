@@ -2930,6 +2930,27 @@ LayoutView::get_image_with_options (unsigned int width, unsigned int height, int
   return mp_canvas->image_with_options (width, height, linewidth, oversampling, resolution, background, foreground, active, target_box, monochrome);
 }
 
+tl::PixelBuffer
+LayoutView::get_pixels_with_options (unsigned int width, unsigned int height, int linewidth, double resolution,
+                                     QColor background, QColor foreground, QColor active, const db::DBox &target_box)
+{
+  tl::PixelBuffer pixels (width, height);
+  render_pixels_with_options (pixels, linewidth, resolution, background, foreground, active, target_box);
+  return pixels;
+}
+
+void
+LayoutView::render_pixels_with_options (tl::PixelBuffer &pixels, int linewidth, double resolution,
+                                        QColor background, QColor foreground, QColor active, const db::DBox &target_box)
+{
+  tl::SelfTimer timer (tl::verbosity () >= 11, tl::to_string (QObject::tr ("Render image")));
+
+  //  Execute all deferred methods - ensure there are no pending tasks
+  tl::DeferredMethodScheduler::execute ();
+
+  mp_canvas->render_pixels (pixels, linewidth, resolution, background, foreground, active, target_box);
+}
+
 void 
 LayoutView::save_image (const std::string &fn, unsigned int width, unsigned int height)
 {
@@ -3865,6 +3886,7 @@ LayoutView::redraw ()
   for (lay::LayerPropertiesConstIterator l = begin_layers (); !l.at_end (); ++l) {
     if (! l->has_children ()) {
       layers.push_back (RedrawLayerInfo (*l));
+      layers.back ().name = l->display_string (this, true /*real*/);
     }
   }
 
@@ -5040,6 +5062,24 @@ LayoutView::show_properties_as_text (bool sp)
   }
 }
 
+void
+LayoutView::show_redraw_statistics (bool f)
+{
+  mp_canvas->set_show_redraw_statistics (f);
+}
+
+bool
+LayoutView::show_redraw_statistics () const
+{
+  return mp_canvas->show_redraw_statistics ();
+}
+
+lay::RedrawStatistics
+LayoutView::redraw_statistics () const
+{
+  return mp_canvas->redraw_statistics ();
+}
+
 void 
 LayoutView::bitmap_caching (bool l)
 {
@@ -899,6 +899,33 @@ public:
    */
   QImage get_image_with_options (unsigned int width, unsigned int height, int linewidth, int oversampling, double resolution, QColor background, QColor foreground, QColor active_color, const db::DBox &target_box, bool monochrome);
 
+  /**
+   *  @brief Get the layout rendered into a pixel buffer with the given width and height
+   *
+   *  In contrast to get_image_with_options, this method does not use QImage and
+   *  renders the layout only (no rulers, markers or other view objects). 
+   *  Oversampling is not supported.
+   *
+   *  @param width The width of the image in pixels
+   *  @param height The height of the image
+   *  @param linewidth The width of a line in pixels (usually 1) or 0 for default
+   *  @param resolution The resolution (pixel size compared to a screen pixel size) or 0 for default
+   *  @param background The background color or QColor() for default
+   *  @param foreground The foreground color or QColor() for default
+   *  @param active The active color or QColor() for default
+   *  @param target_box The box to draw or db::DBox() for default
+   */
+  tl::PixelBuffer get_pixels_with_options (unsigned int width, unsigned int height, int linewidth, double resolution, QColor background, QColor foreground, QColor active_color, const db::DBox &target_box);
+
+  /**
+   *  @brief Renders the layout into the given pixel buffer
+   *
+   *  This method is similar to get_pixels_with_options, but renders into an existing 
+   *  pixel buffer. The dimensions are taken from the pixel buffer. If the pixel
+   *  buffer refers to external memory, the image is rendered into that memory directly.
+   */
+  void render_pixels_with_options (tl::PixelBuffer &pixels, int linewidth, double resolution, QColor background, QColor foreground, QColor active_color, const db::DBox &target_box);
+
   /**
    *  @brief Hierarchy level selection setter
    */
@@ -1058,6 +1085,24 @@ public:
     return m_bitmap_caching;
   }
 
+  /**
+   *  @brief Shows or hides the redraw statistics overlay
+   */
+  void show_redraw_statistics (bool f);
+
+  /**
+   *  @brief Gets a value indicating whether the redraw statistics overlay is shown
+   */
+  bool show_redraw_statistics () const;
+
+  /**
+   *  @brief Gets a snapshot of the statistics of the current or last redraw
+   *
+   *  The statistics include per-layer timing, number of shapes drawn, instances visited
+   *  and cell bitmap cache hits.
+   */
+  lay::RedrawStatistics redraw_statistics () const;
+
   /** 
    *  @brief Lazy rendering of text objects
    */
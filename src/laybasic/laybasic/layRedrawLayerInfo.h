@@ -117,6 +117,13 @@ struct RedrawLayerInfo
    */
   bool inverse_prop_sel;
 
+  /**
+   *  @brief The display name of the layer
+   *
+   *  This name is used for the redraw statistics. It is not set by the constructor.
+   */
+  std::string name;
+
   /**
    *  @brief Returns true, if the layer needs to be drawn
    */
@@ -0,0 +1,209 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "layRedrawStatistics.h"
+#include "tlString.h"
+
+#include <algorithm>
+
+namespace lay
+{
+
+// -------------------------------------------------------------
+//  RedrawLayerStatistics implementation
+
+RedrawLayerStatistics::RedrawLayerStatistics ()
+  : task_id (0), seconds (0.0), shapes_drawn (0), instances_visited (0), cache_hits (0), cache_misses (0)
+{
+  //  .. nothing yet ..
+}
+
+void
+RedrawLayerStatistics::clear ()
+{
+  seconds = 0.0;
+  shapes_drawn = 0;
+  instances_visited = 0;
+  cache_hits = 0;
+  cache_misses = 0;
+}
+
+void
+RedrawLayerStatistics::add (const RedrawLayerStatistics &other)
+{
+  seconds += other.seconds;
+  shapes_drawn += other.shapes_drawn;
+  instances_visited += other.instances_visited;
+  cache_hits += other.cache_hits;
+  cache_misses += other.cache_misses;
+}
+
+double
+RedrawLayerStatistics::cache_hit_rate () const
+{
+  size_t n = cache_hits + cache_misses;
+  return n > 0 ? double (cache_hits) / double (n) : 0.0;
+}
+
+// -------------------------------------------------------------
+//  RedrawStatistics implementation
+
+RedrawStatistics::RedrawStatistics ()
+  : m_image_time (0.0), m_redraw_time (0.0), m_image_updates (0)
+{
+  //  .. nothing yet ..
+}
+
+RedrawStatistics::RedrawStatistics (const RedrawStatistics &other)
+  : m_image_time (0.0), m_redraw_time (0.0), m_image_updates (0)
+{
+  operator= (other);
+}
+
+RedrawStatistics &
+RedrawStatistics::operator= (const RedrawStatistics &other)
+{
+  if (this != &other) {
+
+    std::vector<RedrawLayerStatistics> tasks;
+    double image_time, redraw_time;
+    unsigned int image_updates;
+
+    {
+      tl::MutexLocker locker (&other.m_lock);
+      tasks = other.m_tasks;
+      image_time = other.m_image_time;
+      redraw_time = other.m_redraw_time;
+      image_updates = other.m_image_updates;
+    }
+
+    tl::MutexLocker locker (&m_lock);
+    m_tasks.swap (tasks);
+    m_image_time = image_time;
+    m_redraw_time = redraw_time;
+    m_image_updates = image_updates;
+
+  }
+  return *this;
+}
+
+void
+RedrawStatistics::clear ()
+{
+  tl::MutexLocker locker (&m_lock);
+  m_tasks.clear ();
+  m_image_time = 0.0;
+  m_redraw_time = 0.0;
+  m_image_updates = 0;
+}
+
+void
+RedrawStatistics::add_task (const RedrawLayerStatistics &stat)
+{
+  tl::MutexLocker locker (&m_lock);
+
+  for (std::vector<RedrawLayerStatistics>::iterator t = m_tasks.begin (); t != m_tasks.end (); ++t) {
+    if (t->task_id == stat.task_id) {
+      t->add (stat);
+      return;
+    }
+  }
+
+  m_tasks.push_back (stat);
+}
+
+void
+RedrawStatistics::add_image_time (double seconds)
+{
+  tl::MutexLocker locker (&m_lock);
+  m_image_time += seconds;
+  ++m_image_updates;
+}
+
+void
+RedrawStatistics::set_redraw_time (double seconds)
+{
+  tl::MutexLocker locker (&m_lock);
+  m_redraw_time = seconds;
+}
+
+std::vector<RedrawLayerStatistics>
+RedrawStatistics::tasks () const
+{
+  tl::MutexLocker locker (&m_lock);
+  return m_tasks;
+}
+
+RedrawLayerStatistics
+RedrawStatistics::total () const
+{
+  tl::MutexLocker locker (&m_lock);
+
+  RedrawLayerStatistics t;
+  t.task_id = -1;
+  for (std::vector<RedrawLayerStatistics>::const_iterator i = m_tasks.begin (); i != m_tasks.end (); ++i) {
+    t.add (*i);
+  }
+  return t;
+}
+
+static bool
+slower_task (const RedrawLayerStatistics &a, const RedrawLayerStatistics &b)
+{
+  return a.seconds > b.seconds;
+}
+
+std::string
+RedrawStatistics::to_string (unsigned int max_tasks) const
+{
+  RedrawStatistics snapshot (*this);
+  RedrawLayerStatistics t = snapshot.total ();
+
+  std::string res;
+  res += "redraw: " + tl::sprintf ("%.3f", snapshot.redraw_time ()) + "s";
+  res += ", image: " + tl::sprintf ("%.3f", snapshot.image_time ()) + "s (" + tl::to_string (snapshot.image_updates ()) + "x)";
+  res += "\nshapes: " + tl::to_string (t.shapes_drawn);
+  res += ", instances: " + tl::to_string (t.instances_visited);
+  res += ", cache hits: " + tl::sprintf ("%.0f", t.cache_hit_rate () * 100.0) + "%";
+
+  std::vector<RedrawLayerStatistics> tasks = snapshot.tasks ();
+  std::stable_sort (tasks.begin (), tasks.end (), &slower_task);
+  if (max_tasks > 0 && tasks.size () > size_t (max_tasks)) {
+    tasks.erase (tasks.begin () + max_tasks, tasks.end ());
+  }
+
+  for (std::vector<RedrawLayerStatistics>::const_iterator i = tasks.begin (); i != tasks.end (); ++i) {
+    res += "\n#" + tl::to_string (i->task_id);
+    if (! i->name.empty ()) {
+      res += " (" + i->name + ")";
+    }
+    res += ": " + tl::sprintf ("%.3f", i->seconds) + "s";
+    res += ", " + tl::to_string (i->shapes_drawn) + " shapes";
+    res += ", " + tl::to_string (i->instances_visited) + " instances";
+  }
+
+  return res;
+}
+
+}
+
@@ -0,0 +1,185 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#ifndef HDR_layRedrawStatistics
+#define HDR_layRedrawStatistics
+
+#include "laybasicCommon.h"
+#include "tlThreads.h"
+
+#include <vector>
+#include <string>
+#include <cstddef>
+
+namespace lay
+{
+
+/**
+ *  @brief Statistics for one redraw task (usually one layer)
+ */
+struct LAYBASIC_PUBLIC RedrawLayerStatistics
+{
+  RedrawLayerStatistics ();
+
+  /**
+   *  @brief Resets the counters (but not the task id and name)
+   */
+  void clear ();
+
+  /**
+   *  @brief Adds the counters of another object to this one
+   */
+  void add (const RedrawLayerStatistics &other);
+
+  /**
+   *  @brief Gets the hit rate of the cell bitmap cache (0..1)
+   */
+  double cache_hit_rate () const;
+
+  /**
+   *  @brief The redraw task id
+   *
+   *  For layers, this is the index of the layer in the redraw thread's layer list.
+   *  Special tasks (cell frames, decorations) have negative ids.
+   */
+  int task_id;
+
+  /**
+   *  @brief The name of the task
+   *
+   *  For layers, this is the display name of the layer.
+   */
+  std::string name;
+
+  /**
+   *  @brief The accumulated time spent in this task in seconds
+   */
+  double seconds;
+
+  /**
+   *  @brief The number of shapes sent to the renderer
+   */
+  size_t shapes_drawn;
+
+  /**
+   *  @brief The number of instances visited
+   */
+  size_t instances_visited;
+
+  /**
+   *  @brief The number of cell bitmap cache hits and misses
+   */
+  size_t cache_hits, cache_misses;
+};
+
+/**
+ *  @brief Statistics of one frame (one full redraw)
+ *
+ *  The redraw thread collects per-task statistics here. The canvas adds
+ *  the times spent in converting the bitmaps into the image. Adding
+ *  statistics is thread-safe. The object can be copied to take a snapshot.
+ */
+class LAYBASIC_PUBLIC RedrawStatistics
+{
+public:
+  RedrawStatistics ();
+  RedrawStatistics (const RedrawStatistics &other);
+  RedrawStatistics &operator= (const RedrawStatistics &other);
+
+  /**
+   *  @brief Clears the statistics (starts a new frame)
+   */
+  void clear ();
+
+  /**
+   *  @brief Adds the statistics of one task
+   *
+   *  Statistics of the same task are accumulated.
+   */
+  void add_task (const RedrawLayerStatistics &stat);
+
+  /**
+   *  @brief Adds time spent in producing the image from the bitmaps
+   */
+  void add_image_time (double seconds);
+
+  /**
+   *  @brief Sets the wall time the full redraw took
+   */
+  void set_redraw_time (double seconds);
+
+  /**
+   *  @brief Gets the per-task statistics
+   *
+   *  Since the statistics are updated by the redraw threads, this
+   *  method delivers a copy.
+   */
+  std::vector<RedrawLayerStatistics> tasks () const;
+
+  /**
+   *  @brief Gets the statistics summed over all tasks (task_id is -1)
+   */
+  RedrawLayerStatistics total () const;
+
+  /**
+   *  @brief Gets the time spent in producing the image from the bitmaps in seconds
+   */
+  double image_time () const
+  {
+    return m_image_time;
+  }
+
+  /**
+   *  @brief Gets the wall time of the redraw in seconds
+   */
+  double redraw_time () const
+  {
+    return m_redraw_time;
+  }
+
+  /**
+   *  @brief Gets the number of image conversions since the last clear
+   */
+  unsigned int image_updates () const
+  {
+    return m_image_updates;
+  }
+
+  /**
+   *  @brief Produces a short, human-readable summary
+   *
+   *  If "max_tasks" is non-zero, only the "max_tasks" slowest tasks are listed.
+   */
+  std::string to_string (unsigned int max_tasks = 0) const;
+
+private:
+  std::vector<RedrawLayerStatistics> m_tasks;
+  double m_image_time, m_redraw_time;
+  unsigned int m_image_updates;
+  mutable tl::Mutex m_lock;
+};
+
+}
+
+#endif
+
@@ -57,7 +57,8 @@ RedrawThread::RedrawThread (lay::RedrawThreadCanvas *canvas, lay::LayoutView *vi
 
 RedrawThread::~RedrawThread ()
 {
-  // .. nothing yet ..
+  stop ();
+  clear_compiled_property_selections ();
 }
 
 void RedrawThread::layout_changed ()
@@ -70,6 +71,41 @@ void RedrawThread::layout_changed ()
   stop ();
 }
 
+void RedrawThread::layout_content_changed ()
+{
+  layout_changed ();
+
+  //  the workers are stopped now, so we can safely drop the compiled selections
+  clear_compiled_property_selections ();
+}
+
+void
+RedrawThread::clear_compiled_property_selections ()
+{
+  QMutexLocker locker (&m_compiled_property_selections_lock);
+
+  for (std::map<compiled_property_selection_key, CompiledPropertySelection *>::const_iterator c = m_compiled_property_selections.begin (); c != m_compiled_property_selections.end (); ++c) {
+    delete c->second;
+  }
+  m_compiled_property_selections.clear ();
+}
+
+const CompiledPropertySelection *
+RedrawThread::compiled_property_selection (int cv_index, const db::Layout &layout, unsigned int layer, const std::set<db::properties_id_type> &prop_sel, bool inverse)
+{
+  QMutexLocker locker (&m_compiled_property_selections_lock);
+
+  compiled_property_selection_key key (std::make_pair (cv_index, layer), std::make_pair (inverse, prop_sel));
+
+  std::map<compiled_property_selection_key, CompiledPropertySelection *>::const_iterator c = m_compiled_property_selections.find (key);
+  if (c == m_compiled_property_selections.end ()) {
+    tl::SelfTimer timer (tl::verbosity () >= 41, tl::to_string (QObject::tr ("Compiling property selection")));
+    c = m_compiled_property_selections.insert (std::make_pair (key, new CompiledPropertySelection (layout, layer, prop_sel, inverse))).first;
+  }
+
+  return c->second;
+}
+
 void
 RedrawThread::task_finished (int task_id)
 {
@@ -241,21 +277,27 @@ RedrawThread::do_start (bool clear, const db::Vector *shift_vector, const std::v
       if (cv.is_valid () && ! cv->layout ().under_construction () && ! (cv->layout ().manager () && cv->layout ().manager ()->transacting ())) {
         cv->layout ().update ();
         //  attach to the layout object to receive change notifications to stop the redraw thread
-        cv->layout ().hier_changed_event.add (this, &RedrawThread::layout_changed);
-        cv->layout ().bboxes_changed_any_event.add (this, &RedrawThread::layout_changed);
+        cv->layout ().hier_changed_event.add (this, &RedrawThread::layout_content_changed);
+        cv->layout ().bboxes_changed_any_event.add (this, &RedrawThread::layout_content_changed);
+      } else {
+        //  we don't observe this layout, so we cannot rely on the compiled selections
+        clear_compiled_property_selections ();
       }
     }
     mp_view->annotation_shapes ().update ();
     //  attach to the layout object to receive change notifications to stop the redraw thread
     mp_view->annotation_shapes ().hier_changed_event.add (this, &RedrawThread::layout_changed);  //  not really required, since the shapes have no hierarchy, but for completeness ..
     mp_view->annotation_shapes ().bboxes_changed_any_event.add (this, &RedrawThread::layout_changed);
-    mp_view->cellviews_about_to_change_event.add (this, &RedrawThread::layout_changed);
-    mp_view->cellview_about_to_change_event.add (this, &RedrawThread::layout_changed_with_int);
+    mp_view->cellviews_about_to_change_event.add (this, &RedrawThread::layout_content_changed);
+    mp_view->cellview_about_to_change_event.add (this, &RedrawThread::layout_content_changed_with_int);
 
     m_initial_update = true;
 
     if (clear) {
       m_layers = *layers;
+      //  a full redraw starts a new frame
+      m_statistics.clear ();
+      m_start_clock = tl::Clock::current ();
     }
 
     m_nlayers = int (m_layers.size ());
@@ -379,6 +421,8 @@ RedrawThread::done ()
   //  stop timer if there is one 
   m_main_timer.reset (0);
 
+  m_statistics.set_redraw_time ((tl::Clock::current () - m_start_clock).seconds ());
+
   wakeup ();
 
   //  release the workers' resources
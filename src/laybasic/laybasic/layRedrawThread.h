@@ -26,6 +26,7 @@
 
 #include <vector>
 #include <set>
+#include <map>
 #include <memory>
 
 #include <QThread>
@@ -39,6 +40,8 @@
 #include "layLayoutView.h"
 #include "layRedrawThreadCanvas.h"
 #include "layRedrawLayerInfo.h"
+#include "layRedrawStatistics.h"
+#include "layCompiledPropertySelection.h"
 #include "layCanvasPlane.h"
 #include "tlTimer.h"
 #include "tlThreadedWorkers.h"
@@ -83,6 +86,25 @@ public:
 
   void task_finished (int id);
 
+  /**
+   *  @brief Gets the compiled form of a layer's property selection
+   *
+   *  The compiled selections are kept until the layouts change. This method is
+   *  thread-safe and is intended to be called from the workers.
+   */
+  const CompiledPropertySelection *compiled_property_selection (int cv_index, const db::Layout &layout, unsigned int layer, const std::set<db::properties_id_type> &prop_sel, bool inverse);
+
+  /**
+   *  @brief Gets the statistics of the current or last redraw
+   *
+   *  The statistics are cleared when a new redraw starts. The workers add to this
+   *  object while drawing, so take a copy to get a consistent snapshot.
+   */
+  RedrawStatistics &statistics ()
+  {
+    return m_statistics;
+  }
+
 protected:
   tl::Worker *create_worker ();
   void setup_worker (tl::Worker *worker);
@@ -96,11 +118,17 @@ private:
 
   void layout_changed ();
 
-  void layout_changed_with_int (int)
+  void layout_content_changed ();
+
+  void layout_content_changed_with_int (int)
   {
-    layout_changed ();
+    layout_content_changed ();
   }
 
+  void clear_compiled_property_selections ();
+
+  typedef std::pair<std::pair<int, unsigned int>, std::pair<bool, std::set<db::properties_id_type> > > compiled_property_selection_key;
+
   bool m_initial_update;
   std::vector <RedrawLayerInfo> m_layers;
   int m_nlayers;
@@ -120,10 +148,15 @@ private:
   bool m_start_recursion_sentinel;
 
   tl::Clock m_clock;
+  tl::Clock m_start_clock;
+  RedrawStatistics m_statistics;
   QMutex m_initial_wait_lock;
   QWaitCondition m_initial_wait_cond;
 
   std::auto_ptr<tl::SelfTimer> m_main_timer;
+
+  std::map<compiled_property_selection_key, CompiledPropertySelection *> m_compiled_property_selections;
+  QMutex m_compiled_property_selections_lock;
 };
 
 }
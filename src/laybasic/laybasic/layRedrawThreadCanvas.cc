@@ -184,6 +184,8 @@ shift_bitmap (const lay::Bitmap *from, lay::Bitmap *to, int dx, int dy)
     return;
   }
 
+  std::vector<uint32_t> buffer ((from->width () + 31) / 32 + 1, 0);
+
   int nn = int (to->height ()) - std::max (0, dy);
   for (int n = std::max (-dy, 0); n < nn; ++n) {
 
@@ -192,6 +194,10 @@ shift_bitmap (const lay::Bitmap *from, lay::Bitmap *to, int dx, int dy)
     }
 
     const uint32_t *sl_from = from->scanline (n);
+    if (from->is_scanline_sparse (n)) {
+      from->expand_scanline (n, &buffer.front ());
+      sl_from = &buffer.front ();
+    }
     uint32_t *sl_to = to->scanline (n + dy);
 
     if (dx < 0) {
@@ -406,5 +412,18 @@ BitmapRedrawThreadCanvas::to_image (const std::vector <lay::ViewOp> &view_ops, c
   }
 }
 
+void
+BitmapRedrawThreadCanvas::to_image (const std::vector <lay::ViewOp> &view_ops, const lay::DitherPattern &dp, const lay::LineStyles &ls, QColor background, QColor foreground, QColor active, const lay::Drawings *drawings, lay::color_t *data, unsigned int stride, bool transparent, unsigned int width, unsigned int height)
+{
+  //  convert the plane data to image data
+  bitmaps_to_image (view_ops, mp_plane_buffers, dp, ls, data, stride, width, height, true, transparent, &mutex ());
+
+  //  convert the planes of the "drawing" objects too:
+  std::vector <std::vector <lay::Bitmap *> >::const_iterator bt = mp_drawing_plane_buffers.begin ();
+  for (lay::Drawings::const_iterator d = drawings->begin (); d != drawings->end () && bt != mp_drawing_plane_buffers.end (); ++d, ++bt) {
+    bitmaps_to_image (d->get_view_ops (*this, background, foreground, active), *bt, dp, ls, data, stride, width, height, true, transparent, &mutex ());
+  }
+}
+
 }
 
@@ -324,6 +324,13 @@ public:
    */
   void to_image (const std::vector <lay::ViewOp> &view_ops, const lay::DitherPattern &dp, const lay::LineStyles &ls, QColor background, QColor foreground, QColor active, const lay::Drawings *drawings, QImage &img, unsigned int width, unsigned int height);
 
+  /**
+   *  @brief Transfer the content to a raw 32 bit pixel buffer
+   *
+   *  See lay::bitmaps_to_image for a description of the "data", "stride" and "transparent" parameters.
+   */
+  void to_image (const std::vector <lay::ViewOp> &view_ops, const lay::DitherPattern &dp, const lay::LineStyles &ls, QColor background, QColor foreground, QColor active, const lay::Drawings *drawings, lay::color_t *data, unsigned int stride, bool transparent, unsigned int width, unsigned int height);
+
   /**
    *  @brief Gets the current bitmap data as a BitmapCanvasData object
    */
@@ -68,6 +68,7 @@ RedrawThreadWorker::RedrawThreadWorker (RedrawThread *redraw_thread)
   m_xfill = false;
   mp_prop_sel = 0;
   m_inv_prop_sel = false;
+  mp_compiled_prop_sel = 0;
   m_clock = tl::Clock::current ();
 
   for (unsigned int i = 0; i < sizeof (m_planes) / sizeof (m_planes[0]); ++i) {
@@ -102,6 +103,11 @@ RedrawThreadWorker::perform_task (tl::Task *task)
 
   int task_id = redraw_thread_task->id ();
 
+  m_stat.clear ();
+  m_stat.task_id = task_id;
+  m_stat.name.clear ();
+  tl::Clock start_clock = tl::Clock::current ();
+
   if (task_id >= 0) {
 
     //  draw a layer
@@ -151,6 +157,7 @@ RedrawThreadWorker::perform_task (tl::Task *task)
     }
 
     const RedrawLayerInfo &li = mp_redraw_thread->get_layer_info (task_id);
+    m_stat.name = li.name;
 
     if (li.cellview_index >= 0) {
 
@@ -183,6 +190,11 @@ RedrawThreadWorker::perform_task (tl::Task *task)
         if (li.layer_index >= 0) {
 
           m_layer = li.layer_index;
+
+          //  use the compiled selection to skip cells without selected shapes
+          if (mp_prop_sel) {
+            mp_compiled_prop_sel = mp_redraw_thread->compiled_property_selection (m_cv_index, *mp_layout, m_layer, *mp_prop_sel, m_inv_prop_sel);
+          }
        
           if (tl::verbosity () >= 40) {
             tl::info << tl::to_string (QObject::tr ("Drawing layer: ")) << mp_layout->get_properties (m_layer).name;
@@ -227,6 +239,7 @@ RedrawThreadWorker::perform_task (tl::Task *task)
 
         mp_prop_sel = 0;
         m_inv_prop_sel = false;
+        mp_compiled_prop_sel = 0;
 
       }
 
@@ -234,6 +247,8 @@ RedrawThreadWorker::perform_task (tl::Task *task)
 
   } else if (task_id == draw_boxes_queue_entry) {
 
+    m_stat.name = "cell frames";
+
     //  draw the bounding boxes
     if (tl::verbosity () >= 40) {
       tl::info << tl::to_string (QObject::tr ("Drawing frames and guiding shapes"));
@@ -390,6 +405,8 @@ RedrawThreadWorker::perform_task (tl::Task *task)
 
   } else if (task_id == draw_custom_queue_entry) {
 
+    m_stat.name = "decorations";
+
     //  draw the decorations
     if (tl::verbosity () >= 40) {
       tl::info << tl::to_string (QObject::tr ("Drawing decorations"));
@@ -453,6 +470,9 @@ RedrawThreadWorker::perform_task (tl::Task *task)
 
   m_cell_cache.clear ();
 
+  m_stat.seconds = (tl::Clock::current () - start_clock).seconds ();
+  mp_redraw_thread->statistics ().add_task (m_stat);
+
   mp_redraw_thread->task_finished (task_id);
 }
 
@@ -527,6 +547,7 @@ RedrawThreadWorker::setup (LayoutView *view, RedrawThreadCanvas *canvas, const s
 
   mp_prop_sel = 0;
   m_inv_prop_sel = false;
+  mp_compiled_prop_sel = 0;
 
   m_hidden_cells = view->hidden_cells ();
 
@@ -1012,6 +1033,11 @@ RedrawThreadWorker::any_shapes (db::cell_index_type cell_index, unsigned int lev
     }
   }
 
+  //  no shapes matching the property selection below this cell
+  if (! cell_selected (cell_index)) {
+    return false;
+  }
+
   //  the cache contains all cells that are visited already
   RedrawThreadWorker::micro_instance_cache_t::const_iterator c = m_mi_cache.find (std::make_pair (cell_index, levels));
   if (c == m_mi_cache.end ()) {
@@ -1085,6 +1111,11 @@ RedrawThreadWorker::any_text_shapes (db::cell_index_type cell_index, unsigned in
     }
   }
 
+  //  no shapes matching the property selection below this cell
+  if (! cell_selected (cell_index)) {
+    return false;
+  }
+
   //  the cache contains all cells that are visited already
   RedrawThreadWorker::micro_instance_cache_t::const_iterator c = m_mi_text_cache.find (std::make_pair (cell_index, levels));
   if (c == m_mi_text_cache.end ()) {
@@ -1114,42 +1145,43 @@ has_zero_bit (const lay::Bitmap *bitmap, unsigned int ixmin, unsigned int iymin,
   uint32_t imin = ixmin / 32;
   uint32_t imax = ixmax / 32;
 
-  if (imin == imax) {
-
-    uint32_t m = ((unsigned int) 0xffffffff << (ixmin % 32)) & ((unsigned int) 0xffffffff >> (31 - (ixmax % 32)));
+  std::vector<uint32_t> buffer;
 
-    for (unsigned int y = iymin; y <= iymax; ++y) {
-
-      if (bitmap->is_scanline_empty (y)) {
-        return true;
-      }
-
-      if ((bitmap->scanline (y) [imin] & m) != m) {
-        return true;
-      }
+  for (unsigned int y = iymin; y <= iymax; ++y) {
 
+    if (bitmap->is_scanline_empty (y)) {
+      return true;
     }
 
-  } else {
-
-    uint32_t m1 = ((unsigned int) 0xffffffff << (ixmin % 32));
-    uint32_t m2 = ((unsigned int) 0xffffffff >> (31 - (ixmax % 32)));
+    //  sparse scanlines are expanded into a buffer as the bitmap must not be modified here
+    const uint32_t *sl = bitmap->scanline (y);
+    if (bitmap->is_scanline_sparse (y)) {
+      buffer.resize ((bitmap->width () + 31) / 32, 0);
+      bitmap->expand_scanline (y, &buffer.front ());
+      sl = &buffer.front ();
+    }
 
-    for (unsigned int y = iymin; y <= iymax; ++y) {
+    if (imin == imax) {
 
-      if (bitmap->is_scanline_empty (y)) {
+      uint32_t m = ((unsigned int) 0xffffffff << (ixmin % 32)) & ((unsigned int) 0xffffffff >> (31 - (ixmax % 32)));
+      if ((sl [imin] & m) != m) {
         return true;
       }
 
-      if ((bitmap->scanline (y) [imin] & m1) != m1) {
+    } else {
+
+      uint32_t m1 = ((unsigned int) 0xffffffff << (ixmin % 32));
+      uint32_t m2 = ((unsigned int) 0xffffffff >> (31 - (ixmax % 32)));
+
+      if ((sl [imin] & m1) != m1) {
         return true;
       }
       for (unsigned int i = imin + 1; i < imax; ++i) {
-        if (bitmap->scanline (y) [i] != 0xffffffff) {
+        if (sl [i] != 0xffffffff) {
           return true;
         }
       }
-      if ((bitmap->scanline (y) [imax] & m2) != m2) {
+      if ((sl [imax] & m2) != m2) {
         return true;
       }
 
@@ -1234,7 +1266,7 @@ RedrawThreadWorker::draw_text_layer (bool drawing_context, db::cell_index_type c
   vertex = m_planes[3 + plane_group * (planes_per_layer / 3)];
 
   //  do not draw, if there is nothing to draw
-  if (mp_layout->cells () <= ci || vp.empty () || mp_layout->cell (ci).bbox (m_layer).empty ()) {
+  if (mp_layout->cells () <= ci || vp.empty () || mp_layout->cell (ci).bbox (m_layer).empty () || ! cell_selected (ci)) {
     return;
   }
   if (cell_var_cached (ci, trans)) {
@@ -1328,6 +1360,8 @@ RedrawThreadWorker::draw_text_layer (bool drawing_context, db::cell_index_type c
 
               test_snapshot (0); 
 
+              ++m_stat.shapes_drawn;
+
               r.draw (*shape, trans, fill, frame, vertex, text);
               if (opt_bitmap) {
                 r.draw (*shape, trans, 0, 0, opt_bitmap, 0);
@@ -1406,7 +1440,7 @@ RedrawThreadWorker::draw_text_layer (bool drawing_context, db::cell_index_type c
               bool hidden = (m_cv_index < int (m_hidden_cells.size ()) && m_hidden_cells [m_cv_index].find (new_ci) != m_hidden_cells [m_cv_index].end ());
 
               db::Box cell_box = mp_layout->cell (new_ci).bbox (m_layer);
-              if (! cell_box.empty () && ! hidden) {
+              if (! cell_box.empty () && ! hidden && cell_selected (new_ci)) {
 
                 db::Vector a, b;
                 unsigned long amax = 0, bmax = 0; 
@@ -1621,6 +1655,8 @@ RedrawThreadWorker::draw_layer_wo_cache (int from_level, int to_level, db::cell_
 
           }
 
+          ++m_stat.shapes_drawn;
+
           if (simplified) {
             shape.finish_array ();
           } else {
@@ -1675,11 +1711,13 @@ RedrawThreadWorker::draw_layer_wo_cache (int from_level, int to_level, db::cell_
           const db::CellInstArray &cell_inst = inst->cell_inst ();
           ++inst;
 
+          ++m_stat.instances_visited;
+
           db::cell_index_type new_ci = cell_inst.object ().cell_index ();
           bool hidden = (m_cv_index < int (m_hidden_cells.size ()) && m_hidden_cells [m_cv_index].find (new_ci) != m_hidden_cells [m_cv_index].end ());
 
           db::Box new_cell_box = mp_layout->cell (new_ci).bbox (m_layer);
-          if (! new_cell_box.empty () && ! hidden) {
+          if (! new_cell_box.empty () && ! hidden && cell_selected (new_ci)) {
 
             db::Vector a, b;
             unsigned long amax = 0, bmax = 0; 
@@ -1725,6 +1763,10 @@ RedrawThreadWorker::draw_layer_wo_cache (int from_level, int to_level, db::cell_
                 r.draw (bbox, trans, vertex, vertex, 0, 0);
               }
 
+            } else if (anything && draw_array_replicated (from_level, to_level, cell_inst, trans, *v, level, fill, frame, vertex, text, update_snapshot)) {
+
+              //  The array has been drawn by replicating a representative member
+
             } else if (anything) {
 
               for (db::CellInstArray::iterator p = cell_inst.begin_touching (*v, bc); ! p.at_end (); ++p) {
@@ -1788,6 +1830,146 @@ private:
   lay::CanvasPlane *mp_text;
 };
 
+CellCacheInfo &
+RedrawThreadWorker::cached_cell_bitmaps (int from_level, int to_level, db::cell_index_type ci, const db::CplxTrans &trans, const std::vector<db::Box> &vv, int level,
+                                         lay::CanvasPlane *fill, lay::CanvasPlane *frame, lay::CanvasPlane *vertex, lay::CanvasPlane *text, const UpdateSnapshotCallback *update_snapshot)
+{
+  const db::Cell &cell = mp_layout->cell (ci);
+  db::Box cell_bbox = cell.bbox ();
+
+  db::CplxTrans trans_wo_disp = trans;
+  trans_wo_disp.disp (db::DVector ());
+
+  //  if we have the cell cached, use the cached bitmap
+  CellCacheKey key (to_level - level, ci, trans_wo_disp);
+  cell_cache_t::iterator cached_cell = m_cell_cache.find (key);
+  if (cached_cell == m_cell_cache.end ()) {
+
+    ++m_stat.cache_misses;
+
+    //  put the cell into the cache
+    cached_cell = m_cell_cache.insert (std::make_pair (key, CellCacheInfo ())).first;
+
+    db::DBox cell_box_trans = trans_wo_disp * cell_bbox;
+
+    //  Hint: this rounding scheme guarantees a integer-pixel shift vector at least for the first instance
+    db::DPoint d = cell_box_trans.lower_left () + trans.disp ();
+    d = db::DPoint (floor (d.x ()), floor (d.y ()));
+    cached_cell->second.offset = d - trans.disp ();
+    db::CplxTrans drawing_trans = trans_wo_disp;
+    drawing_trans.disp (db::DPoint () - cached_cell->second.offset);
+
+    int width = int (cell_box_trans.width () + 3);    //  +3 = one pixel for a one-pixel frame at both sides and one for safety
+    int height = int (cell_box_trans.height () + 3);
+
+    cached_cell->second.fill   = new lay::Bitmap (width, height, 1.0);
+    cached_cell->second.frame  = new lay::Bitmap (width, height, 1.0);
+    cached_cell->second.vertex = new lay::Bitmap (width, height, 1.0);
+    cached_cell->second.text   = new lay::Bitmap (width, height, 1.0);
+
+    //  this object is responsible for doing updates when a snapshot is taken
+    UpdateSnapshotWithCache update_cached_snapshot (update_snapshot, &trans, &cached_cell->second, fill, frame, vertex, text);
+
+    draw_layer_wo_cache (from_level, to_level, ci, drawing_trans, vv, level, cached_cell->second.fill, cached_cell->second.frame, cached_cell->second.vertex, cached_cell->second.text, &update_cached_snapshot);
+
+  } else {
+    ++m_stat.cache_hits;
+  }
+  cached_cell->second.hits++;
+
+  return cached_cell->second;
+}
+
+bool
+RedrawThreadWorker::draw_array_replicated (int from_level, int to_level, const db::CellInstArray &cell_inst, const db::CplxTrans &trans, const db::Box &vp, int level,
+                                           lay::CanvasPlane *fill, lay::CanvasPlane *frame, lay::CanvasPlane *vertex, lay::CanvasPlane *text, const UpdateSnapshotCallback *update_snapshot)
+{
+  int new_level = level + 1;
+
+  //  Replication requires the cell bitmap cache to be available for the array members. Cell variant caching
+  //  and border-only array drawing need to see every single member and abstract mode draws partial cells.
+  if (! m_bitmap_caching || dynamic_cast<lay::Bitmap *> (fill) == 0 || mp_cell_var_cache != 0 || m_draw_array_border_instances ||
+      new_level < from_level || new_level >= to_level || (new_level == 1 && m_abstract_mode_width > 0)) {
+    return false;
+  }
+
+  db::Vector a, b;
+  unsigned long amax = 0, bmax = 0;
+  if (! cell_inst.is_regular_array (a, b, amax, bmax) || amax * bmax < 2) {
+    return false;
+  }
+
+  db::cell_index_type ci = cell_inst.object ().cell_index ();
+  const db::Cell &cell = mp_layout->cell (ci);
+  db::Box bbox = cell.bbox (m_layer);
+  db::Box cell_bbox = cell.bbox ();
+
+  if (bbox.empty ()) {
+    return true;
+  }
+
+  //  The array members differ by their displacement only. Hence the size-dependent decisions 
+  //  can be taken once for the whole array.
+  db::CplxTrans rep_trans = trans * db::ICplxTrans (cell_inst.complex_trans ());
+  if (m_drop_small_cells && drop_cell (cell, rep_trans)) {
+    return true;
+  }
+
+  db::DBox dbbox = rep_trans * bbox;
+  if ((dbbox.width () < 2.5 && dbbox.height () < 1.5) || 
+      (dbbox.width () < 1.5 && dbbox.height () < 2.5)) {
+    return false;
+  }
+
+  lay::Bitmap *fill_bitmap = dynamic_cast<lay::Bitmap *> (fill);
+  lay::Bitmap *frame_bitmap = dynamic_cast<lay::Bitmap *> (frame);
+  lay::Bitmap *vertex_bitmap = dynamic_cast<lay::Bitmap *> (vertex);
+  lay::Bitmap *text_bitmap = dynamic_cast<lay::Bitmap *> (text);
+
+  //  All members fully inside the search region share the same cached bitmaps (the cache key does
+  //  not include the displacement). The representative is drawn once and then replicated by
+  //  merging the cached bitmaps with the member's pixel offset. 
+  CellCacheInfo *cached_cell = 0;
+
+  db::box_convert <db::CellInst> bc (*mp_layout, m_layer);
+  for (db::CellInstArray::iterator p = cell_inst.begin_touching (vp, bc); ! p.at_end (); ++p) {
+
+    db::ICplxTrans t (cell_inst.complex_trans (*p));
+    db::CplxTrans member_trans = trans * t;
+    db::Box new_vp = db::Box (t.inverted () * vp);
+
+    if (! cell_bbox.inside (new_vp)) {
+
+      //  members at the border of the search region are drawn the normal way
+      draw_layer (from_level, to_level, ci, member_trans, new_vp, new_level, fill, frame, vertex, text, update_snapshot);
+
+    } else {
+
+      test_snapshot (update_snapshot);
+
+      if (! cached_cell) {
+        std::vector<db::Box> vv;
+        vv.push_back (new_vp);
+        cached_cell = &cached_cell_bitmaps (from_level, to_level, ci, member_trans, vv, new_level, fill, frame, vertex, text, update_snapshot);
+      } else {
+        cached_cell->hits++;
+        ++m_stat.cache_hits;
+      }
+
+      db::Point d = db::Point (cached_cell->offset + member_trans.disp ());
+
+      copy_bitmap (cached_cell->fill,   fill_bitmap,   d.x (), d.y ());
+      copy_bitmap (cached_cell->frame,  frame_bitmap,  d.x (), d.y ());
+      copy_bitmap (cached_cell->vertex, vertex_bitmap, d.x (), d.y ());
+      copy_bitmap (cached_cell->text,   text_bitmap,   d.x (), d.y ());
+
+    }
+
+  }
+
+  return true;
+}
+
 void
 RedrawThreadWorker::draw_layer (int from_level, int to_level, db::cell_index_type ci, const db::CplxTrans &trans, const std::vector<db::Box> &vp, int level,
                                 lay::CanvasPlane *fill, lay::CanvasPlane *frame, lay::CanvasPlane *vertex, lay::CanvasPlane *text, const UpdateSnapshotCallback *update_snapshot)
@@ -1816,7 +1998,7 @@ RedrawThreadWorker::draw_layer (int from_level, int to_level, db::cell_index_typ
   db::Box cell_bbox = cell.bbox ();
 
   //  Nothing to draw
-  if (bbox.empty ()) {
+  if (bbox.empty () || ! cell_selected (ci)) {
     return;
   }
 
@@ -1878,48 +2060,14 @@ RedrawThreadWorker::draw_layer (int from_level, int to_level, db::cell_index_typ
 
       if (can_cache) {
 
-        db::CplxTrans trans_wo_disp = trans;
-        trans_wo_disp.disp (db::DVector ());
-
-        //  if we have the cell cached, use the cached bitmap
-        CellCacheKey key (to_level - level, ci, trans_wo_disp);
-        cell_cache_t::iterator cached_cell = m_cell_cache.find (key);
-        if (cached_cell == m_cell_cache.end ()) {
-
-          //  put the cell into the cache
-          cached_cell = m_cell_cache.insert (std::make_pair (key, CellCacheInfo ())).first;
-
-          db::DBox cell_box_trans = trans_wo_disp * cell_bbox;
-
-          //  Hint: this rounding scheme guarantees a integer-pixel shift vector at least for the first instance
-          db::DPoint d = cell_box_trans.lower_left () + trans.disp ();
-          d = db::DPoint (floor (d.x ()), floor (d.y ()));
-          cached_cell->second.offset = d - trans.disp ();
-          db::CplxTrans drawing_trans = trans_wo_disp;
-          drawing_trans.disp (db::DPoint () - cached_cell->second.offset);
-
-          int width = int (cell_box_trans.width () + 3);    //  +3 = one pixel for a one-pixel frame at both sides and one for safety
-          int height = int (cell_box_trans.height () + 3);
-
-          cached_cell->second.fill   = new lay::Bitmap (width, height, 1.0);
-          cached_cell->second.frame  = new lay::Bitmap (width, height, 1.0);
-          cached_cell->second.vertex = new lay::Bitmap (width, height, 1.0);
-          cached_cell->second.text   = new lay::Bitmap (width, height, 1.0);
-
-          //  this object is responsible for doing updates when a snapshot is taken
-          UpdateSnapshotWithCache update_cached_snapshot (update_snapshot, &trans, &cached_cell->second, fill, frame, vertex, text);
-
-          draw_layer_wo_cache (from_level, to_level, ci, drawing_trans, vv, level, cached_cell->second.fill, cached_cell->second.frame, cached_cell->second.vertex, cached_cell->second.text, &update_cached_snapshot);
-
-        }
-        cached_cell->second.hits++;
+        const CellCacheInfo &cached_cell = cached_cell_bitmaps (from_level, to_level, ci, trans, vv, level, fill, frame, vertex, text, update_snapshot);
 
-        db::Point t = db::Point (cached_cell->second.offset + trans.disp ());
+        db::Point t = db::Point (cached_cell.offset + trans.disp ());
 
-        copy_bitmap(cached_cell->second.fill,   dynamic_cast<lay::Bitmap *> (fill),   t.x (), t.y ());
-        copy_bitmap(cached_cell->second.frame,  dynamic_cast<lay::Bitmap *> (frame),  t.x (), t.y ());
-        copy_bitmap(cached_cell->second.vertex, dynamic_cast<lay::Bitmap *> (vertex), t.x (), t.y ());
-        copy_bitmap(cached_cell->second.text,   dynamic_cast<lay::Bitmap *> (text),   t.x (), t.y ());
+        copy_bitmap(cached_cell.fill,   dynamic_cast<lay::Bitmap *> (fill),   t.x (), t.y ());
+        copy_bitmap(cached_cell.frame,  dynamic_cast<lay::Bitmap *> (frame),  t.x (), t.y ());
+        copy_bitmap(cached_cell.vertex, dynamic_cast<lay::Bitmap *> (vertex), t.x (), t.y ());
+        copy_bitmap(cached_cell.text,   dynamic_cast<lay::Bitmap *> (text),   t.x (), t.y ());
 
       } else {
         draw_layer_wo_cache (from_level, to_level, ci, trans, vv, level, fill, frame, vertex, text, update_snapshot);
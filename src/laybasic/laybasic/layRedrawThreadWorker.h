@@ -26,6 +26,8 @@
 
 #include "dbLayout.h"
 #include "layLayoutView.h"
+#include "layRedrawStatistics.h"
+#include "layCompiledPropertySelection.h"
 #include "tlThreadedWorkers.h"
 #include "tlTimer.h"
 
@@ -178,6 +180,8 @@ private:
   void draw_layer (bool drawing_context, db::cell_index_type ci, const db::CplxTrans &trans, const std::vector <db::Box> &redraw_regions, int level);
   void draw_layer (int from_level, int to_level, db::cell_index_type ci, const db::CplxTrans &trans, const std::vector <db::Box> &redraw_regions, int level, lay::CanvasPlane *fill, lay::CanvasPlane *frame, lay::CanvasPlane *vertex, lay::CanvasPlane *text, const UpdateSnapshotCallback *update_snapshot);
   void draw_layer (int from_level, int to_level, db::cell_index_type ci, const db::CplxTrans &trans, const db::Box &redraw_box, int level, lay::CanvasPlane *fill, lay::CanvasPlane *frame, lay::CanvasPlane *vertex, lay::CanvasPlane *text, const UpdateSnapshotCallback *update_snapshot);
+  CellCacheInfo &cached_cell_bitmaps (int from_level, int to_level, db::cell_index_type ci, const db::CplxTrans &trans, const std::vector<db::Box> &vv, int level, lay::CanvasPlane *fill, lay::CanvasPlane *frame, lay::CanvasPlane *vertex, lay::CanvasPlane *text, const UpdateSnapshotCallback *update_snapshot);
+  bool draw_array_replicated (int from_level, int to_level, const db::CellInstArray &cell_inst, const db::CplxTrans &trans, const db::Box &vp, int level, lay::CanvasPlane *fill, lay::CanvasPlane *frame, lay::CanvasPlane *vertex, lay::CanvasPlane *text, const UpdateSnapshotCallback *update_snapshot);
   void draw_layer_wo_cache (int from_level, int to_level, db::cell_index_type ci, const db::CplxTrans &trans, const std::vector<db::Box> &vv, int level, lay::CanvasPlane *fill, lay::CanvasPlane *frame, lay::CanvasPlane *vertex, lay::CanvasPlane *text, const UpdateSnapshotCallback *update_snapshot);
   void draw_text_layer (bool drawing_context, db::cell_index_type ci, const db::CplxTrans &trans, const std::vector <db::Box> &redraw_regions, int level);
   void draw_text_layer (bool drawing_context, db::cell_index_type ci, const db::CplxTrans &trans, const db::Box &redraw_region, int level, lay::CanvasPlane *fill, lay::CanvasPlane *frame, lay::CanvasPlane *vertex, lay::CanvasPlane *text, Bitmap *opt_bitmap);
@@ -200,6 +204,11 @@ private:
   bool any_text_shapes (db::cell_index_type cell_index, unsigned int levels);
   bool any_cell_box (db::cell_index_type cell_index, unsigned int levels);
 
+  bool cell_selected (db::cell_index_type ci) const
+  {
+    return ! mp_compiled_prop_sel || mp_compiled_prop_sel->selects_cell (ci);
+  }
+
   RedrawThread *mp_redraw_thread;
   std::vector <db::Box> m_redraw_region;
   std::vector <lay::Drawing *> mp_drawings;
@@ -230,6 +239,7 @@ private:
   cell_cache_t m_cell_cache;
   std::set <std::pair <db::CplxTrans, db::cell_index_type>, lay::CellVariantCacheCompare> *mp_cell_var_cache;
   unsigned int m_cache_hits, m_cache_misses;
+  RedrawLayerStatistics m_stat;
   std::set <std::pair <db::DCplxTrans, int> > m_box_variants;
   std::vector <std::set <lay::LayoutView::cell_index_type> > m_hidden_cells;
   std::vector <lay::CellView> m_cellviews;
@@ -240,6 +250,7 @@ private:
   bool m_xfill;
   const std::set<db::properties_id_type> *mp_prop_sel;
   bool m_inv_prop_sel;
+  const CompiledPropertySelection *mp_compiled_prop_sel;
   db::DCplxTrans m_vp_trans;
   std::vector<std::pair<unsigned int, lay::CanvasPlane *> > m_buffers;
   unsigned int m_test_count;
@@ -87,6 +87,7 @@ SOURCES = \
   gsiDeclLayMarker.cc \
   gsiDeclLayMenu.cc \
   gsiDeclLayPlugin.cc \
+  gsiDeclLayRedrawStatistics.cc \
   gsiDeclLayStream.cc \
   layAbstractMenu.cc \
   layAnnotationShapes.cc \
@@ -101,6 +102,7 @@ SOURCES = \
   layBrowserPanel.cc \
   layBrowseShapesForm.cc \
   layCanvasPlane.cc \
+  layCellNameIndex.cc \
   layCellSelectionForm.cc \
   layCellTreeModel.cc \
   layCellView.cc \
@@ -140,6 +142,8 @@ SOURCES = \
   layPropertiesDialog.cc \
   layQtTools.cc \
   layRedrawLayerInfo.cc \
+  layRedrawStatistics.cc \
+  layCompiledPropertySelection.cc \
   layRedrawThreadCanvas.cc \
   layRedrawThread.cc \
   layRedrawThreadWorker.cc \
@@ -200,6 +204,7 @@ HEADERS = \
   layBrowserPanel.h \
   layBrowseShapesForm.h \
   layCanvasPlane.h \
+  layCellNameIndex.h \
   layCellSelectionForm.h \
   layCellTreeModel.h \
   layCellView.h \
@@ -239,6 +244,8 @@ HEADERS = \
   layProperties.h \
   layQtTools.h \
   layRedrawLayerInfo.h \
+  layRedrawStatistics.h \
+  layCompiledPropertySelection.h \
   layRedrawThreadCanvas.h \
   layRedrawThread.h \
   layRedrawThreadWorker.h \
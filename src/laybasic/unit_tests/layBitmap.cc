@@ -31,10 +31,13 @@ to_string (const lay::Bitmap &bm)
 {
   std::string r;
 
+  std::vector<uint32_t> buffer ((bm.width () + 31) / 32 + 1, 0);
+
   for (unsigned int j = bm.height (); j > 0; --j) {
+    bm.expand_scanline (j - 1, &buffer.front ());
     std::string s;
     for (unsigned int k = 0; k < bm.width (); ++k) {
-      s += (bm.scanline (j - 1)[k / 32] & (1 << (k % 32))) != 0 ? "#" : "-";
+      s += (buffer [k / 32] & (1 << (k % 32))) != 0 ? "#" : "-";
     }
     r += s;
     r += "\n";
@@ -43,6 +46,39 @@ to_string (const lay::Bitmap &bm)
   return r;
 }
 
+static std::string 
+spans_to_string (const lay::Bitmap &bm, unsigned int y)
+{
+  if (bm.is_scanline_empty (y)) {
+    return "empty";
+  } else if (! bm.is_scanline_sparse (y)) {
+    return "dense";
+  }
+
+  std::string r;
+  const lay::Bitmap::span_list &spans = bm.scanline_spans (y);
+  for (lay::Bitmap::span_list::const_iterator s = spans.begin (); s != spans.end (); ++s) {
+    if (! r.empty ()) {
+      r += ",";
+    }
+    r += "[" + tl::to_string (s->first) + "," + tl::to_string (s->second) + ")";
+  }
+  return r;
+}
+
+static std::string 
+expanded_to_string (const lay::Bitmap &bm, unsigned int y, unsigned int x1, unsigned int x2)
+{
+  std::vector<uint32_t> buffer ((bm.width () + 31) / 32, 0);
+  bm.expand_scanline (y, &buffer.front ());
+
+  std::string s;
+  for (unsigned int k = x1; k < x2; ++k) {
+    s += (buffer [k / 32] & (1 << (k % 32))) != 0 ? "#" : "-";
+  }
+  return s;
+}
+
 TEST(1) 
 {
   lay::Bitmap b1 (8, 8, 1.0);
@@ -203,3 +239,72 @@ TEST(2)
 
 }
 
+//  sparse scanlines
+TEST(3)
+{
+  lay::Bitmap b1 (512, 4, 1.0);
+  EXPECT_EQ (b1.empty (), true);
+  EXPECT_EQ (spans_to_string (b1, 1), "empty");
+
+  b1.fill (1, 10, 20);
+  EXPECT_EQ (b1.empty (), false);
+  EXPECT_EQ (spans_to_string (b1, 1), "[10,20)");
+
+  b1.fill (1, 20, 30);
+  EXPECT_EQ (spans_to_string (b1, 1), "[10,30)");
+
+  b1.fill (1, 40, 50);
+  EXPECT_EQ (spans_to_string (b1, 1), "[10,30),[40,50)");
+
+  b1.fill (1, 2, 4);
+  EXPECT_EQ (spans_to_string (b1, 1), "[2,4),[10,30),[40,50)");
+  EXPECT_EQ (expanded_to_string (b1, 1, 0, 52), "--##------####################----------##########--");
+
+  b1.fill (1, 5, 45);
+  EXPECT_EQ (spans_to_string (b1, 1), "[2,4),[5,50)");
+
+  b1.fill (1, 4, 5);
+  EXPECT_EQ (spans_to_string (b1, 1), "[2,50)");
+
+  //  too many spans: switches to dense mode
+  b1.fill (1, 60, 61);
+  b1.fill (1, 70, 71);
+  b1.fill (1, 80, 81);
+  EXPECT_EQ (spans_to_string (b1, 1), "[2,50),[60,61),[70,71),[80,81)");
+  b1.fill (1, 90, 91);
+  EXPECT_EQ (spans_to_string (b1, 1), "dense");
+  EXPECT_EQ (expanded_to_string (b1, 1, 0, 92), "--################################################----------#---------#---------#---------#-");
+
+  b1.fill (2, 506, 512);
+  EXPECT_EQ (spans_to_string (b1, 2), "[506,512)");
+  EXPECT_EQ (expanded_to_string (b1, 2, 496, 512), "----------######");
+
+  lay::Bitmap b2 (b1);
+  EXPECT_EQ (spans_to_string (b2, 1), "dense");
+  EXPECT_EQ (spans_to_string (b2, 2), "[506,512)");
+
+  //  const access does not change the representation
+  const lay::Bitmap &b2c = b2;
+  EXPECT_EQ (b2c.scanline (2) == b2c.empty_scanline (), true);
+  EXPECT_EQ (spans_to_string (b2, 2), "[506,512)");
+
+  //  non-const access converts into dense mode
+  b2.scanline (2);
+  EXPECT_EQ (spans_to_string (b2, 2), "dense");
+  EXPECT_EQ (expanded_to_string (b2, 2, 496, 512), "----------######");
+
+  //  merge keeps sparse scanlines sparse
+  lay::Bitmap b3 (512, 4, 1.0);
+  b3.merge (&b1, 3, 1);
+  EXPECT_EQ (spans_to_string (b3, 1), "empty");
+  EXPECT_EQ (spans_to_string (b3, 2), "dense");
+  EXPECT_EQ (spans_to_string (b3, 3), "[509,512)");
+
+  b3.clear ();
+  EXPECT_EQ (b3.empty (), true);
+  EXPECT_EQ (spans_to_string (b3, 3), "empty");
+
+  b3.merge (&b1, -10, 0);
+  EXPECT_EQ (spans_to_string (b3, 2), "[496,502)");
+  EXPECT_EQ (expanded_to_string (b3, 1, 0, 92), "########################################----------#---------#---------#---------#-----------");
+}
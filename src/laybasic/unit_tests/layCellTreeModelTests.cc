@@ -0,0 +1,159 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "layCellTreeModel.h"
+#include "layCellNameIndex.h"
+#include "dbLayout.h"
+#include "tlGlobPattern.h"
+#include "tlUnitTest.h"
+
+static void
+make_layout (db::Layout &layout)
+{
+  db::cell_index_type top = layout.add_cell ("TOP");
+  db::cell_index_type a = layout.add_cell ("ALPHA");
+  db::cell_index_type a2 = layout.add_cell ("alpha2");
+  db::cell_index_type b = layout.add_cell ("Beta");
+  db::cell_index_type g = layout.add_cell ("GAMMA_X");
+
+  layout.cell (top).insert (db::CellInstArray (db::CellInst (a), db::Trans ()));
+  layout.cell (top).insert (db::CellInstArray (db::CellInst (a2), db::Trans ()));
+  layout.cell (a).insert (db::CellInstArray (db::CellInst (b), db::Trans ()));
+  layout.cell (b).insert (db::CellInstArray (db::CellInst (g), db::Trans ()));
+}
+
+static std::string
+find (const lay::CellNameIndex &index, const db::Layout &layout, const std::string &pattern, bool exact, bool case_sensitive)
+{
+  tl::GlobPattern p (pattern);
+  p.set_exact (exact);
+  p.set_case_sensitive (case_sensitive);
+  p.set_header_match (true);
+
+  std::vector<db::cell_index_type> cells;
+  index.find (p, cells);
+
+  std::string r;
+  for (std::vector<db::cell_index_type>::const_iterator c = cells.begin (); c != cells.end (); ++c) {
+    if (! r.empty ()) {
+      r += ",";
+    }
+    r += layout.cell_name (*c);
+  }
+  return r;
+}
+
+static std::string
+prefix (const std::string &pattern, bool exact)
+{
+  tl::GlobPattern p (pattern);
+  p.set_exact (exact);
+  return lay::CellNameIndex::literal_prefix (p);
+}
+
+TEST(1_NameIndexPrefix)
+{
+  EXPECT_EQ (prefix ("AB*C", false), "AB");
+  EXPECT_EQ (prefix ("AB?C", false), "AB");
+  EXPECT_EQ (prefix ("AB[CD]", false), "AB");
+  EXPECT_EQ (prefix ("AB{C,D}", false), "AB");
+  EXPECT_EQ (prefix ("A\\*B*", false), "A*B");
+  EXPECT_EQ (prefix ("*AB", false), "");
+  EXPECT_EQ (prefix ("AB*C", true), "AB*C");
+}
+
+TEST(2_NameIndexFind)
+{
+  db::Layout layout;
+  make_layout (layout);
+
+  lay::CellNameIndex index;
+  EXPECT_EQ (index.is_valid (), false);
+
+  index.build (layout);
+  EXPECT_EQ (index.is_valid (), true);
+
+  EXPECT_EQ (find (index, layout, "ALPHA", true, true), "ALPHA");
+  EXPECT_EQ (find (index, layout, "AL", true, true), "ALPHA");
+  EXPECT_EQ (find (index, layout, "AL", true, false), "ALPHA,alpha2");
+  EXPECT_EQ (find (index, layout, "al*2", false, false), "alpha2");
+  EXPECT_EQ (find (index, layout, "*A", false, true), "ALPHA,GAMMA_X");
+  EXPECT_EQ (find (index, layout, "*_x", false, false), "GAMMA_X");
+  EXPECT_EQ (find (index, layout, "*_x", false, true), "");
+  EXPECT_EQ (find (index, layout, "{Beta,TOP}", false, true), "TOP,Beta");
+  EXPECT_EQ (find (index, layout, "X", true, true), "");
+
+  index.invalidate ();
+  EXPECT_EQ (index.is_valid (), false);
+  EXPECT_EQ (find (index, layout, "ALPHA", true, true), "");
+}
+
+TEST(3_CellTreeModelLocate)
+{
+  db::Layout layout;
+  make_layout (layout);
+  layout.update ();
+
+  std::auto_ptr<lay::CellTreeModel> model (new lay::CellTreeModel (0, &layout));
+
+  //  top level only
+  QModelIndex i = model->locate ("Beta", false, true, true);
+  EXPECT_EQ (i.isValid (), false);
+
+  //  hierarchical search
+  i = model->locate ("Beta", false, true, false);
+  EXPECT_EQ (i.isValid (), true);
+  EXPECT_EQ (std::string (model->cell_name (i)), "Beta");
+
+  i = model->locate ("GAMMA", false, true, false);
+  EXPECT_EQ (i.isValid (), true);
+  EXPECT_EQ (std::string (model->cell_name (i)), "GAMMA_X");
+  EXPECT_EQ (std::string (model->cell_name (model->parent (i))), "Beta");
+
+  i = model->locate ("al*", true, false, false);
+  EXPECT_EQ (i.isValid (), true);
+  EXPECT_EQ (std::string (model->cell_name (i)), "ALPHA");
+  i = model->locate_next ();
+  EXPECT_EQ (std::string (model->cell_name (i)), "alpha2");
+  i = model->locate_next ();
+  EXPECT_EQ (std::string (model->cell_name (i)), "ALPHA");
+
+  //  renaming a cell invalidates the name index
+  layout.rename_cell (layout.cell_by_name ("Beta").second, "DELTA");
+
+  i = model->locate ("Beta", false, true, false);
+  EXPECT_EQ (i.isValid (), false);
+  i = model->locate ("DELTA", false, true, false);
+  EXPECT_EQ (i.isValid (), true);
+  EXPECT_EQ (std::string (model->cell_name (i)), "DELTA");
+
+  //  so does adding a cell
+  db::cell_index_type e = layout.add_cell ("EPSILON");
+  layout.cell (layout.cell_by_name ("ALPHA").second).insert (db::CellInstArray (db::CellInst (e), db::Trans ()));
+  layout.update ();
+  model->configure (&layout);
+
+  i = model->locate ("EPS", false, true, false);
+  EXPECT_EQ (i.isValid (), true);
+  EXPECT_EQ (std::string (model->cell_name (i)), "EPSILON");
+}
@@ -0,0 +1,91 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "layCompiledPropertySelection.h"
+#include "dbLayout.h"
+#include "dbCell.h"
+#include "tlUnitTest.h"
+
+TEST(1)
+{
+  db::Layout layout;
+  unsigned int l1 = layout.insert_layer (db::LayerProperties (1, 0));
+  unsigned int l2 = layout.insert_layer (db::LayerProperties (2, 0));
+
+  db::PropertiesRepository::properties_set ps1;
+  ps1.insert (std::make_pair (layout.properties_repository ().prop_name_id (tl::Variant (1)), tl::Variant ("A")));
+  db::properties_id_type pid1 = layout.properties_repository ().properties_id (ps1);
+
+  db::PropertiesRepository::properties_set ps2;
+  ps2.insert (std::make_pair (layout.properties_repository ().prop_name_id (tl::Variant (1)), tl::Variant ("B")));
+  db::properties_id_type pid2 = layout.properties_repository ().properties_id (ps2);
+
+  db::Cell &top = layout.cell (layout.add_cell ("TOP"));
+  db::Cell &a = layout.cell (layout.add_cell ("A"));
+  db::Cell &b = layout.cell (layout.add_cell ("B"));
+  db::Cell &c = layout.cell (layout.add_cell ("C"));
+
+  a.shapes (l1).insert (db::BoxWithProperties (db::Box (0, 0, 100, 100), pid1));
+  b.shapes (l1).insert (db::Box (0, 0, 100, 100));
+  c.shapes (l1).insert (db::BoxWithProperties (db::Box (0, 0, 100, 100), pid2));
+  c.shapes (l2).insert (db::BoxWithProperties (db::Box (0, 0, 100, 100), pid1));
+
+  top.insert (db::CellInstArray (db::CellInst (a.cell_index ()), db::Trans ()));
+  top.insert (db::CellInstArray (db::CellInst (b.cell_index ()), db::Trans ()));
+
+  layout.update ();
+
+  std::set<db::properties_id_type> sel;
+  sel.insert (pid1);
+
+  lay::CompiledPropertySelection cps (layout, l1, sel, false);
+  EXPECT_EQ (cps.matches (0), false);
+  EXPECT_EQ (cps.matches (pid1), true);
+  EXPECT_EQ (cps.matches (pid2), false);
+  EXPECT_EQ (cps.matches (pid2 + 100), false);
+  EXPECT_EQ (cps.selects_cell (top.cell_index ()), true);
+  EXPECT_EQ (cps.selects_cell (a.cell_index ()), true);
+  EXPECT_EQ (cps.selects_cell (b.cell_index ()), false);
+  EXPECT_EQ (cps.selects_cell (c.cell_index ()), false);
+  EXPECT_EQ (cps.selected_cells (), size_t (2));
+
+  //  unknown cells are selected
+  EXPECT_EQ (cps.selects_cell (layout.cells () + 1), true);
+
+  lay::CompiledPropertySelection cpsi (layout, l1, sel, true);
+  EXPECT_EQ (cpsi.matches (0), true);
+  EXPECT_EQ (cpsi.matches (pid1), false);
+  EXPECT_EQ (cpsi.matches (pid2), true);
+  EXPECT_EQ (cpsi.matches (pid2 + 100), true);
+  EXPECT_EQ (cpsi.selects_cell (top.cell_index ()), true);
+  EXPECT_EQ (cpsi.selects_cell (a.cell_index ()), false);
+  EXPECT_EQ (cpsi.selects_cell (b.cell_index ()), true);
+  EXPECT_EQ (cpsi.selects_cell (c.cell_index ()), true);
+  EXPECT_EQ (cpsi.selected_cells (), size_t (3));
+
+  lay::CompiledPropertySelection cps2 (layout, l2, sel, false);
+  EXPECT_EQ (cps2.selects_cell (top.cell_index ()), false);
+  EXPECT_EQ (cps2.selects_cell (a.cell_index ()), false);
+  EXPECT_EQ (cps2.selects_cell (c.cell_index ()), true);
+  EXPECT_EQ (cps2.selected_cells (), size_t (1));
+}
@@ -0,0 +1,87 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "layRedrawStatistics.h"
+#include "tlUnitTest.h"
+
+TEST(1)
+{
+  lay::RedrawStatistics stat;
+  EXPECT_EQ (stat.tasks ().size (), size_t (0));
+  EXPECT_EQ (stat.total ().shapes_drawn, size_t (0));
+  EXPECT_EQ (stat.total ().cache_hit_rate (), 0.0);
+
+  lay::RedrawLayerStatistics ls;
+  ls.task_id = 1;
+  ls.seconds = 0.5;
+  ls.shapes_drawn = 10;
+  ls.instances_visited = 2;
+  ls.cache_hits = 3;
+  ls.cache_misses = 1;
+  stat.add_task (ls);
+
+  ls.task_id = 2;
+  ls.name = "2/0";
+  ls.seconds = 1.0;
+  ls.cache_hits = 0;
+  ls.cache_misses = 0;
+  stat.add_task (ls);
+
+  //  same task again: accumulates
+  ls.task_id = 1;
+  ls.name = std::string ();
+  ls.seconds = 0.25;
+  stat.add_task (ls);
+
+  EXPECT_EQ (stat.tasks ().size (), size_t (2));
+  EXPECT_EQ (stat.tasks () [0].task_id, 1);
+  EXPECT_EQ (stat.tasks () [0].seconds, 0.75);
+  EXPECT_EQ (stat.tasks () [0].shapes_drawn, size_t (20));
+  EXPECT_EQ (stat.tasks () [0].cache_hits, size_t (3));
+  EXPECT_EQ (stat.tasks () [1].name, "2/0");
+
+  lay::RedrawLayerStatistics t = stat.total ();
+  EXPECT_EQ (t.task_id, -1);
+  EXPECT_EQ (t.shapes_drawn, size_t (30));
+  EXPECT_EQ (t.instances_visited, size_t (6));
+  EXPECT_EQ (t.cache_hit_rate (), 0.75);
+
+  stat.add_image_time (0.125);
+  stat.add_image_time (0.125);
+  stat.set_redraw_time (2.0);
+  EXPECT_EQ (stat.image_time (), 0.25);
+  EXPECT_EQ (stat.image_updates (), (unsigned int) 2);
+
+  EXPECT_EQ (stat.to_string (1),
+    "redraw: 2.000s, image: 0.250s (2x)\n"
+    "shapes: 30, instances: 6, cache hits: 75%\n"
+    "#2 (2/0): 1.000s, 10 shapes, 2 instances"
+  );
+
+  lay::RedrawStatistics copy (stat);
+  stat.clear ();
+  EXPECT_EQ (stat.tasks ().size (), size_t (0));
+  EXPECT_EQ (stat.redraw_time (), 0.0);
+  EXPECT_EQ (copy.tasks ().size (), size_t (2));
+  EXPECT_EQ (copy.redraw_time (), 2.0);
+}
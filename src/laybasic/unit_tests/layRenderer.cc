@@ -32,10 +32,13 @@ to_string (const lay::Bitmap &bm)
 {
   std::string r;
 
+  std::vector<uint32_t> buffer ((bm.width () + 31) / 32 + 1, 0);
+
   for (unsigned int j = bm.height (); j > 0; --j) {
+    bm.expand_scanline (j - 1, &buffer.front ());
     std::string s;
     for (unsigned int k = 0; k < bm.width (); ++k) {
-      const char *t = (bm.scanline (j - 1)[k / 32] & (1 << (k % 32))) != 0 ? "#" : "-";
+      const char *t = (buffer [k / 32] & (1 << (k % 32))) != 0 ? "#" : "-";
       s += t;
     }
     r += s;
@@ -50,11 +53,16 @@ to_string (const lay::Bitmap &bm, const lay::Bitmap &bf)
 {
   std::string r;
 
+  std::vector<uint32_t> bm_buffer ((bm.width () + 31) / 32 + 1, 0);
+  std::vector<uint32_t> bf_buffer ((bf.width () + 31) / 32 + 1, 0);
+
   for (unsigned int j = bm.height (); j > 0; --j) {
+    bm.expand_scanline (j - 1, &bm_buffer.front ());
+    bf.expand_scanline (j - 1, &bf_buffer.front ());
     std::string s;
     for (unsigned int k = 0; k < bm.width (); ++k) {
-      const char *t = (bm.scanline (j - 1)[k / 32] & (1 << (k % 32))) != 0 ? "#" : "-";
-      if ((bf.scanline (j - 1)[k / 32] & (1 << (k % 32))) != 0) {
+      const char *t = (bm_buffer [k / 32] & (1 << (k % 32))) != 0 ? "#" : "-";
+      if ((bf_buffer [k / 32] & (1 << (k % 32))) != 0) {
         t = "*";
       }
       s += t;
@@ -10,8 +10,11 @@ SOURCES = \
   layAnnotationShapes.cc \
   layBitmap.cc \
   layBitmapsToImage.cc \
+  layCellTreeModelTests.cc \
   layLayerProperties.cc \
   layParsedLayerSource.cc \
+  layRedrawStatisticsTests.cc \
+  layCompiledPropertySelectionTests.cc \
   layRenderer.cc \
   laySnap.cc \
   layNetlistBrowserModelTests.cc \
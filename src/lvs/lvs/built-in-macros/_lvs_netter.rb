@@ -222,7 +222,7 @@ module LVS
       nl = _ensure_two_netlists
       lvs_data.reference = nl[1]
 
-      lvs_data.compare(self._comparer)
+      @engine._cmd(lvs_data, :compare, self._comparer)
 
     end
 
@@ -114,7 +114,8 @@ public:
       user_units (1.0),
       write_timestamps (true),
       write_cell_properties (false),
-      write_file_properties (false)
+      write_file_properties (false),
+      threads (0)
   {
     //  .. nothing yet ..
   }
@@ -183,6 +184,15 @@ public:
    */
   bool write_file_properties;
 
+  /**
+   *  @brief The number of threads used for serializing the cells
+   *
+   *  If this value is larger than 0, the cell content is serialized into memory blocks
+   *  by the given number of threads. The blocks are written in the original order,
+   *  so the output is the same as with 0 (single-threaded mode).
+   */
+  unsigned int threads;
+
   /**
    *  @brief Implementation of FormatSpecificWriterOptions
    */
@@ -38,11 +38,21 @@ namespace db
 // ------------------------------------------------------------------
 //  GDS2Writer implementation
 
-GDS2Writer::GDS2Writer ()
-  : mp_stream (0), m_progress (tl::to_string (tr ("Writing GDS2 file")), 10000)
+GDS2Writer::GDS2Writer (bool with_progress)
+  : mp_stream (0)
 {
-  m_progress.set_format (tl::to_string (tr ("%.0f MB")));
-  m_progress.set_unit (1024 * 1024);
+  if (with_progress) {
+    mp_progress.reset (new tl::AbsoluteProgress (tl::to_string (tr ("Writing GDS2 file")), 10000));
+    mp_progress->set_format (tl::to_string (tr ("%.0f MB")));
+    mp_progress->set_unit (1024 * 1024);
+  }
+}
+
+GDS2WriterBase *
+GDS2Writer::create_block_writer () const
+{
+  //  block writers are used inside worker threads and must not report progress
+  return new GDS2Writer (false);
 }
 
 void 
@@ -79,6 +89,31 @@ GDS2Writer::write_int (int32_t l)
   mp_stream->put ( (char*)(&l), sizeof (l));
 }
 
+void
+GDS2Writer::write_ints (const int32_t *l, size_t n)
+{
+  //  encodes the values in chunks rather than calling write_int for each one
+  char buffer [1024];
+
+  while (n > 0) {
+
+    size_t nchunk = std::min (n, sizeof (buffer) / 4);
+
+    char *b = buffer;
+    for (size_t i = 0; i < nchunk; ++i) {
+      uint32_t v = uint32_t (*l++);
+      *b++ = char (v >> 24);
+      *b++ = char (v >> 16);
+      *b++ = char (v >> 8);
+      *b++ = char (v);
+    }
+
+    mp_stream->put (buffer, nchunk * 4);
+    n -= nchunk;
+
+  }
+}
+
 void 
 GDS2Writer::write_double (double d)
 {
@@ -147,7 +182,9 @@ GDS2Writer::write_string (const std::string &t)
 void 
 GDS2Writer::progress_checkpoint ()
 {
-  m_progress.set (mp_stream->pos ());
+  if (mp_progress.get ()) {
+    mp_progress->set (mp_stream->pos ());
+  }
 }
 
 } // namespace db
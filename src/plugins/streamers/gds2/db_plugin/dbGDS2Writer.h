@@ -29,6 +29,8 @@
 #include "dbWriterTools.h"
 #include "tlProgress.h"
 
+#include <memory>
+
 namespace db
 {
 
@@ -42,8 +44,10 @@ class DB_PLUGIN_PUBLIC GDS2Writer
 public:
   /**
    *  @brief Instantiate the writer
+   *
+   *  If "with_progress" is false, the writer will not report progress.
    */
-  GDS2Writer ();
+  GDS2Writer (bool with_progress = true);
 
 protected:
   /**
@@ -71,6 +75,11 @@ protected:
    */
   void write_int (int32_t l);
 
+  /**
+   *  @brief Write a number of longs
+   */
+  void write_ints (const int32_t *l, size_t n);
+
   /**
    *  @brief Write a double
    */
@@ -109,9 +118,14 @@ protected:
    */
   void progress_checkpoint ();
 
+  /**
+   *  @brief Creates a writer for the multi-threaded mode
+   */
+  GDS2WriterBase *create_block_writer () const;
+
 private:
   tl::OutputStream *mp_stream;
-  tl::AbsoluteProgress m_progress;
+  std::auto_ptr<tl::AbsoluteProgress> mp_progress;
 };
 
 } // namespace db
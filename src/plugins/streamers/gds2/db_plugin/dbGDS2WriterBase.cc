@@ -33,6 +33,11 @@
 #include "dbClip.h"
 #include "dbSaveLayoutOptions.h"
 #include "dbPolygonGenerators.h"
+#include "tlThreadedWorkers.h"
+#include "tlThreads.h"
+
+#include <deque>
+#include <memory>
 
 #include <stdio.h>
 #include <errno.h>
@@ -47,7 +52,17 @@ namespace db
 //  GDS2WriterBase implementation
 
 GDS2WriterBase::GDS2WriterBase ()
+  : mp_cell_name_map (&m_cell_name_map),
+    mp_layout (0), mp_cell_set (0),
+    m_sf (1.0), m_dbu (1.0),
+    m_keep_instances (false), m_multi_xy (false), m_no_zero_length_paths (false),
+    m_max_vertex_count (0),
+    m_write_cell_properties (false), m_stream_cell (0), m_cells_mapped (0)
 {
+  for (unsigned int i = 0; i < 6; ++i) {
+    m_time_data [i] = 0;
+  }
+
   // .. nothing yet ..
 }
 
@@ -73,19 +88,110 @@ inline int scale (double sf, int value)
 }
 
 void
-GDS2WriterBase::write (db::Layout &layout, tl::OutputStream &stream, const db::SaveLayoutOptions &options)
+GDS2WriterBase::init_settings (const db::Layout &layout, const db::SaveLayoutOptions &options, const db::GDS2WriterOptions &gds2_options)
 {
-  set_stream (stream);
-
-  double dbu = (options.dbu () == 0.0) ? layout.dbu () : options.dbu ();
-  double sf = options.scale_factor () * (layout.dbu () / dbu);
-  if (fabs (sf - 1.0) < 1e-9) {
+  m_dbu = (options.dbu () == 0.0) ? layout.dbu () : options.dbu ();
+  m_sf = options.scale_factor () * (layout.dbu () / m_dbu);
+  if (fabs (m_sf - 1.0) < 1e-9) {
     //  to avoid rounding problems, set to 1.0 exactly if possible.
-    sf = 1.0;
+    m_sf = 1.0;
+  }
+
+  mp_layout = &layout;
+  m_keep_instances = options.keep_instances ();
+  m_multi_xy = gds2_options.multi_xy_records;
+  m_no_zero_length_paths = gds2_options.no_zero_length_paths;
+  m_max_vertex_count = std::max (gds2_options.max_vertex_count, (unsigned int)4);
+
+  //  get current time
+  for (unsigned int i = 0; i < 6; ++i) {
+    m_time_data [i] = 0;
   }
+  if (gds2_options.write_timestamps) {
+    time_t ti = 0;
+    time (&ti);
+    const struct tm *t = localtime (&ti);
+    if (t) {
+      m_time_data[0] = t->tm_year + 1900;
+      m_time_data[1] = t->tm_mon + 1;
+      m_time_data[2] = t->tm_mday;
+      m_time_data[3] = t->tm_hour;
+      m_time_data[4] = t->tm_min;
+      m_time_data[5] = t->tm_sec;
+    }
+  }
+
+  size_t max_cellname_length = std::max (gds2_options.max_cellname_length, (unsigned int)8);
+
+  m_cell_name_map = db::WriterCellNameMap (max_cellname_length);
+  m_cell_name_map.replacement ('$');
+  m_cell_name_map.disallow_all ();
+  //  TODO: restrict character set, i.e allow_standard and "$"
+  m_cell_name_map.allow_all_printing ();
+}
+
+void
+GDS2WriterBase::write_header (const db::Layout &layout, const db::GDS2WriterOptions &gds2_options)
+{
+  write_record_size (6);
+  write_record (sHEADER);
+  write_short (600);
+
+  write_record_size (4 + 12 * 2);
+  write_record (sBGNLIB);
+  write_time (m_time_data);
+  write_time (m_time_data);
+
+  write_string_record (sLIBNAME, gds2_options.libname);
+
+  write_record_size (4 + 8 * 2);
+  write_record (sUNITS);
+  write_double (m_dbu / std::max (1e-9, gds2_options.user_units));
+  write_double (m_dbu * 1e-6);
+
+  //  layout properties 
+
+  if (gds2_options.write_file_properties && layout.prop_id () != 0) {
+    write_properties (layout, layout.prop_id ());
+  }
+}
+
+void
+GDS2WriterBase::write_cell_shapes (const db::Cell &cref, const std::vector <std::pair <unsigned int, db::LayerProperties> > &layers)
+{
+  const db::Layout &layout = *mp_layout;
+
+  for (std::vector <std::pair <unsigned int, db::LayerProperties> >::const_iterator l = layers.begin (); l != layers.end (); ++l) {
+
+    if (layout.is_valid_layer (l->first)) {
+
+      int layer = l->second.layer;
+      int datatype = l->second.datatype;
+
+      db::ShapeIterator shape (cref.shapes (l->first).begin (db::ShapeIterator::Boxes | db::ShapeIterator::Polygons | db::ShapeIterator::Edges | db::ShapeIterator::EdgePairs | db::ShapeIterator::Paths | db::ShapeIterator::Texts));
+      while (! shape.at_end ()) {
+        progress_checkpoint ();
+        write_shape (layer, datatype, *shape);
+        ++shape;
+      }
+
+    }
+
+  }
+}
+
+void
+GDS2WriterBase::write (db::Layout &layout, tl::OutputStream &stream, const db::SaveLayoutOptions &options)
+{
+  set_stream (stream);
 
   db::GDS2WriterOptions gds2_options = options.get_options<db::GDS2WriterOptions> ();
 
+  init_settings (layout, options, gds2_options);
+
+  const short *time_data = m_time_data;
+  double dbu = m_dbu;
+
   layout.add_meta_info (MetaInfo ("dbuu", tl::to_string (tr ("Database unit in user units")), tl::to_string (dbu / std::max (1e-9, gds2_options.user_units))));
   layout.add_meta_info (MetaInfo ("dbum", tl::to_string (tr ("Database unit in meter")), tl::to_string (dbu * 1e-6)));
   layout.add_meta_info (MetaInfo ("libname", tl::to_string (tr ("Library name")), gds2_options.libname));
@@ -106,37 +212,10 @@ GDS2WriterBase::write (db::Layout &layout, tl::OutputStream &stream, const db::S
     }
   }
 
-  //  get current time
-  short time_data [6] = { 0, 0, 0, 0, 0, 0 };
-  if (gds2_options.write_timestamps) {
-    time_t ti = 0;
-    time (&ti);
-    const struct tm *t = localtime (&ti);
-    if (t) {
-      time_data[0] = t->tm_year + 1900;
-      time_data[1] = t->tm_mon + 1;
-      time_data[2] = t->tm_mday;
-      time_data[3] = t->tm_hour;
-      time_data[4] = t->tm_min;
-      time_data[5] = t->tm_sec;
-    }
-  }
-
   std::string str_time = tl::sprintf ("%d/%d/%d %d:%02d:%02d", time_data[1], time_data[2], time_data[0], time_data[3], time_data[4], time_data[5]); 
   layout.add_meta_info (MetaInfo ("mod_time", tl::to_string (tr ("Modification Time")), str_time));
   layout.add_meta_info (MetaInfo ("access_time", tl::to_string (tr ("Access Time")), str_time));
 
-  bool multi_xy = gds2_options.multi_xy_records;
-  size_t max_cellname_length = std::max (gds2_options.max_cellname_length, (unsigned int)8);
-  size_t max_vertex_count = std::max (gds2_options.max_vertex_count, (unsigned int)4);
-  bool no_zero_length_paths = gds2_options.no_zero_length_paths;
-
-  m_cell_name_map = db::WriterCellNameMap (max_cellname_length);
-  m_cell_name_map.replacement ('$');
-  m_cell_name_map.disallow_all ();
-  //  TODO: restrict character set, i.e allow_standard and "$"
-  m_cell_name_map.allow_all_printing ();
-
   //  For keep instances we need to map all cells since all can be present as instances.
   //  We use top-down assignment to make "upper cells less modified".
   if (options.keep_instances ()) {
@@ -153,27 +232,7 @@ GDS2WriterBase::write (db::Layout &layout, tl::OutputStream &stream, const db::S
 
   //  write header
 
-  write_record_size (6);
-  write_record (sHEADER);
-  write_short (600);
-
-  write_record_size (4 + 12 * 2);
-  write_record (sBGNLIB);
-  write_time (time_data);
-  write_time (time_data);
-
-  write_string_record (sLIBNAME, gds2_options.libname);
-
-  write_record_size (4 + 8 * 2);
-  write_record (sUNITS);
-  write_double (dbu / std::max (1e-9, gds2_options.user_units));
-  write_double (dbu * 1e-6);
-
-  //  layout properties 
-
-  if (gds2_options.write_file_properties && layout.prop_id () != 0) {
-    write_properties (layout, layout.prop_id ());
-  }
+  write_header (layout, gds2_options);
 
   //  write context info
   
@@ -207,7 +266,7 @@ GDS2WriterBase::write (db::Layout &layout, tl::OutputStream &stream, const db::S
         write_record_size (4);
         write_record (sSREF);
 
-        write_string_record (sSNAME, m_cell_name_map.cell_name (*cell));
+        write_string_record (sSNAME, mp_cell_name_map->cell_name (*cell));
 
         write_record_size (12);
         write_record (sXY);
@@ -248,102 +307,465 @@ GDS2WriterBase::write (db::Layout &layout, tl::OutputStream &stream, const db::S
 
   //  body
 
-  for (std::vector<db::cell_index_type>::const_iterator cell = cells.begin (); cell != cells.end (); ++cell) {
+  mp_cell_set = &cell_set;
 
-    progress_checkpoint ();
+  std::auto_ptr<GDS2WriterBase> block_writer;
+  if (gds2_options.threads > 0) {
+    block_writer.reset (create_block_writer ());
+  }
+
+  if (block_writer.get ()) {
 
-    const db::Cell &cref (layout.cell (*cell));
+    block_writer.reset (0);
+    write_cells_parallel (cells, layers, time_data, gds2_options.write_cell_properties, gds2_options.threads, stream);
 
-    //  don't write ghost cells unless they are not empty (any more)
-    //  also don't write proxy cells which are not employed
-    if ((! cref.is_ghost_cell () || ! cref.empty ()) && (! cref.is_proxy () || ! cref.is_top ())) {
+  } else {
 
-      //  cell header 
+    for (std::vector<db::cell_index_type>::const_iterator cell = cells.begin (); cell != cells.end (); ++cell) {
 
-      write_record_size (4 + 12 * 2);
-      write_record (sBGNSTR);
-      write_time (time_data);
-      write_time (time_data);
+      progress_checkpoint ();
 
-      write_string_record (sSTRNAME, m_cell_name_map.cell_name (*cell));
+      const db::Cell &cref (layout.cell (*cell));
 
-      //  cell body 
+      //  don't write ghost cells unless they are not empty (any more)
+      //  also don't write proxy cells which are not employed
+      if ((! cref.is_ghost_cell () || ! cref.empty ()) && (! cref.is_proxy () || ! cref.is_top ())) {
+
+        write_cell_header (cref, time_data, gds2_options.write_cell_properties);
+
+        write_instances (cref);
+        write_cell_shapes (cref, layers);
+
+        //  end of cell
+
+        write_record_size (4);
+        write_record (sENDSTR);
 
-      if (gds2_options.write_cell_properties && cref.prop_id () != 0) {
-        write_properties (layout, cref.prop_id ());
       }
 
-      //  instances
-      
-      for (db::Cell::const_iterator inst = cref.begin (); ! inst.at_end (); ++inst) {
+    }
+
+  }
+
+  write_record_size (4);
+  write_record (sENDLIB);
+
+  progress_checkpoint ();
+}
+
+void
+GDS2WriterBase::begin_stream (const db::Layout &layout, tl::OutputStream &stream, const db::SaveLayoutOptions &options)
+{
+  set_stream (stream);
+
+  db::GDS2WriterOptions gds2_options = options.get_options<db::GDS2WriterOptions> ();
+
+  init_settings (layout, options, gds2_options);
+
+  //  in streaming mode, all instances are written
+  mp_cell_set = 0;
+  m_keep_instances = true;
+  m_write_cell_properties = gds2_options.write_cell_properties;
+  m_cells_mapped = 0;
+
+  write_header (layout, gds2_options);
+}
+
+void
+GDS2WriterBase::map_stream_cells ()
+{
+  //  new cells are added to the name map in the order they appear
+  for ( ; m_cells_mapped < mp_layout->cells (); ++m_cells_mapped) {
+    m_cell_name_map.insert (db::cell_index_type (m_cells_mapped), mp_layout->cell_name (db::cell_index_type (m_cells_mapped)));
+  }
+}
+
+void
+GDS2WriterBase::begin_stream_cell (db::cell_index_type cell)
+{
+  progress_checkpoint ();
+
+  map_stream_cells ();
 
-        //  write only instances to selected cells
-        if (options.keep_instances () || cell_set.find (inst->cell_index ()) != cell_set.end ()) {
+  m_stream_cell = cell;
+  write_cell_header (mp_layout->cell (cell), m_time_data, m_write_cell_properties);
+}
+
+void
+GDS2WriterBase::write_stream_cell_content (const std::vector <std::pair <unsigned int, db::LayerProperties> > &layers)
+{
+  map_stream_cells ();
+
+  const db::Cell &cref = mp_layout->cell (m_stream_cell);
+  write_instances (cref);
+  write_cell_shapes (cref, layers);
+}
+
+void
+GDS2WriterBase::end_stream_cell ()
+{
+  write_record_size (4);
+  write_record (sENDSTR);
+}
+
+void
+GDS2WriterBase::end_stream ()
+{
+  write_record_size (4);
+  write_record (sENDLIB);
+
+  progress_checkpoint ();
+}
+
+void
+GDS2WriterBase::write_cell_header (const db::Cell &cref, const short *time_data, bool write_cell_properties)
+{
+  write_record_size (4 + 12 * 2);
+  write_record (sBGNSTR);
+  write_time (time_data);
+  write_time (time_data);
+
+  write_string_record (sSTRNAME, mp_cell_name_map->cell_name (cref.cell_index ()));
+
+  if (write_cell_properties && cref.prop_id () != 0) {
+    write_properties (*mp_layout, cref.prop_id ());
+  }
+}
+
+void
+GDS2WriterBase::write_instances (const db::Cell &cref)
+{
+  for (db::Cell::const_iterator inst = cref.begin (); ! inst.at_end (); ++inst) {
+
+    //  write only instances to selected cells
+    if (m_keep_instances || mp_cell_set->find (inst->cell_index ()) != mp_cell_set->end ()) {
+
+      progress_checkpoint ();
+      write_inst (m_sf, *inst, true /*normalize*/, *mp_layout, inst->prop_id ());
+
+    }
+
+  }
+}
+
+void
+GDS2WriterBase::write_shape (int layer, int datatype, const db::Shape &shape)
+{
+  const db::Layout &layout = *mp_layout;
+  double sf = m_sf;
+
+  if (shape.is_text ()) {
+    write_text (layer, datatype, sf, m_dbu, shape, layout, shape.prop_id ());
+  } else if (shape.is_polygon ()) {
+    write_polygon (layer, datatype, sf, shape, m_multi_xy, m_max_vertex_count, layout, shape.prop_id ());
+  } else if (shape.is_edge ()) {
+    write_edge (layer, datatype, sf, shape, layout, shape.prop_id ());
+  } else if (shape.is_edge_pair ()) {
+    write_edge (layer, datatype, sf, shape.edge_pair ().first (), layout, shape.prop_id ());
+    write_edge (layer, datatype, sf, shape.edge_pair ().second (), layout, shape.prop_id ());
+  } else if (shape.is_path ()) {
+    if (m_no_zero_length_paths && (shape.path_length () - shape.path_extensions ().first - shape.path_extensions ().second) == 0) {
+      //  eliminate the zero-width path
+      db::Polygon poly;
+      shape.polygon (poly);
+      write_polygon (layer, datatype, sf, poly, m_multi_xy, m_max_vertex_count, layout, shape.prop_id (), false);
+    } else {
+      write_path (layer, datatype, sf, shape, m_multi_xy, layout, shape.prop_id ());
+    }
+  } else if (shape.is_box ()) {
+    write_box (layer, datatype, sf, shape, layout, shape.prop_id ());
+  }
+}
+
+void
+GDS2WriterBase::init_block_writer (GDS2WriterBase &writer) const
+{
+  writer.mp_cell_name_map = mp_cell_name_map;
+  writer.mp_layout = mp_layout;
+  writer.mp_cell_set = mp_cell_set;
+  writer.m_sf = m_sf;
+  writer.m_dbu = m_dbu;
+  writer.m_keep_instances = m_keep_instances;
+  writer.m_multi_xy = m_multi_xy;
+  writer.m_no_zero_length_paths = m_no_zero_length_paths;
+  writer.m_max_vertex_count = m_max_vertex_count;
+}
+
+// ------------------------------------------------------------------
+//  Multi-threaded serialization of the cells
+
+/**
+ *  @brief A piece of a cell's content
+ *
+ *  A block holds the cell header if "begin_cell" is set, the instances if "instances"
+ *  is set, the given shapes and the ENDSTR record if "end_cell" is set. The blocks are
+ *  serialized into "data" by the workers and written to the output stream in the order
+ *  they have been created.
+ */
+struct GDS2WriterBlock
+{
+  GDS2WriterBlock (const db::Cell *_cell)
+    : cell (_cell), begin_cell (false), end_cell (false), instances (false), layer (0), datatype (0), done (false)
+  { }
+
+  const db::Cell *cell;
+  bool begin_cell, end_cell, instances;
+  int layer, datatype;
+  std::vector<db::Shape> shapes;
+  std::vector<char> data;
+  std::string error;
+  bool done;
+};
+
+/**
+ *  @brief A memory stream writing into a block's data
+ */
+class GDS2WriterBlockStream
+  : public tl::OutputStreamBase
+{
+public:
+  GDS2WriterBlockStream (std::vector<char> &data)
+    : mp_data (&data)
+  { }
+
+  virtual void write (const char *b, size_t n)
+  {
+    mp_data->insert (mp_data->end (), b, b + n);
+  }
+
+private:
+  std::vector<char> *mp_data;
+};
+
+/**
+ *  @brief Synchronization between the workers and the thread writing the blocks
+ */
+struct GDS2WriterBlockSync
+{
+  tl::Mutex lock;
+  tl::WaitCondition block_done;
+};
+
+class GDS2WriterBlockTask
+  : public tl::Task
+{
+public:
+  GDS2WriterBlockTask (GDS2WriterBlock *block)
+    : mp_block (block)
+  { }
+
+  GDS2WriterBlock *block () const
+  {
+    return mp_block;
+  }
+
+private:
+  GDS2WriterBlock *mp_block;
+};
+
+class GDS2WriterBlockWorker
+  : public tl::Worker
+{
+public:
+  GDS2WriterBlockWorker (const GDS2WriterBase *master, GDS2WriterBlockSync *sync, const short *time_data, bool write_cell_properties)
+    : tl::Worker (), mp_writer (master->create_block_writer ()), mp_sync (sync), mp_time_data (time_data), m_write_cell_properties (write_cell_properties)
+  {
+    master->init_block_writer (*mp_writer);
+  }
+
+  void perform_task (tl::Task *task)
+  {
+    GDS2WriterBlock *block = static_cast<GDS2WriterBlockTask *> (task)->block ();
+
+    std::string error;
+
+    try {
+      GDS2WriterBlockStream data (block->data);
+      tl::OutputStream stream (data);
+      mp_writer->set_stream (stream);
+      mp_writer->write_block (*block, mp_time_data, m_write_cell_properties);
+      stream.flush ();
+    } catch (tl::Exception &ex) {
+      error = ex.msg ();
+    } catch (std::exception &ex) {
+      error = ex.what ();
+    } catch (...) {
+      error = tl::to_string (tr ("Unspecific error"));
+    }
+
+    tl::MutexLocker locker (&mp_sync->lock);
+    block->error = error;
+    block->done = true;
+    mp_sync->block_done.wakeAll ();
+  }
+
+private:
+  std::auto_ptr<GDS2WriterBase> mp_writer;
+  GDS2WriterBlockSync *mp_sync;
+  const short *mp_time_data;
+  bool m_write_cell_properties;
+};
+
+class GDS2WriterBlockJob
+  : public tl::JobBase
+{
+public:
+  GDS2WriterBlockJob (int nworkers, const GDS2WriterBase *master, GDS2WriterBlockSync *sync, const short *time_data, bool write_cell_properties)
+    : tl::JobBase (nworkers), mp_master (master), mp_sync (sync), mp_time_data (time_data), m_write_cell_properties (write_cell_properties)
+  { }
+
+protected:
+  virtual tl::Worker *create_worker ()
+  {
+    return new GDS2WriterBlockWorker (mp_master, mp_sync, mp_time_data, m_write_cell_properties);
+  }
+
+private:
+  const GDS2WriterBase *mp_master;
+  GDS2WriterBlockSync *mp_sync;
+  const short *mp_time_data;
+  bool m_write_cell_properties;
+};
+
+void
+GDS2WriterBase::write_block (const GDS2WriterBlock &block, const short *time_data, bool write_cell_properties)
+{
+  if (block.begin_cell) {
+    write_cell_header (*block.cell, time_data, write_cell_properties);
+  }
+
+  if (block.instances) {
+    write_instances (*block.cell);
+  }
+
+  for (std::vector<db::Shape>::const_iterator s = block.shapes.begin (); s != block.shapes.end (); ++s) {
+    write_shape (block.layer, block.datatype, *s);
+  }
+
+  if (block.end_cell) {
+    write_record_size (4);
+    write_record (sENDSTR);
+  }
+}
+
+void
+GDS2WriterBase::write_cells_parallel (const std::vector<db::cell_index_type> &cells, const std::vector <std::pair <unsigned int, db::LayerProperties> > &layers, const short *time_data, bool write_cell_properties, unsigned int threads, tl::OutputStream &stream)
+{
+  //  the number of shapes per block
+  const size_t shapes_per_block = 10000;
+  //  the maximum number of blocks in flight - this limits the memory required
+  const size_t max_blocks = threads * 4;
+
+  const db::Layout &layout = *mp_layout;
+
+  GDS2WriterBlockSync sync;
+  GDS2WriterBlockJob job (int (threads), this, &sync, time_data, write_cell_properties);
+
+  std::deque<GDS2WriterBlock *> blocks;
+
+  try {
 
-          progress_checkpoint ();
-          write_inst (sf, *inst, true /*normalize*/, layout, inst->prop_id ());
+    for (std::vector<db::cell_index_type>::const_iterator cell = cells.begin (); cell != cells.end () || ! blocks.empty (); ) {
 
+      //  produce new blocks unless there are too many already
+      if (cell != cells.end () && blocks.size () < max_blocks) {
+
+        const db::Cell &cref (layout.cell (*cell));
+        ++cell;
+
+        //  don't write ghost cells unless they are not empty (any more)
+        //  also don't write proxy cells which are not employed
+        if ((cref.is_ghost_cell () && cref.empty ()) || (cref.is_proxy () && cref.is_top ())) {
+          continue;
         }
 
-      }
+        std::vector<GDS2WriterBlock *> new_blocks;
+
+        new_blocks.push_back (new GDS2WriterBlock (&cref));
+        new_blocks.back ()->begin_cell = true;
+        new_blocks.back ()->instances = true;
 
-      //  shapes
-
-      for (std::vector <std::pair <unsigned int, db::LayerProperties> >::const_iterator l = layers.begin (); l != layers.end (); ++l) {
-   
-        if (layout.is_valid_layer (l->first)) {
-
-          int layer = l->second.layer;
-          int datatype = l->second.datatype;
-
-          db::ShapeIterator shape (cref.shapes (l->first).begin (db::ShapeIterator::Boxes | db::ShapeIterator::Polygons | db::ShapeIterator::Edges | db::ShapeIterator::EdgePairs | db::ShapeIterator::Paths | db::ShapeIterator::Texts));
-          while (! shape.at_end ()) {
-
-            progress_checkpoint ();
-
-            if (shape->is_text ()) {
-              write_text (layer, datatype, sf, dbu, *shape, layout, shape->prop_id ());
-            } else if (shape->is_polygon ()) {
-              write_polygon (layer, datatype, sf, *shape, multi_xy, max_vertex_count, layout, shape->prop_id ());
-            } else if (shape->is_edge ()) {
-              write_edge (layer, datatype, sf, *shape, layout, shape->prop_id ());
-            } else if (shape->is_edge_pair ()) {
-              write_edge (layer, datatype, sf, shape->edge_pair ().first (), layout, shape->prop_id ());
-              write_edge (layer, datatype, sf, shape->edge_pair ().second (), layout, shape->prop_id ());
-            } else if (shape->is_path ()) {
-              if (no_zero_length_paths && (shape->path_length () - shape->path_extensions ().first - shape->path_extensions ().second) == 0) {
-                //  eliminate the zero-width path
-                db::Polygon poly;
-                shape->polygon (poly);
-                write_polygon (layer, datatype, sf, poly, multi_xy, max_vertex_count, layout, shape->prop_id (), false);
-              } else {
-                write_path (layer, datatype, sf, *shape, multi_xy, layout, shape->prop_id ());
+        for (std::vector <std::pair <unsigned int, db::LayerProperties> >::const_iterator l = layers.begin (); l != layers.end (); ++l) {
+
+          if (layout.is_valid_layer (l->first)) {
+
+            GDS2WriterBlock *block = 0;
+
+            db::ShapeIterator shape (cref.shapes (l->first).begin (db::ShapeIterator::Boxes | db::ShapeIterator::Polygons | db::ShapeIterator::Edges | db::ShapeIterator::EdgePairs | db::ShapeIterator::Paths | db::ShapeIterator::Texts));
+            while (! shape.at_end ()) {
+
+              if (! block || block->shapes.size () >= shapes_per_block) {
+                new_blocks.push_back (new GDS2WriterBlock (&cref));
+                block = new_blocks.back ();
+                block->layer = l->second.layer;
+                block->datatype = l->second.datatype;
+                block->shapes.reserve (shapes_per_block);
               }
-            } else if (shape->is_box ()) {
-              write_box (layer, datatype, sf, *shape, layout, shape->prop_id ());
-            }
 
-            ++shape;
+              block->shapes.push_back (*shape);
+              ++shape;
+
+            }
 
           }
 
         }
 
+        new_blocks.back ()->end_cell = true;
+
+        for (std::vector<GDS2WriterBlock *>::const_iterator b = new_blocks.begin (); b != new_blocks.end (); ++b) {
+          blocks.push_back (*b);
+          job.schedule (new GDS2WriterBlockTask (*b));
+        }
+
+        if (! job.is_running ()) {
+          job.start ();
+        }
+
+        //  keep producing while we can
+        if (blocks.size () < max_blocks) {
+          continue;
+        }
+
       }
 
-      //  end of cell
+      //  write the first block when it is ready
 
-      write_record_size (4);
-      write_record (sENDSTR);
+      GDS2WriterBlock *block = blocks.front ();
+
+      {
+        tl::MutexLocker locker (&sync.lock);
+        while (! block->done) {
+          sync.block_done.wait (&sync.lock);
+        }
+      }
+
+      blocks.pop_front ();
+      std::auto_ptr<GDS2WriterBlock> block_holder (block);
+
+      if (! block->error.empty ()) {
+        throw tl::Exception (block->error);
+      }
+
+      if (! block->data.empty ()) {
+        stream.put (&block->data.front (), block->data.size ());
+      }
+
+      progress_checkpoint ();
 
     }
 
-  }
+  } catch (...) {
 
-  write_record_size (4);
-  write_record (sENDLIB);
+    job.terminate ();
 
-  progress_checkpoint ();
+    for (std::deque<GDS2WriterBlock *>::const_iterator b = blocks.begin (); b != blocks.end (); ++b) {
+      delete *b;
+    }
+
+    throw;
+
+  }
 }
 
 void
@@ -420,7 +842,7 @@ GDS2WriterBase::write_inst (double sf, const db::Instance &instance, bool normal
   write_record_size (4);
   write_record (is_reg ? sAREF : sSREF);
 
-  write_string_record (sSNAME, m_cell_name_map.cell_name (instance.cell_index ()));
+  write_string_record (sSNAME, mp_cell_name_map->cell_name (instance.cell_index ()));
 
   if (t.rot () != 0 || instance.is_complex ()) {
 
@@ -457,16 +879,21 @@ GDS2WriterBase::write_inst (double sf, const db::Instance &instance, bool normal
 
   write_record_size (4 + (is_reg ? 3 : 1) * 2 * 4);
   write_record (sXY);
-  write_int (scale (sf, t.disp ().x ()));
-  write_int (scale (sf, t.disp ().y ()));
+  int32_t xy [6] = {
+    scale (sf, t.disp ().x ()),
+    scale (sf, t.disp ().y ()),
+    0, 0, 0, 0
+  };
 
   if (is_reg) {
-    write_int (scale (sf, t.disp ().x () + b.x () * bmax));
-    write_int (scale (sf, t.disp ().y () + b.y () * bmax));
-    write_int (scale (sf, t.disp ().x () + a.x () * amax));
-    write_int (scale (sf, t.disp ().y () + a.y () * amax));
+    xy [2] = scale (sf, t.disp ().x () + b.x () * bmax);
+    xy [3] = scale (sf, t.disp ().y () + b.y () * bmax);
+    xy [4] = scale (sf, t.disp ().x () + a.x () * amax);
+    xy [5] = scale (sf, t.disp ().y () + a.y () * amax);
   }
 
+  write_ints (xy, is_reg ? 6 : 2);
+
   finish (layout, prop_id);
 }
 
@@ -488,16 +915,13 @@ GDS2WriterBase::write_box (int layer, int datatype, double sf, const db::Shape &
 
   write_record_size (4 + 5 * 2 * 4);
   write_record (sXY);
-  write_int (scale (sf, box.left ()));
-  write_int (scale (sf, box.bottom ()));
-  write_int (scale (sf, box.left ()));
-  write_int (scale (sf, box.top ()));
-  write_int (scale (sf, box.right ()));
-  write_int (scale (sf, box.top ()));
-  write_int (scale (sf, box.right ()));
-  write_int (scale (sf, box.bottom ()));
-  write_int (scale (sf, box.left ()));
-  write_int (scale (sf, box.bottom ()));
+  int32_t l = scale (sf, box.left ());
+  int32_t b = scale (sf, box.bottom ());
+  int32_t r = scale (sf, box.right ());
+  int32_t t = scale (sf, box.top ());
+
+  int32_t xy [10] = { l, b, l, t, r, t, r, b, l, b };
+  write_ints (xy, 10);
 
   finish (layout, prop_id);
 }
@@ -568,12 +992,16 @@ GDS2WriterBase::write_path (int layer, int datatype, double sf, const db::Shape
     write_record (sXY);
 
     //  write path ..
+    m_xy.clear ();
     for ( ; p != path.end () && nxy > 0; ++p) {
-      write_int (scale (sf, (*p).x ()));
-      write_int (scale (sf, (*p).y ()));
+      m_xy.push_back (scale (sf, (*p).x ()));
+      m_xy.push_back (scale (sf, (*p).y ()));
       --nxy;
       --n;
     }
+    if (! m_xy.empty ()) {
+      write_ints (&m_xy.front (), m_xy.size ());
+    }
 
   }
 
@@ -610,10 +1038,13 @@ GDS2WriterBase::write_edge (int layer, int datatype, double sf, const db::Edge &
 
   write_record_size (4 + 2 * 2 * 4);
   write_record (sXY);
-  write_int (scale (sf, e.p1 ().x ()));
-  write_int (scale (sf, e.p1 ().y ()));
-  write_int (scale (sf, e.p2 ().x ()));
-  write_int (scale (sf, e.p2 ().y ()));
+  int32_t xy [4] = {
+    scale (sf, e.p1 ().x ()),
+    scale (sf, e.p1 ().y ()),
+    scale (sf, e.p2 ().x ()),
+    scale (sf, e.p2 ().y ())
+  };
+  write_ints (xy, 4);
 
   finish (layout, prop_id);
 }
@@ -734,9 +1165,10 @@ GDS2WriterBase::write_polygon (int layer, int datatype, double sf, const db::Pol
       write_record (sXY);
 
       //  write polygon ..
+      m_xy.clear ();
       for ( ; e != polygon.end_hull () && nxy > 0; ++e) {
-        write_int (scale (sf, (*e).x ()));
-        write_int (scale (sf, (*e).y ()));
+        m_xy.push_back (scale (sf, (*e).x ()));
+        m_xy.push_back (scale (sf, (*e).y ()));
         --nxy;
         --n;
       }
@@ -744,11 +1176,15 @@ GDS2WriterBase::write_polygon (int layer, int datatype, double sf, const db::Pol
       //  .. and closing point
       if (nxy > 0) {
         e = polygon.begin_hull ();
-        write_int (scale (sf, (*e).x ()));
-        write_int (scale (sf, (*e).y ()));
+        m_xy.push_back (scale (sf, (*e).x ()));
+        m_xy.push_back (scale (sf, (*e).y ()));
         tl_assert (n == 0);
       }
 
+      if (! m_xy.empty ()) {
+        write_ints (&m_xy.front (), m_xy.size ());
+      }
+
     }
 
     finish (layout, prop_id);
@@ -807,9 +1243,10 @@ GDS2WriterBase::write_polygon (int layer, int datatype, double sf, const db::Sha
         write_record (sXY);
 
         //  write polygon ..
+        m_xy.clear ();
         for ( ; e != shape.end_hull () && nxy > 0; ++e) {
-          write_int (scale (sf, (*e).x ()));
-          write_int (scale (sf, (*e).y ()));
+          m_xy.push_back (scale (sf, (*e).x ()));
+          m_xy.push_back (scale (sf, (*e).y ()));
           --nxy;
           --n;
         }
@@ -817,11 +1254,15 @@ GDS2WriterBase::write_polygon (int layer, int datatype, double sf, const db::Sha
         //  .. and closing point
         if (nxy > 0) {
           e = shape.begin_hull ();
-          write_int (scale (sf, (*e).x ()));
-          write_int (scale (sf, (*e).y ()));
+          m_xy.push_back (scale (sf, (*e).x ()));
+          m_xy.push_back (scale (sf, (*e).y ()));
           tl_assert (n == 0);
         }
 
+        if (! m_xy.empty ()) {
+          write_ints (&m_xy.front (), m_xy.size ());
+        }
+
       }
 
       finish (layout, prop_id);
@@ -867,6 +1308,14 @@ GDS2WriterBase::finish (const db::Layout &layout, db::properties_id_type prop_id
   write_record (sENDEL);
 }
 
+void
+GDS2WriterBase::write_ints (const int32_t *l, size_t n)
+{
+  for (size_t i = 0; i < n; ++i) {
+    write_int (l [i]);
+  }
+}
+
 void 
 GDS2WriterBase::write_string_record (short record, const std::string &t)
 {
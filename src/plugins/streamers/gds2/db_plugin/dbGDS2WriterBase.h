@@ -27,8 +27,12 @@
 #include "dbPluginCommon.h"
 #include "dbWriter.h"
 #include "dbWriterTools.h"
+#include "dbStreamingWriter.h"
 #include "tlProgress.h"
 
+#include <set>
+#include <vector>
+
 namespace tl
 {
   class OutputStream;
@@ -39,13 +43,15 @@ namespace db
 
 class Layout;
 class SaveLayoutOptions;
+class GDS2WriterOptions;
+struct GDS2WriterBlock;
 
 /**
  *  @brief A GDS2 writer abstraction
  */
 
 class DB_PLUGIN_PUBLIC GDS2WriterBase
-  : public db::WriterBase
+  : public db::WriterBase, public db::StreamingWriterBase
 {
 public:
   /**
@@ -58,6 +64,13 @@ public:
    */
   void write (db::Layout &layout, tl::OutputStream &stream, const db::SaveLayoutOptions &options);
 
+  //  StreamingWriterBase implementation
+  virtual void begin_stream (const db::Layout &layout, tl::OutputStream &stream, const db::SaveLayoutOptions &options);
+  virtual void begin_stream_cell (db::cell_index_type cell);
+  virtual void write_stream_cell_content (const std::vector <std::pair <unsigned int, db::LayerProperties> > &layers);
+  virtual void end_stream_cell ();
+  virtual void end_stream ();
+
 protected:
   /**
    *  @brief Write a byte
@@ -84,6 +97,14 @@ protected:
    */
   virtual void write_int (int32_t l) = 0;
 
+  /**
+   *  @brief Write a number of longs
+   *
+   *  This method is used for XY records. The default implementation calls write_int
+   *  for every value. Implementations can provide a bulk encoding here.
+   */
+  virtual void write_ints (const int32_t *l, size_t n);
+
   /**
    *  @brief Write a double
    */
@@ -114,6 +135,19 @@ protected:
    */
   virtual void progress_checkpoint () = 0;
 
+  /**
+   *  @brief Creates a writer for serializing cell content into memory blocks
+   *
+   *  If this method returns a writer object, cells are serialized in multiple threads
+   *  when the "threads" option is set. The block writer receives the memory stream
+   *  through "set_stream" and must not report progress. The default implementation
+   *  returns 0 which disables the multi-threaded mode.
+   */
+  virtual GDS2WriterBase *create_block_writer () const
+  {
+    return 0;
+  }
+
   /**
    *  @brief Write a string plus record
    */
@@ -165,9 +199,38 @@ protected:
   void finish (const db::Layout &layout, db::properties_id_type prop_id);
 
 private:
-  db::WriterCellNameMap m_cell_name_map;
+  friend class GDS2WriterBlockWorker;
 
+  db::WriterCellNameMap m_cell_name_map;
+  const db::WriterCellNameMap *mp_cell_name_map;
+  std::vector<int32_t> m_xy;
+
+  //  settings for writing the cell content (shared with the block writers)
+  const db::Layout *mp_layout;
+  const std::set<db::cell_index_type> *mp_cell_set;
+  double m_sf, m_dbu;
+  bool m_keep_instances;
+  bool m_multi_xy;
+  bool m_no_zero_length_paths;
+  size_t m_max_vertex_count;
+  short m_time_data [6];
+
+  //  streaming mode
+  bool m_write_cell_properties;
+  db::cell_index_type m_stream_cell;
+  size_t m_cells_mapped;
+
+  void init_settings (const db::Layout &layout, const db::SaveLayoutOptions &options, const db::GDS2WriterOptions &gds2_options);
+  void write_header (const db::Layout &layout, const db::GDS2WriterOptions &gds2_options);
+  void write_cell_shapes (const db::Cell &cref, const std::vector <std::pair <unsigned int, db::LayerProperties> > &layers);
+  void map_stream_cells ();
   void write_properties (const db::Layout &layout, db::properties_id_type prop_id);
+  void write_cell_header (const db::Cell &cref, const short *time_data, bool write_cell_properties);
+  void write_instances (const db::Cell &cref);
+  void write_shape (int layer, int datatype, const db::Shape &shape);
+  void write_block (const GDS2WriterBlock &block, const short *time_data, bool write_cell_properties);
+  void write_cells_parallel (const std::vector<db::cell_index_type> &cells, const std::vector <std::pair <unsigned int, db::LayerProperties> > &layers, const short *time_data, bool write_cell_properties, unsigned int threads, tl::OutputStream &stream);
+  void init_block_writer (GDS2WriterBase &writer) const;
 };
 
 } // namespace db
@@ -115,6 +115,16 @@ static std::string get_gds2_libname (const db::SaveLayoutOptions *options)
   return options->get_options<db::GDS2WriterOptions> ().libname;
 }
 
+static void set_gds2_threads (db::SaveLayoutOptions *options, unsigned int n)
+{
+  options->get_options<db::GDS2WriterOptions> ().threads = n;
+}
+
+static unsigned int get_gds2_threads (const db::SaveLayoutOptions *options)
+{
+  return options->get_options<db::GDS2WriterOptions> ().threads;
+}
+
 static void set_gds2_user_units (db::SaveLayoutOptions *options, double n)
 {
   options->get_options<db::GDS2WriterOptions> ().user_units = n;
@@ -237,6 +247,19 @@ gsi::ClassExt<db::SaveLayoutOptions> gds2_writer_options (
     "@brief Get the user units\n"
     "See \\gds2_user_units= method for a description of the user units."
     "\nThis property has been added in version 0.18.\n"
+  ) +
+  gsi::method_ext ("gds2_threads=", &set_gds2_threads, gsi::arg ("n"),
+    "@brief Sets the number of threads used for writing GDS2 files\n"
+    "\n"
+    "If this value is larger than 0, the cells are serialized into memory blocks by the given number of "
+    "threads. This speeds up the writing of large, flat layouts. The blocks are written in the original "
+    "order, so the output is identical to the one produced in the single-threaded mode (0, the default).\n"
+    "\nThis property has been added in version 0.27.\n"
+  ) +
+  gsi::method_ext ("gds2_threads", &get_gds2_threads,
+    "@brief Gets the number of threads used for writing GDS2 files\n"
+    "See \\gds2_threads= method for a description of this property."
+    "\nThis property has been added in version 0.27.\n"
   ),
   ""
 );
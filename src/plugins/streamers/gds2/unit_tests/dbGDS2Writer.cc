@@ -26,7 +26,9 @@
 #include "dbLayoutDiff.h"
 #include "dbShapeProcessor.h"
 #include "dbWriter.h"
+#include "dbStreamingWriter.h"
 #include "dbTextWriter.h"
+#include "dbTestSupport.h"
 #include "tlUnitTest.h"
 
 #include <stdlib.h>
@@ -1153,3 +1155,178 @@ TEST(166)
   opt.max_vertex_count = 4;
   run_test (_this, "t166.oas.gz", "t166_au.gds.gz", false, opt);
 }
+
+static std::string write_to_string (db::Layout &layout, const db::GDS2WriterOptions &opt)
+{
+  tl::OutputStringStream os;
+
+  {
+    tl::OutputStream stream (os);
+    db::SaveLayoutOptions options;
+    options.set_format ("GDS2");
+    options.set_options (new db::GDS2WriterOptions (opt));
+    db::Writer writer (options);
+    writer.write (layout, stream);
+  }
+
+  return os.string ();
+}
+
+//  Multi-threaded mode: the output needs to be identical to the single-threaded one
+TEST(200)
+{
+  db::Manager m (false);
+  db::Layout layout (&m);
+
+  {
+    std::string fn (tl::testsrc ());
+    fn += "/testdata/gds/t10.gds";
+    tl::InputStream stream (fn);
+    db::Reader reader (stream);
+    reader.read (layout);
+  }
+
+  //  add a flat, large cell with various shapes so it gets split into several blocks
+  unsigned int l1 = layout.insert_layer (db::LayerProperties (100, 0));
+  unsigned int l2 = layout.insert_layer (db::LayerProperties (101, 0));
+  db::Cell &flat = layout.cell (layout.add_cell ("FLAT"));
+  for (int i = 0; i < 30000; ++i) {
+    flat.shapes (l1).insert (db::Box (i * 10, 0, i * 10 + 5, 100));
+    if (i % 3 == 0) {
+      db::Point pts[] = { db::Point (i, 0), db::Point (i, 1000), db::Point (i + 100, 1000), db::Point (i + 100, 500), db::Point (i + 50, 0) };
+      db::Polygon poly;
+      poly.assign_hull (pts, pts + sizeof (pts) / sizeof (pts [0]));
+      flat.shapes (l2).insert (poly);
+    }
+  }
+  db::Point ppts[] = { db::Point (0, 0), db::Point (0, 1000), db::Point (500, 1000) };
+  flat.shapes (l2).insert (db::Path (ppts, ppts + sizeof (ppts) / sizeof (ppts [0]), 20));
+  flat.shapes (l2).insert (db::Text ("T", db::Trans (db::Vector (10, 20))));
+
+  db::GDS2WriterOptions opt;
+  opt.write_timestamps = false;
+
+  std::string st = write_to_string (layout, opt);
+
+  opt.threads = 4;
+  std::string mt = write_to_string (layout, opt);
+
+  EXPECT_EQ (st.size () > 1000000, true);
+  EXPECT_EQ (st == mt, true);
+
+  //  read back
+  db::Layout layout_read (&m);
+  {
+    tl::InputMemoryStream data (mt.c_str (), mt.size ());
+    tl::InputStream stream (data);
+    db::Reader reader (stream);
+    reader.read (layout_read);
+  }
+
+  bool equal = db::compare_layouts (layout, layout_read, db::layout_diff::f_verbose, 0);
+  EXPECT_EQ (equal, true);
+
+  //  errors are reported from the workers
+  db::Cell &bad = layout.cell (layout.add_cell ("BAD"));
+  bad.insert (db::CellInstArray (db::CellInst (flat.cell_index ()), db::Trans (), db::Vector (10, 0), db::Vector (0, 10), 40000, 1));
+
+  try {
+    write_to_string (layout, opt);
+    EXPECT_EQ (true, false);
+  } catch (tl::Exception &ex) {
+    EXPECT_EQ (ex.msg (), "Cannot write array references with more than 32767 columns or rows to GDS2 streams");
+  }
+}
+
+//  Streaming mode
+TEST(201)
+{
+  db::Layout layout;
+  layout.dbu (0.001);
+
+  unsigned int l1 = layout.insert_layer (db::LayerProperties (1, 0));
+  unsigned int l2 = layout.insert_layer (db::LayerProperties (2, 5));
+
+  db::Cell &top = layout.cell (layout.add_cell ("TOP"));
+  db::Cell &a = layout.cell (layout.add_cell ("A"));
+  db::Cell &b = layout.cell (layout.add_cell ("B"));
+
+  db::PropertiesRepository::properties_set ps;
+  ps.insert (std::make_pair (layout.properties_repository ().prop_name_id (tl::Variant (1)), tl::Variant ("VALUE")));
+  db::properties_id_type pid = layout.properties_repository ().properties_id (ps);
+
+  a.shapes (l1).insert (db::Box (0, 0, 100, 200));
+  a.shapes (l2).insert (db::Text ("A", db::Trans (db::Vector (10, 20))));
+  db::Point pts[] = { db::Point (0, 0), db::Point (0, 1000), db::Point (500, 1000), db::Point (700, 0) };
+  db::Polygon poly;
+  poly.assign_hull (pts, pts + sizeof (pts) / sizeof (pts [0]));
+  b.shapes (l2).insert (db::PolygonWithProperties (poly, pid));
+  b.shapes (l1).insert (db::Path (pts, pts + 3, 20));
+
+  //  enough shapes to produce several slices
+  for (int i = 0; i < 1000; ++i) {
+    top.shapes (l1).insert (db::Box (i * 10, 0, i * 10 + 5, 100));
+  }
+  top.insert (db::CellInstArray (db::CellInst (a.cell_index ()), db::Trans (db::Vector (0, 5000)), db::Vector (1000, 0), db::Vector (0, 1000), 3, 2));
+  top.insert (db::CellInstArrayWithProperties (db::CellInstArray (db::CellInst (b.cell_index ()), db::Trans (1, true, db::Vector (-100, 200))), pid));
+  b.insert (db::CellInstArray (db::CellInst (a.cell_index ()), db::Trans ()));
+
+  tl::OutputStringStream os;
+
+  {
+    tl::OutputStream stream (os);
+    db::SaveLayoutOptions options;
+    options.set_format ("GDS2");
+
+    db::StreamingWriter writer (stream, options, layout.dbu ());
+    writer.set_flush_threshold (100);
+
+    //  TOP references A and B before these are written
+    db::write_cell_streaming (writer, layout, top.cell_index ());
+    db::write_cell_streaming (writer, layout, b.cell_index ());
+    db::write_cell_streaming (writer, layout, a.cell_index ());
+
+    //  flattening through the shape receiver
+    writer.begin_cell ("FLAT");
+    for (db::Layout::layer_iterator l = layout.begin_layers (); l != layout.end_layers (); ++l) {
+      db::StreamingWriterShapeReceiver rec (&writer, writer.layer (*(*l).second));
+      db::RecursiveShapeIterator (layout, top, (*l).first).push (&rec);
+    }
+    writer.end_cell ();
+
+    try {
+      writer.begin_cell ("A");
+      EXPECT_EQ (true, false);
+    } catch (tl::Exception &ex) {
+      EXPECT_EQ (ex.msg (), "Cell is written twice in streaming mode: A");
+    }
+
+    writer.finish ();
+  }
+
+  db::Layout layout_read;
+  {
+    std::string data = os.string ();
+    tl::InputMemoryStream mem (data.c_str (), data.size ());
+    tl::InputStream stream (mem);
+    db::Reader reader (stream);
+    reader.read (layout_read);
+  }
+
+  std::pair<bool, db::cell_index_type> flat_read = layout_read.cell_by_name ("FLAT");
+  EXPECT_EQ (flat_read.first, true);
+
+  //  the flattened cell needs to be identical to TOP flattened
+  db::Layout layout_flat;
+  layout_flat = layout;
+  db::cell_index_type flat = layout_flat.add_cell ("FLAT");
+  tl::ident_map<db::properties_id_type> pm;
+  for (db::Layout::layer_iterator l = layout_flat.begin_layers (); l != layout_flat.end_layers (); ++l) {
+    for (db::RecursiveShapeIterator s (layout_flat, layout_flat.cell (top.cell_index ()), (*l).first); ! s.at_end (); ++s) {
+      layout_flat.cell (flat).shapes ((*l).first).insert (*s, s.trans (), pm);
+    }
+  }
+
+  bool equal = db::compare_layouts (layout_flat, layout_read, db::layout_diff::f_verbose, 0);
+  EXPECT_EQ (equal, true);
+}
@@ -24,8 +24,12 @@
 #include "dbDEFImporter.h"
 #include "dbPolygonTools.h"
 #include "tlGlobPattern.h"
+#include "tlThreadedWorkers.h"
+#include "tlThreads.h"
 
 #include <cmath>
+#include <deque>
+#include <memory>
 
 namespace db
 {
@@ -136,6 +140,785 @@ struct Group
   std::vector<tl::GlobPattern> comp_match;
 };
 
+/**
+ *  @brief The read-only information required for parsing NETS, SPECIALNETS and COMPONENTS statements
+ *
+ *  This information is shared between the worker threads.
+ */
+struct DEFContext
+{
+  DEFContext (const LEFImporter *_lef, const std::map<std::string, std::map<std::string, double> > *_nondefault_widths, const std::map<int, db::Polygon> *_styles, const std::map<std::string, ViaDesc> *_via_desc, double _scale, double _dbu, bool _specialnets)
+    : lef (_lef), nondefault_widths (_nondefault_widths), styles (_styles), via_desc (_via_desc), scale (_scale), dbu (_dbu), specialnets (_specialnets)
+  {
+    //  .. nothing yet ..
+  }
+
+  const LEFImporter *lef;
+  const std::map<std::string, std::map<std::string, double> > *nondefault_widths;
+  const std::map<int, db::Polygon> *styles;
+  const std::map<std::string, ViaDesc> *via_desc;
+  double scale, dbu;
+  bool specialnets;
+};
+
+/**
+ *  @brief A buffer for the shapes and vias of the nets
+ *
+ *  The net parser stores the shapes here instead of putting them into the layout
+ *  directly. This way, nets can be parsed in worker threads. The records keep the
+ *  original order, so the layout is built the same way than without the buffer.
+ */
+class DEFNetsBuffer
+{
+public:
+  enum record_type { Net, Box, Path, Polygon, Via };
+
+  struct Record
+  {
+    Record (record_type _type, unsigned int _layer, size_t _index)
+      : type (_type), layer (_layer), index (_index)
+    { }
+
+    record_type type;
+    unsigned int layer;
+    size_t index;
+  };
+
+  void begin_net (const std::string &net)
+  {
+    m_records.push_back (Record (Net, 0, m_nets.size ()));
+    m_nets.push_back (net);
+  }
+
+  void insert (const std::string &ln, const db::Box &box)
+  {
+    m_records.push_back (Record (Box, layer_id (ln), m_boxes.size ()));
+    m_boxes.push_back (box);
+  }
+
+  void insert (const std::string &ln, const db::Path &path)
+  {
+    m_records.push_back (Record (Path, layer_id (ln), m_paths.size ()));
+    m_paths.push_back (path);
+  }
+
+  void insert (const std::string &ln, const db::Polygon &polygon)
+  {
+    m_records.push_back (Record (Polygon, layer_id (ln), m_polygons.size ()));
+    m_polygons.push_back (polygon);
+  }
+
+  void insert_via (const db::CellInstArray &via)
+  {
+    m_records.push_back (Record (Via, 0, m_vias.size ()));
+    m_vias.push_back (via);
+  }
+
+  void clear ()
+  {
+    m_records.clear ();
+    m_nets.clear ();
+    m_layers.clear ();
+    m_layer_ids.clear ();
+    m_boxes.clear ();
+    m_paths.clear ();
+    m_polygons.clear ();
+    m_vias.clear ();
+  }
+
+  const std::vector<Record> &records () const { return m_records; }
+  const std::vector<std::string> &nets () const { return m_nets; }
+  const std::vector<std::string> &layers () const { return m_layers; }
+  const std::vector<db::Box> &boxes () const { return m_boxes; }
+  const std::vector<db::Path> &paths () const { return m_paths; }
+  const std::vector<db::Polygon> &polygons () const { return m_polygons; }
+  const std::vector<db::CellInstArray> &vias () const { return m_vias; }
+
+private:
+  std::vector<Record> m_records;
+  std::vector<std::string> m_nets;
+  std::vector<std::string> m_layers;
+  std::map<std::string, unsigned int> m_layer_ids;
+  std::vector<db::Box> m_boxes;
+  std::vector<db::Path> m_paths;
+  std::vector<db::Polygon> m_polygons;
+  std::vector<db::CellInstArray> m_vias;
+
+  unsigned int layer_id (const std::string &ln)
+  {
+    std::map<std::string, unsigned int>::const_iterator l = m_layer_ids.find (ln);
+    if (l != m_layer_ids.end ()) {
+      return l->second;
+    }
+    unsigned int id = (unsigned int) m_layers.size ();
+    m_layer_ids.insert (std::make_pair (ln, id));
+    m_layers.push_back (ln);
+    return id;
+  }
+};
+
+/**
+ *  @brief A chunk of NETS, SPECIALNETS or COMPONENTS statements
+ *
+ *  The chunk holds the text of the statements and receives the parsed data.
+ */
+struct DEFChunk
+{
+  DEFChunk (bool _nets)
+    : nets (_nets), done (false)
+  { }
+
+  bool nets;
+  LEFDEFSection section;
+  DEFNetsBuffer nets_buffer;
+  std::list<std::pair<std::string, db::CellInstArray> > instances;
+  std::string error;
+  bool done;
+};
+
+/**
+ *  @brief Synchronization between the workers and the thread building the layout
+ */
+struct DEFChunkSync
+{
+  tl::Mutex lock;
+  tl::WaitCondition chunk_done;
+};
+
+class DEFChunkTask
+  : public tl::Task
+{
+public:
+  DEFChunkTask (DEFChunk *chunk)
+    : mp_chunk (chunk)
+  { }
+
+  DEFChunk *chunk () const
+  {
+    return mp_chunk;
+  }
+
+private:
+  DEFChunk *mp_chunk;
+};
+
+class DEFChunkWorker
+  : public tl::Worker
+{
+public:
+  DEFChunkWorker (const DEFContext *context, const std::string &fn, DEFChunkSync *sync)
+    : tl::Worker (), mp_context (context), m_fn (fn), mp_sync (sync)
+  { }
+
+  void perform_task (tl::Task *task)
+  {
+    DEFChunk *chunk = static_cast<DEFChunkTask *> (task)->chunk ();
+
+    std::string error;
+
+    try {
+      m_importer.read_chunk (*chunk, *mp_context, m_fn);
+    } catch (tl::Exception &ex) {
+      error = ex.msg ();
+    } catch (std::exception &ex) {
+      error = ex.what ();
+    } catch (...) {
+      error = tl::to_string (tr ("Unspecific error"));
+    }
+
+    tl::MutexLocker locker (&mp_sync->lock);
+    chunk->error = error;
+    chunk->done = true;
+    mp_sync->chunk_done.wakeAll ();
+  }
+
+private:
+  DEFImporter m_importer;
+  const DEFContext *mp_context;
+  std::string m_fn;
+  DEFChunkSync *mp_sync;
+};
+
+class DEFChunkJob
+  : public tl::JobBase
+{
+public:
+  DEFChunkJob (int nworkers, const DEFContext *context, const std::string &fn, DEFChunkSync *sync)
+    : tl::JobBase (nworkers), mp_context (context), m_fn (fn), mp_sync (sync)
+  { }
+
+protected:
+  virtual tl::Worker *create_worker ()
+  {
+    return new DEFChunkWorker (mp_context, m_fn, mp_sync);
+  }
+
+private:
+  const DEFContext *mp_context;
+  std::string m_fn;
+  DEFChunkSync *mp_sync;
+};
+
+void
+DEFImporter::read_chunk (DEFChunk &chunk, const DEFContext &context, const std::string &fn)
+{
+  tl::InputMemoryStream data (chunk.section.text.c_str (), chunk.section.text.size ());
+  tl::InputStream stream (data);
+
+  enter_section (stream, fn, chunk.section.line_offset);
+
+  try {
+
+    //  the leading "-" of the statements is not part of the text
+    while (! at_end ()) {
+      if (chunk.nets) {
+        read_net (chunk.nets_buffer, context);
+      } else {
+        read_component (chunk.instances, context);
+      }
+    }
+
+  } catch (...) {
+    leave_section ();
+    throw;
+  }
+
+  leave_section ();
+}
+
+void
+DEFImporter::read_chunks_parallel (bool nets, const DEFContext &context, unsigned int threads, db::Layout &layout, db::Cell &design, instance_list &instances)
+{
+  //  the size of the chunks - they should be large enough to keep the overhead low
+  const size_t max_chunk_size = 1024 * 1024;
+  const size_t max_chunk_statements = 2000;
+  //  the maximum number of chunks in flight - this limits the memory required
+  const size_t max_chunks = threads * 4;
+
+  DEFChunkSync sync;
+  DEFChunkJob job (int (threads), &context, filename (), &sync);
+
+  std::deque<DEFChunk *> chunks;
+
+  try {
+
+    bool at_end = false;
+
+    while (! at_end || ! chunks.empty ()) {
+
+      //  cut new chunks from the text unless there are too many already
+      if (! at_end && chunks.size () < max_chunks) {
+
+        std::auto_ptr<DEFChunk> chunk (new DEFChunk (nets));
+
+        size_t n = 0;
+        while (n < max_chunk_statements && chunk->section.text.size () < max_chunk_size) {
+          if (! test ("-")) {
+            at_end = true;
+            break;
+          }
+          read_statement (chunk->section);
+          ++n;
+        }
+
+        if (n > 0) {
+
+          chunks.push_back (chunk.release ());
+          job.schedule (new DEFChunkTask (chunks.back ()));
+
+          if (! job.is_running ()) {
+            job.start ();
+          }
+
+        }
+
+        //  keep producing while we can
+        if (! at_end && chunks.size () < max_chunks) {
+          continue;
+        }
+
+        if (chunks.empty ()) {
+          continue;
+        }
+
+      }
+
+      //  merge the first chunk when it is ready
+
+      DEFChunk *chunk = chunks.front ();
+
+      {
+        tl::MutexLocker locker (&sync.lock);
+        while (! chunk->done) {
+          sync.chunk_done.wait (&sync.lock);
+        }
+      }
+
+      chunks.pop_front ();
+      std::auto_ptr<DEFChunk> chunk_holder (chunk);
+
+      if (! chunk->error.empty ()) {
+        throw db::ReaderException (chunk->error);
+      }
+
+      if (nets) {
+        insert_nets (layout, design, chunk->nets_buffer);
+      } else {
+        instances.splice (instances.end (), chunk->instances);
+      }
+
+    }
+
+  } catch (...) {
+
+    job.terminate ();
+
+    for (std::deque<DEFChunk *>::const_iterator c = chunks.begin (); c != chunks.end (); ++c) {
+      delete *c;
+    }
+
+    throw;
+
+  }
+}
+
+void
+DEFImporter::read_net (DEFNetsBuffer &buffer, const DEFContext &context)
+{
+  double scale = context.scale;
+  double dbu = context.dbu;
+  bool specialnets = context.specialnets;
+  const std::map<int, db::Polygon> &styles = *context.styles;
+  const std::map<std::string, ViaDesc> &via_desc = *context.via_desc;
+
+  std::string net = get ();
+  std::string nondefaultrule;
+  std::string stored_netname, stored_nondefaultrule;
+  std::string taperrule;
+  bool in_subnet = false;
+
+  buffer.begin_net (net);
+
+  while (test ("(")) {
+    while (! test (")")) {
+      take ();
+    }
+  }
+
+  while (test ("+")) {
+
+    bool was_shield = false;
+
+    if (! specialnets && test ("SUBNET")) {
+
+      while (test ("(")) {
+        while (! test (")")) {
+          take ();
+        }
+      }
+
+      if (! in_subnet) {
+        stored_netname = net;
+        stored_nondefaultrule = nondefaultrule;
+        in_subnet = true;
+      }
+
+    } else if (! specialnets && test ("NONDEFAULTRULE")) {
+
+      nondefaultrule = get ();
+
+    } else if ((was_shield = test ("SHIELD")) == true || test ("NOSHIELD") || test ("ROUTED") || test ("FIXED") || test ("COVER")) {
+
+      if (was_shield) {
+        take ();
+      }
+
+      taperrule.clear ();
+
+      do {
+
+        std::string ln = get ();
+
+        db::Coord w = 0;
+        if (specialnets) {
+          w = db::coord_traits<db::Coord>::rounded (get_double () * scale);
+        } 
+
+        const db::Polygon *style = 0;
+
+        int sn = std::numeric_limits<int>::max ();
+
+        if (specialnets) {
+
+          while (test ("+")) {
+
+            if (test ("STYLE")) {
+              sn = get_long ();
+            } else if (test ("SHAPE")) {
+              take ();
+            }
+
+          }
+
+        } else {
+
+          while (true) {
+            if (test ("TAPER")) {
+              taperrule.clear ();
+            } else if (test ("TAPERRULE")) {
+              taperrule = get ();
+            } else if (test ("STYLE")) {
+              sn = get_long ();
+            } else {
+              break;
+            }
+          }
+
+        }
+
+        if (! specialnets) {
+
+          const std::string *rulename = &taperrule;
+          if (rulename->empty ()) {
+            rulename = &nondefaultrule;
+          }
+
+          w = db::coord_traits<db::Coord>::rounded (context.lef->layer_width (ln, *rulename, 0.0) / dbu);
+
+          //  try to find local nondefault rule
+          if (! rulename->empty ()) {
+            std::map<std::string, std::map<std::string, double> >::const_iterator nd = context.nondefault_widths->find (*rulename);
+            if (nd != context.nondefault_widths->end ()) {
+              std::map<std::string, double>::const_iterator ld = nd->second.find (ln);
+              if (ld != nd->second.end ()) {
+                w = ld->second;
+              }
+            }
+          }
+
+        }
+
+        db::Coord def_ext = 0;
+        if (! specialnets) {
+          def_ext = db::coord_traits<db::Coord>::rounded (context.lef->layer_ext (ln, w * 0.5 * dbu) / dbu);
+        }
+
+        std::map<int, db::Polygon>::const_iterator s = styles.find (sn);
+        if (s != styles.end ()) {
+          style = &s->second;
+        }
+
+        std::vector<db::Coord> ext;
+        std::vector<db::Point> pts;
+
+        double x = 0.0, y = 0.0;
+
+        while (true) {
+
+          if (test ("MASK")) {
+            //  ignore mask spec
+            get_long ();
+          }
+
+          if (test ("RECT")) {
+
+            if (! test ("(")) {
+              error (tl::to_string (tr ("RECT routing specification not followed by coordinate list")));
+            }
+
+            //  breaks wiring
+            pts.clear ();
+
+            //  rect spec
+
+            double x1 = get_double ();
+            double y1 = get_double ();
+            double x2 = get_double ();
+            double y2 = get_double ();
+
+            test (")");
+
+            db::Box rect (db::Point (db::DPoint ((x + x1) * scale, (y + y1) * scale)),
+                          db::Point (db::DPoint ((x + x2) * scale, (y + y2) * scale)));
+
+            buffer.insert (ln, rect);
+
+          } else if (test ("VIRTUAL")) {
+
+            //  virtual specs simply create a new segment
+            pts.clear ();
+
+          } else if (peek ("(")) {
+
+            ext.clear ();
+
+            while (peek ("(") || peek ("MASK")) {
+
+              if (test ("MASK")) {
+                //  ignore MASK spec
+                get_long ();
+              } 
+
+              if (! test ("(")) {
+                //  We could have a via here: in that case we have swallowed MASK already, but
+                //  since we don't do anything with that, this does not hurt for now.
+                break;
+              }
+
+              if (! test ("*")) {
+                x = get_double ();
+              }
+              if (! test ("*")) {
+                y = get_double ();
+              }
+              pts.push_back (db::Point (db::DPoint (x * scale, y * scale)));
+              db::Coord e = def_ext;
+              if (! peek (")")) {
+                e = db::coord_traits<db::Coord>::rounded (get_double () * scale);
+              }
+              ext.push_back (e);
+
+              test (")");
+
+            }
+
+            if (pts.size () > 1) {
+
+              if (! style) {
+
+                //  Use the default style (octagon "pen" for non-manhattan segments, paths for 
+                //  horizontal/vertical segments).
+
+                db::Coord e = std::max (ext.front (), ext.back ());
+
+                std::vector<db::Point>::const_iterator pt = pts.begin ();
+                while (pt != pts.end ()) {
+
+                  std::vector<db::Point>::const_iterator pt0 = pt;
+                  do {
+                    ++pt;
+                  } while (pt != pts.end () && (pt[-1].x () == pt[0].x () || pt[-1].y () == pt[0].y()));
+
+                  if (pt - pt0 > 1) {
+
+                    db::Path p (pt0, pt, w, pt0 == pts.begin () ? e : 0, pt == pts.end () ? e : 0, false);
+                    buffer.insert (ln, p);
+
+                    if (pt == pts.end ()) {
+                      break;
+                    }
+
+                    --pt;
+
+                  } else if (pt != pts.end ()) {
+
+                    db::Coord s = (w + 1) / 2;
+                    db::Coord t = db::Coord (ceil (w * (M_SQRT2 - 1) / 2));
+
+                    db::Point octagon[8] = {
+                      db::Point (-s, t),
+                      db::Point (-t, s),
+                      db::Point (t, s),
+                      db::Point (s, t),
+                      db::Point (s, -t),
+                      db::Point (t, -s),
+                      db::Point (-t, -s),
+                      db::Point (-s, -t)
+                    };
+
+                    db::Polygon k;
+                    k.assign_hull (octagon, octagon + sizeof (octagon) / sizeof (octagon[0]));
+
+                    db::Polygon p = db::minkowsky_sum (k, db::Edge (*pt0, *pt));
+                    buffer.insert (ln, p);
+
+                  }
+
+                }
+
+              } else {
+
+                for (size_t i = 0; i < pts.size () - 1; ++i) {
+                  db::Polygon p = db::minkowsky_sum (*style, db::Edge (pts [i], pts [i + 1]));
+                  buffer.insert (ln, p);
+                }
+
+              }
+
+            }
+
+          } else if (! peek ("NEW") && ! peek ("+") && ! peek ("-") && ! peek (";")) {
+
+            //  indicates a via
+            std::string vn = get ();
+            db::FTrans ft = get_orient (true /*optional*/);
+
+            std::map<std::string, ViaDesc>::const_iterator vd = via_desc.find (vn);
+            if (vd != via_desc.end () && ! pts.empty ()) {
+              buffer.insert_via (db::CellInstArray (db::CellInst (vd->second.cell->cell_index ()), db::Trans (ft.rot (), db::Vector (pts.back ()))));
+              if (ln == vd->second.m1) {
+                ln = vd->second.m2;
+              } else if (ln == vd->second.m2) {
+                ln = vd->second.m1;
+              }
+            }
+
+            //  continue a segment with the current point and the new layer
+            if (pts.size () > 1) {
+              pts.erase (pts.begin (), pts.end () - 1);
+            }
+
+          } else {
+            break;
+          }
+
+        }
+
+      } while (test ("NEW"));
+
+      if (in_subnet) {
+        in_subnet = false;
+        net = stored_netname;
+        stored_netname.clear ();
+        nondefaultrule = stored_nondefaultrule;
+        stored_nondefaultrule.clear ();
+      }
+
+    } else if (test ("POLYGON")) {
+
+      std::string ln = get ();
+
+      db::Polygon p;
+      read_polygon (p, scale);
+
+      buffer.insert (ln, p);
+
+    } else if (test ("RECT")) {
+
+      std::string ln = get ();
+
+      db::Polygon p;
+      read_rect (p, scale);
+
+      buffer.insert (ln, p);
+
+    } else {
+      while (! peek ("+") && ! peek ("-") && ! peek (";")) {
+        take ();
+      }
+    }
+
+  }
+
+  expect (";");
+}
+
+void
+DEFImporter::insert_nets (db::Layout &layout, db::Cell &design, const DEFNetsBuffer &buffer)
+{
+  //  layers are opened in the order of their first use, like without the buffer
+  std::vector<std::pair<bool, unsigned int> > layers;
+  std::vector<bool> layers_opened;
+  layers.resize (buffer.layers ().size (), std::make_pair (false, 0));
+  layers_opened.resize (buffer.layers ().size (), false);
+
+  db::properties_id_type prop_id = 0;
+
+  for (std::vector<DEFNetsBuffer::Record>::const_iterator r = buffer.records ().begin (); r != buffer.records ().end (); ++r) {
+
+    if (r->type == DEFNetsBuffer::Net) {
+
+      prop_id = 0;
+      if (produce_net_props ()) {
+        db::PropertiesRepository::properties_set props;
+        props.insert (std::make_pair (net_prop_name_id (), tl::Variant (buffer.nets () [r->index])));
+        prop_id = layout.properties_repository ().properties_id (props);
+      }
+
+    } else if (r->type == DEFNetsBuffer::Via) {
+
+      design.insert (buffer.vias () [r->index]);
+
+    } else {
+
+      if (! layers_opened [r->layer]) {
+        layers [r->layer] = open_layer (layout, buffer.layers () [r->layer], Routing);
+        layers_opened [r->layer] = true;
+      }
+
+      const std::pair<bool, unsigned int> &dl = layers [r->layer];
+      if (! dl.first) {
+        continue;
+      }
+
+      db::Shapes &shapes = design.shapes (dl.second);
+
+      if (r->type == DEFNetsBuffer::Box) {
+        if (prop_id != 0) {
+          shapes.insert (db::object_with_properties<db::Box> (buffer.boxes () [r->index], prop_id));
+        } else {
+          shapes.insert (buffer.boxes () [r->index]);
+        }
+      } else if (r->type == DEFNetsBuffer::Path) {
+        if (prop_id != 0) {
+          shapes.insert (db::object_with_properties<db::Path> (buffer.paths () [r->index], prop_id));
+        } else {
+          shapes.insert (buffer.paths () [r->index]);
+        }
+      } else if (r->type == DEFNetsBuffer::Polygon) {
+        if (prop_id != 0) {
+          shapes.insert (db::object_with_properties<db::Polygon> (buffer.polygons () [r->index], prop_id));
+        } else {
+          shapes.insert (buffer.polygons () [r->index]);
+        }
+      }
+
+    }
+
+  }
+}
+
+void
+DEFImporter::read_component (instance_list &instances, const DEFContext &context)
+{
+  double scale = context.scale;
+
+  std::string inst_name = get ();
+  std::string model = get ();
+
+  db::Cell *cell = context.lef->macro_by_name (model);
+
+  while (test ("+")) {
+
+    if (test ("PLACED") || test ("FIXED") || test ("COVER")) {
+
+      test ("(");
+      double x = get_double ();
+      double y = get_double ();
+      db::Point pt = db::Point (db::DPoint (x * scale, y * scale));
+      test (")");
+
+      db::FTrans ft = get_orient (false /*mandatory*/);
+      db::Vector d = pt - context.lef->macro_bbox_by_name (model).transformed (ft).lower_left ();
+
+      if (cell) {
+        db::CellInstArray inst (db::CellInst (cell->cell_index ()), db::Trans (ft.rot (), d));
+        instances.push_back (std::make_pair (inst_name, inst));
+      } else {
+        warn (tl::to_string (tr ("Macro not found in LEF file: ")) + model);
+      }
+
+    } else {
+      while (! peek ("+") && ! peek ("-") && ! peek (";")) {
+        take ();
+      }
+    }
+
+  }
+
+  expect (";");
+}
+
 void 
 DEFImporter::do_read (db::Layout &layout)
 {
@@ -149,6 +932,8 @@ DEFImporter::do_read (db::Layout &layout)
 
   db::Cell &design = layout.cell (layout.add_cell ("TOP"));
 
+  unsigned int threads = tech_comp () ? tech_comp ()->threads () : 0;
+
   while (! at_end ()) {
 
     bool specialnets = false;
@@ -426,374 +1211,22 @@ DEFImporter::do_read (db::Layout &layout)
       get_long ();
       expect (";");
 
-      while (test ("-")) {
-
-        std::string net = get ();
-        std::string nondefaultrule;
-        std::string stored_netname, stored_nondefaultrule;
-        std::string taperrule;
-        bool in_subnet = false;
-
-        db::properties_id_type prop_id = 0;
-        if (produce_net_props ()) {
-          db::PropertiesRepository::properties_set props;
-          props.insert (std::make_pair (net_prop_name_id (), tl::Variant (net)));
-          prop_id = layout.properties_repository ().properties_id (props);
-        }
-
-        while (test ("(")) {
-          while (! test (")")) {
-            take ();
-          }
-        }
-
-        while (test ("+")) {
-
-          bool was_shield = false;
-
-          if (! specialnets && test ("SUBNET")) {
-
-            while (test ("(")) {
-              while (! test (")")) {
-                take ();
-              }
-            }
-
-            if (! in_subnet) {
-              stored_netname = net;
-              stored_nondefaultrule = nondefaultrule;
-              in_subnet = true;
-            }
-
-          } else if (! specialnets && test ("NONDEFAULTRULE")) {
-
-            nondefaultrule = get ();
-
-          } else if ((was_shield = test ("SHIELD")) == true || test ("NOSHIELD") || test ("ROUTED") || test ("FIXED") || test ("COVER")) {
-
-            if (was_shield) {
-              take ();
-            }
-
-            taperrule.clear ();
-
-            do {
-
-              std::string ln = get ();
-
-              db::Coord w = 0;
-              if (specialnets) {
-                w = db::coord_traits<db::Coord>::rounded (get_double () * scale);
-              } 
-
-              const db::Polygon *style = 0;
-
-              int sn = std::numeric_limits<int>::max ();
-
-              if (specialnets) {
-
-                while (test ("+")) {
-
-                  if (test ("STYLE")) {
-                    sn = get_long ();
-                  } else if (test ("SHAPE")) {
-                    take ();
-                  }
-
-                }
-
-              } else {
-
-                while (true) {
-                  if (test ("TAPER")) {
-                    taperrule.clear ();
-                  } else if (test ("TAPERRULE")) {
-                    taperrule = get ();
-                  } else if (test ("STYLE")) {
-                    sn = get_long ();
-                  } else {
-                    break;
-                  }
-                }
-
-              }
-
-              if (! specialnets) {
-
-                const std::string *rulename = &taperrule;
-                if (rulename->empty ()) {
-                  rulename = &nondefaultrule;
-                }
-
-                w = db::coord_traits<db::Coord>::rounded (m_lef_importer.layer_width (ln, *rulename, 0.0) / layout.dbu ());
-
-                //  try to find local nondefault rule
-                if (! rulename->empty ()) {
-                  std::map<std::string, std::map<std::string, double> >::const_iterator nd = m_nondefault_widths.find (*rulename);
-                  if (nd != m_nondefault_widths.end ()) {
-                    std::map<std::string, double>::const_iterator ld = nd->second.find (ln);
-                    if (ld != nd->second.end ()) {
-                      w = ld->second;
-                    }
-                  }
-                }
-
-              }
-
-              db::Coord def_ext = 0;
-              if (! specialnets) {
-                def_ext = db::coord_traits<db::Coord>::rounded (m_lef_importer.layer_ext (ln, w * 0.5 * layout.dbu ()) / layout.dbu ());
-              }
-
-              std::map<int, db::Polygon>::const_iterator s = styles.find (sn);
-              if (s != styles.end ()) {
-                style = &s->second;
-              }
-
-              std::vector<db::Coord> ext;
-              std::vector<db::Point> pts;
-
-              double x = 0.0, y = 0.0;
-
-              while (true) {
-
-                if (test ("MASK")) {
-                  //  ignore mask spec
-                  get_long ();
-                }
-
-                if (test ("RECT")) {
-
-                  if (! test ("(")) {
-                    error (tl::to_string (tr ("RECT routing specification not followed by coordinate list")));
-                  }
-
-                  //  breaks wiring
-                  pts.clear ();
-
-                  //  rect spec
-
-                  double x1 = get_double ();
-                  double y1 = get_double ();
-                  double x2 = get_double ();
-                  double y2 = get_double ();
-
-                  test (")");
-
-                  std::pair <bool, unsigned int> dl = open_layer (layout, ln, Routing);
-                  if (dl.first) {
-
-                    db::Box rect (db::Point (db::DPoint ((x + x1) * scale, (y + y1) * scale)),
-                                  db::Point (db::DPoint ((x + x2) * scale, (y + y2) * scale)));
-
-                    if (prop_id != 0) {
-                      design.shapes (dl.second).insert (db::object_with_properties<db::Box> (rect, prop_id));
-                    } else {
-                      design.shapes (dl.second).insert (rect);
-                    }
-
-                  }
-
-                } else if (test ("VIRTUAL")) {
-
-                  //  virtual specs simply create a new segment
-                  pts.clear ();
-
-                } else if (peek ("(")) {
-
-                  ext.clear ();
-
-                  while (peek ("(") || peek ("MASK")) {
-
-                    if (test ("MASK")) {
-                      //  ignore MASK spec
-                      get_long ();
-                    } 
-
-                    if (! test ("(")) {
-                      //  We could have a via here: in that case we have swallowed MASK already, but
-                      //  since we don't do anything with that, this does not hurt for now.
-                      break;
-                    }
-
-                    if (! test ("*")) {
-                      x = get_double ();
-                    }
-                    if (! test ("*")) {
-                      y = get_double ();
-                    }
-                    pts.push_back (db::Point (db::DPoint (x * scale, y * scale)));
-                    db::Coord e = def_ext;
-                    if (! peek (")")) {
-                      e = db::coord_traits<db::Coord>::rounded (get_double () * scale);
-                    }
-                    ext.push_back (e);
-
-                    test (")");
-
-                  }
-
-                  if (pts.size () > 1) {
-
-                    std::pair <bool, unsigned int> dl = open_layer (layout, ln, Routing);
-                    if (dl.first) {
-
-                      if (! style) {
-
-                        //  Use the default style (octagon "pen" for non-manhattan segments, paths for 
-                        //  horizontal/vertical segments).
-
-                        db::Coord e = std::max (ext.front (), ext.back ());
-
-                        std::vector<db::Point>::const_iterator pt = pts.begin ();
-                        while (pt != pts.end ()) {
-
-                          std::vector<db::Point>::const_iterator pt0 = pt;
-                          do {
-                            ++pt;
-                          } while (pt != pts.end () && (pt[-1].x () == pt[0].x () || pt[-1].y () == pt[0].y()));
-
-                          if (pt - pt0 > 1) {
-
-                            db::Path p (pt0, pt, w, pt0 == pts.begin () ? e : 0, pt == pts.end () ? e : 0, false);
-                            if (prop_id != 0) {
-                              design.shapes (dl.second).insert (db::object_with_properties<db::Path> (p, prop_id));
-                            } else {
-                              design.shapes (dl.second).insert (p);
-                            }
-
-                            if (pt == pts.end ()) {
-                              break;
-                            }
-
-                            --pt;
-
-                          } else if (pt != pts.end ()) {
-
-                            db::Coord s = (w + 1) / 2;
-                            db::Coord t = db::Coord (ceil (w * (M_SQRT2 - 1) / 2));
-
-                            db::Point octagon[8] = {
-                              db::Point (-s, t),
-                              db::Point (-t, s),
-                              db::Point (t, s),
-                              db::Point (s, t),
-                              db::Point (s, -t),
-                              db::Point (t, -s),
-                              db::Point (-t, -s),
-                              db::Point (-s, -t)
-                            };
-
-                            db::Polygon k;
-                            k.assign_hull (octagon, octagon + sizeof (octagon) / sizeof (octagon[0]));
-
-                            db::Polygon p = db::minkowsky_sum (k, db::Edge (*pt0, *pt));
-                            if (prop_id != 0) {
-                              design.shapes (dl.second).insert (db::object_with_properties<db::Polygon> (p, prop_id));
-                            } else {
-                              design.shapes (dl.second).insert (p);
-                            }
-
-                          }
-
-                        }
-
-                      } else {
-
-                        for (size_t i = 0; i < pts.size () - 1; ++i) {
-                          db::Polygon p = db::minkowsky_sum (*style, db::Edge (pts [i], pts [i + 1]));
-                          if (prop_id != 0) {
-                            design.shapes (dl.second).insert (db::object_with_properties<db::Polygon> (p, prop_id));
-                          } else {
-                            design.shapes (dl.second).insert (p);
-                          }
-                        }
-
-                      }
-
-                    }
-                    
-                  }
-
-                } else if (! peek ("NEW") && ! peek ("+") && ! peek ("-") && ! peek (";")) {
-
-                  //  indicates a via
-                  std::string vn = get ();
-                  db::FTrans ft = get_orient (true /*optional*/);
-
-                  std::map<std::string, ViaDesc>::const_iterator vd = via_desc.find (vn);
-                  if (vd != via_desc.end () && ! pts.empty ()) {
-                    design.insert (db::CellInstArray (db::CellInst (vd->second.cell->cell_index ()), db::Trans (ft.rot (), db::Vector (pts.back ()))));
-                    if (ln == vd->second.m1) {
-                      ln = vd->second.m2;
-                    } else if (ln == vd->second.m2) {
-                      ln = vd->second.m1;
-                    }
-                  }
+      DEFContext context (&m_lef_importer, &m_nondefault_widths, &styles, &via_desc, scale, layout.dbu (), specialnets);
 
-                  //  continue a segment with the current point and the new layer
-                  if (pts.size () > 1) {
-                    pts.erase (pts.begin (), pts.end () - 1);
-                  }
-
-                } else {
-                  break;
-                }
-
-              }
-
-            } while (test ("NEW"));
-
-            if (in_subnet) {
-              in_subnet = false;
-              net = stored_netname;
-              stored_netname.clear ();
-              nondefaultrule = stored_nondefaultrule;
-              stored_nondefaultrule.clear ();
-            }
-
-          } else if (test ("POLYGON")) {
-
-            std::string ln = get ();
-
-            db::Polygon p;
-            read_polygon (p, scale);
-
-            std::pair <bool, unsigned int> dl = open_layer (layout, ln, Routing);
-            if (dl.first) {
-              if (prop_id != 0) {
-                design.shapes (dl.second).insert (db::object_with_properties<db::Polygon> (p, prop_id));
-              } else {
-                design.shapes (dl.second).insert (p);
-              }
-            }
-
-          } else if (test ("RECT")) {
-
-            std::string ln = get ();
+      if (threads > 0) {
 
-            db::Polygon p;
-            read_rect (p, scale);
+        read_chunks_parallel (true, context, threads, layout, design, instances);
 
-            std::pair <bool, unsigned int> dl = open_layer (layout, ln, Routing);
-            if (dl.first) {
-              if (prop_id != 0) {
-                design.shapes (dl.second).insert (db::object_with_properties<db::Polygon> (p, prop_id));
-              } else {
-                design.shapes (dl.second).insert (p);
-              }
-            }
+      } else {
 
-          } else {
-            while (! peek ("+") && ! peek ("-") && ! peek (";")) {
-              take ();
-            }
-          }
+        DEFNetsBuffer buffer;
 
+        while (test ("-")) {
+          read_net (buffer, context);
+          insert_nets (layout, design, buffer);
+          buffer.clear ();
         }
 
-        expect (";");
-
       }
 
       test ("END");
@@ -981,43 +1414,14 @@ DEFImporter::do_read (db::Layout &layout)
       get_long ();
       expect (";");
 
-      while (test ("-")) {
-
-        std::string inst_name = get ();
-        std::string model = get ();
-
-        db::Cell *cell = m_lef_importer.macro_by_name (model);
-
-        while (test ("+")) {
-
-          if (test ("PLACED") || test ("FIXED") || test ("COVER")) {
-
-            test ("(");
-            double x = get_double ();
-            double y = get_double ();
-            db::Point pt = db::Point (db::DPoint (x * scale, y * scale));
-            test (")");
-
-            db::FTrans ft = get_orient (false /*mandatory*/);
-            db::Vector d = pt - m_lef_importer.macro_bbox_by_name (model).transformed (ft).lower_left ();
-
-            if (cell) {
-              db::CellInstArray inst (db::CellInst (cell->cell_index ()), db::Trans (ft.rot (), d));
-              instances.push_back (std::make_pair (inst_name, inst));
-            } else {
-              warn (tl::to_string (tr ("Macro not found in LEF file: ")) + model);
-            }
-
-          } else {
-            while (! peek ("+") && ! peek ("-") && ! peek (";")) {
-              take ();
-            }
-          }
+      DEFContext context (&m_lef_importer, &m_nondefault_widths, &styles, &via_desc, scale, layout.dbu (), false);
 
+      if (threads > 0) {
+        read_chunks_parallel (false, context, threads, layout, design, instances);
+      } else {
+        while (test ("-")) {
+          read_component (instances, context);
         }
-
-        expect (";");
-
       }
 
       expect ("END");
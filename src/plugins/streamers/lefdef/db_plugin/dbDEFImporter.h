@@ -32,10 +32,16 @@
 
 #include <vector>
 #include <string>
+#include <list>
 
 namespace db
 {
 
+struct DEFContext;
+struct DEFChunk;
+class DEFNetsBuffer;
+class DEFChunkWorker;
+
 /**
  *  @brief The DEF importer object
  */
@@ -56,16 +62,33 @@ public:
    */
   void read_lef (tl::InputStream &stream, db::Layout &layout, LEFDEFLayerDelegate &ld);
 
+  /**
+   *  @brief Gets the LEF importer which holds the LEF data for the DEF file
+   */
+  LEFImporter &lef_importer ()
+  {
+    return m_lef_importer;
+  }
+
 protected:
   void do_read (db::Layout &layout);
 
 private:
+  friend class DEFChunkWorker;
+
+  typedef std::list<std::pair<std::string, db::CellInstArray> > instance_list;
+
   LEFImporter m_lef_importer;
   std::map<std::string, std::map<std::string, double> > m_nondefault_widths;
 
   db::FTrans get_orient (bool optional);
   void read_polygon (db::Polygon &poly, double scale);
   void read_rect (db::Polygon &poly, double scale);
+  void read_net (DEFNetsBuffer &buffer, const DEFContext &context);
+  void insert_nets (db::Layout &layout, db::Cell &design, const DEFNetsBuffer &buffer);
+  void read_component (instance_list &instances, const DEFContext &context);
+  void read_chunk (DEFChunk &chunk, const DEFContext &context, const std::string &fn);
+  void read_chunks_parallel (bool nets, const DEFContext &context, unsigned int threads, db::Layout &layout, db::Cell &design, instance_list &instances);
 };
 
 }
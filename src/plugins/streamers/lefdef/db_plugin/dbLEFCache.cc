@@ -0,0 +1,989 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "dbLEFCache.h"
+#include "dbLayoutUtils.h"
+#include "tlFileUtils.h"
+#include "tlStream.h"
+#include "tlTimer.h"
+#include "tlLog.h"
+
+#include <memory>
+#include <cstring>
+
+namespace db
+{
+
+// -----------------------------------------------------------------------------------
+//  LEFCacheKey implementation
+
+LEFCacheKey::LEFCacheKey (const std::vector<std::string> &paths, double _dbu, const LEFDEFReaderOptions *options)
+  : dbu (_dbu), produce_pin_names (false)
+{
+  for (std::vector<std::string>::const_iterator p = paths.begin (); p != paths.end (); ++p) {
+    files.push_back (File ());
+    files.back ().path = *p;
+    if (! tl::file_info (*p, files.back ().mtime, files.back ().size)) {
+      files.back ().mtime = -1;
+      files.back ().size = -1;
+    }
+  }
+
+  if (options && options->produce_pin_names ()) {
+    produce_pin_names = true;
+    pin_property_name = options->pin_property_name ().to_parsable_string ();
+  }
+}
+
+bool
+LEFCacheKey::operator== (const LEFCacheKey &other) const
+{
+  return files == other.files && dbu == other.dbu && produce_pin_names == other.produce_pin_names && pin_property_name == other.pin_property_name;
+}
+
+// -----------------------------------------------------------------------------------
+//  The cache entry and the layer delegate recording the layers
+
+struct LEFCacheEntry
+{
+  struct Layer
+  {
+    Layer (const std::string &_name, LayerPurpose _purpose, unsigned int _index)
+      : name (_name), purpose (_purpose), index (_index)
+    { }
+
+    std::string name;
+    LayerPurpose purpose;
+    unsigned int index;
+  };
+
+  LEFCacheKey key;
+  db::Layout layout;
+  LEFImporter importer;
+  std::vector<std::string> registered_layers;
+  std::vector<Layer> layers;
+};
+
+/**
+ *  @brief A layer delegate creating a layer for every name and purpose
+ *
+ *  This delegate records the order in which the layers are opened.
+ */
+class LEFCacheLayerDelegate
+  : public LEFDEFLayerDelegate
+{
+public:
+  LEFCacheLayerDelegate (const LEFDEFReaderOptions *options, LEFCacheEntry *entry)
+    : LEFDEFLayerDelegate (options), mp_entry (entry)
+  { }
+
+  virtual std::pair <bool, unsigned int> open_layer (db::Layout &layout, const std::string &name, LayerPurpose purpose)
+  {
+    std::map<std::pair<std::string, LayerPurpose>, unsigned int>::const_iterator l = m_layers.find (std::make_pair (name, purpose));
+    if (l != m_layers.end ()) {
+      return std::make_pair (true, l->second);
+    }
+
+    unsigned int li = layout.insert_layer (db::LayerProperties ());
+    m_layers.insert (std::make_pair (std::make_pair (name, purpose), li));
+    mp_entry->layers.push_back (LEFCacheEntry::Layer (name, purpose, li));
+    return std::make_pair (true, li);
+  }
+
+  virtual void register_layer (const std::string &l)
+  {
+    mp_entry->registered_layers.push_back (l);
+  }
+
+private:
+  LEFCacheEntry *mp_entry;
+  std::map<std::pair<std::string, LayerPurpose>, unsigned int> m_layers;
+};
+
+// -----------------------------------------------------------------------------------
+//  Cache file serialization
+
+static const char *cache_file_magic = "KLayout LEF cache";
+static const unsigned int cache_file_version = 1;
+
+enum cache_shape_type { ShapeBox = 0, ShapePolygon = 1, ShapePath = 2, ShapeText = 3 };
+
+class LEFCacheWriter
+{
+public:
+  LEFCacheWriter (tl::OutputStream &stream)
+    : mp_stream (&stream)
+  { }
+
+  void write_uint (uint64_t v)
+  {
+    char b[10];
+    size_t n = 0;
+    while (v >= 0x80) {
+      b[n++] = char ((v & 0x7f) | 0x80);
+      v >>= 7;
+    }
+    b[n++] = char (v);
+    mp_stream->put (b, n);
+  }
+
+  void write_int (int64_t v)
+  {
+    //  zig-zag encoding
+    write_uint (v < 0 ? ((uint64_t (-(v + 1)) << 1) | 1) : (uint64_t (v) << 1));
+  }
+
+  void write_double (double d)
+  {
+    uint64_t v = 0;
+    memcpy (&v, &d, sizeof (v));
+    char b[8];
+    for (unsigned int i = 0; i < 8; ++i) {
+      b[i] = char ((v >> (i * 8)) & 0xff);
+    }
+    mp_stream->put (b, 8);
+  }
+
+  void write_string (const std::string &s)
+  {
+    write_uint (s.size ());
+    mp_stream->put (s.c_str (), s.size ());
+  }
+
+  void write_point (const db::Point &p)
+  {
+    write_int (p.x ());
+    write_int (p.y ());
+  }
+
+  void write_trans (const db::Trans &t)
+  {
+    write_uint (t.rot ());
+    write_int (t.disp ().x ());
+    write_int (t.disp ().y ());
+  }
+
+  void write_box (const db::Box &b)
+  {
+    write_uint (b.empty () ? 1 : 0);
+    if (! b.empty ()) {
+      write_point (b.p1 ());
+      write_point (b.p2 ());
+    }
+  }
+
+private:
+  tl::OutputStream *mp_stream;
+};
+
+class LEFCacheReader
+{
+public:
+  LEFCacheReader (tl::InputStream &stream)
+    : mp_stream (&stream)
+  { }
+
+  uint64_t read_uint ()
+  {
+    uint64_t v = 0;
+    unsigned int shift = 0;
+    while (true) {
+      unsigned char c = (unsigned char) *get (1);
+      if (shift > 63) {
+        error ();
+      }
+      v |= uint64_t (c & 0x7f) << shift;
+      if ((c & 0x80) == 0) {
+        return v;
+      }
+      shift += 7;
+    }
+  }
+
+  int64_t read_int ()
+  {
+    uint64_t u = read_uint ();
+    return (u & 1) != 0 ? -int64_t (u >> 1) - 1 : int64_t (u >> 1);
+  }
+
+  double read_double ()
+  {
+    const char *b = get (8);
+    uint64_t v = 0;
+    for (unsigned int i = 0; i < 8; ++i) {
+      v |= uint64_t ((unsigned char) b[i]) << (i * 8);
+    }
+    double d = 0.0;
+    memcpy (&d, &v, sizeof (d));
+    return d;
+  }
+
+  std::string read_string ()
+  {
+    size_t n = size_t (read_uint ());
+    if (n == 0) {
+      return std::string ();
+    }
+    const char *b = get (n);
+    return std::string (b, n);
+  }
+
+  db::Point read_point ()
+  {
+    db::Coord x = db::Coord (read_int ());
+    db::Coord y = db::Coord (read_int ());
+    return db::Point (x, y);
+  }
+
+  db::Trans read_trans ()
+  {
+    int rot = int (read_uint ());
+    db::Coord x = db::Coord (read_int ());
+    db::Coord y = db::Coord (read_int ());
+    return db::Trans (rot, db::Vector (x, y));
+  }
+
+  db::Box read_box ()
+  {
+    if (read_uint () != 0) {
+      return db::Box ();
+    }
+    db::Point p1 = read_point ();
+    db::Point p2 = read_point ();
+    return db::Box (p1, p2);
+  }
+
+  tl::Variant read_variant ()
+  {
+    std::string s = read_string ();
+    tl::Variant v;
+    tl::Extractor ex (s.c_str ());
+    ex.read (v);
+    return v;
+  }
+
+  void error ()
+  {
+    throw tl::Exception (tl::to_string (tr ("Invalid or truncated LEF cache file: ")) + mp_stream->source ());
+  }
+
+private:
+  tl::InputStream *mp_stream;
+
+  const char *get (size_t n)
+  {
+    const char *b = mp_stream->get (n);
+    if (! b) {
+      error ();
+    }
+    return b;
+  }
+};
+
+static void
+write_key (LEFCacheWriter &writer, const LEFCacheKey &key)
+{
+  writer.write_uint (key.files.size ());
+  for (std::vector<LEFCacheKey::File>::const_iterator f = key.files.begin (); f != key.files.end (); ++f) {
+    writer.write_string (f->path);
+    writer.write_int (f->mtime);
+    writer.write_int (f->size);
+  }
+  writer.write_double (key.dbu);
+  writer.write_uint (key.produce_pin_names ? 1 : 0);
+  writer.write_string (key.pin_property_name);
+}
+
+static LEFCacheKey
+read_key (LEFCacheReader &reader)
+{
+  LEFCacheKey key;
+  size_t n = size_t (reader.read_uint ());
+  for (size_t i = 0; i < n; ++i) {
+    key.files.push_back (LEFCacheKey::File ());
+    key.files.back ().path = reader.read_string ();
+    key.files.back ().mtime = reader.read_int ();
+    key.files.back ().size = reader.read_int ();
+  }
+  key.dbu = reader.read_double ();
+  key.produce_pin_names = (reader.read_uint () != 0);
+  key.pin_property_name = reader.read_string ();
+  return key;
+}
+
+void
+LEFCache::save (const LEFCacheEntry &entry, const std::string &path)
+{
+  tl::SelfTimer timer (tl::verbosity () >= 11, tl::to_string (tr ("Writing LEF cache file")));
+
+  const db::Layout &layout = entry.layout;
+  const LEFImporter &importer = entry.importer;
+
+  tl::OutputStream stream (path, tl::OutputStream::OM_Zlib);
+  LEFCacheWriter writer (stream);
+
+  stream.put (cache_file_magic, strlen (cache_file_magic) + 1);
+  writer.write_uint (cache_file_version);
+
+  write_key (writer, entry.key);
+
+  writer.write_uint (entry.registered_layers.size ());
+  for (std::vector<std::string>::const_iterator l = entry.registered_layers.begin (); l != entry.registered_layers.end (); ++l) {
+    writer.write_string (*l);
+  }
+
+  writer.write_uint (entry.layers.size ());
+  for (std::vector<LEFCacheEntry::Layer>::const_iterator l = entry.layers.begin (); l != entry.layers.end (); ++l) {
+    writer.write_string (l->name);
+    writer.write_uint ((unsigned int) l->purpose);
+  }
+
+  //  properties in the order of their IDs
+
+  const db::PropertiesRepository &rep = layout.properties_repository ();
+
+  size_t nprops = 0;
+  for (db::PropertiesRepository::iterator p = rep.begin (); p != rep.end (); ++p) {
+    ++nprops;
+  }
+
+  writer.write_uint (nprops);
+  for (db::PropertiesRepository::iterator p = rep.begin (); p != rep.end (); ++p) {
+    writer.write_uint (p->first);
+    writer.write_uint (p->second.size ());
+    for (db::PropertiesRepository::properties_set::const_iterator pp = p->second.begin (); pp != p->second.end (); ++pp) {
+      writer.write_string (rep.prop_name (pp->first).to_parsable_string ());
+      writer.write_string (pp->second.to_parsable_string ());
+    }
+  }
+
+  //  cells
+
+  writer.write_uint (layout.cells ());
+  for (db::cell_index_type ci = 0; ci < db::cell_index_type (layout.cells ()); ++ci) {
+    writer.write_string (layout.cell_name (ci));
+  }
+
+  for (db::cell_index_type ci = 0; ci < db::cell_index_type (layout.cells ()); ++ci) {
+
+    const db::Cell &cell = layout.cell (ci);
+
+    for (std::vector<LEFCacheEntry::Layer>::const_iterator l = entry.layers.begin (); l != entry.layers.end (); ++l) {
+
+      const db::Shapes &shapes = cell.shapes (l->index);
+      writer.write_uint (shapes.size ());
+
+      for (db::ShapeIterator s = shapes.begin (db::ShapeIterator::All); ! s.at_end (); ++s) {
+
+        if (s->is_box ()) {
+
+          writer.write_uint (ShapeBox);
+          writer.write_uint (s->prop_id ());
+          writer.write_box (s->box ());
+
+        } else if (s->is_polygon ()) {
+
+          db::Polygon poly;
+          s->polygon (poly);
+
+          writer.write_uint (ShapePolygon);
+          writer.write_uint (s->prop_id ());
+          writer.write_uint (poly.holes () + 1);
+          for (unsigned int c = 0; c <= poly.holes (); ++c) {
+            const db::Polygon::contour_type &ctr = poly.contour (c);
+            writer.write_uint (ctr.size ());
+            for (size_t i = 0; i < ctr.size (); ++i) {
+              writer.write_point (ctr [i]);
+            }
+          }
+
+        } else if (s->is_path ()) {
+
+          db::Path path;
+          s->path (path);
+
+          writer.write_uint (ShapePath);
+          writer.write_uint (s->prop_id ());
+          writer.write_int (path.width ());
+          writer.write_int (path.extensions ().first);
+          writer.write_int (path.extensions ().second);
+          writer.write_uint (path.round () ? 1 : 0);
+          writer.write_uint (path.points ());
+          for (db::Path::iterator p = path.begin (); p != path.end (); ++p) {
+            writer.write_point (*p);
+          }
+
+        } else if (s->is_text ()) {
+
+          db::Text text;
+          s->text (text);
+
+          writer.write_uint (ShapeText);
+          writer.write_uint (s->prop_id ());
+          writer.write_string (text.string ());
+          writer.write_trans (text.trans ());
+          writer.write_int (text.size ());
+
+        } else {
+          throw tl::Exception (tl::to_string (tr ("Unsupported shape type for LEF cache file: ")) + s->to_string ());
+        }
+
+      }
+
+    }
+
+    writer.write_uint (cell.cell_instances ());
+    for (db::Cell::const_iterator i = cell.begin (); ! i.at_end (); ++i) {
+      const db::CellInstArray &inst = i->cell_inst ();
+      if (inst.is_complex () || inst.size () != 1) {
+        throw tl::Exception (tl::to_string (tr ("Unsupported instance type for LEF cache file")));
+      }
+      writer.write_uint (inst.object ().cell_index ());
+      writer.write_trans (inst.front ());
+    }
+
+  }
+
+  //  importer data
+
+  writer.write_uint (importer.m_nondefault_widths.size ());
+  for (std::map<std::string, std::map<std::string, double> >::const_iterator nd = importer.m_nondefault_widths.begin (); nd != importer.m_nondefault_widths.end (); ++nd) {
+    writer.write_string (nd->first);
+    writer.write_uint (nd->second.size ());
+    for (std::map<std::string, double>::const_iterator w = nd->second.begin (); w != nd->second.end (); ++w) {
+      writer.write_string (w->first);
+      writer.write_double (w->second);
+    }
+  }
+
+  writer.write_uint (importer.m_default_widths.size ());
+  for (std::map<std::string, double>::const_iterator w = importer.m_default_widths.begin (); w != importer.m_default_widths.end (); ++w) {
+    writer.write_string (w->first);
+    writer.write_double (w->second);
+  }
+
+  writer.write_uint (importer.m_default_ext.size ());
+  for (std::map<std::string, double>::const_iterator w = importer.m_default_ext.begin (); w != importer.m_default_ext.end (); ++w) {
+    writer.write_string (w->first);
+    writer.write_double (w->second);
+  }
+
+  writer.write_uint (importer.m_macros_by_name.size ());
+  for (std::map<std::string, db::Cell *>::const_iterator m = importer.m_macros_by_name.begin (); m != importer.m_macros_by_name.end (); ++m) {
+    writer.write_string (m->first);
+    writer.write_uint (m->second->cell_index ());
+  }
+
+  writer.write_uint (importer.m_macro_bboxes_by_name.size ());
+  for (std::map<std::string, db::Box>::const_iterator m = importer.m_macro_bboxes_by_name.begin (); m != importer.m_macro_bboxes_by_name.end (); ++m) {
+    writer.write_string (m->first);
+    writer.write_box (m->second);
+  }
+
+  writer.write_uint (importer.m_vias.size ());
+  for (std::map<std::string, ViaDesc>::const_iterator v = importer.m_vias.begin (); v != importer.m_vias.end (); ++v) {
+    writer.write_string (v->first);
+    if (v->second.cell) {
+      writer.write_uint (v->second.cell->cell_index () + 1);
+    } else {
+      writer.write_uint (0);
+    }
+    writer.write_string (v->second.m1);
+    writer.write_string (v->second.m2);
+  }
+
+  stream.flush ();
+}
+
+LEFCacheEntry *
+LEFCache::load (const std::string &path, const LEFCacheKey &key)
+{
+  tl::SelfTimer timer (tl::verbosity () >= 11, tl::to_string (tr ("Reading LEF cache file")));
+
+  tl::InputStream stream (path);
+  LEFCacheReader reader (stream);
+
+  const char *magic = stream.get (strlen (cache_file_magic) + 1);
+  if (! magic || strcmp (magic, cache_file_magic) != 0) {
+    reader.error ();
+  }
+  if (reader.read_uint () != cache_file_version) {
+    return 0;
+  }
+
+  if (! (read_key (reader) == key)) {
+    return 0;
+  }
+
+  std::auto_ptr<LEFCacheEntry> entry (new LEFCacheEntry ());
+  entry->key = key;
+
+  db::Layout &layout = entry->layout;
+  layout.dbu (key.dbu);
+
+  LEFImporter &importer = entry->importer;
+
+  size_t n = size_t (reader.read_uint ());
+  for (size_t i = 0; i < n; ++i) {
+    entry->registered_layers.push_back (reader.read_string ());
+  }
+
+  n = size_t (reader.read_uint ());
+  for (size_t i = 0; i < n; ++i) {
+    std::string name = reader.read_string ();
+    LayerPurpose purpose = LayerPurpose (reader.read_uint ());
+    entry->layers.push_back (LEFCacheEntry::Layer (name, purpose, layout.insert_layer (db::LayerProperties ())));
+  }
+
+  //  properties
+
+  std::map<db::properties_id_type, db::properties_id_type> prop_ids;
+
+  n = size_t (reader.read_uint ());
+  for (size_t i = 0; i < n; ++i) {
+    db::properties_id_type id = db::properties_id_type (reader.read_uint ());
+    db::PropertiesRepository::properties_set props;
+    size_t np = size_t (reader.read_uint ());
+    for (size_t j = 0; j < np; ++j) {
+      tl::Variant name = reader.read_variant ();
+      tl::Variant value = reader.read_variant ();
+      props.insert (std::make_pair (layout.properties_repository ().prop_name_id (name), value));
+    }
+    prop_ids.insert (std::make_pair (id, layout.properties_repository ().properties_id (props)));
+  }
+
+  //  cells
+
+  std::vector<db::cell_index_type> cells;
+
+  n = size_t (reader.read_uint ());
+  for (size_t i = 0; i < n; ++i) {
+    std::string name = reader.read_string ();
+    cells.push_back (layout.add_cell (name.c_str ()));
+  }
+
+  for (std::vector<db::cell_index_type>::const_iterator ci = cells.begin (); ci != cells.end (); ++ci) {
+
+    db::Cell &cell = layout.cell (*ci);
+
+    for (std::vector<LEFCacheEntry::Layer>::const_iterator l = entry->layers.begin (); l != entry->layers.end (); ++l) {
+
+      db::Shapes &shapes = cell.shapes (l->index);
+
+      size_t nshapes = size_t (reader.read_uint ());
+      for (size_t i = 0; i < nshapes; ++i) {
+
+        unsigned int type = (unsigned int) reader.read_uint ();
+
+        db::properties_id_type prop_id = db::properties_id_type (reader.read_uint ());
+        if (prop_id != 0) {
+          std::map<db::properties_id_type, db::properties_id_type>::const_iterator pi = prop_ids.find (prop_id);
+          if (pi == prop_ids.end ()) {
+            reader.error ();
+          }
+          prop_id = pi->second;
+        }
+
+        if (type == ShapeBox) {
+
+          db::Box box = reader.read_box ();
+          if (prop_id != 0) {
+            shapes.insert (db::object_with_properties<db::Box> (box, prop_id));
+          } else {
+            shapes.insert (box);
+          }
+
+        } else if (type == ShapePolygon) {
+
+          db::Polygon poly;
+
+          size_t ncontours = size_t (reader.read_uint ());
+          for (size_t c = 0; c < ncontours; ++c) {
+            std::vector<db::Point> pts;
+            size_t npts = size_t (reader.read_uint ());
+            pts.reserve (npts);
+            for (size_t j = 0; j < npts; ++j) {
+              pts.push_back (reader.read_point ());
+            }
+            if (c == 0) {
+              poly.assign_hull (pts.begin (), pts.end (), false /*don't compress*/);
+            } else {
+              poly.insert_hole (pts.begin (), pts.end (), false /*don't compress*/);
+            }
+          }
+
+          if (prop_id != 0) {
+            shapes.insert (db::object_with_properties<db::Polygon> (poly, prop_id));
+          } else {
+            shapes.insert (poly);
+          }
+
+        } else if (type == ShapePath) {
+
+          db::Coord w = db::Coord (reader.read_int ());
+          db::Coord bgn_ext = db::Coord (reader.read_int ());
+          db::Coord end_ext = db::Coord (reader.read_int ());
+          bool round = (reader.read_uint () != 0);
+
+          std::vector<db::Point> pts;
+          size_t npts = size_t (reader.read_uint ());
+          pts.reserve (npts);
+          for (size_t j = 0; j < npts; ++j) {
+            pts.push_back (reader.read_point ());
+          }
+
+          db::Path path (pts.begin (), pts.end (), w, bgn_ext, end_ext, round);
+          if (prop_id != 0) {
+            shapes.insert (db::object_with_properties<db::Path> (path, prop_id));
+          } else {
+            shapes.insert (path);
+          }
+
+        } else if (type == ShapeText) {
+
+          std::string s = reader.read_string ();
+          db::Trans t = reader.read_trans ();
+          db::Coord size = db::Coord (reader.read_int ());
+
+          db::Text text (s, t, size);
+          if (prop_id != 0) {
+            shapes.insert (db::object_with_properties<db::Text> (text, prop_id));
+          } else {
+            shapes.insert (text);
+          }
+
+        } else {
+          reader.error ();
+        }
+
+      }
+
+    }
+
+    size_t ninst = size_t (reader.read_uint ());
+    for (size_t i = 0; i < ninst; ++i) {
+      size_t ci = size_t (reader.read_uint ());
+      if (ci >= cells.size ()) {
+        reader.error ();
+      }
+      db::Trans t = reader.read_trans ();
+      cell.insert (db::CellInstArray (db::CellInst (cells [ci]), t));
+    }
+
+  }
+
+  //  importer data
+
+  n = size_t (reader.read_uint ());
+  for (size_t i = 0; i < n; ++i) {
+    std::map<std::string, double> &widths = importer.m_nondefault_widths [reader.read_string ()];
+    size_t nw = size_t (reader.read_uint ());
+    for (size_t j = 0; j < nw; ++j) {
+      std::string l = reader.read_string ();
+      widths [l] = reader.read_double ();
+    }
+  }
+
+  n = size_t (reader.read_uint ());
+  for (size_t i = 0; i < n; ++i) {
+    std::string l = reader.read_string ();
+    importer.m_default_widths [l] = reader.read_double ();
+  }
+
+  n = size_t (reader.read_uint ());
+  for (size_t i = 0; i < n; ++i) {
+    std::string l = reader.read_string ();
+    importer.m_default_ext [l] = reader.read_double ();
+  }
+
+  n = size_t (reader.read_uint ());
+  for (size_t i = 0; i < n; ++i) {
+    std::string m = reader.read_string ();
+    size_t ci = size_t (reader.read_uint ());
+    if (ci >= cells.size ()) {
+      reader.error ();
+    }
+    importer.m_macros_by_name [m] = &layout.cell (cells [ci]);
+  }
+
+  n = size_t (reader.read_uint ());
+  for (size_t i = 0; i < n; ++i) {
+    std::string m = reader.read_string ();
+    importer.m_macro_bboxes_by_name [m] = reader.read_box ();
+  }
+
+  n = size_t (reader.read_uint ());
+  for (size_t i = 0; i < n; ++i) {
+    ViaDesc &vd = importer.m_vias [reader.read_string ()];
+    size_t ci = size_t (reader.read_uint ());
+    if (ci > cells.size ()) {
+      reader.error ();
+    }
+    vd.cell = ci > 0 ? &layout.cell (cells [ci - 1]) : 0;
+    vd.m1 = reader.read_string ();
+    vd.m2 = reader.read_string ();
+  }
+
+  return entry.release ();
+}
+
+// -----------------------------------------------------------------------------------
+//  LEFCache implementation
+
+LEFCache &
+LEFCache::instance ()
+{
+  static LEFCache s_instance;
+  return s_instance;
+}
+
+LEFCache::LEFCache ()
+  : m_max_entries (4)
+{
+  //  .. nothing yet ..
+}
+
+LEFCache::~LEFCache ()
+{
+  clear ();
+}
+
+void
+LEFCache::clear ()
+{
+  tl::MutexLocker locker (&m_lock);
+
+  for (std::list<LEFCacheEntry *>::const_iterator e = m_entries.begin (); e != m_entries.end (); ++e) {
+    delete *e;
+  }
+  m_entries.clear ();
+}
+
+size_t
+LEFCache::size () const
+{
+  tl::MutexLocker locker (&m_lock);
+  return m_entries.size ();
+}
+
+void
+LEFCache::set_max_entries (size_t n)
+{
+  tl::MutexLocker locker (&m_lock);
+  m_max_entries = n;
+  trim ();
+}
+
+void
+LEFCache::trim ()
+{
+  while (m_entries.size () > m_max_entries) {
+    delete m_entries.back ();
+    m_entries.pop_back ();
+  }
+}
+
+void
+LEFCache::add (LEFCacheEntry *entry)
+{
+  m_entries.push_front (entry);
+}
+
+LEFCacheEntry *
+LEFCache::find (const LEFCacheKey &key)
+{
+  for (std::list<LEFCacheEntry *>::iterator e = m_entries.begin (); e != m_entries.end (); ++e) {
+    if ((*e)->key == key) {
+      //  most recently used entries go first
+      LEFCacheEntry *entry = *e;
+      m_entries.erase (e);
+      m_entries.push_front (entry);
+      return entry;
+    }
+  }
+  return 0;
+}
+
+LEFCacheEntry *
+LEFCache::create (const LEFCacheKey &key, const std::vector<std::string> &paths, const LEFDEFReaderOptions *options)
+{
+  std::auto_ptr<LEFCacheEntry> entry (new LEFCacheEntry ());
+  entry->key = key;
+  entry->layout.dbu (key.dbu);
+
+  LEFCacheLayerDelegate ld (options, entry.get ());
+
+  for (std::vector<std::string>::const_iterator p = paths.begin (); p != paths.end (); ++p) {
+    tl::InputStream stream (*p);
+    tl::log << tl::to_string (tr ("Reading")) << " " << *p;
+    entry->importer.read (stream, entry->layout, ld);
+  }
+
+  return entry.release ();
+}
+
+void
+LEFCache::replay (const LEFCacheEntry &entry, LEFImporter &importer, db::Layout &layout, LEFDEFLayerDelegate &ld)
+{
+  const db::Layout &source = entry.layout;
+
+  for (std::vector<std::string>::const_iterator l = entry.registered_layers.begin (); l != entry.registered_layers.end (); ++l) {
+    ld.register_layer (*l);
+  }
+
+  //  create the cells in the original order
+
+  std::vector<db::cell_index_type> cell_map;
+  cell_map.reserve (source.cells ());
+  for (db::cell_index_type ci = 0; ci < db::cell_index_type (source.cells ()); ++ci) {
+    cell_map.push_back (layout.add_cell (source.cell_name (ci)));
+  }
+
+  //  open the layers in the original order. Labels are only produced for pin layers
+  //  which are produced, hence the label layers are opened only in that case.
+
+  std::vector<std::pair<bool, unsigned int> > layer_map;
+  std::map<std::string, bool> pins_produced;
+
+  for (std::vector<LEFCacheEntry::Layer>::const_iterator l = entry.layers.begin (); l != entry.layers.end (); ++l) {
+
+    std::pair<bool, unsigned int> dl (false, 0);
+
+    if (l->purpose == Label) {
+      std::map<std::string, bool>::const_iterator p = pins_produced.find (l->name);
+      if (p != pins_produced.end () && p->second) {
+        dl = ld.open_layer (layout, l->name, l->purpose);
+      }
+    } else {
+      dl = ld.open_layer (layout, l->name, l->purpose);
+      if (l->purpose == Pins) {
+        pins_produced [l->name] = dl.first;
+      }
+    }
+
+    layer_map.push_back (dl);
+
+  }
+
+  //  map the properties in the original order
+
+  db::PropertyMapper pm (layout, source);
+  for (db::PropertiesRepository::iterator p = source.properties_repository ().begin (); p != source.properties_repository ().end (); ++p) {
+    pm (p->first);
+  }
+
+  //  copy the shapes and instances
+
+  for (db::cell_index_type ci = 0; ci < db::cell_index_type (source.cells ()); ++ci) {
+
+    const db::Cell &source_cell = source.cell (ci);
+    db::Cell &target_cell = layout.cell (cell_map [ci]);
+
+    for (size_t i = 0; i < entry.layers.size (); ++i) {
+      if (layer_map [i].first) {
+        target_cell.shapes (layer_map [i].second).insert_transformed (source_cell.shapes (entry.layers [i].index), db::Trans (), pm);
+      }
+    }
+
+    for (db::Cell::const_iterator inst = source_cell.begin (); ! inst.at_end (); ++inst) {
+      db::CellInstArray ci_array = inst->cell_inst ();
+      ci_array.object () = db::CellInst (cell_map [ci_array.object ().cell_index ()]);
+      target_cell.insert (ci_array);
+    }
+
+  }
+
+  //  transfer the technology and macro information
+
+  importer.m_nondefault_widths = entry.importer.m_nondefault_widths;
+  importer.m_default_widths = entry.importer.m_default_widths;
+  importer.m_default_ext = entry.importer.m_default_ext;
+  importer.m_macro_bboxes_by_name = entry.importer.m_macro_bboxes_by_name;
+
+  importer.m_macros_by_name.clear ();
+  for (std::map<std::string, db::Cell *>::const_iterator m = entry.importer.m_macros_by_name.begin (); m != entry.importer.m_macros_by_name.end (); ++m) {
+    importer.m_macros_by_name.insert (std::make_pair (m->first, &layout.cell (cell_map [m->second->cell_index ()])));
+  }
+
+  importer.m_vias.clear ();
+  for (std::map<std::string, ViaDesc>::const_iterator v = entry.importer.m_vias.begin (); v != entry.importer.m_vias.end (); ++v) {
+    ViaDesc &vd = importer.m_vias [v->first];
+    vd = v->second;
+    if (vd.cell) {
+      vd.cell = &layout.cell (cell_map [vd.cell->cell_index ()]);
+    }
+  }
+}
+
+void
+LEFCache::read_lef_files (LEFImporter &importer, const std::vector<std::string> &paths, db::Layout &layout, LEFDEFLayerDelegate &ld, const std::string &cache_file)
+{
+  //  the cell indexes are taken from the cache, so the layout must not have cells yet
+  tl_assert (layout.cells () == 0);
+
+  LEFCacheKey key (paths, layout.dbu (), ld.tech_comp ());
+
+  tl::MutexLocker locker (&m_lock);
+
+  LEFCacheEntry *entry = find (key);
+
+  if (! entry && ! cache_file.empty () && tl::file_exists (cache_file)) {
+
+    try {
+      entry = load (cache_file, key);
+    } catch (tl::Exception &ex) {
+      tl::warn << ex.msg ();
+    }
+
+    if (entry) {
+      tl::log << tl::to_string (tr ("Taking LEF data from cache file")) << " " << cache_file;
+      add (entry);
+    }
+
+  } else if (entry) {
+    tl::log << tl::to_string (tr ("Taking LEF data from cache"));
+  }
+
+  if (! entry) {
+
+    entry = create (key, paths, ld.tech_comp ());
+    add (entry);
+
+    if (! cache_file.empty ()) {
+      try {
+        save (*entry, cache_file);
+      } catch (tl::Exception &ex) {
+        tl::warn << ex.msg ();
+      }
+    }
+
+  }
+
+  replay (*entry, importer, layout, ld);
+
+  //  NOTE: trim after replay - with a small cache size, trimming may delete the entry
+  trim ();
+}
+
+}
+
@@ -0,0 +1,164 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+
+#ifndef HDR_dbLEFCache
+#define HDR_dbLEFCache
+
+#include "dbPluginCommon.h"
+#include "dbLEFImporter.h"
+#include "dbLayout.h"
+#include "tlThreads.h"
+
+#include <vector>
+#include <string>
+#include <list>
+
+#include <stdint.h>
+
+namespace db
+{
+
+struct LEFCacheEntry;
+
+/**
+ *  @brief The key of a LEF cache entry
+ *
+ *  The key identifies a set of LEF files by their paths, modification times and
+ *  sizes. It also includes the options which affect the way the LEF files are read.
+ *  The options which only control the layer production are not part of the key:
+ *  these are applied when the cached data is put into the layout.
+ */
+struct DB_PLUGIN_PUBLIC LEFCacheKey
+{
+  LEFCacheKey ()
+    : dbu (0.0), produce_pin_names (false)
+  { }
+
+  LEFCacheKey (const std::vector<std::string> &paths, double dbu, const LEFDEFReaderOptions *options);
+
+  bool operator== (const LEFCacheKey &other) const;
+
+  struct File
+  {
+    File () : mtime (0), size (0) { }
+
+    bool operator== (const File &other) const
+    {
+      return path == other.path && mtime == other.mtime && size == other.size;
+    }
+
+    std::string path;
+    int64_t mtime, size;
+  };
+
+  std::vector<File> files;
+  double dbu;
+  bool produce_pin_names;
+  std::string pin_property_name;
+};
+
+/**
+ *  @brief A process-wide cache for the LEF data read along with DEF files
+ *
+ *  Batch flows frequently read many DEF files against the same set of LEF files.
+ *  The cache keeps the macro and via cells and the technology information of the
+ *  LEF files, so subsequent DEF reads don't need to parse the LEF files again.
+ *
+ *  The LEF files are read into a separate layout. The layers are opened in this
+ *  layout without applying the reader options. When the cached data is put into
+ *  the target layout, the layers are opened through the target's layer delegate
+ *  in the original order. Hence the result is the same as reading the LEF files
+ *  directly.
+ *
+ *  Optionally, the cache data can be stored in a file. This way, the LEF data can
+ *  be shared between processes.
+ */
+class DB_PLUGIN_PUBLIC LEFCache
+{
+public:
+  /**
+   *  @brief Gets the singleton instance
+   */
+  static LEFCache &instance ();
+
+  /**
+   *  @brief Destructor
+   */
+  ~LEFCache ();
+
+  /**
+   *  @brief Reads the given LEF files into the importer using the cache
+   *
+   *  The layout must not have cells yet. The importer receives the technology and
+   *  macro information as if it had read the LEF files itself.
+   *  If "cache_file" is not empty, the cache data is taken from this file if it
+   *  is valid. Otherwise, the LEF files are read and the data is stored in the file.
+   */
+  void read_lef_files (LEFImporter &importer, const std::vector<std::string> &paths, db::Layout &layout, LEFDEFLayerDelegate &ld, const std::string &cache_file = std::string ());
+
+  /**
+   *  @brief Clears the cache
+   */
+  void clear ();
+
+  /**
+   *  @brief Gets the number of cache entries
+   */
+  size_t size () const;
+
+  /**
+   *  @brief Sets the maximum number of cache entries
+   *
+   *  If there are more entries, the least recently used ones are dropped.
+   */
+  void set_max_entries (size_t n);
+
+  /**
+   *  @brief Gets the maximum number of cache entries
+   */
+  size_t max_entries () const
+  {
+    return m_max_entries;
+  }
+
+private:
+  mutable tl::Mutex m_lock;
+  std::list<LEFCacheEntry *> m_entries;
+  size_t m_max_entries;
+
+  LEFCache ();
+
+  void add (LEFCacheEntry *entry);
+  void trim ();
+  LEFCacheEntry *find (const LEFCacheKey &key);
+  LEFCacheEntry *create (const LEFCacheKey &key, const std::vector<std::string> &paths, const LEFDEFReaderOptions *options);
+  void replay (const LEFCacheEntry &entry, LEFImporter &importer, db::Layout &layout, LEFDEFLayerDelegate &ld);
+  static void save (const LEFCacheEntry &entry, const std::string &path);
+  static LEFCacheEntry *load (const std::string &path, const LEFCacheKey &key);
+};
+
+}
+
+#endif
+
@@ -25,6 +25,7 @@
 
 #include "tlStream.h"
 #include "tlProgress.h"
+#include "tlAssert.h"
 
 #include <cctype>
 
@@ -66,7 +67,9 @@ LEFDEFReaderOptions::LEFDEFReaderOptions ()
     m_labels_datatype (1),
     m_produce_routing (true),
     m_routing_suffix (""),
-    m_routing_datatype (0)
+    m_routing_datatype (0),
+    m_threads (0),
+    m_cache_lef_files (false)
 {
   //  .. nothing yet ..
 }
@@ -115,6 +118,9 @@ LEFDEFReaderOptions &LEFDEFReaderOptions::operator= (const LEFDEFReaderOptions &
     m_routing_suffix = d.m_routing_suffix;
     m_routing_datatype = d.m_routing_datatype;
     m_lef_files = d.m_lef_files;
+    m_threads = d.m_threads;
+    m_cache_lef_files = d.m_cache_lef_files;
+    m_lef_cache_file = d.m_lef_cache_file;
   }
   return *this;
 }
@@ -368,7 +374,7 @@ LEFDEFLayerDelegate::finish (db::Layout &layout)
 //  LEFDEFImporter implementation
 
 LEFDEFImporter::LEFDEFImporter ()
-  : mp_progress (0), mp_stream (0), mp_layer_delegate (0),
+  : mp_progress (0), mp_stream (0), m_line_offset (0), mp_layer_delegate (0),
     m_produce_net_props (false), m_net_prop_name_id (0),
     m_produce_inst_props (false), m_inst_prop_name_id (0),
     m_produce_pin_props (false), m_pin_prop_name_id (0)
@@ -438,14 +444,14 @@ LEFDEFImporter::read (tl::InputStream &stream, db::Layout &layout, LEFDEFLayerDe
 void 
 LEFDEFImporter::error (const std::string &msg)
 {
-  throw LEFDEFReaderException (msg, int (mp_stream->line_number ()), m_cellname, m_fn);
+  throw LEFDEFReaderException (msg, int (mp_stream->line_number () + m_line_offset), m_cellname, m_fn);
 }
 
 void 
 LEFDEFImporter::warn (const std::string &msg)
 {
   tl::warn << msg 
-           << tl::to_string (tr (" (line=")) << mp_stream->line_number ()
+           << tl::to_string (tr (" (line=")) << mp_stream->line_number () + m_line_offset
            << tl::to_string (tr (", cell=")) << m_cellname
            << tl::to_string (tr (", file=")) << m_fn
            << ")";
@@ -621,13 +627,123 @@ LEFDEFImporter::next ()
 
   } while (c);
 
-  if (mp_stream->line_number () != last_line) {
+  if (mp_progress && mp_stream->line_number () != last_line) {
     ++*mp_progress;
   }
 
   return m_last_token;
 }
 
+void
+LEFDEFImporter::read_statement (LEFDEFSection &section)
+{
+  //  a token which has been peeked already would be missing in the text
+  tl_assert (m_last_token.empty ());
+
+  //  This is a raw scan for the terminating ";" token: it follows the token rules of "next", but
+  //  does not build the tokens. The text is taken over block-wise from the stream's buffer.
+
+  enum { Space, Token, Quoted, Comment } state = Space;
+  char quot = 0;
+  bool escaped = false;
+  size_t token_length = 0;
+  bool semicolon = false;
+  bool done = false;
+
+  while (! done) {
+
+    size_t n = 0;
+    const char *b = mp_stream->peek_block (n);
+    if (! b) {
+      break;
+    }
+
+    const char *c = b;
+    for (const char *e = b + n; c != e && ! done; ++c) {
+
+      char ch = *c;
+
+      //  CR and null characters are ignored by the text stream
+      if (ch == '\r' || ch == 0) {
+        continue;
+      }
+
+      if (state == Comment) {
+
+        if (ch == '\n') {
+          state = Space;
+        }
+
+      } else if (state == Space) {
+
+        if (ch == '#') {
+          state = Comment;
+        } else if (ch == '\'' || ch == '"') {
+          state = Quoted;
+          quot = ch;
+          token_length = 0;
+        } else if (! isspace (ch)) {
+          //  NOTE: the first character is taken literally
+          state = Token;
+          token_length = 1;
+          semicolon = (ch == ';');
+        }
+
+      } else if (escaped) {
+
+        escaped = false;
+        if (token_length++ == 0) {
+          semicolon = (ch == ';');
+        }
+
+      } else if (ch == '\\') {
+
+        escaped = true;
+
+      } else if (state == Quoted ? ch == quot : isspace (ch)) {
+
+        done = (token_length == 1 && semicolon);
+        state = Space;
+
+      } else if (token_length++ == 0) {
+
+        semicolon = (ch == ';');
+
+      }
+
+    }
+
+    section.add (b, c - b, mp_stream->next_line_number ());
+
+    size_t last_line = mp_stream->line_number ();
+    mp_stream->skip_block (c - b);
+    if (mp_progress && mp_stream->line_number () != last_line) {
+      ++*mp_progress;
+    }
+
+  }
+}
+
+void
+LEFDEFImporter::enter_section (tl::InputStream &stream, const std::string &fn, size_t line_offset)
+{
+  leave_section ();
+
+  m_fn = fn;
+  m_line_offset = line_offset;
+  m_last_token.clear ();
+  mp_progress = 0;
+  mp_stream = new tl::TextInputStream (stream);
+}
+
+void
+LEFDEFImporter::leave_section ()
+{
+  delete mp_stream;
+  mp_stream = 0;
+  m_line_offset = 0;
+}
+
 static bool is_hex_digit (char c)
 {
   char cup = toupper (c);
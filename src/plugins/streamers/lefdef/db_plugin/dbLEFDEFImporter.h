@@ -34,6 +34,7 @@
 #include <vector>
 #include <string>
 #include <map>
+#include <algorithm>
 
 namespace tl
 {
@@ -436,6 +437,36 @@ public:
     m_lef_files = lf;
   }
 
+  unsigned int threads () const
+  {
+    return m_threads;
+  }
+
+  void set_threads (unsigned int n)
+  {
+    m_threads = n;
+  }
+
+  bool cache_lef_files () const
+  {
+    return m_cache_lef_files;
+  }
+
+  void set_cache_lef_files (bool f)
+  {
+    m_cache_lef_files = f;
+  }
+
+  const std::string &lef_cache_file () const
+  {
+    return m_lef_cache_file;
+  }
+
+  void set_lef_cache_file (const std::string &f)
+  {
+    m_lef_cache_file = f;
+  }
+
 private:
   bool m_read_all_layers;
   db::LayerMap m_layer_map;
@@ -471,6 +502,9 @@ private:
   std::string m_routing_suffix;
   int m_routing_datatype;
   std::vector<std::string> m_lef_files;
+  unsigned int m_threads;
+  bool m_cache_lef_files;
+  std::string m_lef_cache_file;
 };
 
 /**
@@ -519,15 +553,20 @@ public:
     return m_layer_map;
   }
 
+  /**
+   *  @brief Destructor
+   */
+  virtual ~LEFDEFLayerDelegate () { }
+
   /**
    *  @brief Create a new layer or return the index of the given layer
    */
-  std::pair <bool, unsigned int> open_layer (db::Layout &layout, const std::string &name, LayerPurpose purpose);
+  virtual std::pair <bool, unsigned int> open_layer (db::Layout &layout, const std::string &name, LayerPurpose purpose);
 
   /**
    *  @brief Registers a layer (assign a new default layer number)
    */
-  void register_layer (const std::string &l);
+  virtual void register_layer (const std::string &l);
 
   /**
    *  @brief Prepare, i.e. create layers required by the layer map
@@ -574,6 +613,42 @@ struct DB_PLUGIN_PUBLIC ViaDesc
   std::string m1, m2;
 };
 
+/**
+ *  @brief A piece of text cut from a LEF or DEF file
+ *
+ *  The text is made from one or more statements. Line breaks are inserted between the
+ *  statements such that the line numbers inside the text plus "line_offset" give the
+ *  line numbers inside the file.
+ */
+struct DB_PLUGIN_PUBLIC LEFDEFSection
+{
+  LEFDEFSection ()
+    : line_offset (0), last_line (0)
+  { }
+
+  /**
+   *  @brief Adds a block of "n" characters from the file
+   *
+   *  "line" is the line of the file the first character was read from.
+   */
+  void add (const char *b, size_t n, size_t line)
+  {
+    if (text.empty ()) {
+      line_offset = line - 1;
+      last_line = line;
+    }
+    while (last_line < line) {
+      text += '\n';
+      ++last_line;
+    }
+    text.append (b, n);
+    last_line += std::count (b, b + n, '\n');
+  }
+
+  std::string text;
+  size_t line_offset, last_line;
+};
+
 /**
  *  @brief The LEF importer object
  */
@@ -735,6 +810,46 @@ protected:
     return m_pin_prop_name_id;
   }
 
+  /**
+   *  @brief Gets the name of the file being read
+   */
+  const std::string &filename () const
+  {
+    return m_fn;
+  }
+
+  /**
+   *  @brief Gets the reader options or 0 if there are no options
+   */
+  const LEFDEFReaderOptions *tech_comp () const
+  {
+    return mp_layer_delegate ? mp_layer_delegate->tech_comp () : 0;
+  }
+
+  /**
+   *  @brief Reads the text of a statement into the given section
+   *
+   *  This method reads the tokens up to and including the terminating ";" and appends
+   *  the text to the section. The text can be parsed later by a separate importer
+   *  using "enter_section". The tokens are not interpreted.
+   */
+  void read_statement (LEFDEFSection &section);
+
+  /**
+   *  @brief Makes the importer read from the text of a section
+   *
+   *  "stream" is the stream delivering the section's text. "fn" is the file name
+   *  and "line_offset" the line offset of the section for error messages. While
+   *  reading a section, no progress is reported. Hence this method can be used
+   *  inside worker threads. Use "leave_section" to detach the importer from the stream.
+   */
+  void enter_section (tl::InputStream &stream, const std::string &fn, size_t line_offset);
+
+  /**
+   *  @brief Detaches the importer from the section's stream
+   */
+  void leave_section ();
+
 protected:
   void create_generated_via (std::vector<db::Polygon> &bottom,
                              std::vector<db::Polygon> &cut,
@@ -750,6 +865,7 @@ protected:
 private:
   tl::AbsoluteProgress *mp_progress;
   tl::TextInputStream *mp_stream;
+  size_t m_line_offset;
   LEFDEFLayerDelegate *mp_layer_delegate;
   std::string m_cellname;
   std::string m_fn;
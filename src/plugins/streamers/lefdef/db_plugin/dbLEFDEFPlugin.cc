@@ -30,6 +30,7 @@
 #include "dbLEFImporter.h"
 #include "dbDEFImporter.h"
 #include "dbLEFDEFImporter.h"
+#include "dbLEFCache.h"
 
 namespace db
 {
@@ -153,14 +154,10 @@ private:
 
       DEFImporter importer;
 
-      for (std::vector<std::string>::const_iterator l = lefdef_options->begin_lef_files (); l != lefdef_options->end_lef_files (); ++l) {
-
-        std::string lp = correct_path (*l);
-
-        tl::InputStream lef_stream (lp);
-        tl::log << tl::to_string (tr ("Reading")) << " " << lp;
-        importer.read_lef (lef_stream, layout, layers);
+      std::vector<std::string> lef_paths;
 
+      for (std::vector<std::string>::const_iterator l = lefdef_options->begin_lef_files (); l != lefdef_options->end_lef_files (); ++l) {
+        lef_paths.push_back (correct_path (*l));
       }
 
       //  Additionally read all LEF files next to the DEF file
@@ -170,16 +167,24 @@ private:
 
         std::vector<std::string> entries = tl::dir_entries (input_dir);
         for (std::vector<std::string>::const_iterator e = entries.begin (); e != entries.end (); ++e) {
-
           if (is_lef_format (*e)) {
+            lef_paths.push_back (tl::combine_path (input_dir, *e));
+          }
+        }
 
-            std::string lp = tl::combine_path (input_dir, *e);
-            tl::InputStream lef_stream (lp);
-            tl::log << tl::to_string (tr ("Reading")) << " " << lp;
-            importer.read_lef (lef_stream, layout, layers);
+      }
 
-          }
+      //  The cache provides the cells from the LEF files, so it can only be used on empty layouts
+      if (lefdef_options->cache_lef_files () && layout.cells () == 0) {
+
+        db::LEFCache::instance ().read_lef_files (importer.lef_importer (), lef_paths, layout, layers, lefdef_options->lef_cache_file ());
+
+      } else {
 
+        for (std::vector<std::string>::const_iterator lp = lef_paths.begin (); lp != lef_paths.end (); ++lp) {
+          tl::InputStream lef_stream (*lp);
+          tl::log << tl::to_string (tr ("Reading")) << " " << *lp;
+          importer.read_lef (lef_stream, layout, layers);
         }
 
       }
@@ -265,7 +270,10 @@ class LEFDEFFormatDeclaration
       tl::make_member (&LEFDEFReaderOptions::produce_routing, &LEFDEFReaderOptions::set_produce_routing, "produce-routing") +
       tl::make_member (&LEFDEFReaderOptions::routing_suffix, &LEFDEFReaderOptions::set_routing_suffix, "routing-suffix") +
       tl::make_member (&LEFDEFReaderOptions::routing_datatype, &LEFDEFReaderOptions::set_routing_datatype, "routing-datatype") +
-      tl::make_member (&LEFDEFReaderOptions::begin_lef_files, &LEFDEFReaderOptions::end_lef_files, &LEFDEFReaderOptions::push_lef_file, "lef-files")
+      tl::make_member (&LEFDEFReaderOptions::begin_lef_files, &LEFDEFReaderOptions::end_lef_files, &LEFDEFReaderOptions::push_lef_file, "lef-files") +
+      tl::make_member (&LEFDEFReaderOptions::threads, &LEFDEFReaderOptions::set_threads, "threads") +
+      tl::make_member (&LEFDEFReaderOptions::cache_lef_files, &LEFDEFReaderOptions::set_cache_lef_files, "cache-lef-files") +
+      tl::make_member (&LEFDEFReaderOptions::lef_cache_file, &LEFDEFReaderOptions::set_lef_cache_file, "lef-cache-file")
     );
   }
 };
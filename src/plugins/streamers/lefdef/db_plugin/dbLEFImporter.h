@@ -100,6 +100,8 @@ protected:
   void do_read (db::Layout &layout);
 
 private:
+  friend class LEFCache;
+
   std::map<std::string, std::map<std::string, double> > m_nondefault_widths;
   std::map<std::string, double> m_default_widths;
   std::map<std::string, double> m_default_ext;
@@ -7,6 +7,7 @@ include($$PWD/../../../db_plugin.pri)
 HEADERS = \
   dbDEFImporter.h \
   dbLEFDEFImporter.h \
+  dbLEFCache.h \
   dbLEFImporter.h
 
 SOURCES = \
@@ -14,4 +15,5 @@ SOURCES = \
   dbLEFDEFPlugin.cc \
   dbDEFImporter.cc \
   dbLEFDEFImporter.cc \
+  dbLEFCache.cc \
   dbLEFImporter.cc
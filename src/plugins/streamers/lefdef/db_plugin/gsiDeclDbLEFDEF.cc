@@ -26,6 +26,7 @@
 #include "dbLEFImporter.h"
 #include "dbDEFImporter.h"
 #include "dbLEFDEFImporter.h"
+#include "dbLEFCache.h"
 
 namespace gsi
 {
@@ -33,6 +34,11 @@ namespace gsi
 // ---------------------------------------------------------------
 //  gsi Implementation of specific methods
 
+static void clear_lef_cache ()
+{
+  db::LEFCache::instance ().clear ();
+}
+
 static db::LEFDEFReaderOptions &get_lefdef_config (db::LoadLayoutOptions *options)
 {
   return options->get_options<db::LEFDEFReaderOptions> ();
@@ -390,6 +396,56 @@ gsi::Class<db::LEFDEFReaderOptions> decl_lefdef_config ("db", "LEFDEFReaderConfi
   gsi::method ("lef_files=", &db::LEFDEFReaderOptions::set_lef_files,
     "@brief Sets the list technology LEF files to additionally import\n"
     "See \\lef_files for details."
+  ) +
+  gsi::method ("threads", &db::LEFDEFReaderOptions::threads,
+    "@brief Gets the number of threads used for reading DEF files\n"
+    "See \\threads= for details about this property.\n"
+    "\n"
+    "This property has been introduced in version 0.27."
+  ) +
+  gsi::method ("threads=", &db::LEFDEFReaderOptions::set_threads, gsi::arg ("n"),
+    "@brief Sets the number of threads used for reading DEF files\n"
+    "If this value is larger than 0, the COMPONENTS, NETS and SPECIALNETS sections of DEF files are cut into "
+    "chunks of statements which are parsed by the given number of threads. The results are put into the "
+    "layout in the original order, so the layout is the same as the one produced in the single-threaded "
+    "mode (0, the default).\n"
+    "\n"
+    "This property has been introduced in version 0.27."
+  ) +
+  gsi::method ("cache_lef_files", &db::LEFDEFReaderOptions::cache_lef_files,
+    "@brief Gets a value indicating whether the LEF data is cached for DEF reads\n"
+    "See \\cache_lef_files= for details about this property.\n"
+    "\n"
+    "This property has been introduced in version 0.27."
+  ) +
+  gsi::method ("cache_lef_files=", &db::LEFDEFReaderOptions::set_cache_lef_files, gsi::arg ("f"),
+    "@brief Sets a value indicating whether the LEF data is cached for DEF reads\n"
+    "If this property is set to true, the data read from the LEF files when reading a DEF file is kept in a "
+    "process-wide cache. Subsequent DEF reads using the same LEF files (same paths, modification times and sizes) "
+    "will take the LEF data from the cache instead of parsing the LEF files again. The cache is only used "
+    "when reading into an empty layout. Use \\clear_lef_cache to release the cached data.\n"
+    "\n"
+    "This property has been introduced in version 0.27."
+  ) +
+  gsi::method ("lef_cache_file", &db::LEFDEFReaderOptions::lef_cache_file,
+    "@brief Gets the path of the LEF cache file\n"
+    "See \\lef_cache_file= for details about this property.\n"
+    "\n"
+    "This property has been introduced in version 0.27."
+  ) +
+  gsi::method ("lef_cache_file=", &db::LEFDEFReaderOptions::set_lef_cache_file, gsi::arg ("path"),
+    "@brief Sets the path of the LEF cache file\n"
+    "If LEF caching is enabled (see \\cache_lef_files=) and this path is not empty, the cached LEF data is "
+    "also stored in this file. Other processes reading DEF files with the same LEF files can take the LEF data "
+    "from this file. The file is rewritten if it does not match the LEF files.\n"
+    "\n"
+    "This property has been introduced in version 0.27."
+  ) +
+  gsi::method ("clear_lef_cache", &clear_lef_cache,
+    "@brief Clears the process-wide LEF cache\n"
+    "See \\cache_lef_files= for details about the LEF cache.\n"
+    "\n"
+    "This method has been introduced in version 0.27."
   ),
   "@brief Detailed LEF/DEF reader options\n"
   "This class is a aggregate belonging to the \\LoadLayoutOptions class. It provides options for the LEF/DEF reader. "
@@ -25,10 +25,14 @@
 #include "dbWriter.h"
 #include "dbDEFImporter.h"
 #include "dbLEFImporter.h"
+#include "dbLEFCache.h"
+#include "dbReader.h"
+#include "tlFileUtils.h"
 
 #include "tlUnitTest.h"
 
 #include <cstdlib>
+#include <algorithm>
 
 static db::LEFDEFReaderOptions default_options ()
 {
@@ -265,3 +269,309 @@ TEST(23)
   run_test (_this, "issue-517", "def:in.def", "au.oas.gz", default_options (), false);
 }
 
+
+TEST(24)
+{
+  //  multi-threaded mode
+  db::LEFDEFReaderOptions opt = default_options ();
+  opt.set_threads (4);
+  run_test (_this, "issue-172", "lef:in.lef+def:in.def", "au.oas.gz", opt, false);
+  run_test (_this, "issue-517", "def:in.def", "au.oas.gz", opt, false);
+
+  opt.set_produce_pin_names (true);
+  opt.set_pin_property_name (2);
+  run_test (_this, "issue-489", "lef:in.lef+def:in.def", "au.oas", opt, false);
+}
+
+static void write_text (const std::string &fn, const std::string &text)
+{
+  tl::OutputStream stream (fn);
+  stream << text;
+}
+
+static void read_def (db::Layout &layout, const std::string &lef, const std::string &def, unsigned int threads)
+{
+  db::LEFDEFReaderOptions tc = default_options ();
+  tc.set_threads (threads);
+
+  db::LEFDEFLayerDelegate ld (&tc);
+  ld.prepare (layout);
+
+  db::DEFImporter imp;
+
+  {
+    tl::InputStream stream (lef);
+    imp.read_lef (stream, layout, ld);
+  }
+
+  {
+    tl::InputStream stream (def);
+    imp.read (stream, layout, ld);
+  }
+
+  ld.finish (layout);
+}
+
+static std::string read_def_error (const std::string &lef, const std::string &def, unsigned int threads)
+{
+  db::Layout layout;
+  try {
+    read_def (layout, lef, def, threads);
+  } catch (tl::Exception &ex) {
+    return ex.msg ();
+  }
+  return std::string ();
+}
+
+TEST(25)
+{
+  //  multi-threaded mode with many statements (multiple chunks)
+
+  std::string lef_text =
+    "VERSION 5.7 ;\n"
+    "UNITS\n"
+    "  DATABASE MICRONS 1000 ;\n"
+    "END UNITS\n"
+    "LAYER M1\n"
+    "  TYPE ROUTING ;\n"
+    "  WIDTH 0.2 ;\n"
+    "END M1\n"
+    "LAYER V2\n"
+    "  TYPE CUT ;\n"
+    "END V2\n"
+    "LAYER M2\n"
+    "  TYPE ROUTING ;\n"
+    "  WIDTH 0.3 ;\n"
+    "END M2\n"
+    "VIA M2_M1 DEFAULT\n"
+    "  LAYER M1 ;\n"
+    "    RECT -0.300 -0.300 0.300 0.300 ;\n"
+    "  LAYER V2 ;\n"
+    "    RECT -0.200 -0.200 0.200 0.200 ;\n"
+    "  LAYER M2 ;\n"
+    "    RECT -0.300 -0.300 0.300 0.300 ;\n"
+    "END M2_M1\n"
+    "MACRO CELL\n"
+    "  CLASS CORE ;\n"
+    "  ORIGIN 0 0 ;\n"
+    "  SIZE 1 BY 2 ;\n"
+    "  OBS\n"
+    "    LAYER M1 ;\n"
+    "      RECT 0 0 1 2 ;\n"
+    "  END\n"
+    "END CELL\n"
+    "END LIBRARY\n";
+
+  const int n = 5000;
+
+  std::string def_text =
+    "VERSION 5.6 ;\n"
+    "DESIGN CHUNKS ;\n"
+    "UNITS DISTANCE MICRONS 100 ;\n"
+    "DIEAREA ( 0 0 ) ( 100000 100000 ) ;\n";
+
+  def_text += tl::sprintf ("COMPONENTS %d ;\n", n);
+  for (int i = 0; i < n; ++i) {
+    def_text += tl::sprintf ("- I%d CELL + PLACED ( %d %d ) %s ;\n", i, (i % 100) * 200, (i / 100) * 300, (i % 2) ? "N" : "FS");
+  }
+  def_text += "END COMPONENTS\n";
+
+  def_text += tl::sprintf ("SPECIALNETS %d ;\n", n);
+  for (int i = 0; i < n; ++i) {
+    def_text += tl::sprintf ("- S%d\n  + ROUTED M1 20 ( %d 0 ) ( * 500 )\n", i, i * 10);
+    def_text += tl::sprintf ("  + RECT M2 ( %d 600 ) ( %d 700 ) ;\n", i * 10, i * 10 + 5);
+  }
+  def_text += "END SPECIALNETS\n";
+
+  def_text += tl::sprintf ("NETS %d ;\n", n);
+  for (int i = 0; i < n; ++i) {
+    //  with comments, quoted names, escaped characters, ";" inside tokens and CRLF line endings
+    def_text += tl::sprintf ("- \"N\\\" ; %d\" ( I%d A ) # comment ;\n", i, i);
+    def_text += tl::sprintf ("  + ROUTED M1 ( %d %d ) ( %d * ) M2_M1\n  NEW M2 ( %d %d ) ( * %d ) ;", i * 10, 1000, i * 10 + 100, i * 10 + 100, 1000, 2000);
+    def_text += (i % 3) ? ((i % 7) ? "\n" : "\r\n") : "  # ;\n\n";
+  }
+  def_text += "END NETS\n";
+  def_text += "END DESIGN\n";
+
+  std::string lef = tmp_file ("in.lef");
+  std::string def = tmp_file ("in.def");
+  write_text (lef, lef_text);
+  write_text (def, def_text);
+
+  db::Layout layout, layout_threaded;
+  read_def (layout, lef, def, 0);
+  read_def (layout_threaded, lef, def, 3);
+
+  EXPECT_EQ (db::compare_layouts (layout, layout_threaded, db::layout_diff::f_verbose, 0), true);
+
+  //  errors are reported with the same line number
+
+  std::string line ("  + ROUTED M1 ( 40000 1000 ) ( 40100 * ) M2_M1\n");
+  size_t pos = def_text.find (line);
+  EXPECT_EQ (pos != std::string::npos, true);
+  def_text.replace (pos, line.size (), "  + ROUTED M1 ( x 1000 ) ( 40100 * ) M2_M1\n");
+  write_text (def, def_text);
+
+  int line_number = int (std::count (def_text.begin (), def_text.begin () + pos, '\n')) + 1;
+
+  std::string error = read_def_error (lef, def, 0);
+  EXPECT_EQ (error.find (tl::sprintf ("Not a floating-point value: x (line=%d,", line_number)) != std::string::npos, true);
+  EXPECT_EQ (read_def_error (lef, def, 3), error);
+}
+
+static void read_def_with_reader (db::Layout &layout, const std::string &def, const db::LEFDEFReaderOptions &tc)
+{
+  db::LoadLayoutOptions options;
+  options.set_options (tc);
+
+  tl::InputStream stream (def);
+  db::Reader reader (stream);
+  reader.read (layout, options);
+}
+
+static bool compare_cached (tl::TestBase *_this, const std::string &def, const db::LEFDEFReaderOptions &tc)
+{
+  db::LEFDEFReaderOptions tc_cached = tc;
+  tc_cached.set_cache_lef_files (true);
+
+  db::Layout layout, layout_cached;
+  read_def_with_reader (layout, def, tc);
+  read_def_with_reader (layout_cached, def, tc_cached);
+
+  EXPECT_EQ (layout.cells () > 0, true);
+  return db::compare_layouts (layout, layout_cached, db::layout_diff::f_verbose, 0);
+}
+
+TEST(26)
+{
+  //  LEF cache
+
+  std::string lef_text =
+    "VERSION 5.7 ;\n"
+    "UNITS\n"
+    "  DATABASE MICRONS 1000 ;\n"
+    "END UNITS\n"
+    "LAYER M1\n"
+    "  TYPE ROUTING ;\n"
+    "  WIDTH 0.2 ;\n"
+    "END M1\n"
+    "LAYER V2\n"
+    "  TYPE CUT ;\n"
+    "END V2\n"
+    "LAYER M2\n"
+    "  TYPE ROUTING ;\n"
+    "  WIDTH 0.3 ;\n"
+    "END M2\n"
+    "VIA M2_M1 DEFAULT\n"
+    "  LAYER M1 ;\n"
+    "    RECT -0.300 -0.300 0.300 0.300 ;\n"
+    "  LAYER V2 ;\n"
+    "    RECT -0.200 -0.200 0.200 0.200 ;\n"
+    "  LAYER M2 ;\n"
+    "    RECT -0.300 -0.300 0.300 0.300 ;\n"
+    "END M2_M1\n"
+    "MACRO CELL\n"
+    "  CLASS CORE ;\n"
+    "  ORIGIN 0 0 ;\n"
+    "  SIZE 1 BY 2 ;\n"
+    "  PIN A\n"
+    "    DIRECTION INPUT ;\n"
+    "    PORT\n"
+    "      LAYER M1 ;\n"
+    "        RECT 0.1 0.1 0.3 0.5 ;\n"
+    "        POLYGON 0.5 0.1 0.9 0.1 0.9 0.5 0.7 0.5 0.7 0.3 0.5 0.3 ;\n"
+    "      LAYER M2 ;\n"
+    "        PATH 0.1 1.0 0.9 1.0 ;\n"
+    "      VIA 0.5 1.5 M2_M1 ;\n"
+    "    END\n"
+    "  END A\n"
+    "  OBS\n"
+    "    LAYER M1 ;\n"
+    "      RECT 0 1.8 1 2 ;\n"
+    "  END\n"
+    "END CELL\n"
+    "END LIBRARY\n";
+
+  std::string def_text =
+    "VERSION 5.6 ;\n"
+    "DESIGN CACHED ;\n"
+    "UNITS DISTANCE MICRONS 100 ;\n"
+    "DIEAREA ( 0 0 ) ( 1000 1000 ) ;\n"
+    "COMPONENTS 2 ;\n"
+    "- I1 CELL + PLACED ( 0 0 ) N ;\n"
+    "- I2 CELL + PLACED ( 200 0 ) FS ;\n"
+    "END COMPONENTS\n"
+    "NETS 1 ;\n"
+    "- N1 ( I1 A ) ( I2 A )\n"
+    "  + ROUTED M1 ( 20 20 ) ( 220 * ) M2_M1 ;\n"
+    "END NETS\n"
+    "END DESIGN\n";
+
+  //  the LEF file is taken from the DEF file's folder
+  std::string lef = tmp_file ("in.lef");
+  std::string def = tmp_file ("in.def");
+  write_text (lef, lef_text);
+  write_text (def, def_text);
+
+  db::LEFCache::instance ().clear ();
+
+  db::LEFDEFReaderOptions tc = default_options ();
+  EXPECT_EQ (compare_cached (_this, def, tc), true);
+  EXPECT_EQ (db::LEFCache::instance ().size (), size_t (1));
+
+  //  the layer production options are applied to the cached data
+  tc.set_produce_pins (false);
+  EXPECT_EQ (compare_cached (_this, def, tc), true);
+  EXPECT_EQ (db::LEFCache::instance ().size (), size_t (1));
+
+  tc = default_options ();
+  tc.set_read_all_layers (false);
+  tc.layer_map ().map (db::LayerProperties ("M1.PIN"), 0, db::LayerProperties (10, 0));
+  tc.layer_map ().map (db::LayerProperties ("M2"), 1, db::LayerProperties (11, 0));
+  EXPECT_EQ (compare_cached (_this, def, tc), true);
+  EXPECT_EQ (db::LEFCache::instance ().size (), size_t (1));
+
+  //  pin names are a different key
+  tc = default_options ();
+  tc.set_produce_pin_names (true);
+  tc.set_pin_property_name (tl::Variant (17));
+  EXPECT_EQ (compare_cached (_this, def, tc), true);
+  EXPECT_EQ (db::LEFCache::instance ().size (), size_t (2));
+
+  //  a modified LEF file invalidates the cache entry
+  write_text (lef, lef_text + "\n");
+  EXPECT_EQ (compare_cached (_this, def, tc), true);
+  EXPECT_EQ (db::LEFCache::instance ().size (), size_t (3));
+
+  //  cache file
+
+  std::string cache_file = tmp_file ("lef.cache");
+
+  db::LEFDEFReaderOptions tc_cached = tc;
+  tc_cached.set_cache_lef_files (true);
+  tc_cached.set_lef_cache_file (cache_file);
+
+  db::LEFCache::instance ().clear ();
+
+  db::Layout layout, layout_cached;
+  read_def_with_reader (layout, def, tc);
+  read_def_with_reader (layout_cached, def, tc_cached);
+  EXPECT_EQ (tl::file_exists (cache_file), true);
+  EXPECT_EQ (db::compare_layouts (layout, layout_cached, db::layout_diff::f_verbose, 0), true);
+
+  db::LEFCache::instance ().clear ();
+
+  db::Layout layout_from_file;
+  read_def_with_reader (layout_from_file, def, tc_cached);
+  EXPECT_EQ (db::LEFCache::instance ().size (), size_t (1));
+  EXPECT_EQ (db::compare_layouts (layout, layout_from_file, db::layout_diff::f_verbose, 0), true);
+
+  //  a cache size of 0 does not keep any entry
+  size_t max_entries = db::LEFCache::instance ().max_entries ();
+  db::LEFCache::instance ().set_max_entries (0);
+  EXPECT_EQ (compare_cached (_this, def, tc), true);
+  EXPECT_EQ (db::LEFCache::instance ().size (), size_t (0));
+  db::LEFCache::instance ().set_max_entries (max_entries);
+
+  db::LEFCache::instance ().clear ();
+}
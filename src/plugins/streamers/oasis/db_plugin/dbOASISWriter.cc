@@ -28,6 +28,9 @@
 #include "tlMath.h"
 
 #include <math.h>
+#include <map>
+#include <limits>
+#include <unordered_map>
 
 namespace db
 {
@@ -330,6 +333,336 @@ inline double cost_of (double d)
 }
 
 
+/**
+ *  @brief Returns the cost of a list of displacements written as an irregular repetition
+ *  The displacements are assumed to be sorted.
+ */
+static double
+irregular_repetition_cost (const std::vector<db::Vector> &disp)
+{
+  double cost = 0.0;
+
+  if (! disp.empty ()) {
+    cost += cost_of (disp.front ().x ()) + cost_of (disp.front ().y ()); 
+    for (std::vector<db::Vector>::const_iterator d = disp.begin () + 1; d != disp.end (); ++d) {
+      cost += std::max (1.0, cost_of (double (d->x ()) - double (d[-1].x ())) + cost_of (double (d->y ()) - double (d[-1].y ()))); 
+    }
+  }
+
+  return cost;
+}
+
+/**
+ *  @brief Returns the cost of a list of regular repetitions
+ */
+static double
+regular_repetitions_cost (const std::vector<std::pair<db::Vector, db::Repetition> > &reps)
+{
+  double cost = 0.0;
+
+  bool array_set = false;
+  db::Vector a_ref, b_ref;
+  size_t in_ref = 0, im_ref = 0;
+  bool ref_set = false;
+  db::Coord x_ref = 0, y_ref = 0;
+
+  for (std::vector<std::pair<db::Vector, db::Repetition> >::const_iterator r = reps.begin (); r != reps.end (); ++r) {
+
+    db::Vector a, b;
+    size_t in = 0, im = 0;
+    tl_assert (r->second.is_regular (a, b, in, im));
+
+    cost += 2; // two bytes for the shape
+
+    //  The cost of the first point (takes into account compression by reuse of one coordinate)
+    if (!ref_set || x_ref != r->first.x ()) {
+      cost += cost_of (r->first.x ());
+    }
+    if (!ref_set || y_ref != r->first.y ()) {
+      cost += cost_of (r->first.y ());
+    }
+    ref_set = true;
+    x_ref = r->first.x ();
+    y_ref = r->first.y ();
+
+    //  Cost of the repetition (takes into account reuse)
+    if (! array_set || a != a_ref || b != b_ref || in != in_ref || im != im_ref) {
+      array_set = true;
+      a_ref = a;
+      b_ref = b;
+      in_ref = in;
+      im_ref = im;
+      cost += cost_of (a.x ()) + cost_of (b.x ()) + cost_of (a.y ()) + cost_of (b.y ()) + cost_of (in) + cost_of (im);
+    } else {
+      cost += 1; // one byte
+    }
+
+    //  Note: the pointlist is reused, hence does not contribute
+
+  }
+
+  return cost;
+}
+
+namespace
+{
+
+/**
+ *  @brief A regular array found by the lattice search
+ */
+struct LatticeArray
+{
+  LatticeArray (const db::Vector &_p0, const db::Vector &_a, const db::Vector &_b, size_t _na, size_t _nb)
+    : p0 (_p0), a (_a), b (_b), na (_na), nb (_nb)
+  { }
+
+  //  NOTE: identical repetitions are sorted next to each other, so the writer can reuse them
+  bool operator< (const LatticeArray &other) const
+  {
+    if (a != other.a) {
+      return a < other.a;
+    }
+    if (b != other.b) {
+      return b < other.b;
+    }
+    if (na != other.na) {
+      return na < other.na;
+    }
+    if (nb != other.nb) {
+      return nb < other.nb;
+    }
+    return vector_cmp_x () (p0, other.p0);
+  }
+
+  db::Vector p0, a, b;
+  size_t na, nb;
+};
+
+}
+
+/**
+ *  @brief Adds a step to a point with a check for coordinate overflow
+ *  Returns false, if the step cannot be done.
+ */
+static inline bool
+lattice_step (db::Vector &p, const db::Vector &step)
+{
+  if (step.x () > 0 && p.x () > std::numeric_limits<db::Coord>::max () - step.x ()) {
+    return false;
+  }
+  if (step.y () > 0 && p.y () > std::numeric_limits<db::Coord>::max () - step.y ()) {
+    return false;
+  }
+  p += step;
+  return true;
+}
+
+/**
+ *  @brief Collects the most frequent distances between neighbors in the same row or column
+ *
+ *  "pts" needs to be sorted with vector_cmp_x. The step vectors delivered are (dx > 0, 0) or
+ *  (0, dy > 0), hence they point "forward" in the order of "pts". Steps collinear with "exclude"
+ *  are not taken. The steps are delivered with the most frequent one first.
+ */
+static void
+lattice_step_candidates (const std::vector<db::Vector> &pts, const db::Vector &exclude, size_t max_candidates, std::vector<db::Vector> &steps)
+{
+  //  the number of neighbors looked at for each point
+  const size_t neighbors = 2;
+
+  std::unordered_map<db::Vector, size_t> histogram;
+  histogram.reserve (pts.size ());
+
+  //  rows: "pts" is sorted by y first
+  for (size_t i = 0; i < pts.size (); ++i) {
+    for (size_t j = i + 1; j < pts.size () && j <= i + neighbors && pts [j].y () == pts [i].y (); ++j) {
+      if (pts [j].x () != pts [i].x ()) {
+        histogram [db::Vector (safe_diff (pts [j].x (), pts [i].x ()), 0)] += 1;
+      }
+    }
+  }
+
+  //  columns
+  std::vector<db::Vector> pts_by_x (pts);
+  std::sort (pts_by_x.begin (), pts_by_x.end (), vector_cmp_y ());
+
+  for (size_t i = 0; i < pts_by_x.size (); ++i) {
+    for (size_t j = i + 1; j < pts_by_x.size () && j <= i + neighbors && pts_by_x [j].x () == pts_by_x [i].x (); ++j) {
+      if (pts_by_x [j].y () != pts_by_x [i].y ()) {
+        histogram [db::Vector (0, safe_diff (pts_by_x [j].y (), pts_by_x [i].y ()))] += 1;
+      }
+    }
+  }
+
+  std::vector<std::pair<size_t, db::Vector> > sorted;
+  sorted.reserve (histogram.size ());
+  for (std::unordered_map<db::Vector, size_t>::const_iterator h = histogram.begin (); h != histogram.end (); ++h) {
+    if (exclude == db::Vector () || db::vprod_sign (h->first, exclude) != 0) {
+      //  NOTE: negative counts give descending order
+      sorted.push_back (std::make_pair (std::numeric_limits<size_t>::max () - h->second, h->first));
+    }
+  }
+
+  if (sorted.size () > max_candidates) {
+    std::partial_sort (sorted.begin (), sorted.begin () + max_candidates, sorted.end ());
+    sorted.erase (sorted.begin () + max_candidates, sorted.end ());
+  } else {
+    std::sort (sorted.begin (), sorted.end ());
+  }
+
+  steps.clear ();
+  for (std::vector<std::pair<size_t, db::Vector> >::const_iterator s = sorted.begin (); s != sorted.end (); ++s) {
+    steps.push_back (s->second);
+  }
+}
+
+/**
+ *  @brief Extracts runs of equidistant points
+ *
+ *  "pts" needs to be sorted with vector_cmp_x and "step" needs to point forward in this order.
+ *  Hence a point's predecessor is always visited before the point itself. Runs of at least
+ *  "min_length" points are delivered in "runs" (start point and length) and their points are
+ *  removed from "pts". "pts" may contain duplicates.
+ */
+static void
+extract_lattice_runs (std::vector<db::Vector> &pts, const db::Vector &step, size_t min_length, std::vector<std::pair<db::Vector, size_t> > &runs)
+{
+  std::unordered_map<db::Vector, size_t> avail;
+  avail.reserve (pts.size ());
+  for (std::vector<db::Vector>::const_iterator p = pts.begin (); p != pts.end (); ++p) {
+    avail [*p] += 1;
+  }
+
+  bool any = false;
+
+  for (std::vector<db::Vector>::const_iterator p = pts.begin (); p != pts.end (); ++p) {
+
+    if (avail [*p] == 0) {
+      //  already taken by a run
+      continue;
+    }
+
+    //  determine the run length. Each point is visited a limited number of times only: if the
+    //  run is long, the points are taken, if it's short, the walk is short.
+    size_t n = 0;
+    db::Vector q = *p;
+    while (true) {
+      std::unordered_map<db::Vector, size_t>::const_iterator a = avail.find (q);
+      if (a == avail.end () || a->second == 0) {
+        break;
+      }
+      ++n;
+      if (! lattice_step (q, step)) {
+        break;
+      }
+    }
+
+    if (n >= min_length) {
+
+      q = *p;
+      for (size_t i = 0; i < n; ++i) {
+        avail [q] -= 1;
+        lattice_step (q, step);
+      }
+
+      runs.push_back (std::make_pair (*p, n));
+      any = true;
+
+    }
+
+  }
+
+  if (any) {
+    std::vector<db::Vector>::iterator pw = pts.begin ();
+    for (std::vector<db::Vector>::const_iterator p = pts.begin (); p != pts.end (); ++p) {
+      size_t &a = avail [*p];
+      if (a > 0) {
+        --a;
+        *pw++ = *p;
+      }
+    }
+    pts.erase (pw, pts.end ());
+  }
+}
+
+/**
+ *  @brief Finds regular 1d and 2d arrays in a list of displacements
+ *
+ *  The step vectors are taken from a histogram of distances between neighbors in the same row
+ *  or column, most frequent first. For each step, runs of equidistant points are extracted. Runs
+ *  with the same step and length are then combined into 2d arrays the same way. The cost is
+ *  O(N log N) plus O(N) for every step tried, "max_candidates" limits the number of steps.
+ *
+ *  The displacements not taken into arrays are left in "disp" (sorted with vector_cmp_x).
+ */
+static void
+find_lattice_repetitions (std::vector<db::Vector> &disp, std::vector<std::pair<db::Vector, db::Repetition> > &reps, size_t max_candidates)
+{
+  std::sort (disp.begin (), disp.end (), vector_cmp_x ());
+
+  std::vector<db::Vector> steps;
+  std::vector<std::pair<db::Vector, size_t> > runs;
+
+  //  first stage: runs of equidistant points
+
+  std::map<std::pair<db::Vector, size_t>, std::vector<db::Vector> > runs_by_kind;
+
+  lattice_step_candidates (disp, db::Vector (), max_candidates, steps);
+  for (std::vector<db::Vector>::const_iterator s = steps.begin (); s != steps.end () && disp.size () > 1; ++s) {
+    runs.clear ();
+    extract_lattice_runs (disp, *s, 2, runs);
+    for (std::vector<std::pair<db::Vector, size_t> >::const_iterator r = runs.begin (); r != runs.end (); ++r) {
+      runs_by_kind [std::make_pair (*s, r->second)].push_back (r->first);
+    }
+  }
+
+  //  second stage: combine runs of the same step and length into 2d arrays
+
+  std::vector<LatticeArray> arrays;
+
+  for (std::map<std::pair<db::Vector, size_t>, std::vector<db::Vector> >::iterator k = runs_by_kind.begin (); k != runs_by_kind.end (); ++k) {
+
+    const db::Vector &a = k->first.first;
+    size_t na = k->first.second;
+    std::vector<db::Vector> &starts = k->second;
+
+    std::sort (starts.begin (), starts.end (), vector_cmp_x ());
+
+    if (starts.size () > 1) {
+      lattice_step_candidates (starts, a, max_candidates, steps);
+      for (std::vector<db::Vector>::const_iterator s = steps.begin (); s != steps.end () && starts.size () > 1; ++s) {
+        runs.clear ();
+        extract_lattice_runs (starts, *s, 2, runs);
+        for (std::vector<std::pair<db::Vector, size_t> >::const_iterator r = runs.begin (); r != runs.end (); ++r) {
+          arrays.push_back (LatticeArray (r->first, a, *s, na, r->second));
+        }
+      }
+    }
+
+    //  The remaining runs are kept as 1d arrays unless they are too short to be worth it
+    for (std::vector<db::Vector>::const_iterator p = starts.begin (); p != starts.end (); ++p) {
+      if (na > 2) {
+        arrays.push_back (LatticeArray (*p, a, db::Vector (), na, 1));
+      } else {
+        db::Vector q = *p;
+        for (size_t i = 0; i < na; ++i) {
+          disp.push_back (q);
+          q += a;
+        }
+      }
+    }
+
+  }
+
+  std::sort (disp.begin (), disp.end (), vector_cmp_x ());
+  std::sort (arrays.begin (), arrays.end ());
+
+  reps.reserve (reps.size () + arrays.size ());
+  for (std::vector<LatticeArray>::const_iterator a = arrays.begin (); a != arrays.end (); ++a) {
+    reps.push_back (std::make_pair (a->p0, db::Repetition (new RegularRepetition (a->a, a->b, a->na, a->nb))));
+  }
+}
+
 template <class Obj>
 void 
 Compressor<Obj>::flush (db::OASISWriter *writer) 
@@ -353,30 +686,37 @@ Compressor<Obj>::flush (db::OASISWriter *writer)
       //  Simple compression: just sort and make irregular repetitions
       std::sort (n->second.begin (), n->second.end (), vector_cmp_x ());
 
-    } else {
-    
-      disp_vector::iterator d;
-      tmp_rep_vector::iterator rw;
+    } else if (m_level > 1) {
+
+      //  Establish a baseline for the repetition cost
+      std::sort (n->second.begin (), n->second.end (), vector_cmp_x ());
+      double simple_rep_cost = irregular_repetition_cost (n->second);
+
+      //  Lattice search: the compression level determines the number of step vectors tried
+      find_lattice_repetitions (n->second, rep_vector, size_t (m_level) * 2);
+
+      double array_cost = irregular_repetition_cost (n->second) + regular_repetitions_cost (rep_vector);
 
-      std::unordered_set<db::Coord> xcoords, ycoords;
-      if (m_level > 1) {
-        for (d = n->second.begin (); d != n->second.end (); ++d) {
-          xcoords.insert (d->x ());
-          ycoords.insert (d->y ());
+      //  And resolve the repetitions if it does not make sense to keep them
+      if (array_cost > simple_rep_cost) {
+        for (std::vector<std::pair<db::Vector, db::Repetition> >::const_iterator r = rep_vector.begin (); r != rep_vector.end (); ++r) {
+          for (db::RepetitionIterator i = r->second.begin (); ! i.at_end (); ++i) {
+            n->second.push_back (r->first + *i);
+          }
         }
+        rep_vector.clear ();
+        std::sort (n->second.begin (), n->second.end (), vector_cmp_x ());
       }
 
-      bool xfirst = xcoords.size () < ycoords.size ();
-
-      double simple_rep_cost = 0;
-      double array_cost = 0;
+    } else {
+    
+      disp_vector::iterator d;
+      tmp_rep_vector::iterator rw;
 
-      //  Try single-point compression to repetitions in the x and y direction. For the first
-      //  direction, use the one with more distinct values. For this, a better compression is 
-      //  expected.
+      //  Try single-point compression to repetitions in the y and x direction
       for (int xypass = 0; xypass <= 1; ++xypass) {
 
-        bool xrep = (xfirst == (xypass == 0));
+        bool xrep = (xypass != 0);
       
         displacements.clear ();
         repetitions.clear ();
@@ -388,121 +728,39 @@ Compressor<Obj>::flush (db::OASISWriter *writer)
           std::sort (displacements.begin (), displacements.end (), vector_cmp_y ());
         }
 
-        if (xypass == 0 && m_level > 1) {
-          //  Establish a baseline for the repetition cost
-          simple_rep_cost += cost_of (displacements.front ().x ()) + cost_of (displacements.front ().y ()); 
-          for (d = displacements.begin () + 1; d != displacements.end (); ++d) {
-            simple_rep_cost += std::max (1.0, cost_of (double (d->x ()) - double (d[-1].x ())) + cost_of (double (d->y ()) - double (d[-1].y ()))); 
-          }
-        }
-
-        disp_vector::iterator dwindow = displacements.begin ();
         for (d = displacements.begin (); d != displacements.end (); ) {
 
-          if (m_level < 2) {
-
-            disp_vector::iterator dd = d;
-            ++dd;
+          disp_vector::iterator dd = d;
+          ++dd;
 
-            db::Vector dxy;
-            int nxy = 1;
+          db::Vector dxy;
+          int nxy = 1;
 
-            if (dd != displacements.end ()) {
+          if (dd != displacements.end ()) {
 
-              dxy = xrep ? db::Vector (safe_diff (dd->x (), d->x ()), 0) : db::Vector (0, safe_diff (dd->y (), d->y ()));
-              while (dd != displacements.end () && *dd == dd[-1] + dxy) {
-                ++dd;
-                ++nxy;
-              } 
-
-            }
+            dxy = xrep ? db::Vector (safe_diff (dd->x (), d->x ()), 0) : db::Vector (0, safe_diff (dd->y (), d->y ()));
+            while (dd != displacements.end () && *dd == dd[-1] + dxy) {
+              ++dd;
+              ++nxy;
+            } 
 
-            //  Note in level 1 optimization, no cost estimation is done, hence small arrays won't be removed.
-            //  To compensate that, we use a minimum size of 3 items per array.
-            if (nxy < 3) {
-
-              n->second.push_back (*d++);
-
-            } else {
+          }
 
-              repetitions.push_back (std::make_pair (*d, std::make_pair (xrep ? dxy.x () : dxy.y (), nxy)));
-              d = dd;
+          //  Note in level 1 optimization, no cost estimation is done, hence small arrays won't be removed.
+          //  To compensate that, we use a minimum size of 3 items per array.
+          if (nxy < 3) {
 
-            }
+            n->second.push_back (*d++);
 
           } else {
 
-            //  collect the nearest neighbor distances and counts for 2..level order neighbors
-            int nxy_max = 1;
-            unsigned int nn_max = 0;
-
-            //  move the window of identical x/y coordinates if necessary
-            if (d == dwindow) {
-              for (dwindow = d + 1; dwindow != displacements.end () && (xrep ? (dwindow->y () == d->y ()) : (dwindow->x () == d->x ())); ++dwindow) 
-                ;
-            }
-
-            for (unsigned int nn = 0; nn < m_level; ++nn) {
-
-              disp_vector::iterator dd = d + (nn + 1);
-              if (dd >= dwindow) {
-                break;
-              }
-
-              db::Vector dxy = xrep ? db::Vector (safe_diff (dd->x (), d->x ()), 0) : db::Vector (0, safe_diff (dd->y (), d->y ()));
-
-              int nxy = 2;
-              while (dd != dwindow) {
-                disp_vector::iterator df = std::lower_bound (dd + 1, dwindow, *dd + dxy);
-                if (df == dwindow || *df != *dd + dxy) {
-                  break;
-                }
-                ++nxy;
-                dd = df;
-              }
-
-              if (nxy > nxy_max) {
-                nxy_max = nxy;
-                nn_max = nn;
-              }
-
-            }
-
-            if (nxy_max < 2) {
-
-              //  no candidate found - just keep that one
-              n->second.push_back (*d++);
-
-            } else {
-
-              //  take out the ones of this sequence from the list
-              db::Vector dxy_max = xrep ? db::Vector (safe_diff ((d + nn_max + 1)->x (), d->x ()), 0) : db::Vector (0, safe_diff ((d + nn_max + 1)->y (), d->y ()));
-
-              disp_vector::iterator ds = dwindow;
-              disp_vector::iterator dt = dwindow;
-              db::Vector df = *d + dxy_max * long (nxy_max - 1);
-
-              do {
-                --ds;
-                if (*ds != df) {
-                  *--dt = *ds;
-                } else {
-                  df -= dxy_max;
-                }
-              } while (ds != d);
-
-              repetitions.push_back (std::make_pair (*d, std::make_pair (xrep ? dxy_max.x () : dxy_max.y (), nxy_max)));
-
-              d = dt;
-
-            }
+            repetitions.push_back (std::make_pair (*d, std::make_pair (xrep ? dxy.x () : dxy.y (), nxy)));
+            d = dd;
 
           }
 
         }
 
-        //  Apply some heuristic criterion that allows the algorithm to determine whether it's worth doing the compression
-
         //  Try to compact these repetitions further, y direction first, then x direction
         for (int xypass2 = 1; xypass2 >= 0; --xypass2) {
         
@@ -534,15 +792,10 @@ Compressor<Obj>::flush (db::OASISWriter *writer)
             if (nxy2 < 2 && xypass2) {
               *rw++ = *r;
             } else {
-              if (m_level < 2) {
-                Obj obj = n->first;
-                obj.move (r->first);
-                db::Vector a (xrep ? r->second.first : 0, xrep ? 0 : r->second.first);
-                writer->write (obj, db::Repetition (new RegularRepetition (a, dxy2, r->second.second, nxy2)));
-              } else {
-                db::Vector a (xrep ? r->second.first : 0, xrep ? 0 : r->second.first);
-                rep_vector.push_back (std::make_pair (r->first, db::Repetition (new RegularRepetition (a, dxy2, r->second.second, nxy2))));
-              }
+              Obj obj = n->first;
+              obj.move (r->first);
+              db::Vector a (xrep ? r->second.first : 0, xrep ? 0 : r->second.first);
+              writer->write (obj, db::Repetition (new RegularRepetition (a, dxy2, r->second.second, nxy2)));
             }
 
             r = rr;
@@ -555,72 +808,6 @@ Compressor<Obj>::flush (db::OASISWriter *writer)
 
       }
 
-      if (m_level > 1) {
-
-        //  Compute a cost for the repetitions
-
-        if (! n->second.empty ()) {
-          //  irregular repetition contribution
-          array_cost += cost_of (n->second.front ().x ()) + cost_of (n->second.front ().y ()); 
-          for (std::vector<db::Vector>::const_iterator d = n->second.begin () + 1; d != n->second.end (); ++d) {
-            array_cost += std::max(1.0, cost_of (d->x () - d[-1].x ()) + cost_of (d->y () - d[-1].y ())); 
-          }
-        }
-
-        bool array_set = false;
-        db::Vector a_ref, b_ref;
-        size_t in_ref = 0, im_ref = 0;
-        bool ref_set = false;
-        db::Coord x_ref = 0, y_ref = 0;
-
-        for (std::vector<std::pair<db::Vector, db::Repetition> >::const_iterator r = rep_vector.begin (); r != rep_vector.end (); ++r) {
-
-          db::Vector a, b;
-          size_t in = 0, im = 0;
-          tl_assert (r->second.is_regular (a, b, in, im));
-
-          array_cost += 2; // two bytes for the shape
-
-          //  The cost of the first point (takes into account compression by reuse of one coordinate)
-          if (!ref_set || x_ref != r->first.x ()) {
-            array_cost += cost_of (r->first.x ());
-          }
-          if (!ref_set || y_ref != r->first.y ()) {
-            array_cost += cost_of (r->first.y ());
-          }
-          ref_set = true;
-          x_ref = r->first.x ();
-          y_ref = r->first.y ();
-
-          //  Cost of the repetition (takes into account reuse)
-          if (! array_set || a != a_ref || b != b_ref || in != in_ref || im != im_ref) {
-            array_set = true;
-            a_ref = a;
-            b_ref = b;
-            in_ref = in;
-            im_ref = im;
-            array_cost += cost_of (a.x ()) + cost_of (b.x ()) + cost_of (a.y ()) + cost_of (b.y ()) + cost_of (in) + cost_of (im);
-          } else {
-            array_cost += 1; // one byte
-          }
-
-          //  Note: the pointlist is reused, hence does not contribute
-
-        }
-
-        //  And resolve the repetitions if it does not make sense to keep them
-        if (array_cost > simple_rep_cost) {
-          for (std::vector<std::pair<db::Vector, db::Repetition> >::const_iterator r = rep_vector.begin (); r != rep_vector.end (); ++r) {
-            for (db::RepetitionIterator i = r->second.begin (); ! i.at_end (); ++i) {
-              n->second.push_back (r->first + *i);
-            }
-          }
-          rep_vector.clear ();
-          std::sort (n->second.begin (), n->second.end (), vector_cmp_x ());
-        }
-
-      }
-
     }
 
     for (std::vector<std::pair<db::Vector, db::Repetition> >::const_iterator r = rep_vector.begin (); r != rep_vector.end (); ++r) {
@@ -670,6 +857,8 @@ OASISWriter::OASISWriter ()
     m_propname_id (0),
     m_propstring_id (0),
     m_proptables_written (false),
+    m_streaming (false),
+    m_stream_cell (0),
     m_progress (tl::to_string (tr ("Writing OASIS file")), 10000)
 {
   m_progress.set_format (tl::to_string (tr ("%.0f MB")));
@@ -1160,6 +1349,7 @@ OASISWriter::write (db::Layout &layout, tl::OutputStream &stream, const db::Save
   m_layer = m_datatype = 0;
   m_in_cblock = false;
   m_cblock_buffer.clear ();
+  m_streaming = false;
 
   m_options = options.get_options<OASISWriterOptions> ();
   mp_stream = &stream;
@@ -1551,38 +1741,7 @@ OASISWriter::write (db::Layout &layout, tl::OutputStream &stream, const db::Save
 
   //  write layernames table
 
-  {
-
-    for (std::vector <std::pair <unsigned int, db::LayerProperties> >::const_iterator l = layers.begin (); l != layers.end (); ++l) {
-
-      if (! l->second.name.empty ()) {
-
-        begin_table (layernames_table_pos);
-
-        //  write mappings to text layer and shape layers
-        write_record_id (11);
-        write_nstring (l->second.name.c_str ());
-        write_byte (3);
-        write ((unsigned long) l->second.layer);
-        write_byte (3);
-        write ((unsigned long) l->second.datatype);
-
-        write_record_id (12);
-        write_nstring (l->second.name.c_str ());
-        write_byte (3);
-        write ((unsigned long) l->second.layer);
-        write_byte (3);
-        write ((unsigned long) l->second.datatype);
-
-        m_progress.set (mp_stream->pos ());
-
-      }
-
-    }
-
-    end_table (layernames_table_pos);
-
-  }
+  write_layername_table (layernames_table_pos, layers);
 
   std::vector <std::string> context_prop_strings;
 
@@ -1647,7 +1806,7 @@ OASISWriter::write (db::Layout &layout, tl::OutputStream &stream, const db::Save
 
       //  instances
       if (cref.cell_instances () > 0) {
-        write_insts (cell_set);
+        write_insts (&cell_set);
       }
 
       //  shapes
@@ -1674,71 +1833,269 @@ OASISWriter::write (db::Layout &layout, tl::OutputStream &stream, const db::Save
   //  for the S_CELL_OFFSET properties)
   
   if (m_options.strict_mode) {
+    write_cellname_table (cellnames_table_pos, cells_by_index, &cell_positions);
+  }
 
-    bool sequential = true;
-    for (std::vector<db::cell_index_type>::const_iterator cell = cells_by_index.begin (); cell != cells_by_index.end () && sequential; ++cell) {
-      sequential = (*cell == db::cell_index_type (cell - cells_by_index.begin ()));
+  //  END record
+
+  write_end_record (m_options.strict_mode, cellnames_table_pos, textstrings_table_pos, propnames_table_pos, propstrings_table_pos, layernames_table_pos);
+
+  m_progress.set (mp_stream->pos ());
+}
+
+void
+OASISWriter::begin_stream (const db::Layout &layout, tl::OutputStream &stream, const db::SaveLayoutOptions &options)
+{
+  typedef db::coord_traits<db::Coord>::distance_type coord_distance_type;
+
+  mp_layout = &layout;
+  mp_cell = 0;
+  m_layer = m_datatype = 0;
+  m_in_cblock = false;
+  m_cblock_buffer.clear ();
+  m_streaming = true;
+  m_stream_cell = 0;
+  m_cell_positions.clear ();
+  m_stream_layers.clear ();
+
+  m_options = options.get_options<OASISWriterOptions> ();
+  mp_stream = &stream;
+
+  double dbu = (options.dbu () == 0.0) ? layout.dbu () : options.dbu ();
+  m_sf = options.scale_factor () * (layout.dbu () / dbu);
+  if (fabs (m_sf - 1.0) < 1e-9) {
+    //  to avoid rounding problems, set to 1.0 exactly if possible.
+    m_sf = 1.0;
+  }
+
+  //  write header
+
+  char magic[] = "%SEMI-OASIS\015\012";
+  write_bytes (magic, sizeof (magic) - 1);
+
+  //  START record - in streaming mode the name tables are written at the end, hence the
+  //  table offsets are only available in strict mode where they go into the END record
+  write_record_id (1); 
+  write_bstring ("1.0");
+  write (1.0 / dbu);
+  write_byte (m_options.strict_mode ? 1 : 0);  //  offset-flag
+
+  if (! m_options.strict_mode) {
+
+    //  offset table:
+    for (unsigned int i = 0; i < 12; ++i) {
+      write_byte (0);
     }
 
-    for (std::vector<db::cell_index_type>::const_iterator cell = cells_by_index.begin (); cell != cells_by_index.end (); ++cell) {
-      
-      begin_table (cellnames_table_pos);
+  }
 
-      //  CELLNAME (explicit)
-      write_record_id (sequential ? 3 : 4);
-      write_nstring (layout.cell_name (*cell));
-      if (! sequential) {
-        write ((unsigned long) *cell);
-      }
+  reset_modal_variables ();
 
-      reset_modal_variables ();
+  //  No name tables are used in streaming mode except for the cell names: the
+  //  property names, property strings and text strings are written explicitly.
+  m_textstrings.clear ();
+  m_propnames.clear ();
+  m_propstrings.clear ();
+  m_propstring_id = m_propname_id = 0;
+  m_proptables_written = false;
 
-      if (m_options.write_std_properties > 1) {
+  //  NOTE: S_TOP_CELL and S_BOUNDING_BOX are not available in streaming mode since the
+  //  hierarchy is not known in advance
+  if (m_options.write_std_properties > 0) {
+    write_property_def (s_max_signed_integer_width_name, tl::Variant (sizeof (db::Coord)), true);
+    write_property_def (s_max_unsigned_integer_width_name, tl::Variant (sizeof (coord_distance_type)), true);
+  }
 
-        //  write S_BOUNDING_BOX entries
+  if (layout.prop_id () != 0) {
+    write_props (layout.prop_id ());
+  }
+}
 
-        std::vector<tl::Variant> values;
+void
+OASISWriter::begin_stream_cell (db::cell_index_type cell)
+{
+  m_progress.set (mp_stream->pos ());
 
-        //  TODO: how to set the "depends on external cells" flag?
-        db::Box bbox = layout.cell (*cell).bbox ();
-        if (bbox.empty ()) {
-          //  empty box 
-          values.push_back (tl::Variant ((unsigned int) 0x2)); 
-          bbox = db::Box (0, 0, 0, 0);
-        } else {
-          values.push_back (tl::Variant ((unsigned int) 0x0)); 
-        }
+  m_stream_cell = cell;
+  mp_cell = &mp_layout->cell (cell);
 
-        values.push_back (tl::Variant (bbox.left ())); 
-        values.push_back (tl::Variant (bbox.bottom ())); 
-        values.push_back (tl::Variant (bbox.width ()));
-        values.push_back (tl::Variant (bbox.height ()));
+  m_cell_positions.insert (std::make_pair (cell, mp_stream->pos ()));
 
-        write_property_def (s_bounding_box_name, values, true);
+  write_record_id (13);  // CELL
+  write ((unsigned long) cell);
+
+  reset_modal_variables ();
+
+  if (mp_cell->prop_id () != 0) {
+    write_props (mp_cell->prop_id ());
+  }
+}
+
+void
+OASISWriter::write_stream_cell_content (const std::vector <std::pair <unsigned int, db::LayerProperties> > &layers)
+{
+  mp_cell = &mp_layout->cell (m_stream_cell);
+
+  //  collect the layers for the LAYERNAME table
+  for (std::vector <std::pair <unsigned int, db::LayerProperties> >::const_iterator l = layers.begin () + std::min (layers.size (), m_stream_layers.size ()); l != layers.end (); ++l) {
+    m_stream_layers.push_back (*l);
+  }
+
+  if (m_options.write_cblocks) {
+    begin_cblock ();
+  }
+
+  //  instances
+  if (mp_cell->cell_instances () > 0) {
+    write_insts (0);
+  }
+
+  //  shapes
+  for (std::vector <std::pair <unsigned int, db::LayerProperties> >::const_iterator l = layers.begin (); l != layers.end (); ++l) {
+    const db::Shapes &shapes = mp_cell->shapes (l->first);
+    if (! shapes.empty ()) {
+      write_shapes (l->second, shapes);
+      m_progress.set (mp_stream->pos ());
+    }
+  }
+
+  if (m_options.write_cblocks) {
+    end_cblock ();
+  }
+}
+
+void
+OASISWriter::end_stream_cell ()
+{
+  mp_cell = 0;
+}
+
+void
+OASISWriter::end_stream ()
+{
+  size_t cellnames_table_pos = 0;
+  size_t layernames_table_pos = 0;
+
+  //  the cell name table includes the cells which are referenced only
+  std::vector<db::cell_index_type> cells_by_index;
+  cells_by_index.reserve (mp_layout->cells ());
+  for (db::Layout::const_iterator cell = mp_layout->begin (); cell != mp_layout->end (); ++cell) {
+    cells_by_index.push_back (cell->cell_index ());
+  }
+
+  write_cellname_table (cellnames_table_pos, cells_by_index, m_options.strict_mode ? &m_cell_positions : 0);
+  write_layername_table (layernames_table_pos, m_stream_layers);
+
+  write_end_record (m_options.strict_mode, cellnames_table_pos, 0, 0, 0, layernames_table_pos);
+
+  m_progress.set (mp_stream->pos ());
+
+  m_streaming = false;
+}
+
+void
+OASISWriter::write_layername_table (size_t &layernames_table_pos, const std::vector <std::pair <unsigned int, db::LayerProperties> > &layers)
+{
+  for (std::vector <std::pair <unsigned int, db::LayerProperties> >::const_iterator l = layers.begin (); l != layers.end (); ++l) {
+
+    if (! l->second.name.empty ()) {
+
+      begin_table (layernames_table_pos);
+
+      //  write mappings to text layer and shape layers
+      write_record_id (11);
+      write_nstring (l->second.name.c_str ());
+      write_byte (3);
+      write ((unsigned long) l->second.layer);
+      write_byte (3);
+      write ((unsigned long) l->second.datatype);
+
+      write_record_id (12);
+      write_nstring (l->second.name.c_str ());
+      write_byte (3);
+      write ((unsigned long) l->second.layer);
+      write_byte (3);
+      write ((unsigned long) l->second.datatype);
+
+      m_progress.set (mp_stream->pos ());
+
+    }
 
+  }
+
+  end_table (layernames_table_pos);
+}
+
+void
+OASISWriter::write_cellname_table (size_t &cellnames_table_pos, const std::vector<db::cell_index_type> &cells_by_index, const std::map<db::cell_index_type, size_t> *cell_positions)
+{
+  bool sequential = true;
+  for (std::vector<db::cell_index_type>::const_iterator cell = cells_by_index.begin (); cell != cells_by_index.end () && sequential; ++cell) {
+    sequential = (*cell == db::cell_index_type (cell - cells_by_index.begin ()));
+  }
+
+  for (std::vector<db::cell_index_type>::const_iterator cell = cells_by_index.begin (); cell != cells_by_index.end (); ++cell) {
+
+    begin_table (cellnames_table_pos);
+
+    //  CELLNAME (explicit)
+    write_record_id (sequential ? 3 : 4);
+    write_nstring (mp_layout->cell_name (*cell));
+    if (! sequential) {
+      write ((unsigned long) *cell);
+    }
+
+    reset_modal_variables ();
+
+    //  NOTE: in streaming mode, the bounding boxes are not known
+    if (m_options.write_std_properties > 1 && ! m_streaming) {
+
+      //  write S_BOUNDING_BOX entries
+
+      std::vector<tl::Variant> values;
+
+      //  TODO: how to set the "depends on external cells" flag?
+      db::Box bbox = mp_layout->cell (*cell).bbox ();
+      if (bbox.empty ()) {
+        //  empty box 
+        values.push_back (tl::Variant ((unsigned int) 0x2)); 
+        bbox = db::Box (0, 0, 0, 0);
+      } else {
+        values.push_back (tl::Variant ((unsigned int) 0x0)); 
       }
 
-      //  PROPERTY record with S_CELL_OFFSET
-      std::map<db::cell_index_type, size_t>::const_iterator pp = cell_positions.find (*cell);
-      if (pp != cell_positions.end ()) {
+      values.push_back (tl::Variant (bbox.left ())); 
+      values.push_back (tl::Variant (bbox.bottom ())); 
+      values.push_back (tl::Variant (bbox.width ()));
+      values.push_back (tl::Variant (bbox.height ()));
+
+      write_property_def (s_bounding_box_name, values, true);
+
+    }
+
+    //  PROPERTY record with S_CELL_OFFSET
+    if (cell_positions) {
+      std::map<db::cell_index_type, size_t>::const_iterator pp = cell_positions->find (*cell);
+      if (pp != cell_positions->end ()) {
         write_property_def (s_cell_offset_name, tl::Variant (pp->second), true);
       } else {
         write_property_def (s_cell_offset_name, tl::Variant (size_t (0)), true);
       }
-
     }
 
-    end_table (cellnames_table_pos);
-
   }
 
-  //  END record
+  end_table (cellnames_table_pos);
+}
 
+void
+OASISWriter::write_end_record (bool with_offsets, size_t cellnames_table_pos, size_t textstrings_table_pos, size_t propnames_table_pos, size_t propstrings_table_pos, size_t layernames_table_pos)
+{
   size_t end_record_pos = mp_stream->pos ();
 
   write_record_id (2);
 
-  if (m_options.strict_mode) {
+  if (with_offsets) {
 
     //  offset table for strict mode (write it now since we have the table offsets now)
 
@@ -1777,8 +2134,6 @@ OASISWriter::write (db::Layout &layout, tl::OutputStream &stream, const db::Save
 
   //  validation-scheme
   write_byte (0);
-
-  m_progress.set (mp_stream->pos ());
 }
 
 void 
@@ -1990,7 +2345,7 @@ OASISWriter::write (const db::CellInstArray &inst, db::properties_id_type prop_i
 }
 
 void 
-OASISWriter::write_insts (const std::set <db::cell_index_type> &cell_set)
+OASISWriter::write_insts (const std::set <db::cell_index_type> *cell_set)
 {
   int level = m_options.compression_level;
 
@@ -2004,7 +2359,7 @@ OASISWriter::write_insts (const std::set <db::cell_index_type> &cell_set)
   //  Collect all instances 
   for (db::Cell::const_iterator inst_iterator = mp_cell->begin (); ! inst_iterator.at_end (); ++inst_iterator) {
 
-    if (cell_set.find (inst_iterator->cell_index ()) != cell_set.end ()) {
+    if (! cell_set || cell_set->find (inst_iterator->cell_index ()) != cell_set->end ()) {
 
       db::properties_id_type prop_id = inst_iterator->prop_id ();
 
@@ -2119,7 +2474,7 @@ OASISWriter::write_property_def (const char *name_str, const std::vector<tl::Var
 
       //  In strict mode always write property ID's: before we have issued the table we can 
       //  create new ID's.
-      if (pni == m_propnames.end () && m_options.strict_mode) {
+      if (pni == m_propnames.end () && m_options.strict_mode && ! m_streaming) {
         tl_assert (! m_proptables_written);
         pni = m_propnames.insert (std::make_pair (name_str, m_propname_id++)).first;
       }
@@ -2182,7 +2537,7 @@ OASISWriter::write_property_def (const char *name_str, const std::vector<tl::Var
 
           //  In strict mode always write property string ID's: before we have issued the table we can 
           //  create new ID's.
-          if (pvi == m_propstrings.end () && m_options.strict_mode) {
+          if (pvi == m_propstrings.end () && m_options.strict_mode && ! m_streaming) {
             tl_assert (! m_proptables_written);
             pvi = m_propstrings.insert (std::make_pair (pvs, m_propstring_id++)).first;
           }
@@ -2301,11 +2656,16 @@ OASISWriter::write (const db::Text &text, db::properties_id_type prop_id, const
   m_progress.set (mp_stream->pos ());
 
   db::Trans trans = text.trans ();
-  std::map <std::string, unsigned long>::const_iterator ts = m_textstrings.find (text.string ());
-  tl_assert (ts != m_textstrings.end ());
-  unsigned long text_id = ts->second;
 
-  unsigned char info = 0x20;
+  //  in streaming mode, the text strings are not known in advance, hence they are written explicitly
+  unsigned long text_id = 0;
+  if (! m_streaming) {
+    std::map <std::string, unsigned long>::const_iterator ts = m_textstrings.find (text.string ());
+    tl_assert (ts != m_textstrings.end ());
+    text_id = ts->second;
+  }
+
+  unsigned char info = m_streaming ? 0x00 : 0x20;
 
   if (mm_text_string != text.string ()) {
     info |= 0x40;
@@ -2330,7 +2690,11 @@ OASISWriter::write (const db::Text &text, db::properties_id_type prop_id, const
   write_byte (info);
   if (info & 0x40) {
     mm_text_string = text.string ();
-    write ((unsigned long) text_id);
+    if (info & 0x20) {
+      write ((unsigned long) text_id);
+    } else {
+      write_astring (text.string ());
+    }
   }
   if (info & 0x01) {
     mm_textlayer = m_layer;
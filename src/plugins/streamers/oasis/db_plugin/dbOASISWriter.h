@@ -26,6 +26,7 @@
 
 #include "dbPluginCommon.h"
 #include "dbWriter.h"
+#include "dbStreamingWriter.h"
 #include "dbOASIS.h"
 #include "dbOASISFormat.h"
 #include "dbSaveLayoutOptions.h"
@@ -99,7 +100,7 @@ private:
  *  @brief A OASIS writer abstraction
  */
 class DB_PLUGIN_PUBLIC OASISWriter
-  : public db::WriterBase
+  : public db::WriterBase, public db::StreamingWriterBase
 {
 public:
   /**
@@ -112,6 +113,13 @@ public:
    */
   void write (db::Layout &layout, tl::OutputStream &stream, const db::SaveLayoutOptions &options);
 
+  //  StreamingWriterBase implementation
+  virtual void begin_stream (const db::Layout &layout, tl::OutputStream &stream, const db::SaveLayoutOptions &options);
+  virtual void begin_stream_cell (db::cell_index_type cell);
+  virtual void write_stream_cell_content (const std::vector <std::pair <unsigned int, db::LayerProperties> > &layers);
+  virtual void end_stream_cell ();
+  virtual void end_stream ();
+
   void write (const db::CellInstArray &inst_array, const db::Repetition &rep)
   {
     write (inst_array, 0, rep);
@@ -210,6 +218,10 @@ private:
   unsigned long m_propname_id;
   unsigned long m_propstring_id;
   bool m_proptables_written;
+  bool m_streaming;
+  db::cell_index_type m_stream_cell;
+  std::map<db::cell_index_type, size_t> m_cell_positions;
+  std::vector <std::pair <unsigned int, db::LayerProperties> > m_stream_layers;
 
   std::map <std::string, unsigned long> m_textstrings;
   std::map <std::string, unsigned long> m_propnames;
@@ -298,7 +310,10 @@ private:
 
   void emit_propname_def (db::properties_id_type prop_id);
   void emit_propstring_def (db::properties_id_type prop_id);
-  void write_insts (const std::set <db::cell_index_type> &cell_set);
+  void write_insts (const std::set <db::cell_index_type> *cell_set);
+  void write_layername_table (size_t &layernames_table_pos, const std::vector <std::pair <unsigned int, db::LayerProperties> > &layers);
+  void write_cellname_table (size_t &cellnames_table_pos, const std::vector<db::cell_index_type> &cells_by_index, const std::map<db::cell_index_type, size_t> *cell_positions);
+  void write_end_record (bool with_offsets, size_t cellnames_table_pos, size_t textstrings_table_pos, size_t propnames_table_pos, size_t propstrings_table_pos, size_t layernames_table_pos);
 
   void write_shapes (const db::LayerProperties &lprops, const db::Shapes &shapes);
 
@@ -282,8 +282,9 @@ gsi::ClassExt<db::SaveLayoutOptions> oasis_writer_options (
     "@brief Set the OASIS compression level\n"
     "The OASIS compression level is an integer number between 0 and 10. 0 basically is no compression, "
     "1 produces shape arrays in a simple fashion. 2 and higher compression levels will use a more elaborate "
-    "algorithm to find shape arrays which uses 2nd and further neighbor distances. The higher the level, the "
-    "higher the memory requirements and run times.\n"
+    "algorithm to find shape arrays: it derives candidate pitches from the most frequent neighbor distances and "
+    "forms one- and two-dimensional arrays from them. The higher the level, the more candidate pitches are tried "
+    "and the longer the run times.\n"
   ) +
   gsi::method_ext ("oasis_compression_level", &get_oasis_compression,
     "@brief Get the OASIS compression level\n"
@@ -25,6 +25,7 @@
 #include "dbOASISReader.h"
 #include "dbLayoutDiff.h"
 #include "dbWriter.h"
+#include "dbStreamingWriter.h"
 #include "dbTextWriter.h"
 #include "dbLibraryProxy.h"
 #include "dbTestSupport.h"
@@ -1805,3 +1806,159 @@ TEST(119_WithAndWithoutContext)
   }
 
 }
+
+static size_t write_with_compression (tl::TestBase *_this, const db::Layout &layout, int level)
+{
+  tl::OutputMemoryStream buffer;
+
+  {
+    tl::OutputStream out (buffer);
+    db::SaveLayoutOptions options;
+    db::OASISWriterOptions oasis_options;
+    oasis_options.compression_level = level;
+    options.set_options (oasis_options);
+    options.set_format ("OASIS");
+    db::Writer writer (options);
+    writer.write (const_cast<db::Layout &> (layout), out);
+  }
+
+  tl::InputMemoryStream data (buffer.data (), buffer.size ());
+  tl::InputStream in (data);
+  db::Reader reader (in);
+  db::Layout layout2;
+  reader.read (layout2);
+
+  bool equal = db::compare_layouts (layout, layout2, db::layout_diff::f_verbose | db::layout_diff::f_flatten_array_insts | db::layout_diff::f_no_layer_names, 0);
+  EXPECT_EQ (equal, true);
+
+  return buffer.size ();
+}
+
+//  lattice search for repetitions (compression level 2 and above)
+TEST(120)
+{
+  db::Layout g;
+
+  unsigned int l1 = g.insert_layer (db::LayerProperties (1, 0));
+  unsigned int l2 = g.insert_layer (db::LayerProperties (2, 0));
+  db::Cell &top = g.cell (g.add_cell ("TOP"));
+
+  //  a grid with holes
+  for (int i = 0; i < 50; ++i) {
+    for (int j = 0; j < 40; ++j) {
+      if ((i * 7 + j * 13) % 11 != 0) {
+        top.shapes (l1).insert (db::Box (i * 200, j * 300, i * 200 + 100, j * 300 + 150));
+      }
+    }
+  }
+
+  //  rows with different pitch and length plus some random boxes
+  for (int r = 0; r < 20; ++r) {
+    int pitch = 100 + (r % 7) * 20;
+    for (int i = 0; i < 20 + (r * 17) % 30; ++i) {
+      top.shapes (l2).insert (db::Box (i * pitch, 20000 + r * 500, i * pitch + 50, 20000 + r * 500 + 50));
+    }
+  }
+
+  srand (1);
+  for (int i = 0; i < 500; ++i) {
+    int x = rand () % 10000, y = rand () % 10000;
+    top.shapes (l2).insert (db::Box (x, y, x + 50, y + 50));
+  }
+
+  size_t s0 = write_with_compression (_this, g, 0);
+  size_t s1 = write_with_compression (_this, g, 1);
+  size_t s2 = write_with_compression (_this, g, 2);
+  size_t s10 = write_with_compression (_this, g, 10);
+
+  EXPECT_EQ (s1 < s0, true);
+  EXPECT_EQ (s2 < s1, true);
+  EXPECT_EQ (s10 <= s2, true);
+}
+
+static void run_streaming_test (tl::TestBase *_this, const db::Layout &layout, const db::OASISWriterOptions &oasis_options)
+{
+  tl::OutputMemoryStream buffer;
+
+  {
+    tl::OutputStream out (buffer);
+    db::SaveLayoutOptions options;
+    options.set_options (oasis_options);
+    options.set_format ("OASIS");
+
+    db::StreamingWriter writer (out, options, layout.dbu ());
+    writer.set_flush_threshold (100);
+
+    //  cells are written top-down, so instances reference cells before they are written
+    for (db::Layout::top_down_const_iterator c = layout.begin_top_down (); c != layout.end_top_down (); ++c) {
+      db::write_cell_streaming (writer, layout, *c);
+    }
+
+    writer.finish ();
+  }
+
+  //  the END record is 256 bytes long - the table offsets are only written in strict mode
+  EXPECT_EQ (buffer.size () > 256, true);
+  EXPECT_EQ (int (buffer.data () [buffer.size () - 256]), 2);
+  EXPECT_EQ (int ((unsigned char) buffer.data () [buffer.size () - 255]), oasis_options.strict_mode ? 1 : 0x80);
+
+  tl::InputMemoryStream data (buffer.data (), buffer.size ());
+  tl::InputStream in (data);
+  db::Reader reader (in);
+  reader.set_warnings_as_errors (true);
+  db::Layout layout2;
+  reader.read (layout2);
+
+  bool equal = db::compare_layouts (layout, layout2, db::layout_diff::f_verbose | db::layout_diff::f_no_layer_names, 0);
+  EXPECT_EQ (equal, true);
+}
+
+//  streaming mode
+TEST(121)
+{
+  db::Layout g;
+
+  unsigned int l1 = g.insert_layer (db::LayerProperties (1, 0));
+  unsigned int l2 = g.insert_layer (db::LayerProperties (2, 5, "NAMED"));
+
+  db::Cell &top = g.cell (g.add_cell ("TOP"));
+  db::Cell &a = g.cell (g.add_cell ("A"));
+  db::Cell &b = g.cell (g.add_cell ("B"));
+
+  db::PropertiesRepository::properties_set ps;
+  ps.insert (std::make_pair (g.properties_repository ().prop_name_id (tl::Variant ("PROP")), tl::Variant ("VALUE")));
+  ps.insert (std::make_pair (g.properties_repository ().prop_name_id (tl::Variant ("P2")), tl::Variant ("42")));
+  db::properties_id_type pid = g.properties_repository ().properties_id (ps);
+
+  a.shapes (l1).insert (db::Box (0, 0, 100, 200));
+  a.shapes (l2).insert (db::Text ("A", db::Trans (db::Vector (10, 20))));
+  a.shapes (l2).insert (db::TextWithProperties (db::Text ("B", db::Trans (db::Vector (30, 20))), pid));
+
+  db::Point pts[] = { db::Point (0, 0), db::Point (0, 1000), db::Point (500, 1000), db::Point (700, 0) };
+  db::Polygon poly;
+  poly.assign_hull (pts, pts + sizeof (pts) / sizeof (pts [0]));
+  b.shapes (l2).insert (db::PolygonWithProperties (poly, pid));
+  b.shapes (l1).insert (db::Path (pts, pts + 3, 20));
+  b.insert (db::CellInstArray (db::CellInst (a.cell_index ()), db::Trans ()));
+
+  //  enough shapes to produce several slices
+  for (int i = 0; i < 1000; ++i) {
+    top.shapes (l1).insert (db::Box (i * 10, 0, i * 10 + 5, 100));
+  }
+  top.insert (db::CellInstArray (db::CellInst (a.cell_index ()), db::Trans (db::Vector (0, 5000)), db::Vector (1000, 0), db::Vector (0, 1000), 3, 2));
+  top.insert (db::CellInstArrayWithProperties (db::CellInstArray (db::CellInst (b.cell_index ()), db::Trans (1, true, db::Vector (-100, 200))), pid));
+
+  db::OASISWriterOptions oasis_options;
+  oasis_options.compression_level = 0;
+  oasis_options.write_cblocks = false;
+  oasis_options.strict_mode = false;
+
+  run_streaming_test (_this, g, oasis_options);
+
+  oasis_options.compression_level = 2;
+  oasis_options.write_cblocks = true;
+  oasis_options.strict_mode = true;
+  oasis_options.write_std_properties = 2;
+
+  run_streaming_test (_this, g, oasis_options);
+}
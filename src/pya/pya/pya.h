@@ -113,6 +113,14 @@ public:
    */
   ~PythonInterpreter ();
 
+  /**
+   *  @brief Gets a value indicating whether the interpreter is an embedded one
+   */
+  bool is_embedded () const
+  {
+    return m_embedded;
+  }
+
   /**
    *  @brief Add the given path to the search path
    */
@@ -187,6 +187,16 @@ std::string python2c_func<std::string>::operator() (PyObject *rval)
     return std::string (PyBytes_AsString (ba.get ()), PyBytes_Size (ba.get ()));
   } else if (PyByteArray_Check (rval)) {
     return std::string (PyByteArray_AsString (rval), PyByteArray_Size (rval));
+  } else if (PyObject_CheckBuffer (rval)) {
+    //  objects providing a contiguous buffer (e.g. memoryview or numpy arrays) deliver their raw bytes
+    Py_buffer view;
+    if (PyObject_GetBuffer (rval, &view, PyBUF_CONTIG_RO) != 0) {
+      check_error ();
+      throw tl::Exception (tl::to_string (tr ("Argument cannot be converted to a string")));
+    }
+    std::string s ((const char *) view.buf, size_t (view.len));
+    PyBuffer_Release (&view);
+    return s;
   } else {
     throw tl::Exception (tl::to_string (tr ("Argument cannot be converted to a string")));
   }
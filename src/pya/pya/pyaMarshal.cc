@@ -25,6 +25,7 @@
 #include "pyaObject.h"
 #include "pyaConvert.h"
 #include "pyaModule.h"
+#include "pyaUtils.h"
 
 #include "gsiTypes.h"
 #include "gsiObjectHolder.h"
@@ -34,6 +35,12 @@ namespace pya
 
 // -------------------------------------------------------------------
 //  Serialization adaptors for strings, variants, vectors and maps
+//
+//  These adaptors are used for callback return values too. In that case
+//  they are consumed and destroyed by C++ code after the callback has
+//  returned - potentially inside a method which has released the GIL
+//  (see PythonAllowThreads). Hence all methods touching Python objects
+//  need to acquire the lock.
 
 /**
  *  @brief An adaptor for a string from ruby objects
@@ -48,6 +55,12 @@ public:
     //  .. nothing yet ..
   }
 
+  ~PythonBasedStringAdaptor ()
+  {
+    PythonEnsureLock ensure_lock;
+    m_string = PythonPtr ();
+  }
+
   virtual const char *c_str () const
   {
     return m_stdstr.c_str ();
@@ -76,6 +89,7 @@ class PythonBasedVariantAdaptor
 {
 public:
   PythonBasedVariantAdaptor (const PythonPtr &var);
+  ~PythonBasedVariantAdaptor ();
 
   virtual tl::Variant var () const;
   virtual void set (const tl::Variant &v);
@@ -92,6 +106,7 @@ class PythonBasedVectorAdaptorIterator
 {
 public:
   PythonBasedVectorAdaptorIterator (const PythonPtr &array, size_t len, const gsi::ArgType *ainner);
+  ~PythonBasedVectorAdaptorIterator ();
 
   virtual void get (gsi::SerialArgs &w, tl::Heap &heap) const;
   virtual bool at_end () const;
@@ -111,6 +126,7 @@ class PythonBasedVectorAdaptor
 {
 public:
   PythonBasedVectorAdaptor (const PythonPtr &array, const gsi::ArgType *ainner);
+  ~PythonBasedVectorAdaptor ();
 
   virtual gsi::VectorAdaptorIterator *create_iterator () const;
   virtual void push (gsi::SerialArgs &r, tl::Heap &heap);
@@ -131,6 +147,7 @@ class PythonBasedMapAdaptorIterator
 {
 public:
   PythonBasedMapAdaptorIterator (const PythonPtr &hash, const gsi::ArgType *ainner, const gsi::ArgType *ainner_k);
+  ~PythonBasedMapAdaptorIterator ();
 
   virtual void get (gsi::SerialArgs &w, tl::Heap &heap) const;
   virtual bool at_end () const;
@@ -152,6 +169,7 @@ class PythonBasedMapAdaptor
 {
 public:
   PythonBasedMapAdaptor (const PythonPtr &hash, const gsi::ArgType *ainner, const gsi::ArgType *ainner_k);
+  ~PythonBasedMapAdaptor ();
 
   virtual gsi::MapAdaptorIterator *create_iterator () const;
   virtual void insert (gsi::SerialArgs &r, tl::Heap &heap);
@@ -527,6 +545,12 @@ struct reader<gsi::StringType>
     std::auto_ptr<gsi::StringAdaptor> a ((gsi::StringAdaptor *) rr->read<void *>(*heap));
     if (!a.get ()) {
       *ret = PythonRef (Py_None, false /*borrowed*/);
+    } else if (a->is_binary ()) {
+#if PY_MAJOR_VERSION < 3
+      *ret = PyString_FromStringAndSize (a->c_str (), Py_ssize_t (a->size ()));
+#else
+      *ret = PyBytes_FromStringAndSize (a->c_str (), Py_ssize_t (a->size ()));
+#endif
     } else {
       *ret = c2python (std::string (a->c_str (), a->size ()));
     }
@@ -696,8 +720,15 @@ PythonBasedVariantAdaptor::PythonBasedVariantAdaptor (const PythonPtr &var)
   //  .. nothing yet ..
 }
 
+PythonBasedVariantAdaptor::~PythonBasedVariantAdaptor ()
+{
+  PythonEnsureLock ensure_lock;
+  m_var = PythonPtr ();
+}
+
 tl::Variant PythonBasedVariantAdaptor::var () const
 {
+  PythonEnsureLock ensure_lock;
   return python2c<tl::Variant> (m_var.get ());
 }
 
@@ -715,8 +746,15 @@ PythonBasedVectorAdaptorIterator::PythonBasedVectorAdaptorIterator (const Python
   //  .. nothing yet ..
 }
 
+PythonBasedVectorAdaptorIterator::~PythonBasedVectorAdaptorIterator ()
+{
+  PythonEnsureLock ensure_lock;
+  m_array = PythonPtr ();
+}
+
 void PythonBasedVectorAdaptorIterator::get (gsi::SerialArgs &w, tl::Heap &heap) const
 {
+  PythonEnsureLock ensure_lock;
   PyObject *member = NULL;
   if (PyTuple_Check (m_array.get ())) {
     member = PyTuple_GetItem (m_array.get (), m_i);
@@ -745,13 +783,21 @@ PythonBasedVectorAdaptor::PythonBasedVectorAdaptor (const PythonPtr &array, cons
   //  .. nothing yet ..
 }
 
+PythonBasedVectorAdaptor::~PythonBasedVectorAdaptor ()
+{
+  PythonEnsureLock ensure_lock;
+  m_array = PythonPtr ();
+}
+
 gsi::VectorAdaptorIterator *PythonBasedVectorAdaptor::create_iterator () const
 {
+  PythonEnsureLock ensure_lock;
   return new PythonBasedVectorAdaptorIterator (m_array, size (), mp_ainner);
 }
 
 void PythonBasedVectorAdaptor::push (gsi::SerialArgs &r, tl::Heap &heap)
 {
+  PythonEnsureLock ensure_lock;
   if (PyList_Check (m_array.get ())) {
     PythonRef member;
     gsi::do_on_type<reader> () (mp_ainner->type (), &r, &member, (PYAObjectBase *) 0, *mp_ainner, &heap);
@@ -763,6 +809,7 @@ void PythonBasedVectorAdaptor::push (gsi::SerialArgs &r, tl::Heap &heap)
 
 void PythonBasedVectorAdaptor::clear ()
 {
+  PythonEnsureLock ensure_lock;
   if (PySequence_Check (m_array.get ())) {
     PySequence_DelSlice (m_array.get (), 0, PySequence_Length (m_array.get ()));
   }
@@ -770,6 +817,7 @@ void PythonBasedVectorAdaptor::clear ()
 
 size_t PythonBasedVectorAdaptor::size () const
 {
+  PythonEnsureLock ensure_lock;
   if (PySequence_Check (m_array.get ())) {
     return PySequence_Length (m_array.get ());
   } else {
@@ -788,13 +836,21 @@ size_t PythonBasedVectorAdaptor::serial_size () const
 PythonBasedMapAdaptorIterator::PythonBasedMapAdaptorIterator (const PythonPtr &hash, const gsi::ArgType *ainner, const gsi::ArgType *ainner_k)
   : mp_ainner (ainner), mp_ainner_k (ainner_k)
 {
+  PythonEnsureLock ensure_lock;
   m_pos = 0;
   m_hash = hash;
   inc ();
 }
 
+PythonBasedMapAdaptorIterator::~PythonBasedMapAdaptorIterator ()
+{
+  PythonEnsureLock ensure_lock;
+  m_hash = PythonPtr ();
+}
+
 void PythonBasedMapAdaptorIterator::get (gsi::SerialArgs &w, tl::Heap &heap) const
 {
+  PythonEnsureLock ensure_lock;
   gsi::do_on_type<writer> () (mp_ainner_k->type (), &w, m_key, *mp_ainner_k, &heap);
   gsi::do_on_type<writer> () (mp_ainner->type (), &w, m_value, *mp_ainner, &heap);
 }
@@ -806,6 +862,7 @@ bool PythonBasedMapAdaptorIterator::at_end () const
 
 void PythonBasedMapAdaptorIterator::inc ()
 {
+  PythonEnsureLock ensure_lock;
   m_has_items = PyDict_Next(m_hash.get (), &m_pos, &m_key, &m_value);
 }
 
@@ -815,6 +872,13 @@ void PythonBasedMapAdaptorIterator::inc ()
 PythonBasedMapAdaptor::PythonBasedMapAdaptor (const PythonPtr &hash, const gsi::ArgType *ainner, const gsi::ArgType *ainner_k)
   : mp_ainner (ainner), mp_ainner_k (ainner_k), m_hash (hash)
 {
+  //  .. nothing yet ..
+}
+
+PythonBasedMapAdaptor::~PythonBasedMapAdaptor ()
+{
+  PythonEnsureLock ensure_lock;
+  m_hash = PythonPtr ();
 }
 
 gsi::MapAdaptorIterator *PythonBasedMapAdaptor::create_iterator () const
@@ -824,6 +888,7 @@ gsi::MapAdaptorIterator *PythonBasedMapAdaptor::create_iterator () const
 
 void PythonBasedMapAdaptor::insert (gsi::SerialArgs &r, tl::Heap &heap)
 {
+  PythonEnsureLock ensure_lock;
   PythonRef k, v;
   gsi::do_on_type<reader> () (mp_ainner_k->type (), &r, &k, (PYAObjectBase *) 0, *mp_ainner_k, &heap);
   gsi::do_on_type<reader> () (mp_ainner->type (), &r, &v, (PYAObjectBase *) 0, *mp_ainner, &heap);
@@ -832,11 +897,13 @@ void PythonBasedMapAdaptor::insert (gsi::SerialArgs &r, tl::Heap &heap)
 
 void PythonBasedMapAdaptor::clear ()
 {
+  PythonEnsureLock ensure_lock;
   PyDict_Clear (m_hash.get ());
 }
 
 size_t PythonBasedMapAdaptor::size () const
 {
+  PythonEnsureLock ensure_lock;
   return PyDict_Size (m_hash.get ());
 }
 
@@ -924,6 +991,8 @@ struct test_arg_func<gsi::StringType>
       *ret = true;
     } else if (PyByteArray_Check (arg)) {
       *ret = true;
+    } else if (PyObject_CheckBuffer (arg)) {
+      *ret = true;
     } else {
       *ret = false;
     }
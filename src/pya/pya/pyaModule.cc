@@ -40,6 +40,71 @@ namespace pya
 // -------------------------------------------------------------------
 //  The lookup table for the method overload resolution
 
+/**
+ *  @brief The argument signature of a call for the overload resolution cache
+ *
+ *  The signature consists of the Python types of the arguments and the
+ *  constness of the object references (including "self"). Overload resolution
+ *  depends on these properties only, with the exception of containers (lists,
+ *  tuples and dicts) whose members are checked as well. Hence, calls with
+ *  container arguments or too many arguments don't have a signature.
+ */
+struct CallSignature
+{
+  enum { max_args = 8 };
+
+  CallSignature ()
+    : argc (0), const_flags (0)
+  { }
+
+  /**
+   *  @brief Forms the signature for the given call
+   *  Returns false if no signature can be formed.
+   */
+  bool init (PYAObjectBase *self, PyObject *args)
+  {
+    argc = args == NULL ? 0 : int (PyTuple_Size (args));
+    if (argc > int (max_args)) {
+      return false;
+    }
+
+    const_flags = (self && self->const_ref ()) ? 1 : 0;
+
+    for (int i = 0; i < argc; ++i) {
+
+      PyObject *a = PyTuple_GetItem (args, i);
+      if (PyList_Check (a) || PyTuple_Check (a) || PyDict_Check (a)) {
+        return false;
+      }
+
+      types [i] = Py_TYPE (a);
+      if (PythonModule::cls_for_type (types [i]) && PYAObjectBase::from_pyobject (a)->const_ref ()) {
+        const_flags |= (2 << i);
+      }
+
+    }
+
+    return true;
+  }
+
+  bool operator== (const CallSignature &other) const
+  {
+    if (argc != other.argc || const_flags != other.const_flags) {
+      return false;
+    }
+    for (int i = 0; i < argc; ++i) {
+      if (types [i] != other.types [i]) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  int argc;
+  unsigned int const_flags;
+  PyTypeObject *types [max_args];
+};
+
 /**
  *  @brief A single entry in the method table
  *  This class provides an entry for one name. It provides flags
@@ -52,7 +117,7 @@ public:
   typedef std::vector<const gsi::MethodBase *>::const_iterator method_iterator;
 
   MethodTableEntry (const std::string &name, bool st, bool prot)
-    : m_name (name), m_is_static (st), m_is_protected (prot)
+    : m_name (name), m_is_static (st), m_is_protected (prot), m_next_cache_entry (0)
   { }
 
   const std::string &name () const
@@ -93,11 +158,43 @@ public:
     return m_methods.end ();
   }
 
+  /**
+   *  @brief Looks up the overload resolved before for the given call signature
+   *  Returns 0 if there is no such entry.
+   */
+  const gsi::MethodBase *cached_overload (const CallSignature &sig) const
+  {
+    for (std::vector<std::pair<CallSignature, const gsi::MethodBase *> >::const_iterator c = m_overload_cache.begin (); c != m_overload_cache.end (); ++c) {
+      if (c->first == sig) {
+        return c->second;
+      }
+    }
+    return 0;
+  }
+
+  /**
+   *  @brief Stores the resolved overload for the given call signature
+   *  The cache keeps a few signatures only (usually a method is called with one
+   *  or two signatures) and replaces the entries round-robin.
+   */
+  void cache_overload (const CallSignature &sig, const gsi::MethodBase *m) const
+  {
+    const size_t max_cache_entries = 4;
+    if (m_overload_cache.size () < max_cache_entries) {
+      m_overload_cache.push_back (std::make_pair (sig, m));
+    } else {
+      m_overload_cache [m_next_cache_entry] = std::make_pair (sig, m);
+      m_next_cache_entry = (m_next_cache_entry + 1) % max_cache_entries;
+    }
+  }
+
 private:
   std::string m_name;
   bool m_is_static : 1;
   bool m_is_protected : 1;
   std::vector<const gsi::MethodBase *> m_methods;
+  mutable std::vector<std::pair<CallSignature, const gsi::MethodBase *> > m_overload_cache;
+  mutable size_t m_next_cache_entry;
 };
 
 /**
@@ -335,6 +432,14 @@ public:
     return m_table[mid - m_method_offset].end ();
   }
 
+  /**
+   *  @brief Gets the entry for method ID mid
+   */
+  const MethodTableEntry &entry (size_t mid) const
+  {
+    return m_table[mid - m_method_offset];
+  }
+
   /**
    *  @brief Finishes construction of the table
    *  This method must be called after the add_method calls have been used
@@ -780,6 +885,17 @@ match_method (int mid, PyObject *self, PyObject *args, bool strict)
 
   }
 
+  //  more than one candidate -> use the cached resolution if there is one
+  CallSignature sig;
+  bool has_sig = false;
+  if (candidates > 1) {
+    has_sig = sig.init (p, args);
+    const gsi::MethodBase *cached = has_sig ? mt->entry (mid).cached_overload (sig) : 0;
+    if (cached) {
+      return cached;
+    }
+  }
+
   //  more than one candidate -> refine by checking the arguments
   if (candidates > 1) {
 
@@ -859,6 +975,10 @@ match_method (int mid, PyObject *self, PyObject *args, bool strict)
     }
   }
 
+  if (has_sig) {
+    mt->entry (mid).cache_overload (sig, meth);
+  }
+
   return meth;
 }
 
@@ -1162,7 +1282,10 @@ method_adaptor (int mid, PyObject *self, PyObject *args)
 
       }
 
-      meth->call (obj, arglist, retlist);
+      {
+        PythonAllowThreads allow_threads (meth->is_long_running ());
+        meth->call (obj, arglist, retlist);
+      }
 
       ret = get_return_value (p, retlist, meth, heap);
 
@@ -1713,7 +1836,10 @@ method_init_adaptor (int mid, PyObject *self, PyObject *args)
 
       }
 
-      meth->call (0, arglist, retlist);
+      {
+        PythonAllowThreads allow_threads (meth->is_long_running ());
+        meth->call (0, arglist, retlist);
+      }
 
       void *obj = retlist.read<void *> (heap);
       if (obj) {
@@ -1950,7 +2076,10 @@ property_getter_impl (int mid, PyObject *self)
 
     gsi::SerialArgs retlist (meth->retsize ());
     gsi::SerialArgs arglist (0);
-    meth->call (obj, arglist, retlist);
+    {
+      PythonAllowThreads allow_threads (meth->is_long_running ());
+      meth->call (obj, arglist, retlist);
+    }
 
     PyObject *ret = get_return_value (p, retlist, meth, heap);
 
@@ -2119,7 +2248,10 @@ property_setter_impl (int mid, PyObject *self, PyObject *value)
     gsi::MethodBase::argument_iterator a = meth->begin_arguments ();
     push_arg (*a, arglist, value, heap);
 
-    meth->call (obj, arglist, retlist);
+    {
+      PythonAllowThreads allow_threads (meth->is_long_running ());
+      meth->call (obj, arglist, retlist);
+    }
 
     return get_return_value (p, retlist, meth, heap);
 
@@ -122,6 +122,9 @@ Callee::can_call () const
 void 
 Callee::call (int id, gsi::SerialArgs &args, gsi::SerialArgs &ret) const
 {
+  //  the lock may have been released by a long-running method
+  PythonEnsureLock ensure_lock;
+
   const gsi::MethodBase *meth = m_cbfuncs [id].method ();
 
   try {
@@ -123,6 +123,9 @@ SignalHandler::~SignalHandler ()
 
 void SignalHandler::call (const gsi::MethodBase *meth, gsi::SerialArgs &args, gsi::SerialArgs &ret) const
 {
+  //  the lock may have been released by a long-running method
+  PythonEnsureLock ensure_lock;
+
   PYTHON_BEGIN_EXEC
 
     tl::Heap heap;
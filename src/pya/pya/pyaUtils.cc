@@ -132,5 +132,49 @@ void check_error ()
   }
 }
 
+// --------------------------------------------------------------------------
+//  PythonAllowThreads implementation
+
+PythonAllowThreads::PythonAllowThreads (bool release)
+  : mp_thread_state (0)
+{
+  if (release && PythonInterpreter::instance () && ! PythonInterpreter::instance ()->is_embedded ()) {
+    mp_thread_state = (void *) PyEval_SaveThread ();
+  }
+}
+
+PythonAllowThreads::~PythonAllowThreads ()
+{
+  if (mp_thread_state) {
+    PyEval_RestoreThread ((PyThreadState *) mp_thread_state);
+    mp_thread_state = 0;
+  }
+}
+
+// --------------------------------------------------------------------------
+//  PythonEnsureLock implementation
+
+PythonEnsureLock::PythonEnsureLock ()
+  : m_gil_state (0), m_acquired (false)
+{
+#if PY_VERSION_HEX >= 0x03040000
+  //  avoid the overhead if we already own the lock (the usual case)
+  if (PyGILState_Check ()) {
+    return;
+  }
+#endif
+  if (Py_IsInitialized ()) {
+    m_gil_state = int (PyGILState_Ensure ());
+    m_acquired = true;
+  }
 }
 
+PythonEnsureLock::~PythonEnsureLock ()
+{
+  if (m_acquired) {
+    PyGILState_Release ((PyGILState_STATE) m_gil_state);
+    m_acquired = false;
+  }
+}
+
+}
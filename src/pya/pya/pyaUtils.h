@@ -70,6 +70,49 @@ namespace pya
  */
 void check_error ();
 
+/**
+ *  @brief Releases the global interpreter lock while this object is alive
+ *
+ *  This object is used to frame calls of long-running C++ methods
+ *  (see gsi::MethodBase::is_long_running). Other Python threads can run
+ *  while such a method is executed. The lock is only released if "release"
+ *  is true and Python is not embedded into the application. In the embedded
+ *  case, the application's event loop may enter the interpreter through paths
+ *  other than callbacks, so the lock is kept.
+ */
+class PythonAllowThreads
+{
+public:
+  PythonAllowThreads (bool release = true);
+  ~PythonAllowThreads ();
+
+private:
+  void *mp_thread_state;
+
+  PythonAllowThreads (const PythonAllowThreads &);
+  PythonAllowThreads &operator= (const PythonAllowThreads &);
+};
+
+/**
+ *  @brief Makes sure the calling thread holds the global interpreter lock while this object is alive
+ *
+ *  This object is used to frame code calling back into Python from C++. If the
+ *  lock has been released by PythonAllowThreads, it is reacquired temporarily.
+ */
+class PythonEnsureLock
+{
+public:
+  PythonEnsureLock ();
+  ~PythonEnsureLock ();
+
+private:
+  int m_gil_state;
+  bool m_acquired;
+
+  PythonEnsureLock (const PythonEnsureLock &);
+  PythonEnsureLock &operator= (const PythonEnsureLock &);
+};
+
 }
 
 #endif
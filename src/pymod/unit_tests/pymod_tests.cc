@@ -87,6 +87,7 @@ PYMODTEST (bridge, "bridge.py")
 PYMODTEST (import_tl, "import_tl.py")
 PYMODTEST (import_db, "import_db.py")
 PYMODTEST (import_rdb, "import_rdb.py")
+PYMODTEST (gil_release, "gil_release.py")
 
 #if defined(HAVE_QT) && defined(HAVE_QTBINDINGS)
 
@@ -885,6 +885,46 @@ method_name_from_id (int mid, VALUE self)
   return cls_decl->name () + "::" + mt->name (mid);
 }
 
+/**
+ *  @brief Executes a method call with the GVL released
+ */
+class MethodCallWithoutGVL
+  : public GVLFunction
+{
+public:
+  MethodCallWithoutGVL (const gsi::MethodBase *meth, void *obj, gsi::SerialArgs &args, gsi::SerialArgs &ret)
+    : mp_meth (meth), mp_obj (obj), mp_args (&args), mp_ret (&ret)
+  { }
+
+protected:
+  virtual void do_call ()
+  {
+    mp_meth->call (mp_obj, *mp_args, *mp_ret);
+  }
+
+private:
+  const gsi::MethodBase *mp_meth;
+  void *mp_obj;
+  gsi::SerialArgs *mp_args, *mp_ret;
+};
+
+/**
+ *  @brief Calls the method, releasing the GVL for long-running methods if possible
+ *
+ *  The GVL is released only in Ruby threads other than the main one. The main
+ *  thread serves the application (e.g. the progress reporter and the event loop)
+ *  which may call back into Ruby without knowing about the GVL.
+ */
+static void
+call_method (const gsi::MethodBase *meth, void *obj, gsi::SerialArgs &args, gsi::SerialArgs &ret)
+{
+  if (meth->is_long_running () && rb_thread_current () != rb_thread_main ()) {
+    MethodCallWithoutGVL (meth, obj, args, ret).call_without_gvl ();
+  } else {
+    meth->call (obj, args, ret);
+  }
+}
+
 VALUE
 method_adaptor (int mid, int argc, VALUE *argv, VALUE self, bool ctor)
 {
@@ -1023,7 +1063,7 @@ method_adaptor (int mid, int argc, VALUE *argv, VALUE self, bool ctor)
 
         }
 
-        meth->call (obj, arglist, retlist);
+        call_method (meth, obj, arglist, retlist);
 
       }
 
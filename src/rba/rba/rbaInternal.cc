@@ -242,6 +242,77 @@ private:
   InternalGC *mp_gc;
 };
 
+// --------------------------------------------------------------------------
+//  Helpers to reacquire the GVL in callbacks
+
+/**
+ *  @brief Executes a Proxy callback with the GVL held
+ */
+class ProxyCallWithGVL
+  : public GVLFunction
+{
+public:
+  ProxyCallWithGVL (const Proxy *proxy, int id, gsi::SerialArgs &args, gsi::SerialArgs &ret)
+    : mp_proxy (proxy), m_id (id), mp_args (&args), mp_ret (&ret)
+  { }
+
+protected:
+  virtual void do_call ()
+  {
+    mp_proxy->call (m_id, *mp_args, *mp_ret);
+  }
+
+private:
+  const Proxy *mp_proxy;
+  int m_id;
+  gsi::SerialArgs *mp_args, *mp_ret;
+};
+
+/**
+ *  @brief Delivers a Proxy status event with the GVL held
+ */
+class ProxyStatusChangedWithGVL
+  : public GVLFunction
+{
+public:
+  ProxyStatusChangedWithGVL (Proxy *proxy, gsi::ObjectBase::StatusEventType type)
+    : mp_proxy (proxy), m_type (type)
+  { }
+
+protected:
+  virtual void do_call ()
+  {
+    mp_proxy->object_status_changed (m_type);
+  }
+
+private:
+  Proxy *mp_proxy;
+  gsi::ObjectBase::StatusEventType m_type;
+};
+
+/**
+ *  @brief Executes a signal handler with the GVL held
+ */
+class SignalHandlerCallWithGVL
+  : public GVLFunction
+{
+public:
+  SignalHandlerCallWithGVL (const SignalHandler *handler, const gsi::MethodBase *meth, gsi::SerialArgs &args, gsi::SerialArgs &ret)
+    : mp_handler (handler), mp_meth (meth), mp_args (&args), mp_ret (&ret)
+  { }
+
+protected:
+  virtual void do_call ()
+  {
+    mp_handler->call (mp_meth, *mp_args, *mp_ret);
+  }
+
+private:
+  const SignalHandler *mp_handler;
+  const gsi::MethodBase *mp_meth;
+  gsi::SerialArgs *mp_args, *mp_ret;
+};
+
 // --------------------------------------------------------------------------
 //  Proxy implementation
 
@@ -309,6 +380,12 @@ bool Proxy::can_call () const
 void
 Proxy::call (int id, gsi::SerialArgs &args, gsi::SerialArgs &ret) const
 {
+  if (GVLFunction::gvl_released ()) {
+    //  called from a long-running method which has released the GVL
+    ProxyCallWithGVL (this, id, args, ret).call_with_gvl ();
+    return;
+  }
+
   GCDisabler gc_disabler;
 
   tl_assert (id < int (m_cbfuncs.size ()) && id >= 0);
@@ -696,6 +773,11 @@ Proxy::obj ()
 void
 Proxy::object_status_changed (gsi::ObjectBase::StatusEventType type)
 {
+  if (GVLFunction::gvl_released ()) {
+    ProxyStatusChangedWithGVL (this, type).call_with_gvl ();
+    return;
+  }
+
   if (type == gsi::ObjectBase::ObjectDestroyed) {
     m_destroyed = true;  //  NOTE: must be set before detach and indicates that the object was destroyed externally.
     detach ();
@@ -887,6 +969,11 @@ SignalHandler::define_class (VALUE module, const char *name)
 
 void SignalHandler::call (const gsi::MethodBase *meth, gsi::SerialArgs &args, gsi::SerialArgs &ret) const
 {
+  if (GVLFunction::gvl_released ()) {
+    SignalHandlerCallWithGVL (this, meth, args, ret).call_with_gvl ();
+    return;
+  }
+
   GCDisabler gc_disabler;
 
   VALUE argv = rb_ary_new2 (long (std::distance (meth->begin_arguments (), meth->end_arguments ())));
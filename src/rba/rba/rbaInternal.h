@@ -167,6 +167,8 @@ private:
 
   void initialize_callbacks ();
 
+  friend class ProxyStatusChangedWithGVL;
+
   void object_status_changed (gsi::ObjectBase::StatusEventType type);
   void keep_internal ();
 };
@@ -27,9 +27,15 @@
 #include "rbaUtils.h"
 #include "rbaInternal.h"
 
+#include "tlThreads.h"
+#include "tlProgress.h"
+
 #if HAVE_RUBY_VERSION_CODE >= 20200
 #  include <ruby/debug.h>
 #endif
+#if HAVE_RUBY_VERSION_CODE >= 20000
+#  include <ruby/thread.h>
+#endif
 
 static VALUE ruby_top_self = Qnil;
 
@@ -507,6 +513,128 @@ rba_yield_checked (VALUE value)
   }
 }
 
+// -------------------------------------------------------------------
+//  GVLFunction implementation
+
+//  Indicates whether the current thread has released the GVL
+static tl::ThreadStorage<bool> s_gvl_released;
+
+static void set_gvl_released (bool f)
+{
+  s_gvl_released.setLocalData (f);
+}
+
+GVLFunction::GVLFunction ()
+  : m_error (NoError), m_exit_status (0), mp_ruby_error (0)
+{
+  //  .. nothing yet ..
+}
+
+GVLFunction::~GVLFunction ()
+{
+  delete mp_ruby_error;
+  mp_ruby_error = 0;
+}
+
+bool
+GVLFunction::gvl_released ()
+{
+  return s_gvl_released.hasLocalData () && s_gvl_released.localData ();
+}
+
+void
+GVLFunction::call_without_gvl ()
+{
+#if HAVE_RUBY_VERSION_CODE >= 20000
+  if (! gvl_released ()) {
+    rb_thread_call_without_gvl (&GVLFunction::execute_released, (void *) this, 0, 0);
+    rethrow ();
+    return;
+  }
+#endif
+  do_call ();
+}
+
+void
+GVLFunction::call_with_gvl ()
+{
+#if HAVE_RUBY_VERSION_CODE >= 20000
+  if (gvl_released ()) {
+    rb_thread_call_with_gvl (&GVLFunction::execute_acquired, (void *) this);
+    rethrow ();
+    return;
+  }
+#endif
+  do_call ();
+}
+
+void *
+GVLFunction::execute_released (void *self)
+{
+  set_gvl_released (true);
+  ((GVLFunction *) self)->execute ();
+  set_gvl_released (false);
+  return 0;
+}
+
+void *
+GVLFunction::execute_acquired (void *self)
+{
+  set_gvl_released (false);
+  ((GVLFunction *) self)->execute ();
+  set_gvl_released (true);
+  return 0;
+}
+
+void
+GVLFunction::execute ()
+{
+  m_error = NoError;
+
+  try {
+    do_call ();
+  } catch (tl::ExitException &ex) {
+    m_error = ExitError;
+    m_exit_status = ex.status ();
+  } catch (rba::RubyError &ex) {
+    m_error = RubyExceptionError;
+    delete mp_ruby_error;
+    mp_ruby_error = new rba::RubyError (ex);
+  } catch (tl::CancelException &) {
+    m_error = CancelError;
+  } catch (tl::BreakException &) {
+    m_error = BreakError;
+  } catch (tl::Exception &ex) {
+    m_error = GenericError;
+    m_msg = ex.msg ();
+  } catch (std::exception &ex) {
+    m_error = GenericError;
+    m_msg = ex.what ();
+  } catch (...) {
+    m_error = GenericError;
+    m_msg = tl::to_string (tr ("Unspecific exception"));
+  }
+}
+
+void
+GVLFunction::rethrow ()
+{
+  error_type e = m_error;
+  m_error = NoError;
+
+  if (e == ExitError) {
+    throw tl::ExitException (m_exit_status);
+  } else if (e == RubyExceptionError) {
+    throw rba::RubyError (*mp_ruby_error);
+  } else if (e == CancelError) {
+    throw tl::CancelException ();
+  } else if (e == BreakError) {
+    throw tl::BreakException ();
+  } else if (e == GenericError) {
+    throw tl::Exception (m_msg);
+  }
+}
+
 #if HAVE_RUBY_VERSION_CODE >= 20200
 static VALUE debug_inspector_get_binding (const rb_debug_inspector_t *dbg_context, void *data)
 {
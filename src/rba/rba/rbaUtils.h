@@ -223,6 +223,67 @@ VALUE rba_f_eval_checked (int argc, VALUE *argv, VALUE self);
 void rba_yield_checked (VALUE value);
 VALUE rba_eval_string_in_context (const char *expr, const char *file, int line, int context);
 
+class RubyError;
+
+/**
+ *  @brief A function object which can be executed with the Ruby GVL released or reacquired
+ *
+ *  Ruby threads run C code only while holding the global VM lock (GVL). Long-running
+ *  native functions can give up the GVL so other Ruby threads can run meanwhile.
+ *  While the GVL is released, no Ruby API must be used. Functions which need Ruby
+ *  (i.e. callbacks into Ruby code) need to reacquire the GVL with "call_with_gvl".
+ *
+ *  C++ exceptions must not propagate through the Ruby runtime. Hence, exceptions
+ *  thrown by "do_call" are captured and rethrown after the GVL state has been
+ *  restored. Exceptions are rethrown as tl::ExitException, rba::RubyError or
+ *  tl::Exception (carrying the message only).
+ */
+class GVLFunction
+{
+public:
+  GVLFunction ();
+  virtual ~GVLFunction ();
+
+  /**
+   *  @brief Executes the function with the GVL released
+   *
+   *  For Ruby versions before 2.0, the function is executed directly.
+   */
+  void call_without_gvl ();
+
+  /**
+   *  @brief Executes the function making sure the GVL is held
+   *
+   *  If the GVL was released by "call_without_gvl" before, it is reacquired.
+   *  Otherwise, the function is executed directly.
+   */
+  void call_with_gvl ();
+
+  /**
+   *  @brief Returns true, if the current thread has released the GVL through "call_without_gvl"
+   */
+  static bool gvl_released ();
+
+protected:
+  /**
+   *  @brief Reimplement this method to provide the function
+   */
+  virtual void do_call () = 0;
+
+private:
+  enum error_type { NoError, ExitError, RubyExceptionError, CancelError, BreakError, GenericError };
+
+  error_type m_error;
+  std::string m_msg;
+  int m_exit_status;
+  RubyError *mp_ruby_error;
+
+  static void *execute_released (void *self);
+  static void *execute_acquired (void *self);
+  void execute ();
+  void rethrow ();
+};
+
 /**
  *  @brief A struct encapsulating the call parameters for a function
  */
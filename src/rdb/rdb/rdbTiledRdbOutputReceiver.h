@@ -35,7 +35,7 @@ namespace rdb
 /**
  *  @brief A helper class for the generic implementation of the insert functionality
  */
-class RdbInserter
+class RDB_PUBLIC RdbInserter
 {
 public:
   RdbInserter (rdb::Database *rdb, rdb::id_type cell_id, rdb::id_type category_id, const db::CplxTrans &trans);
@@ -58,7 +58,7 @@ private:
 /**
  *  @brief A receiver for the db::TilingProcessor putting the output to the given RDB
  */
-class TiledRdbOutputReceiver
+class RDB_PUBLIC TiledRdbOutputReceiver
   : public db::TileOutputReceiver
 {
 public:
@@ -23,6 +23,7 @@ SOURCES = \
     tlInternational.cc \
     tlLog.cc \
     tlObject.cc \
+    tlParallelGZip.cc \
     tlProgress.cc \
     tlScriptError.cc \
     tlStaticObjects.cc \
@@ -47,7 +48,8 @@ SOURCES = \
     tlEquivalenceClusters.cc \
     tlUniqueName.cc \
     tlRecipe.cc \
-    tlEnv.cc
+    tlEnv.cc \
+    tlPixelBuffer.cc
 
 HEADERS = \
     tlAlgorithm.h \
@@ -70,6 +72,7 @@ HEADERS = \
     tlLog.h \
     tlObject.h \
     tlObjectCollection.h \
+    tlParallelGZip.h \
     tlProgress.h \
     tlReuseVector.h \
     tlScriptError.h \
@@ -105,7 +108,8 @@ HEADERS = \
     tlUniqueName.h \
     tlRecipe.h \
     tlSelect.h \
-    tlEnv.h
+    tlEnv.h \
+    tlPixelBuffer.h
 
 equals(HAVE_CURL, "1") {
 
@@ -26,12 +26,58 @@
 #include "tlAssert.h"
 
 #include <algorithm>
+#include <vector>
+#include <string.h>
 
 #include <zlib.h>
 
 namespace tl
 {
 
+// ------------------------------------------------------------------------
+//  BitStream implementation
+
+void
+BitStream::fill (unsigned int n, bool required)
+{
+  //  The whole bytes still in the buffer have been obtained with the last "get" call
+  //  and are still present in the stream's buffer. We return them and fetch them again
+  //  together with the next bytes. This way we never read more than we need to.
+  unsigned int nbytes = m_nbits / 8;
+  if (nbytes > 0) {
+    mp_input->unget (nbytes, true /*bypass_inflate*/);
+    m_nbits -= nbytes * 8;
+    m_bits &= (uint64_t (1) << m_nbits) - 1;
+  }
+
+  size_t want = (64 - m_nbits) / 8;
+  const char *b = 0;
+  while (want > 0 && (b = mp_input->get (want, true /*bypass_inflate*/)) == 0) {
+    //  near the end of the stream
+    --want;
+  }
+
+  for (size_t i = 0; i < want; ++i) {
+    m_bits |= uint64_t ((unsigned char) b [i]) << m_nbits;
+    m_nbits += 8;
+  }
+
+  if (required && m_nbits < n) {
+    throw tl::Exception (tl::to_string (tr ("Unexpected end of file (DEFLATE implementation)")));
+  }
+}
+
+void
+BitStream::release ()
+{
+  skip_to_byte ();
+  if (m_nbits > 0) {
+    mp_input->unget (m_nbits / 8, true /*bypass_inflate*/);
+  }
+  m_bits = 0;
+  m_nbits = 0;
+}
+
 // ------------------------------------------------------------------------
 //  The Huffmann decoder core
 
@@ -42,6 +88,10 @@ namespace tl
  *  using this tree. 
  *  As specified by RFC1951, the code tree is constructed from a list of code lengths
  *  vs. value alone.
+ *
+ *  In fast mode, the decoder uses a lookup table indexed by the next bits of the
+ *  stream. Codes longer than the table's index are decoded bit by bit in canonical
+ *  order.
  */
 class HuffmannDecoder
 {
@@ -51,12 +101,17 @@ public:
    *  
    *  Creates an empty code tree.
    */
-  HuffmannDecoder ()
+  HuffmannDecoder (bool fast)
   {
     mp_codes = 0;
     mp_bitmasks = 0;
     m_max_bits = 0;
     m_num_codes = 0;
+    m_fast = fast;
+    m_table_bits = 0;
+    for (unsigned int i = 0; i <= MAX_BITS; ++i) {
+      m_count [i] = 0;
+    }
   }
 
   /**
@@ -82,8 +137,6 @@ public:
    */
   void fill_fixed_table_length ()
   {
-    reserve (9);
-
     unsigned short lengths [288];
     for (unsigned int i = 0; i < 144; ++i) {
       lengths[i] = 8;
@@ -109,8 +162,6 @@ public:
    */
   void fill_fixed_table_dist ()
   {
-    reserve (5);
-
     unsigned short lengths [32];
     for (unsigned int i = 0; i < 32; ++i) {
       lengths[i] = 5;
@@ -129,7 +180,6 @@ public:
   template <class Iter>
   void init_codes (Iter begin_lengths, Iter end_lengths)
   {
-    const unsigned int MAX_BITS = 16;
     unsigned short bl_count[MAX_BITS + 1];
     unsigned short bitmasks[MAX_BITS + 1];
     unsigned short next_code[MAX_BITS + 1];
@@ -155,6 +205,11 @@ public:
       next_code[bits] = code;
     }
 
+    if (m_fast) {
+      init_table (begin_lengths, end_lengths, bl_count, next_code, max_bits);
+      return;
+    }
+
     for (unsigned int bits = 0; bits <= max_bits; bits++) {
       bitmasks [bits] = ((1 << bits) - 1) << (max_bits - bits);
     }
@@ -180,6 +235,23 @@ public:
    */
   unsigned short decode (BitStream &s) const
   {
+    if (m_fast) {
+
+      //  NOTE: at the end of the stream, less bits may be available than the table
+      //  requires. The missing bits are zero and the entry is valid if the code is
+      //  short enough.
+      s.prefetch (m_table_bits);
+      unsigned int e = m_table [s.peek (m_table_bits)];
+      unsigned int bits = e & 0xff;
+      if (bits > 0 && bits <= s.available ()) {
+        s.consume (bits);
+        return (unsigned short) (e >> 8);
+      } else {
+        return decode_canonical (s);
+      }
+
+    }
+
     tl_assert (mp_codes != 0);
 
     unsigned int m = m_num_codes / 2;
@@ -196,8 +268,18 @@ public:
   }
 
 private:
+  static const unsigned int MAX_BITS = 16;
+  static const unsigned int MAX_TABLE_BITS = 10;
+
   unsigned short *mp_codes, *mp_bitmasks;
   unsigned int m_num_codes, m_max_bits;
+  bool m_fast;
+
+  //  fast mode: the lookup table (symbol << 8 | code length) and the canonical code description
+  std::vector<unsigned int> m_table;
+  unsigned int m_table_bits;
+  unsigned short m_count [MAX_BITS + 1];
+  std::vector<unsigned short> m_symbols;
 
   void reserve (unsigned int max_bits)
   {
@@ -214,24 +296,119 @@ private:
       mp_bitmasks = new unsigned short [m_num_codes];
     }
   }
+
+  template <class Iter>
+  void init_table (Iter begin_lengths, Iter end_lengths, const unsigned short *bl_count, unsigned short *next_code, unsigned int max_bits)
+  {
+    m_table_bits = std::min (max_bits, MAX_TABLE_BITS);
+    m_table.clear ();
+    m_table.resize (size_t (1) << m_table_bits, 0);
+
+    //  the symbols sorted by code length and value - this is the canonical code order
+    unsigned short offsets [MAX_BITS + 1];
+    unsigned int n = 0;
+    m_count [0] = 0;
+    for (unsigned int bits = 1; bits <= MAX_BITS; ++bits) {
+      m_count [bits] = bl_count [bits];
+      offsets [bits] = n;
+      n += bl_count [bits];
+    }
+    m_symbols.resize (n);
+
+    unsigned short symbol = 0;
+    for (Iter l = begin_lengths; l != end_lengths; ++l, ++symbol) {
+
+      unsigned int bits = *l;
+      if (bits == 0) {
+        continue;
+      }
+
+      m_symbols [offsets [bits]++] = symbol;
+
+      if (bits <= m_table_bits) {
+
+        //  Huffmann codes are stored most significant bit first, so the table index is the reversed code
+        unsigned int code = next_code [bits];
+        unsigned int rcode = 0;
+        for (unsigned int i = 0; i < bits; ++i) {
+          rcode = (rcode << 1) | (code & 1);
+          code >>= 1;
+        }
+
+        unsigned int e = (unsigned int) (symbol << 8) | bits;
+        for (unsigned int i = rcode; i < m_table.size (); i += (1 << bits)) {
+          m_table [i] = e;
+        }
+
+      }
+
+      ++next_code [bits];
+
+    }
+  }
+
+  unsigned short decode_canonical (BitStream &s) const
+  {
+    int code = 0, first = 0, index = 0;
+    for (unsigned int bits = 1; bits <= MAX_BITS; ++bits) {
+      code |= s.get_bit () ? 1 : 0;
+      int count = m_count [bits];
+      if (code - count < first) {
+        return m_symbols [index + (code - first)];
+      }
+      index += count;
+      first += count;
+      first <<= 1;
+      code <<= 1;
+    }
+    throw tl::Exception (tl::to_string (tr ("Invalid Huffmann code (DEFLATE implementation)")));
+  }
 };
 
 
 // ------------------------------------------------------------------------
 //  InflateFilter implementation
 
+static bool s_inflate_fast_mode = true;
+
+//  base values and extra bits for the length and distance codes (RFC1951)
+static const unsigned short length_base [] = {
+  3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+static const unsigned char length_extra [] = {
+  0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+static const unsigned short dist_base [] = {
+  1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+static const unsigned char dist_extra [] = {
+  0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+
+void
+InflateFilter::set_fast_mode (bool fast)
+{
+  s_inflate_fast_mode = fast;
+}
+
+bool
+InflateFilter::fast_mode ()
+{
+  return s_inflate_fast_mode;
+}
+
 InflateFilter::InflateFilter (tl::InputStream &input)
   : m_input (input), 
-    m_b_insert (0), m_b_read (0), m_at_end (false),
-    m_last_block (false), 
+    m_b_insert (0), m_b_read (0), m_at_end (false), m_fast (s_inflate_fast_mode),
+    m_last_block (false), m_stream_end (false),
     m_uncompressed_length (0)  //  this forces a new block on "process()"
 {
   for (size_t i = 0; i < sizeof (m_buffer) / sizeof (m_buffer [0]); ++i) {
     m_buffer[i] = 0;
   }
 
-  mp_dist_decoder = new HuffmannDecoder ();
-  mp_lit_decoder = new HuffmannDecoder ();
+  mp_dist_decoder = new HuffmannDecoder (m_fast);
+  mp_lit_decoder = new HuffmannDecoder (m_fast);
 }
 
 InflateFilter::~InflateFilter ()
@@ -298,9 +475,43 @@ InflateFilter::put_byte_dist (unsigned int d)
   put_byte (m_buffer [(m_b_insert - d) % sizeof (m_buffer)]);
 }
 
+void
+InflateFilter::put_match (unsigned int d, unsigned int length)
+{
+  unsigned int from = (m_b_insert - d) % sizeof (m_buffer);
+
+  if (m_fast && m_b_insert + length <= sizeof (m_buffer) && from + length <= sizeof (m_buffer)) {
+
+    char *t = m_buffer + m_b_insert;
+    const char *f = m_buffer + from;
+    if (d >= length) {
+      //  source and target do not overlap
+      memcpy (t, f, length);
+    } else {
+      //  overlapping: repeats the pattern of the last d bytes
+      for (unsigned int i = 0; i < length; ++i) {
+        t [i] = f [i];
+      }
+    }
+
+    m_b_insert = (m_b_insert + length) % sizeof (m_buffer);
+
+  } else {
+    while (length-- > 0) {
+      put_byte_dist (d);
+    }
+  }
+}
+
 bool 
 InflateFilter::process ()
 {
+  if (m_stream_end) {
+    return false;
+  }
+
+  bool produced = false;
+
   while (true) {
 
     bool new_block = false;
@@ -328,58 +539,19 @@ InflateFilter::process ()
 
       } else {
 
-        unsigned int length = 0;
-        if (l < 265) {
-          length = l - 254;
-        } else if (l < 269) {
-          length = (l - 265) * 2 + 11 + m_input.get_bits (1);
-        } else if (l < 273) {
-          length = (l - 269) * 4 + 19 + m_input.get_bits (2);
-        } else if (l < 277) {
-          length = (l - 273) * 8 + 35 + m_input.get_bits (3);
-        } else if (l < 281) {
-          length = (l - 277) * 16 + 67 + m_input.get_bits (4);
-        } else if (l < 285) {
-          length = (l - 281) * 32 + 131 + m_input.get_bits (5);
-        } else {
-          length = 258;
+        l -= 257;
+        if (l >= sizeof (length_base) / sizeof (length_base [0])) {
+          throw tl::Exception (tl::to_string (tr ("Invalid length code (DEFLATE implementation)")));
         }
+        unsigned int length = length_base [l] + m_input.get_bits (length_extra [l]);
 
         unsigned int d = mp_dist_decoder->decode (m_input);
-        unsigned int dist = 0;
-        if (d < 4) {
-          dist = d + 1;
-        } else if (d < 6) {
-          dist = (d - 4) * 2 + 5 + m_input.get_bits (1);
-        } else if (d < 8) {
-          dist = (d - 6) * 4 + 9 + m_input.get_bits (2);
-        } else if (d < 10) {
-          dist = (d - 8) * 8 + 17 + m_input.get_bits (3);
-        } else if (d < 12) {
-          dist = (d - 10) * 16 + 33 + m_input.get_bits (4);
-        } else if (d < 14) {
-          dist = (d - 12) * 32 + 65 + m_input.get_bits (5);
-        } else if (d < 16) {
-          dist = (d - 14) * 64 + 129 + m_input.get_bits (6);
-        } else if (d < 18) {
-          dist = (d - 16) * 128 + 257 + m_input.get_bits (7);
-        } else if (d < 20) {
-          dist = (d - 18) * 256 + 513 + m_input.get_bits (8);
-        } else if (d < 22) {
-          dist = (d - 20) * 512 + 1025 + m_input.get_bits (9);
-        } else if (d < 24) {
-          dist = (d - 22) * 1024 + 2049 + m_input.get_bits (10);
-        } else if (d < 26) {
-          dist = (d - 24) * 2048 + 4097 + m_input.get_bits (11);
-        } else if (d < 28) {
-          dist = (d - 26) * 4096 + 8193 + m_input.get_bits (12);
-        } else {
-          dist = (d - 28) * 8192 + 16385 + m_input.get_bits (13);
+        if (d >= sizeof (dist_base) / sizeof (dist_base [0])) {
+          throw tl::Exception (tl::to_string (tr ("Invalid distance code (DEFLATE implementation)")));
         }
+        unsigned int dist = dist_base [d] + m_input.get_bits (dist_extra [d]);
 
-        while (length-- > 0) {
-          put_byte_dist (dist);
-        }
+        put_match (dist, length);
 
       }
 
@@ -388,7 +560,10 @@ InflateFilter::process ()
     if (new_block) {
 
       if (m_last_block) {
-        return false;
+        //  give back the bytes we have read in advance
+        m_input.release ();
+        m_stream_end = true;
+        return produced;
       }
 
       //  read new block header
@@ -429,7 +604,7 @@ InflateFilter::process ()
             hclengths [hclen_order [i]] = m_input.get_bits (3);
           }
 
-          HuffmannDecoder ldecoder;
+          HuffmannDecoder ldecoder (m_fast);
           ldecoder.init_codes (hclengths, hclengths + sizeof (hclengths) / sizeof (hclengths[0]));
 
           unsigned int lengths [286 + 32];
@@ -476,7 +651,15 @@ InflateFilter::process ()
       }
 
     } else {
-      return true;
+
+      produced = true;
+
+      //  In fast mode, decode a batch of symbols per call. This keeps the buffer filled
+      //  well below the limit required for "unget".
+      if (! m_fast || (m_b_insert + sizeof (m_buffer) - m_b_read) % sizeof (m_buffer) >= 1024) {
+        return true;
+      }
+
     }
 
   }
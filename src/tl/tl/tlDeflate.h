@@ -29,6 +29,8 @@
 #include "tlStream.h"
 #include "tlException.h"
 
+#include <stdint.h>
+
 //  forware definition of the zlib stream structure - we can omit the zlib header here
 struct z_stream_s;
 
@@ -43,6 +45,10 @@ class HuffmannDecoder;
  *  This filter reads bytes from a tl::Stream and delivers bits, taken from
  *  these bytes. The bits are delivered in the order specified by the DEFLATE
  *  format specification (least significant bit first).
+ *
+ *  The bits are kept in a 64 bit buffer which is filled with multiple bytes at
+ *  once. Bytes which are not consumed are returned to the stream on "release",
+ *  so the stream is positioned right after the DEFLATE data.
  */
 class TL_PUBLIC BitStream
 {
@@ -54,7 +60,7 @@ public:
    */
   BitStream (tl::InputStream &input)
     : mp_input (&input),
-      m_mask (0), m_byte (0)
+      m_bits (0), m_nbits (0)
   {
     // ...
   }
@@ -62,17 +68,13 @@ public:
   /**
    *  @brief Get a byte
    *
-   *  This method simply passes the byte.
+   *  This method skips the bits up to the next byte boundary and delivers the next byte.
    *  The method expects the next byte to be available.
    */
   unsigned char get_byte ()
   {
-    m_mask = 0;
-    const char *c = mp_input->get (1, true /*bypass_deflate*/);
-    if (c == 0) {
-      throw tl::Exception (tl::to_string (tr ("Unexpected end of file (DEFLATE implementation)")));
-    }
-    return *c;
+    skip_to_byte ();
+    return (unsigned char) get_bits (8);
   }
 
   /**
@@ -83,12 +85,9 @@ public:
    */
   bool get_bit ()
   {
-    if (m_mask == 0) {
-      m_byte = get_byte ();
-      m_mask = 0x01;
-    } 
-    bool b = ((m_byte & m_mask) != 0);
-    m_mask <<= 1;
+    need (1);
+    bool b = ((m_bits & 1) != 0);
+    consume (1);
     return b;
   }
 
@@ -97,17 +96,13 @@ public:
    *
    *  This method gets the next n bits and delivers them as a single unsigned int,
    *  packing the first bit into the least signification bit. This is the specification
-   *  for reading multiple bit values except Huffmann codes.
+   *  for reading multiple bit values except Huffmann codes. n must not be larger than 32.
    */
   unsigned int get_bits (unsigned int n)
   {
-    //  KLUDGE: take directly from the byte for performance.
-    unsigned int r = 0;
-    unsigned int m = 1;
-    while (n-- > 0) {
-      r |= get_bit () ? m : 0;
-      m <<= 1;
-    }
+    need (n);
+    unsigned int r = peek (n);
+    consume (n);
     return r;
   }
 
@@ -116,13 +111,75 @@ public:
    */
   void skip_to_byte ()
   {
-    m_mask = 0;
+    consume (m_nbits % 8);
+  }
+
+  /**
+   *  @brief Makes sure at least n bits are available (n <= 56)
+   *
+   *  Throws an exception if the stream ends before.
+   */
+  void need (unsigned int n)
+  {
+    if (m_nbits < n) {
+      fill (n, true);
+    }
+  }
+
+  /**
+   *  @brief Tries to make n bits available (n <= 56)
+   *
+   *  Other than "need", this method will not throw if the stream ends before. Missing
+   *  bits will be zero.
+   */
+  void prefetch (unsigned int n)
+  {
+    if (m_nbits < n) {
+      fill (n, false);
+    }
+  }
+
+  /**
+   *  @brief Gets the next n bits without consuming them
+   */
+  unsigned int peek (unsigned int n) const
+  {
+    return (unsigned int) (m_bits & ((uint64_t (1) << n) - 1));
   }
 
+  /**
+   *  @brief Consumes n bits
+   *
+   *  The bits must be available.
+   */
+  void consume (unsigned int n)
+  {
+    m_bits >>= n;
+    m_nbits -= n;
+  }
+
+  /**
+   *  @brief Gets the number of bits available
+   */
+  unsigned int available () const
+  {
+    return m_nbits;
+  }
+
+  /**
+   *  @brief Returns the unused bytes to the stream
+   *
+   *  This method drops the bits of the current byte and returns the bytes
+   *  fetched in advance to the stream.
+   */
+  void release ();
+
 private:
   tl::InputStream *mp_input;
-  unsigned char m_mask;
-  unsigned char m_byte;
+  uint64_t m_bits;
+  unsigned int m_nbits;
+
+  void fill (unsigned int n, bool required);
 };
 
 
@@ -229,6 +286,20 @@ public:
    */
   bool at_end ();
 
+  /**
+   *  @brief Selects the table-driven decoder
+   *
+   *  By default, the Huffmann codes are decoded through lookup tables and matches are
+   *  expanded with block copies. With "fast" set to false, the codes are decoded bit by bit.
+   *  The setting is taken when the filter is created.
+   */
+  static void set_fast_mode (bool fast);
+
+  /**
+   *  @brief Gets a value indicating whether the table-driven decoder is used
+   */
+  static bool fast_mode ();
+
 private:
   BitStream m_input;
 
@@ -236,14 +307,17 @@ private:
   unsigned int m_b_insert;
   unsigned int m_b_read;
   bool m_at_end;
+  bool m_fast;
 
   //  processor state
   bool m_last_block;
+  bool m_stream_end;
   int m_uncompressed_length;
   HuffmannDecoder *mp_lit_decoder, *mp_dist_decoder;
 
   void put_byte (char b);
   void put_byte_dist (unsigned int d);
+  void put_match (unsigned int d, unsigned int length);
   bool process ();
 
 };
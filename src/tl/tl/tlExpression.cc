@@ -435,6 +435,17 @@ ExpressionNode::add_child (ExpressionNode *node)
   m_c.push_back (node);
 }
 
+bool
+ExpressionNode::has_constant_children () const
+{
+  for (std::vector <ExpressionNode *>::const_iterator c = m_c.begin (); c != m_c.end (); ++c) {
+    if (! (*c)->is_constant ()) {
+      return false;
+    }
+  }
+  return true;
+}
+
 // ----------------------------------------------------------------------------
 //  ExpressionNode implementations for some binary operators
 
@@ -1952,6 +1963,12 @@ public:
     v.set (m_value);
   }
 
+  bool is_constant () const
+  {
+    //  user objects may be mutable, so we don't consider them constants
+    return ! m_value.is_user ();
+  }
+
 private:
   tl::Variant m_value;
 };
@@ -3229,6 +3246,32 @@ Eval::eval_assign (ExpressionParserContext &ex, std::auto_ptr<ExpressionNode> &n
   }
 }
 
+/**
+ *  @brief Replaces an operator node by a constant if all its inputs are constants
+ *
+ *  Only side-effect free operator nodes must be passed to this function.
+ *  If the evaluation fails (e.g. division by zero), the node is kept, so the
+ *  error is reported at execution time as before.
+ */
+static void
+fold_constants (const ExpressionParserContext &ex, std::auto_ptr<ExpressionNode> &n)
+{
+  if (! n->has_constant_children ()) {
+    return;
+  }
+
+  EvalTarget v;
+  try {
+    n->execute (v);
+  } catch (tl::Exception &) {
+    return;
+  }
+
+  if (! v->is_user ()) {
+    n.reset (new ConstantExpressionNode (ex, *v));
+  }
+}
+
 void
 Eval::eval_if (ExpressionParserContext &ex, std::auto_ptr<ExpressionNode> &n)
 {
@@ -3244,6 +3287,7 @@ Eval::eval_if (ExpressionParserContext &ex, std::auto_ptr<ExpressionNode> &n)
     }
     eval_if (ex, c);
     n.reset (new IfExpressionNode (ex1, n.release (), b.release (), c.release ()));
+    fold_constants (ex1, n);
 
   }
 }
@@ -3261,12 +3305,14 @@ Eval::eval_boolean (ExpressionParserContext &ex, std::auto_ptr<ExpressionNode> &
       std::auto_ptr<ExpressionNode> b;
       eval_conditional (ex, b);
       n.reset (new LogOrExpressionNode (ex1, n.release (), b.release ()));
+      fold_constants (ex1, n);
 
     } else if (ex.test ("&&")) {
 
       std::auto_ptr<ExpressionNode> b;
       eval_conditional (ex, b);
       n.reset (new LogAndExpressionNode (ex1, n.release (), b.release ()));
+      fold_constants (ex1, n);
 
     } else {
       break;
@@ -3288,36 +3334,42 @@ Eval::eval_conditional (ExpressionParserContext &ex, std::auto_ptr<ExpressionNod
       std::auto_ptr<ExpressionNode> b;
       eval_shift (ex, b);
       n.reset (new LessOrEqualExpressionNode (ex1, n.release (), b.release ()));
+      fold_constants (ex1, n);
 
     } else if (ex.test("<")) {
 
       std::auto_ptr<ExpressionNode> b;
       eval_shift (ex, b);
       n.reset (new LessExpressionNode (ex1, n.release (), b.release ()));
+      fold_constants (ex1, n);
 
     } else if (ex.test(">=")) {
 
       std::auto_ptr<ExpressionNode> b;
       eval_shift (ex, b);
       n.reset (new GreaterOrEqualExpressionNode (ex1, n.release (), b.release ()));
+      fold_constants (ex1, n);
 
     } else if (ex.test(">")) {
 
       std::auto_ptr<ExpressionNode> b;
       eval_shift (ex, b);
       n.reset (new GreaterExpressionNode (ex1, n.release (), b.release ()));
+      fold_constants (ex1, n);
 
     } else if (ex.test("==")) {
 
       std::auto_ptr<ExpressionNode> b;
       eval_shift (ex, b);
       n.reset (new EqualExpressionNode (ex1, n.release (), b.release ()));
+      fold_constants (ex1, n);
 
     } else if (ex.test("!=")) {
 
       std::auto_ptr<ExpressionNode> b;
       eval_shift (ex, b);
       n.reset (new NotEqualExpressionNode (ex1, n.release (), b.release ()));
+      fold_constants (ex1, n);
 
     } else if (ex.test("~")) {
 
@@ -3351,12 +3403,14 @@ Eval::eval_shift (ExpressionParserContext &ex, std::auto_ptr<ExpressionNode> &n)
       std::auto_ptr<ExpressionNode> b;
       eval_addsub (ex, b);
       n.reset (new ShiftLeftExpressionNode (ex1, n.release (), b.release ()));
+      fold_constants (ex1, n);
 
     } else if (ex.test(">>")) {
 
       std::auto_ptr<ExpressionNode> b;
       eval_addsub (ex, b);
       n.reset (new ShiftRightExpressionNode (ex1, n.release (), b.release ()));
+      fold_constants (ex1, n);
 
     } else {
       break;
@@ -3378,12 +3432,14 @@ Eval::eval_addsub (ExpressionParserContext &ex, std::auto_ptr<ExpressionNode> &n
       std::auto_ptr<ExpressionNode> b;
       eval_product (ex, b);
       n.reset (new PlusExpressionNode (ex1, n.release (), b.release ()));
+      fold_constants (ex1, n);
 
     } else if (ex.test("-")) {
 
       std::auto_ptr<ExpressionNode> b;
       eval_product (ex, b);
       n.reset (new MinusExpressionNode (ex1, n.release (), b.release ()));
+      fold_constants (ex1, n);
 
     } else {
       break;
@@ -3405,18 +3461,21 @@ Eval::eval_product (ExpressionParserContext &ex, std::auto_ptr<ExpressionNode> &
       std::auto_ptr<ExpressionNode> b;
       eval_bitwise (ex, b);
       n.reset (new StarExpressionNode (ex1, n.release (), b.release ()));
+      fold_constants (ex1, n);
 
     } else if (ex.test("/")) {
 
       std::auto_ptr<ExpressionNode> b;
       eval_bitwise (ex, b);
       n.reset (new SlashExpressionNode (ex1, n.release (), b.release ()));
+      fold_constants (ex1, n);
 
     } else if (ex.test("%")) {
 
       std::auto_ptr<ExpressionNode> b;
       eval_bitwise (ex, b);
       n.reset (new PercentExpressionNode (ex1, n.release (), b.release ()));
+      fold_constants (ex1, n);
 
     } else {
       break;
@@ -3443,18 +3502,21 @@ Eval::eval_bitwise (ExpressionParserContext &ex, std::auto_ptr<ExpressionNode> &
       std::auto_ptr<ExpressionNode> b;
       eval_unary (ex, b);
       n.reset (new AmpersandExpressionNode (ex1, n.release (), b.release ()));
+      fold_constants (ex1, n);
 
     } else if (ex.test("|")) {
 
       std::auto_ptr<ExpressionNode> b;
       eval_unary (ex, b);
       n.reset (new PipeExpressionNode (ex1, n.release (), b.release ()));
+      fold_constants (ex1, n);
 
     } else if (ex.test("^")) {
 
       std::auto_ptr<ExpressionNode> b;
       eval_unary (ex, b);
       n.reset (new AcuteExpressionNode (ex1, n.release (), b.release ()));
+      fold_constants (ex1, n);
 
     } else {
       break;
@@ -3471,16 +3533,19 @@ Eval::eval_unary (ExpressionParserContext &ex, std::auto_ptr<ExpressionNode> &n)
 
     eval_unary (ex, n);
     n.reset (new UnaryNotExpressionNode (ex1, n.release ()));
+    fold_constants (ex1, n);
 
   } else if (ex.test ("-")) {
 
     eval_unary (ex, n);
     n.reset (new UnaryMinusExpressionNode (ex1, n.release ()));
+    fold_constants (ex1, n);
 
   } else if (ex.test ("~")) {
 
     eval_unary (ex, n);
     n.reset (new UnaryTildeExpressionNode (ex1, n.release ()));
+    fold_constants (ex1, n);
     
   } else {
     eval_suffix (ex, n);
@@ -198,6 +198,19 @@ public:
    */
   virtual ExpressionNode *clone (const tl::Expression *expr) const = 0;
 
+  /**
+   *  @brief Returns true, if the node delivers a constant value without side effects
+   */
+  virtual bool is_constant () const
+  {
+    return false;
+  }
+
+  /**
+   *  @brief Returns true, if all child nodes are constant
+   */
+  bool has_constant_children () const;
+
 protected:
   std::vector <ExpressionNode *> m_c;
   ExpressionParserContext m_context;
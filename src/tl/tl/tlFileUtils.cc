@@ -726,6 +726,18 @@ bool is_dir (const std::string &p)
   }
 }
 
+bool file_info (const std::string &p, int64_t &mtime, int64_t &size)
+{
+  stat_struct st;
+  if (stat_func (p, st) != 0) {
+    return false;
+  } else {
+    mtime = int64_t (st.st_mtime);
+    size = int64_t (st.st_size);
+    return true;
+  }
+}
+
 std::string relative_path (const std::string &base, const std::string &p)
 {
   std::vector<std::string> rem;
@@ -26,6 +26,8 @@
 #include "tlCommon.h"
 #include "tlString.h"
 
+#include <stdint.h>
+
 namespace tl
 {
 
@@ -116,6 +118,14 @@ bool TL_PUBLIC is_readable (const std::string &s);
  */
 bool TL_PUBLIC is_dir (const std::string &s);
 
+/**
+ *  @brief Gets the modification time and the size of the given file
+ *
+ *  Returns false if the file does not exist. "mtime" receives the modification time
+ *  in seconds since the epoch, "size" receives the file size in bytes.
+ */
+bool TL_PUBLIC file_info (const std::string &s, int64_t &mtime, int64_t &size);
+
 /**
  *  @brief Gets the directory entries for the given directory
  *  This method will NEVER return the ".." entry.
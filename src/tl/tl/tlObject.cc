@@ -132,15 +132,22 @@ bool Object::has_strong_references () const
 
 void Object::keep_object ()
 {
+  tl::MutexLocker locker (&WeakOrSharedPtr::lock (this));
   mp_ptrs = (WeakOrSharedPtr *)(size_t (mp_ptrs) | size_t (1));
 }
 
 void Object::release_object ()
 {
-  mp_ptrs = (WeakOrSharedPtr *)(size_t (mp_ptrs) & ~size_t (1));
+  bool to_delete = false;
+
+  {
+    tl::MutexLocker locker (&WeakOrSharedPtr::lock (this));
+    mp_ptrs = (WeakOrSharedPtr *)(size_t (mp_ptrs) & ~size_t (1));
+    to_delete = ! has_strong_references ();
+  }
 
   //  If no more strong references are left, we have to delete ourselves
-  if (! has_strong_references ()) {
+  if (to_delete) {
     delete this;
   }
 }
@@ -176,43 +183,12 @@ WeakOrSharedPtr &WeakOrSharedPtr::operator= (const WeakOrSharedPtr &o)
   return *this;
 }
 
-namespace {
-
-  /**
-   *  @brief Provides the global lock instance
-   */
-  struct GlobalLockInitializer
-  {
-    GlobalLockInitializer ()
-    {
-      if (! sp_lock) {
-        sp_lock = new tl::Mutex ();
-      }
-    }
-
-    tl::Mutex &gl ()
-    {
-      return *sp_lock;
-    }
-
-  private:
-    static tl::Mutex *sp_lock;
-  };
-
-  tl::Mutex *GlobalLockInitializer::sp_lock = 0;
-
-  //  This ensures the instance is created in the initialization code
-  static GlobalLockInitializer s_gl_init;
-
-}
-
-tl::Mutex &WeakOrSharedPtr::lock ()
+tl::Mutex &WeakOrSharedPtr::lock (const Object *obj)
 {
-  //  NOTE: to ensure proper function in static initialization code we cannot simply use
-  //  a static QMutex instance - this may not be initialized. This is not entirely thread
-  //  safe we make sure above that this initialization is guaranteed to happen in the
-  //  static initialization which is single-threaded.
-  return GlobalLockInitializer ().gl ();
+  //  NOTE: each object has its own lock for the list of pointers. So pointers to different
+  //  objects can be registered or unregistered from different threads without serializing
+  //  on a common lock.
+  return obj->m_lock;
 }
 
 Object *WeakOrSharedPtr::get () 
@@ -229,11 +205,18 @@ const Object *WeakOrSharedPtr::get () const
 
 void WeakOrSharedPtr::reset_object ()
 {
-  tl::MutexLocker locker (&lock ());
+  Object *told = mp_t;
+
+  if (told) {
+
+    tl::MutexLocker locker (&lock (told));
+
+    //  NOTE: mp_t may have been reset while we waited for the lock
+    if (mp_t == told) {
+      told->unregister_ptr (this);
+      mp_t = 0;
+    }
 
-  if (mp_t) {
-    mp_t->unregister_ptr (this);
-    mp_t = 0;
   }
 
   tl_assert (mp_prev == 0);
@@ -246,28 +229,36 @@ void WeakOrSharedPtr::reset (Object *t, bool is_shared, bool is_event)
 {
   Object *to_delete = 0;
 
-  {
-    tl::MutexLocker locker (&lock ());
+  //  NOTE: the old and the new object may use different locks. We never hold both
+  //  locks at the same time, so there is no risk of a deadlock.
+
+  Object *told = mp_t;
+
+  if (told) {
 
-    if (mp_t) {
-      Object *told = mp_t;
-      mp_t->unregister_ptr (this);
+    tl::MutexLocker locker (&lock (told));
+
+    //  NOTE: mp_t may have been reset while we waited for the lock
+    if (mp_t == told) {
+      told->unregister_ptr (this);
       mp_t = 0;
-      if (m_is_shared && told && !told->has_strong_references ()) {
+      if (m_is_shared && ! told->has_strong_references ()) {
         to_delete = told;
       }
     }
 
-    tl_assert (mp_prev == 0);
-    tl_assert (mp_next == 0);
+  }
 
-    mp_t = t;
-    m_is_shared = is_shared;
-    m_is_event = is_event;
+  tl_assert (mp_prev == 0);
+  tl_assert (mp_next == 0);
 
-    if (mp_t) {
-      mp_t->register_ptr (this);
-    }
+  m_is_shared = is_shared;
+  m_is_event = is_event;
+
+  if (t) {
+    tl::MutexLocker locker (&lock (t));
+    mp_t = t;
+    t->register_ptr (this);
   }
 
   if (to_delete) {
@@ -135,6 +135,7 @@ private:
   bool has_strong_references () const;
 
   WeakOrSharedPtr *mp_ptrs;  
+  mutable tl::Mutex m_lock;
 };
 
 /**
@@ -236,7 +237,7 @@ private:
   Object *mp_t;
   bool m_is_shared : 1;
   bool m_is_event : 1;
-  static tl::Mutex &lock ();
+  static tl::Mutex &lock (const Object *obj);
 };
 
 /**
@@ -0,0 +1,724 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "tlParallelGZip.h"
+#include "tlThreadedWorkers.h"
+#include "tlThreads.h"
+#include "tlException.h"
+#include "tlString.h"
+#include "tlInternational.h"
+
+#include <zlib.h>
+#include <stdio.h>
+#include <string.h>
+
+namespace tl
+{
+
+//  the size of the deflate dictionary
+static const size_t dict_size = 32768;
+
+//  the maximum number of index entries (limited by the size of the gzip "extra" field)
+static const size_t max_index_entries = 4000;
+
+//  the gzip header: ID1, ID2, CM (deflate), FLG, MTIME (4 bytes), XFL, OS (Unix)
+static const unsigned char gzip_header [] = { 0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x03 };
+static const size_t gzip_header_size = sizeof (gzip_header);
+
+//  the subfield ID for the block index and the magic bytes at the end of the index
+static const char index_si [] = { 'K', 'L' };
+static const char index_magic [] = { 'K', 'L', 'G', 'Z' };
+
+// ---------------------------------------------------------------
+//  Blocks, tasks and workers
+
+/**
+ *  @brief A unit of work for the compression or decompression workers
+ *
+ *  For compression, "in" is the uncompressed data and "out" receives the compressed data.
+ *  For decompression, "in" is the compressed data and "out" receives the uncompressed data
+ *  which is expected to have "size" bytes.
+ */
+struct ParallelGZipBlock
+{
+  ParallelGZipBlock (bool _compress)
+    : compress (_compress), last (false), seq (0), size (0), crc (0), done (false)
+  { }
+
+  bool compress, last;
+  size_t seq;
+  std::vector<char> in, dict, out;
+  size_t size;
+  unsigned long crc;
+  std::string error;
+  bool done;
+};
+
+static void
+deflate_block (ParallelGZipBlock &block)
+{
+  z_stream zs;
+  memset (&zs, 0, sizeof (zs));
+
+  //  raw deflate (negative window bits): the gzip framing is provided by the writer
+  if (deflateInit2 (&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+    throw tl::Exception (tl::to_string (tr ("Unable to initialize the compression library")));
+  }
+
+  if (! block.dict.empty ()) {
+    deflateSetDictionary (&zs, (const Bytef *) &block.dict.front (), uInt (block.dict.size ()));
+  }
+
+  block.out.resize (deflateBound (&zs, uLong (block.in.size ())) + 64);
+
+  zs.next_in = block.in.empty () ? 0 : (Bytef *) &block.in.front ();
+  zs.avail_in = uInt (block.in.size ());
+
+  //  Non-final blocks are terminated by a sync flush. This way they end on a byte
+  //  boundary and can be concatenated with the next one.
+  int flush = block.last ? Z_FINISH : Z_SYNC_FLUSH;
+
+  size_t pos = 0;
+  while (true) {
+
+    if (pos == block.out.size ()) {
+      block.out.resize (block.out.size () * 2);
+    }
+
+    zs.next_out = (Bytef *) &block.out [pos];
+    zs.avail_out = uInt (block.out.size () - pos);
+
+    int ret = deflate (&zs, flush);
+    pos = block.out.size () - zs.avail_out;
+
+    if (ret == Z_STREAM_ERROR) {
+      deflateEnd (&zs);
+      throw tl::Exception (tl::to_string (tr ("Error in compression library")));
+    }
+
+    if (block.last ? (ret == Z_STREAM_END) : (zs.avail_in == 0 && zs.avail_out > 0)) {
+      break;
+    }
+
+  }
+
+  deflateEnd (&zs);
+
+  block.out.resize (pos);
+  block.crc = crc32 (0, block.in.empty () ? 0 : (const Bytef *) &block.in.front (), uInt (block.in.size ()));
+}
+
+static void
+inflate_block (ParallelGZipBlock &block)
+{
+  z_stream zs;
+  memset (&zs, 0, sizeof (zs));
+
+  if (inflateInit2 (&zs, -15) != Z_OK) {
+    throw tl::Exception (tl::to_string (tr ("Unable to initialize the compression library")));
+  }
+
+  block.out.resize (block.size);
+
+  zs.next_in = block.in.empty () ? 0 : (Bytef *) &block.in.front ();
+  zs.avail_in = uInt (block.in.size ());
+  zs.next_out = block.out.empty () ? 0 : (Bytef *) &block.out.front ();
+  zs.avail_out = uInt (block.out.size ());
+
+  while (zs.avail_out > 0) {
+    int ret = inflate (&zs, Z_NO_FLUSH);
+    if (ret == Z_STREAM_END) {
+      break;
+    } else if (ret != Z_OK) {
+      std::string msg = zs.msg ? zs.msg : tl::to_string (tr ("unexpected end of data"));
+      inflateEnd (&zs);
+      throw tl::Exception (tl::to_string (tr ("Error in decompression library: %s")), msg);
+    }
+  }
+
+  size_t total_out = size_t (zs.total_out);
+  inflateEnd (&zs);
+
+  if (total_out != block.size) {
+    throw tl::Exception (tl::to_string (tr ("Inconsistent block index in gzip file")));
+  }
+
+  block.crc = crc32 (0, block.out.empty () ? 0 : (const Bytef *) &block.out.front (), uInt (block.out.size ()));
+}
+
+class ParallelGZipTask
+  : public tl::Task
+{
+public:
+  ParallelGZipTask (ParallelGZipBlock *block)
+    : mp_block (block)
+  { }
+
+  ParallelGZipBlock *block () const
+  {
+    return mp_block;
+  }
+
+private:
+  ParallelGZipBlock *mp_block;
+};
+
+class ParallelGZipWorker
+  : public tl::Worker
+{
+public:
+  ParallelGZipWorker (ParallelGZipJob *job)
+    : tl::Worker (), mp_job (job)
+  { }
+
+  void perform_task (tl::Task *task);
+
+private:
+  ParallelGZipJob *mp_job;
+};
+
+class ParallelGZipJob
+  : public tl::JobBase
+{
+public:
+  ParallelGZipJob (int nworkers)
+    : tl::JobBase (nworkers)
+  { }
+
+  void submit (ParallelGZipBlock *block)
+  {
+    schedule (new ParallelGZipTask (block));
+    if (! is_running ()) {
+      start ();
+    }
+  }
+
+  void wait_for (ParallelGZipBlock *block)
+  {
+    tl::MutexLocker locker (&m_lock);
+    while (! block->done) {
+      m_block_done.wait (&m_lock);
+    }
+  }
+
+  void set_done (ParallelGZipBlock *block, const std::string &error)
+  {
+    tl::MutexLocker locker (&m_lock);
+    block->error = error;
+    block->done = true;
+    m_block_done.wakeAll ();
+  }
+
+protected:
+  virtual tl::Worker *create_worker ()
+  {
+    return new ParallelGZipWorker (this);
+  }
+
+private:
+  tl::Mutex m_lock;
+  tl::WaitCondition m_block_done;
+};
+
+void
+ParallelGZipWorker::perform_task (tl::Task *task)
+{
+  ParallelGZipBlock *block = static_cast<ParallelGZipTask *> (task)->block ();
+
+  std::string error;
+
+  try {
+    if (block->compress) {
+      deflate_block (*block);
+    } else {
+      inflate_block (*block);
+    }
+  } catch (tl::Exception &ex) {
+    error = ex.msg ();
+  } catch (std::exception &ex) {
+    error = ex.what ();
+  } catch (...) {
+    error = tl::to_string (tr ("Unspecific error"));
+  }
+
+  mp_job->set_done (block, error);
+}
+
+// ---------------------------------------------------------------
+//  Little-endian encoding helpers
+
+static void
+put_le (std::vector<char> &data, uint64_t v, unsigned int bytes)
+{
+  for (unsigned int i = 0; i < bytes; ++i) {
+    data.push_back (char (v & 0xff));
+    v >>= 8;
+  }
+}
+
+static uint64_t
+get_le (const unsigned char *data, unsigned int bytes)
+{
+  uint64_t v = 0;
+  for (unsigned int i = bytes; i > 0; ) {
+    --i;
+    v = (v << 8) | uint64_t (data [i]);
+  }
+  return v;
+}
+
+// ---------------------------------------------------------------
+//  ParallelGZipWriter implementation
+
+ParallelGZipWriter::ParallelGZipWriter (tl::OutputStreamBase &sink, unsigned int threads, size_t block_size, size_t group_size)
+  : mp_sink (&sink), mp_job (new ParallelGZipJob (int (std::max ((unsigned int) 1, threads)))),
+    m_block_size (std::max (size_t (1024), block_size)), m_group_size (std::max (size_t (1), group_size)), m_max_blocks (std::max ((unsigned int) 1, threads) * 4),
+    m_block_count (0), m_compressed_pos (0), m_uncompressed_pos (0), m_crc (crc32 (0, 0, 0)), m_index_step (1), m_finished (false)
+{
+  m_buffer.reserve (m_block_size);
+
+  mp_sink->write ((const char *) gzip_header, gzip_header_size);
+  m_compressed_pos = gzip_header_size;
+}
+
+ParallelGZipWriter::~ParallelGZipWriter ()
+{
+  clear ();
+}
+
+void
+ParallelGZipWriter::clear ()
+{
+  mp_job->terminate ();
+
+  for (std::deque<ParallelGZipBlock *>::const_iterator b = m_blocks.begin (); b != m_blocks.end (); ++b) {
+    delete *b;
+  }
+  m_blocks.clear ();
+}
+
+void
+ParallelGZipWriter::write (const char *b, size_t n)
+{
+  tl_assert (! m_finished);
+
+  while (n > 0) {
+
+    size_t nn = std::min (n, m_block_size - m_buffer.size ());
+    m_buffer.insert (m_buffer.end (), b, b + nn);
+    b += nn;
+    n -= nn;
+
+    if (m_buffer.size () == m_block_size) {
+      submit (false);
+    }
+
+  }
+}
+
+void
+ParallelGZipWriter::submit (bool last)
+{
+  ParallelGZipBlock *block = new ParallelGZipBlock (true);
+  block->last = last;
+  block->seq = m_block_count++;
+  block->in.swap (m_buffer);
+
+  //  prime the dictionary with the end of the previous block unless a new group starts
+  if ((block->seq % m_group_size) != 0) {
+    block->dict = m_dict;
+  }
+
+  if (block->in.size () >= dict_size) {
+    m_dict.assign (block->in.end () - dict_size, block->in.end ());
+  } else {
+    m_dict.insert (m_dict.end (), block->in.begin (), block->in.end ());
+    if (m_dict.size () > dict_size) {
+      m_dict.erase (m_dict.begin (), m_dict.end () - dict_size);
+    }
+  }
+
+  m_buffer.clear ();
+  m_buffer.reserve (m_block_size);
+
+  m_blocks.push_back (block);
+  mp_job->submit (block);
+
+  while (m_blocks.size () > m_max_blocks) {
+    write_front ();
+  }
+}
+
+void
+ParallelGZipWriter::write_front ()
+{
+  ParallelGZipBlock *block = m_blocks.front ();
+  mp_job->wait_for (block);
+
+  m_blocks.pop_front ();
+  std::auto_ptr<ParallelGZipBlock> block_holder (block);
+
+  if (! block->error.empty ()) {
+    throw tl::Exception (block->error);
+  }
+
+  //  record the start of a new group in the index
+  if ((block->seq % m_group_size) == 0 && ((block->seq / m_group_size) % m_index_step) == 0) {
+
+    if (m_index.size () >= max_index_entries) {
+      //  thin out the index: every second entry is still a valid starting point
+      std::vector<ParallelGZipIndexEntry>::iterator w = m_index.begin ();
+      for (size_t i = 0; i < m_index.size (); i += 2) {
+        *w++ = m_index [i];
+      }
+      m_index.erase (w, m_index.end ());
+      m_index_step *= 2;
+    }
+
+    if (((block->seq / m_group_size) % m_index_step) == 0) {
+      m_index.push_back (ParallelGZipIndexEntry (m_compressed_pos, m_uncompressed_pos));
+    }
+
+  }
+
+  if (! block->out.empty ()) {
+    mp_sink->write (&block->out.front (), block->out.size ());
+  }
+
+  m_crc = crc32_combine (m_crc, block->crc, z_off_t (block->in.size ()));
+  m_compressed_pos += block->out.size ();
+  m_uncompressed_pos += block->in.size ();
+}
+
+void
+ParallelGZipWriter::finish ()
+{
+  if (m_finished) {
+    return;
+  }
+
+  m_finished = true;
+
+  try {
+
+    submit (true);
+    while (! m_blocks.empty ()) {
+      write_front ();
+    }
+
+  } catch (...) {
+    clear ();
+    throw;
+  }
+
+  std::vector<char> data;
+
+  //  gzip trailer
+  put_le (data, m_crc, 4);
+  put_le (data, m_uncompressed_pos & 0xffffffff, 4);
+
+  //  The block index is written as an empty gzip member with an "extra" field. The
+  //  last index entry marks the end of the deflate data. The payload ends with the
+  //  number of entries and a magic string, so it can be located from the end of the file.
+
+  std::vector<char> payload;
+  for (std::vector<ParallelGZipIndexEntry>::const_iterator i = m_index.begin (); i != m_index.end (); ++i) {
+    put_le (payload, i->compressed, 8);
+    put_le (payload, i->uncompressed, 8);
+  }
+  put_le (payload, m_compressed_pos, 8);
+  put_le (payload, m_uncompressed_pos, 8);
+  put_le (payload, m_index.size () + 1, 4);
+  payload.insert (payload.end (), index_magic, index_magic + sizeof (index_magic));
+
+  data.insert (data.end (), (const char *) gzip_header, (const char *) gzip_header + gzip_header_size);
+  data [8 + 3] = 0x04;  //  FLG.FEXTRA
+  put_le (data, payload.size () + 4, 2);  //  XLEN
+  data.insert (data.end (), index_si, index_si + sizeof (index_si));
+  put_le (data, payload.size (), 2);
+  data.insert (data.end (), payload.begin (), payload.end ());
+
+  //  an empty, final deflate block with fixed codes
+  data.push_back (0x03);
+  data.push_back (0x00);
+
+  //  CRC and size of the empty member
+  put_le (data, 0, 8);
+
+  mp_sink->write (&data.front (), data.size ());
+}
+
+// ---------------------------------------------------------------
+//  ParallelGZipReader implementation
+
+static bool
+read_file_tail (const std::string &path, std::vector<unsigned char> &tail, uint64_t &file_size, size_t max_tail)
+{
+#if defined(_WIN32)
+  FILE *file = _wfopen (tl::to_wstring (path).c_str (), L"rb");
+#else
+  FILE *file = fopen (tl::string_to_system (path).c_str (), "rb");
+#endif
+  if (! file) {
+    return false;
+  }
+
+  bool ok = false;
+
+#if defined(_WIN32)
+  if (_fseeki64 (file, 0, SEEK_END) == 0) {
+    file_size = uint64_t (_ftelli64 (file));
+#else
+  if (fseeko (file, 0, SEEK_END) == 0) {
+    file_size = uint64_t (ftello (file));
+#endif
+
+    size_t n = size_t (std::min (uint64_t (max_tail), file_size));
+    tail.resize (n);
+
+#if defined(_WIN32)
+    if (_fseeki64 (file, __int64 (file_size - n), SEEK_SET) == 0) {
+#else
+    if (fseeko (file, off_t (file_size - n), SEEK_SET) == 0) {
+#endif
+      ok = (n == 0 || fread (&tail.front (), 1, n, file) == n);
+    }
+
+  }
+
+  fclose (file);
+  return ok;
+}
+
+bool
+ParallelGZipReader::read_index (const std::string &path, std::vector<ParallelGZipIndexEntry> &index, unsigned long &crc, unsigned long &size)
+{
+  //  the maximum size of the index member plus the trailer of the data member
+  const size_t max_tail = 65536 + 64;
+
+  std::vector<unsigned char> tail;
+  uint64_t file_size = 0;
+  if (! read_file_tail (path, tail, file_size, max_tail)) {
+    return false;
+  }
+
+  //  trailer of the index member (empty deflate block, CRC and size of zero) plus number of entries and magic
+  const size_t fixed_tail = 8 + 4 + sizeof (index_magic) + 2 + 8;
+  if (tail.size () < fixed_tail) {
+    return false;
+  }
+
+  const unsigned char *t = &tail.front () + tail.size ();
+  if (get_le (t - 8, 8) != 0 || t [-10] != 0x03 || t [-9] != 0x00 || memcmp (t - 10 - sizeof (index_magic), index_magic, sizeof (index_magic)) != 0) {
+    return false;
+  }
+
+  size_t n = size_t (get_le (t - 10 - sizeof (index_magic) - 4, 4));
+  size_t payload_size = n * 16 + 4 + sizeof (index_magic);
+  size_t member_size = gzip_header_size + 2 + 4 + payload_size + 2 + 8;
+  if (n < 2 || member_size + 8 > tail.size ()) {
+    return false;
+  }
+
+  const unsigned char *m = t - member_size;
+  if (m [0] != 0x1f || m [1] != 0x8b || m [2] != 0x08 || m [3] != 0x04 ||
+      get_le (m + gzip_header_size, 2) != payload_size + 4 ||
+      m [gzip_header_size + 2] != (unsigned char) index_si [0] || m [gzip_header_size + 3] != (unsigned char) index_si [1] ||
+      get_le (m + gzip_header_size + 4, 2) != payload_size) {
+    return false;
+  }
+
+  index.clear ();
+  const unsigned char *p = m + gzip_header_size + 6;
+  for (size_t i = 0; i < n; ++i, p += 16) {
+    index.push_back (ParallelGZipIndexEntry (get_le (p, 8), get_le (p + 8, 8)));
+  }
+
+  //  the trailer of the data member is located directly before the index member
+  uint64_t data_end = file_size - member_size - 8;
+  if (index.back ().compressed != data_end) {
+    return false;
+  }
+
+  for (size_t i = 1; i < n; ++i) {
+    if (index [i].compressed < index [i - 1].compressed || index [i].uncompressed < index [i - 1].uncompressed) {
+      return false;
+    }
+  }
+
+  crc = (unsigned long) get_le (m - 8, 4);
+  size = (unsigned long) get_le (m - 4, 4);
+
+  return true;
+}
+
+ParallelGZipReader *
+ParallelGZipReader::create (const std::string &path, unsigned int threads)
+{
+  std::vector<ParallelGZipIndexEntry> index;
+  unsigned long crc = 0, size = 0;
+  if (! read_index (path, index, crc, size)) {
+    return 0;
+  }
+
+  return new ParallelGZipReader (path, threads, index, crc, size);
+}
+
+ParallelGZipReader::ParallelGZipReader (const std::string &path, unsigned int threads, const std::vector<ParallelGZipIndexEntry> &index, unsigned long crc, unsigned long size)
+  : m_path (path), mp_file (new tl::InputFile (path)), m_threads (std::max ((unsigned int) 1, threads)),
+    mp_job (new ParallelGZipJob (int (m_threads))),
+    m_index (index), m_next_group (0), m_file_pos (0), mp_current (0), m_current_pos (0),
+    m_crc (crc32 (0, 0, 0)), m_expected_crc (crc), m_size (0), m_expected_size (size)
+{
+  //  .. nothing yet ..
+}
+
+ParallelGZipReader::~ParallelGZipReader ()
+{
+  clear ();
+}
+
+void
+ParallelGZipReader::clear ()
+{
+  mp_job->terminate ();
+
+  for (std::deque<ParallelGZipBlock *>::const_iterator b = m_blocks.begin (); b != m_blocks.end (); ++b) {
+    delete *b;
+  }
+  m_blocks.clear ();
+
+  if (mp_current) {
+    delete mp_current;
+    mp_current = 0;
+  }
+}
+
+void
+ParallelGZipReader::reset ()
+{
+  clear ();
+
+  mp_file->reset ();
+  m_file_pos = 0;
+  m_next_group = 0;
+  m_current_pos = 0;
+  m_crc = crc32 (0, 0, 0);
+  m_size = 0;
+}
+
+void
+ParallelGZipReader::schedule ()
+{
+  size_t max_blocks = m_threads * 2;
+
+  while (m_blocks.size () < max_blocks && m_next_group + 1 < m_index.size ()) {
+
+    const ParallelGZipIndexEntry &from = m_index [m_next_group];
+    const ParallelGZipIndexEntry &to = m_index [m_next_group + 1];
+    ++m_next_group;
+
+    //  skip the gzip header
+    char skip [1024];
+    while (m_file_pos < from.compressed) {
+      size_t n = mp_file->read (skip, size_t (std::min (uint64_t (sizeof (skip)), from.compressed - m_file_pos)));
+      if (n == 0) {
+        throw tl::Exception (tl::to_string (tr ("Unexpected end of file: %s")), m_path);
+      }
+      m_file_pos += n;
+    }
+
+    std::auto_ptr<ParallelGZipBlock> block (new ParallelGZipBlock (false));
+    block->size = size_t (to.uncompressed - from.uncompressed);
+    block->in.resize (size_t (to.compressed - from.compressed));
+
+    size_t pos = 0;
+    while (pos < block->in.size ()) {
+      size_t n = mp_file->read (&block->in [pos], block->in.size () - pos);
+      if (n == 0) {
+        throw tl::Exception (tl::to_string (tr ("Unexpected end of file: %s")), m_path);
+      }
+      pos += n;
+    }
+    m_file_pos += block->in.size ();
+
+    m_blocks.push_back (block.release ());
+    mp_job->submit (m_blocks.back ());
+
+  }
+}
+
+size_t
+ParallelGZipReader::read (char *b, size_t n)
+{
+  size_t nread = 0;
+
+  while (n > 0) {
+
+    if (! mp_current || m_current_pos == mp_current->out.size ()) {
+
+      if (mp_current) {
+        delete mp_current;
+        mp_current = 0;
+      }
+
+      schedule ();
+
+      if (m_blocks.empty ()) {
+        if (m_crc != m_expected_crc || (m_size & 0xffffffff) != m_expected_size) {
+          throw tl::Exception (tl::to_string (tr ("CRC error in gzip file: %s")), m_path);
+        }
+        break;
+      }
+
+      ParallelGZipBlock *block = m_blocks.front ();
+      mp_job->wait_for (block);
+      m_blocks.pop_front ();
+      mp_current = block;
+      m_current_pos = 0;
+
+      if (! block->error.empty ()) {
+        throw tl::Exception (block->error + " (" + m_path + ")");
+      }
+
+      m_crc = crc32_combine (m_crc, block->crc, z_off_t (block->out.size ()));
+      m_size += block->out.size ();
+
+    } else {
+
+      size_t nn = std::min (n, mp_current->out.size () - m_current_pos);
+      memcpy (b, &mp_current->out [m_current_pos], nn);
+      m_current_pos += nn;
+      b += nn;
+      n -= nn;
+      nread += nn;
+
+    }
+
+  }
+
+  return nread;
+}
+
+}
+
@@ -0,0 +1,203 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#ifndef HDR_tlParallelGZip
+#define HDR_tlParallelGZip
+
+#include "tlCommon.h"
+#include "tlStream.h"
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <memory>
+
+#include <stdint.h>
+
+namespace tl
+{
+
+class ParallelGZipJob;
+struct ParallelGZipBlock;
+
+/**
+ *  @brief An entry of the block index
+ *
+ *  The index lists the positions where inflating can start with an empty
+ *  dictionary. "compressed" is the offset of the deflate data in the file,
+ *  "uncompressed" is the offset in the uncompressed data.
+ */
+struct TL_PUBLIC ParallelGZipIndexEntry
+{
+  ParallelGZipIndexEntry ()
+    : compressed (0), uncompressed (0)
+  { }
+
+  ParallelGZipIndexEntry (uint64_t c, uint64_t u)
+    : compressed (c), uncompressed (u)
+  { }
+
+  uint64_t compressed, uncompressed;
+};
+
+/**
+ *  @brief A gzip writer compressing the data in multiple threads
+ *
+ *  The data is cut into blocks which are compressed independently by worker
+ *  threads and written in the original order. The result is a standard gzip
+ *  stream. Like "pigz", the dictionary of each block is primed with the last
+ *  32k of the previous block, so the compression ratio is practically the same
+ *  than with a single deflate stream.
+ *
+ *  Every "group_size" blocks, the priming is omitted. Inflating can start at
+ *  these positions with an empty dictionary. The positions are recorded in a
+ *  block index which is appended to the file as an empty gzip member carrying
+ *  the index in the "extra" field. Standard gzip readers will skip this member.
+ *  ParallelGZipReader uses the index to inflate the groups in parallel.
+ */
+class TL_PUBLIC ParallelGZipWriter
+{
+public:
+  /**
+   *  @brief Creates a writer sending the compressed data to the given stream
+   *
+   *  @param sink The stream to write the compressed data to
+   *  @param threads The number of worker threads
+   *  @param block_size The number of uncompressed bytes per block
+   *  @param group_size The number of blocks per independent group
+   */
+  ParallelGZipWriter (tl::OutputStreamBase &sink, unsigned int threads, size_t block_size = 128 * 1024, size_t group_size = 32);
+
+  /**
+   *  @brief Destructor
+   *
+   *  The destructor will not finish the stream. Use "finish" to complete the stream.
+   */
+  ~ParallelGZipWriter ();
+
+  /**
+   *  @brief Writes the given data
+   */
+  void write (const char *b, size_t n);
+
+  /**
+   *  @brief Finishes the stream
+   *
+   *  This method writes the remaining blocks, the gzip trailer and the block index.
+   */
+  void finish ();
+
+private:
+  //  no copying
+  ParallelGZipWriter (const ParallelGZipWriter &);
+  ParallelGZipWriter &operator= (const ParallelGZipWriter &);
+
+  tl::OutputStreamBase *mp_sink;
+  std::auto_ptr<ParallelGZipJob> mp_job;
+  std::deque<ParallelGZipBlock *> m_blocks;
+  std::vector<char> m_buffer, m_dict;
+  size_t m_block_size, m_group_size, m_max_blocks;
+  size_t m_block_count;
+  uint64_t m_compressed_pos, m_uncompressed_pos;
+  unsigned long m_crc;
+  std::vector<ParallelGZipIndexEntry> m_index;
+  size_t m_index_step;
+  bool m_finished;
+
+  void submit (bool last);
+  void write_front ();
+  void clear ();
+};
+
+/**
+ *  @brief A gzip reader inflating the data in multiple threads
+ *
+ *  This reader requires the block index written by ParallelGZipWriter. Use
+ *  "create" to obtain a reader for a file - this method will return 0 if the
+ *  file does not carry a block index.
+ */
+class TL_PUBLIC ParallelGZipReader
+{
+public:
+  /**
+   *  @brief Creates a reader for the given file
+   *
+   *  Returns 0 if the file is not a gzip file with a block index.
+   */
+  static ParallelGZipReader *create (const std::string &path, unsigned int threads);
+
+  /**
+   *  @brief Reads the block index from the given file
+   *
+   *  Returns false if the file does not carry a block index. On success, "index" will
+   *  receive the index entries. The last entry marks the end of the deflate data.
+   *  "crc" and "size" will receive the values from the gzip trailer.
+   */
+  static bool read_index (const std::string &path, std::vector<ParallelGZipIndexEntry> &index, unsigned long &crc, unsigned long &size);
+
+  /**
+   *  @brief Destructor
+   */
+  ~ParallelGZipReader ();
+
+  /**
+   *  @brief Reads the next chunk of data
+   *
+   *  Returns the number of bytes read. 0 indicates the end of the data.
+   */
+  size_t read (char *b, size_t n);
+
+  /**
+   *  @brief Restarts from the beginning
+   */
+  void reset ();
+
+private:
+  //  no copying
+  ParallelGZipReader (const ParallelGZipReader &);
+  ParallelGZipReader &operator= (const ParallelGZipReader &);
+
+  ParallelGZipReader (const std::string &path, unsigned int threads, const std::vector<ParallelGZipIndexEntry> &index, unsigned long crc, unsigned long size);
+
+  std::string m_path;
+  std::auto_ptr<tl::InputStreamBase> mp_file;
+  unsigned int m_threads;
+  std::auto_ptr<ParallelGZipJob> mp_job;
+  std::deque<ParallelGZipBlock *> m_blocks;
+  std::vector<ParallelGZipIndexEntry> m_index;
+  size_t m_next_group;
+  uint64_t m_file_pos;
+  ParallelGZipBlock *mp_current;
+  size_t m_current_pos;
+  unsigned long m_crc, m_expected_crc;
+  uint64_t m_size;
+  unsigned long m_expected_size;
+
+  void schedule ();
+  void clear ();
+};
+
+}
+
+#endif
+
@@ -0,0 +1,111 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "tlPixelBuffer.h"
+
+#include <algorithm>
+#include <string.h>
+
+namespace tl
+{
+
+PixelBuffer::PixelBuffer ()
+  : m_width (0), m_height (0), mp_data (0), m_owned (true), m_transparent (false)
+{
+  //  .. nothing yet ..
+}
+
+PixelBuffer::PixelBuffer (unsigned int width, unsigned int height)
+  : m_width (width), m_height (height), mp_data (0), m_owned (true), m_transparent (false)
+{
+  if (m_width > 0 && m_height > 0) {
+    mp_data = new color_t [size_t (m_width) * size_t (m_height)];
+  }
+}
+
+PixelBuffer::PixelBuffer (unsigned int width, unsigned int height, color_t *data)
+  : m_width (width), m_height (height), mp_data (data), m_owned (false), m_transparent (false)
+{
+  //  .. nothing yet ..
+}
+
+PixelBuffer::PixelBuffer (const PixelBuffer &other)
+  : m_width (0), m_height (0), mp_data (0), m_owned (true), m_transparent (false)
+{
+  operator= (other);
+}
+
+PixelBuffer &
+PixelBuffer::operator= (const PixelBuffer &other)
+{
+  if (this != &other) {
+
+    PixelBuffer tmp (other.m_width, other.m_height);
+    tmp.m_transparent = other.m_transparent;
+    if (tmp.mp_data) {
+      memcpy (tmp.mp_data, other.mp_data, sizeof (color_t) * size_t (other.m_width) * size_t (other.m_height));
+    }
+
+    swap (tmp);
+
+  }
+  return *this;
+}
+
+PixelBuffer::~PixelBuffer ()
+{
+  if (m_owned) {
+    delete [] mp_data;
+  }
+  mp_data = 0;
+}
+
+void
+PixelBuffer::swap (PixelBuffer &other)
+{
+  std::swap (m_width, other.m_width);
+  std::swap (m_height, other.m_height);
+  std::swap (mp_data, other.mp_data);
+  std::swap (m_owned, other.m_owned);
+  std::swap (m_transparent, other.m_transparent);
+}
+
+bool
+PixelBuffer::operator== (const PixelBuffer &other) const
+{
+  if (m_width != other.m_width || m_height != other.m_height || m_transparent != other.m_transparent) {
+    return false;
+  }
+
+  size_t n = size_t (m_width) * size_t (m_height);
+  return n == 0 || memcmp (mp_data, other.mp_data, sizeof (color_t) * n) == 0;
+}
+
+void
+PixelBuffer::fill (color_t c)
+{
+  std::fill (mp_data, mp_data + size_t (m_width) * size_t (m_height), c);
+}
+
+}
+
@@ -0,0 +1,234 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#ifndef HDR_tlPixelBuffer
+#define HDR_tlPixelBuffer
+
+#include "tlCommon.h"
+
+#include <cstdint>
+#include <cstddef>
+
+namespace tl
+{
+
+/**
+ *  @brief The pixel type: a 32 bit ARGB value (0xAARRGGBB)
+ *
+ *  This is the same memory layout as QImage::Format_RGB32 and
+ *  QImage::Format_ARGB32 use.
+ */
+typedef uint32_t color_t;
+
+/**
+ *  @brief A simple, Qt-independent 32 bit ARGB pixel buffer
+ *
+ *  The pixel buffer is a plain, row-major array of color_t values
+ *  without padding. Row 0 is the top row. The buffer either owns its
+ *  memory or refers to an external memory block provided by the
+ *  caller. The latter allows rendering directly into memory owned by
+ *  someone else (i.e. a numpy array) without a copy.
+ *
+ *  If the buffer is "transparent", the alpha channel is significant.
+ *  Otherwise, the alpha channel is to be ignored and pixels are
+ *  considered opaque.
+ */
+class TL_PUBLIC PixelBuffer
+{
+public:
+  /**
+   *  @brief Creates an empty pixel buffer (0x0 pixels)
+   */
+  PixelBuffer ();
+
+  /**
+   *  @brief Creates a pixel buffer with the given dimensions
+   *
+   *  The pixels are not initialized.
+   */
+  PixelBuffer (unsigned int width, unsigned int height);
+
+  /**
+   *  @brief Creates a pixel buffer referring to external memory
+   *
+   *  "data" needs to point to a block of at least width * height pixels.
+   *  The pixel buffer will not take ownership of the memory. The memory
+   *  must stay valid as long as the pixel buffer is used.
+   */
+  PixelBuffer (unsigned int width, unsigned int height, color_t *data);
+
+  /**
+   *  @brief Copy constructor
+   *
+   *  The copy will always own its memory.
+   */
+  PixelBuffer (const PixelBuffer &other);
+
+  /**
+   *  @brief Assignment
+   *
+   *  The pixel buffer will own its memory after the assignment.
+   */
+  PixelBuffer &operator= (const PixelBuffer &other);
+
+  /**
+   *  @brief Destructor
+   */
+  ~PixelBuffer ();
+
+  /**
+   *  @brief Swaps two pixel buffers
+   */
+  void swap (PixelBuffer &other);
+
+  /**
+   *  @brief Equality
+   *
+   *  Two buffers are equal if the dimensions, the transparency flag and
+   *  all pixels are equal.
+   */
+  bool operator== (const PixelBuffer &other) const;
+
+  /**
+   *  @brief Inequality
+   */
+  bool operator!= (const PixelBuffer &other) const
+  {
+    return ! operator== (other);
+  }
+
+  /**
+   *  @brief Gets the width in pixels
+   */
+  unsigned int width () const
+  {
+    return m_width;
+  }
+
+  /**
+   *  @brief Gets the height in pixels
+   */
+  unsigned int height () const
+  {
+    return m_height;
+  }
+
+  /**
+   *  @brief Gets the stride (the distance between two rows) in pixels
+   *
+   *  The stride is always identical to the width. This method is provided
+   *  for clarity when passing the buffer to functions expecting a stride.
+   */
+  unsigned int stride () const
+  {
+    return m_width;
+  }
+
+  /**
+   *  @brief Sets a value indicating whether the alpha channel is significant
+   */
+  void set_transparent (bool f)
+  {
+    m_transparent = f;
+  }
+
+  /**
+   *  @brief Gets a value indicating whether the alpha channel is significant
+   */
+  bool transparent () const
+  {
+    return m_transparent;
+  }
+
+  /**
+   *  @brief Gets a value indicating whether the buffer refers to external memory
+   */
+  bool is_external () const
+  {
+    return ! m_owned;
+  }
+
+  /**
+   *  @brief Fills the buffer with the given color
+   */
+  void fill (color_t c);
+
+  /**
+   *  @brief Gets the pointer to the first pixel of row n (0 is the top row)
+   */
+  color_t *scan_line (unsigned int n)
+  {
+    return mp_data + size_t (n) * m_width;
+  }
+
+  /**
+   *  @brief Gets the pointer to the first pixel of row n (const version)
+   */
+  const color_t *scan_line (unsigned int n) const
+  {
+    return mp_data + size_t (n) * m_width;
+  }
+
+  /**
+   *  @brief Gets the pointer to the pixel data
+   */
+  color_t *data ()
+  {
+    return mp_data;
+  }
+
+  /**
+   *  @brief Gets the pointer to the pixel data (const version)
+   */
+  const color_t *data () const
+  {
+    return mp_data;
+  }
+
+  /**
+   *  @brief Gets the pixel at the given position
+   */
+  color_t pixel (unsigned int x, unsigned int y) const
+  {
+    return scan_line (y) [x];
+  }
+
+  /**
+   *  @brief Sets the pixel at the given position
+   */
+  void set_pixel (unsigned int x, unsigned int y, color_t c)
+  {
+    scan_line (y) [x] = c;
+  }
+
+private:
+  unsigned int m_width, m_height;
+  color_t *mp_data;
+  bool m_owned;
+  bool m_transparent;
+};
+
+}
+
+#endif
+
@@ -37,12 +37,14 @@
 #include "tlStream.h"
 #include "tlHttpStream.h"
 #include "tlDeflate.h"
+#include "tlParallelGZip.h"
 #include "tlAssert.h"
 #include "tlFileUtils.h"
 
 #include "tlException.h"
 #include "tlString.h"
 #include "tlUri.h"
+#include "tlLog.h"
 
 #if defined(HAVE_QT)
 #  include <QByteArray>
@@ -134,6 +136,9 @@ class ZLibFilePrivate
 public:
   ZLibFilePrivate () : zs (NULL) { }
   gzFile zs;
+  std::auto_ptr<OutputFile> file;
+  std::auto_ptr<ParallelGZipWriter> writer;
+  std::auto_ptr<ParallelGZipReader> reader;
 };
 
 // ---------------------------------------------------------------
@@ -155,7 +160,7 @@ InputStream::InputStream (InputStreamBase *delegate)
   mp_buffer = new char [m_bcap];
 }
 
-InputStream::InputStream (const std::string &abstract_path)
+InputStream::InputStream (const std::string &abstract_path, unsigned int zlib_threads)
   : m_pos (0), mp_bptr (0), mp_delegate (0), m_owns_delegate (false), mp_inflate (0)
 { 
   m_bcap = 4096; // initial buffer capacity
@@ -197,9 +202,9 @@ InputStream::InputStream (const std::string &abstract_path)
     mp_delegate = new InputPipe (ex.get ());
   } else if (ex.test ("file:")) {
     tl::URI uri (abstract_path);
-    mp_delegate = new InputZLibFile (uri.path ());
+    mp_delegate = new InputZLibFile (uri.path (), zlib_threads);
   } else {
-    mp_delegate = new InputZLibFile (abstract_path);
+    mp_delegate = new InputZLibFile (abstract_path, zlib_threads);
   }
 
   if (! mp_buffer) {
@@ -306,9 +311,9 @@ InputStream::get (size_t n, bool bypass_inflate)
 }
 
 void
-InputStream::unget (size_t n)
+InputStream::unget (size_t n, bool bypass_inflate)
 {
-  if (mp_inflate) {
+  if (mp_inflate && ! bypass_inflate) {
     mp_inflate->unget (n);
   } else {
     mp_bptr -= n;
@@ -322,7 +327,8 @@ InputStream::read_all (size_t max_count)
 {
   std::string str;
   while (max_count > 0) {
-    size_t n = std::min (max_count, std::max (size_t (1), m_blen));
+    //  NOTE: while inflating, m_blen does not tell how many bytes are available
+    size_t n = std::min (max_count, std::max (size_t (1), mp_inflate ? 0 : m_blen));
     const char *b = get (n);
     if (b) {
       str += std::string (b, n);
@@ -339,7 +345,7 @@ InputStream::read_all ()
 {
   std::string str;
   while (true) {
-    size_t n = std::max (size_t (1), m_blen);
+    size_t n = std::max (size_t (1), mp_inflate ? 0 : m_blen);
     const char *b = get (n);
     if (b) {
       str += std::string (b, n);
@@ -509,6 +515,39 @@ TextInputStream::skip ()
   return at_end () ? 0 : c;
 }
 
+const char *
+TextInputStream::peek_block (size_t &n)
+{
+  //  fill the buffer if required
+  if (m_stream.blen () == 0) {
+    if (m_stream.get (1) == 0) {
+      m_at_end = true;
+      n = 0;
+      return 0;
+    }
+    m_stream.unget (1);
+  }
+
+  n = m_stream.blen ();
+  const char *b = m_stream.get (n);
+  m_stream.unget (n);
+  return b;
+}
+
+void
+TextInputStream::skip_block (size_t n)
+{
+  const char *b = m_stream.get (n);
+  tl_assert (b != 0);
+
+  for (const char *be = b + n; b != be; ++b) {
+    m_line = m_next_line;
+    if (*b == '\n') {
+      ++m_next_line;
+    }
+  }
+}
+
 void
 TextInputStream::reset ()
 {
@@ -609,10 +648,19 @@ InputFile::filename () const
 // ---------------------------------------------------------------
 //  InputZLibFile implementation
 
-InputZLibFile::InputZLibFile (const std::string &path)
+InputZLibFile::InputZLibFile (const std::string &path, unsigned int threads)
   : mp_d (new ZLibFilePrivate ())
 {
   m_source = path;
+
+  if (threads > 0) {
+    //  files written with a block index can be inflated in parallel
+    mp_d->reader.reset (ParallelGZipReader::create (path, threads));
+    if (mp_d->reader.get ()) {
+      return;
+    }
+  }
+
 #if defined(_WIN32)
   int fd = _wopen (tl::to_wstring (path).c_str (), _O_BINARY | _O_RDONLY | _O_SEQUENTIAL);
   if (fd < 0) {
@@ -641,11 +689,16 @@ InputZLibFile::close ()
     gzclose (mp_d->zs);
     mp_d->zs = NULL;
   }  
+  mp_d->reader.reset (0);
 }
 
 size_t 
 InputZLibFile::read (char *b, size_t n)
 {
+  if (mp_d->reader.get ()) {
+    return mp_d->reader->read (b, n);
+  }
+
   tl_assert (mp_d->zs != NULL);
   int ret = gzread (mp_d->zs, b, (unsigned int) n);
   if (ret < 0) {
@@ -664,7 +717,9 @@ InputZLibFile::read (char *b, size_t n)
 void 
 InputZLibFile::reset ()
 {
-  if (mp_d->zs != NULL) {
+  if (mp_d->reader.get ()) {
+    mp_d->reader->reset ();
+  } else if (mp_d->zs != NULL) {
     gzrewind (mp_d->zs);
   }
 }
@@ -707,16 +762,16 @@ OutputStream::output_mode_from_filename (const std::string &abstract_path, Outpu
 }
 
 static
-OutputStreamBase *create_file_stream (const std::string &path, OutputStream::OutputStreamMode om)
+OutputStreamBase *create_file_stream (const std::string &path, OutputStream::OutputStreamMode om, unsigned int zlib_threads)
 {
   if (om == OutputStream::OM_Zlib) {
-    return new OutputZLibFile (path);
+    return new OutputZLibFile (path, zlib_threads);
   } else {
     return new OutputFile (path);
   }
 }
 
-OutputStream::OutputStream (const std::string &abstract_path, OutputStreamMode om, bool as_text)
+OutputStream::OutputStream (const std::string &abstract_path, OutputStreamMode om, bool as_text, unsigned int zlib_threads)
   : m_pos (0), mp_delegate (0), m_owns_delegate (false), m_as_text (as_text), m_path (abstract_path)
 {
   //  Determine output mode
@@ -728,9 +783,9 @@ OutputStream::OutputStream (const std::string &abstract_path, OutputStreamMode o
   } else if (ex.test ("pipe:")) {
     mp_delegate = new OutputPipe (ex.get ());
   } else if (ex.test ("file:")) {
-    mp_delegate = create_file_stream (ex.get (), om);
+    mp_delegate = create_file_stream (ex.get (), om, zlib_threads);
   } else {
-    mp_delegate = create_file_stream (abstract_path, om);
+    mp_delegate = create_file_stream (abstract_path, om, zlib_threads);
   }
 
   m_owns_delegate = true;
@@ -742,7 +797,12 @@ OutputStream::OutputStream (const std::string &abstract_path, OutputStreamMode o
 
 OutputStream::~OutputStream ()
 {
-  close ();
+  //  NOTE: errors can't be reported from the destructor. Use "close" to receive them.
+  try {
+    close ();
+  } catch (tl::Exception &ex) {
+    tl::error << ex.msg ();
+  }
 }
 
 void
@@ -750,14 +810,15 @@ OutputStream::close ()
 {
   flush ();
 
-  if (mp_delegate && m_owns_delegate) {
-    delete mp_delegate;
-    mp_delegate = 0;
-  }
   if (mp_buffer) {
     delete[] mp_buffer;
     mp_buffer = 0;
   }
+  if (mp_delegate && m_owns_delegate) {
+    std::auto_ptr<OutputStreamBase> delegate (mp_delegate);
+    mp_delegate = 0;
+    delegate->close ();
+  }
 }
 
 void
@@ -895,7 +956,7 @@ OutputFile::~OutputFile ()
 #if defined(_WIN32)
     _close (m_fd);
 #else
-    close (m_fd);
+    ::close (m_fd);
 #endif
     m_fd = -1;
   }  
@@ -931,10 +992,17 @@ OutputFile::write (const char *b, size_t n)
 // ---------------------------------------------------------------
 //  OutputZLibFile implementation
 
-OutputZLibFile::OutputZLibFile (const std::string &path)
+OutputZLibFile::OutputZLibFile (const std::string &path, unsigned int threads)
   : mp_d (new ZLibFilePrivate ())
 {
   m_source = path;
+
+  if (threads > 0) {
+    mp_d->file.reset (new OutputFile (path));
+    mp_d->writer.reset (new ParallelGZipWriter (*mp_d->file, threads));
+    return;
+  }
+
 #if defined(_WIN32)
   FILE *file = _wfopen (tl::to_wstring (path).c_str (), L"wb");
   if (file == NULL) {
@@ -951,17 +1019,43 @@ OutputZLibFile::OutputZLibFile (const std::string &path)
 
 OutputZLibFile::~OutputZLibFile ()
 {
+  //  fallback if the file was not closed explicitly
+  try {
+    close ();
+  } catch (tl::Exception &ex) {
+    tl::error << ex.msg ();
+  }
+
+  delete mp_d;
+  mp_d = 0;
+}
+
+void
+OutputZLibFile::close ()
+{
+  if (mp_d->writer.get ()) {
+
+    //  NOTE: release the writer and file in any case, so an error is reported once only
+    std::auto_ptr<OutputFile> file (mp_d->file.release ());
+    std::auto_ptr<ParallelGZipWriter> writer (mp_d->writer.release ());
+    writer->finish ();
+
+  }
+
   if (mp_d->zs != NULL) {
     gzclose (mp_d->zs);
     mp_d->zs = NULL;
   }  
-  delete mp_d;
-  mp_d = 0;
 }
 
 void 
 OutputZLibFile::write (const char *b, size_t n)
 {
+  if (mp_d->writer.get ()) {
+    mp_d->writer->write (b, n);
+    return;
+  }
+
   tl_assert (mp_d->zs != NULL);
   int ret = gzwrite (mp_d->zs, (char *) b, (unsigned int) n);
   if (ret < 0) {
@@ -189,9 +189,14 @@ public:
    *  object. open() will throw a FileOpenErrorException if
    *  an error occurs.
    *
+   *  If "threads" is 1 or more and the file has been written with a block index
+   *  (see ParallelGZipWriter), the file is decompressed in parallel using the
+   *  given number of threads. Otherwise, the plain zlib functions are used.
+   *
    *  @param path The (relative) path of the file to open
+   *  @param threads The number of threads to use for decompression
    */
-  InputZLibFile (const std::string &path);
+  InputZLibFile (const std::string &path, unsigned int threads = 0);
 
   /**
    *  @brief Close the file
@@ -397,9 +402,10 @@ public:
    *  @brief Opens a stream from a abstract path
    *
    *  This will automatically create the appropriate delegate and 
-   *  delete it later.
+   *  delete it later. "zlib_threads" is the number of threads used
+   *  for decompressing files (see InputZLibFile).
    */
-  InputStream (const std::string &abstract_path);
+  InputStream (const std::string &abstract_path, unsigned int zlib_threads = 0);
 
   /**
    *  @brief Destructor
@@ -432,8 +438,10 @@ public:
    *  
    *  This call puts back the bytes read by a previous get call.
    *  Only one call can be made undone.
+   *  If inline deflating is enabled, the method will put back
+   *  inflated data unless "bypass_inflate" is set to true.
    */
-  void unget (size_t n);
+  void unget (size_t n, bool bypass_inflate = false);
 
   /**
    *  @brief Reads all remaining bytes into the string
@@ -620,6 +628,23 @@ public:
    */
   char skip ();
 
+  /**
+   *  @brief Peeks the characters available in the stream's buffer
+   *
+   *  Returns a pointer to the characters and sets "n" to the number of characters
+   *  available. The characters are not consumed - use "skip_block" to do so. Unlike
+   *  "get_char", CR and null characters are delivered too. Returns 0 at the end of
+   *  the stream. This method must not be used on streams with inline deflating.
+   */
+  const char *peek_block (size_t &n);
+
+  /**
+   *  @brief Consumes "n" characters which have been delivered by "peek_block"
+   *
+   *  The line number is updated accordingly.
+   */
+  void skip_block (size_t n);
+
   /**
    *  @brief Get the source specification
    */
@@ -636,6 +661,14 @@ public:
     return m_line;
   }
 
+  /**
+   *  @brief Get the line number of the next character
+   */
+  size_t next_line_number ()
+  {
+    return m_next_line;
+  }
+
   /**
    *  @brief Return false, if no more characters can be obtained
    */
@@ -703,6 +736,17 @@ public:
     return false;
   }
 
+  /**
+   *  @brief Completes the output
+   *
+   *  This method is called by OutputStream::close before the delegate is deleted.
+   *  Unlike the destructor, it may throw an exception if the output cannot be completed.
+   */
+  virtual void close ()
+  {
+    //  .. the default implementation does nothing ..
+  }
+
 private:
   //  No copying
   OutputStreamBase (const OutputStreamBase &);
@@ -847,9 +891,14 @@ public:
    *  object. open() will throw a FileOpenErrorException if
    *  an error occurs.
    *
+   *  If "threads" is 1 or more, blocks are compressed in parallel using the
+   *  given number of threads and a block index is written (see ParallelGZipWriter).
+   *  Otherwise, the plain zlib functions are used.
+   *
    *  @param path The (relative) path of the file to open
+   *  @param threads The number of threads to use for compression
    */
-  OutputZLibFile (const std::string &path);
+  OutputZLibFile (const std::string &path, unsigned int threads = 0);
 
   /**
    *  @brief Close the file
@@ -866,6 +915,15 @@ public:
    */
   virtual void write (const char *b, size_t n);
 
+  /**
+   *  @brief Completes the file
+   *
+   *  In multi-threaded mode, this method writes the pending blocks and the
+   *  block index. Errors are reported as exceptions. Without calling "close",
+   *  the destructor will complete the file, but it can only log errors.
+   */
+  virtual void close ();
+
 private:
   //  No copying
   OutputZLibFile (const OutputZLibFile &);
@@ -1035,8 +1093,9 @@ public:
    *
    *  This will automatically create a delegate object and delete it later.
    *  If "as_text" is true, the output will be formatted with the system's line separator.
+   *  "zlib_threads" is the number of threads used for compressing files (see OutputZLibFile).
    */
-  OutputStream (const std::string &abstract_path, OutputStreamMode om = OM_Auto, bool as_text = false);
+  OutputStream (const std::string &abstract_path, OutputStreamMode om = OM_Auto, bool as_text = false, unsigned int zlib_threads = 0);
 
   /**
    *  @brief Destructor
@@ -1047,6 +1106,9 @@ public:
 
   /**
    *  @brief Closes the stream - after closing, the stream can't be accessed anymore
+   *
+   *  Closing the stream explicitly is recommended: unlike the destructor, this
+   *  method reports errors that happen while completing the file as exceptions.
    */
   void close ();
 
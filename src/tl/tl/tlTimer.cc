@@ -192,11 +192,11 @@ SelfTimer::start_report () const
   tl::info << m_desc << ": " << tl::to_string (tr ("started"));
 }
 
-void
-SelfTimer::report () const
+size_t
+Timer::memory_size ()
 {
 #ifdef _WIN32
-  tl::info << m_desc << ": (user) " << sec_user () << " (sys) " << sec_sys ();
+  return 0;
 #else
 
   unsigned long memsize = 0;
@@ -250,10 +250,21 @@ SelfTimer::report () const
     }
   }
 
+  return size_t (memsize);
+
+#endif
+}
+
+void
+SelfTimer::report () const
+{
+#ifdef _WIN32
+  tl::info << m_desc << ": (user) " << sec_user () << " (sys) " << sec_sys ();
+#else
   tl::info << m_desc << ": " << sec_user () << " (user) "
            << sec_sys () << " (sys) "
            << sec_wall () << " (wall) "
-           << tl::sprintf ("%.2fM", double (memsize) / (1024.0 * 1024.0)) << " (mem)"
+           << tl::sprintf ("%.2fM", double (memory_size ()) / (1024.0 * 1024.0)) << " (mem)"
            ;
 #endif
 }
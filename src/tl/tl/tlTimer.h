@@ -95,6 +95,14 @@ public:
     return (double (m_wall_ms_res) * 0.001);
   }
 
+  /**
+   *  @brief Gets the current memory usage of the process in bytes
+   *
+   *  This is the virtual memory size of the process. On platforms where this
+   *  value is not available, 0 is returned.
+   */
+  static size_t memory_size ();
+
 private:
   timer_t m_user_ms, m_sys_ms, m_wall_ms;
   timer_t m_user_ms_res, m_sys_ms_res, m_wall_ms_res;
@@ -24,6 +24,7 @@
 #include "tlStream.h"
 #include "tlDeflate.h"
 #include "tlUnitTest.h"
+#include "tlFileUtils.h"
 
 #include "zlib.h"
 
@@ -118,3 +119,180 @@ TEST(3)
   delete[] hello;
 }
 
+static std::string deflate_string (const std::string &s)
+{
+  tl::OutputStringStream oss;
+  tl::OutputStream os (oss);
+  tl::DeflateFilter fg (os);
+  fg.put (s.c_str (), s.size ());
+  fg.flush ();
+  return oss.string ();
+}
+
+static std::string inflate_string (tl::InputStream &is, size_t size)
+{
+  std::string out;
+  tl::InflateFilter f (is);
+  while (! f.at_end ()) {
+    size_t n = std::min (size_t (4096), size - out.size ());
+    out += std::string (f.get (n), n);
+  }
+  return out;
+}
+
+//  Data following the DEFLATE stream is not consumed, both modes
+TEST(4)
+{
+  bool fast = tl::InflateFilter::fast_mode ();
+
+  std::string text;
+  for (int i = 0; i < 10000; ++i) {
+    text += tl::to_string (i % 77) + ",";
+  }
+
+  std::string deflated = deflate_string (text);
+
+  for (int mode = 0; mode < 2; ++mode) {
+
+    tl::InflateFilter::set_fast_mode (mode != 0);
+
+    for (size_t trailer = 0; trailer < 12; ++trailer) {
+
+      std::string data = deflated + std::string ("ABCDEFGHIJKL", trailer);
+      tl::InputMemoryStream ims (data.c_str (), data.size ());
+      tl::InputStream is (ims);
+
+      is.inflate ();
+      std::string out;
+      while (out.size () < text.size ()) {
+        out += *is.get (1);
+      }
+      EXPECT_EQ (out == text, true);
+      EXPECT_EQ (is.read_all (), std::string ("ABCDEFGHIJKL", trailer));
+
+    }
+
+  }
+
+  tl::InflateFilter::set_fast_mode (fast);
+}
+
+static bool read_uint (const std::string &data, size_t &pos, size_t &v)
+{
+  v = 0;
+  for (unsigned int shift = 0; pos < data.size () && shift < 64; shift += 7) {
+    unsigned char c = (unsigned char) data [pos++];
+    v |= size_t (c & 0x7f) << shift;
+    if ((c & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+static bool inflate_with_zlib (const std::string &deflated, size_t size, std::string &out)
+{
+  z_stream zs;
+  memset (&zs, 0, sizeof (zs));
+  if (inflateInit2 (&zs, -15) != Z_OK) {
+    return false;
+  }
+
+  out = std::string (size, 0);
+  zs.next_in = (Bytef *) deflated.c_str ();
+  zs.avail_in = (uInt) deflated.size ();
+  zs.next_out = (Bytef *) (size > 0 ? &out [0] : 0);
+  zs.avail_out = (uInt) size;
+  int ret = inflate (&zs, Z_FINISH);
+  bool ok = (ret == Z_STREAM_END && zs.total_out == size);
+  inflateEnd (&zs);
+
+  return ok;
+}
+
+//  Collects the payloads of the CBLOCK records (type 34, compression type 0) from an OASIS file.
+//  Candidates are confirmed by decompressing them with zlib.
+static void collect_cblocks (const std::string &oasis, std::vector<std::pair<std::string, std::string> > &cblocks)
+{
+  for (size_t i = 0; i < oasis.size (); ++i) {
+
+    if (oasis [i] != 34) {
+      continue;
+    }
+
+    size_t pos = i + 1;
+    size_t comp_type = 0, uncomp_count = 0, comp_count = 0;
+    if (! read_uint (oasis, pos, comp_type) || comp_type != 0
+        || ! read_uint (oasis, pos, uncomp_count) || ! read_uint (oasis, pos, comp_count)
+        || comp_count == 0 || comp_count > oasis.size () - pos || uncomp_count > 100000000) {
+      continue;
+    }
+
+    std::string deflated (oasis, pos, comp_count);
+    std::string inflated;
+    if (inflate_with_zlib (deflated, uncomp_count, inflated)) {
+      cblocks.push_back (std::make_pair (deflated, inflated));
+    }
+
+  }
+}
+
+//  OASIS data: the table-driven decoder and the bitwise decoder deliver the same
+//  result as zlib for real CBLOCK payloads and for zlib-compressed OASIS files
+//  (zlib uses dynamic Huffman codes)
+TEST(5)
+{
+  bool fast = tl::InflateFilter::fast_mode ();
+
+  std::vector<std::pair<std::string, std::string> > payloads;
+  size_t n_cblocks = 0;
+
+  std::string oasis_dir = tl::combine_path (tl::testsrc (), "testdata/oasis");
+  std::vector<std::string> files = tl::dir_entries (oasis_dir, true, false);
+  for (std::vector<std::string>::const_iterator f = files.begin (); f != files.end (); ++f) {
+
+    if (tl::extension_last (*f) != "oas") {
+      continue;
+    }
+
+    tl::InputStream is (tl::combine_path (oasis_dir, *f));
+    std::string oasis = is.read_all ();
+
+    size_t n = payloads.size ();
+    collect_cblocks (oasis, payloads);
+    n_cblocks += payloads.size () - n;
+
+    std::string deflated (compressBound (uLong (oasis.size ())), 0);
+
+    z_stream zs;
+    memset (&zs, 0, sizeof (zs));
+    EXPECT_EQ (deflateInit2 (&zs, Z_BEST_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY), Z_OK);
+    zs.next_in = (Bytef *) oasis.c_str ();
+    zs.avail_in = (uInt) oasis.size ();
+    zs.next_out = (Bytef *) &deflated [0];
+    zs.avail_out = (uInt) deflated.size ();
+    EXPECT_EQ (deflate (&zs, Z_FINISH), Z_STREAM_END);
+    deflated.resize (zs.total_out);
+    deflateEnd (&zs);
+
+    payloads.push_back (std::make_pair (deflated, oasis));
+
+  }
+
+  //  t14.1.oas contains a CBLOCK
+  EXPECT_EQ (n_cblocks > 0, true);
+
+  for (int mode = 0; mode < 2; ++mode) {
+
+    tl::InflateFilter::set_fast_mode (mode != 0);
+
+    for (std::vector<std::pair<std::string, std::string> >::const_iterator p = payloads.begin (); p != payloads.end (); ++p) {
+      tl::InputMemoryStream ims (p->first.c_str (), p->first.size ());
+      tl::InputStream is (ims);
+      EXPECT_EQ (inflate_string (is, p->second.size ()) == p->second, true);
+    }
+
+  }
+
+  tl::InflateFilter::set_fast_mode (fast);
+}
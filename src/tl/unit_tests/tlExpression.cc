@@ -1189,3 +1189,48 @@ TEST(19)
   v = e.parse ("# A comment\nvar i=CellInstArray.new(17,tr,a,b,100,200); i.to_s(); # A final comment").execute ();
   EXPECT_EQ (v.to_string (), std::string ("#17 r90 10,20 [1,2*100;11,22*200]"));
 }
+
+// constant folding
+TEST(20)
+{
+  tl::Eval e;
+  tl::Variant v;
+
+  v = e.parse ("1+2*3").execute ();
+  EXPECT_EQ (v.to_string (), std::string ("7"));
+  v = e.parse ("-(1+2)*-3").execute ();
+  EXPECT_EQ (v.to_string (), std::string ("9"));
+  v = e.parse ("'a'+1+2").execute ();
+  EXPECT_EQ (v.to_string (), std::string ("a12"));
+  v = e.parse ("1 < 2 ? 'x' : 'y'").execute ();
+  EXPECT_EQ (v.to_string (), std::string ("x"));
+  v = e.parse ("!(1 == 2) && (3 != 4)").execute ();
+  EXPECT_EQ (v.to_string (), std::string ("true"));
+  v = e.parse ("(1 << 4) | 3").execute ();
+  EXPECT_EQ (v.to_string (), std::string ("19"));
+
+  //  mixed constant and variable parts
+  e.set_var ("x", tl::Variant (5));
+  tl::Expression ex;
+  e.parse (ex, "x * (2 + 3) - 1");
+  v = ex.execute ();
+  EXPECT_EQ (v.to_string (), std::string ("24"));
+  e.set_var ("x", tl::Variant (6));
+  v = ex.execute ();
+  EXPECT_EQ (v.to_string (), std::string ("29"));
+
+  //  errors are still reported at execution time
+  bool error = false;
+  e.parse (ex, "1 / 0");
+  try {
+    ex.execute ();
+  } catch (tl::Exception &) {
+    error = true;
+  }
+  EXPECT_EQ (error, true);
+
+  //  copies of folded expressions
+  e.parse (ex, "2.5 * 2");
+  tl::Expression ex2 (ex);
+  EXPECT_EQ (ex2.execute ().to_string (), std::string ("5"));
+}
@@ -676,3 +676,23 @@ TEST (17)
   EXPECT_EQ (tl::is_same_file (yfile, tl::combine_path (dpath, "../d/y")), true);
 }
 
+
+//  file_info
+TEST (18)
+{
+  std::string tp = tl::absolute_file_path (tmp_file ());
+  EXPECT_EQ (tl::mkpath (tp), true);
+
+  std::string xfile = tl::combine_path (tp, "x");
+  {
+    tl::OutputStream os (xfile);
+    os << "hello, world!";
+  }
+
+  int64_t mtime = 0, size = 0;
+  EXPECT_EQ (tl::file_info (xfile, mtime, size), true);
+  EXPECT_EQ (int (size), 13);
+  EXPECT_EQ (mtime > 0, true);
+
+  EXPECT_EQ (tl::file_info (tl::combine_path (tp, "doesnotexist"), mtime, size), false);
+}
@@ -22,6 +22,7 @@
 
 
 #include "tlObjectCollection.h"
+#include "tlThreads.h"
 #include "tlUnitTest.h"
 
 namespace {
@@ -672,3 +673,70 @@ TEST(41)
 
   EXPECT_EQ (wc.empty (), true);
 }
+
+namespace {
+
+  class PtrThread
+    : public tl::Thread
+  {
+  public:
+    PtrThread (MyClass *shared_obj, MyClass *own_obj)
+      : mp_shared_obj (shared_obj), mp_own_obj (own_obj)
+    { }
+
+    void run ()
+    {
+      for (int i = 0; i < 100000; ++i) {
+
+        tl::weak_ptr<MyClass> w1 (mp_shared_obj);
+        tl::shared_ptr<MyClass> s1 (mp_shared_obj);
+        tl::weak_ptr<MyClass> w2 (mp_own_obj);
+        tl::shared_ptr<MyClass> s2 (mp_own_obj);
+
+        //  switch between the objects
+        w1 = w2;
+        s2 = s1;
+
+      }
+    }
+
+  private:
+    MyClass *mp_shared_obj, *mp_own_obj;
+  };
+
+}
+
+//  concurrent pointer management from multiple threads
+TEST(50)
+{
+  MyClass::reset_instance_counter ();
+
+  MyClass *o = new MyClass ();
+  tl::shared_ptr<MyClass> so (o);
+
+  std::vector<tl::shared_ptr<MyClass> > own_objects;
+  std::vector<PtrThread *> threads;
+  for (int i = 0; i < 4; ++i) {
+    MyClass *oo = new MyClass ();
+    own_objects.push_back (tl::shared_ptr<MyClass> (oo));
+    threads.push_back (new PtrThread (o, oo));
+  }
+
+  for (std::vector<PtrThread *>::const_iterator t = threads.begin (); t != threads.end (); ++t) {
+    (*t)->start ();
+  }
+  for (std::vector<PtrThread *>::const_iterator t = threads.begin (); t != threads.end (); ++t) {
+    (*t)->wait ();
+    delete *t;
+  }
+
+  //  all objects are still held by the shared pointers of the main thread
+  EXPECT_EQ (MyClass::instances (), 5);
+  EXPECT_EQ (so.get () == o, true);
+
+  own_objects.clear ();
+  EXPECT_EQ (MyClass::instances (), 1);
+
+  so.reset (0);
+  EXPECT_EQ (MyClass::instances (), 0);
+}
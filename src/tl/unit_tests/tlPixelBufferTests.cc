@@ -0,0 +1,94 @@
+
+/*
+
+  KLayout Layout Viewer
+  Copyright (C) 2006-2020 Matthias Koefferlein
+
+  This program is free software; you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation; either version 2 of the License, or
+  (at your option) any later version.
+
+  This program is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with this program; if not, write to the Free Software
+  Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+*/
+
+
+#include "tlPixelBuffer.h"
+#include "tlUnitTest.h"
+
+TEST(1)
+{
+  tl::PixelBuffer empty;
+  EXPECT_EQ (empty.width (), (unsigned int) 0);
+  EXPECT_EQ (empty.height (), (unsigned int) 0);
+  EXPECT_EQ (empty.is_external (), false);
+
+  tl::PixelBuffer pb (10, 20);
+  EXPECT_EQ (pb.width (), (unsigned int) 10);
+  EXPECT_EQ (pb.height (), (unsigned int) 20);
+  EXPECT_EQ (pb.stride (), (unsigned int) 10);
+  EXPECT_EQ (pb.transparent (), false);
+
+  pb.fill (0xff112233);
+  EXPECT_EQ (pb.pixel (0, 0), (tl::color_t) 0xff112233);
+  EXPECT_EQ (pb.pixel (9, 19), (tl::color_t) 0xff112233);
+
+  pb.set_pixel (1, 2, 0xff000001);
+  EXPECT_EQ (pb.pixel (1, 2), (tl::color_t) 0xff000001);
+  EXPECT_EQ (pb.scan_line (2) [1], (tl::color_t) 0xff000001);
+  EXPECT_EQ (pb.data () [2 * 10 + 1], (tl::color_t) 0xff000001);
+
+  tl::PixelBuffer pb2 (pb);
+  EXPECT_EQ (pb2 == pb, true);
+  EXPECT_EQ (pb2 != pb, false);
+  pb2.set_pixel (1, 2, 0xff000002);
+  EXPECT_EQ (pb2 == pb, false);
+  EXPECT_EQ (pb.pixel (1, 2), (tl::color_t) 0xff000001);
+
+  pb2.set_pixel (1, 2, 0xff000001);
+  EXPECT_EQ (pb2 == pb, true);
+  pb2.set_transparent (true);
+  EXPECT_EQ (pb2 == pb, false);
+
+  pb2 = empty;
+  EXPECT_EQ (pb2.width (), (unsigned int) 0);
+  EXPECT_EQ (pb2 == empty, true);
+
+  pb2.swap (pb);
+  EXPECT_EQ (pb2.width (), (unsigned int) 10);
+  EXPECT_EQ (pb2.pixel (1, 2), (tl::color_t) 0xff000001);
+  EXPECT_EQ (pb.width (), (unsigned int) 0);
+}
+
+TEST(2)
+{
+  //  external memory
+  tl::color_t mem [6] = { 1, 2, 3, 4, 5, 6 };
+
+  tl::PixelBuffer pb (3, 2, mem);
+  EXPECT_EQ (pb.is_external (), true);
+  EXPECT_EQ (pb.pixel (0, 0), (tl::color_t) 1);
+  EXPECT_EQ (pb.pixel (2, 1), (tl::color_t) 6);
+
+  pb.set_pixel (1, 1, 42);
+  EXPECT_EQ (mem [4], (tl::color_t) 42);
+
+  //  copies own their memory
+  tl::PixelBuffer pb2 (pb);
+  EXPECT_EQ (pb2.is_external (), false);
+  EXPECT_EQ (pb2 == pb, true);
+  pb2.fill (0);
+  EXPECT_EQ (mem [4], (tl::color_t) 42);
+
+  pb.fill (7);
+  EXPECT_EQ (mem [0], (tl::color_t) 7);
+  EXPECT_EQ (mem [5], (tl::color_t) 7);
+}
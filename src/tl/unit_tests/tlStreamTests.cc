@@ -23,6 +23,7 @@
 #include "tlStream.h"
 #include "tlUnitTest.h"
 #include "tlFileUtils.h"
+#include "tlParallelGZip.h"
 
 //  Secret mode switchers for testing
 namespace tl
@@ -145,3 +146,187 @@ TEST(TextInputStream)
     EXPECT_EQ (tis.read_all (), "Hello, world!\nWith another line\n\nseparated by a LFCR and CRLF.");
   }
 }
+
+TEST(TextInputStreamBlocks)
+{
+  std::string text = "A\nBC\r\nD";
+  tl::InputMemoryStream data (text.c_str (), text.size ());
+  tl::InputStream is (data);
+  tl::TextInputStream tis (is);
+
+  EXPECT_EQ (tis.get_char (), 'A');
+  EXPECT_EQ (tis.next_line_number (), size_t (1));
+
+  size_t n = 0;
+  const char *b = tis.peek_block (n);
+  EXPECT_EQ (std::string (b, n), "\nBC\r\nD");
+
+  //  peeking does not consume the characters
+  b = tis.peek_block (n);
+  EXPECT_EQ (std::string (b, n), "\nBC\r\nD");
+
+  tis.skip_block (4);
+  EXPECT_EQ (tis.line_number (), size_t (2));
+  EXPECT_EQ (tis.next_line_number (), size_t (2));
+  EXPECT_EQ (tis.get_char (), '\n');
+  EXPECT_EQ (tis.next_line_number (), size_t (3));
+
+  b = tis.peek_block (n);
+  EXPECT_EQ (std::string (b, n), "D");
+  tis.skip_block (n);
+  EXPECT_EQ (tis.line_number (), size_t (3));
+
+  EXPECT_EQ (tis.peek_block (n) == 0, true);
+  EXPECT_EQ (n, size_t (0));
+  EXPECT_EQ (tis.at_end (), true);
+}
+
+static std::string read_gzip_file (const std::string &fn, unsigned int threads)
+{
+  tl::InputZLibFile file (fn, threads);
+  tl::InputStream is (file);
+  tl::TextInputStream tis (is);
+  return tis.read_all ();
+}
+
+TEST(ParallelGZip)
+{
+  std::string fn = tmp_file ("test.txt.gz");
+
+  //  about 7 MB, so we get more than one group of blocks (4 MB each)
+  std::string text;
+  for (int i = 0; i < 400000; ++i) {
+    text += "Line " + tl::to_string (i) + ": " + tl::to_string (i * 7 % 1013) + "\n";
+  }
+
+  {
+    tl::OutputZLibFile file (fn, 4);
+    tl::OutputStream os (file, false);
+    os << text;
+  }
+
+  std::vector<tl::ParallelGZipIndexEntry> index;
+  unsigned long crc = 0, size = 0;
+  EXPECT_EQ (tl::ParallelGZipReader::read_index (fn, index, crc, size), true);
+  EXPECT_EQ (index.size () > 2, true);
+  EXPECT_EQ (index.back ().uncompressed, (uint64_t) text.size ());
+  EXPECT_EQ (size, (unsigned long) text.size ());
+
+  //  parallel reader
+  EXPECT_EQ (read_gzip_file (fn, 4) == text, true);
+
+  //  reset
+  {
+    tl::InputZLibFile file (fn, 4);
+    char buffer [1000];
+    EXPECT_EQ (file.read (buffer, sizeof (buffer)), sizeof (buffer));
+    EXPECT_EQ (std::string (buffer, sizeof (buffer)) == text.substr (0, sizeof (buffer)), true);
+    file.reset ();
+    tl::InputStream is (file);
+    tl::TextInputStream tis (is);
+    EXPECT_EQ (tis.read_all () == text, true);
+  }
+
+  //  plain zlib reader: the block index member is an empty gzip member
+  EXPECT_EQ (read_gzip_file (fn, 0) == text, true);
+
+  //  a plain gzip file does not have a block index
+  {
+    tl::OutputZLibFile file (fn);
+    tl::OutputStream os (file, false);
+    os << text;
+  }
+
+  EXPECT_EQ (tl::ParallelGZipReader::read_index (fn, index, crc, size), false);
+
+  EXPECT_EQ (read_gzip_file (fn, 4) == text, true);
+
+  //  empty file
+  {
+    tl::OutputZLibFile file (fn, 4);
+  }
+
+  EXPECT_EQ (read_gzip_file (fn, 4), "");
+
+  //  the number of threads is an option of the stream
+  {
+    tl::OutputStream os (fn, tl::OutputStream::OM_Auto, false, 4);
+    os << text;
+  }
+
+  EXPECT_EQ (tl::ParallelGZipReader::read_index (fn, index, crc, size), true);
+
+  {
+    tl::InputStream is (fn, 4);
+    tl::TextInputStream tis (is);
+    EXPECT_EQ (tis.read_all () == text, true);
+  }
+}
+
+namespace
+{
+
+//  A sink that fails once a certain number of bytes is exceeded
+class LimitedOutputStream
+  : public tl::OutputStreamBase
+{
+public:
+  LimitedOutputStream (size_t limit)
+    : m_left (limit)
+  {
+    //  .. nothing yet ..
+  }
+
+  virtual void write (const char *, size_t n)
+  {
+    if (n > m_left) {
+      throw tl::Exception ("Output limit exceeded");
+    }
+    m_left -= n;
+  }
+
+private:
+  size_t m_left;
+};
+
+}
+
+TEST(ParallelGZipClose)
+{
+  std::string text;
+  for (int i = 0; i < 1000; ++i) {
+    text += "Line " + tl::to_string (i) + "\n";
+  }
+
+  //  the pending blocks are written by "finish", so errors are reported there
+  {
+    LimitedOutputStream sink (100);
+    tl::ParallelGZipWriter writer (sink, 2);
+    writer.write (text.c_str (), text.size ());
+
+    bool error = false;
+    try {
+      writer.finish ();
+    } catch (tl::Exception &ex) {
+      EXPECT_EQ (ex.msg (), "Output limit exceeded");
+      error = true;
+    }
+    EXPECT_EQ (error, true);
+  }
+
+  //  an explicit close completes the file while the object is still alive
+  std::string fn = tmp_file ("test.txt.gz");
+
+  {
+    tl::OutputStream os (fn, tl::OutputStream::OM_Auto, false, 2);
+    os << text;
+    os.close ();
+
+    EXPECT_EQ (read_gzip_file (fn, 2) == text, true);
+
+    //  closing again does not harm
+    os.close ();
+  }
+
+  EXPECT_EQ (read_gzip_file (fn, 2) == text, true);
+}
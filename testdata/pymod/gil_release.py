@@ -0,0 +1,124 @@
+# KLayout Layout Viewer
+# Copyright (C) 2006-2020 Matthias Koefferlein
+#
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 2 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+
+
+import klayout.db as db
+import unittest
+import threading
+import tempfile
+import sys
+import os
+
+# Tests the release of the global interpreter lock in long-running methods
+
+class Box(db.PCellDeclarationHelper):
+
+  def __init__(self):
+    super(Box, self).__init__()
+    self.param("l", self.TypeLayer, "Layer", default = db.LayerInfo(1, 0))
+    self.param("w", self.TypeInt, "Width", default = 100)
+    self.produced = 0
+
+  def produce_impl(self):
+    # called from Layout#read while the lock is released
+    self.produced += 1
+    self.cell.shapes(self.l_layer).insert(db.Box(0, 0, self.w, self.w))
+
+class BoxLib(db.Library):
+
+  def __init__(self):
+    self.box = Box()
+    self.layout().register_pcell("Box", self.box)
+    self.register("GILReleaseTestLib")
+
+class GILReleaseTest(unittest.TestCase):
+
+  def test_1(self):
+
+    # Region#merged runs without the lock: Python code in the main
+    # thread makes progress while the merge is executed in another thread
+
+    r = db.Region()
+    for i in range(0, 300):
+      for j in range(0, 300):
+        r.insert(db.Box(i * 10, j * 10, i * 10 + 15, j * 10 + 15))
+
+    state = { "started": False, "done": False, "result": None }
+
+    def merge():
+      state["started"] = True
+      state["result"] = r.merged()
+      state["done"] = True
+
+    t = threading.Thread(target = merge)
+    t.start()
+
+    while not state["started"]:
+      pass
+
+    steps = 0
+    while not state["done"]:
+      steps += 1
+
+    t.join()
+
+    self.assertEqual(state["result"].count(), 1)
+    self.assertEqual(steps > 1000, True)
+
+  def test_2(self):
+
+    # Layout#read runs without the lock, but the PCell implementation
+    # is called back and needs to reacquire it
+
+    lib = BoxLib()
+
+    ly = db.Layout()
+    top = ly.create_cell("TOP")
+    pcell = ly.create_cell("Box", "GILReleaseTestLib", { "w": 200 })
+    top.insert(db.CellInstArray(pcell.cell_index(), db.Trans()))
+
+    fn = os.path.join(tempfile.gettempdir(), "gil_release_test.gds")
+    ly.write(fn)
+
+    # a new library does not have the variant yet, so reading the layout will produce it
+    ly._destroy()
+    lib = BoxLib()
+    self.assertEqual(lib.box.produced, 0)
+
+    results = []
+
+    def read():
+      ly2 = db.Layout()
+      ly2.read(fn)
+      results.append(ly2.top_cell().dbbox().to_s())
+
+    threads = [ threading.Thread(target = read) for i in range(0, 4) ]
+    for t in threads:
+      t.start()
+    for t in threads:
+      t.join()
+
+    self.assertEqual(results, [ "(0,0;0.2,0.2)" ] * 4)
+    self.assertEqual(lib.box.produced > 0, True)
+
+# run unit tests
+if __name__ == '__main__':
+  suite = unittest.TestSuite()
+  suite = unittest.TestLoader().loadTestsFromTestCase(GILReleaseTest)
+
+  if not unittest.TextTestRunner(verbosity = 1).run(suite).wasSuccessful():
+    sys.exit(1)
@@ -19,6 +19,7 @@
 import pya
 import unittest
 import sys
+import struct
 import os
 
 class DBLayoutTest(unittest.TestCase):
@@ -1152,6 +1153,31 @@ class DBLayoutTest(unittest.TestCase):
     self.assertEqual(shape.property(42), None)
     self.assertEqual(shape.property(42.0), None)
 
+  # batched geometry iteration
+  def test_14(self):
+
+    ly = pya.Layout()
+    top = ly.create_cell("TOP")
+    shapes = top.shapes(ly.layer(1, 0))
+
+    for i in range(0, 5):
+      shapes.insert(pya.Box(i * 10, 0, i * 10 + 5, 5))
+    shapes.insert(pya.Text("T", pya.Trans()))
+
+    batches = [ [ str(ca.polygon(i)) for i in range(0, ca.size()) ] for ca in shapes.each_batch(2) ]
+    self.assertEqual(batches, [
+      [ "(0,0;0,5;5,5;5,0)", "(10,0;10,5;15,5;15,0)" ],
+      [ "(20,0;20,5;25,5;25,0)", "(30,0;30,5;35,5;35,0)" ],
+      [ "(40,0;40,5;45,5;45,0)" ]
+    ])
+
+    sizes = [ ca.size() for ca in shapes.each_batch(5) ]
+    self.assertEqual(sizes, [ 5 ])
+
+    # packed geometry
+    xy = [ struct.unpack("<8i", ca.coordinates_bytes(4)[0:32]) for ca in shapes.each_batch(2) ]
+    self.assertEqual(xy[2], ( 40, 0, 40, 5, 45, 5, 45, 0 ))
+
 
 # run unit tests
 if __name__ == '__main__':
@@ -19,6 +19,7 @@
 import pya
 import unittest
 import sys
+import struct
 import os
 
 class DBRegionTest(unittest.TestCase):
@@ -40,6 +41,36 @@ class DBRegionTest(unittest.TestCase):
     r.merge()
     self.assertEqual(str(r), "(0,100;0,300;50,300;50,350;250,350;250,150;200,150;200,100)")
 
+  def test_2_Coordinates(self):
+
+    r = pya.Region()
+    r.insert(pya.Box(0, 100, 200, 300))
+    r.insert(pya.Box(-100000, 0, 10, 20))
+
+    ca = r.to_coordinates()
+    self.assertEqual(ca.size(), 2)
+
+    # round trip through packed arrays
+    ca2 = pya.CoordinateArrays.from_bytes(ca.coordinates_bytes(4), ca.contour_offsets_bytes(8), ca.polygon_offsets_bytes(8))
+    r2 = pya.Region()
+    r2.insert_coordinates(ca2)
+    self.assertEqual(str(r2), str(r))
+
+    # any contiguous buffer is accepted (e.g. numpy arrays)
+    xy = struct.pack("<8i", 0, 0, 0, 10, 20, 10, 20, 0)
+    co = struct.pack("<2q", 0, 4)
+    po = struct.pack("<2q", 0, 1)
+    ca3 = pya.CoordinateArrays.from_bytes(memoryview(xy), bytearray(co), po, 4, 8)
+    self.assertEqual(str(ca3.polygon(0)), "(0,0;0,10;20,10;20,0)")
+    self.assertEqual(ca3.polygon_offsets(), [ 0, 1 ])
+
+    # inconsistent arrays
+    try:
+      pya.CoordinateArrays.from_bytes(xy, co, po, 4, 4)
+      self.assertEqual(False, True)
+    except Exception:
+      pass
+
   def test_deep1(self):
 
     ut_testsrc = os.getenv("TESTSRC")
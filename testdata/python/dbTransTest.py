@@ -589,6 +589,45 @@ class DBTransTests(unittest.TestCase):
       self.assertEqual(h[t3c], "t3c")
       self.assertEqual(h[t4], "t4")
 
+  def test_6_Overloads(self):
+
+    # overloads which differ in the argument types only: the same method is
+    # called with alternating argument types, so the overload resolution has
+    # been done (and cached) for one type when the next one comes in
+
+    t = pya.Trans(pya.Trans.R90, 1, 2)
+    b = pya.Box(0, 0, 10, 20)
+
+    ly = pya.Layout()
+    ly.dbu = 0.001
+    top = ly.create_cell("TOP")
+    shapes = top.shapes(ly.layer(1, 0))
+
+    for i in range(0, 3):
+
+      self.assertEqual(str(t * pya.Point(1, 0)), "1,3")
+      self.assertEqual(str(t * pya.Vector(1, 0)), "0,1")
+      self.assertEqual(str(t * b), "(-19,2;1,12)")
+      self.assertEqual(str(t * pya.Edge(0, 0, 10, 0)), "(1,2;1,12)")
+      self.assertEqual(str(t * pya.Point(1, 0)), "1,3")
+      self.assertEqual(str(t * t), "r180 -1,3")
+
+      self.assertEqual(str(b * 2), "(0,0;20,40)")
+      self.assertEqual(str(b * pya.Box(-1, -1, 1, 1)), "(-1,-1;11,21)")
+      self.assertEqual(str(b * 2.5), "(0,0;25,50)")
+      self.assertEqual(str(b * 2), "(0,0;20,40)")
+
+      self.assertEqual(str(shapes.insert(pya.Box(0, 0, 1, 2))), "box (0,0;1,2)")
+      self.assertEqual(str(shapes.insert(pya.DBox(0, 0, 1, 2))), "box (0,0;1000,2000)")
+      self.assertEqual(str(shapes.insert(pya.Edge(0, 0, 1, 2))), "edge (0,0;1,2)")
+      self.assertEqual(str(shapes.insert(pya.DEdge(0, 0, 1, 2))), "edge (0,0;1000,2000)")
+      self.assertEqual(str(shapes.insert(pya.Box(0, 0, 1, 2))), "box (0,0;1,2)")
+
+      # list arguments are not cached but resolved each time
+      self.assertEqual(str(pya.Polygon([ pya.Point(0, 0), pya.Point(0, 1), pya.Point(1, 1) ])), "(0,0;0,1;1,1)")
+      self.assertEqual(str(pya.Polygon(b)), "(0,0;0,20;10,20;10,0)")
+
+
 
 # run unit tests
 if __name__ == '__main__':
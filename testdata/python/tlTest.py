@@ -19,6 +19,7 @@
 import pya
 import unittest
 import sys
+import struct
 
 def astr(a):
   astr = []
@@ -217,6 +218,47 @@ class TLTest(unittest.TestCase):
     self.assertEqual(res[1].destroyed(), True)
     self.assertEqual(res[2].destroyed(), True)
 
+  # PixelBuffer bulk data
+  def test_3_PixelBuffer(self):
+
+    pb = pya.PixelBuffer(2, 1)
+    pb.set_pixel(0, 0, 0x11223344)
+    pb.set_pixel(1, 0, 0xaabbccdd)
+
+    d = pb.data
+    self.assertEqual(len(d), 8)
+    self.assertEqual(struct.unpack("<2I", d), (0x11223344, 0xaabbccdd))
+
+    pb2 = pya.PixelBuffer(2, 1, d)
+    self.assertEqual(pb2 == pb, True)
+    self.assertEqual("%08x" % pb2.pixel(1, 0), "aabbccdd")
+
+    pb2.data = bytearray(struct.pack("<2I", 1, 2))
+    self.assertEqual(pb2.pixel(0, 0), 1)
+    self.assertEqual(pb2.pixel(1, 0), 2)
+
+    try:
+      pb2.data = b"xyz"
+      self.assertEqual(True, False)
+    except Exception as ex:
+      self.assertEqual(str(ex).find("does not match the buffer size") >= 0, True)
+
+    # RGBA byte order
+    d = pb.rgba_data
+    self.assertEqual(d, b"\x22\x33\x44\x11\xbb\xcc\xdd\xaa")
+
+    pb2 = pya.PixelBuffer(2, 1, d, True)
+    self.assertEqual(pb2 == pb, True)
+
+    # objects providing a buffer (e.g. numpy arrays) are accepted too
+    pb2.rgba_data = memoryview(b"\x01\x02\x03\x04\x05\x06\x07\x08")
+    self.assertEqual("%08x" % pb2.pixel(0, 0), "04010203")
+    self.assertEqual("%08x" % pb2.pixel(1, 0), "08050607")
+
+    pb2.data = memoryview(struct.pack("<2I", 3, 4))
+    self.assertEqual(pb2.pixel(0, 0), 3)
+    self.assertEqual(pb2.pixel(1, 0), 4)
+
 # run unit tests
 if __name__ == '__main__':
   suite = unittest.TestLoader().loadTestsFromTestCase(TLTest)
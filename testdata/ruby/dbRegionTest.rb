@@ -837,6 +837,40 @@ class DBRegion_TestClass < TestBase
 
   end
 
+  # bulk insert
+  def test_16
+
+    r = RBA::Region::new
+    r.insert_many([ RBA::Box::new(0, 0, 100, 200), RBA::Box::new(10, 20, 30, 40) ])
+    r.insert_many([ RBA::Polygon::new(RBA::Box::new(0, 0, 10, 10)) ])
+    r.insert_many([ RBA::SimplePolygon::new(RBA::Box::new(0, 0, 20, 20)) ])
+    r.insert_many([ RBA::Path::new([ RBA::Point::new(0, 0), RBA::Point::new(100, 0) ], 10) ])
+    r.insert_boxes([ 1, 2, 3, 4 ])
+    assert_equal(r.size, 6)
+    assert_equal(r.to_s, "(0,0;0,200;100,200;100,0);(10,20;10,40;30,40;30,20);(0,0;0,10;10,10;10,0);(0,0;0,20;20,20;20,0);(0,-5;0,5;100,5;100,-5);(1,2;1,4;3,4;3,2)")
+
+    begin
+      r.insert_boxes([ 1, 2, 3 ])
+      assert_equal(true, false)
+    rescue => ex
+    end
+    assert_equal(r.size, 6)
+
+    # packed version
+    r = RBA::Region::new
+    r.insert_boxes([ -1, 2, 3, 4, 10, 20, 30, 40 ].pack("l<*"))
+    r.insert_boxes([ 5, 6, 7, 8 ].pack("q<*"), 8)
+    assert_equal(r.to_s, "(-1,2;-1,4;3,4;3,2);(10,20;10,40;30,40;30,20);(5,6;5,8;7,8;7,6)")
+
+    begin
+      r.insert_boxes([ 1, 2, 3 ].pack("l<*"))
+      assert_equal(true, false)
+    rescue => ex
+    end
+    assert_equal(r.size, 3)
+
+  end
+
   # deep region tests
   def test_deep1
 
@@ -1514,6 +1514,127 @@ class DBShapes_TestClass < TestBase
 
   end
 
+  # bulk insert
+  def test_11
+
+    [ true, false ].each do |editable|
+
+      ly = RBA::Layout::new(editable)
+      ly.dbu = 0.001
+      top = ly.create_cell("TOP")
+      shapes = top.shapes(ly.layer(1, 0))
+
+      shapes.insert_many([ RBA::Box::new(0, 0, 100, 200), RBA::Box::new(10, 20, 30, 40) ])
+      shapes.insert_many([ RBA::Polygon::new(RBA::Box::new(0, 0, 10, 10)) ])
+      shapes.insert_many([ RBA::SimplePolygon::new(RBA::Box::new(0, 0, 20, 20)) ])
+      shapes.insert_many([ RBA::Path::new([ RBA::Point::new(0, 0), RBA::Point::new(100, 0) ], 10) ])
+      shapes.insert_many([ RBA::Edge::new(0, 0, 100, 100) ])
+      shapes.insert_many([ RBA::Text::new("T", RBA::Trans::new(5, 6)) ])
+      shapes.insert_many([ RBA::DBox::new(0, 0, 0.5, 0.25) ])
+      shapes.insert_boxes([ 1, 2, 3, 4, 5, 6, 7, 8 ])
+
+      assert_equal(shapes.size, 10)
+      boxes = []
+      shapes.each(RBA::Shapes::SBoxes) { |s| boxes << s.to_s }
+      assert_equal(boxes.sort.join(";"), "box (0,0;100,200);box (0,0;500,250);box (1,2;3,4);box (10,20;30,40);box (5,6;7,8)")
+      texts = []
+      shapes.each(RBA::Shapes::STexts) { |s| texts << s.to_s }
+      assert_equal(texts.join(";"), "text ('T',r0 5,6)")
+
+      begin
+        shapes.insert_boxes([ 1, 2, 3 ])
+        assert_equal(true, false)
+      rescue => ex
+      end
+      assert_equal(shapes.size, 10)
+
+      # packed version
+      shapes.clear
+      shapes.insert_boxes([ 1, 2, 3, 4, -5, 6, 7, 8 ].pack("l<*"))
+      shapes.insert_boxes([ 10, 20, 30, 40 ].pack("q<*"), 8)
+      boxes = []
+      shapes.each(RBA::Shapes::SBoxes) { |s| boxes << s.to_s }
+      assert_equal(boxes.sort.join(";"), "box (-5,6;7,8);box (1,2;3,4);box (10,20;30,40)")
+
+      begin
+        shapes.insert_boxes([ 1, 2, 3, 4 ].pack("l<*"), 2)
+        assert_equal(true, false)
+      rescue => ex
+      end
+      assert_equal(shapes.size, 3)
+
+    end
+
+  end
+
+  # batched geometry iteration
+  def test_12
+
+    ly = RBA::Layout::new
+    top = ly.create_cell("TOP")
+    child = ly.create_cell("CHILD")
+    l1 = ly.layer(1, 0)
+    l2 = ly.layer(2, 0)
+
+    shapes = top.shapes(l1)
+    7.times { |i| shapes.insert(RBA::Box::new(i * 10, 0, i * 10 + 5, 5)) }
+    shapes.insert(RBA::Path::new([ RBA::Point::new(0, 100), RBA::Point::new(50, 100) ], 10))
+    shapes.insert(RBA::Text::new("T", RBA::Trans::new))
+    shapes.insert(RBA::Edge::new(0, 0, 100, 100))
+
+    expected = []
+    shapes.each(RBA::Shapes::SBoxes | RBA::Shapes::SPaths) { |s| expected << s.polygon.to_s }
+    assert_equal(expected.size, 8)
+
+    [ [ 3, [ 3, 3, 2 ] ], [ 4, [ 4, 4 ] ], [ 100, [ 8 ] ], [ 1, [ 1 ] * 8 ] ].each do |n, sizes|
+      bs = []
+      polygons = []
+      shapes.each_batch(n) do |ca|
+        bs << ca.size
+        ca.size.times { |i| polygons << ca.polygon(i).to_s }
+      end
+      assert_equal(bs, sizes)
+      assert_equal(polygons.join(";"), expected.join(";"))
+    end
+
+    # texts and edges are not delivered
+    bs = []
+    shapes.each_batch(3, RBA::Shapes::STexts | RBA::Shapes::SEdges) { |ca| bs << ca.size }
+    assert_equal(bs, [])
+
+    # packed geometry
+    ca = nil
+    shapes.each_batch(2, RBA::Shapes::SBoxes) { |c| ca ||= c.dup }
+    assert_equal(ca.coordinates_bytes.unpack("l<*"), [ 0, 0, 0, 5, 5, 5, 5, 0, 10, 0, 10, 5, 15, 5, 15, 0 ])
+    assert_equal(ca.contour_offsets, [ 0, 4, 8 ])
+
+    # recursive iteration delivers the geometry in the top cell
+    child.shapes(l2).insert(RBA::Box::new(0, 0, 10, 10))
+    top.insert(RBA::CellInstArray::new(child.cell_index, RBA::Trans::new(1000, 0)))
+    top.insert(RBA::CellInstArray::new(child.cell_index, RBA::Trans::new(RBA::Trans::R90, 2000, 0)))
+    top.shapes(l2).insert(RBA::Box::new(0, 0, 1, 1))
+    top.shapes(l2).insert(RBA::Text::new("T", RBA::Trans::new))
+
+    expected = []
+    it = RBA::RecursiveShapeIterator::new(ly, top, l2)
+    while !it.at_end?
+      it.shape.is_text? || expected << it.shape.polygon.transformed(it.trans).to_s
+      it.next
+    end
+    assert_equal(expected.size, 3)
+
+    bs = []
+    polygons = []
+    RBA::RecursiveShapeIterator::new(ly, top, l2).each_batch(2) do |batch|
+      bs << batch.size
+      ca = batch.to_coordinates
+      ca.size.times { |i| polygons << ca.polygon(i).to_s }
+    end
+    assert_equal(bs, [ 2, 2 ])
+    assert_equal(polygons.join(";"), expected.join(";"))
+
+  end
+
 end
 
 load("test_epilogue.rb")
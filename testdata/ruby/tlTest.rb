@@ -300,6 +300,45 @@ class Tl_TestClass < TestBase
 
   end
 
+  # PixelBuffer bulk data
+  def test_5_PixelBuffer
+
+    pb = RBA::PixelBuffer::new(2, 1)
+    pb.set_pixel(0, 0, 0x11223344)
+    pb.set_pixel(1, 0, 0xaabbccdd)
+
+    d = pb.data
+    assert_equal(d.size, 8)
+    assert_equal(d.unpack("V*"), [ 0x11223344, 0xaabbccdd ])
+
+    pb2 = RBA::PixelBuffer::new(2, 1, d)
+    assert_equal(pb2 == pb, true)
+    assert_equal("%08x" % pb2.pixel(1, 0), "aabbccdd")
+
+    pb2.data = [ 1, 2 ].pack("V*")
+    assert_equal(pb2.pixel(0, 0), 1)
+    assert_equal(pb2.pixel(1, 0), 2)
+
+    begin
+      pb2.data = "xyz"
+      assert_equal(true, false)
+    rescue => ex
+      assert_equal(ex.to_s.index("does not match the buffer size") != nil, true)
+    end
+
+    # RGBA byte order
+    d = pb.rgba_data
+    assert_equal(d.unpack("C*"), [ 0x22, 0x33, 0x44, 0x11, 0xbb, 0xcc, 0xdd, 0xaa ])
+
+    pb2 = RBA::PixelBuffer::new(2, 1, d, true)
+    assert_equal(pb2 == pb, true)
+
+    pb2.rgba_data = [ 1, 2, 3, 4, 5, 6, 7, 8 ].pack("C*")
+    assert_equal("%08x" % pb2.pixel(0, 0), "04010203")
+    assert_equal("%08x" % pb2.pixel(1, 0), "08050607")
+
+  end
+
 end
 
 load("test_epilogue.rb")